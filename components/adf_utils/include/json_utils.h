@@ -25,10 +25,37 @@
 #ifndef _JSON_UTILS_H_
 #define _JSON_UTILS_H_
 
+#include <stdbool.h>
+#include "esp_err.h"
+#include "jsmn.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * @brief Zero-copy view of a JSON value inside the parsed document
+ *
+ * @note  `ptr` is not null-terminated. String values are returned without the quotes and escapes are kept as is
+ */
+typedef struct {
+    const char  *ptr;           /*!< Start of the value in the json string */
+    int         len;            /*!< Length of the value */
+    jsmntype_t  type;           /*!< Type of the value */
+} json_slice_t;
+
+/**
+ * @brief Tokenized JSON document, parse once and look up many values
+ */
+typedef struct {
+    const char  *json;          /*!< The json string, must be kept valid while the document is used */
+    int         json_len;       /*!< Length of the json string */
+    jsmntok_t   *tokens;        /*!< Token arena */
+    int         token_num;      /*!< Number of parsed tokens */
+    int         token_size;     /*!< Capacity of the token arena */
+    bool        dynamic;        /*!< The token arena is allocated and grown by json_doc */
+} json_doc_t;
+
 /**
  * @brief      This function returns the string value of the token in json_string.
  *             The returning string is allocated and must be free as soon as it is used
@@ -40,6 +67,102 @@ extern "C" {
  */
 char *json_get_token_value(const char *json_string, const char *token_name);
 
+/**
+ * @brief      Tokenize a json string once, values can be looked up by `json_doc_get` afterwards
+ *
+ * @note       If `tokens` is NULL, the token arena is allocated and grown on demand, call `json_doc_release` to free it.
+ *             Otherwise the caller-provided arena is used and parsing fails when it is too small
+ *
+ * @param[out] doc         The document to initialize
+ * @param[in]  json        The json string, it's referenced by the document and not copied
+ * @param[in]  json_len    Length of the json string, -1 to use strlen
+ * @param[in]  tokens      Caller-provided token arena, or NULL
+ * @param[in]  token_size  Number of tokens in `tokens`
+ *
+ * @return
+ *     - ESP_OK                 Success
+ *     - ESP_ERR_INVALID_ARG    Invalid argument
+ *     - ESP_ERR_NO_MEM         Token arena is too small or out of memory
+ *     - ESP_FAIL               Invalid or incomplete json string
+ */
+esp_err_t json_doc_parse(json_doc_t *doc, const char *json, int json_len, jsmntok_t *tokens, int token_size);
+
+/**
+ * @brief      Find the token index of a value by path
+ *
+ * @note       Path segments are object keys separated by '.', array elements are selected by "[index]",
+ *             e.g. "results[0].alternatives[0].transcript". An empty path is the root value
+ *
+ * @param[in]  doc   The parsed document
+ * @param[in]  path  The path of the value
+ *
+ * @return
+ *     - Token index of the value
+ *     - -1 if not found
+ */
+int json_doc_find(const json_doc_t *doc, const char *path);
+
+/**
+ * @brief      Get a value by path without copying it
+ *
+ * @param[in]  doc    The parsed document
+ * @param[in]  path   The path of the value, see `json_doc_find`
+ * @param[out] value  The value slice
+ *
+ * @return
+ *     - ESP_OK               Success
+ *     - ESP_ERR_NOT_FOUND    No such value
+ *     - ESP_ERR_INVALID_ARG  Invalid argument
+ */
+esp_err_t json_doc_get(const json_doc_t *doc, const char *path, json_slice_t *value);
+
+/**
+ * @brief      Get an integer value by path
+ *
+ * @param[in]  doc    The parsed document
+ * @param[in]  path   The path of the value, see `json_doc_find`
+ * @param[out] value  The integer value
+ *
+ * @return
+ *     - ESP_OK               Success
+ *     - ESP_ERR_NOT_FOUND    No such value
+ *     - ESP_ERR_INVALID_ARG  Invalid argument or the value is not a number
+ */
+esp_err_t json_doc_get_int(const json_doc_t *doc, const char *path, int *value);
+
+/**
+ * @brief      Copy a value by path into a caller-provided buffer as a null-terminated string
+ *
+ * @param[in]  doc       The parsed document
+ * @param[in]  path      The path of the value, see `json_doc_find`
+ * @param[out] buf       The output buffer
+ * @param[in]  buf_size  Size of the output buffer
+ *
+ * @return
+ *     - Length of the value on success
+ *     - -1 if not found or the buffer is too small
+ */
+int json_doc_copy(const json_doc_t *doc, const char *path, char *buf, int buf_size);
+
+/**
+ * @brief      Compare a value slice with a null-terminated string
+ *
+ * @param[in]  value  The value slice
+ * @param[in]  str    The string to compare
+ *
+ * @return
+ *     - true    Equal
+ *     - false   Not equal
+ */
+bool json_slice_equal(const json_slice_t *value, const char *str);
+
+/**
+ * @brief      Release the token arena allocated by `json_doc_parse`
+ *
+ * @param[in]  doc  The parsed document
+ */
+void json_doc_release(json_doc_t *doc);
+
 #ifdef __cplusplus
 }
 #endif
@@ -28,9 +28,13 @@
 #include "esp_log.h"
 #include "jsmn.h"
 #include "audio_error.h"
+#include "audio_mem.h"
+#include "json_utils.h"
 
 static const char* TAG = "JSON_UTILS";
 
+#define JSON_DOC_INIT_TOKEN_NUM (32)
+
 static bool jsoneq(const char *json, jsmntok_t *tok, const char *s)
 {
     if (tok->type == JSMN_STRING && (int) strlen(s) == tok->end - tok->start &&
@@ -42,30 +46,196 @@ static bool jsoneq(const char *json, jsmntok_t *tok, const char *s)
 
 char *json_get_token_value(const char *json_string, const char *token_name)
 {
-    jsmn_parser parser;
-    jsmn_init(&parser);
-    jsmntok_t t[20];
+    json_doc_t doc;
     int i;
 
-    int r = jsmn_parse(&parser, json_string, strlen(json_string), t, 20);
-
-    if (r < 0) {
-        ESP_LOGE(TAG, "Failed to parse JSON: %d", r);
+    if (json_doc_parse(&doc, json_string, -1, NULL, 0) != ESP_OK) {
         return NULL;
     }
     /* Assume the top-level element is an object */
-    if (r < 1 || t[0].type != JSMN_OBJECT) {
+    if (doc.tokens[0].type != JSMN_OBJECT) {
         ESP_LOGE(TAG, "Object expected");
+        json_doc_release(&doc);
         return NULL;
     }
-    for (i = 1; i < r; i++) {
-        if (jsoneq(json_string, &t[i], token_name) && i < r) {
-            int tok_len = t[i+1].end - t[i+1].start;
-            char *tok = calloc(1, tok_len + 1);
-            AUDIO_MEM_CHECK(TAG, tok, return NULL);
-            memcpy(tok, json_string + t[i+1].start, tok_len);
-            return tok;
+    char *tok = NULL;
+    for (i = 1; i < doc.token_num - 1; i++) {
+        if (jsoneq(json_string, &doc.tokens[i], token_name)) {
+            int tok_len = doc.tokens[i + 1].end - doc.tokens[i + 1].start;
+            tok = calloc(1, tok_len + 1);
+            AUDIO_MEM_CHECK(TAG, tok, break);
+            memcpy(tok, json_string + doc.tokens[i + 1].start, tok_len);
+            break;
+        }
+    }
+    json_doc_release(&doc);
+    return tok;
+}
+
+esp_err_t json_doc_parse(json_doc_t *doc, const char *json, int json_len, jsmntok_t *tokens, int token_size)
+{
+    AUDIO_NULL_CHECK(TAG, doc, return ESP_ERR_INVALID_ARG);
+    AUDIO_NULL_CHECK(TAG, json, return ESP_ERR_INVALID_ARG);
+    memset(doc, 0, sizeof(json_doc_t));
+    doc->json = json;
+    doc->json_len = json_len < 0 ? strlen(json) : json_len;
+    doc->tokens = tokens;
+    doc->token_size = token_size;
+    if (tokens == NULL) {
+        doc->dynamic = true;
+        doc->token_size = JSON_DOC_INIT_TOKEN_NUM;
+        doc->tokens = audio_malloc(doc->token_size * sizeof(jsmntok_t));
+        AUDIO_MEM_CHECK(TAG, doc->tokens, return ESP_ERR_NO_MEM);
+    }
+
+    jsmn_parser parser;
+    jsmn_init(&parser);
+    int r;
+    while ((r = jsmn_parse(&parser, doc->json, doc->json_len, doc->tokens, doc->token_size)) == JSMN_ERROR_NOMEM) {
+        if (doc->dynamic == false) {
+            ESP_LOGE(TAG, "Token arena is too small, %d tokens", doc->token_size);
+            return ESP_ERR_NO_MEM;
+        }
+        // jsmn keeps its position, so parsing resumes after the arena has grown
+        jsmntok_t *grown = audio_realloc(doc->tokens, doc->token_size * 2 * sizeof(jsmntok_t));
+        AUDIO_MEM_CHECK(TAG, grown, {
+            json_doc_release(doc);
+            return ESP_ERR_NO_MEM;
+        });
+        doc->tokens = grown;
+        doc->token_size *= 2;
+    }
+    if (r < 1) {
+        ESP_LOGE(TAG, "Failed to parse JSON: %d", r);
+        json_doc_release(doc);
+        return ESP_FAIL;
+    }
+    doc->token_num = r;
+    return ESP_OK;
+}
+
+/* Index of the token following the whole subtree of token `i` */
+static int json_doc_skip(const json_doc_t *doc, int i)
+{
+    int pending = 1;
+    while (pending > 0 && i < doc->token_num) {
+        pending += doc->tokens[i].size - 1;
+        i++;
+    }
+    return i;
+}
+
+int json_doc_find(const json_doc_t *doc, const char *path)
+{
+    AUDIO_NULL_CHECK(TAG, doc && doc->tokens, return -1);
+    AUDIO_NULL_CHECK(TAG, path, return -1);
+    int cur = 0;
+    const char *p = path;
+    while (*p && cur < doc->token_num) {
+        jsmntok_t *t = &doc->tokens[cur];
+        int end = json_doc_skip(doc, cur);
+        if (*p == '[') {
+            char *idx_end = NULL;
+            long idx = strtol(p + 1, &idx_end, 10);
+            if (t->type != JSMN_ARRAY || idx_end == p + 1 || *idx_end != ']' || idx < 0) {
+                return -1;
+            }
+            int elem = cur + 1;
+            while (idx-- > 0 && elem < end) {
+                elem = json_doc_skip(doc, elem);
+            }
+            if (elem >= end) {
+                return -1;
+            }
+            cur = elem;
+            p = idx_end + 1;
+        } else {
+            if (*p == '.') {
+                p++;
+            }
+            int key_len = strcspn(p, ".[");
+            if (t->type != JSMN_OBJECT || key_len == 0) {
+                return -1;
+            }
+            int key = cur + 1;
+            int found = -1;
+            while (key + 1 < end) {
+                jsmntok_t *k = &doc->tokens[key];
+                if (k->type == JSMN_STRING && k->end - k->start == key_len
+                    && memcmp(doc->json + k->start, p, key_len) == 0) {
+                    found = key + 1;
+                    break;
+                }
+                key = json_doc_skip(doc, key + 1);
+            }
+            if (found < 0) {
+                return -1;
+            }
+            cur = found;
+            p += key_len;
         }
     }
-    return NULL;
+    return cur < doc->token_num ? cur : -1;
+}
+
+esp_err_t json_doc_get(const json_doc_t *doc, const char *path, json_slice_t *value)
+{
+    AUDIO_NULL_CHECK(TAG, value, return ESP_ERR_INVALID_ARG);
+    int i = json_doc_find(doc, path);
+    if (i < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    value->ptr = doc->json + doc->tokens[i].start;
+    value->len = doc->tokens[i].end - doc->tokens[i].start;
+    value->type = doc->tokens[i].type;
+    return ESP_OK;
+}
+
+esp_err_t json_doc_get_int(const json_doc_t *doc, const char *path, int *value)
+{
+    AUDIO_NULL_CHECK(TAG, value, return ESP_ERR_INVALID_ARG);
+    json_slice_t slice;
+    esp_err_t ret = json_doc_get(doc, path, &slice);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    char num[16];
+    if (slice.type != JSMN_PRIMITIVE || slice.len >= (int)sizeof(num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(num, slice.ptr, slice.len);
+    num[slice.len] = 0;
+    char *end = NULL;
+    *value = strtol(num, &end, 10);
+    return end == num ? ESP_ERR_INVALID_ARG : ESP_OK;
+}
+
+int json_doc_copy(const json_doc_t *doc, const char *path, char *buf, int buf_size)
+{
+    AUDIO_NULL_CHECK(TAG, buf, return -1);
+    json_slice_t slice;
+    if (json_doc_get(doc, path, &slice) != ESP_OK || slice.len >= buf_size) {
+        return -1;
+    }
+    memcpy(buf, slice.ptr, slice.len);
+    buf[slice.len] = 0;
+    return slice.len;
+}
+
+bool json_slice_equal(const json_slice_t *value, const char *str)
+{
+    AUDIO_NULL_CHECK(TAG, value && str, return false);
+    return (int)strlen(str) == value->len && memcmp(value->ptr, str, value->len) == 0;
+}
+
+void json_doc_release(json_doc_t *doc)
+{
+    if (doc && doc->dynamic && doc->tokens) {
+        audio_free(doc->tokens);
+    }
+    if (doc) {
+        doc->tokens = NULL;
+        doc->token_num = 0;
+        doc->token_size = 0;
+    }
 }
@@ -0,0 +1,102 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) PTE LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include <string.h>
+
+#include "unity.h"
+
+#include "esp_log.h"
+#include "json_utils.h"
+
+static const char *TAG = "TEST_JSON_UTILS";
+
+static const char *test_json =
+    "{\"id\":\"results\","
+    "\"results\":[{\"alternatives\":[{\"transcript\":\"hello\",\"confidence\":97}]},"
+    "{\"alternatives\":[{\"transcript\":\"world\",\"confidence\":42}]}],"
+    "\"meta\":{\"tags\":[\"confidence\",\"transcript\"],\"count\":2}}";
+
+TEST_CASE("json_doc finds values by nested path", "[json_utils]")
+{
+    json_doc_t doc;
+    json_slice_t value;
+    int num = 0;
+    char buf[16];
+    TEST_ASSERT_EQUAL(ESP_OK, json_doc_parse(&doc, test_json, -1, NULL, 0));
+    ESP_LOGI(TAG, "Parsed %d tokens", doc.token_num);
+
+    TEST_ASSERT_EQUAL(0, json_doc_find(&doc, ""));
+    TEST_ASSERT_EQUAL(ESP_OK, json_doc_get(&doc, "results[0].alternatives[0].transcript", &value));
+    TEST_ASSERT_TRUE(json_slice_equal(&value, "hello"));
+    TEST_ASSERT_EQUAL(ESP_OK, json_doc_get_int(&doc, "results[1].alternatives[0].confidence", &num));
+    TEST_ASSERT_EQUAL(42, num);
+    TEST_ASSERT_EQUAL(ESP_OK, json_doc_get_int(&doc, "meta.count", &num));
+    TEST_ASSERT_EQUAL(2, num);
+    TEST_ASSERT_EQUAL(10, json_doc_copy(&doc, "meta.tags[1]", buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING("transcript", buf);
+
+    json_doc_release(&doc);
+}
+
+TEST_CASE("json_doc reports missing keys and indexes", "[json_utils]")
+{
+    json_doc_t doc;
+    json_slice_t value;
+    TEST_ASSERT_EQUAL(ESP_OK, json_doc_parse(&doc, test_json, -1, NULL, 0));
+
+    TEST_ASSERT_EQUAL(-1, json_doc_find(&doc, "missing"));
+    TEST_ASSERT_EQUAL(-1, json_doc_find(&doc, "meta.missing"));
+    TEST_ASSERT_EQUAL(-1, json_doc_find(&doc, "results[2]"));
+    TEST_ASSERT_EQUAL(-1, json_doc_find(&doc, "results[0].alternatives[1]"));
+    TEST_ASSERT_EQUAL(-1, json_doc_find(&doc, "meta[0]"));
+    TEST_ASSERT_EQUAL(-1, json_doc_find(&doc, "results.alternatives"));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, json_doc_get(&doc, "results[0].transcript", &value));
+
+    json_doc_release(&doc);
+}
+
+TEST_CASE("json_doc does not match values that look like keys", "[json_utils]")
+{
+    json_doc_t doc;
+    json_slice_t value;
+    jsmntok_t tokens[16];
+    // "id" holds the string "results" and "meta.tags" holds key names, only real keys may match
+    TEST_ASSERT_EQUAL(ESP_OK, json_doc_parse(&doc, test_json, -1, NULL, 0));
+    TEST_ASSERT_EQUAL(ESP_OK, json_doc_get(&doc, "results", &value));
+    TEST_ASSERT_EQUAL(JSMN_ARRAY, value.type);
+    TEST_ASSERT_EQUAL(-1, json_doc_find(&doc, "meta.transcript"));
+    TEST_ASSERT_EQUAL(-1, json_doc_find(&doc, "meta.confidence"));
+    json_doc_release(&doc);
+
+    // Primitive values are never keys either
+    const char *json = "{\"a\":true,\"b\":{\"true\":1,\"c\":\"true\"}}";
+    TEST_ASSERT_EQUAL(ESP_OK, json_doc_parse(&doc, json, -1, tokens, sizeof(tokens) / sizeof(tokens[0])));
+    TEST_ASSERT_EQUAL(-1, json_doc_find(&doc, "true"));
+    TEST_ASSERT_EQUAL(ESP_OK, json_doc_get(&doc, "b.true", &value));
+    TEST_ASSERT_TRUE(json_slice_equal(&value, "1"));
+    TEST_ASSERT_EQUAL(ESP_OK, json_doc_get(&doc, "b.c", &value));
+    TEST_ASSERT_TRUE(json_slice_equal(&value, "true"));
+    json_doc_release(&doc);
+}
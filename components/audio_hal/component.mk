@@ -7,6 +7,8 @@ COMPONENT_ADD_INCLUDEDIRS := ./include ./driver/include
 COMPONENT_SRCDIRS := .
 COMPONENT_PRIV_INCLUDEDIRS := ./driver/include
 
+COMPONENT_SRCDIRS += ./driver/codec_regmap
+
 COMPONENT_ADD_INCLUDEDIRS += ./driver/es8388 ./driver/es8374
 COMPONENT_SRCDIRS += ./driver/es8388 ./driver/es8374
 
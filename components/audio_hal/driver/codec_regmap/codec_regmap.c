@@ -0,0 +1,207 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <string.h>
+#include "esp_log.h"
+#include "audio_error.h"
+#include "audio_mem.h"
+#include "codec_regmap.h"
+
+#define REGMAP_MAX_REG      (256)
+#define REGMAP_WORDS        (REGMAP_MAX_REG / 32)
+#define BIT_TEST(m, r)      (((m)[(r) >> 5] >> ((r) & 31)) & 1)
+#define BIT_SET(m, r)       ((m)[(r) >> 5] |= (1UL << ((r) & 31)))
+#define BIT_CLR(m, r)       ((m)[(r) >> 5] &= ~(1UL << ((r) & 31)))
+
+static const char *TAG = "CODEC_REGMAP";
+
+struct codec_regmap {
+    codec_regmap_cfg_t      cfg;
+    int                     batch_depth;
+    uint32_t                valid[REGMAP_WORDS];
+    uint32_t                dirty[REGMAP_WORDS];
+    codec_regmap_stats_t    stats;
+    uint8_t                 cache[];
+};
+
+static inline bool regmap_cached(codec_regmap_handle_t map, uint8_t reg)
+{
+    return reg < map->cfg.reg_num && (map->cfg.is_volatile == NULL || map->cfg.is_volatile(reg) == false);
+}
+
+static esp_err_t regmap_xfer_write(codec_regmap_handle_t map, uint8_t reg, uint8_t *data, int len)
+{
+    map->stats.write_xfer++;
+    return i2c_bus_write_bytes(map->cfg.bus, map->cfg.addr, &reg, sizeof(reg), data, len);
+}
+
+static esp_err_t regmap_set(codec_regmap_handle_t map, uint8_t reg, uint8_t val, bool force)
+{
+    map->stats.write_req++;
+    if (!regmap_cached(map, reg)) {
+        return regmap_xfer_write(map, reg, &val, 1);
+    }
+    if (!force && BIT_TEST(map->valid, reg) && map->cache[reg] == val) {
+        map->stats.skipped++;
+        return ESP_OK;
+    }
+    map->cache[reg] = val;
+    BIT_SET(map->valid, reg);
+    if (map->batch_depth) {
+        BIT_SET(map->dirty, reg);
+        return ESP_OK;
+    }
+    if (regmap_xfer_write(map, reg, &map->cache[reg], 1) != ESP_OK) {
+        BIT_CLR(map->valid, reg);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+codec_regmap_handle_t codec_regmap_create(const codec_regmap_cfg_t *cfg)
+{
+    AUDIO_NULL_CHECK(TAG, cfg, return NULL);
+    if (cfg->reg_num <= 0 || cfg->reg_num > REGMAP_MAX_REG) {
+        ESP_LOGE(TAG, "Invalid register number %d", cfg->reg_num);
+        return NULL;
+    }
+    codec_regmap_handle_t map = audio_calloc(1, sizeof(struct codec_regmap) + cfg->reg_num);
+    AUDIO_MEM_CHECK(TAG, map, return NULL);
+    map->cfg = *cfg;
+    if (map->cfg.max_burst < 1) {
+        map->cfg.max_burst = 1;
+    }
+    return map;
+}
+
+esp_err_t codec_regmap_destroy(codec_regmap_handle_t map)
+{
+    AUDIO_NULL_CHECK(TAG, map, return ESP_ERR_INVALID_ARG);
+    audio_free(map);
+    return ESP_OK;
+}
+
+esp_err_t codec_regmap_write(codec_regmap_handle_t map, uint8_t reg, uint8_t val)
+{
+    AUDIO_NULL_CHECK(TAG, map, return ESP_ERR_INVALID_ARG);
+    return regmap_set(map, reg, val, false);
+}
+
+esp_err_t codec_regmap_write_force(codec_regmap_handle_t map, uint8_t reg, uint8_t val)
+{
+    AUDIO_NULL_CHECK(TAG, map, return ESP_ERR_INVALID_ARG);
+    return regmap_set(map, reg, val, true);
+}
+
+esp_err_t codec_regmap_read(codec_regmap_handle_t map, uint8_t reg, uint8_t *val)
+{
+    AUDIO_NULL_CHECK(TAG, map, return ESP_ERR_INVALID_ARG);
+    AUDIO_NULL_CHECK(TAG, val, return ESP_ERR_INVALID_ARG);
+    map->stats.read_req++;
+    bool cached = regmap_cached(map, reg);
+    if (cached && BIT_TEST(map->valid, reg)) {
+        map->stats.cache_hit++;
+        *val = map->cache[reg];
+        return ESP_OK;
+    }
+    map->stats.read_xfer++;
+    if (i2c_bus_read_bytes(map->cfg.bus, map->cfg.addr, &reg, sizeof(reg), val, 1) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    if (cached) {
+        map->cache[reg] = *val;
+        BIT_SET(map->valid, reg);
+    }
+    return ESP_OK;
+}
+
+esp_err_t codec_regmap_update_bits(codec_regmap_handle_t map, uint8_t reg, uint8_t mask, uint8_t val)
+{
+    uint8_t old = 0;
+    esp_err_t ret = codec_regmap_read(map, reg, &old);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return regmap_set(map, reg, (old & ~mask) | (val & mask), false);
+}
+
+esp_err_t codec_regmap_batch_begin(codec_regmap_handle_t map)
+{
+    AUDIO_NULL_CHECK(TAG, map, return ESP_ERR_INVALID_ARG);
+    map->batch_depth++;
+    return ESP_OK;
+}
+
+esp_err_t codec_regmap_batch_commit(codec_regmap_handle_t map)
+{
+    AUDIO_NULL_CHECK(TAG, map, return ESP_ERR_INVALID_ARG);
+    if (map->batch_depth == 0) {
+        ESP_LOGW(TAG, "Commit without batch");
+        return ESP_OK;
+    }
+    if (--map->batch_depth) {
+        return ESP_OK;
+    }
+    esp_err_t ret = ESP_OK;
+    int reg = 0;
+    while (reg < map->cfg.reg_num) {
+        if (map->dirty[reg >> 5] == 0) {
+            reg = (reg | 31) + 1;
+            continue;
+        }
+        if (!BIT_TEST(map->dirty, reg)) {
+            reg++;
+            continue;
+        }
+        int len = 0;
+        while (reg + len < map->cfg.reg_num && len < map->cfg.max_burst && BIT_TEST(map->dirty, reg + len)) {
+            BIT_CLR(map->dirty, reg + len);
+            len++;
+        }
+        if (regmap_xfer_write(map, reg, &map->cache[reg], len) != ESP_OK) {
+            ESP_LOGE(TAG, "Write 0x%02x, %d registers failed", reg, len);
+            for (int i = 0; i < len; i++) {
+                BIT_CLR(map->valid, reg + i);
+            }
+            ret = ESP_FAIL;
+        }
+        reg += len;
+    }
+    return ret;
+}
+
+esp_err_t codec_regmap_invalidate(codec_regmap_handle_t map)
+{
+    AUDIO_NULL_CHECK(TAG, map, return ESP_ERR_INVALID_ARG);
+    memset(map->valid, 0, sizeof(map->valid));
+    memset(map->dirty, 0, sizeof(map->dirty));
+    return ESP_OK;
+}
+
+esp_err_t codec_regmap_get_stats(codec_regmap_handle_t map, codec_regmap_stats_t *stats)
+{
+    AUDIO_NULL_CHECK(TAG, map, return ESP_ERR_INVALID_ARG);
+    AUDIO_NULL_CHECK(TAG, stats, return ESP_ERR_INVALID_ARG);
+    *stats = map->stats;
+    return ESP_OK;
+}
@@ -0,0 +1,4 @@
+#!/usr/bin/perl
+# Run the register map and the es8388 driver on host, the I2C bus is replaced by i2c_bus_mock.c and stub/
+my @f = ("../codec_regmap.c", "../../es8388/es8388.c", "../../../audio_volume.c");
+`gcc @f i2c_bus_mock.c test.c -Istub -I../../../../../tools/host_test/stub -I../../../../../tools/host_test/include -I../../include -I../../es8388 -I../../../include -g -O2 -Wall -o ./test -lm`;
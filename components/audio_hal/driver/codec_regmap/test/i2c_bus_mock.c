@@ -0,0 +1,68 @@
+/* Host mock of i2c_bus, counts the transactions and keeps the register file of the emulated chip */
+#include <string.h>
+#include "i2c_bus.h"
+#include "board.h"
+
+i2c_bus_mock_t i2c_bus_mock;
+
+void i2c_bus_mock_reset(void)
+{
+    memset(&i2c_bus_mock, 0, sizeof(i2c_bus_mock));
+}
+
+i2c_bus_handle_t i2c_bus_create(i2c_port_t port, i2c_config_t *conf)
+{
+    return &i2c_bus_mock;
+}
+
+esp_err_t i2c_bus_delete(i2c_bus_handle_t bus)
+{
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_write_bytes(i2c_bus_handle_t bus, int addr, uint8_t *reg, int regLen, uint8_t *data, int datalen)
+{
+    i2c_bus_mock.write_xfer++;
+    if (i2c_bus_mock.fail_next) {
+        i2c_bus_mock.fail_next--;
+        return ESP_FAIL;
+    }
+    for (int i = 0; i < datalen; i++) {
+        i2c_bus_mock.regs[(uint8_t)(*reg + i)] = data[i];
+    }
+    i2c_bus_mock.write_bytes += datalen;
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_read_bytes(i2c_bus_handle_t bus, int addr, uint8_t *reg, int regLen, uint8_t *outdata, int datalen)
+{
+    i2c_bus_mock.read_xfer++;
+    if (i2c_bus_mock.fail_next) {
+        i2c_bus_mock.fail_next--;
+        return ESP_FAIL;
+    }
+    for (int i = 0; i < datalen; i++) {
+        outdata[i] = i2c_bus_mock.regs[(uint8_t)(*reg + i)];
+    }
+    return ESP_OK;
+}
+
+esp_err_t get_i2c_pins(i2c_port_t port, i2c_config_t *i2c_config)
+{
+    return ESP_OK;
+}
+
+int8_t get_pa_enable_gpio(void)
+{
+    return 21;
+}
+
+esp_err_t gpio_config(const gpio_config_t *cfg)
+{
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(int gpio_num, uint32_t level)
+{
+    return ESP_OK;
+}
@@ -0,0 +1,8 @@
+/* Host shim of the board definitions used by the es8388 driver */
+#pragma once
+#include "driver/i2c.h"
+
+#define BOARD_PA_GAIN       (10)
+
+esp_err_t get_i2c_pins(i2c_port_t port, i2c_config_t *i2c_config);
+int8_t get_pa_enable_gpio(void);
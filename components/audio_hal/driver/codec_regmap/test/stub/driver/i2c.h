@@ -0,0 +1,42 @@
+/* Host shim of the IDF I2C and GPIO driver declarations used by the codec drivers */
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include "esp_err.h"
+
+#define BIT64(nr)           (1ULL << (nr))
+#define ets_printf          printf
+
+typedef int i2c_port_t;
+#define I2C_NUM_0           (0)
+
+typedef enum {
+    I2C_MODE_SLAVE = 0,
+    I2C_MODE_MASTER,
+} i2c_mode_t;
+
+#define GPIO_PULLUP_ENABLE  (1)
+
+typedef struct {
+    i2c_mode_t mode;
+    int sda_io_num;
+    int scl_io_num;
+    int sda_pullup_en;
+    int scl_pullup_en;
+    struct {
+        uint32_t clk_speed;
+    } master;
+} i2c_config_t;
+
+#define GPIO_MODE_OUTPUT    (2)
+
+typedef struct {
+    uint64_t pin_bit_mask;
+    int mode;
+    int pull_up_en;
+    int pull_down_en;
+    int intr_type;
+} gpio_config_t;
+
+esp_err_t gpio_config(const gpio_config_t *cfg);
+esp_err_t gpio_set_level(int gpio_num, uint32_t level);
@@ -0,0 +1,9 @@
+/* Host shim of the FreeRTOS types named by the audio_hal headers */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+typedef uint32_t TickType_t;
+typedef void    *xSemaphoreHandle;
@@ -0,0 +1,24 @@
+/* Host mock of the esp_peripherals i2c_bus, see i2c_bus_mock.c */
+#pragma once
+#include <stdint.h>
+#include "driver/i2c.h"
+
+typedef void *i2c_bus_handle_t;
+
+i2c_bus_handle_t i2c_bus_create(i2c_port_t port, i2c_config_t *conf);
+esp_err_t i2c_bus_write_bytes(i2c_bus_handle_t bus, int addr, uint8_t *reg, int regLen, uint8_t *data, int datalen);
+esp_err_t i2c_bus_read_bytes(i2c_bus_handle_t bus, int addr, uint8_t *reg, int regLen, uint8_t *outdata, int datalen);
+esp_err_t i2c_bus_delete(i2c_bus_handle_t bus);
+
+/* Mock side, one emulated chip whose register address auto-increments within a transaction */
+typedef struct {
+    uint32_t write_xfer;
+    uint32_t read_xfer;
+    uint32_t write_bytes;
+    uint8_t  regs[256];
+    int      fail_next;     /* Number of coming transactions to fail */
+} i2c_bus_mock_t;
+
+extern i2c_bus_mock_t i2c_bus_mock;
+
+void i2c_bus_mock_reset(void);
@@ -0,0 +1,251 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "i2c_bus.h"
+#include "codec_regmap.h"
+#include "es8388.h"
+#include "audio_volume.h"
+#include "host_test.h"
+
+/*
+ * Check the register map against a plain model with random traffic, then count the I2C
+ * transactions of the es8388 driver for a board init and volume sweeps on a mock bus.
+ */
+#define MAP_REG_NUM     (48)
+#define MAP_VOLATILE    (0x20)
+#define STEPS           (200000)
+
+/* Transactions of the write-through es8388 driver for the same sequences, one per register access */
+#define LEGACY_INIT_XFER    (47)
+#define LEGACY_SWITCH_XFER  (21)
+
+static bool map_volatile(uint8_t reg)
+{
+    return reg == MAP_VOLATILE;
+}
+
+static codec_regmap_handle_t map_create(int max_burst)
+{
+    codec_regmap_cfg_t cfg = {
+        .bus = i2c_bus_create(I2C_NUM_0, NULL),
+        .addr = 0x20,
+        .reg_num = MAP_REG_NUM,
+        .max_burst = max_burst,
+        .is_volatile = map_volatile,
+    };
+    return codec_regmap_create(&cfg);
+}
+
+static void test_basic(void)
+{
+    i2c_bus_mock_reset();
+    codec_regmap_handle_t map = map_create(8);
+    CHECK(map);
+    uint8_t v = 0;
+
+    // Write through, then no-op writes and cached reads cost nothing
+    CHECK(codec_regmap_write(map, 1, 0x55) == ESP_OK);
+    CHECK(codec_regmap_write(map, 1, 0x55) == ESP_OK);
+    CHECK(codec_regmap_read(map, 1, &v) == ESP_OK && v == 0x55);
+    CHECK(i2c_bus_mock.write_xfer == 1 && i2c_bus_mock.read_xfer == 0);
+    CHECK(codec_regmap_write_force(map, 1, 0x55) == ESP_OK);
+    CHECK(i2c_bus_mock.write_xfer == 2);
+
+    // First read fetches, the second hits the cache, volatile and out of range always fetch
+    i2c_bus_mock.regs[2] = 0xA5;
+    CHECK(codec_regmap_read(map, 2, &v) == ESP_OK && v == 0xA5);
+    CHECK(codec_regmap_read(map, 2, &v) == ESP_OK && v == 0xA5);
+    CHECK(i2c_bus_mock.read_xfer == 1);
+    CHECK(codec_regmap_read(map, MAP_VOLATILE, &v) == ESP_OK);
+    CHECK(codec_regmap_read(map, MAP_VOLATILE, &v) == ESP_OK);
+    CHECK(codec_regmap_read(map, 0xFD, &v) == ESP_OK);
+    CHECK(codec_regmap_read(map, 0xFD, &v) == ESP_OK);
+    CHECK(i2c_bus_mock.read_xfer == 5);
+
+    // Update bits works on the cached value
+    CHECK(codec_regmap_update_bits(map, 2, 0x0F, 0x03) == ESP_OK);
+    CHECK(i2c_bus_mock.regs[2] == 0xA3 && i2c_bus_mock.read_xfer == 5);
+
+    // Nested batch, 10 contiguous registers go out as a burst of 8 and one of 2, volatile is not deferred
+    i2c_bus_mock.write_xfer = 0;
+    CHECK(codec_regmap_batch_begin(map) == ESP_OK);
+    CHECK(codec_regmap_batch_begin(map) == ESP_OK);
+    for (int i = 0; i < 10; i++) {
+        CHECK(codec_regmap_write(map, 8 + i, i) == ESP_OK);
+    }
+    CHECK(codec_regmap_write(map, 9, 0x99) == ESP_OK);
+    CHECK(codec_regmap_write(map, MAP_VOLATILE, 0x77) == ESP_OK);
+    CHECK(i2c_bus_mock.write_xfer == 1 && i2c_bus_mock.regs[MAP_VOLATILE] == 0x77);
+    CHECK(codec_regmap_batch_commit(map) == ESP_OK);
+    CHECK(i2c_bus_mock.write_xfer == 1);
+    CHECK(codec_regmap_batch_commit(map) == ESP_OK);
+    CHECK(i2c_bus_mock.write_xfer == 3);
+    CHECK(i2c_bus_mock.regs[9] == 0x99 && i2c_bus_mock.regs[17] == 9);
+
+    // A failed write drops the register from the cache so the same value is sent again
+    i2c_bus_mock.fail_next = 1;
+    CHECK(codec_regmap_write(map, 3, 0x33) == ESP_FAIL);
+    CHECK(codec_regmap_write(map, 3, 0x33) == ESP_OK);
+    CHECK(i2c_bus_mock.regs[3] == 0x33);
+    CHECK(codec_regmap_batch_begin(map) == ESP_OK);
+    CHECK(codec_regmap_write(map, 4, 0x44) == ESP_OK);
+    i2c_bus_mock.fail_next = 1;
+    CHECK(codec_regmap_batch_commit(map) == ESP_FAIL);
+    CHECK(codec_regmap_write(map, 4, 0x44) == ESP_OK);
+    CHECK(i2c_bus_mock.regs[4] == 0x44);
+
+    // Invalidate after a chip reset
+    i2c_bus_mock.regs[1] = 0;
+    CHECK(codec_regmap_invalidate(map) == ESP_OK);
+    CHECK(codec_regmap_read(map, 1, &v) == ESP_OK && v == 0);
+
+    codec_regmap_stats_t st;
+    CHECK(codec_regmap_get_stats(map, &st) == ESP_OK);
+    CHECK(st.skipped == 1 && st.cache_hit >= 3);
+    CHECK(codec_regmap_destroy(map) == ESP_OK);
+    printf("basic: pass\n");
+}
+
+static void test_random(void)
+{
+    uint8_t model[MAP_REG_NUM];
+    i2c_bus_mock_reset();
+    for (int i = 0; i < MAP_REG_NUM; i++) {
+        i2c_bus_mock.regs[i] = model[i] = rand();
+    }
+    codec_regmap_handle_t map = map_create(5);
+    CHECK(map);
+    int depth = 0;
+    for (int step = 0; step < STEPS; step++) {
+        uint8_t reg = rand() % MAP_REG_NUM;
+        uint8_t val = rand() % 4;
+        uint8_t v = 0;
+        switch (rand() % 8) {
+            case 0:
+            case 1:
+                CHECK(codec_regmap_write(map, reg, val) == ESP_OK);
+                model[reg] = val;
+                break;
+            case 2:
+                CHECK(codec_regmap_update_bits(map, reg, 0x0C, val << 2) == ESP_OK);
+                model[reg] = (model[reg] & ~0x0C) | (val << 2);
+                break;
+            case 3:
+            case 4:
+                CHECK(codec_regmap_read(map, reg, &v) == ESP_OK);
+                CHECK(v == model[reg]);
+                break;
+            case 5:
+                if (depth < 3) {
+                    codec_regmap_batch_begin(map);
+                    depth++;
+                }
+                break;
+            case 6:
+                if (depth) {
+                    CHECK(codec_regmap_batch_commit(map) == ESP_OK);
+                    depth--;
+                }
+                break;
+            default:
+                if (depth == 0) {
+                    CHECK(memcmp(model, i2c_bus_mock.regs, MAP_REG_NUM) == 0);
+                }
+                break;
+        }
+    }
+    while (depth--) {
+        CHECK(codec_regmap_batch_commit(map) == ESP_OK);
+    }
+    CHECK(memcmp(model, i2c_bus_mock.regs, MAP_REG_NUM) == 0);
+    codec_regmap_stats_t st;
+    codec_regmap_get_stats(map, &st);
+    printf("random: %u writes, %u reads requested, %u write and %u read transactions\n",
+           st.write_req, st.read_req, st.write_xfer, st.read_xfer);
+    codec_regmap_destroy(map);
+}
+
+static uint32_t bus_xfer(void)
+{
+    return i2c_bus_mock.write_xfer + i2c_bus_mock.read_xfer;
+}
+
+static void test_es8388(void)
+{
+    i2c_bus_mock_reset();
+    audio_hal_codec_config_t cfg = {
+        .adc_input = AUDIO_HAL_ADC_INPUT_LINE1,
+        .dac_output = AUDIO_HAL_DAC_OUTPUT_ALL,
+        .codec_mode = AUDIO_HAL_CODEC_MODE_BOTH,
+        .i2s_iface = {
+            .mode = AUDIO_HAL_MODE_SLAVE,
+            .fmt = AUDIO_HAL_I2S_NORMAL,
+            .samples = AUDIO_HAL_48K_SAMPLES,
+            .bits = AUDIO_HAL_BIT_LENGTH_16BITS,
+        },
+    };
+    CHECK(es8388_init(&cfg) == ESP_OK);
+    CHECK(es8388_config_i2s(cfg.codec_mode, &cfg.i2s_iface) == ESP_OK);
+    CHECK(es8388_set_voice_volume(AUDIO_HAL_VOL_DEFAULT) == ESP_OK);
+    CHECK(es8388_ctrl_state(AUDIO_HAL_CODEC_MODE_BOTH, AUDIO_HAL_CTRL_START) == ESP_OK);
+    printf("es8388 board init: %u transactions, legacy %d transactions\n", bus_xfer(), LEGACY_INIT_XFER);
+    CHECK(bus_xfer() < LEGACY_INIT_XFER);
+    CHECK(i2c_bus_mock.regs[ES8388_CHIPPOWER] == 0x00);
+    CHECK(i2c_bus_mock.regs[ES8388_DACPOWER] == 0x3C);
+    CHECK(i2c_bus_mock.regs[ES8388_ADCPOWER] == 0x00);
+    CHECK(i2c_bus_mock.regs[ES8388_DACCONTROL1] == 0x18);
+    CHECK(i2c_bus_mock.regs[ES8388_ADCCONTROL4] == 0x0C);
+    CHECK(i2c_bus_mock.regs[ES8388_DACCONTROL3] == 0x00);
+    CHECK(i2c_bus_mock.regs[ES8388_DACCONTROL24] == 0x1E && i2c_bus_mock.regs[ES8388_DACCONTROL25] == 0x1E);
+
+    // Volume sweep up and down, the two DAC volume registers go in one burst per step
+    uint32_t start = bus_xfer();
+    int steps = 0;
+    for (int vol = 0; vol <= 100; vol++, steps++) {
+        CHECK(es8388_set_voice_volume(vol) == ESP_OK);
+    }
+    for (int vol = 100; vol >= 0; vol--, steps++) {
+        CHECK(es8388_set_voice_volume(vol) == ESP_OK);
+    }
+    printf("es8388 volume sweep: %d steps, %u transactions, legacy %d transactions\n",
+           steps, bus_xfer() - start, steps * 2);
+    CHECK(bus_xfer() - start <= steps);
+
+    // Setting the same volume again and reading it back stay off the bus
+    start = bus_xfer();
+    int vol = 0;
+    CHECK(es8388_set_voice_volume(60) == ESP_OK);
+    CHECK(bus_xfer() - start == 1);
+    for (int i = 0; i < 10; i++) {
+        CHECK(es8388_set_voice_volume(60) == ESP_OK);
+        CHECK(es8388_get_voice_volume(&vol) == ESP_OK && vol == 60);
+    }
+    CHECK(bus_xfer() - start == 1);
+    CHECK(i2c_bus_mock.regs[ES8388_DACCONTROL4] == i2c_bus_mock.regs[ES8388_DACCONTROL5]);
+
+    // Line in bypass switches and a mute toggle
+    start = bus_xfer();
+    CHECK(es8388_ctrl_state(AUDIO_HAL_CODEC_MODE_LINE_IN, AUDIO_HAL_CTRL_START) == ESP_OK);
+    CHECK(es8388_ctrl_state(AUDIO_HAL_CODEC_MODE_LINE_IN, AUDIO_HAL_CTRL_STOP) == ESP_OK);
+    CHECK(es8388_set_voice_mute(true) == ESP_OK);
+    CHECK(es8388_get_voice_mute() == 1);
+    CHECK(es8388_set_voice_mute(false) == ESP_OK);
+    printf("es8388 line in on/off and mute toggle: %u transactions, legacy %d transactions\n",
+           bus_xfer() - start, LEGACY_SWITCH_XFER);
+    CHECK(bus_xfer() - start < LEGACY_SWITCH_XFER);
+    CHECK(i2c_bus_mock.regs[ES8388_DACCONTROL16] == 0x00 && i2c_bus_mock.regs[ES8388_DACCONTROL17] == 0x90);
+    CHECK(i2c_bus_mock.regs[ES8388_DACCONTROL21] == 0x80 && i2c_bus_mock.regs[ES8388_DACCONTROL3] == 0x00);
+
+    CHECK(es8388_deinit() == ESP_OK);
+    CHECK(i2c_bus_mock.regs[ES8388_CHIPPOWER] == 0xFF);
+}
+
+int main(void)
+{
+    srand(1);
+    test_basic();
+    test_random();
+    test_es8388();
+    printf("PASS\n");
+    return 0;
+}
@@ -25,6 +25,7 @@
 #include <string.h>
 #include "esp_log.h"
 #include "i2c_bus.h"
+#include "codec_regmap.h"
 #include "es8388.h"
 #include "board.h"
 #include "audio_volume.h"
@@ -35,8 +36,13 @@
 
 static const char *ES_TAG = "ES8388_DRIVER";
 static i2c_bus_handle_t i2c_handle;
+static codec_regmap_handle_t es_regmap;
 static codec_dac_volume_config_t *dac_vol_handle;
 
+/* Registers 0x35 ~ 0x39 are not documented but written by the DLL setting of the init */
+#define ES8388_REG_NUM          (0x3A)
+#define ES8388_MAX_BURST        (16)
+
 #define ES8388_DAC_VOL_CFG_DEFAULT() {                      \
     .max_dac_volume = 0,                                    \
     .min_dac_volume = -96,                                  \
@@ -69,12 +75,12 @@ audio_hal_func_t AUDIO_CODEC_ES8388_DEFAULT_HANDLE = {
 
 static esp_err_t es_write_reg(uint8_t slave_addr, uint8_t reg_add, uint8_t data)
 {
-    return i2c_bus_write_bytes(i2c_handle, slave_addr, &reg_add, sizeof(reg_add), &data, sizeof(data));
+    return codec_regmap_write(es_regmap, reg_add, data);
 }
 
 static esp_err_t es_read_reg(uint8_t reg_add, uint8_t *p_data)
 {
-    return i2c_bus_read_bytes(i2c_handle, ES8388_ADDR, &reg_add, sizeof(reg_add), p_data, 1);
+    return codec_regmap_read(es_regmap, reg_add, p_data);
 }
 
 static int i2c_init()
@@ -89,14 +95,30 @@ static int i2c_init()
     res = get_i2c_pins(I2C_NUM_0, &es_i2c_cfg);
     ES_ASSERT(res, "getting i2c pins error", -1);
     i2c_handle = i2c_bus_create(I2C_NUM_0, &es_i2c_cfg);
+    ES_ASSERT(i2c_handle == NULL, "i2c bus create error", -1);
+    codec_regmap_cfg_t map_cfg = {
+        .bus = i2c_handle,
+        .addr = ES8388_ADDR,
+        .reg_num = ES8388_REG_NUM,
+        .max_burst = ES8388_MAX_BURST,
+        .is_volatile = NULL,
+    };
+    if (es_regmap) {
+        // Initialized again, the register cache is rebuilt from the chip
+        codec_regmap_destroy(es_regmap);
+    }
+    es_regmap = codec_regmap_create(&map_cfg);
+    ES_ASSERT(es_regmap == NULL, "register map create error", -1);
     return res;
 }
 
 void es8388_read_all()
 {
+    // Dump the chip, not the register cache
     for (int i = 0; i < 50; i++) {
         uint8_t reg = 0;
-        es_read_reg(i, &reg);
+        uint8_t reg_add = i;
+        i2c_bus_read_bytes(i2c_handle, ES8388_ADDR, &reg_add, sizeof(reg_add), &reg, 1);
         ets_printf("%x: %x\n", i, reg);
     }
 }
@@ -129,6 +151,7 @@ static int es8388_set_adc_dac_volume(int mode, int volume, int dot)
     }
     dot = (dot >= 5 ? 1 : 0);
     volume = (-volume << 1) + dot;
+    codec_regmap_batch_begin(es_regmap);
     if (mode == ES_MODULE_ADC || mode == ES_MODULE_ADC_DAC) {
         res |= es_write_reg(ES8388_ADDR, ES8388_ADCCONTROL8, volume);
         res |= es_write_reg(ES8388_ADDR, ES8388_ADCCONTROL9, volume);  //ADC Right Volume=0db
@@ -137,6 +160,7 @@ static int es8388_set_adc_dac_volume(int mode, int volume, int dot)
         res |= es_write_reg(ES8388_ADDR, ES8388_DACCONTROL5, volume);
         res |= es_write_reg(ES8388_ADDR, ES8388_DACCONTROL4, volume);
     }
+    res |= codec_regmap_batch_commit(es_regmap);
     return res;
 }
 
@@ -157,19 +181,22 @@ esp_err_t es8388_start(es_module_t mode)
     uint8_t prev_data = 0, data = 0;
     es_read_reg(ES8388_DACCONTROL21, &prev_data);
     if (mode == ES_MODULE_LINE) {
+        codec_regmap_batch_begin(es_regmap);
         res |= es_write_reg(ES8388_ADDR, ES8388_DACCONTROL16, 0x09); // 0x00 audio on LIN1&RIN1,  0x09 LIN2&RIN2 by pass enable
         res |= es_write_reg(ES8388_ADDR, ES8388_DACCONTROL17, 0x50); // left DAC to left mixer enable  and  LIN signal to left mixer enable 0db  : bupass enable
         res |= es_write_reg(ES8388_ADDR, ES8388_DACCONTROL20, 0x50); // right DAC to right mixer enable  and  LIN signal to right mixer enable 0db : bupass enable
         res |= es_write_reg(ES8388_ADDR, ES8388_DACCONTROL21, 0xC0); //enable adc
+        res |= codec_regmap_batch_commit(es_regmap);
     } else {
         res |= es_write_reg(ES8388_ADDR, ES8388_DACCONTROL21, 0x80);   //enable dac
     }
     es_read_reg(ES8388_DACCONTROL21, &data);
     if (prev_data != data) {
-        res |= es_write_reg(ES8388_ADDR, ES8388_CHIPPOWER, 0xF0);   //start state machine
+        // The restart is a pulse, both writes must reach the chip whatever the cache holds
+        res |= codec_regmap_write_force(es_regmap, ES8388_CHIPPOWER, 0xF0);   //start state machine
         // res |= es_write_reg(ES8388_ADDR, ES8388_CONTROL1, 0x16);
         // res |= es_write_reg(ES8388_ADDR, ES8388_CONTROL2, 0x50);
-        res |= es_write_reg(ES8388_ADDR, ES8388_CHIPPOWER, 0x00);   //start state machine
+        res |= codec_regmap_write_force(es_regmap, ES8388_CHIPPOWER, 0x00);   //start state machine
     }
     if (mode == ES_MODULE_ADC || mode == ES_MODULE_ADC_DAC || mode == ES_MODULE_LINE) {
         res |= es_write_reg(ES8388_ADDR, ES8388_ADCPOWER, 0x00);   //power up adc and line in
@@ -197,10 +224,13 @@ esp_err_t es8388_stop(es_module_t mode)
 {
     esp_err_t res = ESP_OK;
     if (mode == ES_MODULE_LINE) {
+        // DAC is enabled first, a burst would send DACCONTROL21 after the mixer registers
         res |= es_write_reg(ES8388_ADDR, ES8388_DACCONTROL21, 0x80); //enable dac
+        codec_regmap_batch_begin(es_regmap);
         res |= es_write_reg(ES8388_ADDR, ES8388_DACCONTROL16, 0x00); // 0x00 audio on LIN1&RIN1,  0x09 LIN2&RIN2
         res |= es_write_reg(ES8388_ADDR, ES8388_DACCONTROL17, 0x90); // only left DAC to left mixer enable 0db
         res |= es_write_reg(ES8388_ADDR, ES8388_DACCONTROL20, 0x90); // only right DAC to right mixer enable 0db
+        res |= codec_regmap_batch_commit(es_regmap);
         return res;
     }
     if (mode == ES_MODULE_DAC || mode == ES_MODULE_ADC_DAC) {
@@ -245,7 +275,9 @@ esp_err_t es8388_i2s_config_clock(es_i2s_clock_t cfg)
 esp_err_t es8388_deinit(void)
 {
     int res = 0;
-    res = es_write_reg(ES8388_ADDR, ES8388_CHIPPOWER, 0xFF);  //reset and stop es8388
+    res = codec_regmap_write_force(es_regmap, ES8388_CHIPPOWER, 0xFF);  //reset and stop es8388
+    codec_regmap_destroy(es_regmap);
+    es_regmap = NULL;
     i2c_bus_delete(i2c_handle);
 #ifdef CONFIG_ESP_LYRAT_V4_3_BOARD
     headphone_detect_deinit();
@@ -268,6 +300,7 @@ esp_err_t es8388_init(audio_hal_codec_config_t *cfg)
 #endif
 
     res = i2c_init(); // ESP32 in master mode
+    ES_ASSERT(res, "i2c init error", ESP_FAIL);
 
     res |= es_write_reg(ES8388_ADDR, ES8388_DACCONTROL3, 0x04);  // 0x04 mute/0x00 unmute&ramp;DAC unmute and  disabled digital volume control soft ramp
     /* Chip Control and Power Management */
@@ -284,6 +317,8 @@ esp_err_t es8388_init(audio_hal_codec_config_t *cfg)
     /* dac */
     res |= es_write_reg(ES8388_ADDR, ES8388_DACPOWER, 0xC0);  //disable DAC and disable Lout/Rout/1/2
     res |= es_write_reg(ES8388_ADDR, ES8388_CONTROL1, 0x12);  //Enfr=0,Play&Record Mode,(0x17-both of mic&paly)
+    // The DAC setting is order free while the DAC is powered down, send it in bursts
+    codec_regmap_batch_begin(es_regmap);
 //    res |= es_write_reg(ES8388_ADDR, ES8388_CONTROL2, 0);  //LPVrefBuf=0,Pdn_ana=0
     res |= es_write_reg(ES8388_ADDR, ES8388_DACCONTROL1, 0x18);//1a 0x18:16bit iis , 0x00:24
     res |= es_write_reg(ES8388_ADDR, ES8388_DACCONTROL2, 0x02);  //DACFsMode,SINGLE SPEED; DACFsRatio,256
@@ -297,6 +332,7 @@ esp_err_t es8388_init(audio_hal_codec_config_t *cfg)
     res |= es_write_reg(ES8388_ADDR, ES8388_DACCONTROL25, 0x1E);
     res |= es_write_reg(ES8388_ADDR, ES8388_DACCONTROL26, 0);
     res |= es_write_reg(ES8388_ADDR, ES8388_DACCONTROL27, 0);
+    res |= codec_regmap_batch_commit(es_regmap);
     // res |= es8388_set_adc_dac_volume(ES_MODULE_DAC, 0, 0);       // 0db
     int tmp = 0;
     if (AUDIO_HAL_DAC_OUTPUT_LINE2 == cfg->dac_output) {
@@ -309,6 +345,7 @@ esp_err_t es8388_init(audio_hal_codec_config_t *cfg)
     res |= es_write_reg(ES8388_ADDR, ES8388_DACPOWER, tmp);  //0x3c Enable DAC and Enable Lout/Rout/1/2
     /* adc */
     res |= es_write_reg(ES8388_ADDR, ES8388_ADCPOWER, 0xFF);
+    codec_regmap_batch_begin(es_regmap);
     res |= es_write_reg(ES8388_ADDR, ES8388_ADCCONTROL1, 0xbb); // MIC Left and Right channel PGA gain
     tmp = 0;
     if (AUDIO_HAL_ADC_INPUT_LINE1 == cfg->adc_input) {
@@ -324,6 +361,7 @@ esp_err_t es8388_init(audio_hal_codec_config_t *cfg)
     res |= es_write_reg(ES8388_ADDR, ES8388_ADCCONTROL5, 0x02);  //ADCFsMode,singel SPEED,RATIO=256
     //ALC for Microphone
     res |= es8388_set_adc_dac_volume(ES_MODULE_ADC, 0, 0);      // 0db
+    res |= codec_regmap_batch_commit(es_regmap);
     res |= es_write_reg(ES8388_ADDR, ES8388_ADCPOWER, 0x09);    // Power on ADC, enable LIN&RIN, power off MICBIAS, and set int1lp to low power mode
     
     /* es8388 PA gpio_config */
@@ -387,8 +425,10 @@ esp_err_t es8388_set_voice_volume(int volume)
     esp_err_t res = ESP_OK;
     uint8_t reg = 0;
     reg = audio_codec_get_dac_reg_value(dac_vol_handle, volume);
+    codec_regmap_batch_begin(es_regmap);
     res |= es_write_reg(ES8388_ADDR, ES8388_DACCONTROL5, reg);
     res |= es_write_reg(ES8388_ADDR, ES8388_DACCONTROL4, reg);
+    res |= codec_regmap_batch_commit(es_regmap);
     ESP_LOGD(ES_TAG, "Set volume:%.2d reg_value:0x%.2x dB:%.1f", dac_vol_handle->user_volume, reg,
             audio_codec_cal_dac_volume(dac_vol_handle));
     return res;
@@ -557,6 +597,7 @@ esp_err_t es8388_config_i2s(audio_hal_codec_mode_t mode, audio_hal_codec_i2s_ifa
 {
     esp_err_t res = ESP_OK;
     int tmp = 0;
+    codec_regmap_batch_begin(es_regmap);
     res |= es8388_config_fmt(ES_MODULE_ADC_DAC, iface->fmt);
     if (iface->bits == AUDIO_HAL_BIT_LENGTH_16BITS) {
         tmp = BIT_LENGTH_16BITS;
@@ -566,6 +607,7 @@ esp_err_t es8388_config_i2s(audio_hal_codec_mode_t mode, audio_hal_codec_i2s_ifa
         tmp = BIT_LENGTH_32BITS;
     }
     res |= es8388_set_bits_per_sample(ES_MODULE_ADC_DAC, tmp);
+    res |= codec_regmap_batch_commit(es_regmap);
     return res;
 }
 
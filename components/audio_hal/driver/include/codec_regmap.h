@@ -0,0 +1,208 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _CODEC_REGMAP_H_
+#define _CODEC_REGMAP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "i2c_bus.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Register map of a codec with 8 bits register addresses and 8 bits values
+ *
+ *        Registers below `reg_num` are kept in a shadow cache, reading them costs no I2C transaction
+ *        once they have been read or written, and writing the value the cache already holds is skipped.
+ *        Between `codec_regmap_batch_begin` and `codec_regmap_batch_commit` the writes only mark
+ *        the registers dirty, the commit flushes them in ascending address order and sends each run
+ *        of contiguous dirty registers as one burst when the chip auto-increments the address.
+ *        Volatile registers and registers from `reg_num` up always go straight to the chip.
+ *
+ * @note  The map is not locked, the calls on one map must be serialized by the caller,
+ *        which is what the `audio_hal` lock does for the codec drivers
+ */
+typedef struct codec_regmap *codec_regmap_handle_t;
+
+/**
+ * @brief Tells whether a register changes by itself (status, reset, ID), such registers are never cached
+ */
+typedef bool (*codec_regmap_volatile_cb_t)(uint8_t reg);
+
+/**
+ * @brief Register map configuration
+ */
+typedef struct {
+    i2c_bus_handle_t            bus;            /*!< I2C bus handle the codec is attached to */
+    int                         addr;           /*!< I2C address of the codec */
+    int                         reg_num;        /*!< Number of cached registers starting from address 0, 1 ~ 256 */
+    int                         max_burst;      /*!< Maximum registers per write transaction, 1 disables the bursts */
+    codec_regmap_volatile_cb_t  is_volatile;    /*!< Volatile registers filter, NULL if all the registers are cacheable */
+} codec_regmap_cfg_t;
+
+/**
+ * @brief Transaction statistics of a register map
+ */
+typedef struct {
+    uint32_t write_req;     /*!< Register writes requested by the driver */
+    uint32_t read_req;      /*!< Register reads requested by the driver */
+    uint32_t skipped;       /*!< Writes dropped because the register already held the value */
+    uint32_t cache_hit;     /*!< Reads served from the cache */
+    uint32_t write_xfer;    /*!< I2C write transactions issued */
+    uint32_t read_xfer;     /*!< I2C read transactions issued */
+} codec_regmap_stats_t;
+
+/**
+ * @brief Create a register map, the cache starts empty so the first access of every register reaches the chip
+ *
+ * @param cfg  Register map configuration
+ *
+ * @return
+ *     - NULL   Invalid configuration or no memory
+ *     - Others Register map handle
+ */
+codec_regmap_handle_t codec_regmap_create(const codec_regmap_cfg_t *cfg);
+
+/**
+ * @brief Destroy a register map, pending batch writes are dropped
+ *
+ * @param map  Register map handle
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_INVALID_ARG
+ */
+esp_err_t codec_regmap_destroy(codec_regmap_handle_t map);
+
+/**
+ * @brief Write a register, skipped if the cache already holds the value, deferred inside a batch
+ *
+ * @param map  Register map handle
+ * @param reg  Register address
+ * @param val  Register value
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_FAIL   I2C error, the register is dropped from the cache
+ */
+esp_err_t codec_regmap_write(codec_regmap_handle_t map, uint8_t reg, uint8_t val);
+
+/**
+ * @brief Write a register on the chip even if the cache holds the value, for strobe and reset bits
+ *
+ * @note  Inside a batch the write is only marked dirty, it is still sent by the commit
+ *
+ * @param map  Register map handle
+ * @param reg  Register address
+ * @param val  Register value
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_FAIL
+ */
+esp_err_t codec_regmap_write_force(codec_regmap_handle_t map, uint8_t reg, uint8_t val);
+
+/**
+ * @brief Read a register, from the cache when it holds the register
+ *
+ * @param      map  Register map handle
+ * @param      reg  Register address
+ * @param[out] val  Register value
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_FAIL
+ */
+esp_err_t codec_regmap_read(codec_regmap_handle_t map, uint8_t reg, uint8_t *val);
+
+/**
+ * @brief Read-modify-write the bits of `mask` of a register
+ *
+ * @param map   Register map handle
+ * @param reg   Register address
+ * @param mask  Bits to change
+ * @param val   New value of the masked bits
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_FAIL
+ */
+esp_err_t codec_regmap_update_bits(codec_regmap_handle_t map, uint8_t reg, uint8_t mask, uint8_t val);
+
+/**
+ * @brief Start deferring the writes, the batches nest and only the outermost commit flushes
+ *
+ * @note  The commit reorders the writes by address and keeps only the last value of each register,
+ *        sequences that rely on write order or on intermediate values must stay out of a batch
+ *
+ * @param map  Register map handle
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_INVALID_ARG
+ */
+esp_err_t codec_regmap_batch_begin(codec_regmap_handle_t map);
+
+/**
+ * @brief Close a batch, the outermost commit writes all the dirty registers
+ *
+ * @param map  Register map handle
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_FAIL   I2C error, the registers of the failed burst are dropped from the cache
+ */
+esp_err_t codec_regmap_batch_commit(codec_regmap_handle_t map);
+
+/**
+ * @brief Forget the cached values, needed after a chip reset restored the register defaults
+ *
+ * @param map  Register map handle
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_INVALID_ARG
+ */
+esp_err_t codec_regmap_invalidate(codec_regmap_handle_t map);
+
+/**
+ * @brief Get the transaction statistics
+ *
+ * @param      map    Register map handle
+ * @param[out] stats  Statistics
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_INVALID_ARG
+ */
+esp_err_t codec_regmap_get_stats(codec_regmap_handle_t map, codec_regmap_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _CODEC_REGMAP_H_ */
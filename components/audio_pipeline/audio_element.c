@@ -35,6 +35,7 @@
 #include "audio_mutex.h"
 #include "audio_error.h"
 #include "audio_thread.h"
+#include "pcm_splice.h"
 
 static const char *TAG = "AUDIO_ELEMENT";
 #define DEFAULT_MAX_WAIT_TIME       (2000/portTICK_RATE_MS)
@@ -123,6 +124,7 @@ struct audio_element {
     volatile bool               is_running;
     volatile bool               task_run;
     volatile bool               stopping;
+    pcm_splice_t                *splice;    /* Input ringbuffer switch for gapless playback, NULL until first used */
 };
 
 const static int STOPPED_BIT = BIT0;
@@ -221,6 +223,9 @@ static esp_err_t audio_element_on_cmd_error(audio_element_handle_t el)
 
 static esp_err_t audio_element_on_cmd_stop(audio_element_handle_t el)
 {
+    if (el->splice) {
+        pcm_splice_cancel(el->splice);
+    }
     if ((el->state != AEL_STATE_FINISHED) && (el->state != AEL_STATE_STOPPED)) {
         audio_element_process_deinit(el);
         el->state = AEL_STATE_STOPPED;
@@ -385,7 +390,16 @@ audio_element_err_t audio_element_input(audio_element_handle_t el, char *buffer,
             ESP_LOGE(TAG, "[%s] Read IO type ringbuf but ringbuf not set", el->tag);
             return ESP_FAIL;
         }
-        in_len = rb_read(el->in.input_rb, buffer, wanted_size, el->input_wait_time);
+        if (el->splice && el->splice->next && el->stopping == false) {
+            in_len = pcm_splice_read(el->splice, buffer, wanted_size, el->input_wait_time);
+            if (pcm_splice_current(el->splice) != el->in.input_rb) {
+                el->in.input_rb = (ringbuf_handle_t)pcm_splice_current(el->splice);
+                ESP_LOGI(TAG, "IN-[%s] spliced to rb:%p", el->tag, el->in.input_rb);
+                audio_element_report_status(el, AEL_STATUS_INPUT_SPLICED);
+            }
+        } else {
+            in_len = rb_read(el->in.input_rb, buffer, wanted_size, el->input_wait_time);
+        }
     } else {
         ESP_LOGE(TAG, "[%s] Invalid read IO type", el->tag);
         return ESP_FAIL;
@@ -668,7 +682,7 @@ esp_err_t audio_element_report_pos(audio_element_handle_t el)
         audio_event_iface_msg_t msg = { 0 };
         msg.cmd = AEL_MSG_CMD_REPORT_POSITION;
         if (el->report_info == NULL) {
-            el->report_info = audio_calloc(1, sizeof(audio_element_info_t));
+            el->report_info = audio_mem_calloc(1, sizeof(audio_element_info_t), AUDIO_MEM_CAPS_DEFAULT, "audio_element");
             AUDIO_MEM_CHECK(TAG, el->report_info, return ESP_ERR_NO_MEM);
         }
 
@@ -805,6 +819,73 @@ ringbuf_handle_t audio_element_get_input_ringbuf(audio_element_handle_t el)
     }
 }
 
+static int _splice_rb_read(void *rb, char *buf, int len, uint32_t wait)
+{
+    return rb_read((ringbuf_handle_t)rb, buf, len, wait);
+}
+
+static int _splice_rb_filled(void *rb)
+{
+    return rb_bytes_filled((ringbuf_handle_t)rb);
+}
+
+static bool _splice_rb_done(void *rb)
+{
+    return rb_is_done_write((ringbuf_handle_t)rb);
+}
+
+static const pcm_splice_ops_t splice_rb_ops = {
+    .read = _splice_rb_read,
+    .filled = _splice_rb_filled,
+    .done = _splice_rb_done,
+};
+
+esp_err_t audio_element_splice_input_ringbuf(audio_element_handle_t el, ringbuf_handle_t rb, int crossfade_ms)
+{
+    AUDIO_NULL_CHECK(TAG, el, return ESP_ERR_INVALID_ARG);
+    AUDIO_NULL_CHECK(TAG, rb, return ESP_ERR_INVALID_ARG);
+    if (el->read_type != IO_TYPE_RB || el->in.input_rb == NULL || el->in.input_rb == rb) {
+        ESP_LOGE(TAG, "[%s] Splice needs an input ringbuffer other than rb:%p", el->tag, rb);
+        return ESP_FAIL;
+    }
+    if (el->splice == NULL) {
+        el->splice = audio_calloc(1, sizeof(pcm_splice_t));
+        AUDIO_MEM_CHECK(TAG, el->splice, return ESP_ERR_NO_MEM);
+        pcm_splice_init(el->splice, &splice_rb_ops, el->in.input_rb);
+    }
+    if (el->splice->next) {
+        ESP_LOGE(TAG, "[%s] Splice to rb:%p is still pending", el->tag, el->splice->next);
+        return ESP_FAIL;
+    }
+    // Nothing reads the splice while no splice is pending, the current ringbuffer can be taken over
+    el->splice->cur = el->in.input_rb;
+    int channels = 0;
+    int frames = 0;
+    if (crossfade_ms > 0) {
+        audio_element_info_t info = { 0 };
+        audio_element_getinfo(el, &info);
+        if (info.bits == 16 && info.channels > 0 && info.sample_rates > 0) {
+            channels = info.channels;
+            frames = crossfade_ms * info.sample_rates / 1000;
+        } else {
+            ESP_LOGW(TAG, "[%s] Crossfade needs 16 bits samples, bits:%d, join the tracks without", el->tag, info.bits);
+        }
+    }
+    if (pcm_splice_queue(el->splice, rb, channels, frames) != 0) {
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "[%s] Splice rb:%p after rb:%p, crossfade %d frames", el->tag, rb, el->in.input_rb, frames);
+    return ESP_OK;
+}
+
+ringbuf_handle_t audio_element_get_splice_ringbuf(audio_element_handle_t el)
+{
+    if (el->splice) {
+        return (ringbuf_handle_t)el->splice->next;
+    }
+    return NULL;
+}
+
 esp_err_t audio_element_set_output_ringbuf(audio_element_handle_t el, ringbuf_handle_t rb)
 {
     if (rb) {
@@ -1068,6 +1149,11 @@ esp_err_t audio_element_deinit(audio_element_handle_t el)
     if (el->audio_thread) {
         audio_thread_cleanup(&el->audio_thread);
     }
+    if (el->splice) {
+        pcm_splice_cancel(el->splice);
+        audio_free(el->splice);
+        el->splice = NULL;
+    }
     mutex_destroy(el->lock);
     el->lock = NULL;
     audio_free(el);
@@ -1087,12 +1173,12 @@ esp_err_t audio_element_run(audio_element_handle_t el)
     audio_event_iface_discard(el->iface_event);
     xEventGroupClearBits(el->state_event, TASK_CREATED_BIT);
     if (el->task_stack > 0) {
-        ret = audio_thread_create(&el->audio_thread, el->tag, audio_element_task, el, el->task_stack,
+        ret = audio_thread_borrow(&el->audio_thread, el->tag, audio_element_task, el, el->task_stack,
                                   el->task_prio, el->stack_in_ext, el->task_core);
         if (ret == ESP_FAIL) {
             audio_element_force_set_state(el, AEL_STATE_ERROR);
             audio_element_report_status(el, AEL_STATUS_ERROR_OPEN);
-            ESP_LOGE(TAG, "[%s] audio_thread_create failed", el->tag);
+            ESP_LOGE(TAG, "[%s] audio_thread_borrow failed", el->tag);
             return ESP_FAIL;
         }
         EventBits_t uxBits = xEventGroupWaitBits(el->state_event, TASK_CREATED_BIT, false, true, DEFAULT_MAX_WAIT_TIME);
@@ -1020,3 +1020,75 @@ esp_err_t audio_pipeline_relink_more(audio_pipeline_handle_t pipeline, audio_ele
     va_end(args);
     return ESP_OK;
 }
+
+esp_err_t audio_pipeline_splice_next(audio_pipeline_handle_t pipeline, audio_element_handle_t sink, const char *uri, int crossfade_ms)
+{
+    AUDIO_NULL_CHECK(TAG, pipeline, return ESP_ERR_INVALID_ARG);
+    AUDIO_NULL_CHECK(TAG, sink, return ESP_ERR_INVALID_ARG);
+    AUDIO_NULL_CHECK(TAG, uri, return ESP_ERR_INVALID_ARG);
+    audio_element_item_t *el_item, *first = NULL, *tail = NULL;
+    STAILQ_FOREACH(el_item, &pipeline->el_list, next) {
+        if (el_item->linked == false) {
+            continue;
+        }
+        if (el_item->el == sink) {
+            break;
+        }
+        if (first == NULL) {
+            first = el_item;
+        }
+        tail = el_item;
+    }
+    if (tail == NULL || audio_element_get_input_ringbuf(sink) == NULL) {
+        ESP_LOGE(TAG, "Splice needs linked elements in front of a sink reading from a ringbuffer");
+        return ESP_FAIL;
+    }
+    ringbuf_handle_t rb = audio_element_get_output_ringbuf(tail->el);
+    if (audio_element_get_splice_ringbuf(sink)) {
+        ESP_LOGE(TAG, "[%s] has a splice pending", audio_element_get_tag(sink));
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (rb && rb == audio_element_get_input_ringbuf(sink)) {
+        ESP_LOGE(TAG, "[%s] still feeds [%s]", audio_element_get_tag(tail->el), audio_element_get_tag(sink));
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (rb == NULL) {
+        // A standby pipeline ends without a sink, give its last element the ringbuffer the sink will read
+        rb = rb_create(audio_element_get_output_ringbuf_size(tail->el), 1);
+        AUDIO_MEM_CHECK(TAG, rb, return ESP_ERR_NO_MEM);
+        add_rb_to_audio_pipeline(pipeline, rb, tail->el);
+        audio_element_set_output_ringbuf(tail->el, rb);
+    }
+    // Same sequence as stop, reset and run of a whole pipeline, limited to the elements in front of the sink
+    for (el_item = first; el_item && el_item->el != sink; el_item = STAILQ_NEXT(el_item, next)) {
+        if (el_item->linked == false) {
+            continue;
+        }
+        audio_element_state_t st = audio_element_get_state(el_item->el);
+        if (st == AEL_STATE_RUNNING || st == AEL_STATE_PAUSED) {
+            audio_element_stop(el_item->el);
+            audio_element_wait_for_stop(el_item->el);
+        }
+        audio_element_reset_state(el_item->el);
+        if (el_item != first) {
+            audio_element_reset_input_ringbuf(el_item->el);
+        }
+        el_item->el_state = AEL_STATUS_NONE;
+    }
+    rb_reset(rb);
+    esp_err_t ret = audio_element_splice_input_ringbuf(sink, rb, crossfade_ms);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    audio_element_set_uri(first->el, uri);
+    for (el_item = first; el_item && el_item->el != sink; el_item = STAILQ_NEXT(el_item, next)) {
+        if (el_item->linked == false) {
+            continue;
+        }
+        ret |= audio_element_run(el_item->el);
+        ret |= audio_element_resume(el_item->el, 0, 2000 / portTICK_RATE_MS);
+    }
+    audio_pipeline_change_state(pipeline, AEL_STATE_RUNNING);
+    ESP_LOGI(TAG, "Next track %s decodes ahead into rb:%p", uri, rb);
+    return ret == ESP_OK ? ESP_OK : ESP_FAIL;
+}
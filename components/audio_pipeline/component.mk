@@ -2,3 +2,6 @@
 # "main" pseudo-component makefile.
 #
 # (Uses default behaviour of compiling all source files in directory, adding 'include' to include path.)
+
+COMPONENT_SRCDIRS := . ./lib/pcm_splice
+COMPONENT_PRIV_INCLUDEDIRS := ./lib/pcm_splice/include
@@ -97,6 +97,7 @@ typedef enum {
     AEL_STATUS_STATE_FINISHED           = 15,
     AEL_STATUS_MOUNTED                  = 16,
     AEL_STATUS_UNMOUNTED                = 17,
+    AEL_STATUS_INPUT_SPLICED            = 18,   /*!< Input switched to the ringbuffer queued by `audio_element_splice_input_ringbuf` */
 } audio_element_status_t;
 
 typedef struct audio_element *audio_element_handle_t;
@@ -469,6 +470,37 @@ esp_err_t audio_element_set_input_ringbuf(audio_element_handle_t el, ringbuf_han
  */
 ringbuf_handle_t audio_element_get_input_ringbuf(audio_element_handle_t el);
 
+/**
+ * @brief      Queue a ringbuffer to take over the element input once the current input ringbuffer is done.
+ *             The element keeps running and reads on from `rb` within the same read,
+ *             it reports `AEL_STATUS_INPUT_SPLICED` when it switched.
+ *
+ * @note       With `crossfade_ms`, the end of the current input is mixed with the beginning of `rb`.
+ *             This needs 16-bit samples, the channels and sample rate are taken from the element info.
+ *             The crossfade is shortened to what the current input still holds when its writer is done.
+ *             A pending splice is dropped when the element stops.
+ *
+ * @param[in]  el            The audio element handle
+ * @param[in]  rb            The ringbuffer of the next track
+ * @param[in]  crossfade_ms  Crossfade length in milliseconds, 0 to join the tracks as they are
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_FAIL, the element does not read from a ringbuffer or a splice is still pending
+ *     - ESP_ERR_NO_MEM
+ *     - ESP_ERR_INVALID_ARG
+ */
+esp_err_t audio_element_splice_input_ringbuf(audio_element_handle_t el, ringbuf_handle_t rb, int crossfade_ms);
+
+/**
+ * @brief      Get the ringbuffer queued by `audio_element_splice_input_ringbuf` the element has not switched to yet
+ *
+ * @param[in]  el    The audio element handle
+ *
+ * @return     ringbuf_handle_t, NULL when no splice is pending
+ */
+ringbuf_handle_t audio_element_get_splice_ringbuf(audio_element_handle_t el);
+
 /**
  * @brief      Set Element output ringbuffer.
  *
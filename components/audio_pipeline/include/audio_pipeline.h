@@ -479,6 +479,33 @@ esp_err_t audio_pipeline_relink_more(audio_pipeline_handle_t pipeline, audio_ele
  */
 esp_err_t audio_pipeline_change_state(audio_pipeline_handle_t pipeline, audio_element_state_t new_state);
 
+/**
+ * @brief      Prepare the gapless playback of `uri` while the current track plays.
+ *             The linked elements of `pipeline` in front of `sink` (all of them when `sink` is not in `pipeline`)
+ *             are restarted on `uri` and decode ahead into the ringbuffer after the last of them.
+ *             `sink` switches to that ringbuffer when its current input is done and reports `AEL_STATUS_INPUT_SPLICED`,
+ *             the pipeline of the current track is neither stopped nor reset.
+ *
+ * @note       Two source chains take turns, e.g. `http-mp3-i2s` playing and a standby pipeline `http2-mp3_2`
+ *             without sink. Once `i2s` reports `AEL_STATUS_INPUT_SPLICED`, the first chain is free to take the track after.
+ *             The ringbuffer of a standby pipeline without sink is created by the first call and freed by `audio_pipeline_unlink`,
+ *             so `sink` must be stopped before that. Both tracks need the same sample format, see `audio_element_splice_input_ringbuf`
+ *             for the crossfade.
+ *
+ * @param[in]  pipeline      The Audio Pipeline Handle of the source chain for the next track
+ * @param[in]  sink          The element playing the current track
+ * @param[in]  uri           URI of the next track, set to the first element of the chain
+ * @param[in]  crossfade_ms  Crossfade length in milliseconds, 0 to join the tracks as they are
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_FAIL
+ *     - ESP_ERR_INVALID_STATE  The chain still feeds `sink`, or `sink` has a splice pending
+ *     - ESP_ERR_INVALID_ARG
+ *     - ESP_ERR_NO_MEM
+ */
+esp_err_t audio_pipeline_splice_next(audio_pipeline_handle_t pipeline, audio_element_handle_t sink, const char *uri, int crossfade_ms);
+
 
 #ifdef __cplusplus
 }
@@ -162,6 +162,16 @@ esp_err_t rb_done_write(ringbuf_handle_t rb);
  */
 esp_err_t rb_unblock_reader(ringbuf_handle_t rb);
 
+/**
+ * @brief      Check whether the writer has set the ringbuffer done, the data left can still be read
+ *
+ * @param[in]  rb    The Ringbuffer handle
+ *
+ * @return
+ *     - true
+ *     - false
+ */
+bool rb_is_done_write(ringbuf_handle_t rb);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,128 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef _PCM_SPLICE_H_
+#define _PCM_SPLICE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Splice of two PCM sources on the reading side. Reads go to the current source until it is done,
+ * then continue with the queued next source in the same call, so the reader sees one continuous stream.
+ * With a crossfade, the last frames of the current source are mixed with the first frames of the next one,
+ * this needs interleaved 16-bit samples.
+ */
+
+/**
+ * @brief Source operations, `src` is the handle given to `pcm_splice_init` or `pcm_splice_queue`
+ */
+typedef struct {
+    int  (*read)(void *src, char *buf, int len, uint32_t wait);    /*!< Read up to `len` bytes, <= 0 on done, abort or timeout */
+    int  (*filled)(void *src);                                     /*!< Bytes ready to read without blocking */
+    bool (*done)(void *src);                                       /*!< Writer of the source has finished */
+} pcm_splice_ops_t;
+
+typedef struct {
+    pcm_splice_ops_t    ops;
+    void                *cur;               /*!< Source being read */
+    void *volatile      next;               /*!< Source taking over, NULL when none is queued */
+    int                 frame_bytes;        /*!< Bytes of one frame of the crossfade */
+    int                 xfade_bytes;        /*!< Wanted crossfade length, 0 to splice without mixing */
+    int                 xfade_total;        /*!< Frames of the crossfade in progress, 0 when not mixing */
+    int                 xfade_pos;          /*!< Frames mixed so far */
+    char                *scratch;           /*!< Head of the next source while mixing */
+    int                 scratch_size;
+    uint32_t            spliced;            /*!< Number of completed splices */
+} pcm_splice_t;
+
+/**
+ * @brief Initialize a splice reading from `cur`
+ *
+ * @param sp   The splice
+ * @param ops  Source operations
+ * @param cur  Current source
+ *
+ * @return 0 or -1 on invalid arguments
+ */
+int pcm_splice_init(pcm_splice_t *sp, const pcm_splice_ops_t *ops, void *cur);
+
+/**
+ * @brief Queue the source to continue with once the current one is done
+ *
+ * @note  Can be called from another thread than the reader, `next` is published last.
+ *        The crossfade is shortened to what the current source still holds when it is done.
+ *
+ * @param sp           The splice
+ * @param next         Next source
+ * @param channels     Channels of the 16-bit samples, 0 to splice without mixing
+ * @param xfade_frames Frames to crossfade, 0 to splice without mixing
+ *
+ * @return 0, or -1 on invalid arguments or when a splice is already pending
+ */
+int pcm_splice_queue(pcm_splice_t *sp, void *next, int channels, int xfade_frames);
+
+/**
+ * @brief Read from the current source, switching to the next one when it is done
+ *
+ * @param sp    The splice
+ * @param buf   Output
+ * @param len   Bytes wanted
+ * @param wait  Passed to the read operation
+ *
+ * @return Bytes read, or the value <= 0 returned by the read operation
+ */
+int pcm_splice_read(pcm_splice_t *sp, char *buf, int len, uint32_t wait);
+
+/**
+ * @brief Mix `frames` frames of `head` into `tail` with a linear ramp from `pos` to `pos + frames` out of `total`
+ *
+ * @param tail      Fading out samples, overwritten with the mix
+ * @param head      Fading in samples
+ * @param channels  Samples per frame
+ * @param pos       Frames of the crossfade already mixed
+ * @param total     Frames of the whole crossfade
+ * @param frames    Frames to mix
+ */
+void pcm_splice_mix(int16_t *tail, const int16_t *head, int channels, int pos, int total, int frames);
+
+/**
+ * @brief Current source, it changes when `pcm_splice_read` completes a splice
+ */
+void *pcm_splice_current(pcm_splice_t *sp);
+
+/**
+ * @brief Drop a pending splice and free the scratch buffer, the current source is kept
+ */
+void pcm_splice_cancel(pcm_splice_t *sp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PCM_SPLICE_H_ */
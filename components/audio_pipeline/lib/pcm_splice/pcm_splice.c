@@ -0,0 +1,185 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "audio_mem.h"
+#include "pcm_splice.h"
+
+#define PCM_SPLICE_UNIT   (1 << 15)
+
+int pcm_splice_init(pcm_splice_t *sp, const pcm_splice_ops_t *ops, void *cur)
+{
+    if (sp == NULL || ops == NULL || ops->read == NULL || ops->filled == NULL || ops->done == NULL) {
+        return -1;
+    }
+    memset(sp, 0, sizeof(pcm_splice_t));
+    sp->ops = *ops;
+    sp->cur = cur;
+    return 0;
+}
+
+int pcm_splice_queue(pcm_splice_t *sp, void *next, int channels, int xfade_frames)
+{
+    if (sp == NULL || next == NULL || next == sp->cur || channels < 0 || xfade_frames < 0) {
+        return -1;
+    }
+    if (sp->next) {
+        return -1;
+    }
+    if (channels == 0 || xfade_frames == 0) {
+        sp->frame_bytes = 0;
+        sp->xfade_bytes = 0;
+    } else {
+        sp->frame_bytes = channels * sizeof(int16_t);
+        sp->xfade_bytes = xfade_frames * sp->frame_bytes;
+    }
+    sp->xfade_total = 0;
+    sp->xfade_pos = 0;
+    // The reader only looks at the other fields once it sees `next`
+    __sync_synchronize();
+    sp->next = next;
+    return 0;
+}
+
+void pcm_splice_mix(int16_t *tail, const int16_t *head, int channels, int pos, int total, int frames)
+{
+    for (int f = 0; f < frames; f++, pos++) {
+        // The two gains add up to unity, a sample equal on both sides passes unchanged
+        int32_t in = (int32_t)(((int64_t)pos * PCM_SPLICE_UNIT) / total);
+        int32_t out = PCM_SPLICE_UNIT - in;
+        for (int c = 0; c < channels; c++) {
+            *tail = (int16_t)((*tail * out + *head * in + (PCM_SPLICE_UNIT >> 1)) >> 15);
+            tail++;
+            head++;
+        }
+    }
+}
+
+static void pcm_splice_switch(pcm_splice_t *sp)
+{
+    sp->cur = sp->next;
+    sp->xfade_total = 0;
+    sp->xfade_pos = 0;
+    sp->spliced++;
+    __sync_synchronize();
+    sp->next = NULL;
+}
+
+static int pcm_splice_crossfade(pcm_splice_t *sp, char *buf, int len, uint32_t wait)
+{
+    int fb = sp->frame_bytes;
+    int want = (sp->xfade_total - sp->xfade_pos) * fb;
+    if (want > len) {
+        want = len / fb * fb;
+    }
+    if (want == 0) {
+        return sp->ops.read(sp->cur, buf, len, wait);
+    }
+    if (want > sp->scratch_size) {
+        char *scratch = audio_realloc(sp->scratch, want);
+        if (scratch == NULL) {
+            // Splice without mixing rather than fail the read
+            sp->xfade_total = 0;
+            sp->xfade_bytes = 0;
+            return sp->ops.read(sp->cur, buf, len, wait);
+        }
+        sp->scratch = scratch;
+        sp->scratch_size = want;
+    }
+    // The current source is done, what it holds is read at once
+    int n = sp->ops.read(sp->cur, buf, want, wait);
+    if (n < fb) {
+        return n;
+    }
+    n = n / fb * fb;
+    int got = 0;
+    while (got < n) {
+        int ret = sp->ops.read(sp->next, sp->scratch + got, n - got, wait);
+        if (ret <= 0) {
+            break;
+        }
+        got += ret;
+    }
+    if (got < n) {
+        // Next source is late or shorter than the fade, fade out into silence
+        memset(sp->scratch + got, 0, n - got);
+    }
+    int channels = fb / sizeof(int16_t);
+    pcm_splice_mix((int16_t *)buf, (const int16_t *)sp->scratch, channels, sp->xfade_pos, sp->xfade_total, n / fb);
+    sp->xfade_pos += n / fb;
+    if (sp->xfade_pos >= sp->xfade_total) {
+        pcm_splice_switch(sp);
+    }
+    return n;
+}
+
+int pcm_splice_read(pcm_splice_t *sp, char *buf, int len, uint32_t wait)
+{
+    if (sp->next == NULL) {
+        return sp->ops.read(sp->cur, buf, len, wait);
+    }
+    if (sp->xfade_total == 0 && sp->xfade_bytes > 0 && sp->ops.done(sp->cur)) {
+        int fb = sp->frame_bytes;
+        int avail = sp->ops.filled(sp->cur);
+        int xfade = avail / fb * fb;
+        if (xfade > sp->xfade_bytes) {
+            xfade = sp->xfade_bytes;
+        }
+        if (avail > xfade) {
+            // Stop right before the last `xfade` bytes, the fade covers whole frames at the end of the track
+            if (len > avail - xfade) {
+                len = avail - xfade;
+            }
+        } else if (xfade > 0) {
+            sp->xfade_total = xfade / fb;
+            sp->xfade_pos = 0;
+        }
+    }
+    if (sp->xfade_total) {
+        return pcm_splice_crossfade(sp, buf, len, wait);
+    }
+    int ret = sp->ops.read(sp->cur, buf, len, wait);
+    if (ret > 0 || sp->ops.done(sp->cur) == false || sp->ops.filled(sp->cur) > 0) {
+        return ret;
+    }
+    // Current source drained, carry on with the next one in the same read
+    pcm_splice_switch(sp);
+    return sp->ops.read(sp->cur, buf, len, wait);
+}
+
+void *pcm_splice_current(pcm_splice_t *sp)
+{
+    return sp->cur;
+}
+
+void pcm_splice_cancel(pcm_splice_t *sp)
+{
+    sp->next = NULL;
+    sp->xfade_total = 0;
+    sp->xfade_pos = 0;
+    audio_free(sp->scratch);
+    sp->scratch = NULL;
+    sp->scratch_size = 0;
+}
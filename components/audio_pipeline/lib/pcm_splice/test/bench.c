@@ -0,0 +1,278 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "ringbuf.h"
+#include "pcm_splice.h"
+
+/*
+ * Track transitions with file sources and the ringbuf.c of audio_pipeline on host. A sink thread plays
+ * 10 ms periods in real time, every frame it can't fill is counted as gap.
+ *   restart:   the sink reports the track done, the source is stopped, the ring reset and a new source started,
+ *              the sequence the player examples run around audio_pipeline_stop and audio_pipeline_run
+ *   splice:    the next file is opened and buffered on a standby ring while the current track plays,
+ *              the sink switches rings through pcm_splice
+ *   crossfade: same with a 10 ms crossfade
+ */
+#define BENCH_RATE          (48000)
+#define BENCH_CH            (2)
+#define BENCH_FRAME         (BENCH_CH * 2)
+#define BENCH_PERIOD        (BENCH_RATE / 100)
+#define BENCH_TRACK_FRAMES  (BENCH_RATE * 2 / 5 + 123)
+#define BENCH_TRACKS        (5)
+#define BENCH_RB_SIZE       (8 * 1024)
+#define BENCH_XFADE         (BENCH_RATE / 100)
+
+typedef enum {
+    MODE_RESTART,
+    MODE_SPLICE,
+    MODE_CROSSFADE,
+} bench_mode_t;
+
+typedef struct {
+    pthread_t        tid;
+    ringbuf_handle_t rb;
+    char             path[64];
+    bool             running;
+} bench_src_t;
+
+typedef struct {
+    bench_mode_t     mode;
+    ringbuf_handle_t rb;            /* Ring read by the restart mode */
+    pcm_splice_t     sp;
+    pthread_mutex_t  lock;
+    pthread_cond_t   cond;
+    int              finished;      /* Tracks the sink has seen the end of */
+    bool             stopped;       /* Sink waits for the restart */
+    long             played;
+    long             gap;
+    long             max_gap;
+    bool             end;
+} bench_sink_t;
+
+static void write_track(const char *path, int index)
+{
+    FILE *f = fopen(path, "wb");
+    uint8_t head[44] = { 'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E' };
+    fwrite(head, 1, sizeof(head), f);
+    for (int i = 0; i < BENCH_TRACK_FRAMES; i++) {
+        int16_t s = (int16_t)(8000 * sin(2 * M_PI * (220 * (index + 1)) * i / BENCH_RATE));
+        int16_t frame[BENCH_CH] = { s, s };
+        fwrite(frame, sizeof(frame), 1, f);
+    }
+    fclose(f);
+}
+
+static void *source_task(void *arg)
+{
+    bench_src_t *src = (bench_src_t *)arg;
+    char buf[2048];
+    FILE *f = fopen(src->path, "rb");
+    if (f == NULL || fread(buf, 1, 44, f) != 44 || memcmp(buf, "RIFF", 4)) {
+        fprintf(stderr, "bad fixture %s\n", src->path);
+        exit(1);
+    }
+    int n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        if (rb_write(src->rb, buf, n, portMAX_DELAY) < 0) {
+            break;
+        }
+    }
+    fclose(f);
+    rb_done_write(src->rb);
+    return NULL;
+}
+
+static void source_start(bench_src_t *src, ringbuf_handle_t rb, int track)
+{
+    src->rb = rb;
+    snprintf(src->path, sizeof(src->path), "fixture/track%d.wav", track);
+    src->running = true;
+    pthread_create(&src->tid, NULL, source_task, src);
+}
+
+static void source_stop(bench_src_t *src)
+{
+    if (src->running) {
+        rb_abort(src->rb);
+        pthread_join(src->tid, NULL);
+        src->running = false;
+    }
+}
+
+static int rb_ops_read(void *src, char *buf, int len, uint32_t wait)
+{
+    return rb_read((ringbuf_handle_t)src, buf, len, wait);
+}
+
+static int rb_ops_filled(void *src)
+{
+    return rb_bytes_filled((ringbuf_handle_t)src);
+}
+
+static bool rb_ops_done(void *src)
+{
+    return rb_is_done_write((ringbuf_handle_t)src);
+}
+
+static const pcm_splice_ops_t rb_ops = { rb_ops_read, rb_ops_filled, rb_ops_done };
+
+static void sink_notify(bench_sink_t *sink)
+{
+    pthread_mutex_lock(&sink->lock);
+    sink->finished++;
+    pthread_cond_signal(&sink->cond);
+    pthread_mutex_unlock(&sink->lock);
+}
+
+static void *sink_task(void *arg)
+{
+    bench_sink_t *sink = (bench_sink_t *)arg;
+    char period[BENCH_PERIOD * BENCH_FRAME];
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    uint32_t spliced = 0;
+    bool started = false;
+    while (!sink->end) {
+        int got = 0;
+        while (got < sizeof(period)) {
+            int n;
+            if (sink->mode == MODE_RESTART) {
+                if (sink->stopped) {
+                    break;
+                }
+                n = rb_read(sink->rb, period + got, sizeof(period) - got, 0);
+                if (n == RB_DONE) {
+                    sink->stopped = true;
+                    sink_notify(sink);
+                }
+            } else {
+                n = pcm_splice_read(&sink->sp, period + got, sizeof(period) - got, 0);
+                if (sink->sp.spliced != spliced) {
+                    spliced = sink->sp.spliced;
+                    sink_notify(sink);
+                }
+                if (n == RB_DONE) {
+                    sink_notify(sink);
+                }
+            }
+            if (n <= 0) {
+                break;
+            }
+            got += n;
+        }
+        if (got) {
+            started = true;
+        }
+        sink->played += got / BENCH_FRAME;
+        if (started && got < sizeof(period) && sink->finished < BENCH_TRACKS) {
+            long missing = (sizeof(period) - got) / BENCH_FRAME;
+            sink->gap += missing;
+        }
+        next.tv_nsec += 10 * 1000 * 1000;
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000L;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+    return NULL;
+}
+
+static void wait_finished(bench_sink_t *sink, int count)
+{
+    pthread_mutex_lock(&sink->lock);
+    while (sink->finished < count) {
+        pthread_cond_wait(&sink->cond, &sink->lock);
+    }
+    pthread_mutex_unlock(&sink->lock);
+}
+
+static void run(bench_mode_t mode, const char *name)
+{
+    static const int channels[] = { 0, 0, BENCH_CH };
+    static const int xfade[] = { 0, 0, BENCH_XFADE };
+    bench_sink_t sink = { .mode = mode };
+    bench_src_t src[2] = { 0 };
+    ringbuf_handle_t rb[2] = { rb_create(BENCH_RB_SIZE, 1), rb_create(BENCH_RB_SIZE, 1) };
+    pthread_mutex_init(&sink.lock, NULL);
+    pthread_cond_init(&sink.cond, NULL);
+    sink.rb = rb[0];
+    pcm_splice_init(&sink.sp, &rb_ops, rb[0]);
+    source_start(&src[0], rb[0], 0);
+    if (mode != MODE_RESTART) {
+        source_start(&src[1], rb[1], 1);
+        pcm_splice_queue(&sink.sp, rb[1], channels[mode], xfade[mode]);
+    }
+    pthread_t tid;
+    pthread_create(&tid, NULL, sink_task, &sink);
+    for (int t = 1; t < BENCH_TRACKS; t++) {
+        wait_finished(&sink, t);
+        if (mode == MODE_RESTART) {
+            // Stop, wait for stop, reset the ring, set the uri and run again
+            source_stop(&src[0]);
+            rb_reset(rb[0]);
+            source_start(&src[0], rb[0], t);
+            sink.stopped = false;
+        } else if (t + 1 < BENCH_TRACKS) {
+            // The ring of the track just ended is free, it takes the track after the next one
+            bench_src_t *idle = &src[(t + 1) % 2];
+            source_stop(idle);
+            rb_reset(idle->rb);
+            source_start(idle, idle->rb, t + 1);
+            pcm_splice_queue(&sink.sp, idle->rb, channels[mode], xfade[mode]);
+        }
+    }
+    wait_finished(&sink, BENCH_TRACKS);
+    sink.end = true;
+    pthread_join(tid, NULL);
+    source_stop(&src[0]);
+    source_stop(&src[1]);
+    long expect = (long)BENCH_TRACK_FRAMES * BENCH_TRACKS - (long)xfade[mode] * (BENCH_TRACKS - 1);
+    printf("%-10s played %7ld of %7ld frames, gap %6ld frames in %d transitions (%.2f ms each)\n",
+           name, sink.played, expect, sink.gap, BENCH_TRACKS - 1,
+           1000.0 * sink.gap / (BENCH_TRACKS - 1) / BENCH_RATE);
+    pcm_splice_cancel(&sink.sp);
+    rb_destroy(rb[0]);
+    rb_destroy(rb[1]);
+}
+
+int main(void)
+{
+    mkdir("fixture", 0755);
+    char path[64];
+    for (int i = 0; i < BENCH_TRACKS; i++) {
+        snprintf(path, sizeof(path), "fixture/track%d.wav", i);
+        write_track(path, i);
+    }
+    run(MODE_RESTART, "restart");
+    run(MODE_SPLICE, "splice");
+    run(MODE_CROSSFADE, "crossfade");
+    return 0;
+}
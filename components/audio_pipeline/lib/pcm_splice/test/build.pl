@@ -0,0 +1,5 @@
+#!/usr/bin/perl
+# Host test of the splice, and a gap benchmark with file sources over the ringbuf.c of audio_pipeline,
+# FreeRTOS semaphores are replaced by pthreads in stub/, the common stand-ins are in tools/host_test/stub
+`gcc ../pcm_splice.c test.c -I../../../../../tools/host_test/stub -I../include -g -Wall -o ./test`;
+`gcc ../pcm_splice.c ../../../ringbuf.c bench.c -Istub -I../../../../../tools/host_test/stub -I../include -I../../../include -O2 -Wall -pthread -o ./bench -lm`;
@@ -0,0 +1,15 @@
+/* Host shim of FreeRTOS for ringbuf.c, semaphores run on pthreads and a tick is a millisecond */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+typedef uint32_t TickType_t;
+typedef int      BaseType_t;
+
+#define pdTRUE              (1)
+#define pdFALSE             (0)
+#define portMAX_DELAY       (0xffffffffUL)
+#define portTICK_PERIOD_MS  (1)
+#define portTICK_RATE_MS    portTICK_PERIOD_MS
@@ -0,0 +1,72 @@
+#pragma once
+#include <errno.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include "freertos/FreeRTOS.h"
+
+typedef struct {
+    pthread_mutex_t m;
+    pthread_cond_t  c;
+    int             count;
+} stub_sem_t;
+
+typedef stub_sem_t *SemaphoreHandle_t;
+typedef stub_sem_t *xSemaphoreHandle;
+
+static inline stub_sem_t *stub_sem_create(int count)
+{
+    stub_sem_t *s = calloc(1, sizeof(stub_sem_t));
+    if (s) {
+        pthread_mutex_init(&s->m, NULL);
+        pthread_cond_init(&s->c, NULL);
+        s->count = count;
+    }
+    return s;
+}
+
+static inline BaseType_t xSemaphoreTake(stub_sem_t *s, TickType_t ticks)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ticks / 1000;
+    ts.tv_nsec += (ticks % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    pthread_mutex_lock(&s->m);
+    while (s->count == 0) {
+        if (ticks == portMAX_DELAY) {
+            pthread_cond_wait(&s->c, &s->m);
+        } else if (ticks == 0 || pthread_cond_timedwait(&s->c, &s->m, &ts) == ETIMEDOUT) {
+            break;
+        }
+    }
+    BaseType_t ret = pdFALSE;
+    if (s->count) {
+        s->count = 0;
+        ret = pdTRUE;
+    }
+    pthread_mutex_unlock(&s->m);
+    return ret;
+}
+
+static inline BaseType_t xSemaphoreGive(stub_sem_t *s)
+{
+    pthread_mutex_lock(&s->m);
+    s->count = 1;
+    pthread_cond_signal(&s->c);
+    pthread_mutex_unlock(&s->m);
+    return pdTRUE;
+}
+
+static inline void vSemaphoreDelete(stub_sem_t *s)
+{
+    pthread_mutex_destroy(&s->m);
+    pthread_cond_destroy(&s->c);
+    free(s);
+}
+
+#define xSemaphoreCreateBinary()    stub_sem_create(0)
+#define xSemaphoreCreateMutex()     stub_sem_create(1)
@@ -0,0 +1,233 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pcm_splice.h"
+
+#define TEST_ASSERT(cond, ...) if (!(cond)) {   \
+        printf("FAIL line %d: ", __LINE__);     \
+        printf(__VA_ARGS__);                    \
+        printf("\n");                           \
+        return -1;                              \
+    }
+
+#define SRC_DONE      (-2)
+#define SRC_TIMEOUT   (-4)
+
+// Memory source, `written` bytes are readable, the writer is done once all of `size` is written
+typedef struct {
+    int16_t *data;
+    int      size;
+    int      written;
+    int      pos;
+} test_src_t;
+
+static int src_read(void *src, char *buf, int len, uint32_t wait)
+{
+    test_src_t *s = (test_src_t *)src;
+    int n = s->written - s->pos;
+    if (n == 0) {
+        return s->written == s->size ? SRC_DONE : SRC_TIMEOUT;
+    }
+    if (n > len) {
+        n = len;
+    }
+    memcpy(buf, (char *)s->data + s->pos, n);
+    s->pos += n;
+    return n;
+}
+
+static int src_filled(void *src)
+{
+    test_src_t *s = (test_src_t *)src;
+    return s->written - s->pos;
+}
+
+static bool src_done(void *src)
+{
+    test_src_t *s = (test_src_t *)src;
+    return s->written == s->size;
+}
+
+static const pcm_splice_ops_t src_ops = { src_read, src_filled, src_done };
+
+static void src_init(test_src_t *s, int frames, int channels, int16_t base, int16_t step)
+{
+    s->size = frames * channels * sizeof(int16_t);
+    s->data = malloc(s->size);
+    for (int i = 0; i < frames * channels; i++) {
+        s->data[i] = base + step * (i / channels);
+    }
+    s->written = s->size;
+    s->pos = 0;
+}
+
+// Read everything through the splice in `chunk` bytes reads, returns the bytes read
+static int drain(pcm_splice_t *sp, int16_t *out, int max, int chunk)
+{
+    int total = 0;
+    while (total < max) {
+        int n = chunk < max - total ? chunk : max - total;
+        int ret = pcm_splice_read(sp, (char *)out + total, n, 0);
+        if (ret <= 0) {
+            break;
+        }
+        total += ret;
+    }
+    return total;
+}
+
+static int test_mix(void)
+{
+    int16_t tail[8] = { 1000, -1000, 1000, -1000, 1000, -1000, 1000, -1000 };
+    int16_t head[8] = { -1000, 1000, -1000, 1000, -1000, 1000, -1000, 1000 };
+    pcm_splice_mix(tail, head, 2, 0, 4, 4);
+    TEST_ASSERT(tail[0] == 1000 && tail[1] == -1000, "start must be all tail, %d %d", tail[0], tail[1]);
+    TEST_ASSERT(tail[4] == 0 && tail[5] == 0, "middle must be half and half, %d %d", tail[4], tail[5]);
+    TEST_ASSERT(tail[6] == -500 && tail[7] == 500, "3/4 of the fade, %d %d", tail[6], tail[7]);
+    int16_t a[2] = { 32767, -32768 };
+    int16_t b[2] = { 32767, -32768 };
+    pcm_splice_mix(a, b, 2, 1, 3, 1);
+    TEST_ASSERT(a[0] == 32767 && a[1] == -32768, "full scale must not wrap, %d %d", a[0], a[1]);
+    return 0;
+}
+
+static int test_splice(void)
+{
+    const int frames = 1000;
+    test_src_t a, b;
+    src_init(&a, frames, 2, 0, 1);
+    src_init(&b, frames, 2, frames, 1);
+    pcm_splice_t sp;
+    TEST_ASSERT(pcm_splice_init(&sp, &src_ops, &a) == 0, "init");
+    int16_t *out = calloc(4 * frames, sizeof(int16_t));
+    // Odd chunks, the splice happens inside a read
+    int n = drain(&sp, out, 300 * 4, 4 * 77);
+    TEST_ASSERT(n == 300 * 4, "read before queue, %d", n);
+    TEST_ASSERT(pcm_splice_queue(&sp, &b, 0, 0) == 0, "queue");
+    TEST_ASSERT(pcm_splice_queue(&sp, &b, 0, 0) == -1, "queue while pending");
+    n += drain(&sp, out + n / 2, 4 * frames * 2 - n, 4 * 77);
+    TEST_ASSERT(n == 4 * frames * 2, "gapless length, %d", n);
+    for (int i = 0; i < frames * 4; i++) {
+        TEST_ASSERT(out[i] == i / 2, "sample %d is %d", i, out[i]);
+    }
+    TEST_ASSERT(sp.spliced == 1 && pcm_splice_current(&sp) == &b, "splice not done");
+    TEST_ASSERT(pcm_splice_read(&sp, (char *)out, 4, 0) == SRC_DONE, "next must end as a plain source");
+    pcm_splice_cancel(&sp);
+    free(a.data);
+    free(b.data);
+    free(out);
+    return 0;
+}
+
+static int test_crossfade(int xfade, int chunk)
+{
+    const int frames = 1000;
+    test_src_t a, b;
+    src_init(&a, frames, 2, 8000, 0);
+    src_init(&b, frames, 2, -8000, 0);
+    // Writer of `a` not done yet, the splice waits for it
+    a.written = 400 * 4;
+    pcm_splice_t sp;
+    pcm_splice_init(&sp, &src_ops, &a);
+    TEST_ASSERT(pcm_splice_queue(&sp, &b, 2, xfade) == 0, "queue");
+    int16_t *out = calloc(4 * frames, sizeof(int16_t));
+    int n = drain(&sp, out, 4 * frames * 2, chunk);
+    TEST_ASSERT(n == 400 * 4, "must stop at the writer, %d", n);
+    a.written = a.size;
+    n += drain(&sp, out + n / 2, 4 * frames * 2 - n, chunk);
+    TEST_ASSERT(n == 4 * (2 * frames - xfade), "crossfade length, %d", n);
+    for (int f = 0; f < 2 * frames - xfade; f++) {
+        int16_t l = out[2 * f], r = out[2 * f + 1];
+        TEST_ASSERT(l == r, "channels differ at %d", f);
+        if (f < frames - xfade) {
+            TEST_ASSERT(l == 8000, "tail changed at %d, %d", f, l);
+        } else if (f >= frames) {
+            TEST_ASSERT(l == -8000, "head changed at %d, %d", f, l);
+        } else {
+            int expect = 8000 - 16000 * (f - (frames - xfade)) / xfade;
+            TEST_ASSERT(abs(l - expect) <= 1, "ramp at %d is %d, expect %d", f, l, expect);
+        }
+    }
+    TEST_ASSERT(sp.spliced == 1 && sp.next == NULL, "splice not done");
+    pcm_splice_cancel(&sp);
+    free(a.data);
+    free(b.data);
+    free(out);
+    return 0;
+}
+
+static int test_short_tail(void)
+{
+    // Only 50 frames left when the current source is done, the 200 frames fade is shortened
+    test_src_t a, b;
+    src_init(&a, 100, 1, 1000, 0);
+    src_init(&b, 300, 1, 1000, 0);
+    pcm_splice_t sp;
+    pcm_splice_init(&sp, &src_ops, &a);
+    int16_t out[400];
+    int n = drain(&sp, out, 50 * 2, 64);
+    TEST_ASSERT(n == 100, "head read, %d", n);
+    pcm_splice_queue(&sp, &b, 1, 200);
+    n += drain(&sp, out + n / 2, sizeof(out) - n, 64);
+    TEST_ASSERT(n == 2 * (100 + 300 - 50), "shortened crossfade, %d", n);
+    for (int i = 0; i < n / 2; i++) {
+        TEST_ASSERT(out[i] == 1000, "equal sides must pass unchanged, %d: %d", i, out[i]);
+    }
+    free(a.data);
+    free(b.data);
+    pcm_splice_cancel(&sp);
+    return 0;
+}
+
+static int test_args(void)
+{
+    pcm_splice_t sp;
+    test_src_t a;
+    pcm_splice_ops_t ops = src_ops;
+    TEST_ASSERT(pcm_splice_init(NULL, &src_ops, &a) == -1, "NULL splice");
+    ops.done = NULL;
+    TEST_ASSERT(pcm_splice_init(&sp, &ops, &a) == -1, "missing op");
+    pcm_splice_init(&sp, &src_ops, &a);
+    TEST_ASSERT(pcm_splice_queue(&sp, NULL, 2, 10) == -1, "NULL next");
+    TEST_ASSERT(pcm_splice_queue(&sp, &a, 2, 10) == -1, "next is current");
+    TEST_ASSERT(pcm_splice_queue(&sp, &ops, -1, 10) == -1, "bad channels");
+    return 0;
+}
+
+int main(void)
+{
+    int ret = 0;
+    ret |= test_mix();
+    ret |= test_splice();
+    ret |= test_crossfade(100, 4 * 64);
+    ret |= test_crossfade(333, 4 * 1000);
+    ret |= test_crossfade(1, 6);
+    ret |= test_short_tail();
+    ret |= test_args();
+    printf("pcm_splice: %s\n", ret ? "FAILED" : "all tests passed");
+    return ret ? 1 : 0;
+}
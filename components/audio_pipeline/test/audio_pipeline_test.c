@@ -23,12 +23,16 @@
  */
 
 #include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
 #include "unity.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "audio_pipeline.h"
+#include "audio_thread.h"
 #include "esp_log.h"
 #include "esp_err.h"
+#include "esp_timer.h"
 
 static const char *TAG = "AUDIO_ELEMENT_TEST";
 
@@ -117,3 +121,209 @@ TEST_CASE("audio_pipeline", "esp-adf")
     TEST_ASSERT_EQUAL(ESP_OK, audio_element_deinit(last_el));
 
 }
+
+#define SPLICE_TRACKS        (4)
+#define SPLICE_TRACK_BYTES   (16 * 1024)
+
+typedef struct {
+    int      bytes;
+    int      errors;
+    int64_t  last_us;
+    int64_t  max_gap_us;
+} splice_sink_t;
+
+// Track N carries the 16-bit word counter of the whole playlist from N * SPLICE_TRACK_BYTES / 2 on
+static int _splice_src_read(audio_element_handle_t self, char *buffer, int len, TickType_t ticks_to_wait, void *context)
+{
+    audio_element_info_t info = { 0 };
+    audio_element_getinfo(self, &info);
+    int left = SPLICE_TRACK_BYTES - (int)info.byte_pos;
+    if (left <= 0) {
+        return 0;
+    }
+    len = (len < left ? len : left) & ~1;
+    int track = atoi(audio_element_get_uri(self) + strlen("track://"));
+    uint16_t *word = (uint16_t *)buffer;
+    for (int i = 0; i < len / 2; i++) {
+        word[i] = (uint16_t)((track * SPLICE_TRACK_BYTES + (int)info.byte_pos) / 2 + i);
+    }
+    audio_element_update_byte_pos(self, len);
+    return len;
+}
+
+static int _splice_sink_write(audio_element_handle_t self, char *buffer, int len, TickType_t ticks_to_wait, void *context)
+{
+    splice_sink_t *sink = (splice_sink_t *)context;
+    uint16_t *word = (uint16_t *)buffer;
+    for (int i = 0; i < len / 2; i++) {
+        if (word[i] != (uint16_t)(sink->bytes / 2 + i)) {
+            sink->errors++;
+        }
+    }
+    int64_t now = esp_timer_get_time();
+    if (sink->last_us && now - sink->last_us > sink->max_gap_us) {
+        sink->max_gap_us = now - sink->last_us;
+    }
+    sink->last_us = now;
+    sink->bytes += len;
+    // Paced like a 48 kHz stereo sink
+    vTaskDelay(1 + len * 1000 / (48000 * 4) / portTICK_RATE_MS);
+    return len;
+}
+
+static esp_err_t _splice_open(audio_element_handle_t self)
+{
+    return audio_element_set_byte_pos(self, 0);
+}
+
+static int _splice_pass(audio_element_handle_t self, char *buffer, int len)
+{
+    int r_size = audio_element_input(self, buffer, len);
+    if (r_size > 0) {
+        return audio_element_output(self, buffer, r_size);
+    }
+    return r_size;
+}
+
+static audio_element_handle_t splice_el_init(stream_func read, stream_func write, void *ctx)
+{
+    audio_element_cfg_t el_cfg = DEFAULT_AUDIO_ELEMENT_CONFIG();
+    el_cfg.open = _splice_open;
+    el_cfg.process = _splice_pass;
+    el_cfg.buffer_len = 1024;
+    audio_element_handle_t el = audio_element_init(&el_cfg);
+    TEST_ASSERT_NOT_NULL(el);
+    if (read) {
+        audio_element_set_read_cb(el, read, ctx);
+    }
+    if (write) {
+        audio_element_set_write_cb(el, write, ctx);
+    }
+    return el;
+}
+
+TEST_CASE("audio_pipeline gapless splice", "esp-adf")
+{
+    splice_sink_t result = { 0 };
+    audio_element_handle_t src_a = splice_el_init(_splice_src_read, NULL, NULL);
+    audio_element_handle_t dec_a = splice_el_init(NULL, NULL, NULL);
+    audio_element_handle_t src_b = splice_el_init(_splice_src_read, NULL, NULL);
+    audio_element_handle_t dec_b = splice_el_init(NULL, NULL, NULL);
+    audio_element_handle_t sink = splice_el_init(NULL, _splice_sink_write, &result);
+
+    audio_pipeline_cfg_t pipeline_cfg = DEFAULT_AUDIO_PIPELINE_CONFIG();
+    audio_pipeline_handle_t pipeline_a = audio_pipeline_init(&pipeline_cfg);
+    audio_pipeline_handle_t pipeline_b = audio_pipeline_init(&pipeline_cfg);
+    TEST_ASSERT_NOT_NULL(pipeline_a);
+    TEST_ASSERT_NOT_NULL(pipeline_b);
+    audio_pipeline_register(pipeline_a, src_a, "src_a");
+    audio_pipeline_register(pipeline_a, dec_a, "dec_a");
+    audio_pipeline_register(pipeline_a, sink, "sink");
+    audio_pipeline_register(pipeline_b, src_b, "src_b");
+    audio_pipeline_register(pipeline_b, dec_b, "dec_b");
+    TEST_ASSERT_EQUAL(ESP_OK, audio_pipeline_link(pipeline_a, (const char *[]) {"src_a", "dec_a", "sink"}, 3));
+    TEST_ASSERT_EQUAL(ESP_OK, audio_pipeline_link(pipeline_b, (const char *[]) {"src_b", "dec_b"}, 2));
+
+    audio_event_iface_cfg_t evt_cfg = AUDIO_EVENT_IFACE_DEFAULT_CFG();
+    audio_event_iface_handle_t evt = audio_event_iface_init(&evt_cfg);
+    audio_pipeline_set_listener(pipeline_a, evt);
+    audio_pipeline_set_listener(pipeline_b, evt);
+
+    audio_element_set_uri(src_a, "track://0");
+    TEST_ASSERT_EQUAL(ESP_OK, audio_pipeline_run(pipeline_a));
+    TEST_ASSERT_EQUAL(ESP_OK, audio_pipeline_splice_next(pipeline_b, sink, "track://1", 0));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, audio_pipeline_splice_next(pipeline_a, sink, "track://2", 0));
+
+    int spliced = 0;
+    while (1) {
+        audio_event_iface_msg_t msg;
+        TEST_ASSERT_EQUAL(ESP_OK, audio_event_iface_listen(evt, &msg, 5000 / portTICK_RATE_MS));
+        if (msg.source != (void *)sink || msg.cmd != AEL_MSG_CMD_REPORT_STATUS) {
+            continue;
+        }
+        if ((int)msg.data == AEL_STATUS_INPUT_SPLICED) {
+            spliced++;
+            // The chain that played the track before is free for the track after the next one
+            if (spliced + 1 < SPLICE_TRACKS) {
+                char uri[16];
+                snprintf(uri, sizeof(uri), "track://%d", spliced + 1);
+                TEST_ASSERT_EQUAL(ESP_OK, audio_pipeline_splice_next(spliced % 2 ? pipeline_a : pipeline_b, sink, uri, 0));
+            }
+        } else if ((int)msg.data == AEL_STATUS_STATE_FINISHED) {
+            break;
+        }
+    }
+    ESP_LOGI(TAG, "%d bytes in %d tracks, %d splices, longest pause of the sink %lld us",
+             result.bytes, SPLICE_TRACKS, spliced, result.max_gap_us);
+    TEST_ASSERT_EQUAL(SPLICE_TRACKS - 1, spliced);
+    TEST_ASSERT_EQUAL(SPLICE_TRACKS * SPLICE_TRACK_BYTES, result.bytes);
+    TEST_ASSERT_EQUAL(0, result.errors);
+
+    audio_pipeline_stop(pipeline_a);
+    audio_pipeline_wait_for_stop(pipeline_a);
+    audio_pipeline_stop(pipeline_b);
+    audio_pipeline_wait_for_stop(pipeline_b);
+    audio_pipeline_remove_listener(pipeline_a);
+    audio_pipeline_remove_listener(pipeline_b);
+    audio_event_iface_destroy(evt);
+    TEST_ASSERT_EQUAL(ESP_OK, audio_pipeline_deinit(pipeline_a));
+    TEST_ASSERT_EQUAL(ESP_OK, audio_pipeline_deinit(pipeline_b));
+}
+
+#define RESTART_ELEMENTS     (3)
+#define RESTART_ROUNDS       (50)
+
+static int64_t restart_elements_us(audio_element_handle_t *els)
+{
+    int64_t start = esp_timer_get_time();
+    for (int n = 0; n < RESTART_ROUNDS; n++) {
+        for (int i = 0; i < RESTART_ELEMENTS; i++) {
+            TEST_ASSERT_EQUAL(ESP_OK, audio_element_run(els[i]));
+        }
+        for (int i = 0; i < RESTART_ELEMENTS; i++) {
+            TEST_ASSERT_EQUAL(ESP_OK, audio_element_terminate(els[i]));
+        }
+    }
+    return (esp_timer_get_time() - start) / RESTART_ROUNDS;
+}
+
+TEST_CASE("audio_element restart on parked workers", "esp-adf")
+{
+    audio_element_handle_t els[RESTART_ELEMENTS];
+    audio_element_cfg_t el_cfg = DEFAULT_AUDIO_ELEMENT_CONFIG();
+    el_cfg.open = _el_open;
+    el_cfg.process = _el_process;
+    el_cfg.close = _el_close;
+    for (int i = 0; i < RESTART_ELEMENTS; i++) {
+        els[i] = audio_element_init(&el_cfg);
+        TEST_ASSERT_NOT_NULL(els[i]);
+    }
+    esp_log_level_set("AUDIO_ELEMENT", ESP_LOG_WARN);
+    int64_t create_us = restart_elements_us(els);
+
+    audio_thread_pool_class_t classes[] = {
+        {
+            .stack = el_cfg.task_stack,
+            .count = RESTART_ELEMENTS + 1,
+            .stack_in_ext = el_cfg.stack_in_ext,
+            .core_id = el_cfg.task_core,
+        },
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, audio_thread_pool_init(classes, 1));
+    // Let the idle task reap the element tasks deleted above, then count the parked workers in
+    vTaskDelay(10 / portTICK_RATE_MS);
+    UBaseType_t task_num = uxTaskGetNumberOfTasks();
+    int64_t pool_us = restart_elements_us(els);
+    ESP_LOGI(TAG, "%d elements run + terminate, %lld us with created tasks, %lld us on parked workers",
+             RESTART_ELEMENTS, create_us, pool_us);
+
+    // The last worker is given back right after its element reported the task destroyed
+    vTaskDelay(10 / portTICK_RATE_MS);
+    // Every run was served by a parked worker, no task was created or deleted
+    TEST_ASSERT_EQUAL(task_num, uxTaskGetNumberOfTasks());
+    TEST_ASSERT_EQUAL(ESP_OK, audio_thread_pool_deinit());
+    esp_log_level_set("AUDIO_ELEMENT", ESP_LOG_INFO);
+    for (int i = 0; i < RESTART_ELEMENTS; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, audio_element_deinit(els[i]));
+    }
+}
@@ -670,6 +670,49 @@ int audio_recorder_data_read(audio_rec_handle_t handle, void *buffer, int length
     return ret;
 }
 
+static recorder_subproc_iface_t *audio_recorder_get_output(audio_recorder_t *recorder, void **subproc_handle)
+{
+    if (recorder->encoder_handle) {
+        *subproc_handle = recorder->encoder_handle;
+        return &recorder->encoder_iface->base;
+    } else if (recorder->sr_handle) {
+        *subproc_handle = recorder->sr_handle;
+        return &recorder->sr_iface->base;
+    }
+    return NULL;
+}
+
+esp_err_t audio_recorder_frame_acquire(audio_rec_handle_t handle, recorder_frame_t **frame, TickType_t ticks)
+{
+    AUDIO_NULL_CHECK(TAG, handle, return ESP_ERR_INVALID_ARG);
+    AUDIO_NULL_CHECK(TAG, frame, return ESP_ERR_INVALID_ARG);
+    audio_recorder_t *recorder = (audio_recorder_t *)handle;
+    *frame = NULL;
+    if (recorder->state != RECORDER_ST_SPEECHING && recorder->state != RECORDER_ST_WAIT_FOR_SILENCE) {
+        ESP_LOGW(TAG, "Not in speeching, no frame");
+        return ESP_FAIL;
+    }
+    void *subproc_handle = NULL;
+    recorder_subproc_iface_t *subproc = audio_recorder_get_output(recorder, &subproc_handle);
+    if (subproc == NULL || subproc->fetch_frame == NULL) {
+        ESP_LOGW(TAG, "No frame output, use audio_recorder_data_read instead");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return subproc->fetch_frame(subproc_handle, frame, ticks);
+}
+
+esp_err_t audio_recorder_frame_release(audio_rec_handle_t handle, recorder_frame_t *frame)
+{
+    AUDIO_NULL_CHECK(TAG, handle, return ESP_ERR_INVALID_ARG);
+    AUDIO_NULL_CHECK(TAG, frame, return ESP_ERR_INVALID_ARG);
+    audio_recorder_t *recorder = (audio_recorder_t *)handle;
+    void *subproc_handle = NULL;
+    recorder_subproc_iface_t *subproc = audio_recorder_get_output(recorder, &subproc_handle);
+    AUDIO_NULL_CHECK(TAG, subproc, return ESP_ERR_NOT_SUPPORTED);
+    AUDIO_NULL_CHECK(TAG, subproc->release_frame, return ESP_ERR_NOT_SUPPORTED);
+    return subproc->release_frame(subproc_handle, frame);
+}
+
 bool audio_recorder_get_wakeup_state(audio_rec_handle_t handle)
 {
     AUDIO_NULL_CHECK(TAG, handle, return false);
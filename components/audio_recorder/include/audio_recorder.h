@@ -188,6 +188,35 @@ esp_err_t audio_recorder_vad_check_enable(audio_rec_handle_t handle, bool enable
  */
 int audio_recorder_data_read(audio_rec_handle_t handle, void *buffer, int length, TickType_t ticks);
 
+/**
+ * @brief Get a frame of recorder data by reference, instead of copying it by `audio_recorder_data_read`
+ *
+ * @note  The frame stays valid until `audio_recorder_frame_release`, hold it shortly since the pool has a few frames only.
+ *        Don't mix it with `audio_recorder_data_read` during one speech.
+ *
+ * @param handle  Audio recorder handle
+ * @param frame   Pointer to save the frame
+ * @param ticks   Timeout for reading
+ *
+ * @return ESP_OK
+ *         ESP_FAIL                 not in speeching, timeout or recording ended
+ *         ESP_ERR_NOT_SUPPORTED    neither encoder nor sr is used
+ *         ESP_ERR_INVALID_ARG
+ */
+esp_err_t audio_recorder_frame_acquire(audio_rec_handle_t handle, recorder_frame_t **frame, TickType_t ticks);
+
+/**
+ * @brief Give back the frame got by `audio_recorder_frame_acquire`
+ *
+ * @param handle  Audio recorder handle
+ * @param frame   The frame
+ *
+ * @return ESP_OK
+ *         ESP_ERR_NOT_SUPPORTED
+ *         ESP_ERR_INVALID_ARG
+ */
+esp_err_t audio_recorder_frame_release(audio_rec_handle_t handle, recorder_frame_t *frame);
+
 /**
  * @brief Destroy audio recorder and recycle all resource
  *
@@ -27,6 +27,7 @@
 
 #include <string.h>
 #include "esp_err.h"
+#include "channel_layout.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -85,15 +86,12 @@ inline int8_t ch_get_idx(int8_t *order, size_t chan_num, uint8_t target_ch)
  */
 inline esp_err_t ch_sort_16bit_2ch(int16_t *i_buf, int16_t *o_buf, size_t len, int8_t *src_order)
 {
-    if (src_order[0] == DAT_CH_0 && src_order[1] == DAT_CH_1) {
-        memcpy(o_buf, i_buf, len);
-        return ESP_OK;
-    }
-    for (int i = 0; i < (len >> 2); i++) {
-        size_t cur_idx = i << 1;
-        o_buf[cur_idx] = i_buf[cur_idx + 1];
-        o_buf[cur_idx + 1] = i_buf[cur_idx];
+    int8_t order[2] = { 0, 1 };
+    if (src_order[0] != DAT_CH_0 || src_order[1] != DAT_CH_1) {
+        order[0] = 1;
+        order[1] = 0;
     }
+    channel_layout_permute(o_buf, 2, i_buf, 2, 16, order, len >> 2);
     return ESP_OK;
 }
 
@@ -111,18 +109,15 @@ inline esp_err_t ch_sort_16bit_2ch(int16_t *i_buf, int16_t *o_buf, size_t len, i
  */
 inline esp_err_t ch_sort_16bit_4ch(int16_t *i_buf, int16_t *o_buf, size_t len, int8_t *src_order)
 {
-    int8_t ch0_idx = ch_get_idx(src_order, 4, DAT_CH_0);
-    int8_t ch1_idx = ch_get_idx(src_order, 4, DAT_CH_1);
-    int8_t ref_idx = ch_get_idx(src_order, 4, DAT_CH_2);
-
-    if (ch0_idx == -1 || ch1_idx == -1 || ref_idx == -1) {
+    int8_t order[3] = {
+        ch_get_idx(src_order, 4, DAT_CH_0),
+        ch_get_idx(src_order, 4, DAT_CH_1),
+        ch_get_idx(src_order, 4, DAT_CH_2),
+    };
+    if (order[0] == -1 || order[1] == -1 || order[2] == -1) {
         return ESP_ERR_INVALID_ARG;
     }
-    for (int i = 0; i < (len >> 3); i++) {
-        o_buf[3 * i + 0] = i_buf[(i << 2) + ch0_idx];
-        o_buf[3 * i + 1] = i_buf[(i << 2) + ch1_idx];
-        o_buf[3 * i + 2] = i_buf[(i << 2) + ref_idx];
-    }
+    channel_layout_permute(o_buf, 3, i_buf, 4, 16, order, len >> 3);
     return ESP_OK;
 }
 
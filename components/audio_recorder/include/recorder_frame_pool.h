@@ -0,0 +1,155 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __RECORDER_FRAME_POOL_H__
+#define __RECORDER_FRAME_POOL_H__
+
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief A frame of recorder data, passed by reference from the producer to the reader
+ */
+typedef struct {
+    uint8_t *data; /*!< Frame payload */
+    int      len;  /*!< Valid bytes in `data` */
+    int      size; /*!< Capacity of `data` */
+} recorder_frame_t;
+
+/**
+ * @brief Frame pool handle
+ */
+typedef struct recorder_frame_pool *recorder_frame_pool_handle_t;
+
+/**
+ * @brief      Create a pool of `frame_num` frames of `frame_size` bytes, all allocated up front
+ *
+ * @param frame_size  Capacity of each frame
+ * @param frame_num   Number of frames
+ *
+ * @return NULL    failed
+ *         Others  frame pool handle
+ */
+recorder_frame_pool_handle_t recorder_frame_pool_create(int frame_size, int frame_num);
+
+/**
+ * @brief Destroy the pool, frames still held by readers must have been released
+ *
+ * @param pool  Frame pool handle
+ */
+void recorder_frame_pool_destroy(recorder_frame_pool_handle_t pool);
+
+/**
+ * @brief Get an empty frame to fill (producer side)
+ *
+ * @note  With `drop_oldest` a producer which must not block reclaims the oldest published frame when no frame
+ *        is free within `ticks`, so the readers always get the newest data, the reclaimed frame is counted as dropped.
+ *
+ * @param pool         Frame pool handle
+ * @param ticks        Time to wait for a reader to release a frame
+ * @param drop_oldest  Reclaim the oldest published frame on timeout
+ *
+ * @return NULL    timeout, or the pool is done
+ *         Others  the frame
+ */
+recorder_frame_t *recorder_frame_pool_get(recorder_frame_pool_handle_t pool, TickType_t ticks, bool drop_oldest);
+
+/**
+ * @brief Publish a filled frame to the readers (producer side)
+ *
+ * @param pool   Frame pool handle
+ * @param frame  Frame from `recorder_frame_pool_get`
+ *
+ * @return ESP_OK
+ *         ESP_FAIL
+ */
+esp_err_t recorder_frame_pool_put(recorder_frame_pool_handle_t pool, recorder_frame_t *frame);
+
+/**
+ * @brief Take the oldest published frame by reference (reader side)
+ *
+ * @param pool   Frame pool handle
+ * @param ticks  Timeout for waiting
+ *
+ * @return NULL    timeout, or all the published frames are taken after `recorder_frame_pool_done`
+ *         Others  the frame, to be given back by `recorder_frame_pool_release`
+ */
+recorder_frame_t *recorder_frame_pool_take(recorder_frame_pool_handle_t pool, TickType_t ticks);
+
+/**
+ * @brief Give a frame back to the pool
+ *
+ * @param pool   Frame pool handle
+ * @param frame  Frame from `recorder_frame_pool_get` or `recorder_frame_pool_take`
+ */
+void recorder_frame_pool_release(recorder_frame_pool_handle_t pool, recorder_frame_t *frame);
+
+/**
+ * @brief Copy published data into `buf`, for readers of a byte stream
+ *
+ * @note  A partly read frame is kept for the next call, so only one byte stream reader is supported,
+ *        and it should not be mixed with `recorder_frame_pool_take` on the same pool.
+ *
+ * @param pool   Frame pool handle
+ * @param buf    Buffer to save data
+ * @param len    Size of buffer
+ * @param ticks  Timeout for waiting the first frame
+ *
+ * @return Length of data actually read, 0 on timeout or done
+ */
+int recorder_frame_pool_read(recorder_frame_pool_handle_t pool, void *buf, int len, TickType_t ticks);
+
+/**
+ * @brief Signal that the producer is done, the readers get the published frames then NULL,
+ *        and the producer gets no frame until `recorder_frame_pool_reset`
+ *
+ * @param pool  Frame pool handle
+ */
+void recorder_frame_pool_done(recorder_frame_pool_handle_t pool);
+
+/**
+ * @brief Drop all the published frames and clear the done state
+ *
+ * @param pool  Frame pool handle
+ */
+void recorder_frame_pool_reset(recorder_frame_pool_handle_t pool);
+
+/**
+ * @brief Get the number of frames reclaimed before being read
+ *
+ * @param pool  Frame pool handle
+ *
+ * @return Number of dropped frames
+ */
+uint32_t recorder_frame_pool_get_dropped(recorder_frame_pool_handle_t pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RECORDER_FRAME_POOL_H__ */
@@ -61,7 +61,7 @@ typedef struct {
     int          fetch_task_core;                       /*!< Core id of fetch task */
     int          fetch_task_prio;                       /*!< Priority of fetch task */
     int          fetch_task_stack;                      /*!< Stack size of fetch task */
-    int          rb_size;                               /*!< Ringbuffer size of recorder sr */
+    int          rb_size;                               /*!< Output buffer size of recorder sr, split into frames of the AFE fetch size */
     char         *partition_label;                      /*!< Partition label which stored the model data */
     char         *mn_language;                          /*!< Command language for multinet to load */
 } recorder_sr_cfg_t;
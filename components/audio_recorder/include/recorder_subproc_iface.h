@@ -27,6 +27,7 @@
 
 #include "freertos/FreeRTOS.h"
 #include "esp_err.h"
+#include "recorder_frame_pool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -101,6 +102,30 @@ typedef struct {
      *                  ESP_ERR_INVALID_ARG
      */
     int (*fetch)(void *handle, void *buf, int len, TickType_t ticks);
+
+    /**
+     * @brief Function to fetch a frame by reference from recorder subprocess, without copying it out
+     *
+     * @param handle    The handle of recorder subprocess
+     * @param frame     The pointer to save the frame
+     * @param ticks     Timeout for reading
+     *
+     * @returns ESP_OK
+     *          ESP_FAIL
+     *          ESP_ERR_INVALID_ARG
+     */
+    esp_err_t (*fetch_frame)(void *handle, recorder_frame_t **frame, TickType_t ticks);
+
+    /**
+     * @brief Function to give back the frame got by `fetch_frame`
+     *
+     * @param handle    The handle of recorder subprocess
+     * @param frame     The frame
+     *
+     * @returns ESP_OK
+     *          ESP_ERR_INVALID_ARG
+     */
+    esp_err_t (*release_frame)(void *handle, recorder_frame_t *frame);
 } recorder_subproc_iface_t;
 
 #ifdef __cplusplus
@@ -33,8 +33,8 @@
 
 #include "recorder_encoder.h"
 
-#define DEFAULT_OUT_QUEUE_LEN (10)
-#define DEFAULT_OUT_BUF_LEN   (1024)
+#define DEFAULT_OUT_FRAME_NUM  (4)
+#define DEFAULT_OUT_FRAME_SIZE (512)
 
 static const char *TAG = "RECORDER_ENCODER";
 
@@ -43,7 +43,7 @@ typedef struct __recorder_encoder {
     audio_pipeline_handle_t pipeline;
     recorder_data_read_t    read;
     void                    *read_ctx;
-    ringbuf_handle_t        out_rb;
+    recorder_frame_pool_handle_t out_pool;
 } recorder_encoder_t;
 
 static esp_err_t recorder_encoder_enable(void *handle, bool enable)
@@ -52,11 +52,12 @@ static esp_err_t recorder_encoder_enable(void *handle, bool enable)
     recorder_encoder_t *recorder_encoder = (recorder_encoder_t *)handle;
 
     if (enable) {
+        recorder_frame_pool_reset(recorder_encoder->out_pool);
         audio_pipeline_reset_ringbuffer(recorder_encoder->pipeline);
         audio_pipeline_run(recorder_encoder->pipeline);
         audio_pipeline_resume(recorder_encoder->pipeline);
     } else {
-        rb_done_write(recorder_encoder->out_rb);
+        recorder_frame_pool_done(recorder_encoder->out_pool);
         audio_pipeline_stop(recorder_encoder->pipeline);
         audio_pipeline_reset_elements(recorder_encoder->pipeline);
         audio_pipeline_reset_items_state(recorder_encoder->pipeline);
@@ -95,9 +96,27 @@ static int recorder_encoder_fetch(void *handle, void *buf, int len, TickType_t t
     AUDIO_CHECK(TAG, handle, return ESP_ERR_INVALID_ARG, "Handle is NULL");
     recorder_encoder_t *recorder_encoder = (recorder_encoder_t *)handle;
 
-    int ret = rb_read(recorder_encoder->out_rb, buf, len, ticks);
+    return recorder_frame_pool_read(recorder_encoder->out_pool, buf, len, ticks);
+}
+
+static esp_err_t recorder_encoder_fetch_frame(void *handle, recorder_frame_t **frame, TickType_t ticks)
+{
+    AUDIO_CHECK(TAG, handle, return ESP_ERR_INVALID_ARG, "Handle is NULL");
+    AUDIO_CHECK(TAG, frame, return ESP_ERR_INVALID_ARG, "Frame is NULL");
+    recorder_encoder_t *recorder_encoder = (recorder_encoder_t *)handle;
+
+    *frame = recorder_frame_pool_take(recorder_encoder->out_pool, ticks);
+    return *frame ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t recorder_encoder_release_frame(void *handle, recorder_frame_t *frame)
+{
+    AUDIO_CHECK(TAG, handle, return ESP_ERR_INVALID_ARG, "Handle is NULL");
+    AUDIO_CHECK(TAG, frame, return ESP_ERR_INVALID_ARG, "Frame is NULL");
+    recorder_encoder_t *recorder_encoder = (recorder_encoder_t *)handle;
 
-    return ret > 0 ? ret : 0;
+    recorder_frame_pool_release(recorder_encoder->out_pool, frame);
+    return ESP_OK;
 }
 
 static audio_element_err_t recorder_encoder_data_in(audio_element_handle_t self, char *buffer, int len, TickType_t ticks, void *context)
@@ -113,12 +132,36 @@ static audio_element_err_t recorder_encoder_data_in(audio_element_handle_t self,
     }
 }
 
+static audio_element_err_t recorder_encoder_data_out(audio_element_handle_t self, char *buffer, int len, TickType_t ticks, void *context)
+{
+    AUDIO_CHECK(TAG, context, return AEL_IO_FAIL, "Handle is NULL");
+    recorder_encoder_t *recorder_encoder = (recorder_encoder_t *)context;
+
+    // Encoded data goes straight into the frames handed to the reader, blocking while the reader is behind
+    int written = 0;
+    while (written < len) {
+        recorder_frame_t *frame = recorder_frame_pool_get(recorder_encoder->out_pool, ticks, false);
+        if (frame == NULL) {
+            return written > 0 ? written : AEL_IO_ABORT;
+        }
+        frame->len = len - written > frame->size ? frame->size : len - written;
+        memcpy(frame->data, buffer + written, frame->len);
+        written += frame->len;
+        if (recorder_frame_pool_put(recorder_encoder->out_pool, frame) != ESP_OK) {
+            return AEL_IO_ABORT;
+        }
+    }
+    return written;
+}
+
 static recorder_encoder_iface_t recorder_encoder_iface = {
     .base.enable = recorder_encoder_enable,
     .base.get_state = recorder_encoder_get_state,
     .base.set_read_cb = recorder_encoder_set_read_cb,
     .base.feed = NULL,
     .base.fetch = recorder_encoder_fetch,
+    .base.fetch_frame = recorder_encoder_fetch_frame,
+    .base.release_frame = recorder_encoder_release_frame,
 };
 
 static void recorder_encoder_clear(void *handle)
@@ -128,8 +171,8 @@ static void recorder_encoder_clear(void *handle)
     if (recorder_encoder->pipeline) {
         audio_pipeline_deinit(recorder_encoder->pipeline);
     }
-    if (recorder_encoder->out_rb) {
-        rb_destroy(recorder_encoder->out_rb);
+    if (recorder_encoder->out_pool) {
+        recorder_frame_pool_destroy(recorder_encoder->out_pool);
     }
     if (recorder_encoder) {
         audio_free(recorder_encoder);
@@ -156,13 +199,13 @@ recorder_encoder_handle_t recorder_encoder_create(recorder_encoder_cfg_t *cfg, r
     if (recorder_encoder->config.encoder) {
         ret |= audio_pipeline_register(recorder_encoder->pipeline, recorder_encoder->config.encoder, "encoder");
     }
-    recorder_encoder->out_rb = rb_create(2, 1024);
-    AUDIO_NULL_CHECK(TAG, recorder_encoder->out_rb, goto __failed);
+    recorder_encoder->out_pool = recorder_frame_pool_create(DEFAULT_OUT_FRAME_SIZE, DEFAULT_OUT_FRAME_NUM);
+    AUDIO_NULL_CHECK(TAG, recorder_encoder->out_pool, goto __failed);
     audio_element_handle_t first_el = recorder_encoder->config.resample ? recorder_encoder->config.resample : recorder_encoder->config.encoder;
     audio_element_handle_t last_el = recorder_encoder->config.encoder ? recorder_encoder->config.encoder : recorder_encoder->config.resample;
     ret |= audio_pipeline_link_more(recorder_encoder->pipeline, first_el, last_el != first_el ? last_el : NULL, NULL);
     ret |= audio_element_set_read_cb(first_el, recorder_encoder_data_in, (void *)recorder_encoder);
-    ret |= audio_element_set_output_ringbuf(last_el, recorder_encoder->out_rb);
+    ret |= audio_element_set_write_cb(last_el, recorder_encoder_data_out, (void *)recorder_encoder);
     AUDIO_CHECK(TAG, ret == ESP_OK, goto __failed, "recorder pipeline op failed");
 
     *iface = &recorder_encoder_iface;
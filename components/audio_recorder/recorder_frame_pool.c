@@ -0,0 +1,230 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+
+#include "audio_error.h"
+#include "audio_mem.h"
+#include "audio_mutex.h"
+
+#include "recorder_frame_pool.h"
+
+#define FRAME_POOL_WAIT_SLICE (pdMS_TO_TICKS(10))
+
+static const char *TAG = "RECORDER_FRAME";
+
+struct recorder_frame_pool {
+    QueueHandle_t    free_q;   /*!< Empty frames */
+    QueueHandle_t    ready_q;  /*!< Published frames in order, a NULL entry marks the end of data */
+    recorder_frame_t *frames;
+    uint8_t          *buf;
+    int              frame_num;
+    void             *lock;    /*!< Protects the byte stream reader against reset */
+    recorder_frame_t *cur;     /*!< Frame partly read by `recorder_frame_pool_read` */
+    int              pos;
+    volatile bool    done;
+    volatile uint32_t dropped;
+};
+
+recorder_frame_pool_handle_t recorder_frame_pool_create(int frame_size, int frame_num)
+{
+    AUDIO_CHECK(TAG, frame_size > 0 && frame_num > 0, return NULL, "Invalid frame size or number");
+    recorder_frame_pool_handle_t pool = audio_calloc(1, sizeof(struct recorder_frame_pool));
+    AUDIO_MEM_CHECK(TAG, pool, return NULL);
+    pool->frame_num = frame_num;
+    pool->frames = audio_calloc(frame_num, sizeof(recorder_frame_t));
+    AUDIO_MEM_CHECK(TAG, pool->frames, goto _failed);
+    pool->buf = audio_calloc(frame_num, frame_size);
+    AUDIO_MEM_CHECK(TAG, pool->buf, goto _failed);
+    pool->free_q = xQueueCreate(frame_num, sizeof(recorder_frame_t *));
+    AUDIO_MEM_CHECK(TAG, pool->free_q, goto _failed);
+    // One more slot so that the end marker never waits for a frame to be taken
+    pool->ready_q = xQueueCreate(frame_num + 1, sizeof(recorder_frame_t *));
+    AUDIO_MEM_CHECK(TAG, pool->ready_q, goto _failed);
+    pool->lock = mutex_create();
+    AUDIO_MEM_CHECK(TAG, pool->lock, goto _failed);
+    for (int i = 0; i < frame_num; i++) {
+        recorder_frame_t *frame = &pool->frames[i];
+        frame->data = pool->buf + i * frame_size;
+        frame->size = frame_size;
+        xQueueSend(pool->free_q, &frame, 0);
+    }
+    return pool;
+
+_failed:
+    recorder_frame_pool_destroy(pool);
+    return NULL;
+}
+
+void recorder_frame_pool_destroy(recorder_frame_pool_handle_t pool)
+{
+    AUDIO_NULL_CHECK(TAG, pool, return);
+    if (pool->lock) {
+        mutex_destroy(pool->lock);
+    }
+    if (pool->ready_q) {
+        vQueueDelete(pool->ready_q);
+    }
+    if (pool->free_q) {
+        vQueueDelete(pool->free_q);
+    }
+    audio_free(pool->buf);
+    audio_free(pool->frames);
+    audio_free(pool);
+}
+
+recorder_frame_t *recorder_frame_pool_get(recorder_frame_pool_handle_t pool, TickType_t ticks, bool drop_oldest)
+{
+    AUDIO_NULL_CHECK(TAG, pool, return NULL);
+    recorder_frame_t *frame = NULL;
+    // Wait in slices, `recorder_frame_pool_done` has no frame to hand over to wake up the producer
+    do {
+        if (pool->done) {
+            return NULL;
+        }
+        TickType_t wait = ticks < FRAME_POOL_WAIT_SLICE ? ticks : FRAME_POOL_WAIT_SLICE;
+        if (xQueueReceive(pool->free_q, &frame, wait) == pdTRUE) {
+            frame->len = 0;
+            return frame;
+        }
+        if (ticks != portMAX_DELAY) {
+            ticks -= wait;
+        }
+    } while (ticks);
+    if (drop_oldest && xQueueReceive(pool->ready_q, &frame, 0) == pdTRUE) {
+        if (frame == NULL) {
+            xQueueSendToFront(pool->ready_q, &frame, 0);
+            return NULL;
+        }
+        pool->dropped++;
+        frame->len = 0;
+        return frame;
+    }
+    return NULL;
+}
+
+esp_err_t recorder_frame_pool_put(recorder_frame_pool_handle_t pool, recorder_frame_t *frame)
+{
+    AUDIO_NULL_CHECK(TAG, pool, return ESP_FAIL);
+    AUDIO_NULL_CHECK(TAG, frame, return ESP_FAIL);
+    if (pool->done || xQueueSend(pool->ready_q, &frame, 0) != pdTRUE) {
+        xQueueSend(pool->free_q, &frame, 0);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+recorder_frame_t *recorder_frame_pool_take(recorder_frame_pool_handle_t pool, TickType_t ticks)
+{
+    AUDIO_NULL_CHECK(TAG, pool, return NULL);
+    recorder_frame_t *frame = NULL;
+    if (xQueueReceive(pool->ready_q, &frame, ticks) != pdTRUE) {
+        return NULL;
+    }
+    if (frame == NULL) {
+        // Keep the end marker for the following takes until reset
+        xQueueSendToFront(pool->ready_q, &frame, 0);
+    }
+    return frame;
+}
+
+void recorder_frame_pool_release(recorder_frame_pool_handle_t pool, recorder_frame_t *frame)
+{
+    AUDIO_NULL_CHECK(TAG, pool, return);
+    AUDIO_NULL_CHECK(TAG, frame, return);
+    xQueueSend(pool->free_q, &frame, 0);
+}
+
+int recorder_frame_pool_read(recorder_frame_pool_handle_t pool, void *buf, int len, TickType_t ticks)
+{
+    AUDIO_NULL_CHECK(TAG, pool, return 0);
+    AUDIO_NULL_CHECK(TAG, buf, return 0);
+    int read_len = 0;
+    mutex_lock(pool->lock);
+    while (read_len < len) {
+        if (pool->cur == NULL) {
+            pool->cur = recorder_frame_pool_take(pool, ticks);
+            if (pool->cur == NULL) {
+                break;
+            }
+            pool->pos = 0;
+        }
+        int n = pool->cur->len - pool->pos;
+        if (n > len - read_len) {
+            n = len - read_len;
+        }
+        memcpy((uint8_t *)buf + read_len, pool->cur->data + pool->pos, n);
+        read_len += n;
+        pool->pos += n;
+        if (pool->pos >= pool->cur->len) {
+            recorder_frame_pool_release(pool, pool->cur);
+            pool->cur = NULL;
+        }
+    }
+    mutex_unlock(pool->lock);
+    return read_len;
+}
+
+void recorder_frame_pool_done(recorder_frame_pool_handle_t pool)
+{
+    AUDIO_NULL_CHECK(TAG, pool, return);
+    if (pool->done) {
+        return;
+    }
+    pool->done = true;
+    recorder_frame_t *marker = NULL;
+    xQueueSend(pool->ready_q, &marker, 0);
+}
+
+void recorder_frame_pool_reset(recorder_frame_pool_handle_t pool)
+{
+    AUDIO_NULL_CHECK(TAG, pool, return);
+    // Let a blocked byte stream reader return before taking its frame back
+    recorder_frame_pool_done(pool);
+    mutex_lock(pool->lock);
+    recorder_frame_t *frame = NULL;
+    while (xQueueReceive(pool->ready_q, &frame, 0) == pdTRUE) {
+        if (frame) {
+            xQueueSend(pool->free_q, &frame, 0);
+        }
+    }
+    if (pool->cur) {
+        xQueueSend(pool->free_q, &pool->cur, 0);
+        pool->cur = NULL;
+    }
+    pool->pos = 0;
+    pool->dropped = 0;
+    pool->done = false;
+    mutex_unlock(pool->lock);
+}
+
+uint32_t recorder_frame_pool_get_dropped(recorder_frame_pool_handle_t pool)
+{
+    AUDIO_NULL_CHECK(TAG, pool, return 0);
+    return pool->dropped;
+}
@@ -35,8 +35,6 @@
 #include "audio_mem.h"
 #include "audio_thread.h"
 
-#include "ringbuf.h"
-
 #include "esp_afe_sr_models.h"
 #include "esp_wn_iface.h"
 #include "esp_wn_models.h"
@@ -77,7 +75,7 @@ typedef struct __recorder_sr {
     int                   fetch_task_core;
     int                   fetch_task_prio;
     int                   fetch_task_stack;
-    ringbuf_handle_t      out_rb;
+    recorder_frame_pool_handle_t out_pool;
     int                   rb_size;
     EventGroupHandle_t    events;
     bool                  feed_running;
@@ -269,18 +267,43 @@ static void fetch_task(void *parameters)
 
 static esp_err_t recorder_sr_output(recorder_sr_t *recorder_sr, void *buffer, int len)
 {
-    if (rb_bytes_available(recorder_sr->out_rb) < len) {
-        rb_read(recorder_sr->out_rb, NULL, len, 0);
+    // The only copy of the AFE result, the readers get it by reference and the oldest frame is dropped on overrun
+    recorder_frame_t *frame = recorder_frame_pool_get(recorder_sr->out_pool, 0, true);
+    if (frame == NULL) {
+        return ESP_FAIL;
+    }
+    if (len > frame->size) {
+        ESP_LOGW(TAG, "AFE result %d bytes is larger than frame %d bytes", len, frame->size);
+        len = frame->size;
     }
-    int ret = rb_write(recorder_sr->out_rb, buffer, len, 0);
-    return ret == len ? ESP_OK : ESP_FAIL;
+    memcpy(frame->data, buffer, len);
+    frame->len = len;
+    return recorder_frame_pool_put(recorder_sr->out_pool, frame);
 }
 
 static int recorder_sr_fetch(void *handle, void *buf, int len, TickType_t ticks)
 {
     AUDIO_CHECK(TAG, handle, return ESP_ERR_INVALID_ARG, "Handle is NULL");
     recorder_sr_t *recorder_sr = (recorder_sr_t *)handle;
-    return rb_read(recorder_sr->out_rb, buf, len, ticks);
+    return recorder_frame_pool_read(recorder_sr->out_pool, buf, len, ticks);
+}
+
+static esp_err_t recorder_sr_fetch_frame(void *handle, recorder_frame_t **frame, TickType_t ticks)
+{
+    AUDIO_CHECK(TAG, handle, return ESP_ERR_INVALID_ARG, "Handle is NULL");
+    AUDIO_CHECK(TAG, frame, return ESP_ERR_INVALID_ARG, "Frame is NULL");
+    recorder_sr_t *recorder_sr = (recorder_sr_t *)handle;
+    *frame = recorder_frame_pool_take(recorder_sr->out_pool, ticks);
+    return *frame ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t recorder_sr_release_frame(void *handle, recorder_frame_t *frame)
+{
+    AUDIO_CHECK(TAG, handle, return ESP_ERR_INVALID_ARG, "Handle is NULL");
+    AUDIO_CHECK(TAG, frame, return ESP_ERR_INVALID_ARG, "Frame is NULL");
+    recorder_sr_t *recorder_sr = (recorder_sr_t *)handle;
+    recorder_frame_pool_release(recorder_sr->out_pool, frame);
+    return ESP_OK;
 }
 
 static esp_err_t recorder_sr_suspend(void *handle, bool suspend)
@@ -291,10 +314,13 @@ static esp_err_t recorder_sr_suspend(void *handle, bool suspend)
     if (suspend) {
         xEventGroupClearBits(recorder_sr->events, FEED_TASK_RUNNING);
         xEventGroupClearBits(recorder_sr->events, FETCH_TASK_RUNNING);
-        if (recorder_sr->out_rb) {
-            rb_done_write(recorder_sr->out_rb);
+        if (recorder_sr->out_pool) {
+            recorder_frame_pool_done(recorder_sr->out_pool);
         }
     } else {
+        if (recorder_sr->out_pool) {
+            recorder_frame_pool_reset(recorder_sr->out_pool);
+        }
         xEventGroupSetBits(recorder_sr->events, FEED_TASK_RUNNING);
         xEventGroupSetBits(recorder_sr->events, FETCH_TASK_RUNNING);
     }
@@ -327,11 +353,10 @@ static esp_err_t recorder_sr_enable(void *handle, bool enable)
                 true,
                 recorder_sr->fetch_task_core);
         }
-        recorder_sr_suspend(handle, !recorder_sr->wwe_enable);
-
-        if (recorder_sr->out_rb) {
-            rb_reset(recorder_sr->out_rb);
+        if (recorder_sr->out_pool) {
+            recorder_frame_pool_reset(recorder_sr->out_pool);
         }
+        recorder_sr_suspend(handle, !recorder_sr->wwe_enable);
     } else {
         recorder_sr_suspend(handle, false);
 
@@ -349,8 +374,8 @@ static esp_err_t recorder_sr_enable(void *handle, bool enable)
                 ESP_LOGI(TAG, "Feed task destroyed!");
             }
         }
-        if (recorder_sr->out_rb) {
-            rb_done_write(recorder_sr->out_rb);
+        if (recorder_sr->out_pool) {
+            recorder_frame_pool_done(recorder_sr->out_pool);
         }
     }
     return ret == ESP_OK ? ESP_OK : ESP_FAIL;
@@ -470,6 +495,8 @@ static recorder_sr_iface_t recorder_sr_iface = {
     .base.set_read_cb = recorder_sr_set_read_cb,
     .base.feed = NULL,
     .base.fetch = recorder_sr_fetch,
+    .base.fetch_frame = recorder_sr_fetch_frame,
+    .base.release_frame = recorder_sr_release_frame,
     .afe_suspend = recorder_sr_suspend,
     .set_afe_monitor = recorder_sr_set_afe_monitor,
     .set_mn_monitor = recorder_sr_set_mn_monitor,
@@ -496,9 +523,8 @@ static void recorder_sr_clear(void *handle)
     if (recorder_sr->models) {
         esp_srmodel_deinit(recorder_sr->models);
     }
-    if (recorder_sr->out_rb) {
-        rb_reset(recorder_sr->out_rb);
-        rb_destroy(recorder_sr->out_rb);
+    if (recorder_sr->out_pool) {
+        recorder_frame_pool_destroy(recorder_sr->out_pool);
     }
     if (recorder_sr->events) {
         vEventGroupDelete(recorder_sr->events);
@@ -555,8 +581,10 @@ recorder_sr_handle_t recorder_sr_create(recorder_sr_cfg_t *cfg, recorder_sr_ifac
 #endif
     recorder_sr->events = xEventGroupCreate();
     AUDIO_NULL_CHECK(TAG, recorder_sr->events, goto _failed);
-    recorder_sr->out_rb = rb_create(recorder_sr->rb_size, 1);
-    AUDIO_NULL_CHECK(TAG, recorder_sr->out_rb, goto _failed);
+    int frame_size = esp_afe->get_fetch_chunksize(recorder_sr->afe_handle) * sizeof(int16_t);
+    int frame_num = recorder_sr->rb_size / frame_size;
+    recorder_sr->out_pool = recorder_frame_pool_create(frame_size, frame_num < 2 ? 2 : frame_num);
+    AUDIO_NULL_CHECK(TAG, recorder_sr->out_pool, goto _failed);
 
     *iface = &recorder_sr_iface;
 
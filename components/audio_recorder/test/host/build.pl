@@ -0,0 +1,5 @@
+#!/usr/bin/perl
+# Run the recorder state machine and the sr output path on host, FreeRTOS and esp-sr are replaced by stub/, tools/host_test/stub and os_shim.c
+my @f = ("../../audio_recorder.c", "../../recorder_sr.c", "../../recorder_frame_pool.c",
+         "../../../audio_sal/lib/channel_layout/channel_layout.c");
+`gcc @f os_shim.c test.c -Istub -I../../../../tools/host_test/stub -I../../../../tools/host_test/include -I../../include -I../../../audio_sal/lib/channel_layout/include -g -O2 -Wall -Wno-int-to-pointer-cast -Wno-pointer-to-int-cast -pthread -o ./test`;
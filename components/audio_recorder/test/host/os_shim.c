@@ -0,0 +1,349 @@
+/* pthread based implementation of the stub headers, just enough to run the recorder on the host */
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/event_groups.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "audio_thread.h"
+#include "audio_mutex.h"
+#include "ch_sort.h"
+
+// Emit the external definitions of the C99 inline helpers
+extern int8_t ch_get_idx(int8_t *order, size_t chan_num, uint8_t target_ch);
+extern esp_err_t ch_sort_16bit_2ch(int16_t *i_buf, int16_t *o_buf, size_t len, int8_t *src_order);
+extern esp_err_t ch_sort_16bit_4ch(int16_t *i_buf, int16_t *o_buf, size_t len, int8_t *src_order);
+
+static void deadline_of(TickType_t ticks, struct timespec *ts)
+{
+    clock_gettime(CLOCK_REALTIME, ts);
+    ts->tv_sec += ticks / 1000;
+    ts->tv_nsec += (ticks % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+// Wait on `cond` until woken or the ticks elapsed, returns false on timeout
+static bool cond_wait_ticks(pthread_cond_t *cond, pthread_mutex_t *lock, TickType_t ticks, const struct timespec *deadline)
+{
+    if (ticks == 0) {
+        return false;
+    }
+    if (ticks == portMAX_DELAY) {
+        pthread_cond_wait(cond, lock);
+        return true;
+    }
+    return pthread_cond_timedwait(cond, lock, deadline) != ETIMEDOUT;
+}
+
+struct shim_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t  changed;
+    uint8_t         *items;
+    int             len;
+    int             item_size;
+    int             head;
+    int             count;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t len, UBaseType_t item_size)
+{
+    QueueHandle_t q = calloc(1, sizeof(struct shim_queue));
+    q->items = calloc(len, item_size);
+    q->len = len;
+    q->item_size = item_size;
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->changed, NULL);
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t q)
+{
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->changed);
+    free(q->items);
+    free(q);
+}
+
+static BaseType_t queue_send(QueueHandle_t q, const void *item, TickType_t ticks, bool front)
+{
+    struct timespec deadline;
+    deadline_of(ticks, &deadline);
+    pthread_mutex_lock(&q->lock);
+    while (q->count == q->len) {
+        if (!cond_wait_ticks(&q->changed, &q->lock, ticks, &deadline) && q->count == q->len) {
+            pthread_mutex_unlock(&q->lock);
+            return pdFALSE;
+        }
+    }
+    int pos;
+    if (front) {
+        q->head = (q->head + q->len - 1) % q->len;
+        pos = q->head;
+    } else {
+        pos = (q->head + q->count) % q->len;
+    }
+    memcpy(q->items + pos * q->item_size, item, q->item_size);
+    q->count++;
+    pthread_cond_broadcast(&q->changed);
+    pthread_mutex_unlock(&q->lock);
+    return pdTRUE;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks)
+{
+    return queue_send(q, item, ticks, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t q, const void *item, TickType_t ticks)
+{
+    return queue_send(q, item, ticks, true);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks)
+{
+    struct timespec deadline;
+    deadline_of(ticks, &deadline);
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0) {
+        if (!cond_wait_ticks(&q->changed, &q->lock, ticks, &deadline) && q->count == 0) {
+            pthread_mutex_unlock(&q->lock);
+            return pdFALSE;
+        }
+    }
+    memcpy(item, q->items + q->head * q->item_size, q->item_size);
+    q->head = (q->head + 1) % q->len;
+    q->count--;
+    pthread_cond_broadcast(&q->changed);
+    pthread_mutex_unlock(&q->lock);
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+    pthread_mutex_lock(&q->lock);
+    int count = q->count;
+    pthread_mutex_unlock(&q->lock);
+    return count;
+}
+
+struct shim_event_group {
+    pthread_mutex_t lock;
+    pthread_cond_t  changed;
+    EventBits_t     bits;
+};
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    EventGroupHandle_t eg = calloc(1, sizeof(struct shim_event_group));
+    pthread_mutex_init(&eg->lock, NULL);
+    pthread_cond_init(&eg->changed, NULL);
+    return eg;
+}
+
+void vEventGroupDelete(EventGroupHandle_t eg)
+{
+    pthread_mutex_destroy(&eg->lock);
+    pthread_cond_destroy(&eg->changed);
+    free(eg);
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t eg, EventBits_t bits)
+{
+    pthread_mutex_lock(&eg->lock);
+    eg->bits |= bits;
+    EventBits_t ret = eg->bits;
+    pthread_cond_broadcast(&eg->changed);
+    pthread_mutex_unlock(&eg->lock);
+    return ret;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t eg, EventBits_t bits)
+{
+    pthread_mutex_lock(&eg->lock);
+    EventBits_t ret = eg->bits;
+    eg->bits &= ~bits;
+    pthread_mutex_unlock(&eg->lock);
+    return ret;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t eg, EventBits_t bits, BaseType_t clear, BaseType_t all, TickType_t ticks)
+{
+    struct timespec deadline;
+    deadline_of(ticks, &deadline);
+    pthread_mutex_lock(&eg->lock);
+    for (;;) {
+        EventBits_t hit = eg->bits & bits;
+        if (all ? hit == bits : hit != 0) {
+            break;
+        }
+        if (!cond_wait_ticks(&eg->changed, &eg->lock, ticks, &deadline)) {
+            break;
+        }
+    }
+    EventBits_t ret = eg->bits;
+    EventBits_t hit = eg->bits & bits;
+    if (clear && (all ? hit == bits : hit != 0)) {
+        eg->bits &= ~bits;
+    }
+    pthread_mutex_unlock(&eg->lock);
+    return ret;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    pthread_exit(NULL);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    usleep(ticks * 1000);
+}
+
+typedef struct {
+    void (*main_func)(void *arg);
+    void *arg;
+} thread_start_t;
+
+static void *thread_entry(void *param)
+{
+    thread_start_t start = *(thread_start_t *)param;
+    free(param);
+    start.main_func(start.arg);
+    return NULL;
+}
+
+esp_err_t audio_thread_create(audio_thread_t *p_handle, const char *name, void (*main_func)(void *arg), void *arg,
+                              uint32_t stack, int prio, bool stack_in_ext, int core_id)
+{
+    pthread_t tid;
+    thread_start_t *start = malloc(sizeof(thread_start_t));
+    start->main_func = main_func;
+    start->arg = arg;
+    if (pthread_create(&tid, NULL, thread_entry, start) != 0) {
+        free(start);
+        return ESP_FAIL;
+    }
+    pthread_detach(tid);
+    if (p_handle) {
+        *p_handle = (audio_thread_t)tid;
+    }
+    return ESP_OK;
+}
+
+void *mutex_create(void)
+{
+    pthread_mutex_t *m = malloc(sizeof(pthread_mutex_t));
+    pthread_mutex_init(m, NULL);
+    return m;
+}
+
+int mutex_destroy(void *mutex)
+{
+    pthread_mutex_destroy(mutex);
+    free(mutex);
+    return 0;
+}
+
+int mutex_lock(void *mutex)
+{
+    return pthread_mutex_lock(mutex);
+}
+
+int mutex_unlock(void *mutex)
+{
+    return pthread_mutex_unlock(mutex);
+}
+
+struct shim_timer {
+    pthread_t       tid;
+    pthread_mutex_t lock;
+    pthread_cond_t  changed;
+    esp_timer_cb_t  callback;
+    void            *arg;
+    int64_t         expire;  // 0 when not armed
+    bool            exit;
+};
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+static void *timer_entry(void *param)
+{
+    esp_timer_handle_t t = param;
+    pthread_mutex_lock(&t->lock);
+    while (!t->exit) {
+        if (t->expire == 0) {
+            pthread_cond_wait(&t->changed, &t->lock);
+            continue;
+        }
+        int64_t now = esp_timer_get_time();
+        if (now < t->expire) {
+            int64_t wait = t->expire - now;
+            pthread_mutex_unlock(&t->lock);
+            usleep(wait > 1000 ? 1000 : wait);
+            pthread_mutex_lock(&t->lock);
+            continue;
+        }
+        t->expire = 0;
+        pthread_mutex_unlock(&t->lock);
+        t->callback(t->arg);
+        pthread_mutex_lock(&t->lock);
+    }
+    pthread_mutex_unlock(&t->lock);
+    return NULL;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out_handle)
+{
+    esp_timer_handle_t t = calloc(1, sizeof(struct shim_timer));
+    t->callback = args->callback;
+    t->arg = args->arg;
+    pthread_mutex_init(&t->lock, NULL);
+    pthread_cond_init(&t->changed, NULL);
+    pthread_create(&t->tid, NULL, timer_entry, t);
+    *out_handle = t;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeout_us)
+{
+    pthread_mutex_lock(&t->lock);
+    t->expire = esp_timer_get_time() + timeout_us;
+    pthread_cond_broadcast(&t->changed);
+    pthread_mutex_unlock(&t->lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t t)
+{
+    pthread_mutex_lock(&t->lock);
+    t->expire = 0;
+    pthread_mutex_unlock(&t->lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t t)
+{
+    pthread_mutex_lock(&t->lock);
+    t->exit = true;
+    pthread_cond_broadcast(&t->changed);
+    pthread_mutex_unlock(&t->lock);
+    pthread_join(t->tid, NULL);
+    pthread_mutex_destroy(&t->lock);
+    pthread_cond_destroy(&t->changed);
+    free(t);
+    return ESP_OK;
+}
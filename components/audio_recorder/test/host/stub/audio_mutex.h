@@ -0,0 +1,5 @@
+#pragma once
+void *mutex_create(void);
+int mutex_destroy(void *mutex);
+int mutex_lock(void *mutex);
+int mutex_unlock(void *mutex);
@@ -0,0 +1,9 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+typedef void *audio_thread_t;
+
+esp_err_t audio_thread_create(audio_thread_t *p_handle, const char *name, void (*main_func)(void *arg), void *arg,
+                              uint32_t stack, int prio, bool stack_in_ext, int core_id);
@@ -0,0 +1,52 @@
+/* Stub of the esp-sr AFE interface, only the members used by recorder_sr */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+    WAKENET_NO_DETECT = 0,
+    WAKENET_CHANNEL_VERIFIED = -1,
+    WAKENET_DETECTED = 1,
+} wakenet_state_t;
+
+typedef enum {
+    AFE_VAD_SILENCE = 0,
+    AFE_VAD_SPEECH,
+} afe_vad_state_t;
+
+typedef struct {
+    bool aec_init;
+    bool vad_init;
+    bool wakenet_init;
+    char *wakenet_model_name;
+} afe_config_t;
+
+#define AFE_CONFIG_DEFAULT() {  \
+    .aec_init = false,          \
+    .vad_init = true,           \
+    .wakenet_init = true,       \
+    .wakenet_model_name = NULL, \
+}
+
+typedef struct {
+    int16_t *data;
+    int     data_size;
+    int     wakeup_state;
+    int     wake_word_index;
+    int     vad_state;
+} afe_fetch_result_t;
+
+typedef struct esp_afe_sr_data_t esp_afe_sr_data_t;
+
+typedef struct {
+    esp_afe_sr_data_t *(*create_from_config)(afe_config_t *cfg);
+    int (*feed)(esp_afe_sr_data_t *afe, const int16_t *in);
+    afe_fetch_result_t *(*fetch)(esp_afe_sr_data_t *afe);
+    int (*get_feed_chunksize)(esp_afe_sr_data_t *afe);
+    int (*get_fetch_chunksize)(esp_afe_sr_data_t *afe);
+    int (*enable_wakenet)(esp_afe_sr_data_t *afe);
+    int (*disable_wakenet)(esp_afe_sr_data_t *afe);
+    int (*enable_aec)(esp_afe_sr_data_t *afe);
+    int (*disable_aec)(esp_afe_sr_data_t *afe);
+    void (*destroy)(esp_afe_sr_data_t *afe);
+} esp_afe_sr_iface_t;
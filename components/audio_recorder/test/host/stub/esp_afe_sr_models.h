@@ -0,0 +1,3 @@
+#pragma once
+#include "esp_afe_sr_iface.h"
+extern const esp_afe_sr_iface_t ESP_AFE_SR_HANDLE;
@@ -0,0 +1,2 @@
+#pragma once
+#define ESP_MN_CHINESE "cn"
@@ -0,0 +1,2 @@
+#pragma once
+#define ESP_WN_PREFIX "wn"
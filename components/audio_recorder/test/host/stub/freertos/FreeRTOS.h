@@ -0,0 +1,26 @@
+/* Host shim of the FreeRTOS subset used by audio_recorder, one tick is one millisecond */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+#include "esp_err.h"
+
+typedef uint32_t TickType_t;
+typedef int      BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define portMAX_DELAY        ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS   (1)
+#define portTICK_RATE_MS     (1)
+#define pdMS_TO_TICKS(ms)    ((TickType_t)(ms))
+#define pdTRUE               (1)
+#define pdFALSE              (0)
+#define pdPASS               (pdTRUE)
+#define pdFAIL               (pdFALSE)
+
+#define BIT(n)               (1UL << (n))
+#define BIT0                 BIT(0)
+#define BIT1                 BIT(1)
+#define BIT2                 BIT(2)
+#define BIT3                 BIT(3)
@@ -0,0 +1,11 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+typedef uint32_t EventBits_t;
+typedef struct shim_event_group *EventGroupHandle_t;
+
+EventGroupHandle_t xEventGroupCreate(void);
+void vEventGroupDelete(EventGroupHandle_t eg);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t eg, EventBits_t bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t eg, EventBits_t bits);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t eg, EventBits_t bits, BaseType_t clear, BaseType_t all, TickType_t ticks);
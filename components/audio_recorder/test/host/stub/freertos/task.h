@@ -0,0 +1,7 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
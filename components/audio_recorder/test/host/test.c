@@ -0,0 +1,305 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "audio_recorder.h"
+#include "recorder_sr.h"
+#include "recorder_frame_pool.h"
+#include "model_path.h"
+#include "host_test.h"
+
+/*
+ * The AFE is replaced by a stub which produces a frame every AFE_FRAME_MS, every sample of a frame holds the
+ * frame sequence, the wake word and the vad state are driven by the test.
+ */
+#define AFE_CHUNK_SIZE      (512)
+#define AFE_FRAME_BYTES     (AFE_CHUNK_SIZE * sizeof(int16_t))
+#define AFE_FRAME_MS        (2)
+#define SR_FRAME_NUM        (6)
+#define READ_FRAME_NUM      (100)
+#define EVENT_MAX           (16)
+
+static struct {
+    int16_t            seq;
+    volatile bool      wakeup;
+    volatile bool      speech;
+    int16_t            data[AFE_CHUNK_SIZE];
+    afe_fetch_result_t res;
+} afe;
+
+static struct {
+    volatile int    num;
+    audio_rec_evt_t e[EVENT_MAX];
+} events;
+
+static esp_afe_sr_data_t *afe_create_from_config(afe_config_t *cfg)
+{
+    return (esp_afe_sr_data_t *)&afe;
+}
+
+static int afe_feed(esp_afe_sr_data_t *handle, const int16_t *in)
+{
+    return AFE_CHUNK_SIZE;
+}
+
+static afe_fetch_result_t *afe_fetch(esp_afe_sr_data_t *handle)
+{
+    usleep(AFE_FRAME_MS * 1000);
+    afe.seq++;
+    for (int i = 0; i < AFE_CHUNK_SIZE; i++) {
+        afe.data[i] = afe.seq;
+    }
+    afe.res.data = afe.data;
+    afe.res.data_size = AFE_FRAME_BYTES;
+    afe.res.wakeup_state = afe.wakeup ? WAKENET_DETECTED : WAKENET_NO_DETECT;
+    afe.res.vad_state = afe.speech ? AFE_VAD_SPEECH : AFE_VAD_SILENCE;
+    afe.wakeup = false;
+    return &afe.res;
+}
+
+static int afe_get_chunksize(esp_afe_sr_data_t *handle)
+{
+    return AFE_CHUNK_SIZE;
+}
+
+static int afe_switch(esp_afe_sr_data_t *handle)
+{
+    return 1;
+}
+
+static void afe_destroy(esp_afe_sr_data_t *handle)
+{
+}
+
+const esp_afe_sr_iface_t ESP_AFE_SR_HANDLE = {
+    .create_from_config = afe_create_from_config,
+    .feed = afe_feed,
+    .fetch = afe_fetch,
+    .get_feed_chunksize = afe_get_chunksize,
+    .get_fetch_chunksize = afe_get_chunksize,
+    .enable_wakenet = afe_switch,
+    .disable_wakenet = afe_switch,
+    .enable_aec = afe_switch,
+    .disable_aec = afe_switch,
+    .destroy = afe_destroy,
+};
+
+static srmodel_list_t models;
+
+srmodel_list_t *esp_srmodel_init(const char *partition_label)
+{
+    return &models;
+}
+
+char *esp_srmodel_filter(srmodel_list_t *models, const char *keyword1, const char *keyword2)
+{
+    return "wn_stub";
+}
+
+void esp_srmodel_deinit(srmodel_list_t *models)
+{
+}
+
+static int mic_read(void *buffer, int buf_sz, void *user_ctx, TickType_t ticks)
+{
+    usleep(1000);
+    memset(buffer, 0, buf_sz);
+    return buf_sz;
+}
+
+static esp_err_t on_event(audio_rec_evt_t event, void *user_data)
+{
+    CHECK(events.num < EVENT_MAX);
+    events.e[events.num++] = event;
+    return ESP_OK;
+}
+
+static bool wait_event(audio_rec_evt_t event, int timeout_ms)
+{
+    for (int t = 0; t < timeout_ms; t++) {
+        for (int i = 0; i < events.num; i++) {
+            if (events.e[i] == event) {
+                return true;
+            }
+        }
+        usleep(1000);
+    }
+    return false;
+}
+
+static int frame_seq(const recorder_frame_t *frame)
+{
+    const int16_t *s = (const int16_t *)frame->data;
+    for (int i = 1; i < frame->len / 2; i++) {
+        if (s[i] != s[0]) {
+            return -1;
+        }
+    }
+    return s[0];
+}
+
+static void test_pool(void)
+{
+    recorder_frame_pool_handle_t pool = recorder_frame_pool_create(4, 3);
+    CHECK(pool);
+
+    // Overrun drops the oldest frames and keeps the newest ones in order
+    for (int i = 0; i < 5; i++) {
+        recorder_frame_t *frame = recorder_frame_pool_get(pool, 0, true);
+        CHECK(frame);
+        memset(frame->data, i, 4);
+        frame->len = 4;
+        CHECK(recorder_frame_pool_put(pool, frame) == ESP_OK);
+    }
+    CHECK(recorder_frame_pool_get_dropped(pool) == 2);
+    for (int i = 2; i < 5; i++) {
+        recorder_frame_t *frame = recorder_frame_pool_take(pool, 0);
+        CHECK(frame && frame->len == 4 && frame->data[0] == i);
+        recorder_frame_pool_release(pool, frame);
+    }
+    CHECK(recorder_frame_pool_take(pool, 0) == NULL);
+
+    // Without `drop_oldest` the producer waits for the reader instead
+    recorder_frame_t *held[3];
+    for (int i = 0; i < 3; i++) {
+        held[i] = recorder_frame_pool_get(pool, 0, false);
+        CHECK(held[i]);
+    }
+    CHECK(recorder_frame_pool_get(pool, 5, false) == NULL);
+    for (int i = 0; i < 3; i++) {
+        memset(held[i]->data, 10 + i, 4);
+        held[i]->len = i + 2;
+        recorder_frame_pool_put(pool, held[i]);
+    }
+
+    // The byte stream reader crosses frames, done lets it drain the frames then end
+    recorder_frame_pool_done(pool);
+    CHECK(recorder_frame_pool_get(pool, 0, true) == NULL);
+    uint8_t buf[16];
+    CHECK(recorder_frame_pool_read(pool, buf, 3, 0) == 3);
+    CHECK(buf[0] == 10 && buf[1] == 10 && buf[2] == 11);
+    CHECK(recorder_frame_pool_read(pool, buf, sizeof(buf), 0) == 6);
+    CHECK(buf[0] == 11 && buf[1] == 11 && buf[2] == 12 && buf[5] == 12);
+    CHECK(recorder_frame_pool_read(pool, buf, sizeof(buf), portMAX_DELAY) == 0);
+    CHECK(recorder_frame_pool_take(pool, portMAX_DELAY) == NULL);
+
+    // Reset takes back everything, a partly read frame included
+    recorder_frame_pool_reset(pool);
+    recorder_frame_t *frame = recorder_frame_pool_get(pool, 0, false);
+    frame->len = 4;
+    recorder_frame_pool_put(pool, frame);
+    CHECK(recorder_frame_pool_read(pool, buf, 1, 0) == 1);
+    recorder_frame_pool_reset(pool);
+    for (int i = 0; i < 3; i++) {
+        held[i] = recorder_frame_pool_get(pool, 0, false);
+        CHECK(held[i]);
+    }
+    for (int i = 0; i < 3; i++) {
+        recorder_frame_pool_release(pool, held[i]);
+    }
+    recorder_frame_pool_destroy(pool);
+    printf("pool: ok\n");
+}
+
+static void test_recorder(void)
+{
+    recorder_sr_cfg_t sr_cfg = {
+        .afe_cfg = AFE_CONFIG_DEFAULT(),
+        .input_order = { DAT_CH_0, DAT_CH_1, DAT_CH_2, DAT_CH_IDLE },
+        .rb_size = SR_FRAME_NUM * AFE_FRAME_BYTES,
+    };
+    recorder_sr_iface_t *sr_iface = NULL;
+    recorder_sr_handle_t sr = recorder_sr_create(&sr_cfg, &sr_iface);
+    CHECK(sr && sr_iface);
+
+    audio_rec_cfg_t cfg = AUDIO_RECORDER_DEFAULT_CFG();
+    cfg.event_cb = on_event;
+    cfg.read = mic_read;
+    cfg.sr_handle = sr;
+    cfg.sr_iface = sr_iface;
+    cfg.wakeup_time = 2000;
+    cfg.vad_start = 20;
+    cfg.vad_off = 40;
+    cfg.wakeup_end = 40;
+    audio_rec_handle_t rec = audio_recorder_create(&cfg);
+    CHECK(rec);
+
+    recorder_frame_t *frame = NULL;
+    usleep(50 * 1000);
+    CHECK(audio_recorder_frame_acquire(rec, &frame, 0) == ESP_FAIL && frame == NULL);
+
+    afe.speech = true;
+    afe.wakeup = true;
+    CHECK(wait_event(AUDIO_REC_VAD_START, 1000));
+
+    // Frames come by reference out of the sr pool, in order and without loss while the reader keeps up
+    uint8_t *addrs[SR_FRAME_NUM] = { 0 };
+    int addr_num = 0;
+    int last = -1;
+    for (int i = 0; i < READ_FRAME_NUM; i++) {
+        CHECK(audio_recorder_frame_acquire(rec, &frame, 1000) == ESP_OK);
+        CHECK(frame->len == AFE_FRAME_BYTES);
+        int seq = frame_seq(frame);
+        CHECK(seq >= 0);
+        CHECK(last < 0 || seq == last + 1);
+        last = seq;
+        int k = 0;
+        while (k < addr_num && addrs[k] != frame->data) {
+            k++;
+        }
+        if (k == addr_num) {
+            CHECK(addr_num < SR_FRAME_NUM);
+            addrs[addr_num++] = frame->data;
+        }
+        CHECK(audio_recorder_frame_release(rec, frame) == ESP_OK);
+    }
+
+    // The copying read goes on with the next frame
+    int16_t pcm[AFE_CHUNK_SIZE * 3 / 2];
+    CHECK(audio_recorder_data_read(rec, pcm, sizeof(pcm), 1000) == sizeof(pcm));
+    CHECK(pcm[0] > last && pcm[AFE_CHUNK_SIZE - 1] == pcm[0] && pcm[AFE_CHUNK_SIZE] == pcm[0] + 1);
+    CHECK(pcm[AFE_CHUNK_SIZE * 3 / 2 - 1] == pcm[0] + 1);
+
+    afe.speech = false;
+    CHECK(wait_event(AUDIO_REC_WAKEUP_END, 1000));
+    CHECK(audio_recorder_frame_acquire(rec, &frame, 0) == ESP_FAIL);
+    audio_rec_evt_t expect[] = { AUDIO_REC_WAKEUP_START, AUDIO_REC_VAD_START, AUDIO_REC_VAD_END, AUDIO_REC_WAKEUP_END };
+    CHECK(events.num == sizeof(expect) / sizeof(expect[0]));
+    CHECK(memcmp(events.e, expect, sizeof(expect)) == 0);
+
+    CHECK(audio_recorder_destroy(rec) == ESP_OK);
+    CHECK(recorder_sr_destroy(sr) == ESP_OK);
+    printf("recorder: ok, %d frames read through %d buffers\n", READ_FRAME_NUM, addr_num);
+}
+
+int main(int argc, char *argv[])
+{
+    test_pool();
+    test_recorder();
+    return 0;
+}
@@ -29,6 +29,8 @@
 #include "esp_log.h"
 #include "audio_mem.h"
 #include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "mem_pool.h"
 
 #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 4, 4)
 #include "hal/efuse_hal.h"
@@ -38,6 +40,44 @@
 
 // #define ENABLE_AUDIO_MEM_TRACE
 
+#define AUDIO_MEM_REGION_INTERNAL   (0)
+#define AUDIO_MEM_REGION_SPIRAM     (1)
+
+static mem_pool_t   s_mem_pool;
+static void         *s_mem_pool_region[MEM_POOL_REGION_NUM];
+static bool         s_mem_pool_ready;
+static portMUX_TYPE s_mem_pool_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void _mem_pool_lock(void *ctx)
+{
+    portENTER_CRITICAL((portMUX_TYPE *)ctx);
+}
+
+static void _mem_pool_unlock(void *ctx)
+{
+    portEXIT_CRITICAL((portMUX_TYPE *)ctx);
+}
+
+static int _mem_region(audio_mem_caps_t caps)
+{
+    if (caps == AUDIO_MEM_CAPS_INTERNAL) {
+        return AUDIO_MEM_REGION_INTERNAL;
+    }
+    if (caps == AUDIO_MEM_CAPS_SPIRAM) {
+        return AUDIO_MEM_REGION_SPIRAM;
+    }
+#if CONFIG_SPIRAM_BOOT_INIT
+    return AUDIO_MEM_REGION_SPIRAM;
+#else
+    return AUDIO_MEM_REGION_INTERNAL;
+#endif
+}
+
+static uint32_t _mem_heap_caps(int region)
+{
+    return region == AUDIO_MEM_REGION_SPIRAM ? MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT : MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+}
+
 void *audio_malloc(size_t size)
 {
     void *data =  NULL;
@@ -54,7 +94,9 @@ void *audio_malloc(size_t size)
 
 void audio_free(void *ptr)
 {
-    free(ptr);
+    if (!(s_mem_pool_ready && mem_pool_free(&s_mem_pool, ptr))) {
+        free(ptr);
+    }
 #ifdef ENABLE_AUDIO_MEM_TRACE
     ESP_LOGI("AUIDO_MEM", "free:%p, called:0x%08x", ptr, (intptr_t)__builtin_return_address(0) - 2);
 #endif
@@ -80,6 +122,20 @@ void *audio_calloc(size_t nmemb, size_t size)
 void *audio_realloc(void *ptr, size_t size)
 {
     void *p = NULL;
+    int region = s_mem_pool_ready ? mem_pool_region_of(&s_mem_pool, ptr) : -1;
+    if (region >= 0) {
+        // The block keeps its memory type, it grows out of the pool through the heap
+        size_t block_size = mem_pool_block_size(&s_mem_pool, ptr);
+        if (size <= block_size) {
+            return ptr;
+        }
+        p = heap_caps_malloc(size, _mem_heap_caps(region));
+        if (p) {
+            memcpy(p, ptr, block_size);
+            mem_pool_free(&s_mem_pool, ptr);
+        }
+        return p;
+    }
 #if CONFIG_SPIRAM_BOOT_INIT
     p = heap_caps_realloc(ptr, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
 #else
@@ -122,6 +178,167 @@ void *audio_calloc_inner(size_t n, size_t size)
     return data;
 }
 
+esp_err_t audio_mem_pool_init(const audio_mem_pool_cfg_t *cfg)
+{
+    if (cfg == NULL || (cfg->internal_size == 0 && cfg->spiram_size == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_mem_pool_ready) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    size_t size[MEM_POOL_REGION_NUM] = { cfg->internal_size, cfg->spiram_size };
+    mem_pool_init(&s_mem_pool, _mem_pool_lock, _mem_pool_unlock, &s_mem_pool_lock);
+    for (int i = 0; i < MEM_POOL_REGION_NUM; i++) {
+        if (size[i] == 0) {
+            continue;
+        }
+        s_mem_pool_region[i] = heap_caps_malloc(size[i], _mem_heap_caps(i));
+        if (s_mem_pool_region[i] == NULL || mem_pool_add_region(&s_mem_pool, i, s_mem_pool_region[i], size[i]) == 0) {
+            ESP_LOGE("AUDIO_MEM", "Failed to reserve %d bytes for the pool region %d", (int)size[i], i);
+            for (int k = 0; k <= i; k++) {
+                free(s_mem_pool_region[k]);
+                s_mem_pool_region[k] = NULL;
+            }
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    s_mem_pool_ready = true;
+    return ESP_OK;
+}
+
+esp_err_t audio_mem_pool_deinit(void)
+{
+    if (!s_mem_pool_ready) {
+        return ESP_OK;
+    }
+    mem_pool_stats_t stats;
+    for (int i = 0; i < MEM_POOL_REGION_NUM; i++) {
+        mem_pool_get_stats(&s_mem_pool, i, &stats);
+        if (stats.block_bytes) {
+            ESP_LOGE("AUDIO_MEM", "The pool region %d still holds %d bytes", i, (int)stats.block_bytes);
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+    s_mem_pool_ready = false;
+    for (int i = 0; i < MEM_POOL_REGION_NUM; i++) {
+        free(s_mem_pool_region[i]);
+        s_mem_pool_region[i] = NULL;
+    }
+    memset(&s_mem_pool, 0, sizeof(s_mem_pool));
+    return ESP_OK;
+}
+
+void *audio_mem_alloc(size_t size, audio_mem_caps_t caps, const char *owner)
+{
+    void *data = NULL;
+    int region = _mem_region(caps);
+    if (s_mem_pool_ready) {
+        int tag = mem_pool_owner(&s_mem_pool, owner);
+        data = mem_pool_alloc(&s_mem_pool, region, size, tag);
+        if (data == NULL) {
+            mem_pool_count_fallback(&s_mem_pool, tag);
+        }
+    }
+    if (data == NULL) {
+        data = heap_caps_malloc(size, _mem_heap_caps(region));
+    }
+#ifdef ENABLE_AUDIO_MEM_TRACE
+    ESP_LOGI("AUDIO_MEM", "mem_alloc:%p, size:%d, owner:%s, called:0x%08x", data, (int)size, owner ? owner : "-", (intptr_t)__builtin_return_address(0) - 2);
+#endif
+    return data;
+}
+
+void *audio_mem_calloc(size_t nmemb, size_t size, audio_mem_caps_t caps, const char *owner)
+{
+    void *data = audio_mem_alloc(nmemb * size, caps, owner);
+    if (data) {
+        memset(data, 0, nmemb * size);
+    }
+    return data;
+}
+
+char *audio_mem_strdup(const char *str, audio_mem_caps_t caps, const char *owner)
+{
+    size_t len = strlen(str) + 1;
+    char *copy = audio_mem_alloc(len, caps, owner);
+    if (copy) {
+        memcpy(copy, str, len);
+    }
+    return copy;
+}
+
+esp_err_t audio_mem_get_owner_stats(const char *owner, audio_mem_owner_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_mem_pool_ready) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    // Look the name up without adding it to the table
+    int num = __atomic_load_n(&s_mem_pool.num_owners, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < num; i++) {
+        if ((owner == NULL && i == 0) || (owner && i > 0 && strcmp(s_mem_pool.owner[i].name, owner) == 0)) {
+            mem_pool_owner_t o;
+            mem_pool_get_owner(&s_mem_pool, i, &o);
+            stats->live = o.live;
+            stats->peak = o.peak;
+            stats->blocks = o.blocks;
+            stats->fallbacks = o.fallbacks;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t audio_mem_get_frag(audio_mem_caps_t caps, audio_mem_frag_t *frag)
+{
+    if (frag == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int region = _mem_region(caps);
+    uint32_t heap_caps = _mem_heap_caps(region);
+    memset(frag, 0, sizeof(audio_mem_frag_t));
+    frag->free_size = heap_caps_get_free_size(heap_caps);
+    frag->largest_free_block = heap_caps_get_largest_free_block(heap_caps);
+    if (frag->free_size) {
+        frag->heap_frag = 1000 - (int)((uint64_t)frag->largest_free_block * 1000 / frag->free_size);
+    }
+    if (s_mem_pool_ready) {
+        mem_pool_stats_t stats;
+        mem_pool_get_stats(&s_mem_pool, region, &stats);
+        frag->pool_size = stats.slabs * MEM_POOL_SLAB_SIZE;
+        frag->pool_used = stats.block_bytes;
+        frag->pool_frag = stats.frag;
+    }
+    return ESP_OK;
+}
+
+void audio_mem_pool_print(const char *tag)
+{
+    audio_mem_frag_t frag;
+    const char *name[MEM_POOL_REGION_NUM] = { "Inter", "SPIRAM" };
+    audio_mem_caps_t caps[MEM_POOL_REGION_NUM] = { AUDIO_MEM_CAPS_INTERNAL, AUDIO_MEM_CAPS_SPIRAM };
+    for (int i = 0; i < MEM_POOL_REGION_NUM; i++) {
+        if (i == AUDIO_MEM_REGION_SPIRAM && !audio_mem_spiram_is_enabled()) {
+            break;
+        }
+        audio_mem_get_frag(caps[i], &frag);
+        ESP_LOGI(tag, "%s heap free:%d, largest:%d, frag:%d.%d%%, pool used:%d/%d, frag:%d.%d%%", name[i],
+                 (int)frag.free_size, (int)frag.largest_free_block, frag.heap_frag / 10, frag.heap_frag % 10,
+                 (int)frag.pool_used, (int)frag.pool_size, frag.pool_frag / 10, frag.pool_frag % 10);
+    }
+    if (!s_mem_pool_ready) {
+        return;
+    }
+    int num = __atomic_load_n(&s_mem_pool.num_owners, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < num; i++) {
+        mem_pool_owner_t o;
+        mem_pool_get_owner(&s_mem_pool, i, &o);
+        ESP_LOGI(tag, "  %-16s live:%d, peak:%d, blocks:%d, fallbacks:%d", o.name, (int)o.live, (int)o.peak, (int)o.blocks, (int)o.fallbacks);
+    }
+}
+
 void audio_mem_print(const char *tag, int line, const char *func)
 {
 #ifdef CONFIG_SPIRAM_BOOT_INIT
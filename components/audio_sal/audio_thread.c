@@ -22,6 +22,7 @@
  *
  */
 
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "freertos/task.h"
@@ -33,6 +34,27 @@
 
 static const char *TAG = "AUDIO_THREAD";
 
+#define AUDIO_THREAD_WORKER_PRIO    (1)
+#define AUDIO_THREAD_WORKER_TAG_LEN (16)
+
+typedef struct {
+    audio_thread_t  task;
+    uint32_t        stack;
+    bool            stack_in_ext;
+    int             core_id;
+    bool            busy;
+    void            (*main_func)(void *arg);
+    void            *arg;
+    char            tag[AUDIO_THREAD_WORKER_TAG_LEN];
+} audio_thread_worker_t;
+
+static struct {
+    SemaphoreHandle_t       lock;
+    SemaphoreHandle_t       exited;
+    audio_thread_worker_t   *workers;
+    int                     num;
+} s_pool;
+
 BaseType_t __attribute__((weak)) xTaskCreateRestrictedPinnedToCore(const TaskParameters_t *const pxTaskDefinition, TaskHandle_t *pxCreatedTask, const BaseType_t xCoreID)
 {
     ESP_LOGE(TAG, "Not found right %s.\r\nPlease enter IDF-PATH with \"cd $IDF_PATH\" and apply the IDF patch with \"git apply $ADF_PATH/idf_patches/idf_%.4s_freertos.patch\" first\r\n", __func__, IDF_VER);
@@ -87,6 +109,151 @@ audio_thread_create_error:
     return ESP_FAIL;
 }
 
+static void audio_thread_worker_task(void *pv)
+{
+    audio_thread_worker_t *worker = (audio_thread_worker_t *)pv;
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        // `main_func` is set before every wake up, NULL asks the worker to exit
+        if (worker->main_func == NULL) {
+            break;
+        }
+        worker->main_func(worker->arg);
+        // Park only now that `main_func` has returned, a new borrower can not wake the worker while it still runs
+        xSemaphoreTake(s_pool.lock, portMAX_DELAY);
+        ESP_LOGD(TAG, "The worker of %s parks", worker->tag);
+        vTaskPrioritySet(NULL, AUDIO_THREAD_WORKER_PRIO);
+        worker->tag[0] = '\0';
+        worker->busy = false;
+        xSemaphoreGive(s_pool.lock);
+    }
+    xSemaphoreGive(s_pool.exited);
+    vTaskDelete(NULL);
+}
+
+esp_err_t audio_thread_pool_init(const audio_thread_pool_class_t *classes, int num_classes)
+{
+    AUDIO_NULL_CHECK(TAG, classes, return ESP_ERR_INVALID_ARG);
+    if (s_pool.lock) {
+        ESP_LOGW(TAG, "The thread pool already created");
+        return ESP_ERR_INVALID_STATE;
+    }
+    int total = 0;
+    for (int i = 0; i < num_classes; i++) {
+        AUDIO_CHECK(TAG, classes[i].stack > 0 && classes[i].count >= 0, return ESP_ERR_INVALID_ARG, "Invalid pool class");
+        total += classes[i].count;
+    }
+    AUDIO_CHECK(TAG, total > 0, return ESP_ERR_INVALID_ARG, "Empty pool");
+    s_pool.workers = (audio_thread_worker_t *)audio_calloc(total, sizeof(audio_thread_worker_t));
+    AUDIO_MEM_CHECK(TAG, s_pool.workers, return ESP_FAIL);
+    s_pool.lock = xSemaphoreCreateMutex();
+    s_pool.exited = xSemaphoreCreateCounting(total, 0);
+    AUDIO_MEM_CHECK(TAG, s_pool.lock && s_pool.exited, goto _pool_init_failed);
+    for (int i = 0; i < num_classes; i++) {
+        for (int n = 0; n < classes[i].count; n++) {
+            audio_thread_worker_t *worker = &s_pool.workers[s_pool.num];
+            worker->stack = classes[i].stack;
+            worker->stack_in_ext = classes[i].stack_in_ext;
+            worker->core_id = classes[i].core_id;
+            if (audio_thread_create(&worker->task, "audio_worker", audio_thread_worker_task, worker, worker->stack,
+                                    AUDIO_THREAD_WORKER_PRIO, worker->stack_in_ext, worker->core_id) != ESP_OK) {
+                goto _pool_init_failed;
+            }
+            s_pool.num++;
+        }
+    }
+    ESP_LOGI(TAG, "Thread pool created, %d workers in %d classes", s_pool.num, num_classes);
+    return ESP_OK;
+
+_pool_init_failed:
+    audio_thread_pool_deinit();
+    return ESP_FAIL;
+}
+
+esp_err_t audio_thread_pool_deinit(void)
+{
+    if (s_pool.lock) {
+        xSemaphoreTake(s_pool.lock, portMAX_DELAY);
+        for (int i = 0; i < s_pool.num; i++) {
+            if (s_pool.workers[i].busy) {
+                xSemaphoreGive(s_pool.lock);
+                ESP_LOGE(TAG, "The worker %d is still borrowed by %s", i, s_pool.workers[i].tag);
+                return ESP_ERR_INVALID_STATE;
+            }
+        }
+        for (int i = 0; i < s_pool.num; i++) {
+            s_pool.workers[i].main_func = NULL;
+            xTaskNotifyGive(s_pool.workers[i].task);
+        }
+        xSemaphoreGive(s_pool.lock);
+        // The workers still read their slot when they wake up, wait for all of them before freeing it
+        for (int i = 0; i < s_pool.num; i++) {
+            xSemaphoreTake(s_pool.exited, portMAX_DELAY);
+        }
+        vSemaphoreDelete(s_pool.lock);
+    }
+    if (s_pool.exited) {
+        vSemaphoreDelete(s_pool.exited);
+    }
+    audio_free(s_pool.workers);
+    memset(&s_pool, 0, sizeof(s_pool));
+    return ESP_OK;
+}
+
+esp_err_t audio_thread_borrow(audio_thread_t *p_handle, const char *name, void(*main_func)(void *arg), void *arg,
+                              uint32_t stack, int prio, bool stack_in_ext, int core_id)
+{
+    audio_thread_worker_t *worker = NULL;
+    if (s_pool.lock) {
+        xSemaphoreTake(s_pool.lock, portMAX_DELAY);
+        for (int i = 0; i < s_pool.num; i++) {
+            audio_thread_worker_t *w = &s_pool.workers[i];
+            if (w->busy || w->stack < stack || w->core_id != core_id || (w->stack_in_ext && !stack_in_ext)) {
+                continue;
+            }
+            if (worker == NULL || w->stack < worker->stack) {
+                worker = w;
+            }
+        }
+        if (worker) {
+            worker->busy = true;
+            worker->main_func = main_func;
+            worker->arg = arg;
+            // The task keeps the pool name, the worker keeps the borrower's one for the logs
+            strncpy(worker->tag, name ? name : "", sizeof(worker->tag) - 1);
+        }
+        xSemaphoreGive(s_pool.lock);
+    }
+    if (worker == NULL) {
+        ESP_LOGD(TAG, "No parked worker for %s, create it", name);
+        return audio_thread_create(p_handle, name, main_func, arg, stack, prio, stack_in_ext, core_id);
+    }
+    ESP_LOGD(TAG, "The %s task runs on a parked worker of %d bytes stack", name, worker->stack);
+    vTaskPrioritySet(worker->task, prio);
+    if (p_handle) {
+        *p_handle = worker->task;
+    }
+    xTaskNotifyGive(worker->task);
+    return ESP_OK;
+}
+
+static bool audio_thread_is_borrowed(audio_thread_t task)
+{
+    bool borrowed = false;
+    if (s_pool.lock == NULL) {
+        return borrowed;
+    }
+    xSemaphoreTake(s_pool.lock, portMAX_DELAY);
+    for (int i = 0; i < s_pool.num; i++) {
+        if (s_pool.workers[i].task == task && s_pool.workers[i].busy) {
+            borrowed = true;
+            break;
+        }
+    }
+    xSemaphoreGive(s_pool.lock);
+    return borrowed;
+}
+
 esp_err_t audio_thread_cleanup(audio_thread_t *p_handle)
 {
     // TODO nothing
@@ -95,6 +262,10 @@ esp_err_t audio_thread_cleanup(audio_thread_t *p_handle)
 
 esp_err_t audio_thread_delete_task(audio_thread_t *p_handle)
 {
+    // A borrowed worker is given back by its own loop once `main_func` returns
+    if (audio_thread_is_borrowed(xTaskGetCurrentTaskHandle())) {
+        return ESP_OK;
+    }
     vTaskDelete(NULL);
     return ESP_OK; /* Control never reach here if this is self delete */
 }
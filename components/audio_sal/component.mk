@@ -1,6 +1,8 @@
 #
 # Component Makefile
 
-COMPONENT_ADD_INCLUDEDIRS := . ./include
+COMPONENT_ADD_INCLUDEDIRS := . ./include ./lib/channel_layout/include
 
-COMPONENT_SRCDIRS :=  .
+COMPONENT_PRIV_INCLUDEDIRS := ./lib/mem_pool/include
+
+COMPONENT_SRCDIRS :=  . ./lib/channel_layout ./lib/mem_pool
@@ -26,6 +26,7 @@
 #define _AUDIO_MEM_H_
 
 #include <esp_types.h>
+#include "esp_err.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -131,6 +132,126 @@ bool audio_mem_spiram_is_enabled(void);
  */
 bool audio_mem_spiram_stack_is_enabled(void);
 
+/**
+ * @brief   Memory an allocation is pinned to
+ */
+typedef enum {
+    AUDIO_MEM_CAPS_DEFAULT = 0,     /*!< SPI ram when enabled, internal memory otherwise, the same as `audio_malloc` */
+    AUDIO_MEM_CAPS_INTERNAL,        /*!< Internal memory only */
+    AUDIO_MEM_CAPS_SPIRAM,          /*!< SPI ram only, fails when it is not enabled */
+} audio_mem_caps_t;
+
+/**
+ * @brief   Configuration of the small block pool
+ */
+typedef struct {
+    size_t  internal_size;  /*!< Bytes of internal memory kept for blocks up to 512 bytes, 0 for none */
+    size_t  spiram_size;    /*!< Bytes of SPI ram kept for blocks up to 512 bytes, 0 for none */
+} audio_mem_pool_cfg_t;
+
+/**
+ * @brief   Usage of an owner tag in the small block pool
+ */
+typedef struct {
+    uint32_t    live;       /*!< Bytes of the live blocks, counted by block size */
+    uint32_t    peak;       /*!< Highest `live` seen */
+    uint32_t    blocks;     /*!< Number of live blocks */
+    uint32_t    fallbacks;  /*!< Allocations the pool could not serve, they went to the heap */
+} audio_mem_owner_stats_t;
+
+/**
+ * @brief   Fragmentation of a memory type
+ */
+typedef struct {
+    size_t      free_size;          /*!< Free bytes of the heap */
+    size_t      largest_free_block; /*!< Largest block the heap can still give */
+    int         heap_frag;          /*!< Per mille of the free heap not in the largest free block */
+    size_t      pool_size;          /*!< Bytes of the pool slabs */
+    size_t      pool_used;          /*!< Bytes of the live pool blocks */
+    int         pool_frag;          /*!< Per mille of the pool slabs in use not held by live blocks */
+} audio_mem_frag_t;
+
+/**
+ * @brief   Reserve the small block pool, blocks up to 512 bytes are then served from size-class slabs
+ *          by `audio_mem_alloc` and friends and never split the heap
+ *
+ * @param[in]  cfg   The pool configuration
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_INVALID_ARG
+ *     - ESP_ERR_INVALID_STATE, the pool is already reserved
+ *     - ESP_ERR_NO_MEM
+ */
+esp_err_t audio_mem_pool_init(const audio_mem_pool_cfg_t *cfg);
+
+/**
+ * @brief   Give the small block pool back to the heap
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_INVALID_STATE, some blocks of the pool are still in use
+ */
+esp_err_t audio_mem_pool_deinit(void);
+
+/**
+ * @brief   Malloc memory in ADF pinned to a memory type, with an owner tag for the accounting
+ *
+ * @note    Small blocks come from the pool when it is reserved, the heap serves the rest.
+ *          Free the memory with `audio_free`.
+ *
+ * @param[in]  size    memory size
+ * @param[in]  caps    memory type
+ * @param[in]  owner   owner tag, kept by pointer so a string literal is expected, NULL for untagged
+ *
+ * @return
+ *     - valid pointer on success
+ *     - NULL when any errors
+ */
+void *audio_mem_alloc(size_t size, audio_mem_caps_t caps, const char *owner);
+
+/**
+ * @brief   Same as `audio_mem_alloc` and clear the memory
+ */
+void *audio_mem_calloc(size_t nmemb, size_t size, audio_mem_caps_t caps, const char *owner);
+
+/**
+ * @brief   Same as `audio_strdup` with the memory type and owner tag of `audio_mem_alloc`
+ */
+char *audio_mem_strdup(const char *str, audio_mem_caps_t caps, const char *owner);
+
+/**
+ * @brief   Get the pool usage of an owner tag
+ *
+ * @param[in]  owner   owner tag, NULL for the untagged blocks
+ * @param[out] stats   The usage
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_INVALID_STATE, the pool is not reserved
+ *     - ESP_ERR_NOT_FOUND, the owner never allocated
+ */
+esp_err_t audio_mem_get_owner_stats(const char *owner, audio_mem_owner_stats_t *stats);
+
+/**
+ * @brief   Get the fragmentation of the heap and of the pool for a memory type
+ *
+ * @param[in]  caps    memory type
+ * @param[out] frag    The fragmentation
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_INVALID_ARG
+ */
+esp_err_t audio_mem_get_frag(audio_mem_caps_t caps, audio_mem_frag_t *frag);
+
+/**
+ * @brief   Print the fragmentation and the usage of every owner tag
+ *
+ * @param[in]  tag    tag of log
+ */
+void audio_mem_pool_print(const char *tag);
+
 #define AUDIO_MEM_SHOW(x)  audio_mem_print(x, __LINE__, __func__)
 
 #ifdef __cplusplus
@@ -34,6 +34,16 @@ extern "C" {
 
 #define audio_thread_t xTaskHandle
 
+/**
+ * @brief       Stack size class of the parked worker pool
+ */
+typedef struct {
+    uint32_t    stack;          /*!< Stack size of the workers, requests up to this size are served by the class */
+    int         count;          /*!< Number of workers parked in this class */
+    bool        stack_in_ext;   /*!< Allocate the worker stacks in external memory */
+    int         core_id;        /*!< Core to which the workers are pinned */
+} audio_thread_pool_class_t;
+
 /**
  * @brief       Allocate handle if not allocated and create a thread
  *
@@ -56,6 +66,51 @@ extern "C" {
 esp_err_t audio_thread_create(audio_thread_t *p_handle, const char* name, void(*main_func)(void* arg), void *arg,
                               uint32_t stack, int prio, bool stack_in_ext, int core_id);
 
+/**
+ * @brief       Create the pool of parked worker tasks, the stacks of all classes are allocated once here
+ *
+ * @param       classes         Stack size classes of the pool
+ * @param       num_classes     Number of classes
+ *
+ * @return      - ESP_OK :      Pool created
+ *              - ESP_ERR_INVALID_ARG:   Invalid classes
+ *              - ESP_ERR_INVALID_STATE: Pool already created
+ *              - ESP_FAIL:     Failed to create the workers
+ *
+ * @note        Size each class with one worker more than the elements borrowing from it,
+ *              a worker is given back a few instructions after its borrower reports the task destroyed,
+ *              when `main_func` has returned, and parks again at the pool priority.
+ */
+esp_err_t audio_thread_pool_init(const audio_thread_pool_class_t *classes, int num_classes);
+
+/**
+ * @brief       Stop all the parked workers and free the pool
+ *
+ * @return      - ESP_OK :      Pool destroyed
+ *              - ESP_ERR_INVALID_STATE: Some workers are still borrowed
+ */
+esp_err_t audio_thread_pool_deinit(void);
+
+/**
+ * @brief       Run `main_func` on a parked worker of the pool, or create a thread when no worker fits
+ *
+ *              The smallest free worker with at least `stack` bytes pinned to `core_id` is woken up with priority `prio`,
+ *              an internal memory worker may serve a `stack_in_ext` request but not the other way around.
+ *
+ * @param       p_handle        pointer to audio_thread_t handle, set to the worker task
+ * @param       name            Task name when a thread is created, a worker keeps the pool name and shows this one in the logs
+ * @param       main_func       The function which task will execute, it must end with `audio_thread_delete_task`
+ * @param       stack           Task stack
+ * @param       prio            Task priority
+ * @param       stack_in_ext    If task should reside in external memory
+ * @param       core_id         Core to which task will be pinned
+ *
+ * @return      - ESP_OK :      Worker borrowed or task created
+ *              - ESP_FAIL:     Failed to create task
+ */
+esp_err_t audio_thread_borrow(audio_thread_t *p_handle, const char *name, void(*main_func)(void *arg), void *arg,
+                              uint32_t stack, int prio, bool stack_in_ext, int core_id);
+
 /**
  * @brief       Cleanup all the task memory
  *
@@ -76,7 +131,9 @@ esp_err_t audio_thread_cleanup(audio_thread_t *p_handle);
  * @return      - ESP_OK :      Task deleted successfully
  *              - ESP_FAIL:     Task is not running or cleaned up
  *
- * @note        This only deletes the task and all the memory cleanup should be done with `audio_thread_cleanup`
+ * @note        This only deletes the task and all the memory cleanup should be done with `audio_thread_cleanup`.
+ *              On a worker borrowed with `audio_thread_borrow` the worker is given back to the pool instead
+ *              and parks once `main_func` returns, so this must be the last call of `main_func`.
  */
 esp_err_t audio_thread_delete_task(audio_thread_t *p_handle);
 
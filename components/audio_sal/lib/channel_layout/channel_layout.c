@@ -0,0 +1,323 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include <stdbool.h>
+#include "channel_layout.h"
+
+#define GAIN_SHIFT       (12)
+#define GAIN_FAST_MAX    (0xFFFF)   // 16-bit sample times gain still fits in int32
+#define IS_ALIGNED4(p)   ((((uintptr_t)(p)) & 3) == 0)
+
+// Two 16-bit samples are moved as one word where the buffers allow it
+typedef uint32_t __attribute__((__may_alias__)) word_t;
+
+static inline int16_t sat16(int64_t v)
+{
+    return v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : (int16_t)v);
+}
+
+static inline int32_t sat32(int64_t v)
+{
+    return v > INT32_MAX ? INT32_MAX : (v < INT32_MIN ? INT32_MIN : (int32_t)v);
+}
+
+static inline int16_t scale16_fast(int32_t s, int32_t g)
+{
+    int32_t v = (s * g) >> GAIN_SHIFT;
+    return v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : (int16_t)v);
+}
+
+static inline int16_t scale16(int16_t s, int32_t g)
+{
+    return sat16(((int64_t)s * g) >> GAIN_SHIFT);
+}
+
+static inline int32_t scale32(int32_t s, int32_t g)
+{
+    return sat32(((int64_t)s * g) >> GAIN_SHIFT);
+}
+
+/*
+ * Generic remap, a frame is staged first so that in-place remap works, the extra slot reads as silence
+ */
+#define DEFINE_REMAP(name, type, scale)                                                                 \
+static void name(type *dst, int dst_ch, const type *src, int src_ch,                                    \
+                 const int8_t *order, const int32_t *gain, int frames)                                  \
+{                                                                                                       \
+    type frame[CHANNEL_LAYOUT_MAX_CH + 1];                                                              \
+    int8_t idx[CHANNEL_LAYOUT_MAX_CH];                                                                  \
+    for (int c = 0; c < dst_ch; c++) {                                                                  \
+        idx[c] = order[c] < 0 ? src_ch : order[c];                                                      \
+    }                                                                                                   \
+    frame[src_ch] = 0;                                                                                  \
+    for (int i = 0; i < frames; i++) {                                                                  \
+        memcpy(frame, src, src_ch * sizeof(type));                                                      \
+        if (gain) {                                                                                     \
+            for (int c = 0; c < dst_ch; c++) {                                                          \
+                dst[c] = scale(frame[idx[c]], gain[c]);                                                 \
+            }                                                                                           \
+        } else {                                                                                        \
+            for (int c = 0; c < dst_ch; c++) {                                                          \
+                dst[c] = frame[idx[c]];                                                                 \
+            }                                                                                           \
+        }                                                                                               \
+        src += src_ch;                                                                                  \
+        dst += dst_ch;                                                                                  \
+    }                                                                                                   \
+}
+
+DEFINE_REMAP(remap16, int16_t, scale16)
+DEFINE_REMAP(remap32, int32_t, scale32)
+
+/*
+ * Fast paths for the layouts of the call sites, plain loops with constant strides so that the compiler
+ * unrolls them, or vectorizes them where the target has SIMD
+ */
+// Stereo 16-bit swap, rotating each word swaps both samples of a frame at once
+static void swap16_2ch(int16_t *dst, const int16_t *src, int frames)
+{
+    word_t *d = (word_t *)dst;
+    const word_t *s = (const word_t *)src;
+#pragma GCC unroll 4
+    for (int i = 0; i < frames; i++) {
+        uint32_t a = s[i];
+        d[i] = (a >> 16) | (a << 16);
+    }
+}
+
+// Stereo 16-bit with gain, optionally swapped, the products stay in 32 bits
+static void gain16_2ch(int16_t *dst, const int16_t *src, bool swap, int32_t g0, int32_t g1, int frames)
+{
+    if (swap) {
+#pragma GCC unroll 2
+        for (int i = 0; i < frames; i++) {
+            int32_t a = src[2 * i + 1], b = src[2 * i];
+            dst[2 * i] = scale16_fast(a, g0);
+            dst[2 * i + 1] = scale16_fast(b, g1);
+        }
+    } else {
+#pragma GCC unroll 2
+        for (int i = 0; i < frames; i++) {
+            int32_t a = src[2 * i], b = src[2 * i + 1];
+            dst[2 * i] = scale16_fast(a, g0);
+            dst[2 * i + 1] = scale16_fast(b, g1);
+        }
+    }
+}
+
+// Pick 3 of 4 16-bit channels, the mic/mic/ref layout fed to the AFE. A frame is loaded before it is
+// stored since the output of an in-place pick catches up with the input in the first frames
+static void pick16_4to3(int16_t *dst, const int16_t *src, int o0, int o1, int o2, int frames)
+{
+#pragma GCC unroll 2
+    for (int i = 0; i < frames; i++) {
+        int16_t a = src[4 * i + o0], b = src[4 * i + o1], c = src[4 * i + o2];
+        dst[3 * i] = a;
+        dst[3 * i + 1] = b;
+        dst[3 * i + 2] = c;
+    }
+}
+
+static bool layout_valid(int channels, int bits, int frames)
+{
+    return channels > 0 && channels <= CHANNEL_LAYOUT_MAX_CH && (bits == 16 || bits == 32) && frames >= 0;
+}
+
+int channel_layout_remap(void *dst, int dst_ch, const void *src, int src_ch, int bits,
+                         const int8_t *order, const int32_t *gain, int frames)
+{
+    if (dst == NULL || src == NULL || order == NULL || !layout_valid(dst_ch, bits, frames) || !layout_valid(src_ch, bits, frames)) {
+        return -1;
+    }
+    if (dst == src && dst_ch > src_ch) {
+        return -1;
+    }
+    bool identity = dst_ch == src_ch;
+    bool silent = false;
+    bool unity = true;
+    int32_t gain_max = 0;
+    for (int c = 0; c < dst_ch; c++) {
+        if (order[c] < CHANNEL_LAYOUT_ZERO || order[c] >= src_ch) {
+            return -1;
+        }
+        identity &= order[c] == c;
+        silent |= order[c] == CHANNEL_LAYOUT_ZERO;
+        if (gain) {
+            unity &= gain[c] == CHANNEL_LAYOUT_GAIN_UNIT;
+            int32_t g = gain[c] < 0 ? -gain[c] : gain[c];
+            gain_max = g > gain_max ? g : gain_max;
+        }
+    }
+    if (unity) {
+        gain = NULL;
+    }
+    if (identity && unity) {
+        if (dst != src) {
+            memmove(dst, src, frames * dst_ch * bits / 8);
+        }
+        return 0;
+    }
+    if (bits == 16 && !silent) {
+        if (dst_ch == 2 && src_ch == 2) {
+            if (unity && IS_ALIGNED4(dst) && IS_ALIGNED4(src) && order[0] == 1 && order[1] == 0) {
+                swap16_2ch(dst, src, frames);
+                return 0;
+            }
+            if (gain && gain_max <= GAIN_FAST_MAX && order[0] != order[1]) {
+                gain16_2ch(dst, src, order[0] == 1, gain[0], gain[1], frames);
+                return 0;
+            }
+        }
+        if (dst_ch == 3 && src_ch == 4 && unity) {
+            pick16_4to3(dst, src, order[0], order[1], order[2], frames);
+            return 0;
+        }
+    }
+    if (bits == 16) {
+        remap16(dst, dst_ch, src, src_ch, order, gain, frames);
+    } else {
+        remap32(dst, dst_ch, src, src_ch, order, gain, frames);
+    }
+    return 0;
+}
+
+int channel_layout_permute(void *dst, int dst_ch, const void *src, int src_ch, int bits, const int8_t *order, int frames)
+{
+    return channel_layout_remap(dst, dst_ch, src, src_ch, bits, order, NULL, frames);
+}
+
+int channel_layout_gain(void *buf, int channels, int bits, const int32_t *gain, int frames)
+{
+    static const int8_t identity[CHANNEL_LAYOUT_MAX_CH] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+    return channel_layout_remap(buf, channels, buf, channels, bits, identity, gain, frames);
+}
+
+#define DEFINE_INTERLEAVE(name, type)                                                                   \
+static void name(type *dst, const void *const *src, int channels, int frames)                           \
+{                                                                                                       \
+    for (int c = 0; c < channels; c++) {                                                                \
+        const type *s = (const type *)src[c];                                                           \
+        type *d = dst + c;                                                                              \
+        int i = 0;                                                                                      \
+        for (; i + 4 <= frames; i += 4) {                                                               \
+            d[0] = s[i];                                                                                \
+            d[channels] = s[i + 1];                                                                     \
+            d[2 * channels] = s[i + 2];                                                                 \
+            d[3 * channels] = s[i + 3];                                                                 \
+            d += 4 * channels;                                                                          \
+        }                                                                                               \
+        for (; i < frames; i++) {                                                                       \
+            *d = s[i];                                                                                  \
+            d += channels;                                                                              \
+        }                                                                                               \
+    }                                                                                                   \
+}
+
+#define DEFINE_DEINTERLEAVE(name, type)                                                                 \
+static void name(void *const *dst, const type *src, int channels, int frames)                           \
+{                                                                                                       \
+    for (int c = 0; c < channels; c++) {                                                                \
+        type *d = (type *)dst[c];                                                                       \
+        if (d == NULL) {                                                                                \
+            continue;                                                                                   \
+        }                                                                                               \
+        const type *s = src + c;                                                                        \
+        int i = 0;                                                                                      \
+        for (; i + 4 <= frames; i += 4) {                                                               \
+            d[i] = s[0];                                                                                \
+            d[i + 1] = s[channels];                                                                     \
+            d[i + 2] = s[2 * channels];                                                                 \
+            d[i + 3] = s[3 * channels];                                                                 \
+            s += 4 * channels;                                                                          \
+        }                                                                                               \
+        for (; i < frames; i++) {                                                                       \
+            d[i] = *s;                                                                                  \
+            s += channels;                                                                              \
+        }                                                                                               \
+    }                                                                                                   \
+}
+
+DEFINE_INTERLEAVE(interleave16, int16_t)
+DEFINE_INTERLEAVE(interleave32, int32_t)
+DEFINE_DEINTERLEAVE(deinterleave16, int16_t)
+DEFINE_DEINTERLEAVE(deinterleave32, int32_t)
+
+// Stereo 16-bit, the most common case of both directions
+static void interleave16_2ch(int16_t *dst, const int16_t *l, const int16_t *r, int frames)
+{
+#pragma GCC unroll 4
+    for (int i = 0; i < frames; i++) {
+        dst[2 * i] = l[i];
+        dst[2 * i + 1] = r[i];
+    }
+}
+
+static void deinterleave16_2ch(int16_t *l, int16_t *r, const int16_t *src, int frames)
+{
+#pragma GCC unroll 4
+    for (int i = 0; i < frames; i++) {
+        l[i] = src[2 * i];
+        r[i] = src[2 * i + 1];
+    }
+}
+
+int channel_layout_interleave(void *dst, const void *const *src, int channels, int bits, int frames)
+{
+    if (dst == NULL || src == NULL || !layout_valid(channels, bits, frames)) {
+        return -1;
+    }
+    for (int c = 0; c < channels; c++) {
+        if (src[c] == NULL) {
+            return -1;
+        }
+    }
+    if (bits == 16 && channels == 2) {
+        interleave16_2ch(dst, src[0], src[1], frames);
+        return 0;
+    }
+    if (bits == 16) {
+        interleave16(dst, src, channels, frames);
+    } else {
+        interleave32(dst, src, channels, frames);
+    }
+    return 0;
+}
+
+int channel_layout_deinterleave(void *const *dst, const void *src, int channels, int bits, int frames)
+{
+    if (dst == NULL || src == NULL || !layout_valid(channels, bits, frames)) {
+        return -1;
+    }
+    if (bits == 16 && channels == 2 && dst[0] && dst[1]) {
+        deinterleave16_2ch(dst[0], dst[1], src, frames);
+        return 0;
+    }
+    if (bits == 16) {
+        deinterleave16(dst, src, channels, frames);
+    } else {
+        deinterleave32(dst, src, channels, frames);
+    }
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef _CHANNEL_LAYOUT_H_
+#define _CHANNEL_LAYOUT_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Sample layout kernels shared by the streams and the recorder, for 16-bit and 32-bit PCM with up to 8 channels.
+ * Interleaved buffers hold `frames` frames of `channels` samples, all the functions return 0 on success
+ * and -1 on invalid arguments.
+ */
+#define CHANNEL_LAYOUT_MAX_CH    (8)
+#define CHANNEL_LAYOUT_ZERO      (-1)       /*!< Value in `order` for a silent output channel */
+#define CHANNEL_LAYOUT_GAIN_UNIT (1 << 12)  /*!< Unity of the Q12 gain */
+
+/**
+ * @brief Pick, reorder and scale channels in one pass
+ *
+ * @note  Output channel `c` is input channel `order[c]` scaled by `gain[c] / CHANNEL_LAYOUT_GAIN_UNIT` and saturated.
+ *        `dst` can be `src` as long as `dst_ch` is not more than `src_ch`.
+ *
+ * @param dst     Output buffer
+ * @param dst_ch  Channels of output
+ * @param src     Input buffer
+ * @param src_ch  Channels of input
+ * @param bits    16 or 32
+ * @param order   Input channel of each output channel, or CHANNEL_LAYOUT_ZERO
+ * @param gain    Q12 gain of each output channel, NULL for unity
+ * @param frames  Number of frames
+ *
+ * @return 0 or -1
+ */
+int channel_layout_remap(void *dst, int dst_ch, const void *src, int src_ch, int bits,
+                         const int8_t *order, const int32_t *gain, int frames);
+
+/**
+ * @brief Pick and reorder channels, same as `channel_layout_remap` with unity gain
+ */
+int channel_layout_permute(void *dst, int dst_ch, const void *src, int src_ch, int bits, const int8_t *order, int frames);
+
+/**
+ * @brief Scale every channel in place, same as `channel_layout_remap` with the identity order
+ */
+int channel_layout_gain(void *buf, int channels, int bits, const int32_t *gain, int frames);
+
+/**
+ * @brief Interleave planar channels
+ *
+ * @param dst       Interleaved output
+ * @param src       Array of `channels` planar inputs
+ * @param channels  Number of channels
+ * @param bits      16 or 32
+ * @param frames    Number of frames
+ *
+ * @return 0 or -1
+ */
+int channel_layout_interleave(void *dst, const void *const *src, int channels, int bits, int frames);
+
+/**
+ * @brief De-interleave into planar channels
+ *
+ * @param dst       Array of `channels` planar outputs, a NULL entry skips the channel
+ * @param src       Interleaved input
+ * @param channels  Number of channels
+ * @param bits      16 or 32
+ * @param frames    Number of frames
+ *
+ * @return 0 or -1
+ */
+int channel_layout_deinterleave(void *const *dst, const void *src, int channels, int bits, int frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _CHANNEL_LAYOUT_H_ */
@@ -0,0 +1,124 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "channel_layout.h"
+
+/*
+ * Compare the kernels with the loops they replace at the call sites, on AFE sized chunks
+ */
+#define BENCH_FRAMES  (512)
+#define BENCH_ROUNDS  (20000)
+
+static int16_t i_buf[BENCH_FRAMES * 4];
+static int16_t o_buf[BENCH_FRAMES * 4];
+static int16_t plane[2][BENCH_FRAMES];
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// The legacy loops are kept out of line like the kernels, so both work on unknown buffers
+// Legacy ch_sort_16bit_4ch of audio_recorder
+__attribute__((noipa)) static void legacy_sort_4ch(int16_t *i, int16_t *o, size_t len, int ch0, int ch1, int ref)
+{
+    for (int k = 0; k < (len >> 3); k++) {
+        o[3 * k + 0] = i[(k << 2) + ch0];
+        o[3 * k + 1] = i[(k << 2) + ch1];
+        o[3 * k + 2] = i[(k << 2) + ref];
+    }
+}
+
+// Legacy algorithm_data_swap then algorithm_data_gain of algorithm_stream
+__attribute__((noipa)) static void legacy_swap_gain(int16_t *raw, int len, int lfac, int rfac)
+{
+    int16_t tmp;
+    for (int k = 0; k < len / 4; k++) {
+        tmp = raw[k << 1];
+        raw[k << 1] = raw[(k << 1) + 1];
+        raw[(k << 1) + 1] = tmp;
+    }
+    for (int k = 0; k < len / 4; k++) {
+        raw[k << 1] = raw[k << 1] * lfac;
+        raw[(k << 1) + 1] = raw[(k << 1) + 1] * rfac;
+    }
+}
+
+// Legacy i2s_mono_fix of i2s_stream, 16 bits
+__attribute__((noipa)) static void legacy_mono_fix(int16_t *buf, uint32_t len)
+{
+    int16_t temp_box;
+    int k = len >> 1;
+    for (int n = 0; n < k; n += 2) {
+        temp_box = buf[n];
+        buf[n] = buf[n + 1];
+        buf[n + 1] = temp_box;
+    }
+}
+
+// Legacy type2 interleave loop of algorithm_stream
+__attribute__((noipa)) static void legacy_interleave(int16_t *out, const int16_t *rec, const int16_t *ref, int size)
+{
+    for (int k = 0; k < (size / 2); k++) {
+        out[k << 1] = rec[k];
+        out[(k << 1) + 1] = ref[k];
+    }
+}
+
+#define RUN(name, stmt) do {                                                    \
+    double start = now_us();                                                    \
+    for (int r = 0; r < BENCH_ROUNDS; r++) {                                    \
+        stmt;                                                                   \
+        __asm__ volatile("" ::: "memory");                                      \
+    }                                                                           \
+    double cost = (now_us() - start) * 1000 / BENCH_ROUNDS / BENCH_FRAMES;     \
+    printf("%-28s %6.3f ns/frame\n", name, cost);                               \
+} while (0)
+
+int main(int argc, char *argv[])
+{
+    for (int i = 0; i < BENCH_FRAMES * 4; i++) {
+        i_buf[i] = (int16_t)(i * 7919);
+    }
+    static const int8_t pick[3] = { 2, 0, 1 };
+    static const int8_t swap[2] = { 1, 0 };
+    static const int32_t gain[2] = { 2 * CHANNEL_LAYOUT_GAIN_UNIT, 3 * CHANNEL_LAYOUT_GAIN_UNIT };
+    const void *planes[2] = { plane[0], plane[1] };
+
+    RUN("recorder 4->3 legacy", legacy_sort_4ch(i_buf, o_buf, BENCH_FRAMES * 8, 2, 0, 1));
+    RUN("recorder 4->3 remap", channel_layout_permute(o_buf, 3, i_buf, 4, 16, pick, BENCH_FRAMES));
+    RUN("algorithm swap+gain legacy", legacy_swap_gain(o_buf, BENCH_FRAMES * 4, 2, 3));
+    RUN("algorithm swap+gain remap", channel_layout_remap(o_buf, 2, o_buf, 2, 16, swap, gain, BENCH_FRAMES));
+    RUN("i2s mono fix legacy", legacy_mono_fix(o_buf, BENCH_FRAMES * 4));
+    RUN("i2s mono fix permute", channel_layout_permute(o_buf, 2, o_buf, 2, 16, swap, BENCH_FRAMES));
+    RUN("interleave legacy", legacy_interleave(o_buf, plane[0], plane[1], BENCH_FRAMES * 2));
+    RUN("interleave kernel", channel_layout_interleave(o_buf, planes, 2, 16, BENCH_FRAMES));
+    return 0;
+}
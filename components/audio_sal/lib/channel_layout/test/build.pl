@@ -0,0 +1,3 @@
+#!/usr/bin/perl
+`gcc ../channel_layout.c test.c -I../include -I../../../../../tools/host_test/include -g -O2 -Wall -o ./test`;
+`gcc ../channel_layout.c bench.c -I../include -O2 -o ./bench`;
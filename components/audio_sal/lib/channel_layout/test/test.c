@@ -0,0 +1,208 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "channel_layout.h"
+#include "host_test.h"
+
+/*
+ * Every kernel is checked against a plain reference for all the channel counts, sample widths,
+ * in-place and misaligned buffers, random orders and gains.
+ */
+#define MAX_FRAMES  (37)
+#define ROUNDS      (20000)
+
+static int64_t sample_at(const void *buf, int bits, int i)
+{
+    return bits == 16 ? ((const int16_t *)buf)[i] : ((const int32_t *)buf)[i];
+}
+
+static void sample_set(void *buf, int bits, int i, int64_t v)
+{
+    if (bits == 16) {
+        ((int16_t *)buf)[i] = (int16_t)v;
+    } else {
+        ((int32_t *)buf)[i] = (int32_t)v;
+    }
+}
+
+static int64_t ref_scale(int64_t s, const int32_t *gain, int c, int bits)
+{
+    if (gain == NULL) {
+        return s;
+    }
+    int64_t v = (s * gain[c]) >> 12;
+    int64_t max = bits == 16 ? INT16_MAX : INT32_MAX;
+    int64_t min = bits == 16 ? INT16_MIN : INT32_MIN;
+    return v > max ? max : (v < min ? min : v);
+}
+
+static int64_t rand_sample(int bits)
+{
+    int64_t v = ((int64_t)rand() << 32) ^ ((int64_t)rand() << 16) ^ rand();
+    switch (rand() % 8) {
+        case 0:
+            return bits == 16 ? INT16_MAX : INT32_MAX;
+        case 1:
+            return bits == 16 ? INT16_MIN : INT32_MIN;
+        default:
+            return bits == 16 ? (int16_t)v : (int32_t)v;
+    }
+}
+
+static int32_t rand_gain(void)
+{
+    switch (rand() % 5) {
+        case 0:
+            return CHANNEL_LAYOUT_GAIN_UNIT;
+        case 1:
+            return (rand() % 16) * CHANNEL_LAYOUT_GAIN_UNIT;
+        case 2:
+            return -(rand() % 0x20000);
+        case 3:
+            return rand() % 0x100000;
+        default:
+            return rand() % (2 * CHANNEL_LAYOUT_GAIN_UNIT);
+    }
+}
+
+static void test_remap(void)
+{
+    static uint8_t src_mem[MAX_FRAMES * CHANNEL_LAYOUT_MAX_CH * 4 + 8];
+    static uint8_t dst_mem[MAX_FRAMES * CHANNEL_LAYOUT_MAX_CH * 4 + 8];
+    static uint8_t expect[MAX_FRAMES * CHANNEL_LAYOUT_MAX_CH * 4];
+    for (int round = 0; round < ROUNDS; round++) {
+        int bits = rand() % 2 ? 16 : 32;
+        int width = bits / 8;
+        int src_ch = 1 + rand() % CHANNEL_LAYOUT_MAX_CH;
+        int dst_ch = 1 + rand() % CHANNEL_LAYOUT_MAX_CH;
+        int frames = rand() % MAX_FRAMES;
+        int8_t order[CHANNEL_LAYOUT_MAX_CH];
+        int32_t gain[CHANNEL_LAYOUT_MAX_CH];
+        // Bias towards the layouts with fast paths
+        if (rand() % 3 == 0) {
+            bits = 16;
+            width = 2;
+            src_ch = 2 + (rand() % 2) * 2;
+            dst_ch = src_ch == 2 ? 2 : 3;
+        }
+        for (int c = 0; c < dst_ch; c++) {
+            order[c] = rand() % 10 == 0 ? CHANNEL_LAYOUT_ZERO : rand() % src_ch;
+            gain[c] = rand_gain();
+        }
+        const int32_t *g = rand() % 2 ? gain : NULL;
+        bool in_place = dst_ch <= src_ch && rand() % 2;
+        int offset = bits == 16 ? (rand() % 2) * 2 : 0;
+        void *src = src_mem + offset;
+        void *dst = in_place ? src : dst_mem + (bits == 16 ? (rand() % 2) * 2 : 0);
+        for (int i = 0; i < frames * src_ch; i++) {
+            sample_set(src, bits, i, rand_sample(bits));
+        }
+        for (int i = 0; i < frames; i++) {
+            for (int c = 0; c < dst_ch; c++) {
+                int64_t s = order[c] < 0 ? 0 : sample_at(src, bits, i * src_ch + order[c]);
+                sample_set(expect, bits, i * dst_ch + c, ref_scale(s, g, c, bits));
+            }
+        }
+        CHECK(channel_layout_remap(dst, dst_ch, src, src_ch, bits, order, g, frames) == 0);
+        if (memcmp(dst, expect, frames * dst_ch * width)) {
+            printf("remap %d bits %d -> %d ch, %d frames, gain %s, in place %d\n", bits, src_ch, dst_ch, frames,
+                   g ? "yes" : "no", in_place);
+            CHECK(0);
+        }
+    }
+
+    // Shortcuts and invalid arguments
+    int16_t a[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    int16_t b[8] = { 0 };
+    int8_t order[CHANNEL_LAYOUT_MAX_CH] = { 1, 0 };
+    int32_t gain[CHANNEL_LAYOUT_MAX_CH] = { 2 * CHANNEL_LAYOUT_GAIN_UNIT, 3 * CHANNEL_LAYOUT_GAIN_UNIT };
+    CHECK(channel_layout_permute(b, 2, a, 2, 16, order, 4) == 0);
+    CHECK(b[0] == 2 && b[1] == 1 && b[6] == 8 && b[7] == 7);
+    CHECK(channel_layout_gain(a, 2, 16, gain, 4) == 0);
+    CHECK(a[0] == 2 && a[1] == 6 && a[6] == 14 && a[7] == 24);
+    CHECK(channel_layout_remap(a, 4, a, 2, 16, order, NULL, 1) == -1);
+    CHECK(channel_layout_remap(b, 2, a, 2, 24, order, NULL, 1) == -1);
+    CHECK(channel_layout_remap(b, 9, a, 2, 16, order, NULL, 1) == -1);
+    order[0] = 2;
+    CHECK(channel_layout_remap(b, 2, a, 2, 16, order, NULL, 1) == -1);
+    order[0] = -2;
+    CHECK(channel_layout_remap(b, 2, a, 2, 16, order, NULL, 1) == -1);
+    printf("remap: ok\n");
+}
+
+static void test_interleave(void)
+{
+    static uint8_t planes[CHANNEL_LAYOUT_MAX_CH][MAX_FRAMES * 4 + 4];
+    static uint8_t out[CHANNEL_LAYOUT_MAX_CH][MAX_FRAMES * 4 + 4];
+    static uint8_t mixed[MAX_FRAMES * CHANNEL_LAYOUT_MAX_CH * 4 + 4];
+    for (int round = 0; round < ROUNDS; round++) {
+        int bits = rand() % 2 ? 16 : 32;
+        int width = bits / 8;
+        int channels = rand() % 3 ? 1 + rand() % CHANNEL_LAYOUT_MAX_CH : 2;
+        int frames = rand() % MAX_FRAMES;
+        const void *src[CHANNEL_LAYOUT_MAX_CH];
+        void *dst[CHANNEL_LAYOUT_MAX_CH];
+        void *m = mixed + (bits == 16 ? (rand() % 2) * 2 : 0);
+        for (int c = 0; c < channels; c++) {
+            src[c] = planes[c] + (bits == 16 ? (rand() % 2) * 2 : 0);
+            for (int i = 0; i < frames; i++) {
+                sample_set((void *)src[c], bits, i, rand_sample(bits));
+            }
+            dst[c] = rand() % 6 ? out[c] : NULL;
+            memset(out[c], 0x5a, sizeof(out[c]));
+        }
+        CHECK(channel_layout_interleave(m, src, channels, bits, frames) == 0);
+        for (int i = 0; i < frames; i++) {
+            for (int c = 0; c < channels; c++) {
+                CHECK(sample_at(m, bits, i * channels + c) == sample_at(src[c], bits, i));
+            }
+        }
+        CHECK(channel_layout_deinterleave(dst, m, channels, bits, frames) == 0);
+        for (int c = 0; c < channels; c++) {
+            if (dst[c]) {
+                CHECK(memcmp(dst[c], src[c], frames * width) == 0);
+            } else {
+                CHECK(out[c][0] == 0x5a);
+            }
+        }
+    }
+    const void *src[2] = { planes[0], NULL };
+    CHECK(channel_layout_interleave(mixed, src, 2, 16, 1) == -1);
+    CHECK(channel_layout_interleave(mixed, src, 1, 8, 1) == -1);
+    CHECK(channel_layout_deinterleave(NULL, mixed, 2, 16, 1) == -1);
+    printf("interleave: ok\n");
+}
+
+int main(int argc, char *argv[])
+{
+    srand(argc > 1 ? atoi(argv[1]) : 1);
+    test_remap();
+    test_interleave();
+    return 0;
+}
@@ -0,0 +1,172 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef _MEM_POOL_H_
+#define _MEM_POOL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Size-class pool for small blocks. A region of memory given once is cut into slabs, a slab serves one
+ * power of two block size at a time and goes back to the region as soon as its last block is freed,
+ * so a slab is reused by any class and the small blocks never split the general heap.
+ * Allocation and free are O(1) under the lock given at init. Blocks carry an owner index for
+ * live and peak accounting, owner 0 is untagged.
+ */
+#define MEM_POOL_SLAB_SIZE      (2048)
+#define MEM_POOL_MIN_BLOCK      (16)
+#define MEM_POOL_MAX_BLOCK      (512)
+#define MEM_POOL_CLASS_NUM      (6)     /*!< 16, 32, 64, 128, 256 and 512 bytes */
+#define MEM_POOL_REGION_NUM     (2)
+#define MEM_POOL_MAX_OWNERS     (32)
+#define MEM_POOL_NO_SLAB        (0xffff)
+
+typedef struct {
+    const char  *name;
+    uint32_t    live;       /*!< Bytes of the live blocks, counted by block size */
+    uint32_t    peak;       /*!< Highest `live` seen */
+    uint32_t    blocks;     /*!< Number of live blocks */
+    uint32_t    fallbacks;  /*!< Requests the pool could not serve */
+} mem_pool_owner_t;
+
+typedef struct {
+    uint32_t    slabs;          /*!< Slabs of the region */
+    uint32_t    free_slabs;     /*!< Slabs not serving any class */
+    uint32_t    block_bytes;    /*!< Bytes of the live blocks */
+    uint32_t    frag;           /*!< Per mille of the slabs in use not held by live blocks */
+} mem_pool_stats_t;
+
+typedef struct {
+    uint16_t    prev;
+    uint16_t    next;
+    uint8_t     cls;        /*!< MEM_POOL_CLASS_NUM while the slab is free */
+    uint16_t    used;
+    uint16_t    carved;     /*!< Blocks handed out at least once, the rest was never touched */
+    void        *free_head;
+    uint8_t     owner[MEM_POOL_SLAB_SIZE / MEM_POOL_MIN_BLOCK];
+} mem_pool_slab_t;
+
+typedef struct {
+    uint8_t         *base;
+    uint8_t         *end;
+    mem_pool_slab_t *slabs;
+    uint16_t        num_slabs;
+    uint16_t        free_slabs;
+    uint16_t        num_free;
+    uint16_t        partial[MEM_POOL_CLASS_NUM];
+    uint32_t        block_bytes;
+} mem_pool_region_t;
+
+typedef struct {
+    mem_pool_region_t   region[MEM_POOL_REGION_NUM];
+    mem_pool_owner_t    owner[MEM_POOL_MAX_OWNERS];
+    int                 num_owners;
+    void                (*lock)(void *ctx);
+    void                (*unlock)(void *ctx);
+    void                *lock_ctx;
+} mem_pool_t;
+
+/**
+ * @brief Init an empty pool
+ *
+ * @param pool      The pool
+ * @param lock      Enter the critical section of the pool, NULL when the pool is used by one task only
+ * @param unlock    Leave it
+ * @param lock_ctx  Argument of `lock` and `unlock`
+ */
+void mem_pool_init(mem_pool_t *pool, void (*lock)(void *ctx), void (*unlock)(void *ctx), void *lock_ctx);
+
+/**
+ * @brief Give a region of memory to the pool, the slab table is kept at its head
+ *
+ * @param pool    The pool
+ * @param region  Index of the region, less than MEM_POOL_REGION_NUM
+ * @param mem     Memory of the region, it belongs to the pool from now on
+ * @param size    Size of `mem`
+ *
+ * @return Number of slabs, 0 when `size` is too small or the region is in use
+ */
+int mem_pool_add_region(mem_pool_t *pool, int region, void *mem, size_t size);
+
+/**
+ * @brief Allocate a block of at least `size` bytes from a region
+ *
+ * @return The block, NULL when `size` is over MEM_POOL_MAX_BLOCK or the region is full
+ */
+void *mem_pool_alloc(mem_pool_t *pool, int region, size_t size, int owner);
+
+/**
+ * @brief Free a block of the pool
+ *
+ * @return false when `ptr` does not belong to the pool, nothing is done then
+ */
+bool mem_pool_free(mem_pool_t *pool, void *ptr);
+
+/**
+ * @brief Region holding `ptr`, or -1 when `ptr` does not belong to the pool
+ */
+int mem_pool_region_of(const mem_pool_t *pool, const void *ptr);
+
+/**
+ * @brief Usable size of the block at `ptr`, or 0 when `ptr` does not belong to the pool
+ */
+size_t mem_pool_block_size(const mem_pool_t *pool, const void *ptr);
+
+/**
+ * @brief Owner index of a name, the name is added on first use and kept by pointer
+ *
+ * @note  The name must outlive the pool, a string literal is the usual choice and is found without the lock.
+ *
+ * @return Index of the owner, 0 for NULL or when the table is full
+ */
+int mem_pool_owner(mem_pool_t *pool, const char *name);
+
+/**
+ * @brief Count a request of `owner` the pool could not serve
+ */
+void mem_pool_count_fallback(mem_pool_t *pool, int owner);
+
+/**
+ * @brief Snapshot the accounting of an owner
+ *
+ * @return false when `owner` is not in the table
+ */
+bool mem_pool_get_owner(mem_pool_t *pool, int owner, mem_pool_owner_t *stats);
+
+/**
+ * @brief Snapshot the usage of a region
+ */
+void mem_pool_get_stats(mem_pool_t *pool, int region, mem_pool_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MEM_POOL_H_ */
@@ -0,0 +1,316 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "mem_pool.h"
+
+#define SLAB_FREE       (MEM_POOL_CLASS_NUM)
+#define BLOCK_SIZE(c)   (MEM_POOL_MIN_BLOCK << (c))
+
+static inline void pool_lock(mem_pool_t *pool)
+{
+    if (pool->lock) {
+        pool->lock(pool->lock_ctx);
+    }
+}
+
+static inline void pool_unlock(mem_pool_t *pool)
+{
+    if (pool->unlock) {
+        pool->unlock(pool->lock_ctx);
+    }
+}
+
+static inline int size_class(size_t size)
+{
+    if (size <= MEM_POOL_MIN_BLOCK) {
+        return 0;
+    }
+    // 17..32 is class 1, 33..64 class 2 and so on
+    return 32 - __builtin_clz((uint32_t)size - 1) - 4;
+}
+
+static void slab_push(mem_pool_region_t *r, uint16_t *head, uint16_t idx)
+{
+    mem_pool_slab_t *s = &r->slabs[idx];
+    s->prev = MEM_POOL_NO_SLAB;
+    s->next = *head;
+    if (*head != MEM_POOL_NO_SLAB) {
+        r->slabs[*head].prev = idx;
+    }
+    *head = idx;
+}
+
+static void slab_unlink(mem_pool_region_t *r, uint16_t *head, uint16_t idx)
+{
+    mem_pool_slab_t *s = &r->slabs[idx];
+    if (s->prev != MEM_POOL_NO_SLAB) {
+        r->slabs[s->prev].next = s->next;
+    } else {
+        *head = s->next;
+    }
+    if (s->next != MEM_POOL_NO_SLAB) {
+        r->slabs[s->next].prev = s->prev;
+    }
+    s->prev = MEM_POOL_NO_SLAB;
+    s->next = MEM_POOL_NO_SLAB;
+}
+
+static void owner_add(mem_pool_t *pool, int owner, int bytes)
+{
+    mem_pool_owner_t *o = &pool->owner[owner];
+    o->live += bytes;
+    o->blocks += bytes > 0 ? 1 : -1;
+    if (o->live > o->peak) {
+        o->peak = o->live;
+    }
+}
+
+void mem_pool_init(mem_pool_t *pool, void (*lock)(void *ctx), void (*unlock)(void *ctx), void *lock_ctx)
+{
+    memset(pool, 0, sizeof(mem_pool_t));
+    pool->lock = lock;
+    pool->unlock = unlock;
+    pool->lock_ctx = lock_ctx;
+    pool->num_owners = 1;
+    pool->owner[0].name = "untagged";
+}
+
+int mem_pool_add_region(mem_pool_t *pool, int region, void *mem, size_t size)
+{
+    if (region < 0 || region >= MEM_POOL_REGION_NUM || mem == NULL || pool->region[region].slabs) {
+        return 0;
+    }
+    mem_pool_region_t *r = &pool->region[region];
+    uintptr_t start = ((uintptr_t)mem + sizeof(void *) - 1) & ~(uintptr_t)(sizeof(void *) - 1);
+    if (size < start - (uintptr_t)mem) {
+        return 0;
+    }
+    size_t avail = size - (start - (uintptr_t)mem);
+    // Slab table first, then the slabs aligned to the biggest block so every block is aligned to its size
+    size_t n = avail / (MEM_POOL_SLAB_SIZE + sizeof(mem_pool_slab_t));
+    if (n > MEM_POOL_NO_SLAB - 1) {
+        n = MEM_POOL_NO_SLAB - 1;
+    }
+    while (n > 0) {
+        uintptr_t base = (start + n * sizeof(mem_pool_slab_t) + MEM_POOL_MAX_BLOCK - 1) & ~(uintptr_t)(MEM_POOL_MAX_BLOCK - 1);
+        if (base + n * MEM_POOL_SLAB_SIZE <= (uintptr_t)mem + size) {
+            r->base = (uint8_t *)base;
+            break;
+        }
+        n--;
+    }
+    if (n == 0) {
+        return 0;
+    }
+    r->slabs = (mem_pool_slab_t *)start;
+    r->num_slabs = n;
+    r->end = r->base + n * MEM_POOL_SLAB_SIZE;
+    r->free_slabs = MEM_POOL_NO_SLAB;
+    for (int c = 0; c < MEM_POOL_CLASS_NUM; c++) {
+        r->partial[c] = MEM_POOL_NO_SLAB;
+    }
+    for (int i = n - 1; i >= 0; i--) {
+        r->slabs[i].cls = SLAB_FREE;
+        slab_push(r, &r->free_slabs, i);
+    }
+    r->num_free = n;
+    r->block_bytes = 0;
+    return n;
+}
+
+void *mem_pool_alloc(mem_pool_t *pool, int region, size_t size, int owner)
+{
+    if (region < 0 || region >= MEM_POOL_REGION_NUM || size > MEM_POOL_MAX_BLOCK) {
+        return NULL;
+    }
+    mem_pool_region_t *r = &pool->region[region];
+    if (r->slabs == NULL) {
+        return NULL;
+    }
+    if (owner < 0 || owner >= MEM_POOL_MAX_OWNERS) {
+        owner = 0;
+    }
+    int cls = size_class(size);
+    int bsize = BLOCK_SIZE(cls);
+    uint8_t *p = NULL;
+
+    pool_lock(pool);
+    uint16_t idx = r->partial[cls];
+    if (idx == MEM_POOL_NO_SLAB) {
+        idx = r->free_slabs;
+        if (idx == MEM_POOL_NO_SLAB) {
+            pool_unlock(pool);
+            return NULL;
+        }
+        slab_unlink(r, &r->free_slabs, idx);
+        r->num_free--;
+        mem_pool_slab_t *s = &r->slabs[idx];
+        s->cls = cls;
+        s->used = 0;
+        s->carved = 0;
+        s->free_head = NULL;
+        slab_push(r, &r->partial[cls], idx);
+    }
+    mem_pool_slab_t *s = &r->slabs[idx];
+    uint8_t *slab = r->base + idx * MEM_POOL_SLAB_SIZE;
+    if (s->free_head) {
+        p = s->free_head;
+        s->free_head = *(void **)p;
+    } else {
+        p = slab + s->carved * bsize;
+        s->carved++;
+    }
+    if (++s->used == MEM_POOL_SLAB_SIZE / bsize) {
+        slab_unlink(r, &r->partial[cls], idx);
+    }
+    s->owner[(p - slab) / MEM_POOL_MIN_BLOCK] = owner;
+    r->block_bytes += bsize;
+    owner_add(pool, owner, bsize);
+    pool_unlock(pool);
+    return p;
+}
+
+int mem_pool_region_of(const mem_pool_t *pool, const void *ptr)
+{
+    for (int i = 0; i < MEM_POOL_REGION_NUM; i++) {
+        const mem_pool_region_t *r = &pool->region[i];
+        if ((const uint8_t *)ptr >= r->base && (const uint8_t *)ptr < r->end) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+size_t mem_pool_block_size(const mem_pool_t *pool, const void *ptr)
+{
+    int region = mem_pool_region_of(pool, ptr);
+    if (region < 0) {
+        return 0;
+    }
+    const mem_pool_region_t *r = &pool->region[region];
+    return BLOCK_SIZE(r->slabs[((const uint8_t *)ptr - r->base) / MEM_POOL_SLAB_SIZE].cls);
+}
+
+bool mem_pool_free(mem_pool_t *pool, void *ptr)
+{
+    int region = mem_pool_region_of(pool, ptr);
+    if (region < 0) {
+        return false;
+    }
+    mem_pool_region_t *r = &pool->region[region];
+    uint16_t idx = ((uint8_t *)ptr - r->base) / MEM_POOL_SLAB_SIZE;
+    uint8_t *slab = r->base + idx * MEM_POOL_SLAB_SIZE;
+
+    pool_lock(pool);
+    mem_pool_slab_t *s = &r->slabs[idx];
+    int cls = s->cls;
+    int bsize = BLOCK_SIZE(cls);
+    bool was_full = s->used == MEM_POOL_SLAB_SIZE / bsize;
+    *(void **)ptr = s->free_head;
+    s->free_head = ptr;
+    s->used--;
+    r->block_bytes -= bsize;
+    owner_add(pool, s->owner[((uint8_t *)ptr - slab) / MEM_POOL_MIN_BLOCK], -bsize);
+    if (s->used == 0) {
+        // Hand the empty slab back to the region, any class can take it from there
+        if (!was_full) {
+            slab_unlink(r, &r->partial[cls], idx);
+        }
+        s->cls = SLAB_FREE;
+        slab_push(r, &r->free_slabs, idx);
+        r->num_free++;
+    } else if (was_full) {
+        slab_push(r, &r->partial[cls], idx);
+    }
+    pool_unlock(pool);
+    return true;
+}
+
+int mem_pool_owner(mem_pool_t *pool, const char *name)
+{
+    if (name == NULL) {
+        return 0;
+    }
+    // Names are string literals most of the time, the pointer compare finds them without the lock
+    int num = __atomic_load_n(&pool->num_owners, __ATOMIC_ACQUIRE);
+    for (int i = 1; i < num; i++) {
+        if (pool->owner[i].name == name) {
+            return i;
+        }
+    }
+    int found = 0;
+    pool_lock(pool);
+    for (int i = 1; i < pool->num_owners; i++) {
+        if (strcmp(pool->owner[i].name, name) == 0) {
+            found = i;
+            break;
+        }
+    }
+    if (found == 0 && pool->num_owners < MEM_POOL_MAX_OWNERS) {
+        found = pool->num_owners;
+        memset(&pool->owner[found], 0, sizeof(mem_pool_owner_t));
+        pool->owner[found].name = name;
+        __atomic_store_n(&pool->num_owners, found + 1, __ATOMIC_RELEASE);
+    }
+    pool_unlock(pool);
+    return found;
+}
+
+void mem_pool_count_fallback(mem_pool_t *pool, int owner)
+{
+    if (owner < 0 || owner >= pool->num_owners) {
+        owner = 0;
+    }
+    pool_lock(pool);
+    pool->owner[owner].fallbacks++;
+    pool_unlock(pool);
+}
+
+bool mem_pool_get_owner(mem_pool_t *pool, int owner, mem_pool_owner_t *stats)
+{
+    if (owner < 0 || owner >= pool->num_owners) {
+        return false;
+    }
+    pool_lock(pool);
+    *stats = pool->owner[owner];
+    pool_unlock(pool);
+    return true;
+}
+
+void mem_pool_get_stats(mem_pool_t *pool, int region, mem_pool_stats_t *stats)
+{
+    memset(stats, 0, sizeof(mem_pool_stats_t));
+    if (region < 0 || region >= MEM_POOL_REGION_NUM) {
+        return;
+    }
+    mem_pool_region_t *r = &pool->region[region];
+    pool_lock(pool);
+    stats->slabs = r->num_slabs;
+    stats->free_slabs = r->num_free;
+    stats->block_bytes = r->block_bytes;
+    pool_unlock(pool);
+    uint32_t in_use = (stats->slabs - stats->free_slabs) * MEM_POOL_SLAB_SIZE;
+    stats->frag = in_use ? 1000 - (uint32_t)((uint64_t)stats->block_bytes * 1000 / in_use) : 0;
+}
@@ -0,0 +1,3 @@
+#!/usr/bin/perl
+`gcc ../mem_pool.c test.c -I../include -g -O2 -Wall -pthread -fsanitize=address,undefined -o ./test`;
+`gcc ../mem_pool.c soak.c -I../include -O2 -Wall -o ./soak`;
@@ -0,0 +1,276 @@
+/*
+ * Soak of a streaming player heap: HLS playlist nodes and URIs, parser strings, report_info and short lived
+ * metadata interleaved with segment buffers and the per track decoder buffers. The same workload runs on a
+ * first fit heap model with immediate coalescing, once with every block on the heap and once with the small
+ * blocks in a mem_pool region carved from that heap at boot.
+ *
+ * ./soak [segments]   one segment is ten seconds of stream, the default is a week
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "mem_pool.h"
+
+#define HEAP_SIZE       (1024 * 1024)
+#define POOL_SIZE       (96 * 1024)
+#define ALIGN           (8)
+#define HDR             (sizeof(blk_t))
+#define MIN_SPLIT       (HDR + 16)
+
+typedef struct blk {
+    uint32_t    size;       // whole block with header, bit 0 set when used
+    uint32_t    prev_size;  // size of the block before, 0 for the first
+    struct blk  *next_free;
+    struct blk  *prev_free;
+} blk_t;
+
+static uint8_t  *s_heap;
+static blk_t    *s_free;
+static size_t   s_free_bytes;
+
+#define BSIZE(b)    ((b)->size & ~1u)
+#define USED(b)     ((b)->size & 1u)
+#define NEXT(b)     ((blk_t *)((uint8_t *)(b) + BSIZE(b)))
+#define PREV(b)     ((blk_t *)((uint8_t *)(b) - (b)->prev_size))
+#define HEAP_END    (s_heap + HEAP_SIZE)
+
+static void free_push(blk_t *b)
+{
+    b->prev_free = NULL;
+    b->next_free = s_free;
+    if (s_free) {
+        s_free->prev_free = b;
+    }
+    s_free = b;
+}
+
+static void free_unlink(blk_t *b)
+{
+    if (b->prev_free) {
+        b->prev_free->next_free = b->next_free;
+    } else {
+        s_free = b->next_free;
+    }
+    if (b->next_free) {
+        b->next_free->prev_free = b->prev_free;
+    }
+}
+
+static void heap_init(void)
+{
+    s_heap = aligned_alloc(64, HEAP_SIZE);
+    blk_t *b = (blk_t *)s_heap;
+    b->size = HEAP_SIZE;
+    b->prev_size = 0;
+    s_free = NULL;
+    free_push(b);
+    s_free_bytes = HEAP_SIZE;
+}
+
+static void *heap_alloc(size_t size)
+{
+    size_t need = (size + HDR + ALIGN - 1) & ~(size_t)(ALIGN - 1);
+    for (blk_t *b = s_free; b; b = b->next_free) {
+        if (BSIZE(b) < need) {
+            continue;
+        }
+        free_unlink(b);
+        if (BSIZE(b) - need >= MIN_SPLIT) {
+            blk_t *rest = (blk_t *)((uint8_t *)b + need);
+            rest->size = BSIZE(b) - need;
+            rest->prev_size = need;
+            if ((uint8_t *)NEXT(rest) < HEAP_END) {
+                NEXT(rest)->prev_size = BSIZE(rest);
+            }
+            free_push(rest);
+            b->size = need;
+        }
+        b->size |= 1;
+        s_free_bytes -= BSIZE(b);
+        return (uint8_t *)b + HDR;
+    }
+    return NULL;
+}
+
+static void heap_free(void *ptr)
+{
+    blk_t *b = (blk_t *)((uint8_t *)ptr - HDR);
+    b->size &= ~1u;
+    s_free_bytes += BSIZE(b);
+    if ((uint8_t *)NEXT(b) < HEAP_END && !USED(NEXT(b))) {
+        blk_t *n = NEXT(b);
+        free_unlink(n);
+        b->size += BSIZE(n);
+    }
+    if (b->prev_size && !USED(PREV(b))) {
+        blk_t *p = PREV(b);
+        free_unlink(p);
+        p->size += BSIZE(b);
+        b = p;
+    }
+    if ((uint8_t *)NEXT(b) < HEAP_END) {
+        NEXT(b)->prev_size = BSIZE(b);
+    }
+    free_push(b);
+}
+
+static size_t heap_largest(void)
+{
+    size_t best = 0;
+    for (blk_t *b = s_free; b; b = b->next_free) {
+        if (BSIZE(b) > best) {
+            best = BSIZE(b);
+        }
+    }
+    return best > HDR ? best - HDR : 0;
+}
+
+static mem_pool_t   s_pool;
+static bool         s_use_pool;
+static uint32_t     s_seed;
+static int          s_failed;
+
+static uint32_t rnd(uint32_t n)
+{
+    s_seed ^= s_seed << 13;
+    s_seed ^= s_seed >> 17;
+    s_seed ^= s_seed << 5;
+    return s_seed % n;
+}
+
+static void *xalloc(size_t size)
+{
+    void *p = s_use_pool ? mem_pool_alloc(&s_pool, 0, size, 0) : NULL;
+    if (p == NULL && s_use_pool && size <= MEM_POOL_MAX_BLOCK) {
+        mem_pool_count_fallback(&s_pool, 0);
+    }
+    if (p == NULL) {
+        p = heap_alloc(size);
+    }
+    if (p == NULL) {
+        s_failed++;
+    }
+    return p;
+}
+
+static void xfree(void *p)
+{
+    if (p && !mem_pool_free(&s_pool, p)) {
+        heap_free(p);
+    }
+}
+
+#define KEEP_TRACKS     (18)
+#define PARSE_STRINGS   (12)
+#define META_SLOTS      (256)
+#define TRACK_BUFS      (3)
+
+typedef struct {
+    void    *tracks[KEEP_TRACKS][2];
+    void    *parse[PARSE_STRINGS];
+    void    *meta[META_SLOTS];
+    int     meta_ttl[META_SLOTS];
+    void    *track_buf[TRACK_BUFS];
+    void    *report_info;
+    void    *resident[16];
+} player_t;
+
+static void segment(player_t *pl, long n)
+{
+    // The segment buffer lives while the segment downloads
+    void *seg = xalloc(2048 + rnd(4096));
+
+    // New playlist entry, the oldest one is dropped
+    int slot = n % KEEP_TRACKS;
+    xfree(pl->tracks[slot][0]);
+    xfree(pl->tracks[slot][1]);
+    pl->tracks[slot][0] = xalloc(24);
+    pl->tracks[slot][1] = xalloc(60 + rnd(160));
+
+    // Playlist refresh, the parser strings of the last parse go away
+    if (n % 6 == 0) {
+        for (int i = 0; i < PARSE_STRINGS; i++) {
+            xfree(pl->parse[i]);
+            pl->parse[i] = xalloc(8 + rnd(200));
+        }
+    }
+
+    // Events and metadata with random lifetimes
+    for (int k = 0; k < 4; k++) {
+        int m = rnd(META_SLOTS);
+        if (pl->meta[m] == NULL) {
+            pl->meta[m] = xalloc(16 + rnd(400));
+            pl->meta_ttl[m] = 1 + rnd(rnd(20) == 0 ? 2000 : 30);
+        }
+    }
+    for (int m = 0; m < META_SLOTS; m++) {
+        if (pl->meta[m] && --pl->meta_ttl[m] == 0) {
+            xfree(pl->meta[m]);
+            pl->meta[m] = NULL;
+        }
+    }
+
+    // Station change every ten minutes or so, the element buffers are reallocated
+    if (n % 60 == 0) {
+        for (int i = 0; i < TRACK_BUFS; i++) {
+            xfree(pl->track_buf[i]);
+            pl->track_buf[i] = NULL;
+        }
+        xfree(pl->report_info);
+        pl->report_info = xalloc(48);
+        for (int i = 0; i < TRACK_BUFS; i++) {
+            pl->track_buf[i] = xalloc(8 * 1024 + rnd(56 * 1024));
+        }
+    }
+    xfree(seg);
+}
+
+static void run(bool use_pool, long segments)
+{
+    static uint8_t *pool_mem;
+    player_t pl;
+    memset(&pl, 0, sizeof(pl));
+    s_seed = 2463534242u;
+    s_failed = 0;
+    s_use_pool = use_pool;
+    heap_init();
+    mem_pool_init(&s_pool, NULL, NULL, NULL);
+    if (use_pool) {
+        pool_mem = heap_alloc(POOL_SIZE);
+        mem_pool_add_region(&s_pool, 0, pool_mem, POOL_SIZE);
+    }
+    // Resident objects of the application, allocated at boot
+    for (int i = 0; i < 16; i++) {
+        pl.resident[i] = xalloc(i < 4 ? 96 * 1024 : 64 + rnd(300));
+    }
+
+    printf("%s\n", use_pool ? "small blocks in mem_pool" : "every block on the heap");
+    printf("  %8s %10s %10s %8s %8s\n", "hours", "free", "largest", "frag", "failed");
+    for (long n = 1; n <= segments; n++) {
+        segment(&pl, n);
+        if (n % (segments / 8) == 0) {
+            size_t largest = heap_largest();
+            printf("  %8.1f %10zu %10zu %7.1f%% %8d\n", n * 10 / 3600.0, s_free_bytes, largest,
+                   100.0 - 100.0 * largest / s_free_bytes, s_failed);
+        }
+    }
+    if (use_pool) {
+        mem_pool_stats_t st;
+        mem_pool_get_stats(&s_pool, 0, &st);
+        mem_pool_owner_t o;
+        mem_pool_get_owner(&s_pool, 0, &o);
+        printf("  pool: %u/%u slabs in use, %u bytes in blocks, frag %u.%u%%, peak %u bytes, %u fallbacks\n",
+               st.slabs - st.free_slabs, st.slabs, st.block_bytes, st.frag / 10, st.frag % 10, o.peak, o.fallbacks);
+    }
+    free(s_heap);
+}
+
+int main(int argc, char **argv)
+{
+    long segments = argc > 1 ? atol(argv[1]) : 7 * 24 * 360;
+    run(false, segments);
+    run(true, segments);
+    return 0;
+}
@@ -0,0 +1,226 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mem_pool.h"
+
+#define SLABS_OF(n) ((n) * (MEM_POOL_SLAB_SIZE + sizeof(mem_pool_slab_t)) + MEM_POOL_MAX_BLOCK)
+
+static void test_region(void)
+{
+    mem_pool_t pool;
+    static uint8_t mem[SLABS_OF(4)];
+    mem_pool_init(&pool, NULL, NULL, NULL);
+    assert(mem_pool_add_region(&pool, 0, mem, 100) == 0);
+    assert(mem_pool_add_region(&pool, 2, mem, sizeof(mem)) == 0);
+    assert(mem_pool_add_region(&pool, 0, mem, sizeof(mem)) == 4);
+    assert(mem_pool_add_region(&pool, 0, mem, sizeof(mem)) == 0);
+    // No region 1, too big a block
+    assert(mem_pool_alloc(&pool, 1, 16, 0) == NULL);
+    assert(mem_pool_alloc(&pool, 0, MEM_POOL_MAX_BLOCK + 1, 0) == NULL);
+
+    int foreign;
+    assert(!mem_pool_free(&pool, &foreign));
+    assert(mem_pool_region_of(&pool, &foreign) == -1);
+    assert(mem_pool_block_size(&pool, &foreign) == 0);
+}
+
+static void test_classes(void)
+{
+    mem_pool_t pool;
+    static uint8_t mem[SLABS_OF(8)];
+    mem_pool_init(&pool, NULL, NULL, NULL);
+    assert(mem_pool_add_region(&pool, 1, mem, sizeof(mem)) == 8);
+    size_t sizes[] = { 0, 1, 16, 17, 32, 33, 100, 128, 129, 256, 300, 512 };
+    size_t expect[] = { 16, 16, 16, 32, 32, 64, 128, 128, 256, 256, 512, 512 };
+    void *p[12];
+    for (int i = 0; i < 12; i++) {
+        p[i] = mem_pool_alloc(&pool, 1, sizes[i], 0);
+        assert(p[i]);
+        assert(mem_pool_region_of(&pool, p[i]) == 1);
+        assert(mem_pool_block_size(&pool, p[i]) == expect[i]);
+        assert(((uintptr_t)p[i] & (expect[i] - 1)) == 0);
+        memset(p[i], 0x5a, expect[i]);
+    }
+    mem_pool_stats_t st;
+    mem_pool_get_stats(&pool, 1, &st);
+    assert(st.slabs == 8 && st.free_slabs == 2);
+    for (int i = 0; i < 12; i++) {
+        assert(mem_pool_free(&pool, p[i]));
+    }
+    mem_pool_get_stats(&pool, 1, &st);
+    assert(st.free_slabs == 8 && st.block_bytes == 0 && st.frag == 0);
+}
+
+static void test_slab_reuse(void)
+{
+    mem_pool_t pool;
+    static uint8_t mem[SLABS_OF(2)];
+    mem_pool_init(&pool, NULL, NULL, NULL);
+    assert(mem_pool_add_region(&pool, 0, mem, sizeof(mem)) == 2);
+
+    // Fill the region with 16 byte blocks
+    int n = 2 * MEM_POOL_SLAB_SIZE / 16;
+    void **p = calloc(n, sizeof(void *));
+    for (int i = 0; i < n; i++) {
+        p[i] = mem_pool_alloc(&pool, 0, 10, 0);
+        assert(p[i]);
+    }
+    assert(mem_pool_alloc(&pool, 0, 10, 0) == NULL);
+    assert(mem_pool_alloc(&pool, 0, 200, 0) == NULL);
+
+    // Every other block freed, half empty slabs serve their class only
+    for (int i = 0; i < n; i += 2) {
+        mem_pool_free(&pool, p[i]);
+    }
+    mem_pool_stats_t st;
+    mem_pool_get_stats(&pool, 0, &st);
+    assert(st.free_slabs == 0 && st.frag == 500);
+    assert(mem_pool_alloc(&pool, 0, 200, 0) == NULL);
+    void *q = mem_pool_alloc(&pool, 0, 16, 0);
+    assert(q);
+    mem_pool_free(&pool, q);
+
+    // The first slab fully freed goes to the 256 byte class
+    for (int i = 1; i < n / 2; i += 2) {
+        mem_pool_free(&pool, p[i]);
+    }
+    void *big = mem_pool_alloc(&pool, 0, 200, 0);
+    assert(big && mem_pool_block_size(&pool, big) == 256);
+    assert((uint8_t *)big < (uint8_t *)p[n / 2]);
+    mem_pool_free(&pool, big);
+    for (int i = n / 2 + 1; i < n; i += 2) {
+        mem_pool_free(&pool, p[i]);
+    }
+    mem_pool_get_stats(&pool, 0, &st);
+    assert(st.free_slabs == 2 && st.block_bytes == 0);
+    free(p);
+}
+
+static void test_owner(void)
+{
+    mem_pool_t pool;
+    static uint8_t mem[SLABS_OF(4)];
+    mem_pool_init(&pool, NULL, NULL, NULL);
+    mem_pool_add_region(&pool, 0, mem, sizeof(mem));
+
+    char name[] = "hls";
+    int hls = mem_pool_owner(&pool, "hls");
+    int url = mem_pool_owner(&pool, "url");
+    assert(hls > 0 && url > 0 && hls != url);
+    assert(mem_pool_owner(&pool, name) == hls);
+    assert(mem_pool_owner(&pool, NULL) == 0);
+
+    void *a = mem_pool_alloc(&pool, 0, 100, hls);
+    void *b = mem_pool_alloc(&pool, 0, 20, hls);
+    void *c = mem_pool_alloc(&pool, 0, 60, url);
+    mem_pool_owner_t o;
+    assert(mem_pool_get_owner(&pool, hls, &o));
+    assert(o.live == 160 && o.peak == 160 && o.blocks == 2);
+    mem_pool_free(&pool, a);
+    void *d = mem_pool_alloc(&pool, 0, 16, hls);
+    assert(mem_pool_get_owner(&pool, hls, &o));
+    assert(o.live == 48 && o.peak == 160 && o.blocks == 2);
+    assert(mem_pool_get_owner(&pool, url, &o));
+    assert(o.live == 64 && o.blocks == 1);
+    mem_pool_count_fallback(&pool, url);
+    mem_pool_free(&pool, b);
+    mem_pool_free(&pool, c);
+    mem_pool_free(&pool, d);
+    assert(mem_pool_get_owner(&pool, url, &o));
+    assert(o.live == 0 && o.peak == 64 && o.fallbacks == 1);
+    assert(!mem_pool_get_owner(&pool, MEM_POOL_MAX_OWNERS, &o));
+
+    // The table is full, more names are untagged
+    char names[MEM_POOL_MAX_OWNERS][8];
+    for (int i = 0; i < MEM_POOL_MAX_OWNERS; i++) {
+        snprintf(names[i], sizeof(names[i]), "o%d", i);
+        int idx = mem_pool_owner(&pool, names[i]);
+        assert(i < MEM_POOL_MAX_OWNERS - 3 ? idx > 0 : idx == 0);
+    }
+}
+
+#define THREADS     (4)
+#define ROUNDS      (200000)
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void lock(void *ctx)
+{
+    pthread_mutex_lock(ctx);
+}
+
+static void unlock(void *ctx)
+{
+    pthread_mutex_unlock(ctx);
+}
+
+static void *churn(void *arg)
+{
+    mem_pool_t *pool = arg;
+    void *held[64] = { 0 };
+    uint8_t tag[64];
+    uint32_t seed = (uint32_t)(uintptr_t)pthread_self();
+    int owner = mem_pool_owner(pool, "churn");
+    for (int i = 0; i < ROUNDS; i++) {
+        seed = seed * 1664525 + 1013904223;
+        int slot = (seed >> 8) & 63;
+        if (held[slot]) {
+            // Nobody else wrote into the block while it was held
+            for (size_t k = 0; k < mem_pool_block_size(pool, held[slot]); k++) {
+                assert(((uint8_t *)held[slot])[k] == tag[slot]);
+            }
+            assert(mem_pool_free(pool, held[slot]));
+            held[slot] = NULL;
+        } else {
+            held[slot] = mem_pool_alloc(pool, (seed >> 20) & 1, (seed >> 22) % MEM_POOL_MAX_BLOCK, owner);
+            if (held[slot]) {
+                tag[slot] = seed >> 3;
+                memset(held[slot], tag[slot], mem_pool_block_size(pool, held[slot]));
+            }
+        }
+    }
+    for (int i = 0; i < 64; i++) {
+        if (held[i]) {
+            mem_pool_free(pool, held[i]);
+        }
+    }
+    return NULL;
+}
+
+static void test_threads(void)
+{
+    mem_pool_t pool;
+    static uint8_t mem0[SLABS_OF(64)], mem1[SLABS_OF(64)];
+    mem_pool_init(&pool, lock, unlock, &s_lock);
+    mem_pool_add_region(&pool, 0, mem0, sizeof(mem0));
+    mem_pool_add_region(&pool, 1, mem1, sizeof(mem1));
+    pthread_t tid[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        pthread_create(&tid[i], NULL, churn, &pool);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(tid[i], NULL);
+    }
+    mem_pool_stats_t st;
+    for (int r = 0; r < 2; r++) {
+        mem_pool_get_stats(&pool, r, &st);
+        assert(st.free_slabs == st.slabs && st.block_bytes == 0);
+    }
+    mem_pool_owner_t o;
+    mem_pool_get_owner(&pool, mem_pool_owner(&pool, "churn"), &o);
+    assert(o.live == 0 && o.blocks == 0 && o.peak > 0);
+}
+
+int main(void)
+{
+    test_region();
+    test_classes();
+    test_slab_reuse();
+    test_owner();
+    test_threads();
+    printf("mem_pool: all tests passed\n");
+    return 0;
+}
@@ -27,6 +27,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "audio_mem.h"
+#include "soc/soc_memory_layout.h"
 #include "esp_log.h"
 #include "esp_err.h"
 
@@ -87,3 +88,55 @@ TEST_CASE("audio_realloc", "esp-adf")
     AUDIO_MEM_SHOW(TAG);
 }
 
+
+TEST_CASE("audio_mem pool", "esp-adf")
+{
+    audio_mem_pool_cfg_t cfg = {
+        .internal_size = 16 * 1024,
+        .spiram_size = audio_mem_spiram_is_enabled() ? 64 * 1024 : 0,
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, audio_mem_pool_init(&cfg));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, audio_mem_pool_init(&cfg));
+
+    audio_mem_frag_t before, after;
+    TEST_ASSERT_EQUAL(ESP_OK, audio_mem_get_frag(AUDIO_MEM_CAPS_INTERNAL, &before));
+    char *blocks[64];
+    for (int i = 0; i < 64; i++) {
+        blocks[i] = audio_mem_alloc(16 + i * 7, AUDIO_MEM_CAPS_INTERNAL, "pool_test");
+        TEST_ASSERT_NOT_NULL(blocks[i]);
+        TEST_ASSERT_TRUE(esp_ptr_internal(blocks[i]));
+    }
+    // The small blocks come from the pool, the heap does not move
+    TEST_ASSERT_EQUAL(ESP_OK, audio_mem_get_frag(AUDIO_MEM_CAPS_INTERNAL, &after));
+    TEST_ASSERT_EQUAL(before.free_size, after.free_size);
+    TEST_ASSERT_GREATER_THAN(0, after.pool_used);
+
+    audio_mem_owner_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, audio_mem_get_owner_stats("pool_test", &stats));
+    TEST_ASSERT_EQUAL(64, stats.blocks);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, audio_mem_get_owner_stats("nobody", &stats));
+
+    // A pool block grows out of the pool and keeps its content
+    strcpy(blocks[0], "pool");
+    blocks[0] = audio_realloc(blocks[0], 2048);
+    TEST_ASSERT_EQUAL_STRING("pool", blocks[0]);
+
+    char *str = audio_mem_strdup("http://example.com/a.m3u8", AUDIO_MEM_CAPS_DEFAULT, "pool_test");
+    TEST_ASSERT_EQUAL_STRING("http://example.com/a.m3u8", str);
+    if (audio_mem_spiram_is_enabled()) {
+        char *ext = audio_mem_alloc(100, AUDIO_MEM_CAPS_SPIRAM, NULL);
+        TEST_ASSERT_TRUE(esp_ptr_external_ram(ext));
+        audio_free(ext);
+    }
+    audio_mem_pool_print(TAG);
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, audio_mem_pool_deinit());
+    for (int i = 0; i < 64; i++) {
+        audio_free(blocks[i]);
+    }
+    audio_free(str);
+    TEST_ASSERT_EQUAL(ESP_OK, audio_mem_get_owner_stats("pool_test", &stats));
+    TEST_ASSERT_EQUAL(0, stats.live);
+    TEST_ASSERT_GREATER_THAN(0, stats.peak);
+    TEST_ASSERT_EQUAL(ESP_OK, audio_mem_pool_deinit());
+}
@@ -0,0 +1,51 @@
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "el_model.h"
+
+#define ELEMENTS    (3)
+#define RESTARTS    (5000)
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// One restart is audio_pipeline_run followed by audio_pipeline_terminate of a three element pipeline
+static double restart_us(el_model_t *els, bool pooled)
+{
+    double start = now_us();
+    for (int n = 0; n < RESTARTS; n++) {
+        for (int i = 0; i < ELEMENTS; i++) {
+            el_model_run(&els[i], 4096, pooled, 0);
+        }
+        for (int i = 0; i < ELEMENTS; i++) {
+            el_model_terminate(&els[i]);
+        }
+    }
+    return (now_us() - start) / RESTARTS;
+}
+
+int main(void)
+{
+    audio_thread_pool_class_t classes[] = {
+        { .stack = 4096, .count = ELEMENTS + 1, .core_id = 0 },
+    };
+    el_model_t els[ELEMENTS] = { 0 };
+    for (int i = 0; i < ELEMENTS; i++) {
+        el_model_init(&els[i]);
+    }
+    restart_us(els, false);
+    double create = restart_us(els, false);
+    audio_thread_pool_init(classes, 1);
+    double pool = restart_us(els, true);
+    usleep(2000);
+    audio_thread_pool_deinit();
+    printf("%d element pipeline run + terminate, %d restarts\n", ELEMENTS, RESTARTS);
+    printf("  create/delete tasks : %8.2f us/restart\n", create);
+    printf("  parked worker pool  : %8.2f us/restart\n", pool);
+    return 0;
+}
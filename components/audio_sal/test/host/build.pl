@@ -0,0 +1,6 @@
+#!/usr/bin/perl
+# Run audio_thread.c on host, FreeRTOS is replaced by stub/ and os_shim.c, the common stand-ins are in tools/host_test/stub
+my $f = "../../audio_thread.c os_shim.c";
+my $flags = "-Istub -I../../../../tools/host_test/stub -I../../include -g -Wall -Wno-unused-function -pthread";
+`gcc $f test.c $flags -fsanitize=address,undefined -o ./test`;
+`gcc $f bench.c $flags -O2 -o ./bench`;
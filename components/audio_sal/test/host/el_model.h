@@ -0,0 +1,64 @@
+/* The created/destroy/destroyed handshake of audio_element_run and audio_element_terminate */
+#pragma once
+#include <pthread.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "audio_thread.h"
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t  changed;
+    int             created;
+    int             destroy;
+    int             destroyed;
+    audio_thread_t  task;
+} el_model_t;
+
+static void el_model_set(el_model_t *el, int *flag)
+{
+    pthread_mutex_lock(&el->lock);
+    *flag = 1;
+    pthread_cond_broadcast(&el->changed);
+    pthread_mutex_unlock(&el->lock);
+}
+
+static void el_model_wait(el_model_t *el, int *flag)
+{
+    pthread_mutex_lock(&el->lock);
+    while (*flag == 0) {
+        pthread_cond_wait(&el->changed, &el->lock);
+    }
+    pthread_mutex_unlock(&el->lock);
+}
+
+static void el_model_task(void *pv)
+{
+    el_model_t *el = pv;
+    el_model_set(el, &el->created);
+    el_model_wait(el, &el->destroy);
+    el_model_set(el, &el->destroyed);
+    audio_thread_delete_task(&el->task);
+}
+
+static void el_model_init(el_model_t *el)
+{
+    pthread_mutex_init(&el->lock, NULL);
+    pthread_cond_init(&el->changed, NULL);
+}
+
+static esp_err_t el_model_run(el_model_t *el, uint32_t stack, bool pooled, int core_id)
+{
+    el->created = el->destroy = el->destroyed = 0;
+    esp_err_t ret = pooled ? audio_thread_borrow(&el->task, "el", el_model_task, el, stack, 5, false, core_id)
+                    : audio_thread_create(&el->task, "el", el_model_task, el, stack, 5, false, core_id);
+    if (ret == ESP_OK) {
+        el_model_wait(el, &el->created);
+    }
+    return ret;
+}
+
+static void el_model_terminate(el_model_t *el)
+{
+    el_model_set(el, &el->destroy);
+    el_model_wait(el, &el->destroyed);
+}
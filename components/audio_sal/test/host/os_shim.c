@@ -0,0 +1,149 @@
+/* pthread based implementation of the stub headers, just enough to run audio_thread on the host */
+#include <pthread.h>
+#include <limits.h>
+#include <stdlib.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+struct shim_task {
+    pthread_mutex_t lock;
+    pthread_cond_t  notified;
+    uint32_t        notify;
+    UBaseType_t     prio;
+    void            (*fn)(void *);
+    void            *arg;
+};
+
+struct shim_sem {
+    pthread_mutex_t lock;
+    pthread_cond_t  given;
+    UBaseType_t     count;
+    UBaseType_t     max;
+};
+
+// TaskHandle_t is an opaque pointer as in IDF, the shim keeps its own task struct behind it
+static __thread struct shim_task *s_self;
+
+static void *task_entry(void *param)
+{
+    s_self = param;
+    s_self->fn(s_self->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(void (*fn)(void *), const char *name, uint32_t stack, void *arg,
+                                   UBaseType_t prio, TaskHandle_t *out, BaseType_t core_id)
+{
+    struct shim_task *task = calloc(1, sizeof(struct shim_task));
+    pthread_mutex_init(&task->lock, NULL);
+    pthread_cond_init(&task->notified, NULL);
+    task->fn = fn;
+    task->arg = arg;
+    task->prio = prio;
+    if (out) {
+        *out = task;
+    }
+    pthread_t tid;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, stack < PTHREAD_STACK_MIN ? PTHREAD_STACK_MIN : stack);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int ret = pthread_create(&tid, &attr, task_entry, task);
+    pthread_attr_destroy(&attr);
+    return ret == 0 ? pdPASS : pdFALSE;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    // Only self delete is used, FreeRTOS frees the TCB later from the idle task
+    pthread_mutex_destroy(&s_self->lock);
+    pthread_cond_destroy(&s_self->notified);
+    free(s_self);
+    pthread_exit(NULL);
+}
+
+void vTaskPrioritySet(TaskHandle_t task, UBaseType_t prio)
+{
+    ((struct shim_task *)(task ? task : s_self))->prio = prio;
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task)
+{
+    return ((struct shim_task *)(task ? task : s_self))->prio;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return s_self;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks)
+{
+    struct shim_task *task = s_self;
+    pthread_mutex_lock(&task->lock);
+    while (task->notify == 0) {
+        pthread_cond_wait(&task->notified, &task->lock);
+    }
+    uint32_t ret = task->notify;
+    task->notify = clear ? 0 : task->notify - 1;
+    pthread_mutex_unlock(&task->lock);
+    return ret;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t handle)
+{
+    struct shim_task *task = (struct shim_task *)handle;
+    pthread_mutex_lock(&task->lock);
+    task->notify++;
+    pthread_cond_signal(&task->notified);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t init)
+{
+    SemaphoreHandle_t sem = calloc(1, sizeof(struct shim_sem));
+    pthread_mutex_init(&sem->lock, NULL);
+    pthread_cond_init(&sem->given, NULL);
+    sem->count = init;
+    sem->max = max;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return xSemaphoreCreateCounting(1, 1);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    pthread_mutex_lock(&sem->lock);
+    while (sem->count == 0) {
+        pthread_cond_wait(&sem->given, &sem->lock);
+    }
+    sem->count--;
+    pthread_mutex_unlock(&sem->lock);
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    BaseType_t ret = pdFALSE;
+    pthread_mutex_lock(&sem->lock);
+    if (sem->count < sem->max) {
+        sem->count++;
+        pthread_cond_signal(&sem->given);
+        ret = pdTRUE;
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return ret;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    pthread_mutex_destroy(&sem->lock);
+    pthread_cond_destroy(&sem->given);
+    free(sem);
+}
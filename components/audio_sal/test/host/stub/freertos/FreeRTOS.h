@@ -0,0 +1,18 @@
+/* Host shim of the FreeRTOS subset used by audio_thread, one tick is one millisecond */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+typedef uint32_t TickType_t;
+typedef int      BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint8_t  StackType_t;
+
+#define IDF_VER              "host"
+#define portMAX_DELAY        ((TickType_t)0xffffffffUL)
+#define portPRIVILEGE_BIT    (0)
+#define pdTRUE               (1)
+#define pdFALSE              (0)
+#define pdPASS               (pdTRUE)
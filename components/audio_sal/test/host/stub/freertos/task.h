@@ -0,0 +1,30 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef TaskHandle_t xTaskHandle;
+
+typedef struct {
+    void        *pvBaseAddress;
+    uint32_t    ulLengthInBytes;
+    uint32_t    ulParameters;
+} MemoryRegion_t;
+
+typedef struct {
+    void            (*pvTaskCode)(void *);
+    const char      *pcName;
+    uint32_t        usStackDepth;
+    void            *pvParameters;
+    UBaseType_t     uxPriority;
+    StackType_t     *puxStackBuffer;
+    MemoryRegion_t  xRegions[1];
+} TaskParameters_t;
+
+BaseType_t xTaskCreatePinnedToCore(void (*fn)(void *), const char *name, uint32_t stack, void *arg,
+                                   UBaseType_t prio, TaskHandle_t *out, BaseType_t core_id);
+void vTaskDelete(TaskHandle_t task);
+void vTaskPrioritySet(TaskHandle_t task, UBaseType_t prio);
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
@@ -0,0 +1,121 @@
+#include <assert.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "el_model.h"
+
+// Let the worker return from main_func and park, the borrower is released a few instructions after `destroyed`
+static void settle(void)
+{
+    usleep(2000);
+}
+
+static void test_no_pool(void)
+{
+    el_model_t el = { 0 };
+    el_model_init(&el);
+    assert(audio_thread_pool_deinit() == ESP_OK);
+    for (int i = 0; i < 10; i++) {
+        assert(el_model_run(&el, 4096, true, 0) == ESP_OK);
+        el_model_terminate(&el);
+    }
+}
+
+static void test_size_class(void)
+{
+    audio_thread_pool_class_t classes[] = {
+        { .stack = 8192, .count = 1, .core_id = 0 },
+        { .stack = 2048, .count = 1, .core_id = 0 },
+    };
+    el_model_t el = { 0 }, el2 = { 0 };
+    el_model_init(&el);
+    el_model_init(&el2);
+    assert(audio_thread_pool_init(NULL, 1) == ESP_ERR_INVALID_ARG);
+    assert(audio_thread_pool_init(classes, 2) == ESP_OK);
+    assert(audio_thread_pool_init(classes, 2) == ESP_ERR_INVALID_STATE);
+
+    // The smallest class that fits is picked and reused on every run
+    assert(el_model_run(&el, 1024, true, 0) == ESP_OK);
+    audio_thread_t small = el.task;
+    el_model_terminate(&el);
+    settle();
+    assert(el_model_run(&el, 2048, true, 0) == ESP_OK);
+    assert(el.task == small);
+    el_model_terminate(&el);
+    settle();
+
+    // A bigger request goes to the big class, the small one is still free
+    assert(el_model_run(&el, 4096, true, 0) == ESP_OK);
+    audio_thread_t big = el.task;
+    assert(big != small);
+    assert(el_model_run(&el2, 1024, true, 0) == ESP_OK);
+    assert(el2.task == small);
+
+    // Borrowed workers can not be freed
+    assert(audio_thread_pool_deinit() == ESP_ERR_INVALID_STATE);
+    el_model_terminate(&el);
+    el_model_terminate(&el2);
+    settle();
+
+    // Too big or on another core falls back to a created thread
+    assert(el_model_run(&el, 16384, true, 0) == ESP_OK);
+    assert(el.task != small && el.task != big);
+    el_model_terminate(&el);
+    assert(el_model_run(&el, 1024, true, 1) == ESP_OK);
+    assert(el.task != small && el.task != big);
+    el_model_terminate(&el);
+    settle();
+
+    assert(audio_thread_pool_deinit() == ESP_OK);
+    assert(audio_thread_pool_init(classes, 2) == ESP_OK);
+    assert(audio_thread_pool_deinit() == ESP_OK);
+}
+
+static void test_ext_request(void)
+{
+    audio_thread_pool_class_t classes[] = {
+        { .stack = 4096, .count = 1, .core_id = 0, .stack_in_ext = true },
+        { .stack = 8192, .count = 1, .core_id = 0 },
+    };
+    el_model_t el = { 0 };
+    el_model_init(&el);
+    assert(audio_thread_pool_init(classes, 2) == ESP_OK);
+    // An internal stack request never lands on an external stack worker
+    assert(el_model_run(&el, 1024, true, 0) == ESP_OK);
+    audio_thread_t internal = el.task;
+    el_model_terminate(&el);
+    settle();
+    assert(el_model_run(&el, 4096, true, 0) == ESP_OK);
+    assert(el.task == internal);
+    el_model_terminate(&el);
+    settle();
+    assert(audio_thread_pool_deinit() == ESP_OK);
+}
+
+static void test_park_prio(void)
+{
+    audio_thread_pool_class_t classes[] = {
+        { .stack = 4096, .count = 1, .core_id = 0 },
+    };
+    el_model_t el = { 0 };
+    el_model_init(&el);
+    assert(audio_thread_pool_init(classes, 1) == ESP_OK);
+    // The worker runs at the borrower's priority and drops back to the pool one when it parks
+    assert(el_model_run(&el, 1024, true, 0) == ESP_OK);
+    audio_thread_t worker = el.task;
+    assert(uxTaskPriorityGet(worker) == 5);
+    el_model_terminate(&el);
+    settle();
+    assert(uxTaskPriorityGet(worker) == 1);
+    assert(audio_thread_pool_deinit() == ESP_OK);
+}
+
+int main(void)
+{
+    test_no_pool();
+    test_size_class();
+    test_ext_request();
+    test_park_prio();
+    printf("audio_thread pool: all tests passed\n");
+    return 0;
+}
@@ -33,6 +33,7 @@
 #include "esp_log.h"
 
 #include "algorithm_stream.h"
+#include "channel_layout.h"
 #include "esp_afe_sr_iface.h"
 #include "esp_afe_sr_models.h"
 
@@ -52,29 +53,21 @@ typedef struct {
     int8_t mic_ch;
     bool afe_fetch_run;
     int sample_rate;
-    int rec_linear_factor;
-    int ref_linear_factor;
+    int8_t ch_order[2];
+    int32_t ch_gain[2];
     algorithm_stream_input_type_t input_type;
     const esp_afe_sr_iface_t *afe_handle;
     esp_afe_sr_data_t *afe_data;
     EventGroupHandle_t state;
     bool debug_input;
-    bool swap_ch;
     bool aec_low_cost;
     int agc_gain;
 } algo_stream_t;
 
 esp_err_t algorithm_mono_fix(uint8_t *sbuff, uint32_t len)
 {
-    int16_t *temp_buf = (int16_t *)sbuff;
-    int16_t temp_box;
-    int k = len >> 1;
-    for (int i = 0; i < k; i += 2) {
-        temp_box = temp_buf[i];
-        temp_buf[i] = temp_buf[i + 1];
-        temp_buf[i + 1] = temp_box;
-    }
-    return ESP_OK;
+    static const int8_t swap[2] = { 1, 0 };
+    return channel_layout_permute(sbuff, 2, sbuff, 2, 16, swap, len >> 2) == 0 ? ESP_OK : ESP_FAIL;
 }
 
 static esp_err_t _algo_close(audio_element_handle_t self)
@@ -208,27 +201,6 @@ static esp_err_t _algo_open(audio_element_handle_t self)
     return ESP_OK;
 }
 
-static esp_err_t algorithm_data_gain(int16_t *raw_buff, int len, int linear_lfac, int linear_rfac)
-{
-    for (int i = 0; i < len / 4; i++) {
-        raw_buff[i << 1] = raw_buff[i << 1] * linear_lfac;
-        raw_buff[(i << 1) + 1] = raw_buff[(i << 1) + 1] * linear_rfac;
-    }
-    return ESP_OK;
-}
-
-// Swap left and right channels
-static esp_err_t algorithm_data_swap(int16_t *raw_buff, int len)
-{
-    int16_t tmp;
-    for (int i = 0; i < len / 4; i++) {
-        tmp = raw_buff[i << 1];
-        raw_buff[i << 1]         = raw_buff[(i << 1) + 1];
-        raw_buff[(i << 1) + 1]   = tmp;
-    }
-    return ESP_OK;
-}
-
 static int algorithm_data_process_for_type1(audio_element_handle_t self)
 {
     algo_stream_t *algo = (algo_stream_t *)audio_element_getdata(self);
@@ -239,13 +211,13 @@ static int algorithm_data_process_for_type1(audio_element_handle_t self)
 
     bytes_read = audio_element_input(self, (char *)algo->aec_buff, size);
     if (bytes_read > 0) {
-        if (algo->swap_ch) {
-            algorithm_data_swap((int16_t *)algo->aec_buff, bytes_read);
-        }
+        // Swap and gain in one pass, the debug output is taken before the gain
+        int frames = bytes_read / (2 * sizeof(int16_t));
         if (algo->debug_input) {
+            channel_layout_permute(algo->aec_buff, 2, algo->aec_buff, 2, 16, algo->ch_order, frames);
             audio_element_output(self, (char *)algo->aec_buff, size);
         } else {
-            algorithm_data_gain(algo->aec_buff, size, algo->rec_linear_factor, algo->ref_linear_factor);
+            channel_layout_remap(algo->aec_buff, 2, algo->aec_buff, 2, 16, algo->ch_order, algo->ch_gain, frames);
             algo->afe_handle->feed(algo->afe_data, algo->aec_buff);
         }
     }
@@ -270,11 +242,8 @@ static int algorithm_data_process_for_type2(audio_element_handle_t self)
 
     bytes_read = audio_element_input(self, (char *)algo->record, size);
     if (bytes_read > 0) {
-        int16_t *temp = algo->aec_buff;
-        for (int i = 0; i < (size / 2); i++) {
-            temp[i << 1] = algo->record[i];
-            temp[(i << 1) + 1] = algo->reference[i];
-        }
+        const void *planes[2] = { algo->record, algo->reference };
+        channel_layout_interleave(algo->aec_buff, planes, 2, 16, size / sizeof(int16_t));
 
         if (algo->debug_input) {
             audio_element_output(self, (char *)algo->aec_buff, 2 * size);
@@ -324,15 +293,16 @@ audio_element_handle_t algo_stream_init(algorithm_stream_cfg_t *config)
     cfg.out_rb_size = config->out_rb_size;
     cfg.tag = "algorithm";
 
-    algo->swap_ch = config->swap_ch;
+    algo->ch_order[0] = config->swap_ch ? 1 : 0;
+    algo->ch_order[1] = config->swap_ch ? 0 : 1;
     algo->agc_gain = config->agc_gain;
     algo->mic_ch = config->mic_ch;
     algo->sample_rate = config->sample_rate;
     algo->input_type = config->input_type;
     algo->algo_mask = config->algo_mask;
     algo->aec_low_cost = config->aec_low_cost;
-    algo->rec_linear_factor = config->rec_linear_factor;
-    algo->ref_linear_factor = config->ref_linear_factor;
+    algo->ch_gain[0] = config->rec_linear_factor * CHANNEL_LAYOUT_GAIN_UNIT;
+    algo->ch_gain[1] = config->ref_linear_factor * CHANNEL_LAYOUT_GAIN_UNIT;
     algo->state = xEventGroupCreate();
     algo->debug_input = config->debug_input;
     audio_element_handle_t el = audio_element_init(&cfg);
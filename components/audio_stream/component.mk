@@ -2,5 +2,5 @@
 # "main" pseudo-component makefile.
 #
 COMPONENT_ADD_INCLUDEDIRS := ./include
-COMPONENT_SRCDIRS := . ./lib/hls ./lib/gzip
-COMPONENT_PRIV_INCLUDEDIRS := ./lib/hls/include ./lib/gzip/include
+COMPONENT_SRCDIRS := . ./lib/hls ./lib/gzip ./lib/pwm_duty ./lib/i2s_fmt ./lib/gain_engine ./lib/http_pool
+COMPONENT_PRIV_INCLUDEDIRS := ./lib/hls/include ./lib/gzip/include ./lib/pwm_duty/include ./lib/i2s_fmt/include ./lib/gain_engine/include ./lib/http_pool/include
@@ -23,6 +23,7 @@
  */
 
 #include <string.h>
+#include <stdlib.h>
 #include "esp_log.h"
 #include "audio_error.h"
 #include "audio_mem.h"
@@ -40,7 +41,9 @@ typedef struct embed_flash_s {
     audio_stream_type_t    type;
     bool                   is_open;
     int                    cur_index;
+    int                    info_num;
     embed_item_info_t      *info;
+    const embed_item_info_t *cur_item;   /*!< Item resolved from the uri at open, read directly from the mapped flash */
 } embed_flash_stream_t;
 
 static esp_err_t _embed_open(audio_element_handle_t self)
@@ -55,54 +58,91 @@ static esp_err_t _embed_open(audio_element_handle_t self)
         return ESP_FAIL;
     }
     char *url = audio_element_get_uri(self);
+    if (url == NULL || strncmp(url, EMBED_PREFIX_STR, strlen(EMBED_PREFIX_STR))) {
+        ESP_LOGE(TAG, "Embed flash uri is not correct!");
+        return ESP_FAIL;
+    }
     url += strlen(EMBED_PREFIX_STR);
-    char *temp = strchr(url, '_');
-    char find_num[EMBED_MAX_FILES] = { 0 };
-    int file_index = 0;
-    if (temp != NULL) {
-        strncpy(find_num, url, temp - url);
-        file_index = strtoul(find_num, 0, 10);
-        ESP_LOGD(TAG, "Wanted read flash tone index is %d", file_index);
-    } else {
+    char *temp = NULL;
+    int file_index = strtoul(url, &temp, 10);
+    if (temp == url || *temp != '_') {
         ESP_LOGE(TAG, "Embed flash file name is not correct!");
         return ESP_FAIL;
     }
+    if (file_index >= stream->info_num) {
+        ESP_LOGE(TAG, "Embed flash file index %d out of range %d", file_index, stream->info_num);
+        return ESP_FAIL;
+    }
+    ESP_LOGD(TAG, "Wanted read flash tone index is %d", file_index);
     stream->cur_index = file_index;
-    audio_element_info_t info = { 0 };
-    info.total_bytes = stream->info[stream->cur_index].size;
-    audio_element_setdata(self, stream);
-    audio_element_set_total_bytes(self, info.total_bytes);
+    stream->cur_item = &stream->info[file_index];
+    audio_element_set_total_bytes(self, stream->cur_item->size);
 
     stream->is_open = true;
     return ESP_OK;
 }
 
-static int _embed_read(audio_element_handle_t self, char *buffer, int len, TickType_t ticks_to_wait, void *context)
+int embed_flash_stream_acquire_read(audio_element_handle_t embed_stream, const uint8_t **data, int wanted_size)
 {
+    AUDIO_NULL_CHECK(TAG, embed_stream, return ESP_FAIL);
+    AUDIO_NULL_CHECK(TAG, data, return ESP_FAIL);
+    embed_flash_stream_t *stream = (embed_flash_stream_t *)audio_element_getdata(embed_stream);
+    if (stream->cur_item == NULL) {
+        ESP_LOGE(TAG, "Embed flash stream not opened");
+        return ESP_FAIL;
+    }
     audio_element_info_t info = { 0 };
-    embed_flash_stream_t *stream = NULL;
-
-    stream = (embed_flash_stream_t *)audio_element_getdata(self);
-    audio_element_getinfo(self, &info);
-    if (info.byte_pos + len > info.total_bytes) {
-        len = info.total_bytes - info.byte_pos;
+    audio_element_getinfo(embed_stream, &info);
+    if (info.byte_pos + wanted_size > info.total_bytes) {
+        wanted_size = info.total_bytes - info.byte_pos;
     }
-    if (len <= 0) {
-        ESP_LOGW(TAG, "No more data,ret:%d ,info.byte_pos:%llu", len, info.byte_pos);
+    if (wanted_size <= 0) {
+        *data = NULL;
         return ESP_OK;
     }
-    memcpy(buffer, stream->info[stream->cur_index].address + info.byte_pos, len);
+    *data = stream->cur_item->address + info.byte_pos;
+    return wanted_size;
+}
 
-    audio_element_update_byte_pos(self, len);
-    ESP_LOGD(TAG, "req lengh=%d, pos=%d/%d", len, (int)info.byte_pos, (int)info.total_bytes);
+esp_err_t embed_flash_stream_release_read(audio_element_handle_t embed_stream, int len)
+{
+    AUDIO_NULL_CHECK(TAG, embed_stream, return ESP_FAIL);
+    if (len <= 0) {
+        return ESP_OK;
+    }
+    return audio_element_update_byte_pos(embed_stream, len);
+}
 
+static int _embed_read(audio_element_handle_t self, char *buffer, int len, TickType_t ticks_to_wait, void *context)
+{
+    const uint8_t *data = NULL;
+    len = embed_flash_stream_acquire_read(self, &data, len);
+    if (len <= 0) {
+        ESP_LOGW(TAG, "No more data,ret:%d", len);
+        return len;
+    }
+    memcpy(buffer, data, len);
+    embed_flash_stream_release_read(self, len);
     return len;
 }
 
 static int _embed_process(audio_element_handle_t self, char *in_buffer, int in_len)
 {
-    int r_size = audio_element_input(self, in_buffer, in_len);
+    const uint8_t *data = NULL;
+    int r_size = 0;
     int w_size = 0;
+    if (audio_element_get_output_ringbuf(self)) {
+        // The data is already mapped, the ringbuffer copies it so the element buffer can be skipped
+        r_size = embed_flash_stream_acquire_read(self, &data, in_len);
+        if (r_size > 0) {
+            w_size = audio_element_output(self, (char *)data, r_size);
+            embed_flash_stream_release_read(self, w_size);
+            return w_size;
+        }
+        return r_size;
+    }
+    // A write callback may keep or modify the buffer, give it a copy in the element buffer
+    r_size = audio_element_input(self, in_buffer, in_len);
     if (r_size > 0) {
         w_size = audio_element_output(self, in_buffer, r_size);
     } else {
@@ -117,6 +157,7 @@ static esp_err_t _embed_close(audio_element_handle_t self)
     if (stream->is_open) {
        stream->is_open = false;
     }
+    stream->cur_item = NULL;
     audio_element_set_byte_pos(self, 0);
     return ESP_OK;
 }
@@ -177,10 +218,20 @@ esp_err_t  embed_flash_stream_set_context(audio_element_handle_t embed_stream, c
         max_can_saved_num *= 10;
     }
 
-    if (max_num > max_can_saved_num) {
+    if (max_num <= 0 || max_num > max_can_saved_num) {
         ESP_LOGW(TAG, "The maximum storage quantity is exceeded. It is recommended to modify the `EMBED_MAX_FILES` value");
         return ESP_FAIL;
     }
+    if (stream->is_open) {
+        ESP_LOGE(TAG, "Can not change the context while the stream is opened");
+        return ESP_FAIL;
+    }
+    for (int i = 0; i < max_num; i++) {
+        if (context[i].address == NULL || context[i].size < 0) {
+            ESP_LOGE(TAG, "Invalid embed item %d", i);
+            return ESP_FAIL;
+        }
+    }
 
     if (stream->info) {
         audio_free(stream->info);
@@ -188,6 +239,7 @@ esp_err_t  embed_flash_stream_set_context(audio_element_handle_t embed_stream, c
     stream->info = audio_calloc(max_num, sizeof(embed_item_info_t));
     AUDIO_MEM_CHECK(TAG, stream->info, return ESP_FAIL);
     memcpy(stream->info, context, sizeof(embed_item_info_t) * max_num);
+    stream->info_num = max_num;
 
     return ESP_OK;
 }
@@ -0,0 +1,145 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <string.h>
+
+#include "esp_log.h"
+
+#include "audio_element.h"
+#include "audio_error.h"
+#include "audio_mem.h"
+#include "gain_engine.h"
+#include "gain_stream.h"
+
+static const char *TAG = "GAIN_STREAM";
+
+typedef struct gain_stream {
+    gain_engine_t   engine;
+} gain_stream_t;
+
+static esp_err_t _gain_open(audio_element_handle_t self)
+{
+    gain_stream_t *gain = (gain_stream_t *)audio_element_getdata(self);
+    audio_element_info_t info = { 0 };
+    audio_element_getinfo(self, &info);
+    if (gain_engine_set_format(&gain->engine, info.sample_rates, info.channels, info.bits) != 0) {
+        ESP_LOGE(TAG, "Unsupported format, rate:%d, ch:%d, bits:%d", info.sample_rates, info.channels, info.bits);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+static int _gain_process(audio_element_handle_t self, char *in_buffer, int in_len)
+{
+    gain_stream_t *gain = (gain_stream_t *)audio_element_getdata(self);
+    int r_size = audio_element_input(self, in_buffer, in_len);
+    if (r_size <= 0) {
+        return r_size;
+    }
+    // Follow the music info, it may change after the decoder reports it
+    audio_element_info_t info = { 0 };
+    audio_element_getinfo(self, &info);
+    gain_engine_cfg_t *cfg = &gain->engine.cfg;
+    if (info.sample_rates != cfg->sample_rate || info.channels != cfg->channels || info.bits != cfg->bits) {
+        if (gain_engine_set_format(&gain->engine, info.sample_rates, info.channels, info.bits) != 0) {
+            ESP_LOGW(TAG, "Unsupported format, rate:%d, ch:%d, bits:%d, pass through", info.sample_rates, info.channels, info.bits);
+            return audio_element_output(self, in_buffer, r_size);
+        }
+    }
+    gain_engine_process(&gain->engine, in_buffer, r_size);
+    return audio_element_output(self, in_buffer, r_size);
+}
+
+static esp_err_t _gain_close(audio_element_handle_t self)
+{
+    return ESP_OK;
+}
+
+static esp_err_t _gain_destroy(audio_element_handle_t self)
+{
+    gain_stream_t *gain = (gain_stream_t *)audio_element_getdata(self);
+    audio_free(gain);
+    return ESP_OK;
+}
+
+esp_err_t gain_stream_set_db(audio_element_handle_t self, int ch, int gain_db)
+{
+    AUDIO_NULL_CHECK(TAG, self, return ESP_ERR_INVALID_ARG);
+    gain_stream_t *gain = (gain_stream_t *)audio_element_getdata(self);
+    if (gain_engine_set_db(&gain->engine, ch, gain_db) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
+
+esp_err_t gain_stream_get_db(audio_element_handle_t self, int ch, int *gain_db)
+{
+    AUDIO_NULL_CHECK(TAG, self, return ESP_ERR_INVALID_ARG);
+    AUDIO_NULL_CHECK(TAG, gain_db, return ESP_ERR_INVALID_ARG);
+    if (ch < 0 || ch >= GAIN_ENGINE_MAX_CH) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    gain_stream_t *gain = (gain_stream_t *)audio_element_getdata(self);
+    *gain_db = gain_engine_get_db(&gain->engine, ch);
+    return ESP_OK;
+}
+
+audio_element_handle_t gain_stream_init(gain_stream_cfg_t *config)
+{
+    AUDIO_NULL_CHECK(TAG, config, return NULL);
+    gain_stream_t *gain = audio_calloc(1, sizeof(gain_stream_t));
+    AUDIO_MEM_CHECK(TAG, gain, return NULL);
+
+    gain_engine_cfg_t engine_cfg = GAIN_ENGINE_CFG_DEFAULT();
+    engine_cfg.ramp_ms = config->ramp_ms;
+    engine_cfg.clip = config->soft_clip ? GAIN_ENGINE_CLIP_SOFT : GAIN_ENGINE_CLIP_HARD;
+    if (gain_engine_init(&gain->engine, &engine_cfg) != 0) {
+        ESP_LOGE(TAG, "Invalid gain configuration");
+        audio_free(gain);
+        return NULL;
+    }
+    // The initial gain is in place from the first sample, no ramp
+    gain_engine_set_db(&gain->engine, -1, config->gain_db);
+    gain_engine_settle(&gain->engine);
+
+    audio_element_cfg_t cfg = DEFAULT_AUDIO_ELEMENT_CONFIG();
+    cfg.open = _gain_open;
+    cfg.close = _gain_close;
+    cfg.process = _gain_process;
+    cfg.destroy = _gain_destroy;
+    cfg.task_stack = config->task_stack;
+    cfg.task_prio = config->task_prio;
+    cfg.task_core = config->task_core;
+    cfg.out_rb_size = config->out_rb_size;
+    cfg.buffer_len = config->buf_sz;
+    cfg.stack_in_ext = config->stack_in_ext;
+    cfg.tag = "gain";
+
+    audio_element_handle_t el = audio_element_init(&cfg);
+    AUDIO_MEM_CHECK(TAG, el, {
+        audio_free(gain);
+        return NULL;
+    });
+    audio_element_setdata(el, gain);
+    return el;
+}
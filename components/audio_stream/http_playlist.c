@@ -36,6 +36,7 @@ static const char *TAG = "HLS_PLAYLIST";
 
 #define MAX_PLAYLIST_TRACKS (128)
 #define MAX_PLAYLIST_KEEP_TRACKS (18)
+#define PLAYLIST_MEM_OWNER       "http_playlist"
 
 typedef struct track_ {
     char *uri;
@@ -74,12 +75,12 @@ void http_playlist_insert(http_playlist_t *playlist, char *track_uri)
         audio_free(track);
         playlist->total_tracks --;
     }
-    track = audio_calloc(1, sizeof(track_t));
+    track = audio_mem_calloc(1, sizeof(track_t), AUDIO_MEM_CAPS_DEFAULT, PLAYLIST_MEM_OWNER);
     if (track == NULL) {
         return;
     }
     if (strstr(track_uri, "http") == track_uri) { // Full URI
-        track->uri = audio_strdup(track_uri);
+        track->uri = audio_mem_strdup(track_uri, AUDIO_MEM_CAPS_DEFAULT, PLAYLIST_MEM_OWNER);
     } else {
         track->uri = join_url((char*)host_uri, track_uri);
     }
@@ -34,6 +34,7 @@
 #include "freertos/task.h"
 
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "http_stream.h"
 #include "http_playlist.h"
 #include "audio_mem.h"
@@ -44,6 +45,7 @@
 #include "hls_playlist.h"
 #include "audio_idf_version.h"
 #include "gzip_miniz.h"
+#include "http_pool.h"
 #if (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 3, 0))
 #include "aes/esp_aes.h"
 #elif (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 1, 0))
@@ -97,6 +99,10 @@ typedef struct http_stream {
     gzip_miniz_handle_t             gzip;             /* GZIP instance */
     http_stream_hls_key_t           *hls_key;
     hls_handle_t                    *hls_media;
+    http_pool_t                     pool;              /* Clients kept alive per host across tracks */
+    http_pool_entry_t               *conn;             /* Pool entry of the client in use, NULL if not pooled */
+    bool                            conn_live;         /* Client in use holds a connection from a completed request */
+    http_stream_conn_stats_t        conn_stats;
 } http_stream_t;
 
 static esp_err_t http_stream_auto_connect_next_track(audio_element_handle_t el);
@@ -161,7 +167,8 @@ static esp_err_t _http_event_handle(esp_http_client_event_t *evt)
     else if (strcasecmp(evt->header_key, "Content-Encoding") == 0) {
         http_stream_t *http = (http_stream_t *)audio_element_getdata(el);
         http->gzip_encoding = true;
-        if (strcasecmp(evt->header_value, "gzip") == 0) {
+        // The gzip reader also takes zlib data, which is what HTTP calls deflate
+        if (strcasecmp(evt->header_value, "gzip") == 0 || strcasecmp(evt->header_value, "deflate") == 0) {
             gzip_miniz_cfg_t cfg = {
                 .chunk_size = 1024,
                 .ctx = http,
@@ -413,6 +420,131 @@ static char *_playlist_get_next_track(audio_element_handle_t self)
     return NULL;
 }
 
+static uint32_t _http_now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static void _http_pool_close(void *conn, void *ctx)
+{
+    esp_http_client_close((esp_http_client_handle_t)conn);
+    esp_http_client_cleanup((esp_http_client_handle_t)conn);
+}
+
+static bool _http_conn_reusable(http_stream_t *http)
+{
+#if (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 1, 0))
+    // The next request can only follow a response read to its end
+    return http->_errno == 0 && esp_http_client_is_complete_data_received(http->client);
+#else
+    return false;
+#endif
+}
+
+static void _http_release_client(http_stream_t *http)
+{
+    if (http->client == NULL) {
+        return;
+    }
+    if (http->conn) {
+        // The pool closes the client when its connection can not be reused
+        http_pool_release(&http->pool, http->conn, _http_conn_reusable(http), _http_now_ms());
+    } else {
+        esp_http_client_close(http->client);
+        esp_http_client_cleanup(http->client);
+    }
+    http->client = NULL;
+    http->conn = NULL;
+    http->conn_live = false;
+}
+
+static esp_err_t _http_bind_client(audio_element_handle_t self, const char *uri)
+{
+    http_stream_t *http = (http_stream_t *)audio_element_getdata(self);
+    char key[HTTP_POOL_KEY_LEN];
+    if (http->client && (http->conn == NULL
+                         || (http_pool_key(uri, key, sizeof(key)) > 0 && strcmp(key, http->conn->key) == 0))) {
+        // Same host, the client keeps its connection if the last response was read to the end
+        if (_http_conn_reusable(http) == false) {
+            esp_http_client_close(http->client);
+            http->conn_live = false;
+        }
+        return esp_http_client_set_url(http->client, uri);
+    }
+    // Park the client of the previous host for its next request
+    _http_release_client(http);
+    http_pool_entry_t *entry = NULL;
+    if (http->pool.cfg.size > 0) {
+        entry = http_pool_acquire(&http->pool, uri, _http_now_ms());
+    }
+    if (entry && entry->conn) {
+        http->client = (esp_http_client_handle_t)entry->conn;
+        http->conn = entry;
+        http->conn_live = true;
+        return esp_http_client_set_url(http->client, uri);
+    }
+    esp_http_client_config_t http_cfg = {
+        .url = uri,
+        .event_handler = _http_event_handle,
+        .user_data = self,
+        .timeout_ms = 30 * 1000,
+        .buffer_size = HTTP_STREAM_BUFFER_SIZE,
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 1, 0)
+        .buffer_size_tx = 1024,
+#endif
+        .cert_pem = http->cert_pem,
+#if  (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 3, 0)) && defined CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+        .crt_bundle_attach = http->crt_bundle_attach,
+#endif //  (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 3, 0)) && defined CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+    };
+    http->client = esp_http_client_init(&http_cfg);
+    if (http->client == NULL) {
+        if (entry) {
+            http_pool_release(&http->pool, entry, false, _http_now_ms());
+        }
+        return ESP_ERR_NO_MEM;
+    }
+    if (entry) {
+        entry->conn = http->client;
+    }
+    http->conn = entry;
+    http->conn_live = false;
+    return ESP_OK;
+}
+
+static bool _http_request_begin(http_stream_t *http)
+{
+    http->conn_stats.requests++;
+    if (http->conn_live) {
+        http->conn_stats.reused++;
+        return true;
+    }
+    http->conn_stats.handshakes++;
+    return false;
+}
+
+static bool _http_request_retry(http_stream_t *http, bool reused, int post_len)
+{
+    // A kept alive connection may have been closed by the server meanwhile, send a request without body again
+    if (reused == false || post_len > 0) {
+        return false;
+    }
+    ESP_LOGW(TAG, "Kept alive connection closed by server, reconnect");
+    esp_http_client_close(http->client);
+    http->conn_live = false;
+    http->conn_stats.requests--;
+    http->conn_stats.reused--;
+    http->conn_stats.stale++;
+    return true;
+}
+
+static void _http_request_done(http_stream_t *http, int64_t start_us)
+{
+    http->conn_live = true;
+    http->conn_stats.last_ttfb_us = esp_timer_get_time() - start_us;
+    http->conn_stats.total_ttfb_us += http->conn_stats.last_ttfb_us;
+}
+
 static esp_err_t _http_open(audio_element_handle_t self)
 {
     http_stream_t *http = (http_stream_t *)audio_element_getdata(self);
@@ -452,26 +584,10 @@ _stream_open_begin:
     }
     audio_element_getinfo(self, &info);
     ESP_LOGD(TAG, "URI=%s", uri);
-    // if not initialize http client, initial it
-    if (http->client == NULL) {
-        esp_http_client_config_t http_cfg = {
-            .url = uri,
-            .event_handler = _http_event_handle,
-            .user_data = self,
-            .timeout_ms = 30 * 1000,
-            .buffer_size = HTTP_STREAM_BUFFER_SIZE,
-#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 1, 0)
-            .buffer_size_tx = 1024,
-#endif
-            .cert_pem = http->cert_pem,
-#if  (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 3, 0)) && defined CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
-            .crt_bundle_attach = http->crt_bundle_attach,
-#endif //  (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 3, 0)) && defined CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
-        };
-        http->client = esp_http_client_init(&http_cfg);
-        AUDIO_MEM_CHECK(TAG, http->client, return ESP_ERR_NO_MEM);
-    } else {
-        esp_http_client_set_url(http->client, uri);
+    // Take the client of the host from the pool, or initialize one
+    if ((err = _http_bind_client(self, uri)) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to prepare http client, err:%d", err);
+        return err;
     }
 
     if (info.byte_pos) {
@@ -497,13 +613,20 @@ _stream_open_begin:
 
     char *buffer = NULL;
     int post_len = esp_http_client_get_post_field(http->client, &buffer);
+    int64_t req_start = 0;
+    bool reused = false;
 _stream_redirect:
     if (http->gzip_encoding) {
         gzip_miniz_deinit(http->gzip);
         http->gzip = NULL;
         http->gzip_encoding = false;
     }
+    req_start = esp_timer_get_time();
+    reused = _http_request_begin(http);
     if ((err = esp_http_client_open(http->client, post_len)) != ESP_OK) {
+        if (_http_request_retry(http, reused, post_len)) {
+            goto _stream_redirect;
+        }
         ESP_LOGE(TAG, "Failed to open http stream");
         return err;
     }
@@ -530,6 +653,10 @@ _stream_redirect:
     * Due to the total byte of content has been changed after seek, set info.total_bytes at beginning only.
     */
     int64_t cur_pos = esp_http_client_fetch_headers(http->client);
+    if (cur_pos < 0 && _http_request_retry(http, reused, post_len)) {
+        goto _stream_redirect;
+    }
+    _http_request_done(http, req_start);
     audio_element_getinfo(self, &info);
     if (info.byte_pos <= 0) {
         info.total_bytes = cur_pos;
@@ -538,6 +665,10 @@ _stream_redirect:
     ESP_LOGI(TAG, "total_bytes=%d", (int)info.total_bytes);
     int status_code = esp_http_client_get_status_code(http->client);
     if (status_code == 301 || status_code == 302) {
+        if (_http_conn_reusable(http) == false) {
+            esp_http_client_close(http->client);
+            http->conn_live = false;
+        }
         esp_http_client_set_redirection(http->client);
         goto _stream_redirect;
     }
@@ -625,11 +756,8 @@ static esp_err_t _http_close(audio_element_handle_t self)
         gzip_miniz_deinit(http->gzip);
         http->gzip = NULL;
     }
-    if (http->client) {
-        esp_http_client_close(http->client);
-        esp_http_client_cleanup(http->client);
-        http->client = NULL;
-    }
+    // Keep the connection for the next track when the pool is enabled
+    _http_release_client(http);
     return ESP_OK;
 }
 
@@ -735,8 +863,40 @@ static int _http_write(audio_element_handle_t self, char *buffer, int len, TickT
     return wrlen;
 }
 
+static int _http_gzip_output(audio_element_handle_t self, int len)
+{
+    // Hand the inflated data to the output straight from the inflate window, skipping the element buffer
+    http_stream_t *http = (http_stream_t *)audio_element_getdata(self);
+    const uint8_t *data = NULL;
+    int r_size = gzip_miniz_acquire_read(http->gzip, &data, len);
+    if (r_size <= 0) {
+        // Stream end and errors are reported by the read path
+        return 0;
+    }
+    if (audio_element_is_stopping(self) == true) {
+        ESP_LOGW(TAG, "No output due to stopping");
+        return AEL_IO_ABORT;
+    }
+    int w_size = audio_element_output(self, (char *)data, r_size);
+    audio_element_multi_output(self, (char *)data, r_size, 0);
+    if (w_size > 0) {
+        gzip_miniz_release_read(http->gzip, w_size);
+        audio_element_update_byte_pos(self, w_size);
+        http->connect_times = 0;
+    }
+    return w_size;
+}
+
 static int _http_process(audio_element_handle_t self, char *in_buffer, int in_len)
 {
+    http_stream_t *http = (http_stream_t *)audio_element_getdata(self);
+    // Hooks and HLS decryption work on the element buffer, they keep the copying path
+    if (http->gzip && http->hook == NULL && http->hls_key == NULL) {
+        int w_size = _http_gzip_output(self, in_len);
+        if (w_size != 0) {
+            return w_size;
+        }
+    }
     int r_size = audio_element_input(self, in_buffer, in_len);
     if (audio_element_is_stopping(self) == true) {
         ESP_LOGW(TAG, "No output due to stopping");
@@ -744,7 +904,6 @@ static int _http_process(audio_element_handle_t self, char *in_buffer, int in_le
     }
     int w_size = 0;
     if (r_size > 0) {
-        http_stream_t *http = (http_stream_t *)audio_element_getdata(self);
         if (http->_errno != 0) {
             esp_err_t ret = ESP_OK;
             if (http->connect_times > HTTP_MAX_CONNECT_TIMES) {
@@ -777,6 +936,8 @@ static esp_err_t _http_destroy(audio_element_handle_t self)
         audio_free(http->playlist->data);
         audio_free(http->playlist);
     }
+    _http_release_client(http);
+    http_pool_deinit(&http->pool);
     audio_free(http);
     return ESP_OK;
 }
@@ -808,6 +969,16 @@ audio_element_handle_t http_stream_init(http_stream_cfg_t *config)
     http->stream_type = config->type;
     http->user_data = config->user_data;
     http->cert_pem = config->cert_pem;
+    if (config->type == AUDIO_STREAM_READER && config->conn_pool_size > 0) {
+        http_pool_cfg_t pool_cfg = {
+            .close = _http_pool_close,
+            .size = config->conn_pool_size,
+            .idle_ms = HTTP_STREAM_CONN_IDLE_MS,
+        };
+        if (http_pool_init(&http->pool, &pool_cfg) != 0) {
+            ESP_LOGW(TAG, "Connection pool size %d not supported, max %d", config->conn_pool_size, HTTP_POOL_MAX_CONN);
+        }
+    }
 
     if (config->crt_bundle_attach) {
 #if  (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 3, 0))
@@ -878,22 +1049,41 @@ esp_err_t http_stream_auto_connect_next_track(audio_element_handle_t el)
     http_stream_t *http = (http_stream_t *)audio_element_getdata(el);
     char *track = _playlist_get_next_track(el);
     if (track) {
-        esp_http_client_set_url(http->client, track);
+        if (_http_bind_client(el, track) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to prepare client for %s", track);
+            return ESP_FAIL;
+        }
         char *buffer = NULL;
         int post_len = esp_http_client_get_post_field(http->client, &buffer);
+        int64_t req_start = 0;
+        bool reused = false;
 redirection:
+        req_start = esp_timer_get_time();
+        reused = _http_request_begin(http);
         if ((esp_http_client_open(http->client, post_len)) != ESP_OK) {
+            if (_http_request_retry(http, reused, post_len)) {
+                goto redirection;
+            }
             ESP_LOGE(TAG, "Failed to open http stream");
             return ESP_FAIL;
         }
         if (dispatch_hook(el, HTTP_STREAM_POST_REQUEST, NULL, 0) < 0) {
             esp_http_client_close(http->client);
+            http->conn_live = false;
             return ESP_FAIL;
         }
         info.total_bytes = esp_http_client_fetch_headers(http->client);
+        if (info.total_bytes < 0 && _http_request_retry(http, reused, post_len)) {
+            goto redirection;
+        }
+        _http_request_done(http, req_start);
         ESP_LOGI(TAG, "total_bytes=%d", (int)info.total_bytes);
         int status_code = esp_http_client_get_status_code(http->client);
         if (status_code == 301 || status_code == 302) {
+            if (_http_conn_reusable(http) == false) {
+                esp_http_client_close(http->client);
+                http->conn_live = false;
+            }
             esp_http_client_set_redirection(http->client);
             goto redirection;
         }
@@ -926,6 +1116,28 @@ esp_err_t http_stream_restart(audio_element_handle_t el)
 esp_err_t http_stream_set_server_cert(audio_element_handle_t el, const char *cert)
 {
     http_stream_t *http = (http_stream_t *)audio_element_getdata(el);
+    if (http->cert_pem != cert) {
+        // Do not reuse a connection or resume a session that the new certification did not verify
+        if (http->conn) {
+            http_pool_release(&http->pool, http->conn, false, _http_now_ms());
+        } else if (http->client) {
+            esp_http_client_close(http->client);
+            esp_http_client_cleanup(http->client);
+        }
+        http->client = NULL;
+        http->conn = NULL;
+        http->conn_live = false;
+        http_pool_flush(&http->pool);
+    }
     http->cert_pem = cert;
     return ESP_OK;
 }
+
+esp_err_t http_stream_get_conn_stats(audio_element_handle_t el, http_stream_conn_stats_t *stats)
+{
+    AUDIO_NULL_CHECK(TAG, el, return ESP_FAIL);
+    AUDIO_NULL_CHECK(TAG, stats, return ESP_FAIL);
+    http_stream_t *http = (http_stream_t *)audio_element_getdata(el);
+    *stats = http->conn_stats;
+    return ESP_OK;
+}
@@ -38,12 +38,15 @@
 #include "audio_mem.h"
 #include "audio_element.h"
 #include "i2s_stream.h"
-#include "esp_alc.h"
 #include "board_pins_config.h"
 #include "audio_idf_version.h"
+#include "channel_layout.h"
+#include "i2s_fmt.h"
+#include "gain_engine.h"
 
 static const char *TAG = "I2S_STREAM";
 
+#define I2S_STREAM_FMT_BUF_SIZE     (2048)
 
 #if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(4, 2, 0)
 #define SOC_I2S_SUPPORTS_ADC_DAC 1
@@ -58,66 +61,31 @@ typedef struct i2s_stream {
     i2s_stream_cfg_t    config;
     bool                is_open;
     bool                use_alc;
-    void                *volume_handle;
+    gain_engine_t       *volume_handle;
     int                 volume;
     bool                uninstall_drv;
+    i2s_fmt_t           fmt;            /*!< Output format stage of the writer */
+    bool                fmt_ready;
+    int                 fmt_bits;       /*!< Music info the format stage is built for */
+    int                 fmt_channels;
+    int                 fmt_chunk;      /*!< Input bytes converted per output buffer */
+    uint8_t             *fmt_buf;       /*!< Output buffer when the data is expanded */
 } i2s_stream_t;
 #ifdef SOC_I2S_SUPPORTS_ADC_DAC
 static esp_err_t i2s_mono_fix(int bits, uint8_t *sbuff, uint32_t len)
 {
+    // 16bit swaps every sample pair, 32bit only swaps the first pair of every 4 samples
+    static const int8_t order[4] = { 1, 0, 2, 3 };
     if (bits == 16) {
-        int16_t *temp_buf = (int16_t *)sbuff;
-        int16_t temp_box;
-        int k = len >> 1;
-        for (int i = 0; i < k; i += 2) {
-            temp_box = temp_buf[i];
-            temp_buf[i] = temp_buf[i + 1];
-            temp_buf[i + 1] = temp_box;
-        }
+        channel_layout_permute(sbuff, 2, sbuff, 2, 16, order, len >> 2);
     } else if (bits == 32) {
-        int32_t *temp_buf = (int32_t *)sbuff;
-        int32_t temp_box;
-        int k = len >> 2;
-        for (int i = 0; i < k; i += 4) {
-            temp_box = temp_buf[i];
-            temp_buf[i] = temp_buf[i + 1];
-            temp_buf[i + 1] = temp_box;
-        }
+        channel_layout_permute(sbuff, 4, sbuff, 4, 32, order, len >> 4);
     } else {
         ESP_LOGE(TAG, "%s %dbits is not supported", __func__, bits);
         return ESP_FAIL;
     }
     return ESP_OK;
 }
-
-/**
- * @brief Scale data to 16bit/32bit for I2S DMA output.
- *        DAC can only output 8bit data value.
- *        I2S DMA will still send 16bit or 32bit data, the highest 8bit contains DAC data.
- */
-static int i2s_dac_data_scale(int bits, uint8_t *sBuff, uint32_t len)
-{
-    if (bits == 16) {
-        short *buf16 = (short *)sBuff;
-        int k = len >> 1;
-        for (int i = 0; i < k; i++) {
-            buf16[i] &= 0xff00;
-            buf16[i] += 0x8000;//turn signed value into unsigned, expand negative value into positive range
-        }
-    } else if (bits == 32) {
-        int *buf32 = (int *)sBuff;
-        int k = len >> 2;
-        for (int i = 0; i < k; i++) {
-            buf32[i] &= 0xff000000;
-            buf32[i] += 0x80000000;//turn signed value into unsigned
-        }
-    } else {
-        ESP_LOGE(TAG, "in %s %dbits is not supported", __func__, bits);
-        return -1;
-    }
-
-    return 0;
-}
 #endif
 
 static int i2s_stream_clear_dma_buffer(audio_element_handle_t self)
@@ -140,6 +108,55 @@ static int i2s_stream_clear_dma_buffer(audio_element_handle_t self)
     return ESP_OK;
 }
 
+/**
+ * @brief Resolve the writer's output stage (mono fix, DAC scaling and bit expansion) for the current music info.
+ *        DAC can only output 8bit data value, I2S DMA will still send 16bit or 32bit data, the highest 8bit contains DAC data.
+ */
+static esp_err_t i2s_stream_fmt_update(i2s_stream_t *i2s, int bits, int channels)
+{
+    if (i2s->fmt_ready && i2s->fmt_bits == bits && i2s->fmt_channels == channels) {
+        return ESP_OK;
+    }
+    i2s_fmt_cfg_t cfg = {
+        .op_bits = bits,
+        .src_bits = bits,
+        .dst_bits = bits,
+    };
+#ifdef CONFIG_IDF_TARGET_ESP32
+    cfg.mono_fix = (channels == 1);
+#endif
+#if SOC_I2S_SUPPORTS_ADC_DAC
+    cfg.dac_scale = ((i2s->config.i2s_config.mode & I2S_MODE_DAC_BUILT_IN) != 0);
+#endif
+    if (i2s->config.need_expand && (i2s->config.i2s_config.bits_per_sample != i2s->config.expand_src_bits)) {
+        cfg.src_bits = i2s->config.expand_src_bits;
+        cfg.dst_bits = i2s->config.i2s_config.bits_per_sample;
+    }
+    i2s->fmt_bits = bits;
+    i2s->fmt_channels = channels;
+    i2s->fmt_ready = true;
+    if (i2s_fmt_build(&i2s->fmt, &cfg) != 0) {
+        ESP_LOGE(TAG, "Output format not supported, %dbits, expand %d to %d bits", bits, cfg.src_bits, cfg.dst_bits);
+        memset(&i2s->fmt, 0, sizeof(i2s_fmt_t));
+        return ESP_FAIL;
+    }
+    if (i2s_fmt_need_output(&i2s->fmt)) {
+        int src_bytes = cfg.src_bits >> 3;
+        i2s->fmt_chunk = I2S_STREAM_FMT_BUF_SIZE / (cfg.dst_bits >> 3) * src_bytes;
+        i2s->fmt_chunk -= i2s->fmt_chunk % (src_bytes << 2);
+        if (i2s->fmt_buf == NULL) {
+            i2s->fmt_buf = audio_malloc(I2S_STREAM_FMT_BUF_SIZE);
+            AUDIO_MEM_CHECK(TAG, i2s->fmt_buf, {
+                // Leave no stage that writes to the missing buffer, the next update retries
+                memset(&i2s->fmt, 0, sizeof(i2s_fmt_t));
+                i2s->fmt_ready = false;
+                return ESP_ERR_NO_MEM;
+            });
+        }
+    }
+    return ESP_OK;
+}
+
 static esp_err_t _i2s_set_clk(i2s_port_t i2s_num, uint32_t rate, uint32_t bits_cfg, int ch)
 {
     i2s_channel_t channel;
@@ -163,15 +180,21 @@ static esp_err_t _i2s_open(audio_element_handle_t self)
 
     if (i2s->type == AUDIO_STREAM_WRITER) {
         audio_element_set_input_timeout(self, 10 / portTICK_RATE_MS);
+        audio_element_info_t info;
+        audio_element_getinfo(self, &info);
+        if (i2s_stream_fmt_update(i2s, info.bits, info.channels) == ESP_ERR_NO_MEM) {
+            return ESP_ERR_NO_MEM;
+        }
         ESP_LOGI(TAG, "AUDIO_STREAM_WRITER");
     }
     i2s->is_open = true;
     if (i2s->use_alc) {
-        i2s->volume_handle = alc_volume_setup_open();
-        if (i2s->volume_handle == NULL) {
-            ESP_LOGE(TAG, "i2s create the handle for setting volume failed, in line(%d)", __LINE__);
-            return ESP_FAIL;
-        }
+        audio_element_info_t info = { 0 };
+        audio_element_getinfo(self, &info);
+        gain_engine_set_format(i2s->volume_handle, info.sample_rates, info.channels, info.bits);
+        // Start at the configured volume, later changes are ramped
+        gain_engine_set_db(i2s->volume_handle, -1, i2s->volume);
+        gain_engine_settle(i2s->volume_handle);
     }
     return ESP_OK;
 }
@@ -182,6 +205,11 @@ static esp_err_t _i2s_destroy(audio_element_handle_t self)
     if (i2s->uninstall_drv) {
         i2s_driver_uninstall(i2s->config.i2s_port);
     }
+    if (i2s->fmt_buf) {
+        audio_free(i2s->fmt_buf);
+    }
+    // Kept for the whole element life, the volume setters use it from other tasks
+    audio_free(i2s->volume_handle);
     audio_free(i2s);
     return ESP_OK;
 }
@@ -198,11 +226,6 @@ static esp_err_t _i2s_close(audio_element_handle_t self)
         audio_element_report_pos(self);
         audio_element_set_byte_pos(self, 0);
     }
-    if (i2s->use_alc) {
-        if (i2s->volume_handle != NULL) {
-            alc_volume_setup_close(i2s->volume_handle);
-        }
-    }
     return ESP_OK;
 }
 
@@ -230,31 +253,31 @@ static int _i2s_write(audio_element_handle_t self, char *buffer, int len, TickTy
     size_t bytes_written = 0;
     audio_element_info_t info;
     audio_element_getinfo(self, &info);
-    if (len > 0) {
-#ifdef CONFIG_IDF_TARGET_ESP32
-        if (info.channels == 1) {
-            i2s_mono_fix(info.bits, (uint8_t *)buffer, len);
-        }
-#endif
-#if SOC_I2S_SUPPORTS_ADC_DAC
-        if ((i2s->config.i2s_config.mode & I2S_MODE_DAC_BUILT_IN) != 0) {
-            i2s_dac_data_scale(info.bits, (uint8_t *)buffer, len);
-        }
-#endif
+    if (len <= 0) {
+        return 0;
     }
-
-    if (i2s->config.need_expand && (i2s->config.i2s_config.bits_per_sample != i2s->config.expand_src_bits)) {
-        i2s_write_expand(i2s->config.i2s_port,
-                         buffer,
-                         len,
-                         i2s->config.expand_src_bits,
-                         i2s->config.i2s_config.bits_per_sample,
-                         &bytes_written,
-                         ticks_to_wait);
-    } else {
+    // Rebuilt only when the music info changes, e.g. after i2s_stream_set_clk
+    if (i2s_stream_fmt_update(i2s, info.bits, info.channels) == ESP_ERR_NO_MEM) {
+        return AEL_IO_FAIL;
+    }
+    if (!i2s_fmt_need_output(&i2s->fmt)) {
+        i2s_fmt_run(&i2s->fmt, NULL, buffer, len);
         i2s_write(i2s->config.i2s_port, buffer, len, &bytes_written, ticks_to_wait);
+        return bytes_written;
+    }
+    // Swap, DAC scaling and expansion in one pass into the buffer handed to the driver
+    int src_bytes = i2s->fmt.cfg.src_bits >> 3;
+    int dst_bytes = i2s->fmt.cfg.dst_bits >> 3;
+    for (int pos = 0; pos < len; pos += i2s->fmt_chunk) {
+        int in_len = (len - pos) < i2s->fmt_chunk ? (len - pos) : i2s->fmt_chunk;
+        int out_len = i2s_fmt_run(&i2s->fmt, i2s->fmt_buf, buffer + pos, in_len);
+        size_t out_written = 0;
+        i2s_write(i2s->config.i2s_port, i2s->fmt_buf, out_len, &out_written, ticks_to_wait);
+        bytes_written += out_written / dst_bytes * src_bytes;
+        if (out_written < (size_t)out_len) {
+            break;
+        }
     }
-
     return bytes_written;
 }
 
@@ -279,7 +302,15 @@ static int _i2s_process(audio_element_handle_t self, char *in_buffer, int in_len
     } else if (r_size > 0) {
         if (i2s->use_alc) {
             audio_element_getinfo(self, &i2s_info);
-            alc_volume_setup_process(in_buffer, r_size, i2s_info.channels, i2s->volume_handle, i2s->volume);
+            gain_engine_cfg_t *gain_cfg = &i2s->volume_handle->cfg;
+            bool gain_ok = true;
+            if (i2s_info.sample_rates != gain_cfg->sample_rate || i2s_info.channels != gain_cfg->channels
+                || i2s_info.bits != gain_cfg->bits) {
+                gain_ok = gain_engine_set_format(i2s->volume_handle, i2s_info.sample_rates, i2s_info.channels, i2s_info.bits) == 0;
+            }
+            if (gain_ok) {
+                gain_engine_process(i2s->volume_handle, in_buffer, r_size);
+            }
         }
         audio_element_multi_output(self, in_buffer, r_size, 0);
         w_size = audio_element_output(self, in_buffer, r_size);
@@ -319,6 +350,9 @@ int i2s_alc_volume_set(audio_element_handle_t i2s_stream, int volume)
     i2s_stream_t *i2s = (i2s_stream_t *)audio_element_getdata(i2s_stream);
     if (i2s->use_alc) {
         i2s->volume = volume;
+        if (i2s->volume_handle) {
+            gain_engine_set_db(i2s->volume_handle, -1, volume);
+        }
         return ESP_OK;
     } else {
         ESP_LOGW(TAG, "The ALC don't be used. It can not be set.");
@@ -368,6 +402,15 @@ audio_element_handle_t i2s_stream_init_driver(i2s_stream_cfg_t *config, bool i2s
     i2s->use_alc = config->use_alc;
     i2s->volume = config->volume;
     i2s->uninstall_drv = config->uninstall_drv;
+    if (i2s->use_alc) {
+        i2s->volume_handle = audio_calloc(1, sizeof(gain_engine_t));
+        AUDIO_MEM_CHECK(TAG, i2s->volume_handle, {
+            audio_free(i2s);
+            return NULL;
+        });
+        gain_engine_cfg_t gain_cfg = GAIN_ENGINE_CFG_DEFAULT();
+        gain_engine_init(i2s->volume_handle, &gain_cfg);
+    }
 
     if (config->type == AUDIO_STREAM_READER) {
         cfg.read = _i2s_read;
@@ -378,6 +421,7 @@ audio_element_handle_t i2s_stream_init_driver(i2s_stream_cfg_t *config, bool i2s
     if (! i2s_preinstalled) {
         esp_err_t ret = i2s_driver_install(i2s->config.i2s_port, &i2s->config.i2s_config, 0, NULL);
         if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+            audio_free(i2s->volume_handle);
             audio_free(i2s);
             return NULL;
         }
@@ -385,6 +429,7 @@ audio_element_handle_t i2s_stream_init_driver(i2s_stream_cfg_t *config, bool i2s
 
     el = audio_element_init(&cfg);
     AUDIO_MEM_CHECK(TAG, el, {
+        audio_free(i2s->volume_handle);
         audio_free(i2s);
         return NULL;
     });
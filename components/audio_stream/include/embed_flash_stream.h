@@ -90,5 +90,34 @@ audio_element_handle_t embed_flash_stream_init(embed_flash_stream_cfg_t *config)
  */
 esp_err_t  embed_flash_stream_set_context(audio_element_handle_t embed_stream, const embed_item_info_t *context, int max_num);
 
+/**
+ * @brief      Get a pointer to the next chunk of the opened embed flash file without copying it
+ *
+ *             The returned data points into the memory-mapped flash and stays valid until the context is changed.
+ *             Call `embed_flash_stream_release_read` with the consumed length to advance the read position.
+ *
+ * @param[in]  embed_stream         The embed flash element handle
+ * @param[out] data                 Pointer to the data in flash
+ * @param[in]  wanted_size          Wanted size in bytes
+ *
+ * @return
+ *     - > 0: Number of bytes available at `data`
+ *     - 0: End of the file
+ *     - ESP_FAIL: The stream is not opened or the arguments are invalid
+ */
+int embed_flash_stream_acquire_read(audio_element_handle_t embed_stream, const uint8_t **data, int wanted_size);
+
+/**
+ * @brief      Advance the read position after the data from `embed_flash_stream_acquire_read` is consumed
+ *
+ * @param[in]  embed_stream         The embed flash element handle
+ * @param[in]  len                  Consumed size in bytes
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_FAIL
+ */
+esp_err_t embed_flash_stream_release_read(audio_element_handle_t embed_stream, int len);
+
 #endif // __EMBED_FLASH_H__
 
@@ -0,0 +1,108 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _GAIN_STREAM_H_
+#define _GAIN_STREAM_H_
+
+#include "audio_element.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Gain Stream configurations, applies per channel gains with smooth ramps and limits at 0 dBFS
+ *          The sample format follows the music info of the element, 16, 24 (packed) or 32 bits
+ */
+typedef struct {
+    int  buf_sz;        /*!< Audio Element Buffer size */
+    int  out_rb_size;   /*!< Size of output ringbuffer */
+    int  task_stack;    /*!< Task stack size */
+    int  task_core;     /*!< Task running in core (0 or 1) */
+    int  task_prio;     /*!< Task priority (based on freeRTOS priority) */
+    bool stack_in_ext;  /*!< Try to allocate stack in external memory */
+    int  gain_db;       /*!< Initial gain of all channels in dB */
+    int  ramp_ms;       /*!< Time a gain change takes, 0 to switch at once */
+    bool soft_clip;     /*!< Compress peaks smoothly instead of saturating at full scale */
+} gain_stream_cfg_t;
+
+#define GAIN_STREAM_BUF_SIZE        (2048)
+#define GAIN_STREAM_TASK_STACK      (3072)
+#define GAIN_STREAM_TASK_CORE       (0)
+#define GAIN_STREAM_TASK_PRIO       (5)
+#define GAIN_STREAM_RINGBUFFER_SIZE (8 * 1024)
+#define GAIN_STREAM_RAMP_MS         (20)
+
+#define GAIN_STREAM_CFG_DEFAULT()                   \
+{                                                   \
+    .buf_sz       = GAIN_STREAM_BUF_SIZE,           \
+    .out_rb_size  = GAIN_STREAM_RINGBUFFER_SIZE,    \
+    .task_stack   = GAIN_STREAM_TASK_STACK,         \
+    .task_core    = GAIN_STREAM_TASK_CORE,          \
+    .task_prio    = GAIN_STREAM_TASK_PRIO,          \
+    .stack_in_ext = true,                           \
+    .gain_db      = 0,                              \
+    .ramp_ms      = GAIN_STREAM_RAMP_MS,            \
+    .soft_clip    = false,                          \
+}
+
+/**
+ * @brief      Create an Audio Element handle that applies gain to the passing data
+ *
+ * @param      config  The configuration
+ *
+ * @return     The Audio Element handle
+ */
+audio_element_handle_t gain_stream_init(gain_stream_cfg_t *config);
+
+/**
+ * @brief      Set the gain, the change is ramped over `ramp_ms`
+ *
+ * @param[in]  self     The gain element handle
+ * @param[in]  ch       Channel index, -1 for all channels
+ * @param[in]  gain_db  Gain in dB, -96 and below mutes, capped at +24
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_INVALID_ARG
+ */
+esp_err_t gain_stream_set_db(audio_element_handle_t self, int ch, int gain_db);
+
+/**
+ * @brief      Get the gain last set of a channel
+ *
+ * @param[in]  self     The gain element handle
+ * @param[in]  ch       Channel index
+ * @param[out] gain_db  Gain in dB
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_INVALID_ARG
+ */
+esp_err_t gain_stream_get_db(audio_element_handle_t self, int ch, int *gain_db);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -88,13 +88,29 @@ typedef struct {
     const char                  *cert_pem;              /*!< SSL server certification, PEM format as string, if the client requires to verify server */
     esp_err_t (*crt_bundle_attach)(void *conf);       /*!< Function pointer to esp_crt_bundle_attach. Enables the use of certification
                                                           bundle for server verification, must be enabled in menuconfig */
+    int                         conn_pool_size;         /*!< Number of hosts whose connection is kept alive across tracks and segments (reader only),
+                                                             e.g. `HTTP_STREAM_CONN_POOL_SIZE`, 0 (default) to close the connection when the track is closed */
 } http_stream_cfg_t;
 
+/**
+ * @brief      Connection statistics of HTTP Stream reader
+ */
+typedef struct {
+    int                         requests;               /*!< Requests sent */
+    int                         handshakes;             /*!< Requests sent on a new connection, paying the TCP and TLS handshakes */
+    int                         reused;                 /*!< Requests sent on a kept alive connection */
+    int                         stale;                  /*!< Kept alive connections closed by the server, the request was sent again on a new one */
+    int64_t                     last_ttfb_us;           /*!< Time from starting the last request (connecting included) to its response headers */
+    int64_t                     total_ttfb_us;          /*!< Sum of the time to first byte of all requests */
+} http_stream_conn_stats_t;
+
 
 #define HTTP_STREAM_TASK_STACK          (6 * 1024)
 #define HTTP_STREAM_TASK_CORE           (0)
 #define HTTP_STREAM_TASK_PRIO           (4)
 #define HTTP_STREAM_RINGBUFFER_SIZE     (20 * 1024)
+#define HTTP_STREAM_CONN_POOL_SIZE      (2)
+#define HTTP_STREAM_CONN_IDLE_MS        (15 * 1000)
 
 #define HTTP_STREAM_CFG_DEFAULT() {              \
     .type = AUDIO_STREAM_READER,                 \
@@ -110,6 +126,7 @@ typedef struct {
     .multi_out_num = 0,                          \
     .cert_pem  = NULL,                           \
     .crt_bundle_attach = NULL,                   \
+    .conn_pool_size = 0, \
 }
 
 /**
@@ -154,6 +171,7 @@ esp_err_t http_stream_fetch_again(audio_element_handle_t el);
 /**
  * @brief       Set SSL server certification
  * @note        EM format as string, if the client requires to verify server
+ *              The pooled connections and TLS sessions were verified with the previous certification, they are closed
  *
  * @param       el    The http_stream element handle
  * @param       cert  server certification
@@ -163,6 +181,22 @@ esp_err_t http_stream_fetch_again(audio_element_handle_t el);
  */
 esp_err_t http_stream_set_server_cert(audio_element_handle_t el, const char *cert);
 
+/**
+ * @brief       Get the connection statistics
+ *
+ *              Connections are kept alive per host when `conn_pool_size` is set, so the tracks of a playlist
+ *              and the segments of a HLS stream skip the TCP and TLS handshakes.
+ *              Idle connections are closed after `HTTP_STREAM_CONN_IDLE_MS`.
+ *
+ * @param       el     The http_stream element handle
+ * @param       stats  Statistics since the element was created
+ *
+ * @return
+ *     - ESP_OK on success
+ *     - ESP_FAIL on wrong parameter
+ */
+esp_err_t http_stream_get_conn_stats(audio_element_handle_t el, http_stream_conn_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
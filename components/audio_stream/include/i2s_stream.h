@@ -278,10 +278,10 @@ audio_element_handle_t i2s_stream_init_driver(i2s_stream_cfg_t *config, bool i2s
 esp_err_t i2s_stream_set_clk(audio_element_handle_t i2s_stream, int rate, int bits, int ch);
 
 /**
- * @brief      Setup volume of stream by using ALC
+ * @brief      Setup volume of stream by using ALC, the change is ramped to avoid zipper noise
  *
  * @param[in]  i2s_stream   The i2s element handle
- * @param[in]  volume       The volume of stream will be set.
+ * @param[in]  volume       The volume of stream will be set, in dB (-96 and below mutes, capped at +24)
  *
  * @return
  *     - ESP_OK
@@ -0,0 +1,319 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <stdbool.h>
+#include <string.h>
+#include "gain_engine.h"
+
+#define SOFT_KNEE_NUM   (3)         // Soft clip starts at 3/4 of full scale, about -2.5 dBFS
+#define SOFT_KNEE_DEN   (4)
+
+// 10^(dB / 20) in Q4.27 for GAIN_ENGINE_DB_MIN to GAIN_ENGINE_DB_MAX in 1 dB steps
+static const int32_t gain_db_table[GAIN_ENGINE_DB_MAX - GAIN_ENGINE_DB_MIN + 1] = {
+          2127,       2387,       2678,       3005,       3371,       3783,
+          4244,       4762,       5343,       5995,       6727,       7548,
+          8469,       9502,      10661,      11962,      13422,      15059,
+         16897,      18959,      21272,      23868,      26780,      30048,
+         33714,      37828,      42443,      47622,      53433,      59953,
+         67268,      75476,      84686,      95019,     106613,     119622,
+        134218,     150595,     168970,     189588,     212721,     238677,
+        267800,     300476,     337140,     378277,     424434,     476222,
+        534330,     599529,     672682,     754762,     846857,     950189,
+       1066129,    1196217,    1342177,    1505948,    1689701,    1895876,
+       2127208,    2386766,    2677996,    3004761,    3371397,    3782770,
+       4244337,    4762225,    5343304,    5995286,    6726821,    7547618,
+       8468566,    9501887,   10661293,   11962168,   13421773,   15059477,
+      16897011,   18958758,   21272076,   23867662,   26779957,   30047606,
+      33713969,   37827695,   42443372,   47622247,   53433040,   59952857,
+      67268212,   75476175,   84685661,   95018875,  106612931,  119621676,
+     134217728,  150594768,  168970108,  189587580,  212720763,  238676622,
+     267799575,  300476065,  337139690,  378276954,  424433723,  476222470,
+     534330399,  599528569,  672682118,  754761750,  846856612,  950188747,
+    1066129310, 1196216760, 1342177280, 1505947677, 1689701085, 1895875800,
+    2127207634,
+};
+
+int32_t gain_engine_db_to_q27(int db)
+{
+    if (db <= GAIN_ENGINE_DB_MIN) {
+        return 0;
+    }
+    if (db > GAIN_ENGINE_DB_MAX) {
+        db = GAIN_ENGINE_DB_MAX;
+    }
+    return gain_db_table[db - GAIN_ENGINE_DB_MIN];
+}
+
+static inline __attribute__((always_inline)) int32_t load_sample(const uint8_t *p, int bits)
+{
+    if (bits == 16) {
+        int16_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    } else if (bits == 24) {
+        return (int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 24)) >> 8;
+    }
+    int32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline __attribute__((always_inline)) void store_sample(uint8_t *p, int32_t v, int bits)
+{
+    if (bits == 16) {
+        int16_t s = (int16_t)v;
+        memcpy(p, &s, sizeof(s));
+    } else if (bits == 24) {
+        p[0] = (uint8_t)v;
+        p[1] = (uint8_t)(v >> 8);
+        p[2] = (uint8_t)(v >> 16);
+    } else {
+        memcpy(p, &v, sizeof(v));
+    }
+}
+
+static inline __attribute__((always_inline)) int32_t gain_sample(int32_t s, int32_t gain, int bits, bool soft)
+{
+    const int64_t fs = ((int64_t)1 << (bits - 1)) - 1;
+    int64_t x = ((int64_t)s * gain + (1 << (GAIN_ENGINE_Q - 1))) >> GAIN_ENGINE_Q;
+    if (soft) {
+        // k + r * d / (r + d) written as k + r - r^2 / (r + d) so the product can not overflow
+        const int64_t knee = fs * SOFT_KNEE_NUM / SOFT_KNEE_DEN;
+        const int64_t r = fs - knee;
+        int64_t a = x < 0 ? -x : x;
+        if (a > knee) {
+            a = knee + r - r * r / (a - knee + r);
+            x = x < 0 ? -a : a;
+        }
+        return (int32_t)x;
+    }
+    if (x > fs) {
+        return (int32_t)fs;
+    }
+    if (x < -fs - 1) {
+        return (int32_t)(-fs - 1);
+    }
+    return (int32_t)x;
+}
+
+// One channel of interleaved data, the ramp part first then the steady part with a fixed gain
+static inline __attribute__((always_inline)) void gain_channel(uint8_t *p, int stride, int n, gain_engine_ch_t *c, int bits, bool soft)
+{
+    int i = 0;
+    for (; i < n && c->remain > 0; i++, p += stride) {
+        c->gain += c->step;
+        if (--c->remain == 0) {
+            c->gain = c->target;
+        }
+        store_sample(p, gain_sample(load_sample(p, bits), c->gain, bits, soft), bits);
+    }
+    if (i == n || (c->gain == GAIN_ENGINE_UNITY && !soft)) {
+        return;
+    }
+    const int32_t gain = c->gain;
+    if (bits == 16 && !soft && gain <= GAIN_ENGINE_UNITY) {
+        // Attenuation of 16bit data in Q15, the product fits in 32 bits and can not exceed full scale
+        const int32_t q15 = (gain + (1 << (GAIN_ENGINE_Q - 16))) >> (GAIN_ENGINE_Q - 15);
+        if (stride == sizeof(int16_t)) {
+            for (int k = 0; k < n - i; k++) {
+                int16_t v;
+                memcpy(&v, p + k * sizeof(v), sizeof(v));
+                v = (int16_t)((v * q15 + (1 << 14)) >> 15);
+                memcpy(p + k * sizeof(v), &v, sizeof(v));
+            }
+            return;
+        }
+        for (; i < n; i++, p += stride) {
+            int16_t v;
+            memcpy(&v, p, sizeof(v));
+            v = (int16_t)((v * q15 + (1 << 14)) >> 15);
+            memcpy(p, &v, sizeof(v));
+        }
+        return;
+    }
+    #pragma GCC unroll 4
+    for (; i < n; i++, p += stride) {
+        store_sample(p, gain_sample(load_sample(p, bits), gain, bits, soft), bits);
+    }
+}
+
+typedef void (*gain_channel_func_t)(uint8_t *p, int stride, int n, gain_engine_ch_t *c);
+
+#define DEFINE_GAIN_CHANNEL(bits, soft) \
+    static void gain_channel_##bits##_##soft(uint8_t *p, int stride, int n, gain_engine_ch_t *c) \
+    { \
+        gain_channel(p, stride, n, c, bits, soft); \
+    }
+
+DEFINE_GAIN_CHANNEL(16, false)
+DEFINE_GAIN_CHANNEL(16, true)
+DEFINE_GAIN_CHANNEL(24, false)
+DEFINE_GAIN_CHANNEL(24, true)
+DEFINE_GAIN_CHANNEL(32, false)
+DEFINE_GAIN_CHANNEL(32, true)
+
+static gain_channel_func_t gain_channel_func(int bits, bool soft)
+{
+    switch (bits) {
+        case 16:
+            return soft ? gain_channel_16_true : gain_channel_16_false;
+        case 24:
+            return soft ? gain_channel_24_true : gain_channel_24_false;
+        default:
+            return soft ? gain_channel_32_true : gain_channel_32_false;
+    }
+}
+
+static int check_format(int sample_rate, int channels, int bits)
+{
+    if (sample_rate <= 0 || channels < 1 || channels > GAIN_ENGINE_MAX_CH) {
+        return -1;
+    }
+    if (bits != 16 && bits != 24 && bits != 32) {
+        return -1;
+    }
+    return 0;
+}
+
+int gain_engine_init(gain_engine_t *eng, const gain_engine_cfg_t *cfg)
+{
+    if (eng == NULL || cfg == NULL || cfg->ramp_ms < 0
+        || check_format(cfg->sample_rate, cfg->channels, cfg->bits) != 0) {
+        return -1;
+    }
+    memset(eng, 0, sizeof(gain_engine_t));
+    eng->cfg = *cfg;
+    eng->ramp_len = cfg->sample_rate * cfg->ramp_ms / 1000;
+    for (int i = 0; i < GAIN_ENGINE_MAX_CH; i++) {
+        eng->ch[i].gain = eng->ch[i].target = eng->ch[i].pending = GAIN_ENGINE_UNITY;
+    }
+    return 0;
+}
+
+int gain_engine_set_format(gain_engine_t *eng, int sample_rate, int channels, int bits)
+{
+    if (eng == NULL || check_format(sample_rate, channels, bits) != 0) {
+        return -1;
+    }
+    eng->cfg.sample_rate = sample_rate;
+    eng->cfg.channels = channels;
+    eng->cfg.bits = bits;
+    eng->ramp_len = sample_rate * eng->cfg.ramp_ms / 1000;
+    return 0;
+}
+
+int gain_engine_set_db(gain_engine_t *eng, int ch, int db)
+{
+    if (eng == NULL || ch < -1 || ch >= GAIN_ENGINE_MAX_CH) {
+        return -1;
+    }
+    int32_t target = gain_engine_db_to_q27(db);
+    for (int i = 0; i < GAIN_ENGINE_MAX_CH; i++) {
+        if (ch == -1 || ch == i) {
+            eng->ch[i].pending = target;
+            eng->ch[i].db = db;
+        }
+    }
+    // Published after the targets, the processing side reads the sequence first
+    __asm__ __volatile__("" ::: "memory");
+    eng->pending_seq++;
+    return 0;
+}
+
+int gain_engine_get_db(gain_engine_t *eng, int ch)
+{
+    if (eng == NULL || ch < 0 || ch >= GAIN_ENGINE_MAX_CH) {
+        return 0;
+    }
+    return eng->ch[ch].db;
+}
+
+void gain_engine_settle(gain_engine_t *eng)
+{
+    if (eng == NULL) {
+        return;
+    }
+    eng->applied_seq = eng->pending_seq;
+    __asm__ __volatile__("" ::: "memory");
+    for (int i = 0; i < GAIN_ENGINE_MAX_CH; i++) {
+        eng->ch[i].gain = eng->ch[i].target = eng->ch[i].pending;
+        eng->ch[i].remain = 0;
+    }
+}
+
+static void gain_engine_apply_pending(gain_engine_t *eng)
+{
+    uint32_t seq = eng->pending_seq;
+    if (seq == eng->applied_seq) {
+        return;
+    }
+    eng->applied_seq = seq;
+    __asm__ __volatile__("" ::: "memory");
+    for (int i = 0; i < GAIN_ENGINE_MAX_CH; i++) {
+        gain_engine_ch_t *c = &eng->ch[i];
+        int32_t target = c->pending;
+        if (target == c->target) {
+            continue;
+        }
+        c->target = target;
+        if (eng->ramp_len <= 0) {
+            c->gain = target;
+            c->remain = 0;
+        } else {
+            // Linear ramp from wherever the previous one got to
+            c->step = (target - c->gain) / eng->ramp_len;
+            c->remain = eng->ramp_len;
+        }
+    }
+}
+
+int gain_engine_process(gain_engine_t *eng, void *buf, int bytes)
+{
+    if (eng == NULL || buf == NULL || bytes < 0) {
+        return -1;
+    }
+    gain_engine_apply_pending(eng);
+    int channels = eng->cfg.channels;
+    int sample_bytes = eng->cfg.bits >> 3;
+    int frames = bytes / (channels * sample_bytes);
+    if (frames == 0) {
+        return 0;
+    }
+    gain_channel_func_t func = gain_channel_func(eng->cfg.bits, eng->cfg.clip == GAIN_ENGINE_CLIP_SOFT);
+    bool shared = true;
+    for (int i = 0; i < channels; i++) {
+        if (eng->ch[i].remain || eng->ch[i].gain != eng->ch[0].gain) {
+            shared = false;
+            break;
+        }
+    }
+    if (shared) {
+        // Same steady gain everywhere, one contiguous sweep instead of one strided sweep per channel
+        func((uint8_t *)buf, sample_bytes, frames * channels, &eng->ch[0]);
+        return 0;
+    }
+    for (int i = 0; i < channels; i++) {
+        func((uint8_t *)buf + i * sample_bytes, channels * sample_bytes, frames, &eng->ch[i]);
+    }
+    return 0;
+}
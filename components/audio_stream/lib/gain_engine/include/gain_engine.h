@@ -0,0 +1,147 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _GAIN_ENGINE_H_
+#define _GAIN_ENGINE_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GAIN_ENGINE_MAX_CH      (8)
+#define GAIN_ENGINE_DB_MIN      (-96)       /*!< Gains at or below this level mute the channel */
+#define GAIN_ENGINE_DB_MAX      (24)
+#define GAIN_ENGINE_Q           (27)        /*!< Linear gains are Q4.27, up to +24 dB fits in 32 bits */
+#define GAIN_ENGINE_UNITY       (1 << GAIN_ENGINE_Q)
+#define GAIN_ENGINE_RAMP_MS     (20)
+
+/**
+ * @brief Limiting at 0 dBFS
+ */
+typedef enum {
+    GAIN_ENGINE_CLIP_HARD = 0,  /*!< Saturate at full scale */
+    GAIN_ENGINE_CLIP_SOFT,      /*!< Compress samples above -2.5 dBFS smoothly towards full scale */
+} gain_engine_clip_t;
+
+/**
+ * @brief Gain engine configuration
+ */
+typedef struct {
+    int                 sample_rate;    /*!< Sample rate, used to size the ramps */
+    int                 channels;       /*!< Interleaved channels (1 - GAIN_ENGINE_MAX_CH) */
+    int                 bits;           /*!< Bits per sample (16, 24 packed in 3 bytes, 32) */
+    int                 ramp_ms;        /*!< Time to reach a new gain, 0 to switch at once */
+    gain_engine_clip_t  clip;           /*!< Limiting at 0 dBFS */
+} gain_engine_cfg_t;
+
+#define GAIN_ENGINE_CFG_DEFAULT() {     \
+    .sample_rate = 44100,               \
+    .channels = 2,                      \
+    .bits = 16,                         \
+    .ramp_ms = GAIN_ENGINE_RAMP_MS,     \
+    .clip = GAIN_ENGINE_CLIP_HARD,      \
+}
+
+/**
+ * @brief Gain state of one channel
+ */
+typedef struct {
+    int32_t gain;               /*!< Gain applied to the next sample, Q4.27 */
+    int32_t target;             /*!< Gain at the end of the ramp */
+    int32_t step;               /*!< Gain change per sample while ramping */
+    int32_t remain;             /*!< Samples left in the ramp */
+    volatile int32_t pending;   /*!< Target set by gain_engine_set_db, picked up by the next process call */
+    int     db;                 /*!< Last gain set in dB */
+} gain_engine_ch_t;
+
+/**
+ * @brief Gain engine, owned by the caller
+ */
+typedef struct {
+    gain_engine_cfg_t   cfg;
+    int                 ramp_len;               /*!< Ramp length in samples */
+    volatile uint32_t   pending_seq;            /*!< Bumped on every gain change */
+    uint32_t            applied_seq;
+    gain_engine_ch_t    ch[GAIN_ENGINE_MAX_CH];
+} gain_engine_t;
+
+/**
+ * @brief         Convert a gain in dB to a Q4.27 linear gain
+ * @param         db: Gain in dB, clamped to GAIN_ENGINE_DB_MAX, at or below GAIN_ENGINE_DB_MIN it is muted
+ * @return        Linear gain
+ */
+int32_t gain_engine_db_to_q27(int db);
+
+/**
+ * @brief         Initialize the engine, all channels start at 0 dB
+ * @return        0: On success
+ *                -1: Input parameter wrong
+ */
+int gain_engine_init(gain_engine_t *eng, const gain_engine_cfg_t *cfg);
+
+/**
+ * @brief         Change the sample format, the gains and ramps in progress are kept
+ * @return        0: On success
+ *                -1: Input parameter wrong
+ */
+int gain_engine_set_format(gain_engine_t *eng, int sample_rate, int channels, int bits);
+
+/**
+ * @brief         Set the gain of one channel or all of them
+ *                Safe to call from another task than the one processing, the ramp starts with the next block
+ * @param         eng: Gain engine
+ * @param         ch: Channel index, -1 for all channels
+ * @param         db: Gain in dB
+ * @return        0: On success
+ *                -1: Input parameter wrong
+ */
+int gain_engine_set_db(gain_engine_t *eng, int ch, int db);
+
+/**
+ * @brief         Jump every channel to its last set gain, dropping the ramps in progress
+ *                Used before the first block so the initial gain does not fade in
+ */
+void gain_engine_settle(gain_engine_t *eng);
+
+/**
+ * @brief         Get the last gain set of a channel in dB
+ */
+int gain_engine_get_db(gain_engine_t *eng, int ch);
+
+/**
+ * @brief         Apply the gains in place
+ * @param         eng: Gain engine
+ * @param         buf: Interleaved samples
+ * @param         bytes: Buffer size, trailing partial frames are left untouched
+ * @return        0: On success
+ *                -1: Input parameter wrong
+ */
+int gain_engine_process(gain_engine_t *eng, void *buf, int bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
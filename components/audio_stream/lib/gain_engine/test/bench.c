@@ -0,0 +1,101 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include "gain_engine.h"
+
+#define BENCH_RATE      (44100)
+#define BENCH_BLOCK     (2048)      // I2S_STREAM_BUF_SIZE
+#define BENCH_SECONDS   (10)
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// Straightforward per sample float gain with clamping, as a baseline for the fixed point kernels
+static __attribute__((noipa)) void float_gain16(int16_t *buf, int samples, float gain)
+{
+    for (int i = 0; i < samples; i++) {
+        float v = buf[i] * gain;
+        buf[i] = v > 32767 ? 32767 : (v < -32768 ? -32768 : (int16_t)v);
+    }
+}
+
+static void bench(const char *name, int bits, int channels, gain_engine_clip_t clip, bool ramping)
+{
+    static uint8_t buf[BENCH_BLOCK];
+    gain_engine_cfg_t cfg = GAIN_ENGINE_CFG_DEFAULT();
+    cfg.bits = bits;
+    cfg.channels = channels;
+    cfg.clip = clip;
+    gain_engine_t eng;
+    gain_engine_init(&eng, &cfg);
+    for (int i = 0; i < BENCH_BLOCK; i++) {
+        buf[i] = rand();
+    }
+    int bytes = BENCH_BLOCK - BENCH_BLOCK % (channels * (bits >> 3));
+    int samples = bytes / (bits >> 3);
+    int blocks = BENCH_RATE * channels * BENCH_SECONDS / samples;
+    double start = now_us();
+    for (int i = 0; i < blocks; i++) {
+        if (ramping || i == 0) {
+            // Keep a ramp running all the time for the worst case
+            gain_engine_set_db(&eng, -1, (i & 1) ? -6 : -12);
+        }
+        gain_engine_process(&eng, buf, bytes);
+    }
+    double cost = now_us() - start;
+    printf("%-30s %7.2f ns/sample  %7.1f us per second of audio\n", name, cost * 1000 / ((double)blocks * samples),
+           cost / BENCH_SECONDS);
+}
+
+int main(int argc, char **argv)
+{
+    static int16_t buf[BENCH_BLOCK / 2];
+    for (int i = 0; i < BENCH_BLOCK / 2; i++) {
+        buf[i] = rand();
+    }
+    int blocks = BENCH_RATE * 2 * BENCH_SECONDS / (BENCH_BLOCK / 2);
+    double start = now_us();
+    for (int i = 0; i < blocks; i++) {
+        float_gain16(buf, BENCH_BLOCK / 2, 0.5f);
+    }
+    double cost = now_us() - start;
+    printf("%-30s %7.2f ns/sample  %7.1f us per second of audio\n", "float baseline 16bit stereo",
+           cost * 1000 / ((double)blocks * BENCH_BLOCK / 2), cost / BENCH_SECONDS);
+    bench("16bit stereo steady", 16, 2, GAIN_ENGINE_CLIP_HARD, false);
+    bench("16bit stereo ramping", 16, 2, GAIN_ENGINE_CLIP_HARD, true);
+    bench("16bit stereo steady soft clip", 16, 2, GAIN_ENGINE_CLIP_SOFT, false);
+    bench("24bit stereo steady", 24, 2, GAIN_ENGINE_CLIP_HARD, false);
+    bench("32bit stereo steady", 32, 2, GAIN_ENGINE_CLIP_HARD, false);
+    bench("32bit stereo ramping", 32, 2, GAIN_ENGINE_CLIP_HARD, true);
+    return 0;
+}
@@ -0,0 +1,4 @@
+#!/usr/bin/perl
+# Host accuracy test and benchmark of the gain engine
+`gcc ../gain_engine.c test.c -I../include -g -O2 -Wall -o ./test -lm`;
+`gcc ../gain_engine.c bench.c -I../include -O2 -Wall -o ./bench -lm`;
@@ -0,0 +1,230 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gain_engine.h"
+
+#define TEST_FRAMES     (1024)
+
+#define TEST_ASSERT(cond, ...) if (!(cond)) {   \
+        printf("FAIL line %d: ", __LINE__);     \
+        printf(__VA_ARGS__);                    \
+        printf("\n");                           \
+        return -1;                              \
+    }
+
+static int32_t load(const uint8_t *p, int bits)
+{
+    if (bits == 16) {
+        return (int16_t)(p[0] | (p[1] << 8));
+    } else if (bits == 24) {
+        return (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 24) >> 8;
+    }
+    return (int32_t)((uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+}
+
+static int test_table(void)
+{
+    for (int db = GAIN_ENGINE_DB_MIN + 1; db <= GAIN_ENGINE_DB_MAX; db++) {
+        double got = 20 * log10((double)gain_engine_db_to_q27(db) / GAIN_ENGINE_UNITY);
+        TEST_ASSERT(fabs(got - db) < 0.005, "db %d -> %.4f", db, got);
+    }
+    TEST_ASSERT(gain_engine_db_to_q27(0) == GAIN_ENGINE_UNITY, "unity");
+    TEST_ASSERT(gain_engine_db_to_q27(GAIN_ENGINE_DB_MIN) == 0, "mute");
+    TEST_ASSERT(gain_engine_db_to_q27(100) == gain_engine_db_to_q27(GAIN_ENGINE_DB_MAX), "clamp");
+    return 0;
+}
+
+// Steady gains against a double reference, within one LSB for every width and channel count
+static int test_steady(int bits, int channels)
+{
+    static uint8_t buf[TEST_FRAMES * GAIN_ENGINE_MAX_CH * 4], ref[sizeof(buf)];
+    gain_engine_cfg_t cfg = GAIN_ENGINE_CFG_DEFAULT();
+    cfg.bits = bits;
+    cfg.channels = channels;
+    cfg.ramp_ms = 0;
+    gain_engine_t eng;
+    TEST_ASSERT(gain_engine_init(&eng, &cfg) == 0, "init");
+    int db[GAIN_ENGINE_MAX_CH];
+    for (int c = 0; c < channels; c++) {
+        db[c] = rand() % 60 - 48;
+        gain_engine_set_db(&eng, c, db[c]);
+    }
+    int bytes = TEST_FRAMES * channels * (bits >> 3);
+    for (int i = 0; i < bytes; i++) {
+        buf[i] = rand();
+    }
+    memcpy(ref, buf, bytes);
+    TEST_ASSERT(gain_engine_process(&eng, buf, bytes) == 0, "process");
+    double fs = ldexp(1, bits - 1);
+    for (int i = 0; i < TEST_FRAMES * channels; i++) {
+        int c = i % channels;
+        double want = load(ref + i * (bits >> 3), bits) * pow(10, db[c] / 20.0);
+        if (want > fs - 1) {
+            want = fs - 1;
+        } else if (want < -fs) {
+            want = -fs;
+        }
+        double got = load(buf + i * (bits >> 3), bits);
+        TEST_ASSERT(fabs(got - want) <= 1 + fabs(want) * 1e-4, "bits %d ch %d sample %d: %.1f vs %.1f (db %d)",
+                    bits, channels, i, got, want, db[c]);
+    }
+    return 0;
+}
+
+// A gain change must move smoothly, no per sample jump beyond the ramp slope, and settle on the target
+static int test_ramp(void)
+{
+    int16_t buf[2 * 4096];
+    gain_engine_cfg_t cfg = GAIN_ENGINE_CFG_DEFAULT();
+    cfg.sample_rate = 48000;
+    cfg.ramp_ms = 10;
+    gain_engine_t eng;
+    gain_engine_init(&eng, &cfg);
+    gain_engine_set_db(&eng, 0, -40);
+    gain_engine_set_db(&eng, 1, 6);
+    for (int i = 0; i < 4096; i++) {
+        buf[i * 2] = 16000;
+        buf[i * 2 + 1] = 8000;
+    }
+    // Odd block sizes so ramps cross block boundaries
+    int pos = 0, blocks[] = { 7, 100, 333, 1, 2000, 1655 };
+    for (int b = 0; b < sizeof(blocks) / sizeof(blocks[0]); b++) {
+        gain_engine_process(&eng, buf + pos * 2, blocks[b] * 4);
+        pos += blocks[b];
+    }
+    int ramp = 480;
+    double l_step = 16000 * (1 - pow(10, -2)) / ramp, r_step = 8000 * (pow(10, 0.3) - 1) / ramp;
+    for (int i = 1; i < 4096; i++) {
+        TEST_ASSERT(buf[i * 2] <= buf[(i - 1) * 2], "left not falling at %d", i);
+        TEST_ASSERT(buf[i * 2 + 1] >= buf[(i - 1) * 2 + 1], "right not rising at %d", i);
+        TEST_ASSERT(buf[(i - 1) * 2] - buf[i * 2] <= l_step + 2, "left jump at %d", i);
+        TEST_ASSERT(buf[i * 2 + 1] - buf[(i - 1) * 2 + 1] <= r_step + 2, "right jump at %d", i);
+    }
+    TEST_ASSERT(abs(buf[ramp * 2] - 160) <= 1 && abs(buf[4095 * 2] - 160) <= 1, "left target %d", buf[4095 * 2]);
+    TEST_ASSERT(abs(buf[4095 * 2 + 1] - 15962) <= 1, "right target %d", buf[4095 * 2 + 1]);
+    TEST_ASSERT(gain_engine_get_db(&eng, 0) == -40 && gain_engine_get_db(&eng, 1) == 6, "get db");
+
+    // Settled gains apply from the first sample
+    gain_engine_set_db(&eng, -1, -20);
+    gain_engine_settle(&eng);
+    int16_t one[2] = { 16000, 16000 };
+    gain_engine_process(&eng, one, sizeof(one));
+    TEST_ASSERT(one[0] == 1600 && one[1] == 1600, "settle %d %d", one[0], one[1]);
+
+    // Retarget in the middle of a ramp, it continues from where it got to
+    gain_engine_set_db(&eng, 0, -40);
+    gain_engine_set_db(&eng, 1, 6);
+    gain_engine_settle(&eng);
+    gain_engine_set_db(&eng, -1, 0);
+    int16_t s[2 * 240];
+    for (int i = 0; i < 240; i++) {
+        s[i * 2] = s[i * 2 + 1] = 16000;
+    }
+    gain_engine_process(&eng, s, sizeof(s));
+    int16_t mid = s[239 * 2];
+    gain_engine_set_db(&eng, -1, -20);
+    s[0] = s[1] = 16000;
+    gain_engine_process(&eng, s, 4);
+    TEST_ASSERT(abs(s[0] - mid) < 40, "retarget jump %d -> %d", mid, s[0]);
+    return 0;
+}
+
+static int test_clip(void)
+{
+    for (int bits = 16; bits <= 32; bits += 8) {
+        uint8_t buf[4 * 512];
+        gain_engine_cfg_t cfg = GAIN_ENGINE_CFG_DEFAULT();
+        cfg.bits = bits;
+        cfg.channels = 1;
+        cfg.ramp_ms = 0;
+        cfg.clip = GAIN_ENGINE_CLIP_SOFT;
+        gain_engine_t eng;
+        gain_engine_init(&eng, &cfg);
+        gain_engine_set_db(&eng, -1, 24);
+        int64_t fs = ((int64_t)1 << (bits - 1)) - 1;
+        int sb = bits >> 3;
+        // Ramp of inputs from 0 to full scale, the output must stay monotonic and inside full scale
+        for (int i = 0; i < 512; i++) {
+            int32_t v = (int32_t)(fs * i / 511) * (i & 1 ? -1 : 1);
+            memcpy(buf + i * sb, (uint8_t *)&v, sb);
+        }
+        gain_engine_process(&eng, buf, 512 * sb);
+        int64_t last = 0;
+        for (int i = 0; i < 512; i++) {
+            int64_t a = llabs(load(buf + i * sb, bits));
+            TEST_ASSERT(a <= fs, "bits %d over full scale at %d", bits, i);
+            TEST_ASSERT(a >= last, "bits %d soft clip not monotonic at %d", bits, i);
+            last = a;
+        }
+        TEST_ASSERT(last > fs * 99 / 100, "bits %d does not approach full scale", bits);
+        // Below the knee it is a plain gain
+        gain_engine_set_db(&eng, -1, 0);
+        int32_t v = (int32_t)(fs / 2);
+        memcpy(buf, (uint8_t *)&v, sb);
+        gain_engine_process(&eng, buf, sb);
+        TEST_ASSERT(load(buf, bits) == fs / 2, "bits %d soft clip below knee", bits);
+    }
+    return 0;
+}
+
+static int test_args(void)
+{
+    gain_engine_t eng;
+    gain_engine_cfg_t cfg = GAIN_ENGINE_CFG_DEFAULT();
+    TEST_ASSERT(gain_engine_init(NULL, &cfg) == -1, "null");
+    cfg.bits = 8;
+    TEST_ASSERT(gain_engine_init(&eng, &cfg) == -1, "bits");
+    cfg.bits = 16;
+    cfg.channels = GAIN_ENGINE_MAX_CH + 1;
+    TEST_ASSERT(gain_engine_init(&eng, &cfg) == -1, "channels");
+    cfg.channels = 2;
+    TEST_ASSERT(gain_engine_init(&eng, &cfg) == 0, "init");
+    TEST_ASSERT(gain_engine_set_db(&eng, GAIN_ENGINE_MAX_CH, 0) == -1, "set ch");
+    TEST_ASSERT(gain_engine_set_format(&eng, 0, 2, 16) == -1, "format");
+    TEST_ASSERT(gain_engine_process(&eng, NULL, 4) == -1, "process");
+    // Partial frames are left as they are
+    int16_t s[3] = { 1000, 1000, 1000 };
+    gain_engine_set_db(&eng, -1, GAIN_ENGINE_DB_MIN);
+    gain_engine_process(&eng, s, 6);
+    TEST_ASSERT(s[2] == 1000, "partial frame touched");
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    srand(argc > 1 ? atoi(argv[1]) : 1);
+    if (test_table() || test_ramp() || test_clip() || test_args()) {
+        return 1;
+    }
+    for (int round = 0; round < 300; round++) {
+        if (test_steady(16 + (rand() % 3) * 8, rand() % GAIN_ENGINE_MAX_CH + 1)) {
+            return 1;
+        }
+    }
+    printf("gain_engine: all tests passed\n");
+    return 0;
+}
@@ -21,6 +21,7 @@
  * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  *
  */
+
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -29,120 +30,243 @@
 #include "gzip_miniz.h"
 #include "miniz_inflate.h"
 
-#define TAG              "GZIP_MINIZ"
-#define GZIP_HEADER_SIZE (10)
+#define TAG                     "GZIP_MINIZ"
+#define GZIP_HEADER_SIZE        (10)
+#define ZLIB_HEADER_SIZE        (2)
+#define GZIP_FLAG_FHCRC         (0x02)
+#define GZIP_FLAG_FEXTRA        (0x04)
+#define GZIP_FLAG_FNAME         (0x08)
+#define GZIP_FLAG_FCOMMENT      (0x10)
+#define GZIP_MIN_WINDOW_BITS    (8)
+#define GZIP_MAX_WINDOW_BITS    (15)
+#define GZIP_DEFAULT_CHUNK_SIZE (32)
+
+typedef enum {
+    GZIP_HEAD_MAGIC,       // Fixed part of the gzip header or the 2 bytes zlib header
+    GZIP_HEAD_EXTRA_LEN,
+    GZIP_HEAD_EXTRA,
+    GZIP_HEAD_NAME,
+    GZIP_HEAD_COMMENT,
+    GZIP_HEAD_CRC,
+    GZIP_HEAD_DONE,
+} gzip_head_state_t;
 
 typedef struct {
-    gzip_miniz_cfg_t cfg;
-    uint8_t         *chunk_ptr;
-    int              chunk_filled;
-    int              chunk_consumed;
-    bool             unzip_error;
-    bool             first_data;
-    bool             final_data;
-    int              head_flag;
-    int              extra_len;
-    int              head_filled;
-    mz_stream        s;
+    gzip_miniz_cfg_t   cfg;
+    uint8_t           *chunk_ptr;      // Receive buffer filled by read_cb, inflated in place
+    int                chunk_filled;
+    int                chunk_consumed;
+    uint8_t           *window;         // LZ77 window ring, decoded data is handed out from here
+    int                window_size;
+    int                window_ofs;     // Start of the decoded data not handed out yet
+    int                window_avail;   // Size of the decoded data not handed out yet
+    int                error;          // Sticky error code returned by the read APIs
+    bool               final_data;
+    bool               input_end;
+    gzip_head_state_t  head_state;
+    uint8_t            head[GZIP_HEADER_SIZE];
+    int                head_filled;
+    int                head_flag;
+    int                extra_len;
+    mz_uint32          inflate_flags;
+    tinfl_decompressor decomp;
 } gzip_miniz_t;
 
-static bool verify_gzip_header(gzip_miniz_t *zip, uint8_t *data, int size)
+static gzip_head_state_t gzip_miniz_next_field(gzip_miniz_t *zip, gzip_head_state_t state)
+{
+    // Optional fields follow the fixed header in this order
+    static const struct {
+        gzip_head_state_t state;
+        int               flag;
+    } fields[] = {
+        { GZIP_HEAD_EXTRA_LEN, GZIP_FLAG_FEXTRA },
+        { GZIP_HEAD_NAME, GZIP_FLAG_FNAME },
+        { GZIP_HEAD_COMMENT, GZIP_FLAG_FCOMMENT },
+        { GZIP_HEAD_CRC, GZIP_FLAG_FHCRC },
+    };
+    for (int i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        if (fields[i].state > state && (zip->head_flag & fields[i].flag)) {
+            return fields[i].state;
+        }
+    }
+    return GZIP_HEAD_DONE;
+}
+
+static int gzip_miniz_alloc_window(gzip_miniz_t *zip, int window_bits)
 {
-    if (size < GZIP_HEADER_SIZE) {
-        return false;
+    if (window_bits < GZIP_MIN_WINDOW_BITS || window_bits > GZIP_MAX_WINDOW_BITS) {
+        ESP_LOGE(TAG, "Window bits %d not supported", window_bits);
+        return -1;
     }
-    if (data[0] != 0x1F || data[1] != 0x8B || data[2] != 0x8) {
-        return false;
+    zip->window_size = 1 << window_bits;
+    zip->window = (uint8_t *) malloc(zip->window_size);
+    if (zip->window == NULL) {
+        ESP_LOGE(TAG, "No memory for window %d", zip->window_size);
+        return -1;
     }
-    zip->head_flag = data[3];
-    return true;
+    tinfl_init(&zip->decomp);
+    return 0;
 }
 
-static int gzip_miniz_skip_head(gzip_miniz_t *zip, uint8_t *data, int size)
+static int gzip_miniz_start_gzip(gzip_miniz_t *zip)
 {
-    if (zip->head_flag == 0) {
-        return 0;
+    uint8_t *head = zip->head;
+    if (head[1] != 0x8B || head[2] != 0x8) {
+        ESP_LOGE(TAG, "Wrong data not match gzip header");
+        return -1;
     }
-    int org_size = size;
-    if (zip->head_flag & 4) {
-        // 2 bytes extra len
-        if (zip->head_filled > 2) {
-            return -1;
-        }
-        if (zip->head_filled + size >= 2) {
-            int used = 2 - zip->head_filled;
-            if (used) {
-                size -= used;
-                while (used--) {
-                    zip->extra_len = zip->extra_len + (*data << (zip->head_filled * 8));
-                    zip->head_filled++;
-                    data++;
+    // Gzip header does not carry the window size, use the configured one
+    if (gzip_miniz_alloc_window(zip, zip->cfg.window_bits ? zip->cfg.window_bits : GZIP_MAX_WINDOW_BITS) != 0) {
+        return -1;
+    }
+    zip->head_flag = head[3];
+    zip->head_filled = 0;
+    zip->inflate_flags = TINFL_FLAG_HAS_MORE_INPUT;
+    zip->head_state = gzip_miniz_next_field(zip, GZIP_HEAD_MAGIC);
+    return 0;
+}
+
+static int gzip_miniz_start_zlib(gzip_miniz_t *zip)
+{
+    uint8_t cmf = zip->head[0];
+    uint8_t flg = zip->head[1];
+    if ((cmf & 0xF) != 8 || ((cmf << 8) | flg) % 31 || (flg & 0x20)) {
+        ESP_LOGE(TAG, "Wrong data not match gzip or zlib header");
+        return -1;
+    }
+    // Zlib header declares the window size in CINFO
+    if (gzip_miniz_alloc_window(zip, (cmf >> 4) + 8) != 0) {
+        return -1;
+    }
+    // Let miniz verify the header and the adler32 trailer
+    zip->inflate_flags = TINFL_FLAG_HAS_MORE_INPUT | TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_COMPUTE_ADLER32;
+    size_t in_size = ZLIB_HEADER_SIZE;
+    size_t out_size = zip->window_size;
+    tinfl_status status = tinfl_decompress(&zip->decomp, zip->head, &in_size, zip->window, zip->window,
+                                           &out_size, zip->inflate_flags);
+    if (status < 0) {
+        ESP_LOGE(TAG, "Zlib header rejected status %d", status);
+        return -1;
+    }
+    zip->head_state = GZIP_HEAD_DONE;
+    return 0;
+}
+
+static int gzip_miniz_parse_head(gzip_miniz_t *zip, const uint8_t *data, int size)
+{
+    int used = 0;
+    while (used < size && zip->head_state != GZIP_HEAD_DONE) {
+        switch (zip->head_state) {
+            case GZIP_HEAD_MAGIC:
+                zip->head[zip->head_filled++] = data[used++];
+                if (zip->head[0] != 0x1F) {
+                    if (zip->head_filled == ZLIB_HEADER_SIZE && gzip_miniz_start_zlib(zip) != 0) {
+                        return -1;
+                    }
+                } else if (zip->head_filled == GZIP_HEADER_SIZE && gzip_miniz_start_gzip(zip) != 0) {
+                    return -1;
                 }
+                break;
+            case GZIP_HEAD_EXTRA_LEN:
+                // 2 bytes extra length in little endian
+                zip->extra_len |= data[used++] << (zip->head_filled * 8);
+                if (++zip->head_filled == 2) {
+                    zip->head_filled = 0;
+                    zip->head_state = zip->extra_len ? GZIP_HEAD_EXTRA : gzip_miniz_next_field(zip, GZIP_HEAD_EXTRA);
+                }
+                break;
+            case GZIP_HEAD_EXTRA: {
+                int skip = size - used;
+                if (skip > zip->extra_len) {
+                    skip = zip->extra_len;
+                }
+                used += skip;
+                zip->extra_len -= skip;
+                if (zip->extra_len == 0) {
+                    zip->head_state = gzip_miniz_next_field(zip, GZIP_HEAD_EXTRA);
+                }
+                break;
             }
-            if (size >= zip->extra_len) {
-                size -= zip->extra_len;
-                data += zip->extra_len;
-                zip->extra_len = 0;
-                zip->head_flag &= ~4;
-                zip->head_filled = 0;
-            } else {
-                zip->extra_len -= size;
-                return org_size;
-            }
-        } else {
-            for (int i = 0; i < size; i++) {
-                zip->extra_len = zip->extra_len + (*data << (zip->head_filled * 8));
-                zip->head_filled++;
-                data++;
-            }
-            zip->head_filled += size;
-            return org_size;
+            case GZIP_HEAD_NAME:
+            case GZIP_HEAD_COMMENT:
+                // Zero terminated string
+                if (data[used++] == '\0') {
+                    zip->head_state = gzip_miniz_next_field(zip, zip->head_state);
+                }
+                break;
+            case GZIP_HEAD_CRC:
+                used++;
+                if (++zip->head_filled == 2) {
+                    zip->head_state = GZIP_HEAD_DONE;
+                }
+                break;
+            default:
+                return -1;
         }
     }
-    if (zip->head_flag & 8) {
-        // name
-        while (size) {
-            size--;
-            data++;
-            if (*(data - 1) == '\0') {
-                zip->head_flag &= ~8;
-                break;
-            }
+    return used;
+}
+
+static int gzip_miniz_fill(gzip_miniz_t *zip)
+{
+    int size = zip->cfg.read_cb(zip->chunk_ptr, zip->cfg.chunk_size, zip->cfg.ctx);
+    if (size < 0) {
+        ESP_LOGE(TAG, "Fail to read data");
+        return -1;
+    }
+    zip->chunk_filled = size;
+    zip->chunk_consumed = 0;
+    if (size == 0) {
+        zip->input_end = true;
+    }
+    return size;
+}
+
+static int gzip_miniz_decode(gzip_miniz_t *zip)
+{
+    while (zip->window_avail == 0) {
+        if (zip->error) {
+            return zip->error;
         }
-        if (size == 0) {
-            return org_size;
+        if (zip->final_data) {
+            return 0;
         }
-    }
-    if (zip->head_flag & 0x10) {
-        // comment
-        while (size) {
-            size--;
-            data++;
-            if (*(data - 1) == '\0') {
-                zip->head_flag &= ~0x10;
-                break;
+        if (zip->chunk_consumed == zip->chunk_filled) {
+            if (zip->input_end) {
+                ESP_LOGW(TAG, "Data ended before the end of the deflate stream");
+                zip->final_data = true;
+                return 0;
             }
+            if (gzip_miniz_fill(zip) < 0) {
+                zip->error = -1;
+            }
+            continue;
         }
-        if (size == 0) {
-            return org_size;
-        }
-    }
-    if (zip->head_flag & 0x2) {
-        // CRC16
-        if (zip->head_filled > 2) {
-            return -1;
+        const uint8_t *in = zip->chunk_ptr + zip->chunk_consumed;
+        size_t in_size = zip->chunk_filled - zip->chunk_consumed;
+        if (zip->head_state != GZIP_HEAD_DONE) {
+            int used = gzip_miniz_parse_head(zip, in, in_size);
+            if (used < 0) {
+                zip->error = -1;
+                continue;
+            }
+            zip->chunk_consumed += used;
+            continue;
         }
-        if (zip->head_filled + size >= 2) {
-            int used = 2 - zip->head_filled;
-            size -= used;
-            data += used;
-            zip->head_flag &= ~0x2;
-        } else {
-            zip->head_filled += size;
-            return org_size;
+        // Inflate straight from the receive buffer into the free part of the window ring
+        size_t out_size = zip->window_size - zip->window_ofs;
+        tinfl_status status = tinfl_decompress(&zip->decomp, in, &in_size, zip->window, zip->window + zip->window_ofs,
+                                               &out_size, zip->inflate_flags);
+        zip->chunk_consumed += in_size;
+        zip->window_avail = out_size;
+        if (status < 0) {
+            ESP_LOGE(TAG, "Fail to inflate status %d", status);
+            zip->error = -2;
+        } else if (status == TINFL_STATUS_DONE) {
+            zip->final_data = true;
         }
     }
-    return org_size - size;
+    return zip->window_avail;
 }
 
 gzip_miniz_handle_t gzip_miniz_init(gzip_miniz_cfg_t *cfg)
@@ -151,13 +275,17 @@ gzip_miniz_handle_t gzip_miniz_init(gzip_miniz_cfg_t *cfg)
         ESP_LOGE(TAG, "Read callback must be provided");
         return NULL;
     }
+    if (cfg->window_bits && (cfg->window_bits < GZIP_MIN_WINDOW_BITS || cfg->window_bits > GZIP_MAX_WINDOW_BITS)) {
+        ESP_LOGE(TAG, "Window bits must be in [%d, %d]", GZIP_MIN_WINDOW_BITS, GZIP_MAX_WINDOW_BITS);
+        return NULL;
+    }
     gzip_miniz_t *zip = (gzip_miniz_t *) calloc(1, sizeof(gzip_miniz_t));
     if (zip == NULL) {
         ESP_LOGE(TAG, "No memory for instance");
         return NULL;
     }
     zip->cfg = *cfg;
-    int chunk_size = cfg->chunk_size ? cfg->chunk_size : 32;
+    int chunk_size = cfg->chunk_size ? cfg->chunk_size : GZIP_DEFAULT_CHUNK_SIZE;
     zip->chunk_ptr = (uint8_t *) malloc(chunk_size);
     if (zip->chunk_ptr == NULL) {
         free(zip);
@@ -165,115 +293,67 @@ gzip_miniz_handle_t gzip_miniz_init(gzip_miniz_cfg_t *cfg)
         return NULL;
     }
     zip->cfg.chunk_size = chunk_size;
-    zip->first_data = true;
-    mz_inflateInit2(&zip->s, -MZ_DEFAULT_WINDOW_BITS);
+    zip->head_state = GZIP_HEAD_MAGIC;
     return (gzip_miniz_handle_t)zip;
 }
 
-int gzip_miniz_read(gzip_miniz_handle_t h, uint8_t *out, int out_size)
+int gzip_miniz_acquire_read(gzip_miniz_handle_t h, const uint8_t **data, int wanted_size)
 {
     gzip_miniz_t *zip = (gzip_miniz_t *) h;
-    if (zip == NULL) {
+    if (zip == NULL || data == NULL) {
         return -1;
     }
-    if (zip->unzip_error) {
-        return -2;
-    }
-    if (zip->final_data) {
-        return 0;
-    }
-    int size = 0;
-    if (zip->first_data == true) {
-        zip->first_data = false;
-        int size = zip->cfg.read_cb(zip->chunk_ptr, zip->cfg.chunk_size, zip->cfg.ctx);
-        if (size < 0) {
-            zip->unzip_error = true;
-            return -1;
-        }
-        zip->chunk_filled = size;
-        if (verify_gzip_header(zip, zip->chunk_ptr, zip->chunk_filled) == false) {
-            zip->unzip_error = true;
-            ESP_LOGE(TAG, "Wrong data not match gzip header");
-            return -1;
-        }
-        zip->chunk_consumed = GZIP_HEADER_SIZE;
+    *data = NULL;
+    int avail = gzip_miniz_decode(zip);
+    if (avail <= 0) {
+        return avail;
     }
+    *data = zip->window + zip->window_ofs;
+    return avail < wanted_size ? avail : wanted_size;
+}
 
-    while (1) {
-        uint8_t *data = zip->chunk_ptr + zip->chunk_consumed;
-        size = zip->chunk_filled - zip->chunk_consumed;
-        if (size) {
-            int skip = gzip_miniz_skip_head(zip, data, size);
-            if (skip == 0) {
-                break;
-            }
-            zip->chunk_consumed += skip;
-            if (size > skip) {
-                break;
-            }
-        }
-        size = zip->cfg.read_cb(zip->chunk_ptr, zip->cfg.chunk_size, zip->cfg.ctx);
-        if (size < 0) {
-            zip->unzip_error = true;
-            ESP_LOGE(TAG, "Fail to read data");
-            return -1;
-        }
-        if (size == 0) {
-            zip->final_data = true;
-            return 0;
-        }
-        zip->chunk_filled = size;
-        zip->chunk_consumed = 0;
+int gzip_miniz_release_read(gzip_miniz_handle_t h, int size)
+{
+    gzip_miniz_t *zip = (gzip_miniz_t *) h;
+    if (zip == NULL || size < 0 || size > zip->window_avail) {
+        return -1;
     }
+    zip->window_avail -= size;
+    zip->window_ofs = (zip->window_ofs + size) & (zip->window_size - 1);
+    return 0;
+}
 
-    int org_size = out_size;
-    // set input buffer
-    mz_stream *s = &zip->s;
-    s->next_in = zip->chunk_ptr + zip->chunk_consumed;
-    s->avail_in = zip->chunk_filled - zip->chunk_consumed;
-    s->next_out = out;
-    s->avail_out = out_size;
-    while (1) {
-        int ret = mz_inflate(s, MZ_SYNC_FLUSH);
-        if (ret < 0) {
-            zip->unzip_error = true;
-            ESP_LOGE(TAG, "Fail to inflate ret %d", ret);
-            break;
-        }
-        int out_consume = out_size - s->avail_out;
-        out += out_consume;
-        out_size -= out_consume;
-        if (ret == MZ_STREAM_END) {
-            zip->final_data = true;
-            break;
-        }
-        if (s->avail_out == 0) {
-            // All output consumed
-            int org_size = zip->chunk_filled - zip->chunk_consumed;
-            zip->chunk_consumed += (org_size - s->avail_in);
-            break;
-        }
-        if (s->avail_in == 0) {
-            size = zip->cfg.read_cb(zip->chunk_ptr, zip->cfg.chunk_size, zip->cfg.ctx);
-            if (size < 0) {
-                zip->unzip_error = true;
-                ESP_LOGE(TAG, "Fail to read data");
-                return -1;
+int gzip_miniz_read(gzip_miniz_handle_t h, uint8_t *out, int out_size)
+{
+    gzip_miniz_t *zip = (gzip_miniz_t *) h;
+    if (zip == NULL) {
+        return -1;
+    }
+    int filled = 0;
+    while (filled < out_size) {
+        const uint8_t *data = NULL;
+        int size = gzip_miniz_acquire_read(h, &data, out_size - filled);
+        if (size <= 0) {
+            // Hand out what is decoded, the error sticks for the next call
+            if (filled == 0) {
+                return size;
             }
-            zip->chunk_filled = size;
-            zip->chunk_consumed = 0;
-            // Update pointer
-            s->next_in = zip->chunk_ptr;
-            s->avail_in = zip->chunk_filled - zip->chunk_consumed;
-            s->next_out = out;
-            s->avail_out = out_size;
-
-        } else {
-            // Impossible case
             break;
         }
+        memcpy(out + filled, data, size);
+        gzip_miniz_release_read(h, size);
+        filled += size;
+    }
+    return filled;
+}
+
+int gzip_miniz_get_window_size(gzip_miniz_handle_t h)
+{
+    gzip_miniz_t *zip = (gzip_miniz_t *) h;
+    if (zip == NULL) {
+        return -1;
     }
-    return org_size - out_size;
+    return zip->window_size;
 }
 
 int gzip_miniz_deinit(gzip_miniz_handle_t h)
@@ -282,7 +362,7 @@ int gzip_miniz_deinit(gzip_miniz_handle_t h)
     if (zip == NULL) {
         return -1;
     }
-    mz_inflateEnd(&zip->s);
+    free(zip->window);
     free(zip->chunk_ptr);
     free(zip);
     return 0;
@@ -35,6 +35,8 @@ typedef struct {
     int   (*read_cb)(uint8_t *data, int size, void *ctx); /*!< Read callback return size being read */
     int   chunk_size;                                    /*!< Chunk size default 32 if set to 0 */
     void  *ctx;                                          /*!< Read context */
+    int   window_bits;                                   /*!< Window bits (8~15) of gzip data, default 15 if set to 0
+                                                              Zlib data always use the window bits declared in its header */
 } gzip_miniz_cfg_t;
 
 /**
@@ -52,6 +54,7 @@ gzip_miniz_handle_t gzip_miniz_init(gzip_miniz_cfg_t *cfg);
 
 /**
  * @brief         Inflate and read data
+ * @param         zip: Handle for gzip
  * @param         out: Data to read after inflated
  * @param         out_size: Data size to read
  * @return        >= 0: Data size being read
@@ -60,6 +63,40 @@ gzip_miniz_handle_t gzip_miniz_init(gzip_miniz_cfg_t *cfg);
  */
 int gzip_miniz_read(gzip_miniz_handle_t zip, uint8_t *out, int out_size);
 
+/**
+ * @brief         Get inflated data without copy
+ *
+ *                The returned data points into the inflate window and stays valid until `gzip_miniz_release_read`
+ *                Call `gzip_miniz_release_read` with the consumed size before next acquire
+ *
+ * @param         zip: Handle for gzip
+ * @param         data: Pointer to the inflated data
+ * @param         wanted_size: Wanted size in bytes
+ * @return        > 0: Data size available at `data`
+ *                0: End of the stream
+ *                -1: Wrong input parameter or wrong data
+ *                -2: Inflate error by miniz
+ */
+int gzip_miniz_acquire_read(gzip_miniz_handle_t zip, const uint8_t **data, int wanted_size);
+
+/**
+ * @brief         Release the data consumed from `gzip_miniz_acquire_read`
+ * @param         zip: Handle for gzip
+ * @param         size: Consumed size in bytes
+ * @return        0: On success
+ *                -1: Input parameter wrong
+ */
+int gzip_miniz_release_read(gzip_miniz_handle_t zip, int size);
+
+/**
+ * @brief         Get the size of the inflate window
+ * @param         zip: Handle for gzip
+ * @return        > 0: Window size in bytes
+ *                0: Header not parsed yet
+ *                -1: Input parameter wrong
+ */
+int gzip_miniz_get_window_size(gzip_miniz_handle_t zip);
+
 /**
  * @brief         Deinitialize gzip using miniz
  * @param         zip: Handle for gzip
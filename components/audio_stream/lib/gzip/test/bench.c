@@ -0,0 +1,156 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "gzip_miniz.h"
+
+#define BENCH_CHUNK     (1024)      // Receive chunk of http_stream
+#define BENCH_OUT       (4096)      // HTTP_STREAM_BUFFER_SIZE
+#define BENCH_ROUNDS    (20)
+
+typedef struct {
+    const uint8_t *data;
+    int            size;
+    int            pos;
+} bench_src_t;
+
+static uint8_t sink[BENCH_OUT];
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static uint8_t *load_file(const char *name, int *size)
+{
+    char path[128];
+    snprintf(path, sizeof(path), "fixture/%s", name);
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return NULL;
+    }
+    fseek(fp, 0, SEEK_END);
+    *size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    uint8_t *data = malloc(*size);
+    if (fread(data, 1, *size, fp) != *size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(fp);
+    return data;
+}
+
+// Socket reads copy into the receive chunk on the chip too
+static int bench_read_cb(uint8_t *data, int size, void *ctx)
+{
+    bench_src_t *src = (bench_src_t *)ctx;
+    if (size > src->size - src->pos) {
+        size = src->size - src->pos;
+    }
+    memcpy(data, src->data + src->pos, size);
+    src->pos += size;
+    return size;
+}
+
+// The consumer copy stands for audio_element_output writing into the ringbuffer
+static __attribute__((noipa)) void consume(const uint8_t *data, int size)
+{
+    memcpy(sink, data, size);
+}
+
+static double bench_once(const uint8_t *gz, int gz_size, int window_bits, int zero_copy, int *window, long *total)
+{
+    static uint8_t out[BENCH_OUT];
+    bench_src_t src = { gz, gz_size, 0 };
+    gzip_miniz_cfg_t cfg = {
+        .read_cb = bench_read_cb,
+        .chunk_size = BENCH_CHUNK,
+        .ctx = &src,
+        .window_bits = window_bits,
+    };
+    double start = now_us();
+    gzip_miniz_handle_t zip = gzip_miniz_init(&cfg);
+    int n;
+    *total = 0;
+    do {
+        if (zero_copy) {
+            const uint8_t *data = NULL;
+            n = gzip_miniz_acquire_read(zip, &data, BENCH_OUT);
+            if (n > 0) {
+                consume(data, n);
+                gzip_miniz_release_read(zip, n);
+            }
+        } else {
+            n = gzip_miniz_read(zip, out, BENCH_OUT);
+            if (n > 0) {
+                consume(out, n);
+            }
+        }
+        *total += n > 0 ? n : 0;
+    } while (n > 0);
+    *window = gzip_miniz_get_window_size(zip);
+    gzip_miniz_deinit(zip);
+    return now_us() - start;
+}
+
+static void bench(const char *name, int window_bits)
+{
+    int gz_size = 0;
+    uint8_t *gz = load_file(name, &gz_size);
+    if (gz == NULL) {
+        printf("%s missing, run build.pl first\n", name);
+        return;
+    }
+    for (int zero_copy = 0; zero_copy < 2; zero_copy++) {
+        double best = 1e30;
+        int window = 0;
+        long total = 0;
+        for (int r = 0; r < BENCH_ROUNDS; r++) {
+            double us = bench_once(gz, gz_size, window_bits, zero_copy, &window, &total);
+            if (us < best) {
+                best = us;
+            }
+        }
+        printf("%-8s %-10s %8d -> %8ld bytes  window %6d  heap %6d  %8.0f us  %7.1f MB/s\n", name,
+               zero_copy ? "acquire" : "read", gz_size, total, window, window + BENCH_CHUNK, best, total / best);
+    }
+    free(gz);
+}
+
+int main(void)
+{
+    // Before this reader miniz held a fixed 32KB dictionary plus its stream state, and every byte was copied
+    // from that dictionary into the caller buffer
+    bench("text.gz", 0);
+    bench("pcm.gz", 0);
+    bench("w10.zz", 0);
+    bench("w9.gz", 9);
+    return 0;
+}
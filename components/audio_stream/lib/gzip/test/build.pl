@@ -0,0 +1,71 @@
+#!/usr/bin/perl
+# Host test and benchmark of the gzip reader, the ROM tinfl is replaced by zlib in stub/rom/miniz.h
+# Fixtures are generated into fixture/, each `.gz` or `.zz` stream comes with its `.raw` original
+use strict;
+use warnings;
+use Compress::Raw::Zlib;
+use File::Path qw(make_path);
+
+gen_fixtures("fixture");
+`gcc ../gzip_miniz.c test.c -Istub -I../include -I../ -g -O2 -Wall -o ./test -lz`;
+`gcc ../gzip_miniz.c bench.c -Istub -I../include -I../ -O2 -Wall -o ./bench -lz`;
+
+sub gen_fixtures {
+    my ($dir) = @_;
+    make_path($dir);
+    # Text like playlist or json content
+    my $text = '';
+    for my $i (0 .. 20000) {
+        $text .= sprintf("{\"id\":%d,\"uri\":\"http://example.com/track/%05d.mp3\",\"duration\":%d}\n", $i, ($i * 7919) % 100000, 120 + $i % 300);
+    }
+    # 16 bits PCM with silence, compresses like raw audio does
+    my $pcm = '';
+    for my $i (0 .. 400000) {
+        my $v = ($i % 44100) < 22050 ? int(8000 * sin($i * 2 * 3.14159265 * 440 / 44100)) : 0;
+        $pcm .= pack('s<', $v);
+    }
+    write_file("$dir/text.raw", $text);
+    write_file("$dir/pcm.raw", $pcm);
+    # Stored name and default window by gzip tool
+    write_file("$dir/text.in", $text);
+    `gzip -9 -f -k $dir/text.in`;
+    rename("$dir/text.in.gz", "$dir/text.gz");
+    unlink("$dir/text.in");
+    write_file("$dir/pcm.gz", gzip_data($pcm, 15, 0));
+    # Zlib streams declare their window bits in the header
+    write_file("$dir/w10.raw", $text);
+    write_file("$dir/w10.zz", deflate_data($text, 10));
+    # All optional gzip header fields with a 512 bytes window
+    write_file("$dir/w9.raw", $pcm);
+    write_file("$dir/w9.gz", gzip_data($pcm, 9, 1));
+}
+
+sub deflate_data {
+    my ($data, $bits) = @_;
+    my ($d, $err) = Compress::Raw::Zlib::Deflate->new(-Level => 6, -WindowBits => $bits, -AppendOutput => 1);
+    die "deflate init $err" if $err != Z_OK;
+    my $out = '';
+    $d->deflate($data, $out);
+    $d->flush($out);
+    return $out;
+}
+
+sub gzip_data {
+    my ($data, $bits, $all_fields) = @_;
+    my $flag = $all_fields ? (0x02 | 0x04 | 0x08 | 0x10) : 0;
+    my $head = pack('CCCCVCC', 0x1F, 0x8B, 8, $flag, 0, 0, 3);
+    if ($all_fields) {
+        my $extra = 'AP' . pack('v', 4) . 'test';
+        $head .= pack('v', length($extra)) . $extra . "fixture.pcm\0" . "host fixture\0";
+        $head .= pack('v', Compress::Raw::Zlib::crc32($head) & 0xFFFF);
+    }
+    return $head . deflate_data($data, -$bits) . pack('VV', Compress::Raw::Zlib::crc32($data), length($data));
+}
+
+sub write_file {
+    my ($f, $str) = @_;
+    open(my $H, '>', $f) || die "Fail to open $f";
+    binmode $H;
+    print $H $str;
+    close $H;
+}
@@ -0,0 +1,7 @@
+#pragma once
+#include <stdio.h>
+#define LOGOUT(tag, format, ...) printf("%s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI LOGOUT
+#define ESP_LOGE LOGOUT
+#define ESP_LOGD(tag, format, ...)
+#define ESP_LOGW LOGOUT
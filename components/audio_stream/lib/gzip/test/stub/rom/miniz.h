@@ -0,0 +1,82 @@
+#pragma once
+// Host replacement of the tinfl API in the ROM, backed by zlib
+// The zlib window is set to the ring size, so data referring beyond the window fails like on the chip
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <zlib.h>
+
+typedef unsigned long mz_ulong;
+typedef unsigned int  mz_uint;
+typedef uint8_t       mz_uint8;
+typedef uint32_t      mz_uint32;
+
+enum {
+    TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
+    TINFL_FLAG_HAS_MORE_INPUT = 2,
+    TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4,
+    TINFL_FLAG_COMPUTE_ADLER32 = 8
+};
+
+typedef enum {
+    TINFL_STATUS_FAILED_CANNOT_MAKE_PROGRESS = -4,
+    TINFL_STATUS_BAD_PARAM = -3,
+    TINFL_STATUS_ADLER32_MISMATCH = -2,
+    TINFL_STATUS_FAILED = -1,
+    TINFL_STATUS_DONE = 0,
+    TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+    TINFL_STATUS_HAS_MORE_OUTPUT = 2
+} tinfl_status;
+
+typedef struct {
+    z_stream z;
+    int      state;
+} tinfl_decompressor;
+
+#define tinfl_init(r) do { (r)->state = 0; } while (0)
+
+static inline tinfl_status tinfl_decompress(tinfl_decompressor *r, const mz_uint8 *in, size_t *in_size,
+                                            mz_uint8 *out_start, mz_uint8 *out_next, size_t *out_size,
+                                            const mz_uint32 flags)
+{
+    size_t ring = (size_t)(out_next - out_start) + *out_size;
+    if (ring & (ring - 1)) {
+        return TINFL_STATUS_BAD_PARAM;
+    }
+    if (r->state == 0) {
+        int bits = 0;
+        while ((1u << bits) < ring) {
+            bits++;
+        }
+        memset(&r->z, 0, sizeof(r->z));
+        if (inflateInit2(&r->z, (flags & TINFL_FLAG_PARSE_ZLIB_HEADER) ? bits : -bits) != Z_OK) {
+            return TINFL_STATUS_FAILED;
+        }
+        r->state = 1;
+    }
+    if (r->state >= 2) {
+        *in_size = *out_size = 0;
+        return r->state == 2 ? TINFL_STATUS_DONE : TINFL_STATUS_FAILED;
+    }
+    r->z.next_in = (Bytef *)in;
+    r->z.avail_in = *in_size;
+    r->z.next_out = out_next;
+    r->z.avail_out = *out_size;
+    int ret = inflate(&r->z, Z_NO_FLUSH);
+    *in_size -= r->z.avail_in;
+    *out_size -= r->z.avail_out;
+    if (ret == Z_STREAM_END) {
+        inflateEnd(&r->z);
+        r->state = 2;
+        return TINFL_STATUS_DONE;
+    }
+    if (ret != Z_OK && ret != Z_BUF_ERROR) {
+        inflateEnd(&r->z);
+        r->state = 3;
+        return TINFL_STATUS_FAILED;
+    }
+    if (r->z.avail_out == 0) {
+        return TINFL_STATUS_HAS_MORE_OUTPUT;
+    }
+    return (flags & TINFL_FLAG_HAS_MORE_INPUT) ? TINFL_STATUS_NEEDS_MORE_INPUT : TINFL_STATUS_FAILED_CANNOT_MAKE_PROGRESS;
+}
@@ -0,0 +1,254 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gzip_miniz.h"
+
+#define TEST_ASSERT(cond, ...) if (!(cond)) {   \
+        printf("FAIL line %d: ", __LINE__);     \
+        printf(__VA_ARGS__);                    \
+        printf("\n");                           \
+        return -1;                              \
+    }
+
+typedef struct {
+    uint8_t *data;
+    int      size;
+    int      pos;
+    int      max_read;   // Largest piece handed out by one read, 0 for random pieces
+    int      fail_at;    // Read fails once this position is reached, 0 to disable
+} test_src_t;
+
+typedef struct {
+    const char *name;
+    int         window_bits;
+    int         expect_window;
+} test_fixture_t;
+
+static const test_fixture_t fixtures[] = {
+    { "text.gz", 0, 32768 },
+    { "pcm.gz", 0, 32768 },
+    { "w10.zz", 0, 1024 },
+    { "w9.gz", 9, 512 },
+};
+
+static uint8_t *load_file(const char *name, int *size)
+{
+    char path[128];
+    snprintf(path, sizeof(path), "fixture/%s", name);
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return NULL;
+    }
+    fseek(fp, 0, SEEK_END);
+    *size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    uint8_t *data = malloc(*size + 1);
+    if (fread(data, 1, *size, fp) != *size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(fp);
+    return data;
+}
+
+static uint8_t *load_raw(const char *name, int *size)
+{
+    char raw[64];
+    snprintf(raw, sizeof(raw), "%.*s.raw", (int)(strrchr(name, '.') - name), name);
+    return load_file(raw, size);
+}
+
+// Hand out the stream in pieces of varying size, like socket reads do
+static int test_read_cb(uint8_t *data, int size, void *ctx)
+{
+    test_src_t *src = (test_src_t *)ctx;
+    if (src->fail_at && src->pos >= src->fail_at) {
+        return -1;
+    }
+    int n = src->max_read ? src->max_read : rand() % 64 + 1;
+    if (n > size) {
+        n = size;
+    }
+    if (n > src->size - src->pos) {
+        n = src->size - src->pos;
+    }
+    memcpy(data, src->data + src->pos, n);
+    src->pos += n;
+    return n;
+}
+
+static gzip_miniz_handle_t open_src(test_src_t *src, int chunk_size, int window_bits)
+{
+    gzip_miniz_cfg_t cfg = {
+        .read_cb = test_read_cb,
+        .chunk_size = chunk_size,
+        .ctx = src,
+        .window_bits = window_bits,
+    };
+    return gzip_miniz_init(&cfg);
+}
+
+static int test_fixture(const test_fixture_t *f, int chunk_size, int max_read, int out_size, int zero_copy)
+{
+    test_src_t src = { 0 };
+    int raw_size = 0;
+    uint8_t *raw = load_raw(f->name, &raw_size);
+    src.data = load_file(f->name, &src.size);
+    src.max_read = max_read;
+    TEST_ASSERT(raw && src.data, "%s missing, run build.pl first", f->name);
+    gzip_miniz_handle_t zip = open_src(&src, chunk_size, f->window_bits);
+    TEST_ASSERT(zip, "init");
+    TEST_ASSERT(gzip_miniz_get_window_size(zip) == 0, "window before header");
+    uint8_t *out = malloc(out_size);
+    int pos = 0;
+    while (1) {
+        int n;
+        if (zero_copy) {
+            const uint8_t *data = NULL;
+            n = gzip_miniz_acquire_read(zip, &data, out_size);
+            if (n > 0) {
+                TEST_ASSERT(n <= out_size, "%s acquire %d over %d", f->name, n, out_size);
+                memcpy(out, data, n);
+                TEST_ASSERT(gzip_miniz_release_read(zip, n) == 0, "release");
+            }
+        } else {
+            n = gzip_miniz_read(zip, out, out_size);
+        }
+        TEST_ASSERT(n >= 0, "%s read ret %d at %d", f->name, n, pos);
+        if (n == 0) {
+            break;
+        }
+        TEST_ASSERT(pos + n <= raw_size && memcmp(out, raw + pos, n) == 0, "%s mismatch at %d", f->name, pos);
+        pos += n;
+    }
+    TEST_ASSERT(pos == raw_size, "%s size %d expect %d", f->name, pos, raw_size);
+    TEST_ASSERT(gzip_miniz_get_window_size(zip) == f->expect_window, "%s window %d", f->name,
+                gzip_miniz_get_window_size(zip));
+    TEST_ASSERT(gzip_miniz_read(zip, out, out_size) == 0, "read after end");
+    gzip_miniz_deinit(zip);
+    free(out);
+    free(raw);
+    free(src.data);
+    return 0;
+}
+
+static int test_errors(void)
+{
+    uint8_t out[256];
+    test_src_t src = { 0 };
+    int size = 0;
+    uint8_t *gz = load_file("text.gz", &size);
+    TEST_ASSERT(gz, "text.gz missing");
+
+    // Wrong magic
+    uint8_t bad[16] = { 0x1F, 0x8C, 8 };
+    src = (test_src_t) { .data = bad, .size = sizeof(bad) };
+    gzip_miniz_handle_t zip = open_src(&src, 0, 0);
+    TEST_ASSERT(gzip_miniz_read(zip, out, sizeof(out)) == -1, "bad gzip magic");
+    TEST_ASSERT(gzip_miniz_read(zip, out, sizeof(out)) == -1, "error sticks");
+    gzip_miniz_deinit(zip);
+
+    // Zlib header with a wrong check value
+    uint8_t bad_zlib[4] = { 0x78, 0x9D };
+    src = (test_src_t) { .data = bad_zlib, .size = sizeof(bad_zlib) };
+    zip = open_src(&src, 0, 0);
+    TEST_ASSERT(gzip_miniz_read(zip, out, sizeof(out)) == -1, "bad zlib check");
+    gzip_miniz_deinit(zip);
+
+    // Corrupted zlib data is caught by the adler32 at the latest, the decoded part is handed out before the error
+    int zz_size = 0;
+    uint8_t *broken = load_file("w10.zz", &zz_size);
+    TEST_ASSERT(broken, "w10.zz missing");
+    memset(broken + zz_size / 2, 0xFF, 64);
+    src = (test_src_t) { .data = broken, .size = zz_size, .max_read = 512 };
+    zip = open_src(&src, 1024, 0);
+    int ret;
+    while ((ret = gzip_miniz_read(zip, out, sizeof(out))) > 0);
+    TEST_ASSERT(ret == -2, "corrupted data ret %d", ret);
+    gzip_miniz_deinit(zip);
+    free(broken);
+
+    // Truncated stream ends without error
+    src = (test_src_t) { .data = gz, .size = size / 3, .max_read = 100 };
+    zip = open_src(&src, 1024, 0);
+    int total = 0;
+    while ((ret = gzip_miniz_read(zip, out, sizeof(out))) > 0) {
+        total += ret;
+    }
+    TEST_ASSERT(ret == 0 && total > 0, "truncated ret %d total %d", ret, total);
+    gzip_miniz_deinit(zip);
+
+    // Read failure of the source
+    src = (test_src_t) { .data = gz, .size = size, .max_read = 100, .fail_at = 1000 };
+    zip = open_src(&src, 1024, 0);
+    while ((ret = gzip_miniz_read(zip, out, sizeof(out))) > 0);
+    TEST_ASSERT(ret == -1, "read failure ret %d", ret);
+    gzip_miniz_deinit(zip);
+
+    // Argument checks
+    gzip_miniz_cfg_t cfg = { .read_cb = test_read_cb, .window_bits = 16 };
+    TEST_ASSERT(gzip_miniz_init(&cfg) == NULL, "window bits 16");
+    cfg.window_bits = 7;
+    TEST_ASSERT(gzip_miniz_init(&cfg) == NULL, "window bits 7");
+    cfg.read_cb = NULL;
+    cfg.window_bits = 0;
+    TEST_ASSERT(gzip_miniz_init(&cfg) == NULL, "no read callback");
+    src = (test_src_t) { .data = gz, .size = size };
+    zip = open_src(&src, 0, 0);
+    const uint8_t *data = NULL;
+    TEST_ASSERT(gzip_miniz_acquire_read(zip, NULL, 16) == -1, "null data");
+    int n = gzip_miniz_acquire_read(zip, &data, 16);
+    TEST_ASSERT(n > 0 && n <= 16 && data, "acquire %d", n);
+    TEST_ASSERT(gzip_miniz_release_read(zip, gzip_miniz_acquire_read(zip, &data, 1 << 16) + 1) == -1, "release over available");
+    TEST_ASSERT(gzip_miniz_release_read(zip, n) == 0, "release");
+    gzip_miniz_deinit(zip);
+    free(gz);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    srand(argc > 1 ? atoi(argv[1]) : 1);
+    if (test_errors()) {
+        return 1;
+    }
+    // Tiny reads and chunks force the header to be parsed across many reads
+    static const int chunk_sizes[] = { 0, 1, 7, 1024 };
+    static const int max_reads[] = { 1, 3, 0, 4096 };
+    static const int out_sizes[] = { 1, 100, 4096, 65536 };
+    for (int i = 0; i < sizeof(fixtures) / sizeof(fixtures[0]); i++) {
+        for (int c = 0; c < 4; c++) {
+            for (int z = 0; z < 2; z++) {
+                if (test_fixture(&fixtures[i], chunk_sizes[c], max_reads[c], out_sizes[(c + z) % 4], z)) {
+                    return 1;
+                }
+            }
+        }
+    }
+    printf("gzip_miniz: all tests passed\n");
+    return 0;
+}
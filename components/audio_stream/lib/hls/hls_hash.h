@@ -0,0 +1,61 @@
+/*
+ * Generated by mk_hls_hash.py, do not edit.
+ */
+
+#ifndef HLS_HASH_H
+#define HLS_HASH_H
+
+#include "hls_parse.h"
+
+typedef struct {
+    const char* name;
+    uint8_t     len;
+    uint8_t     value;
+} hls_hash_entry_t;
+
+#define HLS_TAG_HASH_SIZE (32)
+#define HLS_TAG_HASH(s, n) ((((uint8_t)(s)[0] * 1) ^ ((uint8_t)(s)[(n) - 1] * 2) ^ ((n) * 28)) & (HLS_TAG_HASH_SIZE - 1))
+
+static const hls_hash_entry_t hls_tag_hash_table[HLS_TAG_HASH_SIZE] = {
+    [0] = { "TARGETDURATION", 14, HLS_TAG_TARGET_DURATION },
+    [3] = { "MEDIA", 5, HLS_TAG_MEDIA },
+    [7] = { "STREAM-INF", 10, HLS_TAG_STREAM_INF },
+    [9] = { "ENDLIST", 7, HLS_TAG_ENDLIST },
+    [13] = { "KEY", 3, HLS_TAG_KEY },
+    [14] = { "VERSION", 7, HLS_TAG_VERSION },
+    [15] = { "MEDIA-SEQUENCE", 14, HLS_TAG_MEDIA_SEQUENCE },
+    [17] = { "INF", 3, HLS_TAG_INF },
+    [20] = { "BYTERANGE", 9, HLS_TAG_BYTE_RANGE },
+    [21] = { "SESSION-KEY", 11, HLS_TAG_SESSION_KEY },
+    [22] = { "PLAYLIST-TYPE", 13, HLS_TAG_PLAYLIST_TYPE },
+    [25] = { "MAP", 3, HLS_TAG_MAP },
+    [26] = { "DISCONTINUITY", 13, HLS_TAG_DISCONTINUITY },
+    [29] = { "I-FRAME-STREAM-INF", 18, HLS_TAG_I_FRAME_STREAM_INF },
+    [31] = { "INDEPENDENT-SEGMENTS", 20, HLS_TAG_INDEPENDENT_SEGMENTS },
+};
+
+#define HLS_ATTR_HASH_SIZE (32)
+#define HLS_ATTR_HASH(s, n) ((((uint8_t)(s)[0] * 1) ^ ((uint8_t)(s)[(n) - 1] * 16) ^ ((n) * 24)) & (HLS_ATTR_HASH_SIZE - 1))
+
+static const hls_hash_entry_t hls_attr_hash_table[HLS_ATTR_HASH_SIZE] = {
+    [0] = { "PROGRAM-ID", 10, HLS_ATTR_PROGRAM_ID },
+    [2] = { "RESOLUTION", 10, HLS_ATTR_RESOLUTION },
+    [3] = { "CODECS", 6, HLS_ATTR_CODECS },
+    [4] = { "TYPE", 4, HLS_ATTR_TYPE },
+    [7] = { "GROUP-ID", 8, HLS_ATTR_GROUP_ID },
+    [9] = { "AUDIO", 5, HLS_ATTR_AUDIO },
+    [11] = { "KEYFORMATVERSION", 16, HLS_ATTR_KEYFORMAT_VERSION },
+    [12] = { "DEFAULT", 7, HLS_ATTR_DEFAULT },
+    [13] = { "URI", 3, HLS_ATTR_URI },
+    [17] = { "AUTOSELECT", 10, HLS_ATTR_AUTO_SELECT },
+    [19] = { "KEYFORMAT", 9, HLS_ATTR_KEYFORMAT },
+    [22] = { "FORCED", 6, HLS_ATTR_FORCED },
+    [25] = { "IV", 2, HLS_ATTR_IV },
+    [26] = { "BANDWIDTH", 9, HLS_ATTR_BANDWIDTH },
+    [27] = { "SUBTITLES", 9, HLS_ATTR_SUBTITLES },
+    [28] = { "LANGUAGE", 8, HLS_ATTR_LANGUAGE },
+    [29] = { "METHOD", 6, HLS_ATTR_METHOD },
+    [30] = { "NAME", 4, HLS_ATTR_NAME },
+};
+
+#endif
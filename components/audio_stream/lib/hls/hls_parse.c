@@ -24,6 +24,7 @@
 
 #include "esp_log.h"
 #include "hls_parse.h"
+#include "hls_hash.h"
 
 #define TAG "HLS_PARSER"
 
@@ -87,178 +88,35 @@ static hls_encrypt_method_t hls_get_method(char* attr)
     return HLS_ENCRYPT_METHOD_NONE;
 }
 
-static hls_attr_t hls_get_attr(char* attr)
+static hls_attr_t hls_get_attr(char* attr, int len)
 {
-    switch (*attr) {
-        case 'A':
-            if (STR_SAME(attr, HLS_STR_AUTOSELECT)) {
-                return HLS_ATTR_AUTO_SELECT;
-            }
-            if (STR_SAME(attr, HLS_STR_AUDIO)) {
-                return HLS_ATTR_AUDIO;
-            }
-            break;
-        case 'B':
-            if (STR_SAME(attr, HLS_STR_BANDWIDTH)) {
-                return HLS_ATTR_BANDWIDTH;
-            }
-            break;
-        case 'C':
-            if (STR_SAME(attr, HLS_STR_CODECS)) {
-                return HLS_ATTR_CODECS;
-            }
-            break;
-        case 'D':
-            if (STR_SAME(attr, HLS_STR_DEFAULT)) {
-                return HLS_ATTR_DEFAULT;
-            }
-            break;
-        case 'F':
-            if (STR_SAME(attr, HLS_STR_FORCED)) {
-                return HLS_ATTR_FORCED;
-            }
-            break;
-        case 'G':
-            if (STR_SAME(attr, HLS_STR_GROUP_ID)) {
-                return HLS_ATTR_GROUP_ID;
-            }
-            break;
-        case 'I':
-            if (STR_SAME(attr, HLS_STR_IV)) {
-                return HLS_ATTR_IV;
-            }
-            break;
-        case 'K':
-            if (STR_SAME(attr, HLS_STR_KEYFORMAT)) {
-                return HLS_ATTR_KEYFORMAT;
-            }
-            if (STR_SAME(attr, HLS_STR_KEYFORMATVERSION)) {
-                return HLS_ATTR_KEYFORMAT_VERSION;
-            }
-            break;
-        case 'L':
-            if (STR_SAME(attr, HLS_STR_LANGUAGE)) {
-                return HLS_ATTR_LANGUAGE;
-            }
-            break;
-            case 'M':
-            if (STR_SAME(attr, HLS_STR_METHOD)) {
-                return HLS_ATTR_METHOD;
-            }
-            break;
-        case 'N':
-            if (STR_SAME(attr, HLS_STR_NAME)) {
-                return HLS_ATTR_NAME;
-            }
-            break;
-        case 'P':
-            if (STR_SAME(attr, HLS_STR_PROGRAM_ID)) {
-                return HLS_ATTR_PROGRAM_ID;
-            }
-            break;
-        case 'R':
-            if (STR_SAME(attr, HLS_STR_RESOLUTION)) {
-                return HLS_ATTR_RESOLUTION;
-            }
-            break;
-        case 'S':
-            if (STR_SAME(attr, HLS_STR_SUBTITLES)) {
-                return HLS_ATTR_SUBTITLES;
-            }
-            break;
-        case 'T':
-            if (STR_SAME(attr, HLS_STR_TYPE)) {
-                return HLS_ATTR_TYPE;
-            }
-            break;
-        case 'U':
-            if (STR_SAME(attr, HLS_STR_URI)) {
-                return HLS_ATTR_URI;
-            }
-            break;
-        default:
-            break;
+    if (len <= 0) {
+        return HLS_ATTR_IGNORE;
+    }
+    const hls_hash_entry_t* e = &hls_attr_hash_table[HLS_ATTR_HASH(attr, len)];
+    if (e->len == len && memcmp(e->name, attr, len) == 0) {
+        return (hls_attr_t)e->value;
     }
     return HLS_ATTR_IGNORE;
 }
 
-static hls_tag_t hls_get_tag(char* tag)
+static hls_tag_t hls_get_tag(char* tag, int len)
 {
-    if (MEM_SAME(tag, HLS_STR_EXT_X_)) {
+    if (len >= (int)sizeof(HLS_STR_EXT_X_) - 1 && MEM_SAME(tag, HLS_STR_EXT_X_)) {
         tag += sizeof(HLS_STR_EXT_X_) - 1;
-    } else if (MEM_SAME(tag, HLS_STR_EXT)) {
-        tag += sizeof(HLS_STR_EXT) -1;
+        len -= sizeof(HLS_STR_EXT_X_) - 1;
+    } else if (len >= (int)sizeof(HLS_STR_EXT) - 1 && MEM_SAME(tag, HLS_STR_EXT)) {
+        tag += sizeof(HLS_STR_EXT) - 1;
+        len -= sizeof(HLS_STR_EXT) - 1;
     } else {
         return HLS_TAG_IGNORE;
     }
-    switch (*tag) {
-        case 'B':
-            if (STR_SAME(tag, HLS_STR_BYTERANGE)) {
-                return HLS_TAG_BYTE_RANGE;
-            }
-            break;
-        case 'D':
-            if (STR_SAME(tag, HLS_STR_DISCONTINUITY)) {
-                return HLS_TAG_DISCONTINUITY;
-            }
-            break;
-        case 'E':
-            if (STR_SAME(tag, HLS_STR_ENDLIST)) {
-                return HLS_TAG_ENDLIST;
-            }
-            break;
-        case 'I':
-            if (STR_SAME(tag, HLS_STR_INF)) {
-                return HLS_TAG_INF;
-            }
-            if (STR_SAME(tag, HLS_STR_I_FRAME_STREAM_INF)) {
-                return HLS_TAG_I_FRAME_STREAM_INF;
-            }
-            if (STR_SAME(tag, HLS_STR_INDEPENDENT_SEGMENTS)) {
-                return HLS_TAG_INDEPENDENT_SEGMENTS;
-            }
-            break;
-        case 'K':
-            if (STR_SAME(tag, HLS_STR_KEY)) {
-                return HLS_TAG_KEY;
-            }
-            break;
-        case 'M':
-            if (STR_SAME(tag, HLS_STR_MEDIA)) {
-                return HLS_TAG_MEDIA;
-            }
-            if (STR_SAME(tag, HLS_STR_MEDIA_SEQUENCE)) {
-                return HLS_TAG_MEDIA_SEQUENCE;
-            }
-            if (STR_SAME(tag, HLS_STR_MAP)) {
-                return HLS_TAG_MAP;
-            }
-            break;
-        case 'P':
-            if (STR_SAME(tag, HLS_STR_PLAYLIST_TYPE)) {
-                return HLS_TAG_PLAYLIST_TYPE;
-            }
-            break;
-        case 'S':
-            if (STR_SAME(tag, HLS_STR_STREAM_INF)) {
-                return HLS_TAG_STREAM_INF;
-            }
-            if (STR_SAME(tag, HLS_STR_SESSION_KEY)) {
-                return HLS_TAG_SESSION_KEY;
-            }
-            break;
-        case 'T':
-            if (STR_SAME(tag, HLS_STR_TARGETDURATION)) {
-                return HLS_TAG_TARGET_DURATION;
-            }
-            break;
-        case 'V':
-            if (STR_SAME(tag, HLS_STR_VERSION)) {
-                return HLS_TAG_VERSION;
-            }
-            break;
-        default:
-            break;
+    if (len <= 0) {
+        return HLS_TAG_IGNORE;
+    }
+    const hls_hash_entry_t* e = &hls_tag_hash_table[HLS_TAG_HASH(tag, len)];
+    if (e->len == len && memcmp(e->name, tag, len) == 0) {
+        return (hls_tag_t)e->value;
     }
     return HLS_TAG_IGNORE;
 }
@@ -319,8 +177,8 @@ static void hls_parse_key(hls_parse_t* parser, hls_tag_t tag, int attr_num) {
         char* k = parser->attr[i];
         char* sep = strchr(k, '=');
         if (sep) {
+            parser->k[i] = hls_get_attr(k, sep - k);
             *(sep++) = 0;
-            parser->k[i] = hls_get_attr(k);
             parser->v[i].s = sep;
         } else {
             parser->k[i] = HLS_ATTR_IGNORE;
@@ -347,8 +205,12 @@ static void hls_parse_key(hls_parse_t* parser, hls_tag_t tag, int attr_num) {
     }
 }
 
-static void hls_parse_value(hls_parse_t* parser, int attr_num) {
+static void hls_parse_value(hls_parse_t* parser, hls_tag_t tag, int attr_num) {
     for (int i = 0; i < attr_num; i++) {
+        if (tag == HLS_TAG_PLAYLIST_TYPE && i == 0) {
+            // Value already converted in `hls_parse_key`
+            continue;
+        }
         switch (parser->k[i]) {
             case HLS_ATTR_DURATION:
                 parser->v[i].f = hls_get_float_value(parser->v[i].s);
@@ -446,7 +308,7 @@ int hls_parse(hls_parse_t* parser, hls_tag_callback cb, void* ctx)
         int attr_num = 0;
         char* sep = hls_get_tag_sep(line);
         if (sep == NULL) {
-            tag = hls_get_tag(line);
+            tag = (*line == '#') ? hls_get_tag(line, strlen(line)) : HLS_TAG_IGNORE;
             if (tag == HLS_TAG_IGNORE) {
                 // append tag attribute to previous tag
                 if (parser->tag == HLS_TAG_STREAM_INF || parser->tag == HLS_TAG_INF) {
@@ -461,10 +323,9 @@ int hls_parse(hls_parse_t* parser, hls_tag_callback cb, void* ctx)
             }
             parser->tag = tag;
         } else {
-            char* tag_str = line;
+            tag = hls_get_tag(line, sep - line);
             *(sep++) = 0;
             char* attr = sep;
-            tag = hls_get_tag(tag_str);
             // set previous tag
             parser->tag = tag;
             if (tag == HLS_TAG_IGNORE) {
@@ -473,7 +334,7 @@ int hls_parse(hls_parse_t* parser, hls_tag_callback cb, void* ctx)
             parser->attr[attr_num++] = attr;
             attr_num = hls_parse_attr(parser, sep, attr_num);
             hls_parse_key(parser, tag, attr_num);
-            hls_parse_value(parser, attr_num);
+            hls_parse_value(parser, tag, attr_num);
         }
         if (cb) {
             hls_tag_info_t tag_info = {
@@ -36,7 +36,8 @@
 #define MEDIA_FLAG_DEFAULT     (2)
 #define MEDIA_FLAG_FORCED      (4)
 
-#define HLS_MALLOC(type) (type*)audio_calloc(1, sizeof(type))
+#define HLS_MALLOC(type) (type*)audio_mem_calloc(1, sizeof(type), AUDIO_MEM_CAPS_DEFAULT, "hls")
+#define HLS_STRDUP(s)    audio_mem_strdup(s, AUDIO_MEM_CAPS_DEFAULT, "hls")
 #define HLS_FREE(b)      if (b) {audio_free(b); b = NULL;}
 
 /**
@@ -146,16 +147,16 @@ static int hls_fill_media_attr(hls_media_t* m, hls_tag_info_t* tag_info)
                 m->type = (hls_type_t)tag_info->v[i].v;
                 break;
             case HLS_ATTR_GROUP_ID:
-                m->group_id = audio_strdup(tag_info->v[i].s);
+                m->group_id = HLS_STRDUP(tag_info->v[i].s);
                 break;
             case HLS_ATTR_NAME:
-                m->name = audio_strdup(tag_info->v[i].s);
+                m->name = HLS_STRDUP(tag_info->v[i].s);
                 break;
             case HLS_ATTR_LANGUAGE:
-                m->lang = audio_strdup(tag_info->v[i].s);
+                m->lang = HLS_STRDUP(tag_info->v[i].s);
                 break;
             case HLS_ATTR_URI:
-                m->uri = audio_strdup(tag_info->v[i].s);
+                m->uri = HLS_STRDUP(tag_info->v[i].s);
                 break;
             default:
                 break;
@@ -175,19 +176,19 @@ static int hls_fill_stream_attr(hls_stream_t* s, hls_tag_info_t* tag_info)
                 s->bandwidth = (uint32_t)tag_info->v[i].v;
                 break;
             case HLS_ATTR_CODECS:
-                s->codec = audio_strdup(tag_info->v[i].s);
+                s->codec = HLS_STRDUP(tag_info->v[i].s);
                 break;
             case HLS_ATTR_AUDIO:
-                s->audio = audio_strdup(tag_info->v[i].s);
+                s->audio = HLS_STRDUP(tag_info->v[i].s);
                 break;
             case HLS_ATTR_SUBTITLES:
-                s->subtitle = audio_strdup(tag_info->v[i].s);
+                s->subtitle = HLS_STRDUP(tag_info->v[i].s);
                 break;
             case HLS_ATTR_RESOLUTION:
-                s->resolution = audio_strdup(tag_info->v[i].s);
+                s->resolution = HLS_STRDUP(tag_info->v[i].s);
                 break;
             case HLS_ATTR_URI:
-                s->uri = audio_strdup(tag_info->v[i].s);
+                s->uri = HLS_STRDUP(tag_info->v[i].s);
                 break;
             default:
                 break;
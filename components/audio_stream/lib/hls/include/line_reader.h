@@ -40,7 +40,7 @@ typedef struct {
     int      size;             /*!< Input data size */
     int      rp;               /*!< Read pointer of cache buffer */
     bool     eos;              /*!< Input data end of stream */
-    uint8_t* line_buffer;      /*!< Cache buffers for input data */
+    uint8_t* line_buffer;      /*!< Cache buffer for lines straddling input buffers */
     uint16_t line_size;        /*!< Buffer size of cache buffer */
     uint16_t line_fill;        /*!< Cached size */
 } line_reader_t;
@@ -48,7 +48,7 @@ typedef struct {
 /**
  * @brief      Initialize line reader
  *
- * @param      line_size: Maximum characters in one line
+ * @param      line_size: Maximum characters in one line straddling two input buffers
  *
  * @return     Line reader instance
  */
@@ -57,6 +57,9 @@ line_reader_t* line_reader_init(int line_size);
 /**
  * @brief      Add buffer to line reader
  *
+ * @note       Lines are tokenized in place: line endings inside `buffer` are overwritten with '\0'.
+ *             So the buffer must be writable and stay valid until `line_reader_get_line` returns NULL
+ *
  * @param      reader: Line reader instance
  * @param      buffer: Buffer to be parsed
  * @param      size: Buffer size to be parsed
@@ -67,6 +70,9 @@ void line_reader_add_buffer(line_reader_t* reader, uint8_t* buffer, int size, bo
 /**
  * @brief      Get one line data from line reader
  *
+ * @note       Returned line points into the input buffer, only lines straddling two input buffers
+ *             are copied into the internal cache buffer
+ *
  * @param      reader: Line reader instance
  * @param      buffer: Buffer to be parsed
  * @param      size: Buffer size
@@ -55,7 +55,7 @@ static char* get_slash(char* s, int len, int dir)
 char* join_url(char* base, char* ext)
 {
     if (memcmp(ext, "http", 4) == 0) {
-        return audio_strdup(ext);
+        return audio_mem_strdup(ext, AUDIO_MEM_CAPS_DEFAULT, "hls");
     }
     int base_len = strlen(base);
     int ext_len  = strlen(ext);
@@ -113,7 +113,7 @@ char* join_url(char* base, char* ext)
         base_len = s - base + 1;
     }
     int t = base_len + ext_len - ext_skip + 1;
-    char* dst = (char*) audio_malloc(t);
+    char* dst = (char*) audio_mem_alloc(t, AUDIO_MEM_CAPS_DEFAULT, "hls");
     if (dst == NULL) {
         return dst;
     }
@@ -31,13 +31,22 @@
 
 #define TAG "LINE_READER"
 
-static inline void line_reader_add_char(line_reader_t* b, uint8_t c)
+static inline void line_reader_append(line_reader_t* b, uint8_t* data, int len)
 {
-    if (b->line_fill < b->line_size) {
-        b->line_buffer[b->line_fill++] = c;
-    } else {
+    // Reserve one byte for the line terminator
+    if (b->line_fill + len >= b->line_size) {
         ESP_LOGE(TAG, "Line too long try to init large than %d", b->line_size);
+        len = b->line_size - 1 - b->line_fill;
     }
+    memcpy(b->line_buffer + b->line_fill, data, len);
+    b->line_fill += len;
+}
+
+static inline char* line_reader_take_line(line_reader_t* b)
+{
+    b->line_buffer[b->line_fill] = 0;
+    b->line_fill = 0;
+    return (char*)b->line_buffer;
 }
 
 line_reader_t* line_reader_init(int line_size)
@@ -70,24 +79,32 @@ char* line_reader_get_line(line_reader_t* b)
         return NULL;
     }
     while (b->rp < b->size) {
-        uint8_t c = b->buffer[b->rp];
-        if (c == '\r' || c == '\n') {
-            b->rp++;
-            if (b->line_fill) {
-                line_reader_add_char(b, 0);
-                b->line_fill = 0;
-                return (char*)b->line_buffer;
-            }
-            continue;
-        } else {
-            line_reader_add_char(b, c);
+        uint8_t* start = b->buffer + b->rp;
+        uint8_t* end = b->buffer + b->size;
+        uint8_t* p = start;
+        while (p < end && *p != '\r' && *p != '\n') {
+            p++;
+        }
+        int len = p - start;
+        if (p == end) {
+            // Line straddles the buffer boundary, keep it until the rest arrives
+            line_reader_append(b, start, len);
+            b->rp = b->size;
+            break;
+        }
+        b->rp += len + 1;
+        if (b->line_fill) {
+            line_reader_append(b, start, len);
+            return line_reader_take_line(b);
+        }
+        if (len) {
+            // Terminate the line in place so no copy is needed
+            *p = 0;
+            return (char*)start;
         }
-        b->rp++;
     }
     if (b->eos && b->line_fill) {
-        line_reader_add_char(b, 0);
-        b->line_fill = 0;
-        return (char*)b->line_buffer;
+        return line_reader_take_line(b);
     }
     b->rp = 0; // auto reset
     b->size = 0;
@@ -0,0 +1,137 @@
+#!/usr/bin/env python
+
+#  ESPRESSIF MIT License
+#
+#  Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+#
+#  Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+#  it is free of charge, to any person obtaining a copy of this software and associated
+#  documentation files (the "Software"), to deal in the Software without restriction, including
+#  without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+#  and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+#  to do so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in all copies or
+#  substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+#  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+#  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+#  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+#  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+"""
+mk_hls_hash:
+
+Generate `hls_hash.h`, the perfect hash tables used by `hls_parse.c` to map HLS tag and
+attribute names to `hls_tag_t` / `hls_attr_t` with one probe and one `memcmp`.
+
+The hash of a name `s` with length `n` is:
+    ((s[0] * a) ^ (s[n - 1] * b) ^ (n * c)) & (size - 1)
+The script searches the smallest power-of-two table and the multipliers that make it
+collision free. Rerun it after editing the keyword lists below:
+    python mk_hls_hash.py > hls_hash.h
+"""
+
+import itertools
+
+HLS_TAGS = [
+    ('BYTERANGE',            'HLS_TAG_BYTE_RANGE'),
+    ('DISCONTINUITY',        'HLS_TAG_DISCONTINUITY'),
+    ('ENDLIST',              'HLS_TAG_ENDLIST'),
+    ('INF',                  'HLS_TAG_INF'),
+    ('I-FRAME-STREAM-INF',   'HLS_TAG_I_FRAME_STREAM_INF'),
+    ('INDEPENDENT-SEGMENTS', 'HLS_TAG_INDEPENDENT_SEGMENTS'),
+    ('KEY',                  'HLS_TAG_KEY'),
+    ('MEDIA',                'HLS_TAG_MEDIA'),
+    ('MEDIA-SEQUENCE',       'HLS_TAG_MEDIA_SEQUENCE'),
+    ('MAP',                  'HLS_TAG_MAP'),
+    ('PLAYLIST-TYPE',        'HLS_TAG_PLAYLIST_TYPE'),
+    ('STREAM-INF',           'HLS_TAG_STREAM_INF'),
+    ('SESSION-KEY',          'HLS_TAG_SESSION_KEY'),
+    ('TARGETDURATION',       'HLS_TAG_TARGET_DURATION'),
+    ('VERSION',              'HLS_TAG_VERSION'),
+]
+
+HLS_ATTRS = [
+    ('AUTOSELECT',           'HLS_ATTR_AUTO_SELECT'),
+    ('AUDIO',                'HLS_ATTR_AUDIO'),
+    ('BANDWIDTH',            'HLS_ATTR_BANDWIDTH'),
+    ('CODECS',               'HLS_ATTR_CODECS'),
+    ('DEFAULT',              'HLS_ATTR_DEFAULT'),
+    ('FORCED',               'HLS_ATTR_FORCED'),
+    ('GROUP-ID',             'HLS_ATTR_GROUP_ID'),
+    ('IV',                   'HLS_ATTR_IV'),
+    ('KEYFORMAT',            'HLS_ATTR_KEYFORMAT'),
+    ('KEYFORMATVERSION',     'HLS_ATTR_KEYFORMAT_VERSION'),
+    ('LANGUAGE',             'HLS_ATTR_LANGUAGE'),
+    ('METHOD',               'HLS_ATTR_METHOD'),
+    ('NAME',                 'HLS_ATTR_NAME'),
+    ('PROGRAM-ID',           'HLS_ATTR_PROGRAM_ID'),
+    ('RESOLUTION',           'HLS_ATTR_RESOLUTION'),
+    ('SUBTITLES',            'HLS_ATTR_SUBTITLES'),
+    ('TYPE',                 'HLS_ATTR_TYPE'),
+    ('URI',                  'HLS_ATTR_URI'),
+]
+
+
+def hls_hash(s, a, b, c, size):
+    return ((ord(s[0]) * a) ^ (ord(s[-1]) * b) ^ (len(s) * c)) & (size - 1)
+
+
+def find_params(keys):
+    size = 1
+    while size < len(keys):
+        size <<= 1
+    while True:
+        for a, b, c in itertools.product(range(1, 32), repeat=3):
+            slots = set(hls_hash(k, a, b, c, size) for k, _ in keys)
+            if len(slots) == len(keys):
+                return size, a, b, c
+        size <<= 1
+
+
+def gen_table(prefix, name, keys):
+    size, a, b, c = find_params(keys)
+    table = [None] * size
+    for k, v in keys:
+        table[hls_hash(k, a, b, c, size)] = (k, v)
+    out = []
+    out.append('#define %s_SIZE (%d)' % (prefix, size))
+    out.append('#define %s(s, n) ((((uint8_t)(s)[0] * %d) ^ ((uint8_t)(s)[(n) - 1] * %d) ^ ((n) * %d)) & (%s_SIZE - 1))'
+               % (prefix, a, b, c, prefix))
+    out.append('')
+    out.append('static const hls_hash_entry_t %s[%s_SIZE] = {' % (name, prefix))
+    for i, e in enumerate(table):
+        if e:
+            out.append('    [%d] = { "%s", %d, %s },' % (i, e[0], len(e[0]), e[1]))
+    out.append('};')
+    return '\n'.join(out)
+
+
+def main():
+    print('/*')
+    print(' * Generated by mk_hls_hash.py, do not edit.')
+    print(' */')
+    print('')
+    print('#ifndef HLS_HASH_H')
+    print('#define HLS_HASH_H')
+    print('')
+    print('#include "hls_parse.h"')
+    print('')
+    print('typedef struct {')
+    print('    const char* name;')
+    print('    uint8_t     len;')
+    print('    uint8_t     value;')
+    print('} hls_hash_entry_t;')
+    print('')
+    print(gen_table('HLS_TAG_HASH', 'hls_tag_hash_table', HLS_TAGS))
+    print('')
+    print(gen_table('HLS_ATTR_HASH', 'hls_attr_hash_table', HLS_ATTRS))
+    print('')
+    print('#endif')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,184 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "hls_parse.h"
+
+#define BENCH_READ_SIZE  (512)  // Same as MAX_PLAYLIST_LINE_SIZE in http_stream
+#define BENCH_ROUNDS     (20)
+
+typedef struct {
+    int    tags;
+    int    attrs;
+    int    uris;
+    double duration;
+    uint64_t bandwidth;
+} bench_result_t;
+
+static int bench_tag_cb(hls_tag_info_t* tag_info, void* ctx)
+{
+    bench_result_t* r = (bench_result_t*) ctx;
+    r->tags++;
+    r->attrs += tag_info->attr_num;
+    for (int i = 0; i < tag_info->attr_num; i++) {
+        switch (tag_info->k[i]) {
+            case HLS_ATTR_DURATION:
+                r->duration += tag_info->v[i].f;
+                break;
+            case HLS_ATTR_BANDWIDTH:
+                r->bandwidth += tag_info->v[i].v;
+                break;
+            case HLS_ATTR_URI:
+                r->uris++;
+                break;
+            default:
+                break;
+        }
+    }
+    return 0;
+}
+
+static char* gen_media_playlist(int segments, int* size)
+{
+    int   cap = 256 + segments * 160;
+    char* b = malloc(cap);
+    int   n = 0;
+    n += sprintf(b + n, "#EXTM3U\n#EXT-X-VERSION:3\n#EXT-X-TARGETDURATION:10\n#EXT-X-MEDIA-SEQUENCE:%d\n", 100000);
+    n += sprintf(b + n, "#EXT-X-KEY:METHOD=AES-128,URI=\"https://keys.example.com/live/key.bin\",IV=0x0123456789ABCDEF0123456789ABCDEF\r\n");
+    for (int i = 0; i < segments; i++) {
+        if (i % 64 == 0) {
+            n += sprintf(b + n, "#EXT-X-DISCONTINUITY\r\n");
+        }
+        n += sprintf(b + n, "#EXTINF:9.984,live radio segment\r\n");
+        n += sprintf(b + n, "https://cdn.example.com/live/radio/aac_128k/segment_%08d.aac\r\n", 100000 + i);
+    }
+    *size = n;
+    return b;
+}
+
+static char* gen_master_playlist(int variants, int* size)
+{
+    int   cap = 256 + variants * 320;
+    char* b = malloc(cap);
+    int   n = 0;
+    n += sprintf(b + n, "#EXTM3U\n#EXT-X-INDEPENDENT-SEGMENTS\n");
+    for (int i = 0; i < variants; i++) {
+        n += sprintf(b + n, "#EXT-X-MEDIA:TYPE=AUDIO,GROUP-ID=\"aac-%d\",NAME=\"Main %d\",LANGUAGE=\"en\",DEFAULT=YES,"
+                            "AUTOSELECT=YES,URI=\"audio/%d/index.m3u8\"\n", i, i, i);
+        n += sprintf(b + n, "#EXT-X-STREAM-INF:PROGRAM-ID=1,BANDWIDTH=%d,CODECS=\"mp4a.40.2\",AUDIO=\"aac-%d\"\n",
+                     32000 + i * 1000, i);
+        n += sprintf(b + n, "variant/%d/index.m3u8\n", i);
+    }
+    *size = n;
+    return b;
+}
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void bench_playlist(const char* name, const char* data, int size)
+{
+    uint8_t        chunk[BENCH_READ_SIZE];
+    bench_result_t r;
+    double         best = 0;
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        hls_parse_t parser;
+        memset(&r, 0, sizeof(r));
+        if (hls_parse_init(&parser) != 0) {
+            return;
+        }
+        double start = now_us();
+        int    pos = 0;
+        while (pos < size) {
+            // Mimic http_stream which reads into its own writable buffer
+            int s = size - pos > BENCH_READ_SIZE ? BENCH_READ_SIZE : size - pos;
+            memcpy(chunk, data + pos, s);
+            pos += s;
+            hls_parse_add_buffer(&parser, chunk, s, pos == size);
+            hls_parse(&parser, bench_tag_cb, &r);
+        }
+        double cost = now_us() - start;
+        hls_parse_deinit(&parser);
+        if (round == 0 || cost < best) {
+            best = cost;
+        }
+    }
+    printf("%-24s %8d bytes  %6d tags  %7d attrs  %6d uris  duration:%.3f  bandwidth:%llu\n",
+           name, size, r.tags, r.attrs, r.uris, r.duration, (unsigned long long) r.bandwidth);
+    printf("%-24s %8.1f us  %8.2f MB/s  %6.1f ns/tag\n", "", best, size / best, best * 1000 / r.tags);
+}
+
+static char* read_fixture(const char* f, int* size)
+{
+    FILE* fp = fopen(f, "rb");
+    if (fp == NULL) {
+        return NULL;
+    }
+    fseek(fp, 0, SEEK_END);
+    *size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    char* b = malloc(*size);
+    if (b) {
+        *size = fread(b, 1, *size, fp);
+    }
+    fclose(fp);
+    return b;
+}
+
+int main(int argc, char** argv)
+{
+    int   size = 0;
+    char* data;
+    if (argc >= 2) {
+        // Benchmark user provided playlists
+        for (int i = 1; i < argc; i++) {
+            data = read_fixture(argv[i], &size);
+            if (data == NULL) {
+                printf("File %s not exists\n", argv[i]);
+                continue;
+            }
+            bench_playlist(argv[i], data, size);
+            free(data);
+        }
+        return 0;
+    }
+    int segments[] = { 100, 1000, 5000 };
+    for (int i = 0; i < sizeof(segments) / sizeof(segments[0]); i++) {
+        char name[32];
+        data = gen_media_playlist(segments[i], &size);
+        snprintf(name, sizeof(name), "media_%d_segments", segments[i]);
+        bench_playlist(name, data, size);
+        free(data);
+    }
+    data = gen_master_playlist(500, &size);
+    bench_playlist("master_500_variants", data, size);
+    free(data);
+    return 0;
+}
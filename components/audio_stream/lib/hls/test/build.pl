@@ -2,6 +2,7 @@
 my @f = <../*.c>;
 gen_fake_header();
 `gcc @f test.c -I../include -I../ -g -o ./test`;
+`gcc @f bench.c -I../include -I../ -O2 -o ./bench`;
 clear_up();
 
 sub clear_up {
@@ -19,6 +20,10 @@ sub gen_fake_header {
 #define audio_strdup  strdup
 #define audio_calloc  calloc
 #define audio_realloc realloc
+#define AUDIO_MEM_CAPS_DEFAULT            0
+#define audio_mem_alloc(s, caps, owner)      malloc(s)
+#define audio_mem_calloc(n, s, caps, owner)  calloc(n, s)
+#define audio_mem_strdup(s, caps, owner)     strdup(s)
 MEM_H
 
     my $audio_error =<< 'ERROR_H';
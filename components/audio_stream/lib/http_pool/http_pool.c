@@ -0,0 +1,211 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include "http_pool.h"
+
+int http_pool_key(const char *url, char *key, int size)
+{
+    const char *scheme;
+    const char *host;
+    int port;
+    if (url == NULL || key == NULL) {
+        return -1;
+    }
+    if (strncasecmp(url, "http://", 7) == 0) {
+        scheme = "http";
+        host = url + 7;
+        port = 80;
+    } else if (strncasecmp(url, "https://", 8) == 0) {
+        scheme = "https";
+        host = url + 8;
+        port = 443;
+    } else {
+        return -1;
+    }
+    const char *end = host + strcspn(host, "/?#");
+    // User info does not select another connection
+    for (const char *p = end; p > host; p--) {
+        if (p[-1] == '@') {
+            host = p;
+            break;
+        }
+    }
+    const char *p = host;
+    if (*p == '[') {
+        // IPv6 literal, the port follows the closing bracket
+        p = memchr(host, ']', end - host);
+        if (p == NULL) {
+            return -1;
+        }
+    }
+    p = memchr(p, ':', end - p);
+    if (p) {
+        char *num_end = NULL;
+        port = strtol(p + 1, &num_end, 10);
+        if (num_end == p + 1 || num_end != end || port <= 0 || port > 65535) {
+            return -1;
+        }
+        end = p;
+    }
+    if (end == host) {
+        return -1;
+    }
+    int len = snprintf(key, size, "%s://%.*s:%d", scheme, (int)(end - host), host, port);
+    if (len < 0 || len >= size) {
+        return -1;
+    }
+    for (char *k = key; *k; k++) {
+        *k = tolower((unsigned char)*k);
+    }
+    return len;
+}
+
+int http_pool_init(http_pool_t *pool, const http_pool_cfg_t *cfg)
+{
+    if (pool == NULL || cfg == NULL || cfg->close == NULL || cfg->size <= 0 || cfg->size > HTTP_POOL_MAX_CONN) {
+        return -1;
+    }
+    memset(pool, 0, sizeof(http_pool_t));
+    pool->cfg = *cfg;
+    return 0;
+}
+
+static void http_pool_close(http_pool_t *pool, http_pool_entry_t *entry)
+{
+    if (entry->conn) {
+        pool->cfg.close(entry->conn, pool->cfg.ctx);
+        entry->conn = NULL;
+    }
+}
+
+static void http_pool_clear(http_pool_t *pool, http_pool_entry_t *entry)
+{
+    http_pool_close(pool, entry);
+    if (entry->session && pool->cfg.free_session) {
+        pool->cfg.free_session(entry->session, pool->cfg.ctx);
+    }
+    entry->session = NULL;
+    entry->key[0] = '\0';
+}
+
+void http_pool_expire(http_pool_t *pool, uint32_t now)
+{
+    if (pool == NULL || pool->cfg.idle_ms == 0) {
+        return;
+    }
+    for (int i = 0; i < pool->cfg.size; i++) {
+        http_pool_entry_t *entry = &pool->entry[i];
+        if (entry->busy == false && entry->conn && (uint32_t)(now - entry->last_used) >= pool->cfg.idle_ms) {
+            // The session is kept, it still saves a full handshake on the next connection
+            http_pool_close(pool, entry);
+            pool->stats.expire++;
+        }
+    }
+}
+
+http_pool_entry_t *http_pool_acquire(http_pool_t *pool, const char *url, uint32_t now)
+{
+    char key[HTTP_POOL_KEY_LEN];
+    if (pool == NULL || http_pool_key(url, key, sizeof(key)) < 0) {
+        return NULL;
+    }
+    http_pool_expire(pool, now);
+    http_pool_entry_t *found = NULL;
+    http_pool_entry_t *empty = NULL;
+    http_pool_entry_t *lru = NULL;
+    for (int i = 0; i < pool->cfg.size; i++) {
+        http_pool_entry_t *entry = &pool->entry[i];
+        if (entry->busy) {
+            continue;
+        }
+        if (entry->key[0] == '\0') {
+            if (empty == NULL) {
+                empty = entry;
+            }
+        } else if (strcmp(entry->key, key) == 0) {
+            found = entry;
+            break;
+        } else if (lru == NULL || (uint32_t)(now - entry->last_used) > (uint32_t)(now - lru->last_used)) {
+            lru = entry;
+        }
+    }
+    if (found == NULL) {
+        found = empty ? empty : lru;
+        if (found == NULL) {
+            return NULL;
+        }
+        if (found == lru) {
+            http_pool_clear(pool, found);
+            pool->stats.evict++;
+        }
+        strcpy(found->key, key);
+    }
+    if (found->conn) {
+        pool->stats.hit++;
+    } else {
+        pool->stats.miss++;
+    }
+    found->busy = true;
+    return found;
+}
+
+void http_pool_release(http_pool_t *pool, http_pool_entry_t *entry, bool keep, uint32_t now)
+{
+    if (pool == NULL || entry == NULL || entry->busy == false) {
+        return;
+    }
+    if (keep == false && entry->conn) {
+        http_pool_close(pool, entry);
+        pool->stats.drop++;
+    }
+    entry->busy = false;
+    entry->last_used = now;
+}
+
+void http_pool_flush(http_pool_t *pool)
+{
+    if (pool == NULL || pool->cfg.close == NULL) {
+        return;
+    }
+    for (int i = 0; i < pool->cfg.size; i++) {
+        if (pool->entry[i].busy == false) {
+            http_pool_clear(pool, &pool->entry[i]);
+        }
+    }
+}
+
+void http_pool_deinit(http_pool_t *pool)
+{
+    if (pool == NULL || pool->cfg.close == NULL) {
+        return;
+    }
+    for (int i = 0; i < HTTP_POOL_MAX_CONN; i++) {
+        http_pool_clear(pool, &pool->entry[i]);
+        pool->entry[i].busy = false;
+    }
+}
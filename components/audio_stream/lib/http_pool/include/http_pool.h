@@ -0,0 +1,147 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _HTTP_POOL_H_
+#define _HTTP_POOL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HTTP_POOL_MAX_CONN     (4)
+#define HTTP_POOL_KEY_LEN      (80)
+
+/**
+ * @brief Configuration of the connection pool
+ */
+typedef struct {
+    void     (*close)(void *conn, void *ctx);          /*!< Close and free a pooled connection */
+    void     (*free_session)(void *session, void *ctx); /*!< Free a saved TLS session, NULL if no session is saved */
+    void     *ctx;                                     /*!< Context of the callbacks */
+    int      size;                                     /*!< Number of hosts kept, in use ones included (1 - HTTP_POOL_MAX_CONN) */
+    uint32_t idle_ms;                                  /*!< Idle connections older than this are closed, 0 to keep them */
+} http_pool_cfg_t;
+
+/**
+ * @brief Pool entry of one host
+ *        After `http_pool_acquire` the caller reuses `conn` when set, otherwise it connects (resuming `session` when set)
+ *        and stores the new connection into `conn`
+ */
+typedef struct {
+    char     key[HTTP_POOL_KEY_LEN]; /*!< Normalized "scheme://host:port" */
+    void     *conn;                  /*!< Connection to the host, NULL when closed */
+    void     *session;               /*!< Saved TLS session of the host, kept after the connection is closed */
+    uint32_t last_used;              /*!< Release time in ms */
+    bool     busy;                   /*!< Acquired and not released yet */
+} http_pool_entry_t;
+
+/**
+ * @brief Pool statistics
+ */
+typedef struct {
+    int hit;      /*!< Acquired with an open connection */
+    int miss;     /*!< Acquired without an open connection */
+    int evict;    /*!< Hosts dropped to make room for another host */
+    int expire;   /*!< Idle connections closed by timeout */
+    int drop;     /*!< Connections closed on release as not reusable */
+} http_pool_stats_t;
+
+/**
+ * @brief Connection pool keyed by host
+ */
+typedef struct {
+    http_pool_cfg_t    cfg;
+    http_pool_entry_t  entry[HTTP_POOL_MAX_CONN];
+    http_pool_stats_t  stats;
+} http_pool_t;
+
+/**
+ * @brief         Get the pool key of an URL
+ *                Scheme and host are lower cased and the default port is added, user info is dropped
+ * @param         url: Absolute http or https URL
+ * @param         key: Buffer for the key
+ * @param         size: Size of the buffer
+ * @return        > 0: Length of the key
+ *                -1: Not an absolute http or https URL or the key does not fit
+ */
+int http_pool_key(const char *url, char *key, int size);
+
+/**
+ * @brief         Initialize the pool
+ * @param         pool: Pool to initialize
+ * @param         cfg: Configuration of the pool
+ * @return        0: On success
+ *                -1: Input parameter wrong
+ */
+int http_pool_init(http_pool_t *pool, const http_pool_cfg_t *cfg);
+
+/**
+ * @brief         Acquire the entry of the host of an URL
+ *                Idle connections older than the idle time are closed first
+ *                When the host is not in the pool the least recently used idle host is dropped to make room
+ * @param         pool: Connection pool
+ * @param         url: URL to request
+ * @param         now: Current time in ms
+ * @return        NULL: Wrong URL or all entries are in use
+ *                Others: Entry marked in use
+ */
+http_pool_entry_t *http_pool_acquire(http_pool_t *pool, const char *url, uint32_t now);
+
+/**
+ * @brief         Release an entry acquired by `http_pool_acquire`
+ * @param         pool: Connection pool
+ * @param         entry: Entry to release
+ * @param         keep: Keep the connection open for the next request to the host,
+ *                      set to false when the response was not read completely or the peer closed it
+ * @param         now: Current time in ms
+ */
+void http_pool_release(http_pool_t *pool, http_pool_entry_t *entry, bool keep, uint32_t now);
+
+/**
+ * @brief         Close the idle connections older than the idle time
+ * @param         pool: Connection pool
+ * @param         now: Current time in ms
+ */
+void http_pool_expire(http_pool_t *pool, uint32_t now);
+
+/**
+ * @brief         Close the idle connections and free their saved sessions, e.g. when the trusted certificate changes
+ *                Entries in use are left to their owner
+ * @param         pool: Connection pool
+ */
+void http_pool_flush(http_pool_t *pool);
+
+/**
+ * @brief         Close all connections and free the saved sessions
+ * @param         pool: Connection pool
+ */
+void http_pool_deinit(http_pool_t *pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,287 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <openssl/ssl.h>
+#include "http_pool.h"
+
+#define BENCH_HTTP_PORT     (18080)
+#define BENCH_HTTPS_PORT    (18443)
+#define BENCH_SEGMENTS      (40)
+
+typedef struct {
+    int  fd;
+    SSL *ssl;
+} bench_conn_t;
+
+typedef struct {
+    int    connects;
+    int    tls_full;
+    int    tls_resumed;
+    double ttfb_us;
+    double total_us;
+} bench_result_t;
+
+static SSL_CTX *ssl_ctx;
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void conn_close(void *conn, void *ctx)
+{
+    bench_conn_t *c = (bench_conn_t *)conn;
+    if (c->ssl) {
+        SSL_shutdown(c->ssl);
+        SSL_free(c->ssl);
+    }
+    close(c->fd);
+    free(c);
+}
+
+static void session_free(void *session, void *ctx)
+{
+    SSL_SESSION_free((SSL_SESSION *)session);
+}
+
+static bench_conn_t *conn_open(int port, bool tls, SSL_SESSION *session, bench_result_t *res)
+{
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(port) };
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    bench_conn_t *c = calloc(1, sizeof(bench_conn_t));
+    c->fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(c->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(c->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(c->fd);
+        free(c);
+        return NULL;
+    }
+    res->connects++;
+    if (tls) {
+        c->ssl = SSL_new(ssl_ctx);
+        SSL_set_fd(c->ssl, c->fd);
+        SSL_set_tlsext_host_name(c->ssl, "localhost");
+        if (session) {
+            SSL_set_session(c->ssl, session);
+        }
+        if (SSL_connect(c->ssl) != 1) {
+            conn_close(c, NULL);
+            return NULL;
+        }
+        if (SSL_session_reused(c->ssl)) {
+            res->tls_resumed++;
+        } else {
+            res->tls_full++;
+        }
+    }
+    return c;
+}
+
+static int conn_io(bench_conn_t *c, void *buf, int len, bool wr)
+{
+    if (c->ssl) {
+        return wr ? SSL_write(c->ssl, buf, len) : SSL_read(c->ssl, buf, len);
+    }
+    return wr ? send(c->fd, buf, len, 0) : recv(c->fd, buf, len, 0);
+}
+
+// GET one segment and read the whole response, returns 1 when the connection can be kept
+// Time to first byte counts from `start`, connecting included
+static int conn_get(bench_conn_t *c, const char *path, double start, bench_result_t *res)
+{
+    char buf[4096];
+    int len = snprintf(buf, sizeof(buf), "GET %s HTTP/1.1\r\nHost: localhost\r\n\r\n", path);
+    if (conn_io(c, buf, len, true) != len) {
+        return -1;
+    }
+    int filled = 0;
+    char *body = NULL;
+    while (body == NULL) {
+        int n = conn_io(c, buf + filled, sizeof(buf) - 1 - filled, false);
+        if (n <= 0) {
+            return -1;
+        }
+        if (filled == 0) {
+            res->ttfb_us += now_us() - start;
+        }
+        filled += n;
+        buf[filled] = '\0';
+        body = strstr(buf, "\r\n\r\n");
+    }
+    body += 4;
+    char *cl = strcasestr(buf, "Content-Length:");
+    int keep = strcasestr(buf, "Connection: close") == NULL;
+    int remain = (cl ? atoi(cl + 15) : 0) - (filled - (body - buf));
+    while (remain > 0) {
+        int n = conn_io(c, buf, remain < sizeof(buf) ? remain : sizeof(buf), false);
+        if (n <= 0) {
+            return -1;
+        }
+        remain -= n;
+    }
+    return keep;
+}
+
+// Old behaviour: one connection per segment, no session kept
+static int run_direct(bool tls, const char *path, bench_result_t *res)
+{
+    double start = now_us();
+    for (int i = 0; i < BENCH_SEGMENTS; i++) {
+        double t = now_us();
+        bench_conn_t *c = conn_open(tls ? BENCH_HTTPS_PORT : BENCH_HTTP_PORT, tls, NULL, res);
+        if (c == NULL || conn_get(c, path, t, res) < 0) {
+            return -1;
+        }
+        conn_close(c, NULL);
+    }
+    res->total_us = now_us() - start;
+    return 0;
+}
+
+static int run_pool(bool tls, const char *path, bench_result_t *res)
+{
+    http_pool_t pool;
+    http_pool_cfg_t cfg = {
+        .close = conn_close,
+        .free_session = session_free,
+        .size = 2,
+        .idle_ms = 15000,
+    };
+    char url[64];
+    snprintf(url, sizeof(url), "%s://localhost:%d%s", tls ? "https" : "http", tls ? BENCH_HTTPS_PORT : BENCH_HTTP_PORT, path);
+    http_pool_init(&pool, &cfg);
+    double start = now_us();
+    for (int i = 0; i < BENCH_SEGMENTS; i++) {
+        double t = now_us();
+        uint32_t now = (t - start) / 1000;
+        http_pool_entry_t *e = http_pool_acquire(&pool, url, now);
+        if (e->conn == NULL) {
+            e->conn = conn_open(tls ? BENCH_HTTPS_PORT : BENCH_HTTP_PORT, tls, e->session, res);
+        }
+        int keep = e->conn ? conn_get(e->conn, path, t, res) : -1;
+        if (keep < 0) {
+            return -1;
+        }
+        bench_conn_t *c = e->conn;
+        if (c->ssl) {
+            // Tickets arrive after the handshake, keep the newest one of the host
+            SSL_SESSION *s = SSL_get1_session(c->ssl);
+            if (s) {
+                if (e->session) {
+                    SSL_SESSION_free(e->session);
+                }
+                e->session = s;
+            }
+        }
+        http_pool_release(&pool, e, keep, now);
+    }
+    res->total_us = now_us() - start;
+    http_pool_deinit(&pool);
+    return 0;
+}
+
+static void report(const char *name, bench_result_t *res)
+{
+    printf("%-32s connects %3d  tls full %3d  resumed %3d  ttfb %7.1f us  %8.0f us/segment\n", name, res->connects,
+           res->tls_full, res->tls_resumed, res->ttfb_us / BENCH_SEGMENTS, res->total_us / BENCH_SEGMENTS);
+}
+
+static pid_t start_server(void)
+{
+    pid_t pid = fork();
+    if (pid == 0) {
+        char http_port[8], https_port[8];
+        snprintf(http_port, sizeof(http_port), "%d", BENCH_HTTP_PORT);
+        snprintf(https_port, sizeof(https_port), "%d", BENCH_HTTPS_PORT);
+        execlp("python3", "python3", "server.py", http_port, https_port, "fixture/cert.pem", "fixture/key.pem", NULL);
+        _exit(1);
+    }
+    // Wait for both ports
+    for (int i = 0; i < 100; i++) {
+        bench_result_t res = { 0 };
+        bench_conn_t *c = conn_open(BENCH_HTTPS_PORT, false, NULL, &res);
+        if (c) {
+            conn_close(c, NULL);
+            return pid;
+        }
+        usleep(50000);
+    }
+    kill(pid, SIGTERM);
+    return -1;
+}
+
+int main(void)
+{
+    signal(SIGPIPE, SIG_IGN);
+    ssl_ctx = SSL_CTX_new(TLS_client_method());
+    SSL_CTX_load_verify_locations(ssl_ctx, "fixture/cert.pem", NULL);
+    SSL_CTX_set_verify(ssl_ctx, SSL_VERIFY_PEER, NULL);
+    SSL_CTX_set_session_cache_mode(ssl_ctx, SSL_SESS_CACHE_CLIENT);
+    pid_t server = start_server();
+    if (server < 0) {
+        printf("Fail to start server.py, run build.pl first\n");
+        return 1;
+    }
+    static const struct {
+        const char *name;
+        bool        pool;
+        bool        tls;
+        const char *path;
+    } runs[] = {
+        { "http  connection per segment", false, false, "/seg/1" },
+        { "http  pool", true, false, "/seg/1" },
+        { "https connection per segment", false, true, "/seg/1" },
+        { "https pool", true, true, "/seg/1" },
+        { "https pool, server closes", true, true, "/close/seg/1" },
+    };
+    int ret = 0;
+    for (int i = 0; i < sizeof(runs) / sizeof(runs[0]); i++) {
+        bench_result_t res = { 0 };
+        if ((runs[i].pool ? run_pool : run_direct)(runs[i].tls, runs[i].path, &res) != 0) {
+            printf("%s failed\n", runs[i].name);
+            ret = 1;
+            break;
+        }
+        report(runs[i].name, &res);
+    }
+    kill(server, SIGTERM);
+    waitpid(server, NULL, 0);
+    SSL_CTX_free(ssl_ctx);
+    return ret;
+}
@@ -0,0 +1,9 @@
+#!/usr/bin/perl
+# Host test of the connection pool, and a benchmark against the stand-in server.py over HTTP and HTTPS
+use File::Path qw(make_path);
+make_path("fixture");
+unless (-e "fixture/cert.pem") {
+    `openssl req -x509 -newkey rsa:2048 -nodes -subj /CN=localhost -addext subjectAltName=DNS:localhost -days 365 -keyout fixture/key.pem -out fixture/cert.pem 2>/dev/null`;
+}
+`gcc ../http_pool.c test.c -I../include -g -Wall -o ./test`;
+`gcc ../http_pool.c bench.c -I../include -O2 -Wall -o ./bench -lssl -lcrypto`;
@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+# Stand-in HTTP and HTTPS server for the connection pool benchmark
+# GET /seg/<n> answers a segment on a kept alive connection, /close/seg/<n> closes the connection after the answer
+# Usage: server.py <http_port> <https_port> <cert.pem> <key.pem>
+
+import http.server
+import socket
+import socketserver
+import ssl
+import sys
+import threading
+
+SEGMENT = bytes(range(256)) * 128
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+
+    def setup(self):
+        # Headers and body go out in separate writes, do not let Nagle hold the body
+        self.request.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        super().setup()
+
+    def do_GET(self):
+        close = self.path.startswith('/close/')
+        self.send_response(200)
+        self.send_header('Content-Type', 'video/MP2T')
+        self.send_header('Content-Length', str(len(SEGMENT)))
+        if close:
+            self.send_header('Connection', 'close')
+            self.close_connection = True
+        self.end_headers()
+        self.wfile.write(SEGMENT)
+
+    def log_message(self, format, *args):
+        pass
+
+class Server(socketserver.ThreadingMixIn, http.server.HTTPServer):
+    daemon_threads = True
+    allow_reuse_address = True
+
+def main():
+    http_port, https_port, cert, key = int(sys.argv[1]), int(sys.argv[2]), sys.argv[3], sys.argv[4]
+    plain = Server(('127.0.0.1', http_port), Handler)
+    secure = Server(('127.0.0.1', https_port), Handler)
+    ctx = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+    ctx.load_cert_chain(cert, key)
+    secure.socket = ctx.wrap_socket(secure.socket, server_side=True)
+    threading.Thread(target=plain.serve_forever, daemon=True).start()
+    secure.serve_forever()
+
+if __name__ == '__main__':
+    main()
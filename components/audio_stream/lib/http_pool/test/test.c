@@ -0,0 +1,215 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "http_pool.h"
+
+#define TEST_ASSERT(cond, ...) if (!(cond)) {   \
+        printf("FAIL line %d: ", __LINE__);     \
+        printf(__VA_ARGS__);                    \
+        printf("\n");                           \
+        return -1;                              \
+    }
+
+static int closed;
+static int freed;
+
+static void mock_close(void *conn, void *ctx)
+{
+    closed++;
+    free(conn);
+}
+
+static void mock_free_session(void *session, void *ctx)
+{
+    freed++;
+    free(session);
+}
+
+static int test_key(void)
+{
+    static const char *cases[][2] = {
+        { "http://Example.COM/a/b.mp3", "http://example.com:80" },
+        { "HTTP://example.com:80", "http://example.com:80" },
+        { "https://example.com?x=1", "https://example.com:443" },
+        { "https://user:pw@cdn.example.com:8443/seg.ts", "https://cdn.example.com:8443" },
+        { "http://[fe80::1]:8080/live.m3u8", "http://[fe80::1]:8080" },
+        { "http://[fe80::1]/live.m3u8", "http://[fe80::1]:80" },
+        { "http://192.168.1.2#frag", "http://192.168.1.2:80" },
+    };
+    char key[HTTP_POOL_KEY_LEN];
+    for (int i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        int len = http_pool_key(cases[i][0], key, sizeof(key));
+        TEST_ASSERT(len > 0 && strcmp(key, cases[i][1]) == 0, "%s -> %s", cases[i][0], len > 0 ? key : "error");
+        TEST_ASSERT(len == strlen(key), "length");
+    }
+    static const char *bad[] = {
+        "ftp://example.com/", "example.com/a", "http:///a", "http://host:/a", "http://host:99999/",
+        "http://host:80x/", "http://[fe80::1/", NULL,
+    };
+    for (int i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        TEST_ASSERT(http_pool_key(bad[i], key, sizeof(key)) == -1, "%s accepted", bad[i] ? bad[i] : "NULL");
+    }
+    TEST_ASSERT(http_pool_key("http://example.com/", key, 10) == -1, "key overflow");
+    return 0;
+}
+
+static int test_reuse(void)
+{
+    http_pool_t pool;
+    http_pool_cfg_t cfg = {
+        .close = mock_close,
+        .free_session = mock_free_session,
+        .size = 2,
+        .idle_ms = 1000,
+    };
+    closed = freed = 0;
+    TEST_ASSERT(http_pool_init(&pool, &cfg) == 0, "init");
+
+    // Playlist host, then segments on a CDN, then the playlist again
+    http_pool_entry_t *e = http_pool_acquire(&pool, "http://radio.example.com/live.m3u8", 0);
+    TEST_ASSERT(e && e->conn == NULL && e->busy, "first acquire");
+    e->conn = malloc(1);
+    http_pool_release(&pool, e, true, 10);
+    for (int i = 0; i < 5; i++) {
+        e = http_pool_acquire(&pool, "https://cdn.example.com/seg.ts", 100 + i * 100);
+        TEST_ASSERT(e, "cdn acquire");
+        if (i == 0) {
+            TEST_ASSERT(e->conn == NULL, "cdn first connect");
+            e->conn = malloc(1);
+            e->session = malloc(1);
+        } else {
+            TEST_ASSERT(e->conn, "cdn reuse %d", i);
+        }
+        http_pool_release(&pool, e, true, 150 + i * 100);
+    }
+    e = http_pool_acquire(&pool, "HTTP://RADIO.example.com:80/live.m3u8", 600);
+    TEST_ASSERT(e && e->conn, "playlist host reuse");
+    // Busy entries are never handed out twice
+    http_pool_entry_t *cdn = http_pool_acquire(&pool, "https://cdn.example.com/seg2.ts", 610);
+    TEST_ASSERT(cdn && cdn != e && cdn->conn, "cdn while playlist busy");
+    TEST_ASSERT(http_pool_acquire(&pool, "http://third.example.com/", 620) == NULL, "all busy");
+    TEST_ASSERT(pool.stats.hit == 6 && pool.stats.miss == 2, "hit %d miss %d", pool.stats.hit, pool.stats.miss);
+
+    // Incomplete response, the connection can not be reused but the TLS session is kept
+    http_pool_release(&pool, cdn, false, 700);
+    TEST_ASSERT(closed == 1 && cdn->conn == NULL && cdn->session && pool.stats.drop == 1, "drop");
+    cdn = http_pool_acquire(&pool, "https://cdn.example.com/seg3.ts", 710);
+    TEST_ASSERT(cdn->conn == NULL && cdn->session, "reconnect with the session");
+    cdn->conn = malloc(1);
+    http_pool_release(&pool, cdn, true, 720);
+    http_pool_release(&pool, e, true, 730);
+
+    // Third host evicts the least recently used one, the CDN
+    e = http_pool_acquire(&pool, "http://third.example.com/", 800);
+    TEST_ASSERT(e == cdn && e->conn == NULL && e->session == NULL, "evict lru");
+    TEST_ASSERT(closed == 2 && freed == 1 && pool.stats.evict == 1, "evict closed %d freed %d", closed, freed);
+    e->conn = malloc(1);
+    http_pool_release(&pool, e, true, 800);
+
+    // Idle timeout closes the playlist connection only
+    http_pool_expire(&pool, 1750);
+    TEST_ASSERT(closed == 3 && pool.stats.expire == 1, "expire closed %d", closed);
+    e = http_pool_acquire(&pool, "http://radio.example.com/live.m3u8", 1760);
+    TEST_ASSERT(e && e->conn == NULL && strcmp(e->key, "http://radio.example.com:80") == 0, "expired host");
+    http_pool_release(&pool, e, true, 1760);
+    e = http_pool_acquire(&pool, "http://third.example.com/", 1770);
+    TEST_ASSERT(e && e->conn, "third kept");
+    http_pool_release(&pool, e, true, 1770);
+
+    // Release twice is ignored
+    http_pool_release(&pool, e, false, 1780);
+    TEST_ASSERT(e->conn, "double release");
+    http_pool_deinit(&pool);
+    TEST_ASSERT(closed == 4 && freed == 1, "deinit closed %d freed %d", closed, freed);
+    return 0;
+}
+
+static int test_flush(void)
+{
+    http_pool_t pool;
+    http_pool_cfg_t cfg = {
+        .close = mock_close,
+        .free_session = mock_free_session,
+        .size = 2,
+    };
+    closed = freed = 0;
+    TEST_ASSERT(http_pool_init(&pool, &cfg) == 0, "init");
+    http_pool_entry_t *idle = http_pool_acquire(&pool, "https://cdn.example.com/seg.ts", 0);
+    idle->conn = malloc(1);
+    idle->session = malloc(1);
+    http_pool_release(&pool, idle, true, 10);
+    http_pool_entry_t *busy = http_pool_acquire(&pool, "https://radio.example.com/live.m3u8", 20);
+    busy->conn = malloc(1);
+
+    // Only the idle host is dropped, session included
+    http_pool_flush(&pool);
+    TEST_ASSERT(closed == 1 && freed == 1 && idle->conn == NULL && idle->session == NULL, "flush closed %d freed %d", closed, freed);
+    TEST_ASSERT(busy->busy && busy->conn, "busy kept");
+    idle = http_pool_acquire(&pool, "https://cdn.example.com/seg2.ts", 30);
+    TEST_ASSERT(idle && idle->conn == NULL && idle->session == NULL, "flushed host reconnects");
+    http_pool_release(&pool, idle, false, 40);
+    http_pool_release(&pool, busy, true, 40);
+    http_pool_deinit(&pool);
+    TEST_ASSERT(closed == 2, "deinit closed %d", closed);
+    return 0;
+}
+
+static int test_args(void)
+{
+    http_pool_t pool;
+    http_pool_cfg_t cfg = { .close = mock_close, .size = 0 };
+    TEST_ASSERT(http_pool_init(&pool, &cfg) == -1, "size 0");
+    cfg.size = HTTP_POOL_MAX_CONN + 1;
+    TEST_ASSERT(http_pool_init(&pool, &cfg) == -1, "size over");
+    cfg.size = 1;
+    cfg.close = NULL;
+    TEST_ASSERT(http_pool_init(&pool, &cfg) == -1, "no close");
+    cfg.close = mock_close;
+    TEST_ASSERT(http_pool_init(&pool, &cfg) == 0, "init");
+    TEST_ASSERT(http_pool_acquire(&pool, "rtsp://host/", 0) == NULL, "wrong scheme");
+    TEST_ASSERT(http_pool_acquire(NULL, "http://host/", 0) == NULL, "null pool");
+    // Time wraps around
+    http_pool_entry_t *e = http_pool_acquire(&pool, "http://host/", 0xFFFFFF00);
+    e->conn = malloc(1);
+    http_pool_release(&pool, e, true, 0xFFFFFF00);
+    pool.cfg.idle_ms = 0x200;
+    e = http_pool_acquire(&pool, "http://host/", 0x80);
+    TEST_ASSERT(e->conn, "wrap kept");
+    http_pool_release(&pool, e, true, 0x80);
+    http_pool_deinit(&pool);
+    memset(&pool, 0, sizeof(pool));
+    http_pool_deinit(&pool);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (test_key() || test_reuse() || test_flush() || test_args()) {
+        return 1;
+    }
+    printf("http_pool: all tests passed\n");
+    return 0;
+}
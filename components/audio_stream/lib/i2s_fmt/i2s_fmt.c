@@ -0,0 +1,197 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <string.h>
+#include "i2s_fmt.h"
+
+// Each kernel is specialized on its flags at compile time, so the per sample work is a handful of
+// word operations without branches. The DAC scaling keeps the highest 8 bits and flips the sign bit,
+// which is the same as adding the unsigned bias.
+
+static inline __attribute__((always_inline)) uint32_t op16(uint32_t w, bool swap, bool dac)
+{
+    if (swap) {
+        w = (w >> 16) | (w << 16);
+    }
+    if (dac) {
+        w = (w & 0xFF00FF00u) ^ 0x80008000u;
+    }
+    return w;
+}
+
+static inline __attribute__((always_inline)) int in_place16(uint8_t *buf, int bytes, bool swap, bool dac)
+{
+    int n = bytes >> 2;
+    #pragma GCC unroll 4
+    for (int i = 0; i < n; i++) {
+        uint32_t w;
+        memcpy(&w, buf + (i << 2), sizeof(w));
+        w = op16(w, swap, dac);
+        memcpy(buf + (i << 2), &w, sizeof(w));
+    }
+    return bytes;
+}
+
+static inline __attribute__((always_inline)) int in_place32(uint8_t *buf, int bytes, bool swap, bool dac)
+{
+    uint32_t *s = (uint32_t *)buf;
+    int k = bytes >> 2;
+    for (int i = 0; i < k; i += 4) {
+        int m = k - i < 4 ? k - i : 4;
+        uint32_t v[4];
+        memcpy(v, s + i, m << 2);
+        if (swap && m >= 2) {
+            uint32_t t = v[0];
+            v[0] = v[1];
+            v[1] = t;
+        }
+        if (dac) {
+            for (int j = 0; j < m; j++) {
+                v[j] = (v[j] & 0xFF000000u) ^ 0x80000000u;
+            }
+        }
+        memcpy(s + i, v, m << 2);
+    }
+    return bytes;
+}
+
+// 16 bit to 32 bit, one word holds two samples which become the upper halves of two output words
+static inline __attribute__((always_inline)) int expand16to32(uint8_t *dst, const uint8_t *src, int bytes, bool swap, bool dac)
+{
+    int n = bytes >> 2;
+    #pragma GCC unroll 4
+    for (int i = 0; i < n; i++) {
+        uint32_t w, o[2];
+        memcpy(&w, src + (i << 2), sizeof(w));
+        w = op16(w, swap, dac);
+        o[0] = w << 16;
+        o[1] = w & 0xFFFF0000u;
+        memcpy(dst + (i << 3), o, sizeof(o));
+    }
+    return bytes << 1;
+}
+
+#define DEFINE_KERNEL(name, call) \
+    static int name(void *dst, const void *src, int bytes) \
+    { \
+        (void)dst; \
+        return call; \
+    }
+
+DEFINE_KERNEL(fmt16_swap, in_place16((uint8_t *)src, bytes, true, false))
+DEFINE_KERNEL(fmt16_dac, in_place16((uint8_t *)src, bytes, false, true))
+DEFINE_KERNEL(fmt16_swap_dac, in_place16((uint8_t *)src, bytes, true, true))
+DEFINE_KERNEL(fmt32_swap, in_place32((uint8_t *)src, bytes, true, false))
+DEFINE_KERNEL(fmt32_dac, in_place32((uint8_t *)src, bytes, false, true))
+DEFINE_KERNEL(fmt32_swap_dac, in_place32((uint8_t *)src, bytes, true, true))
+DEFINE_KERNEL(expand16to32_plain, expand16to32(dst, src, bytes, false, false))
+DEFINE_KERNEL(expand16to32_swap, expand16to32(dst, src, bytes, true, false))
+DEFINE_KERNEL(expand16to32_dac, expand16to32(dst, src, bytes, false, true))
+DEFINE_KERNEL(expand16to32_swap_dac, expand16to32(dst, src, bytes, true, true))
+
+// Other widths, laid out as i2s_write_expand does: source bytes on top, zero bytes below
+static int expand_generic(void *dst, const void *src, int bytes, int src_bytes, int dst_bytes)
+{
+    uint8_t *d = (uint8_t *)dst;
+    const uint8_t *s = (const uint8_t *)src;
+    int zero = dst_bytes - src_bytes;
+    int n = bytes / src_bytes;
+    for (int i = 0; i < n; i++) {
+        memset(d, 0, zero);
+        memcpy(d + zero, s, src_bytes);
+        d += dst_bytes;
+        s += src_bytes;
+    }
+    return n * dst_bytes;
+}
+
+DEFINE_KERNEL(expand8to16, expand_generic(dst, src, bytes, 1, 2))
+DEFINE_KERNEL(expand8to24, expand_generic(dst, src, bytes, 1, 3))
+DEFINE_KERNEL(expand8to32, expand_generic(dst, src, bytes, 1, 4))
+DEFINE_KERNEL(expand16to24, expand_generic(dst, src, bytes, 2, 3))
+DEFINE_KERNEL(expand24to32, expand_generic(dst, src, bytes, 3, 4))
+
+static i2s_fmt_func_t pick_in_place(int bits, bool swap, bool dac)
+{
+    static const i2s_fmt_func_t k16[4] = { NULL, fmt16_swap, fmt16_dac, fmt16_swap_dac };
+    static const i2s_fmt_func_t k32[4] = { NULL, fmt32_swap, fmt32_dac, fmt32_swap_dac };
+    int idx = (swap ? 1 : 0) | (dac ? 2 : 0);
+    return bits == 16 ? k16[idx] : k32[idx];
+}
+
+static i2s_fmt_func_t pick_expand(int src_bits, int dst_bits)
+{
+    switch ((src_bits << 8) | dst_bits) {
+        case (8 << 8) | 16:
+            return expand8to16;
+        case (8 << 8) | 24:
+            return expand8to24;
+        case (8 << 8) | 32:
+            return expand8to32;
+        case (16 << 8) | 24:
+            return expand16to24;
+        case (16 << 8) | 32:
+            return expand16to32_plain;
+        case (24 << 8) | 32:
+            return expand24to32;
+        default:
+            return NULL;
+    }
+}
+
+int i2s_fmt_build(i2s_fmt_t *fmt, const i2s_fmt_cfg_t *cfg)
+{
+    if (fmt == NULL || cfg == NULL) {
+        return -1;
+    }
+    memset(fmt, 0, sizeof(i2s_fmt_t));
+    if ((cfg->mono_fix || cfg->dac_scale) && cfg->op_bits != 16 && cfg->op_bits != 32) {
+        return -1;
+    }
+    if (cfg->src_bits != cfg->dst_bits && pick_expand(cfg->src_bits, cfg->dst_bits) == NULL) {
+        return -1;
+    }
+    fmt->cfg = *cfg;
+    if (cfg->src_bits == 16 && cfg->dst_bits == 32 && (cfg->op_bits == 16 || !(cfg->mono_fix || cfg->dac_scale))) {
+        // Most common expansion, fold swap and DAC scaling into the same pass
+        static const i2s_fmt_func_t k[4] = { expand16to32_plain, expand16to32_swap, expand16to32_dac, expand16to32_swap_dac };
+        fmt->expand = k[(cfg->mono_fix ? 1 : 0) | (cfg->dac_scale ? 2 : 0)];
+        return 0;
+    }
+    fmt->in_place = pick_in_place(cfg->op_bits, cfg->mono_fix, cfg->dac_scale);
+    if (cfg->src_bits != cfg->dst_bits) {
+        fmt->expand = pick_expand(cfg->src_bits, cfg->dst_bits);
+    }
+    return 0;
+}
+
+int i2s_fmt_run(const i2s_fmt_t *fmt, void *dst, void *src, int bytes)
+{
+    if (fmt->in_place) {
+        fmt->in_place(src, src, bytes);
+    }
+    if (fmt->expand) {
+        return fmt->expand(dst, src, bytes);
+    }
+    return bytes;
+}
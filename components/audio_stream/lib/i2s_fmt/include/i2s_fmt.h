@@ -0,0 +1,98 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _I2S_FMT_H_
+#define _I2S_FMT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Output format stage of i2s_stream
+ *        The sample pair swap of the ESP32 mono mode, the built-in DAC scaling and the bit expansion
+ *        are resolved into one kernel when the format changes, then applied in a single pass per buffer
+ */
+typedef struct {
+    int  op_bits;       /*!< Bits per sample the swap and DAC scaling see the data as (16 or 32) */
+    bool mono_fix;      /*!< Swap sample pairs, 16bit every pair, 32bit the first pair of every 4 samples */
+    bool dac_scale;     /*!< Keep the highest 8 bits and turn them unsigned for the built-in DAC */
+    int  src_bits;      /*!< Bits per sample of the input data (8, 16, 24 or 32) */
+    int  dst_bits;      /*!< Bits per sample written to I2S, wider than src_bits to expand */
+} i2s_fmt_cfg_t;
+
+typedef int (*i2s_fmt_func_t)(void *dst, const void *src, int bytes);
+
+/**
+ * @brief Resolved format stage
+ */
+typedef struct {
+    i2s_fmt_cfg_t   cfg;        /*!< Configuration the kernels are built for */
+    i2s_fmt_func_t  in_place;   /*!< Kernel rewriting the input in place, NULL if not needed */
+    i2s_fmt_func_t  expand;     /*!< Kernel writing the expanded output, NULL if not needed */
+} i2s_fmt_t;
+
+/**
+ * @brief         Pick the kernels for a configuration
+ *                When swap or DAC scaling run at the source width they are folded into the expand kernel
+ * @param         fmt: Format stage to set up
+ * @param         cfg: Format configuration
+ * @return        0: On success
+ *                -1: Input parameter wrong
+ */
+int i2s_fmt_build(i2s_fmt_t *fmt, const i2s_fmt_cfg_t *cfg);
+
+/**
+ * @brief         Whether the stage writes to a separate output buffer
+ */
+static inline bool i2s_fmt_need_output(const i2s_fmt_t *fmt)
+{
+    return fmt->expand != NULL;
+}
+
+/**
+ * @brief         Size of the output for an input size
+ */
+static inline int i2s_fmt_out_size(const i2s_fmt_t *fmt, int bytes)
+{
+    return fmt->expand ? bytes / (fmt->cfg.src_bits >> 3) * (fmt->cfg.dst_bits >> 3) : bytes;
+}
+
+/**
+ * @brief         Run the format stage
+ * @param         fmt: Format stage
+ * @param         dst: Output buffer with i2s_fmt_out_size bytes, only used when i2s_fmt_need_output
+ * @param         src: Input data, rewritten in place when no output buffer is needed
+ * @param         bytes: Input size, a multiple of 4
+ * @return        Output size in bytes
+ */
+int i2s_fmt_run(const i2s_fmt_t *fmt, void *dst, void *src, int bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
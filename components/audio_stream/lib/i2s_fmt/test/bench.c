@@ -0,0 +1,127 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "i2s_fmt.h"
+
+#define BENCH_BYTES   (2048)        // I2S_STREAM_BUF_SIZE
+#define BENCH_LOOPS   (20000)
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define bench_cycles() __rdtsc()
+#else
+static uint64_t bench_cycles(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+#endif
+
+// Separate passes as i2s_stream ran them before, each one a full sweep over the buffer
+static __attribute__((noipa)) void legacy_mono_fix(int16_t *temp_buf, int len)
+{
+    int k = len >> 1;
+    for (int i = 0; i < k; i += 2) {
+        int16_t temp_box = temp_buf[i];
+        temp_buf[i] = temp_buf[i + 1];
+        temp_buf[i + 1] = temp_box;
+    }
+}
+
+static __attribute__((noipa)) void legacy_dac_scale(short *buf16, int len)
+{
+    int k = len >> 1;
+    for (int i = 0; i < k; i++) {
+        buf16[i] &= 0xff00;
+        buf16[i] += 0x8000;
+    }
+}
+
+static __attribute__((noipa)) int legacy_expand(uint8_t *out, const uint8_t *src, int size, int src_bits, int aim_bits)
+{
+    int aim_bytes = aim_bits / 8;
+    int src_bytes = src_bits / 8;
+    int zero_bytes = aim_bytes - src_bytes;
+    int written = 0;
+    size = size * aim_bytes / src_bytes;
+    memset(out, 0, size);
+    for (int j = 0; j < size; j += (aim_bytes - zero_bytes)) {
+        j += zero_bytes;
+        memcpy(&out[j], src + written, aim_bytes - zero_bytes);
+        written += (aim_bytes - zero_bytes);
+    }
+    return size;
+}
+
+static __attribute__((noipa)) int legacy_chain(const i2s_fmt_cfg_t *cfg, uint8_t *out, uint8_t *buf, int len)
+{
+    if (cfg->mono_fix) {
+        legacy_mono_fix((int16_t *)buf, len);
+    }
+    if (cfg->dac_scale) {
+        legacy_dac_scale((short *)buf, len);
+    }
+    if (cfg->src_bits != cfg->dst_bits) {
+        return legacy_expand(out, buf, len, cfg->src_bits, cfg->dst_bits);
+    }
+    return len;
+}
+
+static void bench(const char *name, const i2s_fmt_cfg_t *cfg)
+{
+    static uint8_t buf[BENCH_BYTES], out[BENCH_BYTES * 2];
+    i2s_fmt_t fmt;
+    i2s_fmt_build(&fmt, cfg);
+    for (int i = 0; i < BENCH_BYTES; i++) {
+        buf[i] = rand();
+    }
+    int samples = BENCH_BYTES / (cfg->src_bits >> 3);
+    uint64_t start = bench_cycles();
+    for (int i = 0; i < BENCH_LOOPS; i++) {
+        legacy_chain(cfg, out, buf, BENCH_BYTES);
+    }
+    uint64_t mid = bench_cycles();
+    for (int i = 0; i < BENCH_LOOPS; i++) {
+        i2s_fmt_run(&fmt, out, buf, BENCH_BYTES);
+    }
+    uint64_t end = bench_cycles();
+    printf("%-28s multi pass %6.2f  fused %6.2f  cycles/sample\n", name,
+           (double)(mid - start) / BENCH_LOOPS / samples, (double)(end - mid) / BENCH_LOOPS / samples);
+}
+
+int main(int argc, char **argv)
+{
+    i2s_fmt_cfg_t dac_mono = { .op_bits = 16, .mono_fix = true, .dac_scale = true, .src_bits = 16, .dst_bits = 16 };
+    i2s_fmt_cfg_t expand = { .op_bits = 16, .src_bits = 16, .dst_bits = 32 };
+    i2s_fmt_cfg_t mono_expand = { .op_bits = 16, .mono_fix = true, .src_bits = 16, .dst_bits = 32 };
+    bench("16bit mono fix + DAC", &dac_mono);
+    bench("16 -> 32bit expand", &expand);
+    bench("16bit mono fix + expand", &mono_expand);
+    return 0;
+}
@@ -0,0 +1,4 @@
+#!/usr/bin/perl
+# Host check of the fused i2s output stage against the multi pass chain, bench reports cycles per sample
+`gcc ../i2s_fmt.c test.c -I../include -g -O2 -Wall -o ./test`;
+`gcc ../i2s_fmt.c bench.c -I../include -O2 -Wall -o ./bench`;
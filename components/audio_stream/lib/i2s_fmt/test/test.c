@@ -0,0 +1,160 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "i2s_fmt.h"
+
+#define TEST_MAX_BYTES  (2048)
+#define TEST_ROUNDS     (20000)
+
+// The multi pass chain of i2s_stream before the fused stage, kept as close to the original as possible
+static void ref_mono_fix(int bits, uint8_t *sbuff, uint32_t len)
+{
+    if (bits == 16) {
+        int16_t *temp_buf = (int16_t *)sbuff;
+        int k = len >> 1;
+        for (int i = 0; i < k; i += 2) {
+            int16_t temp_box = temp_buf[i];
+            temp_buf[i] = temp_buf[i + 1];
+            temp_buf[i + 1] = temp_box;
+        }
+    } else if (bits == 32) {
+        int32_t *temp_buf = (int32_t *)sbuff;
+        int k = len >> 2;
+        for (int i = 0; i + 1 < k; i += 4) {
+            int32_t temp_box = temp_buf[i];
+            temp_buf[i] = temp_buf[i + 1];
+            temp_buf[i + 1] = temp_box;
+        }
+    }
+}
+
+static void ref_dac_data_scale(int bits, uint8_t *sBuff, uint32_t len)
+{
+    if (bits == 16) {
+        short *buf16 = (short *)sBuff;
+        int k = len >> 1;
+        for (int i = 0; i < k; i++) {
+            buf16[i] &= 0xff00;
+            buf16[i] += 0x8000;
+        }
+    } else if (bits == 32) {
+        uint32_t *buf32 = (uint32_t *)sBuff;
+        int k = len >> 2;
+        for (int i = 0; i < k; i++) {
+            buf32[i] &= 0xff000000;
+            buf32[i] += 0x80000000;
+        }
+    }
+}
+
+// Data layout of i2s_write_expand in the IDF driver
+static int ref_write_expand(uint8_t *out, const uint8_t *src, int size, int src_bits, int aim_bits)
+{
+    int aim_bytes = aim_bits / 8;
+    int src_bytes = src_bits / 8;
+    int zero_bytes = aim_bytes - src_bytes;
+    int written = 0;
+    size = size * aim_bytes / src_bytes;
+    size -= size % aim_bytes;
+    memset(out, 0, size);
+    for (int j = 0; j < size; j += (aim_bytes - zero_bytes)) {
+        j += zero_bytes;
+        memcpy(&out[j], src + written, aim_bytes - zero_bytes);
+        written += (aim_bytes - zero_bytes);
+    }
+    return size;
+}
+
+static int ref_chain(const i2s_fmt_cfg_t *cfg, uint8_t *out, uint8_t *buf, int len)
+{
+    if (cfg->mono_fix) {
+        ref_mono_fix(cfg->op_bits, buf, len);
+    }
+    if (cfg->dac_scale) {
+        ref_dac_data_scale(cfg->op_bits, buf, len);
+    }
+    if (cfg->src_bits != cfg->dst_bits) {
+        return ref_write_expand(out, buf, len, cfg->src_bits, cfg->dst_bits);
+    }
+    memcpy(out, buf, len);
+    return len;
+}
+
+static int check(const i2s_fmt_cfg_t *cfg, int len)
+{
+    static uint8_t in[TEST_MAX_BYTES], a[TEST_MAX_BYTES], b[TEST_MAX_BYTES];
+    static uint8_t out_a[TEST_MAX_BYTES * 4], out_b[TEST_MAX_BYTES * 4];
+    i2s_fmt_t fmt;
+    if (i2s_fmt_build(&fmt, cfg) != 0) {
+        printf("build fail op:%d src:%d dst:%d\n", cfg->op_bits, cfg->src_bits, cfg->dst_bits);
+        return -1;
+    }
+    for (int i = 0; i < len; i++) {
+        in[i] = rand();
+    }
+    memcpy(a, in, len);
+    memcpy(b, in, len);
+    int na = ref_chain(cfg, out_a, a, len);
+    int nb = i2s_fmt_run(&fmt, out_b, b, len);
+    const uint8_t *pb = i2s_fmt_need_output(&fmt) ? out_b : b;
+    if (na != nb || nb != i2s_fmt_out_size(&fmt, len) || memcmp(out_a, pb, na)) {
+        printf("mismatch op:%d swap:%d dac:%d src:%d dst:%d len:%d (%d/%d)\n", cfg->op_bits, cfg->mono_fix,
+               cfg->dac_scale, cfg->src_bits, cfg->dst_bits, len, na, nb);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static const int widths[][2] = { {16, 16}, {32, 32}, {16, 32}, {8, 16}, {16, 24}, {24, 32}, {8, 32} };
+    srand(argc > 1 ? atoi(argv[1]) : 1);
+    for (int round = 0; round < TEST_ROUNDS; round++) {
+        int w = rand() % (sizeof(widths) / sizeof(widths[0]));
+        i2s_fmt_cfg_t cfg = {
+            .op_bits = (rand() & 1) ? 32 : 16,
+            .mono_fix = rand() & 1,
+            .dac_scale = rand() & 1,
+            .src_bits = widths[w][0],
+            .dst_bits = widths[w][1],
+        };
+        if (w < 3 && (rand() & 1)) {
+            cfg.op_bits = cfg.src_bits;
+        }
+        // Lengths are multiples of 4 as _i2s_write rounds them down
+        if (check(&cfg, (rand() % (TEST_MAX_BYTES / 4)) * 4) != 0) {
+            return 1;
+        }
+    }
+    i2s_fmt_t fmt;
+    i2s_fmt_cfg_t bad = { .op_bits = 16, .src_bits = 32, .dst_bits = 16 };
+    if (i2s_fmt_build(&fmt, &bad) != -1 || i2s_fmt_build(NULL, &bad) != -1) {
+        printf("invalid config accepted\n");
+        return 1;
+    }
+    printf("i2s_fmt: all %d rounds bit exact\n", TEST_ROUNDS);
+    return 0;
+}
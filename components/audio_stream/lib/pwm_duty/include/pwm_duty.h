@@ -0,0 +1,62 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _PWM_DUTY_H_
+#define _PWM_DUTY_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief  Duty of the left channel in a packed duty frame
+ */
+#define PWM_DUTY_LEFT(frame)    ((frame) & 0xFFFF)
+
+/**
+ * @brief  Duty of the right channel in a packed duty frame
+ */
+#define PWM_DUTY_RIGHT(frame)   ((frame) >> 16)
+
+/**
+ * @brief         Convert signed PCM into packed PWM duty frames
+ *                Each output word holds one sample frame, left duty in the low half and right duty in the high half,
+ *                mono input is duplicated into both halves
+ * @param         dst: Output duty frames
+ * @param         src: Interleaved PCM input, 16 or 32 bits per sample
+ * @param         frames: Sample frames to convert
+ * @param         bits: Bits per sample of the input (16 or 32)
+ * @param         channels: Channels of the input (1 or 2)
+ * @param         duty_resolution: Duty resolution of the PWM in bits (1 - 16)
+ * @return        0: On success
+ *                -1: Input parameter wrong
+ */
+int pwm_duty_convert(uint32_t *dst, const void *src, int frames, int bits, int channels, int duty_resolution);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,82 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <string.h>
+#include "pwm_duty.h"
+
+// Bias signed samples to unsigned and keep the top `duty_resolution` bits.
+// Stereo 16bit frames are converted as one 32bit word, the shift leaks bits of the right sample
+// into the top of the left half, which the mask clears again.
+
+static void convert_16bit_stereo(uint32_t *dst, const uint8_t *src, int frames, int shift)
+{
+    uint32_t mask = (0xFFFFu >> shift) * 0x10001u;
+    #pragma GCC unroll 4
+    for (int i = 0; i < frames; i++) {
+        uint32_t w;
+        memcpy(&w, src + (i << 2), sizeof(w));
+        dst[i] = ((w ^ 0x80008000u) >> shift) & mask;
+    }
+}
+
+static void convert_16bit_mono(uint32_t *dst, const uint8_t *src, int frames, int shift)
+{
+    #pragma GCC unroll 4
+    for (int i = 0; i < frames; i++) {
+        uint16_t s;
+        memcpy(&s, src + (i << 1), sizeof(s));
+        dst[i] = ((uint32_t)(uint16_t)(s ^ 0x8000u) >> shift) * 0x10001u;
+    }
+}
+
+static void convert_32bit(uint32_t *dst, const uint8_t *src, int frames, int channels, int shift)
+{
+    int step = channels << 2;
+    for (int i = 0; i < frames; i++) {
+        uint32_t l, r;
+        memcpy(&l, src, sizeof(l));
+        memcpy(&r, src + step - sizeof(r), sizeof(r));
+        dst[i] = ((l ^ 0x80000000u) >> shift) | (((r ^ 0x80000000u) >> shift) << 16);
+        src += step;
+    }
+}
+
+int pwm_duty_convert(uint32_t *dst, const void *src, int frames, int bits, int channels, int duty_resolution)
+{
+    if (dst == NULL || src == NULL || frames < 0 || (channels != 1 && channels != 2)
+        || duty_resolution < 1 || duty_resolution > 16) {
+        return -1;
+    }
+    if (bits == 16) {
+        if (channels == 2) {
+            convert_16bit_stereo(dst, src, frames, 16 - duty_resolution);
+        } else {
+            convert_16bit_mono(dst, src, frames, 16 - duty_resolution);
+        }
+    } else if (bits == 32) {
+        convert_32bit(dst, src, frames, channels, 32 - duty_resolution);
+    } else {
+        return -1;
+    }
+    return 0;
+}
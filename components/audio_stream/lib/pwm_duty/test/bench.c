@@ -0,0 +1,146 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "pwm_duty.h"
+
+#define BENCH_RATE       (44100)
+#define BENCH_SECONDS    (4)
+#define BENCH_WRITE_SIZE (1024)             // Fits both rings in one go
+#define BENCH_RING_SIZE  (4096)             // Default pwm data_len in bytes
+#define BENCH_DUTY       (10)
+
+// Byte ring and per sample conversion as pwm_stream did before block conversion
+typedef struct {
+    uint8_t  buf[BENCH_RING_SIZE];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    uint32_t size;
+} byte_ring_t;
+
+static __attribute__((noipa)) int byte_ring_write(byte_ring_t *data, const uint8_t indata)
+{
+    uint32_t next_head = data->head + 1;
+    if (next_head == data->size) {
+        next_head = 0;
+    }
+    if (next_head == data->tail) {
+        return -1;
+    }
+    data->buf[data->head] = indata;
+    data->head = next_head;
+    return 0;
+}
+
+static __attribute__((noipa)) void legacy_convert(byte_ring_t *data, uint8_t *inbuf, int32_t duty, uint32_t bytes)
+{
+    int8_t shift = 16 - duty;
+    uint32_t len = bytes >> 1;
+    uint16_t *buf_16b = (uint16_t *)inbuf;
+    for (size_t i = 0; i < len; i++) {
+        int16_t temp = buf_16b[i];
+        uint16_t value = temp + 0x7fff;
+        value >>= shift;
+        byte_ring_write(data, value);
+        byte_ring_write(data, value >> 8);
+    }
+}
+
+// Frame ring filled in at most two spans
+typedef struct {
+    uint32_t buf[BENCH_RING_SIZE / sizeof(uint32_t)];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    uint32_t size;
+} frame_ring_t;
+
+static __attribute__((noipa)) void block_convert(frame_ring_t *data, uint8_t *inbuf, int channels, uint32_t frames)
+{
+    uint32_t head = data->head;
+    uint32_t span = data->size - head;
+    if (span > frames) {
+        span = frames;
+    }
+    pwm_duty_convert(data->buf + head, inbuf, span, 16, channels, BENCH_DUTY);
+    pwm_duty_convert(data->buf, inbuf + span * channels * 2, frames - span, 16, channels, BENCH_DUTY);
+    head += frames;
+    data->head = head >= data->size ? head - data->size : head;
+}
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void bench(int channels, uint8_t *pcm, int total)
+{
+    static byte_ring_t br;
+    static frame_ring_t fr;
+    int frame_bytes = channels * 2;
+    double legacy = 0, block = 0;
+    for (int round = 0; round < 5; round++) {
+        double start = now_us();
+        for (int pos = 0; pos < total; pos += BENCH_WRITE_SIZE) {
+            // Drain instantly so every write lands, the ISR side is not part of the cost
+            br.size = BENCH_RING_SIZE;
+            br.tail = br.head;
+            legacy_convert(&br, pcm + pos, BENCH_DUTY, BENCH_WRITE_SIZE);
+        }
+        double t1 = now_us();
+        for (int pos = 0; pos < total; pos += BENCH_WRITE_SIZE) {
+            fr.size = BENCH_RING_SIZE / sizeof(uint32_t);
+            fr.tail = fr.head;
+            block_convert(&fr, pcm + pos, channels, BENCH_WRITE_SIZE / frame_bytes);
+        }
+        double t2 = now_us();
+        if (round == 0 || t1 - start < legacy) {
+            legacy = t1 - start;
+        }
+        if (round == 0 || t2 - t1 < block) {
+            block = t2 - t1;
+        }
+    }
+    printf("%d ch, 16 bit, %d Hz: byte ring %8.1f us/s of audio, block convert %8.1f us/s of audio\n",
+           channels, BENCH_RATE, legacy / BENCH_SECONDS, block / BENCH_SECONDS);
+}
+
+int main(int argc, char **argv)
+{
+    for (int channels = 1; channels <= 2; channels++) {
+        int total = BENCH_RATE * BENCH_SECONDS * channels * 2;
+        total -= total % BENCH_WRITE_SIZE;
+        uint8_t *pcm = malloc(total);
+        for (int i = 0; i < total; i++) {
+            pcm[i] = rand();
+        }
+        bench(channels, pcm, total);
+        free(pcm);
+    }
+    return 0;
+}
@@ -0,0 +1,4 @@
+#!/usr/bin/perl
+# Host check of the PCM to PWM duty conversion, bench reports convert cost per second of audio
+`gcc ../pwm_duty.c test.c -I../include -g -O2 -Wall -o ./test`;
+`gcc ../pwm_duty.c bench.c -I../include -O2 -Wall -o ./bench`;
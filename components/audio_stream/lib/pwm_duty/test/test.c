@@ -0,0 +1,98 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pwm_duty.h"
+
+#define TEST_FRAMES  (257)
+#define TEST_ROUNDS  (2000)
+
+static uint32_t ref_duty(int32_t s, int bits, int duty)
+{
+    uint32_t u = bits == 16 ? (uint32_t)(uint16_t)(s + 0x8000) : (uint32_t)s ^ 0x80000000u;
+    return u >> (bits - duty);
+}
+
+static int check(int bits, int channels, int duty, int offset)
+{
+    uint8_t raw[TEST_FRAMES * 8 + 4];
+    uint32_t out[TEST_FRAMES];
+    uint8_t *src = raw + offset;
+    for (int i = 0; i < sizeof(raw); i++) {
+        raw[i] = rand();
+    }
+    int frames = rand() % TEST_FRAMES;
+    if (pwm_duty_convert(out, src, frames, bits, channels, duty) != 0) {
+        printf("convert fail bits:%d ch:%d duty:%d\n", bits, channels, duty);
+        return -1;
+    }
+    for (int i = 0; i < frames; i++) {
+        int32_t s[2];
+        for (int c = 0; c < channels; c++) {
+            if (bits == 16) {
+                int16_t v;
+                memcpy(&v, src + (i * channels + c) * 2, 2);
+                s[c] = v;
+            } else {
+                memcpy(&s[c], src + (i * channels + c) * 4, 4);
+            }
+        }
+        uint32_t l = ref_duty(s[0], bits, duty);
+        uint32_t r = ref_duty(s[channels - 1], bits, duty);
+        if (PWM_DUTY_LEFT(out[i]) != l || PWM_DUTY_RIGHT(out[i]) != r) {
+            printf("mismatch bits:%d ch:%d duty:%d frame:%d got %x want %x/%x\n", bits, channels, duty, i, out[i], l, r);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    srand(argc > 1 ? atoi(argv[1]) : 1);
+    for (int round = 0; round < TEST_ROUNDS; round++) {
+        int bits = (rand() & 1) ? 32 : 16;
+        int channels = (rand() & 1) + 1;
+        int duty = rand() % 16 + 1;
+        if (check(bits, channels, duty, rand() & 3) != 0) {
+            return 1;
+        }
+    }
+    // Full scale edges, the most negative sample must map to duty 0
+    int16_t edge[4] = { -32768, 32767, 0, -1 };
+    uint32_t out[2];
+    pwm_duty_convert(out, edge, 2, 16, 2, 10);
+    if (out[0] != (0x3FFu << 16) || out[1] != ((0x1FFu << 16) | 0x200u)) {
+        printf("edge mismatch %x %x\n", out[0], out[1]);
+        return 1;
+    }
+    if (pwm_duty_convert(out, edge, 1, 8, 2, 10) != -1 || pwm_duty_convert(out, edge, 1, 16, 3, 10) != -1
+        || pwm_duty_convert(out, edge, 1, 16, 2, 0) != -1 || pwm_duty_convert(NULL, edge, 1, 16, 2, 10) != -1) {
+        printf("invalid args accepted\n");
+        return 1;
+    }
+    printf("pwm_duty: all %d rounds ok\n", TEST_ROUNDS);
+    return 0;
+}
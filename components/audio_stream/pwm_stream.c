@@ -37,10 +37,12 @@
 #include "soc/ledc_reg.h"
 #include "pwm_stream.h"
 #include "audio_idf_version.h"
+#include "pwm_duty.h"
 
 static const char *TAG = "PWM_STREAM";
 
 #define BUFFER_MIN_SIZE (256UL)
+#define FRAME_MIN_FREE  (BUFFER_MIN_SIZE / sizeof(uint32_t))
 #define SAMPLE_RATE_MAX (48000)
 #define SAMPLE_RATE_MIN (8000)
 #define CHANNEL_LEFT_INDEX  (0)
@@ -50,10 +52,10 @@ static const char *TAG = "PWM_STREAM";
 #define AUDIO_PWM_CH_MAX (2)
 
 typedef struct {
-    char *buf;                         /**< Original pointer */
-    uint32_t volatile head;            /**< ending pointer */
-    uint32_t volatile tail;            /**< Read pointer */
-    uint32_t size;                     /**< Buffer size */
+    uint32_t *buf;                     /**< Packed duty frames, see pwm_duty_convert */
+    uint32_t volatile head;            /**< Write index in frames */
+    uint32_t volatile tail;            /**< Read index in frames */
+    uint32_t size;                     /**< Buffer size in frames */
     uint32_t is_give;                  /**< semaphore give flag */
     SemaphoreHandle_t semaphore;       /**< Semaphore for data */
 } data_list_t;
@@ -128,7 +130,7 @@ static pwm_data_handle_t pwm_data_list_create(int size)
 
     data->is_give = 0;
     data->head = data->tail = 0;
-    data->size = size;
+    data->size = size / sizeof(uint32_t);
     return data;
 
 data_error:
@@ -167,34 +169,43 @@ static esp_err_t pwm_data_list_flush(pwm_data_handle_t data)
     return ESP_OK;
 }
 
-static esp_err_t IRAM_ATTR pwm_data_list_read_byte(pwm_data_handle_t data, uint8_t *outdata)
+static inline bool IRAM_ATTR pwm_data_list_read_frame(pwm_data_handle_t data, uint32_t *frame)
 {
     uint32_t tail = data->tail;
-    if ((tail == data->head) || (tail == (data->head + 1))) {
-        return ESP_FAIL;
+    if (tail == data->head) {
+        return false;
     }
-    *outdata = data->buf[tail];
+    *frame = data->buf[tail];
     tail++;
     if (tail == data->size) {
         tail = 0;
     }
-
     data->tail = tail;
-    return ESP_OK;
+    return true;
 }
 
-static esp_err_t pwm_data_list_write_byte(pwm_data_handle_t data, const uint8_t indata)
+static uint32_t pwm_data_list_write(pwm_data_handle_t data, const uint8_t *inbuf, uint32_t frames, int bits, int ch, int duty)
 {
-    uint32_t next_head = data->head + 1;
-    if (next_head == data->size) {
-        next_head = 0;
-    }
-    if (next_head == data->tail) {
-        return ESP_FAIL;
-    }
-    data->buf[data->head] = indata;
-    data->head = next_head;
-    return ESP_OK;
+    uint32_t free = pwm_data_list_get_free(data);
+    if (frames > free) {
+        frames = free;
+    }
+    // Convert straight into the ring, at most two spans when the write wraps
+    uint32_t head = data->head;
+    uint32_t span = data->size - head;
+    if (span > frames) {
+        span = frames;
+    }
+    pwm_duty_convert(data->buf + head, inbuf, span, bits, ch, duty);
+    pwm_duty_convert(data->buf, inbuf + span * ch * (bits >> 3), frames - span, bits, ch, duty);
+    head += frames;
+    if (head >= data->size) {
+        head -= data->size;
+    }
+    // Frames must be visible before the ISR sees the new head
+    __asm__ __volatile__("" ::: "memory");
+    data->head = head;
+    return frames;
 }
 
 static esp_err_t pwm_data_list_wait_semaphore(pwm_data_handle_t data, TickType_t ticks_to_wait)
@@ -252,56 +263,17 @@ static void IRAM_ATTR timer_group_isr(void *para)
     handle->timg_dev->hw_timer[handle->config.timer_num].config.tn_alarm_en = TIMER_ALARM_EN;
 #endif
 
-    static uint8_t wave_h, wave_l;
-    static uint16_t value;
-
-    if (handle->channel_mask & CHANNEL_LEFT_MASK) {
-        if (handle->config.duty_resolution > 8) {
-            pwm_data_list_read_byte(handle->data, &wave_l);
-            if (ESP_OK == pwm_data_list_read_byte(handle->data, &wave_h)) {
-                value = ((wave_h << 8) | wave_l);
-                ledc_set_left_duty_fast(value);
-            }
-        } else {
-            if (ESP_OK == pwm_data_list_read_byte(handle->data, &wave_h)) {
-                ledc_set_left_duty_fast(wave_h);
-            }
-        }
-    }
-
-    if (handle->channel_mask & CHANNEL_RIGHT_MASK) {
-        if (handle->channel_set_num == 1) {
-            if (handle->config.duty_resolution > 8) {
-                ledc_set_right_duty_fast(value);
-            } else {
-                ledc_set_right_duty_fast(wave_h);
-            }
-        } else {
-            if (handle->config.duty_resolution > 8) {
-                pwm_data_list_read_byte(handle->data, &wave_l);
-                if (ESP_OK == pwm_data_list_read_byte(handle->data, &wave_h)) {
-                    value = ((wave_h << 8) | wave_l);
-                    ledc_set_right_duty_fast(value);
-                }
-            } else {
-                if (ESP_OK == pwm_data_list_read_byte(handle->data, &wave_h)) {
-                    ledc_set_right_duty_fast(wave_h);
-                }
-            }
+    uint32_t frame;
+    if (pwm_data_list_read_frame(handle->data, &frame)) {
+        if (handle->channel_mask & CHANNEL_LEFT_MASK) {
+            ledc_set_left_duty_fast(PWM_DUTY_LEFT(frame));
         }
-    } else {
-        if (handle->channel_set_num == 2) {
-            if (handle->config.duty_resolution > 8) {
-                pwm_data_list_read_byte(handle->data, &wave_h);
-                pwm_data_list_read_byte(handle->data, &wave_h);
-            } else {
-                pwm_data_list_read_byte(handle->data, &wave_h);
-            }
-            pwm_data_list_read_byte(handle->data, &wave_l);
+        if (handle->channel_mask & CHANNEL_RIGHT_MASK) {
+            ledc_set_right_duty_fast(PWM_DUTY_RIGHT(frame));
         }
     }
 
-    if (0 == handle->data->is_give && pwm_data_list_get_free(handle->data) > BUFFER_MIN_SIZE) {
+    if (0 == handle->data->is_give && pwm_data_list_get_free(handle->data) > FRAME_MIN_FREE) {
         handle->data->is_give = 1;
         BaseType_t xHigherPriorityTaskWoken;
         xSemaphoreGiveFromISR(handle->data->semaphore, &xHigherPriorityTaskWoken);
@@ -466,60 +438,6 @@ esp_err_t audio_pwm_set_sample_rate(int rate)
     return res;
 }
 
-static esp_err_t pwm_data_convert(pwm_data_handle_t data, uint8_t *inbuf, int32_t bits_per, int32_t duty, uint32_t bytes)
-{
-    int8_t shift = bits_per - duty;
-    uint32_t len = bytes;
-
-    if (bits_per == 16) {
-        len >>= 1;
-        uint16_t *buf_16b = (uint16_t *)inbuf;
-        uint16_t value;
-        int16_t temp;
-        if (duty > 8) {
-            for (size_t i = 0; i < len; i++) {
-                temp = buf_16b[i];
-                value = temp + 0x7fff;
-                value >>= shift;
-                pwm_data_list_write_byte(data, value);
-                pwm_data_list_write_byte(data, value >> 8);
-            }
-        } else {
-            for (size_t i = 0; i < len; i++) {
-                temp = buf_16b[i];
-                value = temp + 0x7fff;
-                value >>= shift;
-                pwm_data_list_write_byte(data, value);
-            }
-        }
-    } else if (bits_per == 32) {
-        len >>= 2;
-        uint32_t *buf_32b = (uint32_t *)inbuf;
-        uint32_t value;
-        int32_t temp;
-        if (duty > 8) {
-            for (size_t i = 0; i < len; i++) {
-                temp = buf_32b[i];
-                value = temp + 0x7fffffff;
-                value >>= shift;
-                pwm_data_list_write_byte(data, value);
-                pwm_data_list_write_byte(data, value >> 8);
-            }
-        } else {
-            for (size_t i = 0; i < len; i++) {
-                temp = buf_32b[i];
-                value = temp + 0x7fffffff;
-                value >>= shift;
-                pwm_data_list_write_byte(data, value);
-            }
-        }
-    } else {
-        ESP_LOGE(TAG, "Only support bits (16 or 32), now bits_per is %d", bits_per);
-    }
-    return ESP_OK;
-}
-
-
 esp_err_t audio_pwm_write(uint8_t *inbuf, size_t inbuf_len, size_t *bytes_written, TickType_t ticks_to_wait)
 {
     esp_err_t res = ESP_OK;
@@ -528,19 +446,21 @@ esp_err_t audio_pwm_write(uint8_t *inbuf, size_t inbuf_len, size_t *bytes_writte
 
     *bytes_written = 0;
     pwm_data_handle_t data = handle->data;
+    uint32_t frame_bytes = (handle->bits_per_sample >> 3) * handle->channel_set_num;
+    if (handle->bits_per_sample != 16 && handle->bits_per_sample != 32) {
+        ESP_LOGE(TAG, "Only support bits (16 or 32), now bits_per is %d", handle->bits_per_sample);
+        *bytes_written = inbuf_len;
+        return ESP_OK;
+    }
     while (inbuf_len) {
         if (ESP_OK == pwm_data_list_wait_semaphore(data, ticks_to_wait)) {
-            uint32_t free = pwm_data_list_get_free(data);
-            uint32_t bytes_can_write = inbuf_len;
-            if (inbuf_len > free) {
-                bytes_can_write = free;
-            }
-            bytes_can_write &= 0xfffffffc;
+            uint32_t frames = pwm_data_list_write(data, inbuf, inbuf_len / frame_bytes, handle->bits_per_sample,
+                                                  handle->channel_set_num, handle->config.duty_resolution);
+            uint32_t bytes_can_write = frames * frame_bytes;
             if (0 == bytes_can_write) {
                 *bytes_written += inbuf_len;
                 return ESP_OK;
             }
-            pwm_data_convert(data, inbuf, handle->bits_per_sample, handle->config.duty_resolution, bytes_can_write);
             inbuf += bytes_can_write;
             inbuf_len -= bytes_can_write;
             *bytes_written += bytes_can_write;
@@ -0,0 +1,153 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "audio_mem.h"
+#include "audio_element.h"
+#include "embed_flash_stream.h"
+#include "ringbuf.h"
+
+#define EMBED_TEST_TONE_SIZE (48 * 1024)
+
+// Const data is placed in flash, the same as the tones generated by mk_embed_tone
+static const uint8_t embed_test_tone[EMBED_TEST_TONE_SIZE] = { 0x11, 0x22, 0x33, 0x44, [EMBED_TEST_TONE_SIZE - 1] = 0x55 };
+
+static const embed_item_info_t embed_test_info[] = {
+    [0] = { embed_test_tone, EMBED_TEST_TONE_SIZE / 2 },
+    [1] = { embed_test_tone, EMBED_TEST_TONE_SIZE },
+};
+
+typedef struct {
+    int64_t start_us;
+    int64_t first_us;
+    int64_t elapsed_us;
+    int     bytes;
+    bool    match;
+} embed_test_ctx_t;
+
+static int embed_test_write_cb(audio_element_handle_t el, char *buf, int len, TickType_t wait_time, void *ctx)
+{
+    embed_test_ctx_t *t = (embed_test_ctx_t *)ctx;
+    if (t->first_us == 0) {
+        t->first_us = esp_timer_get_time();
+    }
+    if (memcmp(buf, embed_test_tone + t->bytes, len)) {
+        t->match = false;
+    }
+    t->bytes += len;
+    return len;
+}
+
+TEST_CASE("embed flash stream init memory", "esp-adf-stream")
+{
+    embed_flash_stream_cfg_t embed_cfg = EMBED_FLASH_STREAM_CFG_DEFAULT();
+    int cnt = 2000;
+    AUDIO_MEM_SHOW("BEFORE EMBED_FLASH_STREAM_INIT MEMORY TEST");
+    while (cnt--) {
+        audio_element_handle_t embed_stream = embed_flash_stream_init(&embed_cfg);
+        TEST_ASSERT_NOT_NULL(embed_stream);
+        TEST_ASSERT_EQUAL(ESP_OK, embed_flash_stream_set_context(embed_stream, embed_test_info, 2));
+        audio_element_deinit(embed_stream);
+    }
+    AUDIO_MEM_SHOW("AFTER EMBED_FLASH_STREAM_INIT MEMORY TEST");
+}
+
+TEST_CASE("embed flash stream start latency and read cost", "esp-adf-stream")
+{
+    embed_flash_stream_cfg_t embed_cfg = EMBED_FLASH_STREAM_CFG_DEFAULT();
+    audio_element_handle_t embed_stream = embed_flash_stream_init(&embed_cfg);
+    TEST_ASSERT_NOT_NULL(embed_stream);
+    TEST_ASSERT_EQUAL(ESP_FAIL, embed_flash_stream_set_context(embed_stream, embed_test_info, 0));
+    TEST_ASSERT_EQUAL(ESP_OK, embed_flash_stream_set_context(embed_stream, embed_test_info, 2));
+
+    embed_test_ctx_t ctx = { 0 };
+    TEST_ASSERT_EQUAL(ESP_OK, audio_element_set_write_cb(embed_stream, embed_test_write_cb, &ctx));
+    for (int i = 0; i < 2; i++) {
+        const char *uri[] = { "embed://tone/0_half.mp3", "embed://tone/1_full.mp3" };
+        memset(&ctx, 0, sizeof(ctx));
+        ctx.match = true;
+        TEST_ASSERT_EQUAL(ESP_OK, audio_element_set_uri(embed_stream, uri[i]));
+        ctx.start_us = esp_timer_get_time();
+        TEST_ASSERT_EQUAL(ESP_OK, audio_element_run(embed_stream));
+        TEST_ASSERT_EQUAL(ESP_OK, audio_element_resume(embed_stream, 0, 0));
+        TEST_ASSERT_EQUAL(ESP_OK, audio_element_wait_for_stop_ms(embed_stream, 2000));
+        ctx.elapsed_us = esp_timer_get_time() - ctx.start_us;
+        TEST_ASSERT_EQUAL(embed_test_info[i].size, ctx.bytes);
+        TEST_ASSERT_TRUE(ctx.match);
+        ESP_LOGI("EMBED_TEST", "%s, first byte after %lld us, %d bytes in %lld us",
+                 uri[i], ctx.first_us - ctx.start_us, ctx.bytes, ctx.elapsed_us);
+        TEST_ASSERT_EQUAL(ESP_OK, audio_element_terminate(embed_stream));
+        audio_element_reset_state(embed_stream);
+    }
+
+    const uint8_t *data = NULL;
+    TEST_ASSERT_EQUAL(ESP_FAIL, embed_flash_stream_acquire_read(embed_stream, &data, 16));
+    TEST_ASSERT_EQUAL(ESP_OK, audio_element_deinit(embed_stream));
+}
+
+TEST_CASE("embed flash stream hands mapped data to a ringbuffer output", "esp-adf-stream")
+{
+    embed_flash_stream_cfg_t embed_cfg = EMBED_FLASH_STREAM_CFG_DEFAULT();
+    audio_element_handle_t embed_stream = embed_flash_stream_init(&embed_cfg);
+    TEST_ASSERT_NOT_NULL(embed_stream);
+    TEST_ASSERT_EQUAL(ESP_OK, embed_flash_stream_set_context(embed_stream, embed_test_info, 2));
+    ringbuf_handle_t rb = rb_create(8 * 1024, 1);
+    TEST_ASSERT_NOT_NULL(rb);
+    TEST_ASSERT_EQUAL(ESP_OK, audio_element_set_output_ringbuf(embed_stream, rb));
+
+    char *buf = audio_malloc(1024);
+    TEST_ASSERT_NOT_NULL(buf);
+    TEST_ASSERT_EQUAL(ESP_OK, audio_element_set_uri(embed_stream, "embed://tone/1_full.mp3"));
+    int64_t start_us = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_OK, audio_element_run(embed_stream));
+    TEST_ASSERT_EQUAL(ESP_OK, audio_element_resume(embed_stream, 0, 0));
+    int bytes = 0;
+    int ret = 0;
+    bool match = true;
+    while ((ret = rb_read(rb, buf, 1024, 2000 / portTICK_PERIOD_MS)) > 0) {
+        if (bytes + ret > EMBED_TEST_TONE_SIZE || memcmp(buf, embed_test_tone + bytes, ret)) {
+            match = false;
+        }
+        bytes += ret;
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    TEST_ASSERT_EQUAL(RB_DONE, ret);
+    TEST_ASSERT_EQUAL(EMBED_TEST_TONE_SIZE, bytes);
+    TEST_ASSERT_TRUE(match);
+    ESP_LOGI("EMBED_TEST", "ringbuffer output, %d bytes in %lld us", bytes, elapsed_us);
+
+    TEST_ASSERT_EQUAL(ESP_OK, audio_element_wait_for_stop_ms(embed_stream, 2000));
+    TEST_ASSERT_EQUAL(ESP_OK, audio_element_terminate(embed_stream));
+    TEST_ASSERT_EQUAL(ESP_OK, audio_element_deinit(embed_stream));
+    rb_destroy(rb);
+    audio_free(buf);
+}
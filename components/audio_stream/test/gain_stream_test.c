@@ -0,0 +1,65 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "unity.h"
+#include "esp_log.h"
+
+#include "audio_mem.h"
+#include "audio_element.h"
+#include "gain_stream.h"
+
+TEST_CASE("gain stream init memory", "esp-adf-stream")
+{
+    gain_stream_cfg_t gain_cfg = GAIN_STREAM_CFG_DEFAULT();
+    int cnt = 2000;
+    AUDIO_MEM_SHOW("BEFORE GAIN_STREAM_INIT MEMORY TEST");
+    while (cnt--) {
+        audio_element_handle_t gain_stream = gain_stream_init(&gain_cfg);
+        TEST_ASSERT_NOT_NULL(gain_stream);
+        audio_element_deinit(gain_stream);
+    }
+    AUDIO_MEM_SHOW("AFTER GAIN_STREAM_INIT MEMORY TEST");
+}
+
+TEST_CASE("gain stream set and get gain", "esp-adf-stream")
+{
+    gain_stream_cfg_t gain_cfg = GAIN_STREAM_CFG_DEFAULT();
+    gain_cfg.gain_db = -6;
+    audio_element_handle_t gain_stream = gain_stream_init(&gain_cfg);
+    TEST_ASSERT_NOT_NULL(gain_stream);
+
+    int db = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, gain_stream_get_db(gain_stream, 1, &db));
+    TEST_ASSERT_EQUAL(-6, db);
+    TEST_ASSERT_EQUAL(ESP_OK, gain_stream_set_db(gain_stream, 0, -20));
+    TEST_ASSERT_EQUAL(ESP_OK, gain_stream_get_db(gain_stream, 0, &db));
+    TEST_ASSERT_EQUAL(-20, db);
+    TEST_ASSERT_EQUAL(ESP_OK, gain_stream_get_db(gain_stream, 1, &db));
+    TEST_ASSERT_EQUAL(-6, db);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, gain_stream_set_db(gain_stream, 8, 0));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, gain_stream_get_db(gain_stream, -1, &db));
+    TEST_ASSERT_EQUAL(ESP_OK, audio_element_deinit(gain_stream));
+}
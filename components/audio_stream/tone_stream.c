@@ -54,27 +54,29 @@ static esp_err_t _tone_open(audio_element_handle_t self)
         ESP_LOGE(TAG, "already opened");
         return ESP_FAIL;
     }
-    stream->tone_handle = tone_partition_init(stream->partition_label, stream->use_delegate);
+    // Keep the partition handle across opens, the file table is only loaded once
     if (stream->tone_handle == NULL) {
-        return ESP_FAIL;
+        stream->tone_handle = tone_partition_init(stream->partition_label, stream->use_delegate);
+        if (stream->tone_handle == NULL) {
+            return ESP_FAIL;
+        }
     }
 
     char *flash_url = audio_element_get_uri(self);
 
     flash_url += strlen("flash://tone/");
-    char *temp = strchr(flash_url, '_');
-    char find_num[2] = { 0 };
-    int file_index = 0;
-    if (temp != NULL) {
-        strncpy(find_num, flash_url, temp - flash_url);
-        file_index = strtoul(find_num, 0, 10);
+    char *temp = NULL;
+    int file_index = strtoul(flash_url, &temp, 10);
+    if (temp != flash_url && *temp == '_') {
         ESP_LOGD(TAG, "Wanted read flash tone index is %d", file_index);
     } else {
         ESP_LOGE(TAG, "Tone file name is not correct!");
         return ESP_FAIL;
     }
 
-    tone_partition_get_file_info(stream->tone_handle, file_index, &stream->cur_file);
+    if (ESP_OK != tone_partition_get_file_info(stream->tone_handle, file_index, &stream->cur_file)) {
+        return ESP_FAIL;
+    }
     ESP_LOGI(TAG, "Tone offset:%08x, Tone length:%d, pos:%d\n", stream->cur_file.song_adr, stream->cur_file.song_len, file_index);
     if (stream->cur_file.song_len <= 0) {
         ESP_LOGE(TAG, "Mayebe the flash tone is empty, please ensure the flash's contex");
@@ -132,8 +134,6 @@ static esp_err_t _tone_close(audio_element_handle_t self)
     if (stream->is_open) {
         stream->is_open = false;
     }
-    tone_partition_deinit(stream->tone_handle);
-    stream->tone_handle = NULL;
     if (AEL_STATE_PAUSED != audio_element_get_state(self)) {
         audio_element_set_byte_pos(self, 0);
     }
@@ -143,6 +143,9 @@ static esp_err_t _tone_close(audio_element_handle_t self)
 static esp_err_t _tone_destroy(audio_element_handle_t self)
 {
     tone_stream_t *stream = (tone_stream_t *)audio_element_getdata(self);
+    if (stream->tone_handle) {
+        tone_partition_deinit(stream->tone_handle);
+    }
     audio_free(stream);
     return ESP_OK;
 }
@@ -30,7 +30,6 @@
 #include "esp_peripherals.h"
 #include "audio_common.h"
 #include "audio_mem.h"
-#include "audio_thread.h"
 #include "sdkconfig.h"
 
 #include "a2dp_stream.h"
@@ -55,19 +54,10 @@ typedef struct {
     bool volume_notify;
 #endif
 
-    audio_thread_t a2dp_thread;
-    QueueHandle_t a2dp_queue;
+    a2dp_stream_sink_stats_t sink_stats;
+    bool sink_has_data;
 } aadp_info_t;
 
-typedef struct {
-    enum {
-        A2DP_TYPE_SINK ,
-        A2DP_TYPE_DESTORY,
-    } type;
-    void *data;
-    size_t size;
-} a2dp_data_t;
-
 static aadp_info_t s_aadp_handler = { 0 };
 
 int16_t default_volume = 50;
@@ -78,34 +68,6 @@ static void bt_avrc_tg_cb(esp_avrc_tg_cb_event_t event, esp_avrc_tg_cb_param_t *
 static const char *audio_state_str[] = { "Suspended", "Stopped", "Started" };
 static void bt_avrc_ct_cb(esp_avrc_ct_cb_event_t event, esp_avrc_ct_cb_param_t *param);
 
-static void audio_a2dp_stream_thread(void *pvParameters)
-{
-    (void) pvParameters;
-
-    a2dp_data_t recv_msg;
-    bool _aadp_task_run = true;
-    while(_aadp_task_run) {
-        if ( pdTRUE ==  xQueueReceive (s_aadp_handler.a2dp_queue, &recv_msg, portMAX_DELAY) ) {
-            switch (recv_msg.type) {
-            case A2DP_TYPE_SINK:
-                    audio_element_output(s_aadp_handler.sink_stream, (char *)recv_msg.data, recv_msg.size);
-                    audio_free(recv_msg.data);
-                    recv_msg.data = NULL;
-                break;
-            case A2DP_TYPE_DESTORY:
-                _aadp_task_run = false;
-                break;
-            default:
-                break;
-            }
-        }
-    }
-    ESP_LOGI(TAG, "Delete the audio_a2dp_stream_thread");
-    vQueueDelete(s_aadp_handler.a2dp_queue);
-    s_aadp_handler.a2dp_queue = NULL;
-    vTaskDelete(NULL);
-}
-
 static void bt_a2d_sink_cb(esp_a2d_cb_event_t event, esp_a2d_cb_param_t *param)
 {
     if (s_aadp_handler.user_callback.user_a2d_cb) {
@@ -137,6 +99,10 @@ static void bt_a2d_sink_cb(esp_a2d_cb_event_t event, esp_a2d_cb_param_t *param)
         case ESP_A2D_AUDIO_STATE_EVT:
             a2d = (esp_a2d_cb_param_t *)(param);
             ESP_LOGD(TAG, "A2DP audio state: %s", audio_state_str[a2d->audio_stat.state]);
+            if (ESP_A2D_AUDIO_STATE_STARTED != a2d->audio_stat.state) {
+                // The ring drains while the remote is suspended, that is not an underrun
+                s_aadp_handler.sink_has_data = false;
+            }
             if (s_aadp_handler.bt_avrc_periph == NULL) {
                 break;
             }
@@ -181,23 +147,32 @@ static void bt_a2d_sink_data_cb(const uint8_t *data, uint32_t len)
     if (s_aadp_handler.user_callback.user_a2d_sink_data_cb) {
         s_aadp_handler.user_callback.user_a2d_sink_data_cb(data, len);
     }
-    if (s_aadp_handler.sink_stream) {
-        if (audio_element_get_state(s_aadp_handler.sink_stream) == AEL_STATE_RUNNING) {
-            a2dp_data_t send_msg = {0};
-            send_msg.data = (uint8_t *) audio_calloc(1, len);
-            if (!send_msg.data) {
-                ESP_LOGE(TAG, "No ineffecitive memory to allocate(%d)", __LINE__);
-                return;
-            }
-            memcpy(send_msg.data, data, len);
-            send_msg.size = len;
-            send_msg.type = A2DP_TYPE_SINK;
-            if ((!s_aadp_handler.a2dp_queue) || xQueueSend( s_aadp_handler.a2dp_queue, &send_msg, 0)  != pdPASS ) {
-                ESP_LOGW(TAG, "discard a2dp(%p) sink pkt, A2DP_STREAM_QUEUE_SIZE value needs to be expanded", s_aadp_handler.a2dp_queue);
-                audio_free(send_msg.data);
-                send_msg.data = NULL;
-            } 
+    if (s_aadp_handler.sink_stream == NULL
+        || audio_element_get_state(s_aadp_handler.sink_stream) != AEL_STATE_RUNNING) {
+        return;
+    }
+    a2dp_stream_sink_stats_t *stats = &s_aadp_handler.sink_stats;
+    stats->packets++;
+    /**
+     * The output ringbuffer is allocated once when the pipeline is linked and this callback is its only writer,
+     * so the free space checked here can only grow before the write. The packet is copied straight into it,
+     * whole packets are dropped when it is full, and the BT task is never blocked by a slow pipeline.
+     */
+    ringbuf_handle_t rb = audio_element_get_output_ringbuf(s_aadp_handler.sink_stream);
+    if (rb) {
+        if (rb_bytes_filled(rb) == 0 && s_aadp_handler.sink_has_data) {
+            stats->underruns++;
         }
+        if (rb_bytes_available(rb) < (int)len) {
+            stats->overruns++;
+            stats->dropped_bytes += len;
+            return;
+        }
+    }
+    int ret = audio_element_output(s_aadp_handler.sink_stream, (char *)data, len);
+    if (ret > 0) {
+        stats->bytes += ret;
+        s_aadp_handler.sink_has_data = true;
     }
 }
 
@@ -256,15 +231,8 @@ static int32_t bt_a2d_source_data_cb(uint8_t *data, int32_t len)
 
 static esp_err_t a2dp_sink_destory(audio_element_handle_t self)
 {
-    ESP_LOGI(TAG, "a2dp_sink_destory");
-
-    a2dp_data_t destory_msg = {
-        .type = A2DP_TYPE_DESTORY,
-    };
-    if ( xQueueSend( s_aadp_handler.a2dp_queue, &destory_msg, 0 )  != pdPASS ) {
-        ESP_LOGE(TAG, "Destory audio_a2dp_stream_thread failed");
-        return ESP_FAIL;
-    }
+    ESP_LOGI(TAG, "a2dp_sink_destory, packets:%d, overruns:%d, underruns:%d", s_aadp_handler.sink_stats.packets,
+             s_aadp_handler.sink_stats.overruns, s_aadp_handler.sink_stats.underruns);
     s_aadp_handler.sink_stream = NULL;
     memset(&s_aadp_handler.user_callback, 0, sizeof(a2dp_stream_user_callback_t));
     return ESP_OK;
@@ -288,7 +256,10 @@ audio_element_handle_t a2dp_stream_init(a2dp_stream_config_t *config)
     }
 
     cfg.task_stack = -1; // No need task
-    cfg.tag = "aadp";    
+    cfg.tag = "aadp";
+    if (config->out_rb_size > 0) {
+        cfg.out_rb_size = config->out_rb_size;
+    }
 
     esp_avrc_ct_init();
     esp_avrc_ct_register_callback(bt_avrc_ct_cb);
@@ -309,6 +280,11 @@ audio_element_handle_t a2dp_stream_init(a2dp_stream_config_t *config)
         s_aadp_handler.stream_type = AUDIO_STREAM_READER;
         cfg.destroy = a2dp_sink_destory;
         el = s_aadp_handler.sink_stream = audio_element_init(&cfg);
+        AUDIO_MEM_CHECK(TAG, el, return NULL);
+        // The data callback runs in the BT task, the output must not wait for space
+        audio_element_set_output_timeout(el, 0);
+        memset(&s_aadp_handler.sink_stats, 0, sizeof(a2dp_stream_sink_stats_t));
+        s_aadp_handler.sink_has_data = false;
 
         esp_a2d_sink_register_data_callback(bt_a2d_sink_data_cb);
         esp_a2d_register_callback(bt_a2d_sink_cb);
@@ -327,21 +303,17 @@ audio_element_handle_t a2dp_stream_init(a2dp_stream_config_t *config)
     AUDIO_MEM_CHECK(TAG, el, return NULL);
     
     memcpy(&s_aadp_handler.user_callback, &config->user_callback, sizeof(a2dp_stream_user_callback_t));
+    return el;
+}
 
-    if ( config->type == AUDIO_STREAM_READER ) {
-        s_aadp_handler.a2dp_queue = xQueueCreate(A2DP_STREAM_QUEUE_SIZE, sizeof(a2dp_data_t));
-        if (s_aadp_handler.a2dp_queue == 0) {
-            ESP_LOGE(TAG, "Create a2dp queue failed(%d)", __LINE__);
-            return NULL;
-        }
-        esp_err_t err = audio_thread_create(&s_aadp_handler.a2dp_thread, "audio_a2dp_stream_thread", audio_a2dp_stream_thread, NULL,
-                                A2DP_STREAM_TASK_STACK, A2DP_STREAM_TASK_PRIO, A2DP_STREAM_TASK_IN_EXT, A2DP_STREAM_TASK_CORE);
-        if (err != ESP_OK) {
-            ESP_LOGE(TAG, "Create audio_a2dp_stream_thread failed(%d)", __LINE__);
-            return NULL;
-        }
+esp_err_t a2dp_stream_get_sink_stats(a2dp_stream_sink_stats_t *stats)
+{
+    AUDIO_NULL_CHECK(TAG, stats, return ESP_ERR_INVALID_ARG);
+    if (s_aadp_handler.sink_stream == NULL) {
+        return ESP_FAIL;
     }
-    return el;
+    memcpy(stats, &s_aadp_handler.sink_stats, sizeof(a2dp_stream_sink_stats_t));
+    return ESP_OK;
 }
 
 esp_err_t a2dp_destroy()
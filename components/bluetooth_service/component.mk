@@ -4,5 +4,6 @@
 # (Uses default behaviour of compiling all source files in directory, adding 'include' to include path.)
 
 COMPONENT_INCLUDEDIRS := include
-COMPONENT_SRCDIRS :=.
+COMPONENT_SRCDIRS :=. ./lib/hfp_jitter
+COMPONENT_PRIV_INCLUDEDIRS := ./lib/hfp_jitter/include
 
@@ -24,12 +24,15 @@
 
 #include <stdio.h>
 #include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
 #include "raw_stream.h"
 #include "audio_element.h"
 #include "audio_mem.h"
 #include "sdkconfig.h"
 #include "hfp_stream.h"
+#include "hfp_jitter.h"
 
 #if (defined CONFIG_CLASSIC_BT_ENABLED)
 static const char *TAG = "HFP_STREAM";
@@ -37,7 +40,19 @@ static const char *TAG = "HFP_STREAM";
 #define ESP_HFP_RINGBUF_SIZE     3600
 #define ESP_HFP_TASK_SIZE        2048
 #define ESP_HFP_TASK_PRIORITY    23
+#define ESP_HFP_FRAME_SIZE       240    // mSBC frame, 7.5ms of 16kHz 16bit mono
+#define ESP_HFP_FRAME_NUM        16
+#define ESP_HFP_FRAME_TIMEOUT_MS 20
+
+typedef struct {
+    hfp_stream_type_t   type;
+    hfp_jitter_handle_t jitter;     /*!< Frame ring between the SCO data callback and the element task */
+    SemaphoreHandle_t   frame_sem;  /*!< Incoming only, given for each SCO frame stored */
+    int                 frame_len;  /*!< Size of the last SCO frame */
+} hfp_stream_t;
+
 static bool is_get_data = true;
+static bool is_audio_connected = false;
 static hfp_stream_user_callback_t  hfp_stream_user_callback;
 static audio_element_handle_t hfp_incoming_stream = NULL;
 static audio_element_handle_t hfp_outgoing_stream = NULL;
@@ -193,27 +208,33 @@ esp_err_t hfp_open_and_close_evt_cb_register(esp_hf_audio_open_t open_cb, esp_hf
     return ESP_OK;
 }
 
+/**
+ * The SCO data callbacks run in the Bluetooth task, they only touch the frame rings and never wait for the pipeline.
+ * The element tasks move the frames between the rings and the ringbuffers of the pipeline.
+ */
 static uint32_t bt_app_hf_client_outgoing_cb(uint8_t *p_buf, uint32_t sz)
 {
-    int out_len_bytes = 0;
-    if (is_get_data) {
-        out_len_bytes = audio_element_input(hfp_outgoing_stream, (char *)p_buf, sz);
-    }
-
-    if (out_len_bytes == sz) {
-        is_get_data = false;
-        return sz;
-    } else {
+    if (hfp_outgoing_stream == NULL || is_get_data == false) {
         is_get_data = true;
         return 0;
     }
+    hfp_stream_t *hfp = (hfp_stream_t *)audio_element_getdata(hfp_outgoing_stream);
+    hfp->frame_len = sz;
+    // Always gives a full frame, silence or the last frame is sent when the pipeline is late
+    hfp_jitter_get(hfp->jitter, p_buf, sz);
+    is_get_data = false;
+    return sz;
 }
 
 static void bt_app_hf_client_incoming_cb(const uint8_t *buf, uint32_t sz)
 {
     if (hfp_incoming_stream) {
         if (audio_element_get_state(hfp_incoming_stream) == AEL_STATE_RUNNING) {
-            audio_element_output(hfp_incoming_stream, (char *)buf, sz);
+            hfp_stream_t *hfp = (hfp_stream_t *)audio_element_getdata(hfp_incoming_stream);
+            hfp->frame_len = sz;
+            if (hfp_jitter_put(hfp->jitter, buf, sz) > 0) {
+                xSemaphoreGive(hfp->frame_sem);
+            }
             esp_hf_client_outgoing_data_ready();
         }
     }
@@ -239,6 +260,12 @@ void bt_hf_client_cb(esp_hf_client_cb_event_t event, esp_hf_client_cb_param_t *p
                  c_audio_state_str[param->audio_stat.state]);
         if ((param->audio_stat.state == ESP_HF_CLIENT_AUDIO_STATE_CONNECTED)
             || (param->audio_stat.state == ESP_HF_CLIENT_AUDIO_STATE_CONNECTED_MSBC)) {
+            if (hfp_outgoing_stream) {
+                // No SCO data flows yet, it is safe to flush on behalf of the outgoing callback
+                hfp_stream_t *hfp = (hfp_stream_t *)audio_element_getdata(hfp_outgoing_stream);
+                hfp_jitter_flush(hfp->jitter);
+            }
+            is_audio_connected = true;
             if(hfp_stream_user_callback.user_hfp_open_cb != NULL) {
                 if (param->audio_stat.state == ESP_HF_CLIENT_AUDIO_STATE_CONNECTED) {
                     hfp_stream_user_callback.user_hfp_open_cb(HF_DATA_CVSD);
@@ -249,6 +276,7 @@ void bt_hf_client_cb(esp_hf_client_cb_event_t event, esp_hf_client_cb_param_t *p
             esp_hf_client_register_data_callback(bt_app_hf_client_incoming_cb,
                                                  bt_app_hf_client_outgoing_cb);
         } else if (param->audio_stat.state == ESP_HF_CLIENT_AUDIO_STATE_DISCONNECTED) {
+            is_audio_connected = false;
             if (hfp_stream_user_callback.user_hfp_close_cb != NULL) {
                 hfp_stream_user_callback.user_hfp_close_cb();
             }
@@ -346,46 +374,124 @@ esp_err_t hfp_service_init()
     return ESP_OK;
 }
 
+static esp_err_t _hfp_incoming_open(audio_element_handle_t self)
+{
+    hfp_stream_t *hfp = (hfp_stream_t *)audio_element_getdata(self);
+    hfp_jitter_flush(hfp->jitter);
+    while (xSemaphoreTake(hfp->frame_sem, 0) == pdTRUE);
+    return ESP_OK;
+}
+
+static int _hfp_incoming_process(audio_element_handle_t self, char *in_buffer, int in_len)
+{
+    hfp_stream_t *hfp = (hfp_stream_t *)audio_element_getdata(self);
+    if (xSemaphoreTake(hfp->frame_sem, pdMS_TO_TICKS(ESP_HFP_FRAME_TIMEOUT_MS)) != pdTRUE) {
+        if (is_audio_connected == false || hfp->frame_len == 0) {
+            return AEL_IO_TIMEOUT;
+        }
+        // A SCO frame is missing, keep the output going with a concealment frame
+    }
+    int len = hfp->frame_len > in_len ? in_len : hfp->frame_len;
+    hfp_jitter_get(hfp->jitter, (uint8_t *)in_buffer, len);
+    return audio_element_output(self, in_buffer, len);
+}
+
+static int _hfp_outgoing_process(audio_element_handle_t self, char *in_buffer, int in_len)
+{
+    hfp_stream_t *hfp = (hfp_stream_t *)audio_element_getdata(self);
+    int len = hfp->frame_len > in_len ? in_len : hfp->frame_len;
+    int r_size = audio_element_input(self, in_buffer, len);
+    if (r_size > 0 && is_audio_connected) {
+        // Dropped and counted as overrun when the SCO link takes less than the pipeline gives
+        hfp_jitter_put(hfp->jitter, (uint8_t *)in_buffer, r_size);
+    }
+    return r_size;
+}
+
 static esp_err_t _hfp_stream_destroy(audio_element_handle_t self)
 {
-    hfp_stream_config_t *hfp = (hfp_stream_config_t *)audio_element_getdata(self);
+    hfp_stream_t *hfp = (hfp_stream_t *)audio_element_getdata(self);
+    if (self == hfp_incoming_stream) {
+        hfp_incoming_stream = NULL;
+    } else if (self == hfp_outgoing_stream) {
+        hfp_outgoing_stream = NULL;
+    }
+    hfp_jitter_destroy(hfp->jitter);
+    if (hfp->frame_sem) {
+        vSemaphoreDelete(hfp->frame_sem);
+    }
     audio_free(hfp);
     return ESP_OK;
 }
 
+esp_err_t hfp_stream_get_stats(audio_element_handle_t el, hfp_stream_stats_t *stats)
+{
+    AUDIO_NULL_CHECK(TAG, el, return ESP_ERR_INVALID_ARG);
+    AUDIO_NULL_CHECK(TAG, stats, return ESP_ERR_INVALID_ARG);
+    hfp_stream_t *hfp = (hfp_stream_t *)audio_element_getdata(el);
+    hfp_jitter_stats_t jitter_stats;
+    hfp_jitter_get_stats(hfp->jitter, &jitter_stats);
+    stats->frames_in = jitter_stats.frames_in;
+    stats->frames_out = jitter_stats.frames_out;
+    stats->overruns = jitter_stats.overruns;
+    stats->underruns = jitter_stats.underruns;
+    stats->fills = jitter_stats.fills;
+    return ESP_OK;
+}
+
 audio_element_handle_t hfp_stream_init(hfp_stream_config_t *config)
 {
     AUDIO_NULL_CHECK(TAG, config, return NULL);
+    if (config->type != INCOMING_STREAM && config->type != OUTGOING_STREAM) {
+        ESP_LOGE(TAG, "error stream type");
+        return NULL;
+    }
     audio_element_handle_t el = NULL;
-    hfp_stream_config_t *hfp = audio_calloc(1, sizeof(hfp_stream_config_t));
+    hfp_stream_t *hfp = audio_calloc(1, sizeof(hfp_stream_t));
     AUDIO_MEM_CHECK(TAG, hfp, return NULL);
+    hfp->type = config->type;
+    hfp->frame_len = config->type == OUTGOING_STREAM ? ESP_HFP_FRAME_SIZE : 0;
+    hfp_jitter_cfg_t jitter_cfg = {
+        .frame_size = ESP_HFP_FRAME_SIZE,
+        .frame_num = ESP_HFP_FRAME_NUM,
+        .depth = config->jitter_depth > 0 ? config->jitter_depth : HFP_STREAM_JITTER_DEPTH,
+        .repeat_frame = config->repeat_on_underrun,
+    };
+    hfp->jitter = hfp_jitter_create(&jitter_cfg);
+    AUDIO_MEM_CHECK(TAG, hfp->jitter, goto _hfp_init_exit);
+
     audio_element_cfg_t cfg = DEFAULT_AUDIO_ELEMENT_CONFIG();
-    cfg.task_stack = -1; // No need task
+    cfg.task_stack = ESP_HFP_TASK_SIZE;
+    cfg.task_prio = ESP_HFP_TASK_PRIORITY;
     cfg.destroy = _hfp_stream_destroy;
-    hfp->type = config->type;
     if (config->type == INCOMING_STREAM) {
         ESP_LOGI(TAG, "incoming stream init");
+        hfp->frame_sem = xSemaphoreCreateCounting(ESP_HFP_FRAME_NUM, 0);
+        AUDIO_MEM_CHECK(TAG, hfp->frame_sem, goto _hfp_init_exit);
         cfg.tag = "hfp";
+        cfg.open = _hfp_incoming_open;
+        cfg.process = _hfp_incoming_process;
         el = audio_element_init(&cfg);
-        hfp_incoming_stream = el;
-        AUDIO_MEM_CHECK(TAG, el, {
-            audio_free(hfp);
-            return NULL;
-        });
+        AUDIO_MEM_CHECK(TAG, el, goto _hfp_init_exit);
         audio_element_setdata(el, hfp);
-    } else if (config->type == OUTGOING_STREAM) {
+        hfp_incoming_stream = el;
+    } else {
         ESP_LOGI(TAG, "outgoing stream init");
         cfg.tag = "hfp_outgoing";
+        cfg.process = _hfp_outgoing_process;
         el = audio_element_init(&cfg);
-        hfp_outgoing_stream = el;
-        AUDIO_MEM_CHECK(TAG, el, {
-            audio_free(hfp);
-            return NULL;
-        });
+        AUDIO_MEM_CHECK(TAG, el, goto _hfp_init_exit);
         audio_element_setdata(el, hfp);
-    } else {
-        ESP_LOGE(TAG, "error stream type");
+        hfp_outgoing_stream = el;
     }
     return el;
+
+_hfp_init_exit:
+    hfp_jitter_destroy(hfp->jitter);
+    if (hfp->frame_sem) {
+        vSemaphoreDelete(hfp->frame_sem);
+    }
+    audio_free(hfp);
+    return NULL;
 }
 #endif
@@ -56,16 +56,20 @@ typedef struct {
 #if (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 0, 0))
     audio_hal_handle_t          audio_hal;
 #endif
+    int                         out_rb_size;    /*!< Sink only, size of the output ringbuffer the A2DP data is written into.
+                                                     It is the jitter depth the sink can absorb, 0 for the element default */
 } a2dp_stream_config_t;
 
 /**
- * a2dp task is only created in a2dp sink mode
+ * @brief   A2DP sink data path statistics
  */
-#define A2DP_STREAM_TASK_STACK          ( 2 * 1024 )
-#define A2DP_STREAM_TASK_CORE           ( 0 )
-#define A2DP_STREAM_TASK_PRIO           ( 22 )
-#define A2DP_STREAM_TASK_IN_EXT         ( true )
-#define A2DP_STREAM_QUEUE_SIZE          ( 20 )
+typedef struct {
+    uint32_t packets;         /*!< Packets received from the A2DP sink data callback */
+    uint32_t bytes;           /*!< Bytes written into the output ringbuffer */
+    uint32_t overruns;        /*!< Packets dropped because the output ringbuffer was full */
+    uint32_t dropped_bytes;   /*!< Bytes of the dropped packets */
+    uint32_t underruns;       /*!< Times the output ringbuffer was found drained while streaming */
+} a2dp_stream_sink_stats_t;
 
 /**
  * @brief      Create a handle to an Audio Element to stream data from A2DP to another Element
@@ -78,6 +82,18 @@ typedef struct {
  */
 audio_element_handle_t a2dp_stream_init(a2dp_stream_config_t *config);
 
+/**
+ * @brief      Get the statistics of the A2DP sink data path
+ *
+ * @param[out] stats  The statistics
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_INVALID_ARG
+ *     - ESP_FAIL: The A2DP sink stream is not created
+ */
+esp_err_t a2dp_stream_get_sink_stats(a2dp_stream_sink_stats_t *stats);
+
 /**
  * @brief      Destroy and cleanup A2DP profile.
  *
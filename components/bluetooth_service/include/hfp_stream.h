@@ -55,8 +55,29 @@ typedef struct {
 
 typedef struct {
     hfp_stream_type_t         type;
+    int                       jitter_depth;         /*!< SCO frames buffered before playing, after start and after each underrun, 0 for HFP_STREAM_JITTER_DEPTH */
+    bool                      repeat_on_underrun;   /*!< Repeat the last frame once on underrun instead of playing silence */
 } hfp_stream_config_t;
 
+/**
+ * @brief   HFP stream statistics, counted in SCO frames
+ */
+typedef struct {
+    uint32_t frames_in;     /*!< Frames stored into the frame ring */
+    uint32_t frames_out;    /*!< Frames of data taken from the frame ring */
+    uint32_t overruns;      /*!< Frames dropped because the frame ring was full */
+    uint32_t underruns;     /*!< Frames the frame ring could not deliver while playing */
+    uint32_t fills;         /*!< Frames filled with silence or repetition, including while buffering to the jitter depth */
+} hfp_stream_stats_t;
+
+#define HFP_STREAM_JITTER_DEPTH     (3)
+
+#define HFP_STREAM_CFG_DEFAULT() {                  \
+    .type               = INCOMING_STREAM,          \
+    .jitter_depth       = HFP_STREAM_JITTER_DEPTH,  \
+    .repeat_on_underrun = true,                     \
+}
+
 /**
  * @brief      Register hfp audio open and close event callback function for application.
  *
@@ -81,6 +102,18 @@ esp_err_t hfp_service_init(void);
  * @return     The Audio Element handle
  */
 audio_element_handle_t hfp_stream_init(hfp_stream_config_t *config);
+
+/**
+ * @brief      Get the frame ring statistics of a hfp stream
+ *
+ * @param[in]  el     The hfp stream handle
+ * @param[out] stats  The statistics
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_INVALID_ARG
+ */
+esp_err_t hfp_stream_get_stats(audio_element_handle_t el, hfp_stream_stats_t *stats);
 #endif
 
 #ifdef __cplusplus
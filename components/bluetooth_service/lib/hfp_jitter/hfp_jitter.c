@@ -0,0 +1,186 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "audio_mem.h"
+#include "audio_error.h"
+#include "hfp_jitter.h"
+
+static const char *TAG = "HFP_JITTER";
+
+/* Head is only written by the producer and tail by the consumer, the barriers publish the data before the index */
+#define HFP_JITTER_LOAD(p)     __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define HFP_JITTER_STORE(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+
+struct hfp_jitter {
+    uint8_t  *buffer;
+    uint32_t size;          /*!< Ring size, power of two */
+    uint32_t head;          /*!< Total bytes written, owned by the producer */
+    uint32_t tail;          /*!< Total bytes read, owned by the consumer */
+    int      frame_size;
+    int      depth;
+    bool     repeat_frame;
+    bool     playing;       /*!< Depth reached, consumer takes data from the ring */
+    bool     repeated;      /*!< Last frame already repeated since the underrun */
+    uint8_t  *last_frame;
+    int      last_len;
+    uint32_t frames_in;     /*!< Producer side statistics */
+    uint32_t overruns;
+    uint32_t frames_out;    /*!< Consumer side statistics */
+    uint32_t underruns;
+    uint32_t fills;
+};
+
+hfp_jitter_handle_t hfp_jitter_create(const hfp_jitter_cfg_t *cfg)
+{
+    if (cfg == NULL || cfg->frame_size <= 0 || cfg->frame_num <= 0) {
+        return NULL;
+    }
+    struct hfp_jitter *jitter = audio_calloc(1, sizeof(struct hfp_jitter));
+    AUDIO_MEM_CHECK(TAG, jitter, return NULL);
+    jitter->size = 1;
+    while (jitter->size < (uint32_t)(cfg->frame_size * cfg->frame_num)) {
+        jitter->size <<= 1;
+    }
+    jitter->frame_size = cfg->frame_size;
+    jitter->depth = cfg->depth < 0 ? 0 : cfg->depth;
+    if (jitter->depth > cfg->frame_num) {
+        jitter->depth = cfg->frame_num;
+    }
+    jitter->repeat_frame = cfg->repeat_frame;
+    jitter->buffer = audio_malloc(jitter->size);
+    jitter->last_frame = audio_calloc(1, cfg->frame_size);
+    AUDIO_MEM_CHECK(TAG, jitter->buffer && jitter->last_frame, {
+        hfp_jitter_destroy(jitter);
+        return NULL;
+    });
+    return jitter;
+}
+
+int hfp_jitter_put(hfp_jitter_handle_t jitter, const uint8_t *data, int len)
+{
+    uint32_t head = jitter->head;
+    uint32_t tail = HFP_JITTER_LOAD(&jitter->tail);
+    if (len <= 0) {
+        return 0;
+    }
+    if ((uint32_t)len > jitter->size - (head - tail)) {
+        jitter->overruns++;
+        return 0;
+    }
+    uint32_t pos = head & (jitter->size - 1);
+    uint32_t first = jitter->size - pos;
+    if (first >= (uint32_t)len) {
+        memcpy(jitter->buffer + pos, data, len);
+    } else {
+        memcpy(jitter->buffer + pos, data, first);
+        memcpy(jitter->buffer, data + first, len - first);
+    }
+    HFP_JITTER_STORE(&jitter->head, head + len);
+    jitter->frames_in++;
+    return len;
+}
+
+static void hfp_jitter_fill(hfp_jitter_handle_t jitter, uint8_t *data, int len)
+{
+    jitter->fills++;
+    if (jitter->repeat_frame && jitter->repeated == false && jitter->last_len > 0) {
+        // Repeat once only, a longer gap sounds better as silence than as a buzz
+        jitter->repeated = true;
+        for (int i = 0; i < len; i += jitter->last_len) {
+            int n = len - i > jitter->last_len ? jitter->last_len : len - i;
+            memcpy(data + i, jitter->last_frame, n);
+        }
+        return;
+    }
+    memset(data, 0, len);
+}
+
+int hfp_jitter_get(hfp_jitter_handle_t jitter, uint8_t *data, int len)
+{
+    uint32_t tail = jitter->tail;
+    uint32_t filled = HFP_JITTER_LOAD(&jitter->head) - tail;
+    if (len <= 0) {
+        return 0;
+    }
+    if (jitter->playing == false) {
+        if (filled < (uint32_t)len || filled < (uint32_t)(jitter->depth * len)) {
+            hfp_jitter_fill(jitter, data, len);
+            return 0;
+        }
+        jitter->playing = true;
+    }
+    if (filled < (uint32_t)len) {
+        jitter->underruns++;
+        jitter->playing = false;
+        hfp_jitter_fill(jitter, data, len);
+        return 0;
+    }
+    uint32_t pos = tail & (jitter->size - 1);
+    uint32_t first = jitter->size - pos;
+    if (first >= (uint32_t)len) {
+        memcpy(data, jitter->buffer + pos, len);
+    } else {
+        memcpy(data, jitter->buffer + pos, first);
+        memcpy(data + first, jitter->buffer, len - first);
+    }
+    HFP_JITTER_STORE(&jitter->tail, tail + len);
+    jitter->frames_out++;
+    jitter->last_len = len > jitter->frame_size ? jitter->frame_size : len;
+    memcpy(jitter->last_frame, data + len - jitter->last_len, jitter->last_len);
+    jitter->repeated = false;
+    return len;
+}
+
+void hfp_jitter_flush(hfp_jitter_handle_t jitter)
+{
+    HFP_JITTER_STORE(&jitter->tail, HFP_JITTER_LOAD(&jitter->head));
+    jitter->playing = false;
+    jitter->repeated = false;
+    jitter->last_len = 0;
+}
+
+int hfp_jitter_filled(hfp_jitter_handle_t jitter)
+{
+    return HFP_JITTER_LOAD(&jitter->head) - HFP_JITTER_LOAD(&jitter->tail);
+}
+
+void hfp_jitter_get_stats(hfp_jitter_handle_t jitter, hfp_jitter_stats_t *stats)
+{
+    stats->frames_in = jitter->frames_in;
+    stats->frames_out = jitter->frames_out;
+    stats->overruns = jitter->overruns;
+    stats->underruns = jitter->underruns;
+    stats->fills = jitter->fills;
+}
+
+void hfp_jitter_destroy(hfp_jitter_handle_t jitter)
+{
+    if (jitter == NULL) {
+        return;
+    }
+    audio_free(jitter->buffer);
+    audio_free(jitter->last_frame);
+    audio_free(jitter);
+}
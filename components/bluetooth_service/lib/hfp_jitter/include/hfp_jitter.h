@@ -0,0 +1,132 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef HFP_JITTER_H
+#define HFP_JITTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Jitter buffer between the SCO data callbacks and the audio element task
+ *
+ *        It is a single producer, single consumer byte ring. `hfp_jitter_put` is only called by the producer
+ *        and `hfp_jitter_get` / `hfp_jitter_flush` only by the consumer, neither of them blocks or takes a lock.
+ *        Each call is one SCO frame, statistics are counted in those frames.
+ */
+typedef struct hfp_jitter *hfp_jitter_handle_t;
+
+/**
+ * @brief Jitter buffer configuration
+ */
+typedef struct {
+    int  frame_size;    /*!< Maximum bytes of one SCO frame */
+    int  frame_num;     /*!< Frames the ring can hold */
+    int  depth;         /*!< Frames buffered before the consumer starts taking data, after start and after each underrun */
+    bool repeat_frame;  /*!< Repeat the last frame once on underrun instead of playing silence */
+} hfp_jitter_cfg_t;
+
+/**
+ * @brief Jitter buffer statistics
+ */
+typedef struct {
+    uint32_t frames_in;     /*!< Frames stored by the producer */
+    uint32_t frames_out;    /*!< Frames of data delivered to the consumer */
+    uint32_t overruns;      /*!< Frames dropped because the ring was full */
+    uint32_t underruns;     /*!< Frames the ring could not deliver while playing */
+    uint32_t fills;         /*!< Frames filled with silence or repetition, including while buffering to the depth */
+} hfp_jitter_stats_t;
+
+/**
+ * @brief      Create a jitter buffer
+ *
+ * @param      cfg: Configuration
+ *
+ * @return     Jitter buffer instance, NULL on failure
+ */
+hfp_jitter_handle_t hfp_jitter_create(const hfp_jitter_cfg_t* cfg);
+
+/**
+ * @brief      Store one frame, called by the producer
+ *
+ * @param      jitter: Jitter buffer instance
+ * @param      data: Frame data
+ * @param      len: Frame size
+ *
+ * @return     len on success, 0 if the frame is dropped because the ring is full
+ */
+int hfp_jitter_put(hfp_jitter_handle_t jitter, const uint8_t* data, int len);
+
+/**
+ * @brief      Take one frame, called by the consumer
+ *
+ * @note       The output is always filled: with data when enough is buffered, otherwise with silence or the last frame
+ *
+ * @param      jitter: Jitter buffer instance
+ * @param      data: Output buffer
+ * @param      len: Frame size
+ *
+ * @return     Bytes of real data in the output, 0 when it is filled
+ */
+int hfp_jitter_get(hfp_jitter_handle_t jitter, uint8_t* data, int len);
+
+/**
+ * @brief      Drop buffered data and start buffering to the depth again, called by the consumer
+ *
+ * @param      jitter: Jitter buffer instance
+ */
+void hfp_jitter_flush(hfp_jitter_handle_t jitter);
+
+/**
+ * @brief      Get bytes buffered
+ *
+ * @param      jitter: Jitter buffer instance
+ *
+ * @return     Bytes buffered
+ */
+int hfp_jitter_filled(hfp_jitter_handle_t jitter);
+
+/**
+ * @brief      Get statistics
+ *
+ * @param      jitter: Jitter buffer instance
+ * @param      stats: Output statistics
+ */
+void hfp_jitter_get_stats(hfp_jitter_handle_t jitter, hfp_jitter_stats_t* stats);
+
+/**
+ * @brief      Destroy jitter buffer
+ *
+ * @param      jitter: Jitter buffer instance
+ */
+void hfp_jitter_destroy(hfp_jitter_handle_t jitter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,308 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "hfp_jitter.h"
+#include "host_test.h"
+
+/*
+ * Replay synthetic SCO schedules against the jitter buffer.
+ * Time is counted in microseconds, one SCO frame is 7.5 ms of audio.
+ */
+#define SCO_FRAME_US    (7500)
+#define SCO_FRAME_SIZE  (240)   // mSBC, 16 kHz 16 bit mono
+#define SCO_FRAMES      (4000)
+#define THREAD_FRAMES   (100000)
+
+static void make_frame(uint8_t* frame, uint32_t seq)
+{
+    for (int i = 0; i < SCO_FRAME_SIZE; i += 4) {
+        memcpy(frame + i, &seq, 4);
+    }
+}
+
+static uint32_t frame_seq(const uint8_t* frame)
+{
+    uint32_t seq;
+    memcpy(&seq, frame, 4);
+    for (int i = 4; i < SCO_FRAME_SIZE; i += 4) {
+        CHECK(memcmp(frame, frame + i, 4) == 0);
+    }
+    return seq;
+}
+
+static bool is_silence(const uint8_t* frame)
+{
+    for (int i = 0; i < SCO_FRAME_SIZE; i++) {
+        if (frame[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+typedef struct {
+    int      delay_us;      /*!< Extra delay added to the producer clock of each frame */
+    int      loss_start;    /*!< First frame lost by the link */
+    int      loss_num;      /*!< Frames lost by the link */
+    int      drift_ppm;     /*!< Producer clock is faster than the consumer clock */
+    int      burst;         /*!< Frames delivered back to back */
+} sco_schedule_t;
+
+typedef struct {
+    hfp_jitter_stats_t stats;
+    int                data_frames;
+    int                silence_frames;
+    int                repeat_frames;
+    uint32_t           max_seq;
+} sco_result_t;
+
+static int64_t producer_time(const sco_schedule_t* s, int i)
+{
+    int64_t t = (int64_t)i * SCO_FRAME_US - (int64_t)i * SCO_FRAME_US * s->drift_ppm / 1000000;
+    if (s->burst > 1) {
+        // Frames of a burst are held back and delivered together with the last one
+        t = ((int64_t)(i / s->burst) * s->burst + s->burst - 1) * SCO_FRAME_US;
+    }
+    if (s->delay_us) {
+        t += rand() % s->delay_us;
+    }
+    return t;
+}
+
+static sco_result_t replay(const sco_schedule_t* s, const hfp_jitter_cfg_t* cfg)
+{
+    sco_result_t r = { 0 };
+    hfp_jitter_handle_t jitter = hfp_jitter_create(cfg);
+    CHECK(jitter);
+    uint8_t  frame[SCO_FRAME_SIZE];
+    uint8_t  last[SCO_FRAME_SIZE] = { 0 };
+    int      next_in = 0;
+    int64_t  in_time = producer_time(s, 0);
+    uint32_t prev_seq = 0;
+    bool     has_prev = false;
+    // Consumer ticks every frame period, it starts one frame after the first SCO packet
+    for (int tick = 1; tick <= SCO_FRAMES + 64; tick++) {
+        int64_t now = (int64_t)tick * SCO_FRAME_US;
+        while (next_in < SCO_FRAMES && in_time <= now) {
+            if (next_in < s->loss_start || next_in >= s->loss_start + s->loss_num) {
+                make_frame(frame, next_in + 1);
+                hfp_jitter_put(jitter, frame, SCO_FRAME_SIZE);
+            }
+            next_in++;
+            int64_t t = producer_time(s, next_in);
+            in_time = t > in_time ? t : in_time;
+        }
+        if (next_in == SCO_FRAMES && hfp_jitter_filled(jitter) < SCO_FRAME_SIZE) {
+            // The call ended, the rest is not an underrun
+            break;
+        }
+        int ret = hfp_jitter_get(jitter, frame, SCO_FRAME_SIZE);
+        if (ret == SCO_FRAME_SIZE) {
+            uint32_t seq = frame_seq(frame);
+            CHECK(has_prev == false || seq > prev_seq);
+            prev_seq = seq;
+            has_prev = true;
+            r.max_seq = seq;
+            r.data_frames++;
+            memcpy(last, frame, SCO_FRAME_SIZE);
+        } else {
+            CHECK(ret == 0);
+            if (is_silence(frame)) {
+                r.silence_frames++;
+            } else {
+                CHECK(memcmp(frame, last, SCO_FRAME_SIZE) == 0);
+                r.repeat_frames++;
+            }
+        }
+    }
+    hfp_jitter_get_stats(jitter, &r.stats);
+    CHECK(r.stats.frames_out == r.data_frames);
+    CHECK(r.stats.fills == r.silence_frames + r.repeat_frames);
+    hfp_jitter_destroy(jitter);
+    return r;
+}
+
+static void print_result(const char* name, const sco_result_t* r)
+{
+    printf("%-28s in:%5u out:%5u overrun:%4u underrun:%4u fill:%4u (silence:%4d repeat:%3d)\n", name,
+           r->stats.frames_in, r->stats.frames_out, r->stats.overruns, r->stats.underruns, r->stats.fills,
+           r->silence_frames, r->repeat_frames);
+}
+
+static void test_steady(void)
+{
+    sco_schedule_t   s = { 0 };
+    hfp_jitter_cfg_t cfg = { .frame_size = SCO_FRAME_SIZE, .frame_num = 8, .depth = 2 };
+    sco_result_t     r = replay(&s, &cfg);
+    print_result("steady", &r);
+    CHECK(r.stats.frames_in == SCO_FRAMES);
+    CHECK(r.stats.overruns == 0);
+    CHECK(r.stats.underruns == 0);
+    // Only the buffering at start is filled, then every frame comes out in order
+    CHECK(r.stats.fills <= cfg.depth);
+    CHECK(r.max_seq == SCO_FRAMES);
+}
+
+static void test_jitter_absorbed(void)
+{
+    sco_schedule_t   s = { .delay_us = 3 * SCO_FRAME_US };
+    hfp_jitter_cfg_t cfg = { .frame_size = SCO_FRAME_SIZE, .frame_num = 8, .depth = 4 };
+    srand(1);
+    sco_result_t r = replay(&s, &cfg);
+    print_result("jitter 22.5ms, depth 4", &r);
+    CHECK(r.stats.underruns == 0);
+    CHECK(r.stats.overruns == 0);
+
+    cfg.depth = 0;
+    srand(1);
+    r = replay(&s, &cfg);
+    print_result("jitter 22.5ms, depth 0", &r);
+    CHECK(r.stats.underruns > 0);
+}
+
+static void test_burst(void)
+{
+    sco_schedule_t   s = { .burst = 3 };
+    hfp_jitter_cfg_t cfg = { .frame_size = SCO_FRAME_SIZE, .frame_num = 6, .depth = 3 };
+    sco_result_t     r = replay(&s, &cfg);
+    print_result("burst 3, depth 3", &r);
+    CHECK(r.stats.underruns == 0);
+    CHECK(r.stats.overruns == 0);
+}
+
+static void test_loss_concealment(void)
+{
+    sco_schedule_t   s = { .loss_start = 1000, .loss_num = 5 };
+    hfp_jitter_cfg_t cfg = { .frame_size = SCO_FRAME_SIZE, .frame_num = 8, .depth = 2, .repeat_frame = true };
+    sco_result_t     r = replay(&s, &cfg);
+    print_result("loss 5, repeat", &r);
+    CHECK(r.stats.underruns == 1);
+    CHECK(r.repeat_frames == 1);
+    CHECK(r.stats.overruns == 0);
+
+    cfg.repeat_frame = false;
+    r = replay(&s, &cfg);
+    print_result("loss 5, silence", &r);
+    CHECK(r.stats.underruns == 1);
+    CHECK(r.repeat_frames == 0);
+}
+
+static void test_drift_overrun(void)
+{
+    // The AG clock runs 2% fast, the ring fills up and frames are dropped instead of blocking the producer
+    sco_schedule_t   s = { .drift_ppm = 20000 };
+    hfp_jitter_cfg_t cfg = { .frame_size = SCO_FRAME_SIZE, .frame_num = 4, .depth = 2 };
+    sco_result_t     r = replay(&s, &cfg);
+    print_result("drift +2%, 4 frames", &r);
+    CHECK(r.stats.overruns > 0);
+    CHECK(r.stats.underruns == 0);
+    CHECK(r.stats.frames_in + r.stats.overruns == SCO_FRAMES);
+}
+
+static void test_odd_frame_size(void)
+{
+    // CVSD frames are smaller than the configured maximum, the ring still wraps on byte boundaries
+    hfp_jitter_cfg_t    cfg = { .frame_size = SCO_FRAME_SIZE, .frame_num = 3, .depth = 1 };
+    hfp_jitter_handle_t jitter = hfp_jitter_create(&cfg);
+    uint8_t             in[60], out[60];
+    CHECK(jitter);
+    for (int i = 0; i < 1000; i++) {
+        memset(in, i, sizeof(in));
+        CHECK(hfp_jitter_put(jitter, in, sizeof(in)) == sizeof(in));
+        CHECK(hfp_jitter_get(jitter, out, sizeof(out)) == sizeof(out));
+        CHECK(memcmp(in, out, sizeof(in)) == 0);
+    }
+    hfp_jitter_flush(jitter);
+    CHECK(hfp_jitter_filled(jitter) == 0);
+    hfp_jitter_destroy(jitter);
+}
+
+typedef struct {
+    hfp_jitter_handle_t jitter;
+    volatile int        done;
+} thread_ctx_t;
+
+static void* producer_thread(void* arg)
+{
+    thread_ctx_t* ctx = (thread_ctx_t*)arg;
+    uint8_t       frame[SCO_FRAME_SIZE];
+    for (uint32_t seq = 1; seq <= THREAD_FRAMES; seq++) {
+        make_frame(frame, seq);
+        // Retry when full so that both sides keep racing on the indexes
+        while (hfp_jitter_put(ctx->jitter, frame, SCO_FRAME_SIZE) == 0) {
+            sched_yield();
+        }
+    }
+    ctx->done = 1;
+    return NULL;
+}
+
+static void test_threads(void)
+{
+    // Free running producer and consumer on two threads, data must stay intact and in order
+    hfp_jitter_cfg_t cfg = { .frame_size = SCO_FRAME_SIZE, .frame_num = 16, .depth = 0 };
+    thread_ctx_t     ctx = { .jitter = hfp_jitter_create(&cfg) };
+    pthread_t        tid;
+    uint8_t          frame[SCO_FRAME_SIZE];
+    uint32_t         prev = 0;
+    int              got = 0;
+    CHECK(ctx.jitter);
+    pthread_create(&tid, NULL, producer_thread, &ctx);
+    while (ctx.done == 0 || hfp_jitter_filled(ctx.jitter)) {
+        if (hfp_jitter_get(ctx.jitter, frame, SCO_FRAME_SIZE) == SCO_FRAME_SIZE) {
+            uint32_t seq = frame_seq(frame);
+            CHECK(seq > prev);
+            prev = seq;
+            got++;
+        } else {
+            sched_yield();
+        }
+    }
+    pthread_join(tid, NULL);
+    hfp_jitter_stats_t stats;
+    hfp_jitter_get_stats(ctx.jitter, &stats);
+    printf("%-28s in:%5u out:%5u overrun(retried):%u\n", "threads", stats.frames_in, stats.frames_out, stats.overruns);
+    CHECK(stats.frames_out == got);
+    CHECK(got == THREAD_FRAMES);
+    hfp_jitter_destroy(ctx.jitter);
+}
+
+int main(int argc, char** argv)
+{
+    test_steady();
+    test_jitter_absorbed();
+    test_burst();
+    test_loss_concealment();
+    test_drift_overrun();
+    test_odd_frame_size();
+    test_threads();
+    printf("All passed\n");
+    return 0;
+}
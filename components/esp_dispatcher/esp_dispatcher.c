@@ -26,11 +26,12 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "freertos/task.h"
-#include "freertos/event_groups.h"
 #include "sys/queue.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 #include "esp_dispatcher.h"
+#include "esp_action_exe_type.h"
 #include "audio_mutex.h"
 #include "audio_mem.h"
 #include "audio_error.h"
@@ -38,137 +39,424 @@
 
 static const char *TAG = "DISPATCHER";
 
-#define  ESP_DISPATCHER_EVENT_SIZE  (3)
+#define  ESP_DISPATCHER_EVENT_SIZE        (3)
+#define  ESP_DISPATCHER_HIST_BASE_US      (256)
+#define  ESP_DISPATCHER_EXE_TABLE_SIZE    (16)
 
-typedef enum {
-    ESP_DISPCH_EVENT_TYPE_UNKNOWN,
-    ESP_DISPCH_EVENT_TYPE_CMD,
-    ESP_DISPCH_EVENT_TYPE_EXE,
-} esp_dispatcher_event_type_t;
-
-typedef struct {
-    esp_dispatcher_event_type_t     type;
-    int                             sub_index;
-    esp_action_exe                  pfunc;
-    void                            *instance;
-    action_arg_t                    arg;
-    func_ret_cb_t                   ret_cb;
-    void                            *user_data;
-} esp_dispatcher_info_t;
+typedef struct esp_dispatcher_job {
+    STAILQ_ENTRY(esp_dispatcher_job)        entries;
+    int                                     sub_index;
+    esp_action_exe                          pfunc;
+    void                                    *instance;
+    void                                    *order_key;
+    esp_dispatcher_lane_t                   lane;
+    action_arg_t                            arg;
+    func_ret_cb_t                           ret_cb;
+    void                                    *user_data;
+    bool                                    sync;
+    action_result_t                         result;
+    SemaphoreHandle_t                       done;
+} esp_dispatcher_job_t;
 
 typedef struct evt_exe_item {
     STAILQ_ENTRY(evt_exe_item)              entries;
     int                                     sub_index;
     esp_action_exe                          exe_func;
     void*                                   exe_instance;
+    esp_dispatcher_lane_t                   lane;
+    void*                                   order_key;
 } esp_action_exe_item_t;
 
+typedef struct {
+    esp_dispatcher_job_t                            jobs[ESP_DISPATCHER_EVENT_SIZE];
+    STAILQ_HEAD(pending_job_list, esp_dispatcher_job) pending;
+    STAILQ_HEAD(free_job_list, esp_dispatcher_job)  free;
+    SemaphoreHandle_t                               slots;
+    SemaphoreHandle_t                               send_lock;
+    esp_dispatcher_lane_stats_t                     stats;
+} esp_dispatcher_lane_ctx_t;
+
 typedef struct esp_dispatcher {
-    audio_thread_t                                 thread;
-    QueueHandle_t                                  exe_que;
-    QueueHandle_t                                  result_que;
+    int                                            worker_num;
+    int                                            worker_started;
+    TickType_t                                     send_ticks;
+    void                                           **running_keys;
+    bool                                           stopping;
     SemaphoreHandle_t                              mutex;
-    TaskHandle_t                                   task_handle;
-    STAILQ_HEAD(action_exe_list, evt_exe_item)     exe_list;
+    SemaphoreHandle_t                              wakeup;
+    SemaphoreHandle_t                              exited;
+    esp_dispatcher_lane_ctx_t                      lanes[ESP_DISPATCHER_LANE_MAX];
+    esp_action_exe_item_t                          **exe_table;
+    int                                            exe_table_size;
+    int                                            exe_num;
+    STAILQ_HEAD(func_attr_list, evt_exe_item)      func_list;
 } esp_dispatcher_t;
 
 
-static esp_err_t execute_index_exist(esp_dispatcher_handle_t h, int idx)
+// The registered actions are kept in an open addressing hash table indexed by the sparse
+// event index, so that the lookup on every execution does not depend on the number of actions.
+// The index families differ in the upper bits, so the slot is taken from the well mixed top
+// bits of the Fibonacci product, `size` is a power of two.
+static inline uint32_t exe_index_hash(int idx, int size)
+{
+    return ((uint32_t)idx * 2654435761u) >> (32 - __builtin_ctz(size));
+}
+
+static esp_action_exe_item_t *found_exe_func(esp_dispatcher_handle_t h, int idx)
 {
     esp_dispatcher_t *impl = (esp_dispatcher_t *)h;
-    esp_action_exe_item_t *item;
-    STAILQ_FOREACH(item, &impl->exe_list, entries) {
-        if (idx == item->sub_index) {
-            return ESP_OK;
+    if (impl->exe_table == NULL) {
+        return NULL;
+    }
+    uint32_t pos = exe_index_hash(idx, impl->exe_table_size);
+    while (impl->exe_table[pos]) {
+        if (impl->exe_table[pos]->sub_index == idx) {
+            return impl->exe_table[pos];
         }
+        pos = (pos + 1) & (impl->exe_table_size - 1);
     }
-    return ESP_FAIL;
+    return NULL;
 }
 
-static esp_action_exe_item_t *found_exe_func(esp_dispatcher_handle_t h, int idx)
+static esp_err_t execute_index_exist(esp_dispatcher_handle_t h, int idx)
+{
+    return found_exe_func(h, idx) ? ESP_OK : ESP_FAIL;
+}
+
+static void exe_table_insert(esp_action_exe_item_t **table, int size, esp_action_exe_item_t *item)
+{
+    uint32_t pos = exe_index_hash(item->sub_index, size);
+    while (table[pos]) {
+        pos = (pos + 1) & (size - 1);
+    }
+    table[pos] = item;
+}
+
+static esp_err_t exe_table_add(esp_dispatcher_t *impl, esp_action_exe_item_t *item)
+{
+    // Keep the load factor under 1/2 so that probe sequences stay short
+    if ((impl->exe_num + 1) * 2 > impl->exe_table_size) {
+        int size = impl->exe_table_size ? impl->exe_table_size * 2 : ESP_DISPATCHER_EXE_TABLE_SIZE;
+        esp_action_exe_item_t **table = audio_calloc(size, sizeof(esp_action_exe_item_t *));
+        AUDIO_MEM_CHECK(TAG, table, return ESP_ERR_NO_MEM);
+        for (int i = 0; i < impl->exe_table_size; i++) {
+            if (impl->exe_table[i]) {
+                exe_table_insert(table, size, impl->exe_table[i]);
+            }
+        }
+        audio_free(impl->exe_table);
+        impl->exe_table = table;
+        impl->exe_table_size = size;
+    }
+    exe_table_insert(impl->exe_table, impl->exe_table_size, item);
+    impl->exe_num++;
+    return ESP_OK;
+}
+
+static esp_action_exe_item_t *found_func_attr(esp_dispatcher_handle_t h, esp_action_exe func)
 {
     esp_dispatcher_t *impl = (esp_dispatcher_t *)h;
     esp_action_exe_item_t *item;
-    STAILQ_FOREACH(item, &impl->exe_list, entries) {
-        if (idx == item->sub_index) {
+    STAILQ_FOREACH(item, &impl->func_list, entries) {
+        if (func == item->exe_func) {
             return item;
         }
     }
     return NULL;
 }
 
+static esp_dispatcher_lane_t dispatcher_default_lane(int idx)
+{
+    // Player and volume actions are user visible, network actions may block for seconds
+    if (idx >= ACTION_EXE_TYPE_AUDIO_BASE && idx <= ACTION_EXE_TYPE_AUDIO_MAX) {
+        return ESP_DISPATCHER_LANE_HIGH;
+    }
+    if (idx >= ACTION_EXE_TYPE_CONNECTIVITY_BASE && idx <= ACTION_EXE_TYPE_CONNECTIVITY_MAX) {
+        return ESP_DISPATCHER_LANE_LOW;
+    }
+    return ESP_DISPATCHER_LANE_NORMAL;
+}
+
+static bool dispatcher_key_running(esp_dispatcher_t *impl, void *key)
+{
+    for (int i = 0; i < impl->worker_num; i++) {
+        if (impl->running_keys[i] == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int dispatcher_pending_num(esp_dispatcher_t *impl)
+{
+    int num = 0;
+    for (int i = 0; i < ESP_DISPATCHER_LANE_MAX; i++) {
+        num += impl->lanes[i].stats.queued;
+    }
+    return num;
+}
+
+// Must be called with impl->mutex held. Higher lanes first, FIFO inside a lane,
+// skipping the actions whose order key is being executed by another worker.
+static esp_dispatcher_job_t *dispatcher_pick_job(esp_dispatcher_t *impl)
+{
+    for (int i = 0; i < ESP_DISPATCHER_LANE_MAX; i++) {
+        esp_dispatcher_lane_ctx_t *lane = &impl->lanes[i];
+        esp_dispatcher_job_t *job;
+        STAILQ_FOREACH(job, &lane->pending, entries) {
+            if (job->order_key == NULL || dispatcher_key_running(impl, job->order_key) == false) {
+                STAILQ_REMOVE(&lane->pending, job, esp_dispatcher_job, entries);
+                lane->stats.queued--;
+                return job;
+            }
+        }
+    }
+    return NULL;
+}
+
+static void dispatcher_release_job(esp_dispatcher_t *impl, esp_dispatcher_job_t *job)
+{
+    esp_dispatcher_lane_ctx_t *lane = &impl->lanes[job->lane];
+    mutex_lock(impl->mutex);
+    STAILQ_INSERT_TAIL(&lane->free, job, entries);
+    mutex_unlock(impl->mutex);
+    xSemaphoreGive(lane->slots);
+}
+
+static void dispatcher_update_stats(esp_dispatcher_lane_stats_t *stats, uint32_t cost_us)
+{
+    uint32_t limit = ESP_DISPATCHER_HIST_BASE_US;
+    int bucket = 0;
+    while (bucket < ESP_DISPATCHER_EXE_HIST_NUM - 1 && cost_us >= limit) {
+        bucket++;
+        limit <<= 2;
+    }
+    stats->exe_time_hist[bucket]++;
+    stats->executed++;
+    if (cost_us > stats->exe_time_max_us) {
+        stats->exe_time_max_us = cost_us;
+    }
+}
+
 static void dispatcher_event_task(void *parameters)
 {
     esp_dispatcher_t *dispch = (esp_dispatcher_t *)parameters;
-    esp_dispatcher_info_t msg = {0};
-    action_result_t result = {0};
-    esp_action_exe_item_t *exe_item = NULL;
-    bool task_run = true;
-    ESP_LOGI(TAG, "%s is running...", __func__);
-    while (task_run) {
-        if (xQueueReceive(dispch->exe_que, &msg, portMAX_DELAY) == pdTRUE) {
-            if (msg.type == ESP_DISPCH_EVENT_TYPE_EXE) {
-                esp_action_exe exe_func = NULL;
-                void *exe_handle = NULL;
-                result.err = ESP_OK;
-                result.data = 0;
-                result.len = 0;
-                ESP_LOGD(TAG, "EXE type:%d, index:%x, pfunc:%p, %p, %d",
-                        msg.type, msg.sub_index, msg.pfunc, msg.arg.data, msg.arg.len);
-                if (msg.sub_index != -1) {
-                    exe_item = found_exe_func(dispch, msg.sub_index);
-                    if (exe_item) {
-                        exe_func = exe_item->exe_func;
-                        exe_handle = exe_item->exe_instance;
-                    } else {
-                        result.err = ESP_ERR_ADF_NOT_SUPPORT;
-                        ESP_LOGW(TAG, "Not found index:%x", msg.sub_index);
-                    }
-                } else if (msg.sub_index == -1 && msg.pfunc != NULL) {
-                    exe_func = msg.pfunc;
-                    exe_handle = msg.instance;
-                } else {
-                    result.err = ESP_ERR_ADF_NOT_SUPPORT;
-                    ESP_LOGW(TAG, "Unsupported type index:%x, pfunc:%p", msg.sub_index, msg.pfunc);
-                }
-                if (exe_func) {
-                    result.err = exe_func(exe_handle, &msg.arg, &result);
-                }
-                if (msg.ret_cb) {
-                    msg.ret_cb(result, msg.user_data);
-                } else {
-                    if (xQueueSend(dispch->result_que, &result, pdMS_TO_TICKS(0)) == pdFALSE) {
-                        ESP_LOGW(TAG, "Send result failed, pfunc: %p, index:%x", msg.pfunc, msg.sub_index);
-                    }
-                }
-            } else if (msg.type == ESP_DISPCH_EVENT_TYPE_CMD) {
-                task_run = false;
-            }
+    mutex_lock(dispch->mutex);
+    int id = dispch->worker_started++;
+    mutex_unlock(dispch->mutex);
+    ESP_LOGI(TAG, "%s %d is running...", __func__, id);
+    while (1) {
+        mutex_lock(dispch->mutex);
+        esp_dispatcher_job_t *job = dispatcher_pick_job(dispch);
+        if (job) {
+            dispch->running_keys[id] = job->order_key;
+        }
+        bool quit = (job == NULL && dispch->stopping && dispatcher_pending_num(dispch) == 0);
+        mutex_unlock(dispch->mutex);
+        if (quit) {
+            break;
+        }
+        if (job == NULL) {
+            xSemaphoreTake(dispch->wakeup, portMAX_DELAY);
+            continue;
+        }
+        ESP_LOGD(TAG, "EXE lane:%d, index:%x, pfunc:%p, %p, %d",
+                 job->lane, job->sub_index, job->pfunc, job->arg.data, job->arg.len);
+        int64_t start = esp_timer_get_time();
+        if (job->pfunc) {
+            job->result.err = job->pfunc(job->instance, &job->arg, &job->result);
+        }
+        uint32_t cost_us = (uint32_t)(esp_timer_get_time() - start);
+
+        mutex_lock(dispch->mutex);
+        dispch->running_keys[id] = NULL;
+        dispatcher_update_stats(&dispch->lanes[job->lane].stats, cost_us);
+        bool more = dispatcher_pending_num(dispch) > 0;
+        mutex_unlock(dispch->mutex);
+
+        if (job->sync) {
+            xSemaphoreGive(job->done);
         } else {
-            ESP_LOGE(TAG, "Unknown queue or receive error");
+            if (job->ret_cb) {
+                job->ret_cb(job->result, job->user_data);
+            }
+            dispatcher_release_job(dispch, job);
+        }
+        if (more) {
+            // The finished key may unblock an action another worker skipped
+            xSemaphoreGive(dispch->wakeup);
         }
     }
-    result.err = ESP_OK;
-    result.data = 0;
-    result.len = 0;
-    xQueueSend(dispch->result_que, &result, 0 / portTICK_PERIOD_MS);
+    // Chain the wakeup so that every worker notices the stop
+    xSemaphoreGive(dispch->wakeup);
+    xSemaphoreGive(dispch->exited);
     vTaskDelete(NULL);
 }
 
+static esp_err_t dispatcher_post(esp_dispatcher_t *impl, esp_dispatcher_job_t *req, action_result_t *out_result)
+{
+    mutex_lock(impl->mutex);
+    req->lane = ESP_DISPATCHER_LANE_NORMAL;
+    req->order_key = req->instance;
+    if (req->sub_index != -1) {
+        esp_action_exe_item_t *item = found_exe_func(impl, req->sub_index);
+        if (item) {
+            req->pfunc = item->exe_func;
+            req->instance = item->exe_instance;
+            req->lane = item->lane;
+            req->order_key = item->order_key;
+        } else {
+            req->result.err = ESP_ERR_ADF_NOT_SUPPORT;
+            ESP_LOGW(TAG, "Not found index:%x", req->sub_index);
+        }
+    } else if (req->pfunc != NULL) {
+        esp_action_exe_item_t *item = found_func_attr(impl, req->pfunc);
+        if (item) {
+            req->lane = item->lane;
+            if (item->order_key) {
+                req->order_key = item->order_key;
+            }
+        }
+    } else {
+        req->result.err = ESP_ERR_ADF_NOT_SUPPORT;
+        ESP_LOGW(TAG, "Unsupported type index:%x, pfunc:%p", req->sub_index, req->pfunc);
+    }
+    if (req->order_key == NULL && impl->worker_num > 1) {
+        // Actions without instance ran one by one on the single task, keep them serialized
+        req->order_key = impl;
+    }
+    mutex_unlock(impl->mutex);
+
+    // Senders of a lane queue up in order on the send lock, the head one waits for a free slot
+    esp_dispatcher_lane_ctx_t *lane = &impl->lanes[req->lane];
+    TickType_t start = xTaskGetTickCount();
+    BaseType_t queued = xSemaphoreTake(lane->send_lock, impl->send_ticks);
+    if (queued == pdTRUE) {
+        TickType_t wait = impl->send_ticks;
+        if (wait != portMAX_DELAY) {
+            TickType_t spent = xTaskGetTickCount() - start;
+            wait = spent < wait ? wait - spent : 0;
+        }
+        queued = xSemaphoreTake(lane->slots, wait);
+        mutex_unlock(lane->send_lock);
+    }
+    if (queued != pdTRUE) {
+        ESP_LOGE(TAG, "Send timeout lane:%d, index:%x", req->lane, req->sub_index);
+        return ESP_ERR_ADF_TIMEOUT;
+    }
+
+    mutex_lock(impl->mutex);
+    esp_dispatcher_job_t *job = STAILQ_FIRST(&lane->free);
+    STAILQ_REMOVE_HEAD(&lane->free, entries);
+    SemaphoreHandle_t done = job->done;
+    memcpy(job, req, sizeof(esp_dispatcher_job_t));
+    job->done = done;
+    job->sync = (out_result != NULL);
+    STAILQ_INSERT_TAIL(&lane->pending, job, entries);
+    if (++lane->stats.queued > lane->stats.queued_max) {
+        lane->stats.queued_max = lane->stats.queued;
+    }
+    mutex_unlock(impl->mutex);
+    xSemaphoreGive(impl->wakeup);
+
+    if (out_result == NULL) {
+        return ESP_OK;
+    }
+    xSemaphoreTake(job->done, portMAX_DELAY);
+    memcpy(out_result, &job->result, sizeof(action_result_t));
+    dispatcher_release_job(impl, job);
+    return out_result->err;
+}
+
 esp_err_t esp_dispatcher_reg_exe_func(esp_dispatcher_handle_t dh, void *exe_inst, int sub_event_index, esp_action_exe func)
 {
     esp_dispatcher_t *impl = (esp_dispatcher_t *)dh;
     AUDIO_NULL_CHECK(TAG, impl, return ESP_ERR_INVALID_ARG);
+    mutex_lock(impl->mutex);
     if (execute_index_exist(dh, sub_event_index) == ESP_OK) {
+        mutex_unlock(impl->mutex);
         ESP_LOGW(TAG, "The %x index of function already exists", sub_event_index);
         return ESP_ERR_ADF_ALREADY_EXISTS;
     }
     esp_action_exe_item_t *item = audio_calloc(1, sizeof(esp_action_exe_item_t));
+    AUDIO_MEM_CHECK(TAG, item, {
+        mutex_unlock(impl->mutex);
+        return ESP_ERR_NO_MEM;
+    });
     item->sub_index = sub_event_index;
     item->exe_func = func;
     item->exe_instance = exe_inst;
+    item->lane = dispatcher_default_lane(sub_event_index);
+    item->order_key = exe_inst;
 
-    STAILQ_INSERT_TAIL(&impl->exe_list, item, entries);
+    if (exe_table_add(impl, item) != ESP_OK) {
+        mutex_unlock(impl->mutex);
+        audio_free(item);
+        return ESP_ERR_NO_MEM;
+    }
+    mutex_unlock(impl->mutex);
+    return ESP_OK;
+}
+
+esp_err_t esp_dispatcher_set_exe_attr(esp_dispatcher_handle_t dh, int sub_event_index, const esp_dispatcher_exe_attr_t *attr)
+{
+    esp_dispatcher_t *impl = (esp_dispatcher_t *)dh;
+    AUDIO_NULL_CHECK(TAG, impl, return ESP_ERR_INVALID_ARG);
+    AUDIO_NULL_CHECK(TAG, attr, return ESP_ERR_INVALID_ARG);
+    if (attr->lane < 0 || attr->lane >= ESP_DISPATCHER_LANE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    mutex_lock(impl->mutex);
+    esp_action_exe_item_t *item = found_exe_func(impl, sub_event_index);
+    if (item == NULL) {
+        mutex_unlock(impl->mutex);
+        ESP_LOGW(TAG, "Not found index:%x", sub_event_index);
+        return ESP_ERR_ADF_NOT_FOUND;
+    }
+    item->lane = attr->lane;
+    item->order_key = attr->order_key ? attr->order_key : item->exe_instance;
+    mutex_unlock(impl->mutex);
+    return ESP_OK;
+}
+
+esp_err_t esp_dispatcher_set_func_attr(esp_dispatcher_handle_t dh, esp_action_exe func, const esp_dispatcher_exe_attr_t *attr)
+{
+    esp_dispatcher_t *impl = (esp_dispatcher_t *)dh;
+    AUDIO_NULL_CHECK(TAG, impl, return ESP_ERR_INVALID_ARG);
+    AUDIO_NULL_CHECK(TAG, func, return ESP_ERR_INVALID_ARG);
+    AUDIO_NULL_CHECK(TAG, attr, return ESP_ERR_INVALID_ARG);
+    if (attr->lane < 0 || attr->lane >= ESP_DISPATCHER_LANE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    mutex_lock(impl->mutex);
+    esp_action_exe_item_t *item = found_func_attr(impl, func);
+    if (item == NULL) {
+        item = audio_calloc(1, sizeof(esp_action_exe_item_t));
+        AUDIO_MEM_CHECK(TAG, item, {
+            mutex_unlock(impl->mutex);
+            return ESP_ERR_NO_MEM;
+        });
+        item->sub_index = -1;
+        item->exe_func = func;
+        STAILQ_INSERT_TAIL(&impl->func_list, item, entries);
+    }
+    item->lane = attr->lane;
+    item->order_key = attr->order_key;
+    mutex_unlock(impl->mutex);
+    return ESP_OK;
+}
+
+esp_err_t esp_dispatcher_get_lane_stats(esp_dispatcher_handle_t dh, esp_dispatcher_lane_t lane, esp_dispatcher_lane_stats_t *stats)
+{
+    esp_dispatcher_t *impl = (esp_dispatcher_t *)dh;
+    AUDIO_NULL_CHECK(TAG, impl, return ESP_ERR_INVALID_ARG);
+    AUDIO_NULL_CHECK(TAG, stats, return ESP_ERR_INVALID_ARG);
+    if (lane < 0 || lane >= ESP_DISPATCHER_LANE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    mutex_lock(impl->mutex);
+    memcpy(stats, &impl->lanes[lane].stats, sizeof(esp_dispatcher_lane_stats_t));
+    mutex_unlock(impl->mutex);
     return ESP_OK;
 }
 
@@ -177,28 +465,22 @@ esp_err_t esp_dispatcher_execute(esp_dispatcher_handle_t dh, int sub_event_index
 {
     esp_dispatcher_t *impl = (esp_dispatcher_t *)dh;
     AUDIO_NULL_CHECK(TAG, impl, return ESP_ERR_INVALID_ARG);
-    esp_dispatcher_info_t info = {0};
-    info.type = ESP_DISPCH_EVENT_TYPE_EXE;
+    esp_dispatcher_job_t info = {0};
     info.sub_index = sub_event_index;
     if (in_para) {
         memcpy(&info.arg, in_para, sizeof(action_arg_t));
     }
-    ESP_LOGI(TAG, "EXE IN, cmd type:%d, index:%x, data:%p, len:%d",
-             info.type, info.sub_index, info.arg.data, info.arg.len);
+    ESP_LOGI(TAG, "EXE IN, index:%x, data:%p, len:%d", info.sub_index, info.arg.data, info.arg.len);
 
-    mutex_lock(impl->mutex);
-    if (xQueueSend(impl->exe_que, &info, 5000 / portTICK_PERIOD_MS) == pdFALSE) {
-        ESP_LOGE(TAG, "Send timeout type:%d, index:%x", info.type, info.sub_index);
-        mutex_unlock(impl->mutex);
-        return ESP_ERR_ADF_TIMEOUT;
-    }
     action_result_t ret = {0};
-    xQueueReceive(impl->result_que, &ret, portMAX_DELAY);
-    mutex_unlock(impl->mutex);
+    esp_err_t err = dispatcher_post(impl, &info, &ret);
+    if (err == ESP_ERR_ADF_TIMEOUT) {
+        return err;
+    }
     if (out_result) {
         memcpy(out_result, &ret, sizeof(action_result_t));
     }
-    ESP_LOGI(TAG, "EXE OUT,result type:%d, index:%x, ret:%x, data:%p, len:%d", info.type, info.sub_index, ret.err, ret.data, ret.len);
+    ESP_LOGI(TAG, "EXE OUT, index:%x, ret:%x, data:%p, len:%d", info.sub_index, ret.err, ret.data, ret.len);
     return ret.err;
 }
 
@@ -207,8 +489,7 @@ esp_err_t esp_dispatcher_execute_async(esp_dispatcher_handle_t dh, int sub_event
 {
     esp_dispatcher_t *impl = (esp_dispatcher_t *)dh;
     AUDIO_NULL_CHECK(TAG, impl, return ESP_ERR_INVALID_ARG);
-    esp_dispatcher_info_t info = {0};
-    info.type = ESP_DISPCH_EVENT_TYPE_EXE;
+    esp_dispatcher_job_t info = {0};
     info.sub_index = sub_event_index;
     info.ret_cb = ret_cb;
     info.user_data = user_data;
@@ -216,19 +497,16 @@ esp_err_t esp_dispatcher_execute_async(esp_dispatcher_handle_t dh, int sub_event
     if (in_para) {
         memcpy(&info.arg, in_para, sizeof(action_arg_t));
     }
-    ESP_LOGI(TAG, "EXE IN, cmd type:%d, index:%x, data:%p, len:%d",
-             info.type, info.sub_index, info.arg.data, info.arg.len);
+    ESP_LOGI(TAG, "EXE IN, index:%x, data:%p, len:%d", info.sub_index, info.arg.data, info.arg.len);
 
-    mutex_lock(impl->mutex);
-    if (xQueueSend(impl->exe_que, &info, pdMS_TO_TICKS(5000)) != pdPASS) {
-        ESP_LOGE(TAG, "Message send timeout");
+    if (dispatcher_post(impl, &info, NULL) != ESP_OK) {
         action_result_t result = {0};
         result.err = ESP_FAIL;
-        ret_cb(result, user_data);
-        mutex_unlock(impl->mutex);
+        if (ret_cb) {
+            ret_cb(result, user_data);
+        }
         return ESP_ERR_ADF_TIMEOUT;
     }
-    mutex_unlock(impl->mutex);
     return ESP_OK;
 }
 
@@ -242,25 +520,17 @@ esp_err_t esp_dispatcher_execute_with_func(esp_dispatcher_handle_t dh,
     AUDIO_NULL_CHECK(TAG, impl, return ESP_ERR_INVALID_ARG);
     AUDIO_NULL_CHECK(TAG, ret, return ESP_ERR_INVALID_ARG);
 
-    esp_dispatcher_info_t delegate = { 0 };
-    delegate.type = ESP_DISPCH_EVENT_TYPE_EXE;
+    esp_dispatcher_job_t delegate = { 0 };
     delegate.sub_index = -1;
     delegate.pfunc = func;
     delegate.instance = instance;
-    delegate.ret_cb = NULL;
-    delegate.user_data = NULL;
     if (arg) {
         memcpy(&delegate.arg, arg, sizeof(action_arg_t));
     }
-    mutex_lock(impl->mutex);
-    if (xQueueSend(impl->exe_que, &delegate, pdMS_TO_TICKS(5000)) != pdPASS) {
+    if (dispatcher_post(impl, &delegate, ret) == ESP_ERR_ADF_TIMEOUT) {
         ret->err = ESP_FAIL;
-        ESP_LOGE(TAG, "Message send timeout");
-        mutex_unlock(impl->mutex);
         return ESP_ERR_ADF_TIMEOUT;
     }
-    xQueueReceive(impl->result_que, ret, portMAX_DELAY);
-    mutex_unlock(impl->mutex);
     return ret->err;
 }
 
@@ -274,8 +544,7 @@ esp_err_t esp_dispatcher_execute_with_func_async(esp_dispatcher_handle_t dh,
     esp_dispatcher_t *impl = (esp_dispatcher_t *)dh;
     AUDIO_NULL_CHECK(TAG, impl, return ESP_ERR_INVALID_ARG);
 
-    esp_dispatcher_info_t delegate = { 0 };
-    delegate.type = ESP_DISPCH_EVENT_TYPE_EXE;
+    esp_dispatcher_job_t delegate = { 0 };
     delegate.sub_index = -1;
     delegate.pfunc = func;
     delegate.instance = instance;
@@ -286,34 +555,101 @@ esp_err_t esp_dispatcher_execute_with_func_async(esp_dispatcher_handle_t dh,
         memcpy(&delegate.arg, arg, sizeof(action_arg_t));
     }
 
-    mutex_lock(impl->mutex);
-    if (xQueueSend(impl->exe_que, &delegate, pdMS_TO_TICKS(5000)) != pdPASS) {
-        ESP_LOGE(TAG, "Message send timeout");
+    if (dispatcher_post(impl, &delegate, NULL) != ESP_OK) {
         action_result_t result = {0};
         result.err = ESP_FAIL;
-        ret_cb(result, user_data);
-        mutex_unlock(impl->mutex);
+        if (ret_cb) {
+            ret_cb(result, user_data);
+        }
         return ESP_ERR_ADF_TIMEOUT;
     }
-    mutex_unlock(impl->mutex);
     return ESP_OK;
 }
 
+static void dispatcher_stop_workers(esp_dispatcher_t *impl, int num)
+{
+    mutex_lock(impl->mutex);
+    impl->stopping = true;
+    mutex_unlock(impl->mutex);
+    xSemaphoreGive(impl->wakeup);
+    for (int i = 0; i < num; i++) {
+        xSemaphoreTake(impl->exited, portMAX_DELAY);
+    }
+}
+
+static void dispatcher_free(esp_dispatcher_t *impl)
+{
+    esp_action_exe_item_t *item;
+    for (int i = 0; i < impl->exe_table_size; i++) {
+        audio_free(impl->exe_table[i]);
+    }
+    audio_free(impl->exe_table);
+    while ((item = STAILQ_FIRST(&impl->func_list)) != NULL) {
+        STAILQ_REMOVE_HEAD(&impl->func_list, entries);
+        audio_free(item);
+    }
+    for (int i = 0; i < ESP_DISPATCHER_LANE_MAX; i++) {
+        esp_dispatcher_lane_ctx_t *lane = &impl->lanes[i];
+        for (int j = 0; j < ESP_DISPATCHER_EVENT_SIZE; j++) {
+            if (lane->jobs[j].done) {
+                vSemaphoreDelete(lane->jobs[j].done);
+            }
+        }
+        if (lane->slots) {
+            vSemaphoreDelete(lane->slots);
+        }
+        if (lane->send_lock) {
+            mutex_destroy(lane->send_lock);
+        }
+    }
+    if (impl->wakeup) {
+        vSemaphoreDelete(impl->wakeup);
+    }
+    if (impl->exited) {
+        vSemaphoreDelete(impl->exited);
+    }
+    if (impl->mutex) {
+        mutex_destroy(impl->mutex);
+    }
+    audio_free(impl->running_keys);
+    audio_free(impl);
+}
+
 esp_dispatcher_handle_t esp_dispatcher_create(esp_dispatcher_config_t *cfg)
 {
     AUDIO_NULL_CHECK(TAG, cfg, return NULL);
     esp_dispatcher_handle_t impl = audio_calloc(1, sizeof(esp_dispatcher_t));
     AUDIO_MEM_CHECK(TAG, impl, return NULL);
-    impl->result_que = xQueueCreate(1, sizeof(action_result_t));
-    AUDIO_MEM_CHECK(TAG, impl->result_que, goto _failed;);
-    impl->exe_que = xQueueCreate(ESP_DISPATCHER_EVENT_SIZE, sizeof(esp_dispatcher_info_t));
-    AUDIO_MEM_CHECK(TAG, impl->exe_que, goto _failed;);
+    STAILQ_INIT(&impl->func_list);
+    impl->worker_num = cfg->worker_num > 0 ? cfg->worker_num : 1;
+    impl->send_ticks = cfg->send_timeout_ms > 0 ? pdMS_TO_TICKS(cfg->send_timeout_ms) : portMAX_DELAY;
+    impl->running_keys = audio_calloc(impl->worker_num, sizeof(void *));
+    AUDIO_MEM_CHECK(TAG, impl->running_keys, goto _failed);
     impl->mutex = mutex_create();
-    AUDIO_MEM_CHECK(TAG, impl->mutex, goto _failed;);
-    STAILQ_INIT(&impl->exe_list);
-    ESP_LOGE(TAG, "exe first list: %p", STAILQ_FIRST(&impl->exe_list));
+    AUDIO_MEM_CHECK(TAG, impl->mutex, goto _failed);
+    impl->wakeup = xSemaphoreCreateCounting(impl->worker_num + ESP_DISPATCHER_LANE_MAX * ESP_DISPATCHER_EVENT_SIZE, 0);
+    AUDIO_MEM_CHECK(TAG, impl->wakeup, goto _failed);
+    impl->exited = xSemaphoreCreateCounting(impl->worker_num, 0);
+    AUDIO_MEM_CHECK(TAG, impl->exited, goto _failed);
+    for (int i = 0; i < ESP_DISPATCHER_LANE_MAX; i++) {
+        esp_dispatcher_lane_ctx_t *lane = &impl->lanes[i];
+        STAILQ_INIT(&lane->pending);
+        STAILQ_INIT(&lane->free);
+        for (int j = 0; j < ESP_DISPATCHER_EVENT_SIZE; j++) {
+            lane->jobs[j].done = xSemaphoreCreateBinary();
+            AUDIO_MEM_CHECK(TAG, lane->jobs[j].done, goto _failed);
+            STAILQ_INSERT_TAIL(&lane->free, &lane->jobs[j], entries);
+        }
+        lane->slots = xSemaphoreCreateCounting(ESP_DISPATCHER_EVENT_SIZE, ESP_DISPATCHER_EVENT_SIZE);
+        AUDIO_MEM_CHECK(TAG, lane->slots, goto _failed);
+        lane->send_lock = mutex_create();
+        AUDIO_MEM_CHECK(TAG, lane->send_lock, goto _failed);
+    }
 
-    if (ESP_OK != audio_thread_create(&impl->thread,
+    int created = 0;
+    for (; created < impl->worker_num; created++) {
+        audio_thread_t thread = NULL;
+        if (ESP_OK != audio_thread_create(&thread,
                                           "esp_dispatcher",
                                           dispatcher_event_task,
                                           impl,
@@ -321,56 +657,23 @@ esp_dispatcher_handle_t esp_dispatcher_create(esp_dispatcher_config_t *cfg)
                                           cfg->task_prio,
                                           cfg->stack_in_ext,
                                           cfg->task_core)) {
-        ESP_LOGE(TAG, "Create task failed on %s", __func__);
-        goto _failed;
+            ESP_LOGE(TAG, "Create task failed on %s", __func__);
+            dispatcher_stop_workers(impl, created);
+            goto _failed;
+        }
     }
     return impl;
 _failed:
-    if (impl->result_que) {
-        vQueueDelete(impl->result_que);
-        impl->result_que = NULL;
-    }
-    if (impl->exe_que) {
-        vQueueDelete(impl->exe_que);
-        impl->exe_que = NULL;
-    }
-    if (impl->mutex) {
-        mutex_destroy(impl->mutex);
-        impl->mutex = NULL;
-    }
-    audio_free(impl);
-    impl = NULL;
-    return impl;
+    dispatcher_free(impl);
+    return NULL;
 }
 
 esp_err_t esp_dispatcher_destroy(esp_dispatcher_handle_t dh)
 {
     esp_dispatcher_t *impl = (esp_dispatcher_t *)dh;
     AUDIO_NULL_CHECK(TAG, impl, return ESP_ERR_INVALID_ARG);
-    esp_dispatcher_info_t info = {0};
-    action_result_t ret = {0};
-    info.type = ESP_DISPCH_EVENT_TYPE_CMD;
-    xQueueSend(impl->exe_que, &info, portMAX_DELAY);
-    xQueueReceive(impl->result_que, &ret, portMAX_DELAY);
-    esp_action_exe_item_t *item;
-    STAILQ_FOREACH(item, &impl->exe_list, entries) {
-        STAILQ_REMOVE(&impl->exe_list, item, evt_exe_item, entries);
-        audio_free(item);
-    }
-
-    if (impl->result_que) {
-        vQueueDelete(impl->result_que);
-        impl->result_que = NULL;
-    }
-    if (impl->exe_que) {
-        vQueueDelete(impl->exe_que);
-        impl->exe_que = NULL;
-    }
-    if (impl->mutex) {
-        mutex_destroy(impl->mutex);
-        impl->mutex = NULL;
-    }
-    audio_free(impl);
-    impl = NULL;
+    // Workers drain all the queued actions before exit
+    dispatcher_stop_workers(impl, impl->worker_num);
+    dispatcher_free(impl);
     return ESP_OK;
 }
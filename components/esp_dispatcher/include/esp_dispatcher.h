@@ -26,6 +26,7 @@
 #define __ESP_DISPATCHER_H__
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "esp_err.h"
 #include "esp_action_def.h"
@@ -37,6 +38,44 @@ extern "C" {
 #define DEFAULT_ESP_DISPATCHER_STACK_SIZE      (4*1024)
 #define DEFAULT_ESP_DISPATCHER_TASK_PRIO       (10)
 #define DEFAULT_ESP_DISPATCHER_TASK_CORE       (0)
+#define DEFAULT_ESP_DISPATCHER_WORKER_NUM      (1)
+
+#define ESP_DISPATCHER_EXE_HIST_NUM            (8)
+
+/**
+ * @brief The priority lanes of dispatcher, workers always take actions from the higher lane first
+ *
+ * @note  Actions registered in the `ACTION_EXE_TYPE_AUDIO_*` range go to the high lane,
+ *        the `ACTION_EXE_TYPE_CONNECTIVITY_*` range to the low lane and all others to the normal lane
+ *        unless changed by `esp_dispatcher_set_exe_attr`.
+ */
+typedef enum {
+    ESP_DISPATCHER_LANE_HIGH,                           /*!< Player and volume actions */
+    ESP_DISPATCHER_LANE_NORMAL,                         /*!< Default lane */
+    ESP_DISPATCHER_LANE_LOW,                            /*!< Slow actions, such as network and NVS */
+    ESP_DISPATCHER_LANE_MAX,
+} esp_dispatcher_lane_t;
+
+/**
+ * @brief The scheduling attribute of an execution function
+ */
+typedef struct {
+    esp_dispatcher_lane_t       lane;                   /*!< Lane the action is queued to */
+    void                        *order_key;             /*!< Actions with the same key never run concurrently, NULL to use the execution instance */
+} esp_dispatcher_exe_attr_t;
+
+/**
+ * @brief The statistics of one lane
+ */
+typedef struct {
+    int                         queued;                 /*!< Actions waiting in the lane */
+    int                         queued_max;             /*!< High watermark of `queued` */
+    uint32_t                    executed;               /*!< Number of executed actions */
+    uint32_t                    exe_time_max_us;        /*!< The longest execution time */
+    uint32_t                    exe_time_hist[ESP_DISPATCHER_EXE_HIST_NUM]; /*!< Execution time histogram, bucket n counts
+                                                                                 the actions took less than (256 << 2n) us,
+                                                                                 the last bucket counts all the longer ones */
+} esp_dispatcher_lane_stats_t;
 
 /**
  * @brief The dispatcher configuration
@@ -46,6 +85,8 @@ typedef struct {
     int                         task_prio;              /*!< Task priority (based on freeRTOS priority) */
     int                         task_core;              /*!< Task running in core (0 or 1) */
     bool                        stack_in_ext;           /*!< Try to allocate stack in external memory */
+    int                         worker_num;             /*!< Number of worker tasks, actions with different order keys run concurrently, actions without instance share one key, 0 means 1 */
+    int                         send_timeout_ms;        /*!< Time a caller waits for a free slot of the lane, 0 to wait until the action is queued */
 } esp_dispatcher_config_t;
 
 typedef struct esp_dispatcher *esp_dispatcher_handle_t;
@@ -60,6 +101,8 @@ typedef void (*func_ret_cb_t)(action_result_t ret, void *user_data);
     .task_prio = DEFAULT_ESP_DISPATCHER_TASK_PRIO, \
     .task_core = DEFAULT_ESP_DISPATCHER_TASK_CORE, \
     .stack_in_ext = false, \
+    .worker_num = DEFAULT_ESP_DISPATCHER_WORKER_NUM, \
+    .send_timeout_ms = 0, \
 }
 
 /**
@@ -99,6 +142,49 @@ esp_err_t esp_dispatcher_destroy(esp_dispatcher_handle_t handle);
  */
 esp_err_t esp_dispatcher_reg_exe_func(esp_dispatcher_handle_t handle, void *exe_inst, int sub_event_index, esp_action_exe func);
 
+/**
+ * brief      Change the lane and order key of a registered index of event
+ *
+ * @param handle            The ESP dispatcher instance
+ * @param sub_event_index   The index of event
+ * @param attr              The scheduling attribute
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_ADF_NOT_FOUND
+ *     - ESP_ERR_INVALID_ARG
+ */
+esp_err_t esp_dispatcher_set_exe_attr(esp_dispatcher_handle_t handle, int sub_event_index, const esp_dispatcher_exe_attr_t *attr);
+
+/**
+ * brief      Set the lane and order key used when `func` is invoked by `esp_dispatcher_execute_with_func*`
+ *
+ * @note       Without an attribute the function goes to the normal lane and is ordered by its execution instance
+ *
+ * @param handle            The ESP dispatcher instance
+ * @param func              The function to invoke
+ * @param attr              The scheduling attribute
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_NO_MEM
+ *     - ESP_ERR_INVALID_ARG
+ */
+esp_err_t esp_dispatcher_set_func_attr(esp_dispatcher_handle_t handle, esp_action_exe func, const esp_dispatcher_exe_attr_t *attr);
+
+/**
+ * brief      Get the queue depth and execution time statistics of a lane
+ *
+ * @param handle            The ESP dispatcher instance
+ * @param lane              The lane
+ * @param stats             The statistics
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_INVALID_ARG
+ */
+esp_err_t esp_dispatcher_get_lane_stats(esp_dispatcher_handle_t handle, esp_dispatcher_lane_t lane, esp_dispatcher_lane_stats_t *stats);
+
 /**
  * brief      Execution function with specific index of event.
  *            This is a synchronization interface.
@@ -0,0 +1,80 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) PTE LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include <string.h>
+
+#include "unity.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "audio_error.h"
+#include "esp_dispatcher.h"
+
+#define BENCH_ROUNDS      (1000)
+// Registered indexes sit at the start of their families (0x1001, 0x2001, ...), the layout
+// that defeats a hash taken from the low bits
+#define BENCH_INDEX(i)    ((((i) + 1) << 12) + 1)
+
+static esp_err_t bench_action(void *instance, action_arg_t *arg, action_result_t *result)
+{
+    result->err = ESP_OK;
+    return result->err;
+}
+
+TEST_CASE("esp_dispatcher dispatch overhead vs registered actions", "esp-adf")
+{
+    const int action_num[] = { 1, 16, 64, 256, 1024 };
+    // The per call logs of dispatcher would dominate the measurement
+    esp_log_level_set("DISPATCHER", ESP_LOG_WARN);
+    for (int n = 0; n < sizeof(action_num) / sizeof(action_num[0]); n++) {
+        esp_dispatcher_config_t d_cfg = ESP_DISPATCHER_CONFIG_DEFAULT();
+        esp_dispatcher_handle_t dispatcher = esp_dispatcher_create(&d_cfg);
+        TEST_ASSERT_NOT_NULL(dispatcher);
+
+        int64_t start = esp_timer_get_time();
+        for (int i = 0; i < action_num[n]; i++) {
+            TEST_ASSERT_EQUAL(ESP_OK, esp_dispatcher_reg_exe_func(dispatcher, NULL, BENCH_INDEX(i), bench_action));
+        }
+        int64_t reg_us = esp_timer_get_time() - start;
+        TEST_ASSERT_EQUAL(ESP_ERR_ADF_ALREADY_EXISTS, esp_dispatcher_reg_exe_func(dispatcher, NULL, BENCH_INDEX(0), bench_action));
+
+        // The last registered index was the worst case of the linear list
+        action_result_t result = { 0 };
+        start = esp_timer_get_time();
+        for (int i = 0; i < BENCH_ROUNDS; i++) {
+            TEST_ASSERT_EQUAL(ESP_OK, esp_dispatcher_execute(dispatcher, BENCH_INDEX(action_num[n] - 1), NULL, &result));
+        }
+        int64_t exe_us = esp_timer_get_time() - start;
+        TEST_ASSERT_EQUAL(ESP_ERR_ADF_NOT_SUPPORT, esp_dispatcher_execute(dispatcher, BENCH_INDEX(action_num[n]), NULL, &result));
+
+        ESP_LOGI("DISPATCHER_BENCH", "%4d actions, register %lld us, execute %lld us/call",
+                 action_num[n], reg_us, exe_us / BENCH_ROUNDS);
+        esp_dispatcher_destroy(dispatcher);
+    }
+    esp_log_level_set("DISPATCHER", ESP_LOG_INFO);
+}
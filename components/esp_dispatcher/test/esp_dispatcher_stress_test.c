@@ -33,6 +33,8 @@
 #include "esp_action_def.h"
 #include "esp_delegate.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_action_exe_type.h"
 
 #include "audio_thread.h"
 
@@ -111,3 +113,73 @@ TEST_CASE("esp_dispatcher stress test async", "esp-adf")
     vQueueDelete(que);
     esp_dispatcher_destroy(dispatcher);
 }
+
+static int running_cnt;
+static int running_max;
+
+static esp_err_t slow_action(void *instance, action_arg_t *arg, action_result_t *result)
+{
+    int cnt = __atomic_add_fetch(&running_cnt, 1, __ATOMIC_SEQ_CST);
+    if (cnt > running_max) {
+        running_max = cnt;
+    }
+    vTaskDelay(pdMS_TO_TICKS(200));
+    __atomic_sub_fetch(&running_cnt, 1, __ATOMIC_SEQ_CST);
+    result->err = ESP_OK;
+    return result->err;
+}
+
+static esp_err_t fast_action(void *instance, action_arg_t *arg, action_result_t *result)
+{
+    result->err = ESP_OK;
+    return result->err;
+}
+
+TEST_CASE("esp_dispatcher worker pool lanes and order key", "esp-adf")
+{
+    int net_inst, player_inst, keys[2];
+    esp_dispatcher_config_t d_cfg = ESP_DISPATCHER_CONFIG_DEFAULT();
+    d_cfg.worker_num = 2;
+    esp_dispatcher_handle_t dispatcher = esp_dispatcher_create(&d_cfg);
+    TEST_ASSERT_NOT_NULL(dispatcher);
+    que = xQueueCreate(10, sizeof(uint8_t));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_dispatcher_reg_exe_func(dispatcher, &net_inst, ACTION_EXE_TYPE_WIFI_CONNECT, slow_action));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_dispatcher_reg_exe_func(dispatcher, &player_inst, ACTION_EXE_TYPE_AUDIO_PLAY, fast_action));
+
+    // Same instance, the slow actions must not overlap even with two workers
+    running_max = 0;
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_dispatcher_execute_async(dispatcher, ACTION_EXE_TYPE_WIFI_CONNECT, NULL, invoke_cb, NULL));
+    }
+    // The player action is not stuck behind the network ones
+    int64_t start = esp_timer_get_time();
+    action_result_t result = { 0 };
+    TEST_ASSERT_EQUAL(ESP_OK, esp_dispatcher_execute(dispatcher, ACTION_EXE_TYPE_AUDIO_PLAY, NULL, &result));
+    TEST_ASSERT_LESS_THAN(100 * 1000, (int)(esp_timer_get_time() - start));
+    for (int i = 0; i < 3; i++) {
+        int cmd;
+        xQueueReceive(que, &cmd, portMAX_DELAY);
+    }
+    TEST_ASSERT_EQUAL(1, running_max);
+
+    esp_dispatcher_lane_stats_t stats = { 0 };
+    TEST_ASSERT_EQUAL(ESP_OK, esp_dispatcher_get_lane_stats(dispatcher, ESP_DISPATCHER_LANE_LOW, &stats));
+    TEST_ASSERT_EQUAL(3, stats.executed);
+    TEST_ASSERT_EQUAL(0, stats.queued);
+    TEST_ASSERT_EQUAL(3, stats.exe_time_hist[5]);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_dispatcher_get_lane_stats(dispatcher, ESP_DISPATCHER_LANE_HIGH, &stats));
+    TEST_ASSERT_EQUAL(1, stats.executed);
+
+    // Different keys run in parallel
+    running_max = 0;
+    for (int i = 0; i < 2; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_dispatcher_execute_with_func_async(dispatcher, slow_action, &keys[i], NULL, invoke_cb, NULL));
+    }
+    for (int i = 0; i < 2; i++) {
+        int cmd;
+        xQueueReceive(que, &cmd, portMAX_DELAY);
+    }
+    TEST_ASSERT_EQUAL(2, running_max);
+    vQueueDelete(que);
+    esp_dispatcher_destroy(dispatcher);
+}
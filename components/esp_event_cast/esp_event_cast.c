@@ -26,27 +26,83 @@
 #include <stdlib.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include "freertos/task.h"
 #include "audio_mutex.h"
 #include "esp_event_cast.h"
-#include "sys/queue.h"
 #include "audio_mem.h"
 #include "audio_error.h"
 #include "esp_log.h"
 
 static const char *TAG = "EVT_CAST";
 
+#define EVT_CAST_POOL_MAX_NUM   (32)
+#define EVT_CAST_ALIGN(x)       (((x) + 3) & ~3)
+
+/*
+ * Receivers are kept in a list that only grows, an unregistered node is cleared and reused by
+ * a later registration once no broadcaster holds it. So the broadcasters walk the list without lock, including from ISR,
+ * and unregister only has to wait the node is not in use by a broadcaster.
+ */
 typedef struct esp_evt_cast_item {
-    STAILQ_ENTRY(esp_evt_cast_item)     next;
+    struct esp_evt_cast_item            *next;
     xQueueHandle                        que;
+    bool                                by_ref;
+    uint32_t                            busy;
+    uint32_t                            dropped;
 } esp_evt_cast_item_t;
 
-typedef STAILQ_HEAD(esp_event_cast_list, esp_evt_cast_item) esp_event_cast_list_t;
+typedef struct {
+    uint32_t                            refcnt;
+    uint32_t                            index;
+} esp_evt_cast_payload_t;
 
 typedef struct esp_event_cast {
-    xSemaphoreHandle        _mux;
-    esp_event_cast_list_t   evt_list;
+    xSemaphoreHandle                    _mux;
+    esp_evt_cast_item_t                 *evt_list;
+    uint8_t                             *pool;
+    int                                 payload_size;
+    int                                 slot_size;
+    int                                 payload_num;
+    uint32_t                            free_mask;
 } esp_event_cast_t;
 
+static inline esp_evt_cast_item_t *evt_cast_first(esp_event_cast_handle_t handle)
+{
+    return __atomic_load_n(&handle->evt_list, __ATOMIC_ACQUIRE);
+}
+
+static inline xQueueHandle evt_cast_item_get(esp_evt_cast_item_t *item)
+{
+    __atomic_add_fetch(&item->busy, 1, __ATOMIC_SEQ_CST);
+    xQueueHandle que = __atomic_load_n(&item->que, __ATOMIC_SEQ_CST);
+    if (que == NULL) {
+        __atomic_sub_fetch(&item->busy, 1, __ATOMIC_RELEASE);
+    }
+    return que;
+}
+
+static inline void evt_cast_item_put(esp_evt_cast_item_t *item)
+{
+    __atomic_sub_fetch(&item->busy, 1, __ATOMIC_RELEASE);
+}
+
+static inline esp_evt_cast_payload_t *evt_cast_payload_hdr(esp_event_cast_handle_t handle, void *payload)
+{
+    esp_evt_cast_payload_t *hdr = (esp_evt_cast_payload_t *)((uint8_t *)payload - sizeof(esp_evt_cast_payload_t));
+    if (handle->pool == NULL || (uint8_t *)hdr < handle->pool
+        || (uint8_t *)hdr >= handle->pool + handle->slot_size * handle->payload_num
+        || ((uint8_t *)hdr - handle->pool) % handle->slot_size) {
+        return NULL;
+    }
+    return hdr;
+}
+
+static void evt_cast_payload_unref(esp_event_cast_handle_t handle, esp_evt_cast_payload_t *hdr)
+{
+    if (__atomic_sub_fetch(&hdr->refcnt, 1, __ATOMIC_ACQ_REL) == 0) {
+        __atomic_or_fetch(&handle->free_mask, 1u << hdr->index, __ATOMIC_RELEASE);
+    }
+}
 
 esp_event_cast_handle_t esp_event_cast_create(void)
 {
@@ -56,42 +112,67 @@ esp_event_cast_handle_t esp_event_cast_create(void)
     AUDIO_NULL_CHECK(TAG, obj->_mux, {audio_free(obj);
                                       return NULL;
                                      });
-    STAILQ_INIT(&obj->evt_list);
     return obj;
 }
 
 esp_err_t esp_event_cast_destroy(esp_event_cast_handle_t handle)
 {
     if (handle) {
-        esp_evt_cast_item_t *item, *tmp;
-        STAILQ_FOREACH_SAFE(item, &handle->evt_list, next, tmp) {
-            STAILQ_REMOVE(&handle->evt_list, item, esp_evt_cast_item, next);
+        esp_evt_cast_item_t *item = handle->evt_list;
+        while (item) {
+            esp_evt_cast_item_t *next = item->next;
             audio_free(item);
+            item = next;
         }
         mutex_destroy(handle->_mux);
-        free(handle);
+        audio_free(handle->pool);
+        audio_free(handle);
         return ESP_OK;
     }
     return ESP_FAIL;
 }
 
-esp_err_t esp_event_cast_register(esp_event_cast_handle_t handle, xQueueHandle que)
+static esp_err_t evt_cast_register(esp_event_cast_handle_t handle, xQueueHandle que, bool by_ref)
 {
     if ((handle == NULL) || (que == NULL)) {
         ESP_LOGE(TAG, "func:%s, invalid parameters, handle=%p, que=%p", __func__, handle, que);
         return ESP_FAIL;
     }
-    esp_evt_cast_item_t *local_list = audio_calloc(1, sizeof(esp_evt_cast_item_t));
-    AUDIO_MEM_CHECK(TAG, local_list, {return ESP_FAIL;});
     mutex_lock(handle->_mux);
-    local_list->que = que;
-    STAILQ_INSERT_TAIL(&handle->evt_list, local_list, next);
+    // A node still held by a broadcaster may pair the old queue with the new `by_ref`, skip it.
+    // Nobody takes the old queue once it is cleared, so an idle node stays consistent when reused.
+    esp_evt_cast_item_t *item = handle->evt_list;
+    while (item && (item->que || __atomic_load_n(&item->busy, __ATOMIC_SEQ_CST))) {
+        item = item->next;
+    }
+    if (item == NULL) {
+        item = audio_calloc(1, sizeof(esp_evt_cast_item_t));
+        AUDIO_MEM_CHECK(TAG, item, {
+            mutex_unlock(handle->_mux);
+            return ESP_FAIL;
+        });
+        item->next = handle->evt_list;
+        __atomic_store_n(&handle->evt_list, item, __ATOMIC_RELEASE);
+    }
+    item->by_ref = by_ref;
+    item->dropped = 0;
+    __atomic_store_n(&item->que, que, __ATOMIC_SEQ_CST);
     mutex_unlock(handle->_mux);
     ESP_LOGD(TAG, "INERT, list[%p], que:%p", handle, que);
 
     return ESP_OK;
 }
 
+esp_err_t esp_event_cast_register(esp_event_cast_handle_t handle, xQueueHandle que)
+{
+    return evt_cast_register(handle, que, false);
+}
+
+esp_err_t esp_event_cast_register_ref(esp_event_cast_handle_t handle, xQueueHandle que)
+{
+    return evt_cast_register(handle, que, true);
+}
+
 esp_err_t esp_event_cast_unregister(esp_event_cast_handle_t handle, xQueueHandle que)
 {
     if ((handle == NULL) || (que == NULL)) {
@@ -99,16 +180,20 @@ esp_err_t esp_event_cast_unregister(esp_event_cast_handle_t handle, xQueueHandle
         return ESP_FAIL;
     }
     mutex_lock(handle->_mux);
-    esp_evt_cast_item_t *item, *tmp;
-    STAILQ_FOREACH_SAFE(item,  &handle->evt_list, next, tmp) {
+    esp_evt_cast_item_t *item;
+    for (item = handle->evt_list; item; item = item->next) {
         ESP_LOGD(TAG, "func:%s, list=%p, que=%p, target que:%p", __func__, item, item->que, que);
         if (item->que == que) {
-            STAILQ_REMOVE(&handle->evt_list, item, esp_evt_cast_item, next);
-            audio_free(item);
+            __atomic_store_n(&item->que, NULL, __ATOMIC_SEQ_CST);
             break;
         }
     }
     mutex_unlock(handle->_mux);
+    // The queue may be deleted once we return, wait for the broadcasters using it. This is done
+    // without lock, a broadcaster that takes the node after it is reused never sees the old queue.
+    while (item && __atomic_load_n(&item->busy, __ATOMIC_SEQ_CST)) {
+        vTaskDelay(1);
+    }
     ESP_LOGD(TAG, "func:%s, que size=%d", __func__, esp_event_cast_get_count(handle));
     return 0;
 }
@@ -119,18 +204,20 @@ esp_err_t esp_event_cast_broadcasting(esp_event_cast_handle_t handle, void *data
         ESP_LOGE(TAG, "func:%s, invalid parameters, handle=%p, data=%p", __func__, handle, data);
         return ESP_FAIL;
     }
-    mutex_lock(handle->_mux);
-
-    esp_evt_cast_item_t *item, *tmp;
-    STAILQ_FOREACH_SAFE(item,  &handle->evt_list, next, tmp) {
-        ESP_LOGD(TAG, "func:%s, list=%p, que=%p, data:%p", __func__, item, item->que, data);
-        if (item->que) {
-            if (pdFALSE == xQueueSend(item->que, data, 0)) {
-                ESP_LOGW(TAG, "Queue[%p] send failed, free size:%d", item->que, uxQueueSpacesAvailable(item->que));
+    esp_evt_cast_item_t *item;
+    for (item = evt_cast_first(handle); item; item = item->next) {
+        xQueueHandle que = evt_cast_item_get(item);
+        if (que && item->by_ref) {
+            evt_cast_item_put(item);
+        } else if (que) {
+            ESP_LOGD(TAG, "func:%s, list=%p, que=%p, data:%p", __func__, item, que, data);
+            if (pdFALSE == xQueueSend(que, data, 0)) {
+                __atomic_add_fetch(&item->dropped, 1, __ATOMIC_RELAXED);
+                ESP_LOGW(TAG, "Queue[%p] send failed, free size:%d", que, uxQueueSpacesAvailable(que));
             }
+            evt_cast_item_put(item);
         }
     }
-    mutex_unlock(handle->_mux);
     return 0;
 }
 
@@ -140,16 +227,22 @@ esp_err_t esp_event_cast_broadcasting_isr(esp_event_cast_handle_t handle, void *
         ESP_EARLY_LOGE(TAG, "func:%s, invalid parameters, handle=%p, data=%p", __func__, handle, data);
         return ESP_FAIL;
     }
-    mutex_lock(handle->_mux);
-    esp_evt_cast_item_t *item, *tmp;
-    STAILQ_FOREACH_SAFE(item,  &handle->evt_list, next, tmp) {
-        if (item->que) {
-            if (pdFALSE == xQueueSendFromISR(item->que, data, 0)) {
-                ESP_EARLY_LOGW(TAG, "Queue[%p] send failed, free size:%d", item->que, uxQueueSpacesAvailable(item->que));
+    BaseType_t woken = pdFALSE;
+    esp_evt_cast_item_t *item;
+    for (item = evt_cast_first(handle); item; item = item->next) {
+        xQueueHandle que = evt_cast_item_get(item);
+        if (que && item->by_ref) {
+            evt_cast_item_put(item);
+        } else if (que) {
+            if (pdFALSE == xQueueSendFromISR(que, data, &woken)) {
+                __atomic_add_fetch(&item->dropped, 1, __ATOMIC_RELAXED);
             }
+            evt_cast_item_put(item);
         }
     }
-    mutex_unlock(handle->_mux);
+    if (woken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
     return 0;
 }
 
@@ -159,12 +252,132 @@ esp_err_t esp_event_cast_get_count(esp_event_cast_handle_t handle)
         ESP_LOGE(TAG, "func:%s, invalid parameters, handle=%p", __func__, handle);
         return ESP_FAIL;
     }
-    mutex_lock(handle->_mux);
     int cnt = 0;
-    esp_evt_cast_item_t *item, *tmp;
-    STAILQ_FOREACH_SAFE(item,  &handle->evt_list, next, tmp) {
-        cnt ++;
+    esp_evt_cast_item_t *item;
+    for (item = evt_cast_first(handle); item; item = item->next) {
+        if (__atomic_load_n(&item->que, __ATOMIC_ACQUIRE)) {
+            cnt ++;
+        }
     }
-    mutex_unlock(handle->_mux);
     return cnt;
 }
+
+esp_err_t esp_event_cast_get_dropped(esp_event_cast_handle_t handle, xQueueHandle que, uint32_t *dropped)
+{
+    if ((handle == NULL) || (que == NULL) || (dropped == NULL)) {
+        ESP_LOGE(TAG, "func:%s, invalid parameters, handle=%p, que=%p", __func__, handle, que);
+        return ESP_FAIL;
+    }
+    esp_evt_cast_item_t *item;
+    for (item = evt_cast_first(handle); item; item = item->next) {
+        if (__atomic_load_n(&item->que, __ATOMIC_ACQUIRE) == que) {
+            *dropped = __atomic_load_n(&item->dropped, __ATOMIC_RELAXED);
+            return ESP_OK;
+        }
+    }
+    return ESP_FAIL;
+}
+
+esp_err_t esp_event_cast_setup_pool(esp_event_cast_handle_t handle, int payload_size, int payload_num)
+{
+    if ((handle == NULL) || (payload_size <= 0) || (payload_num <= 0) || (payload_num > EVT_CAST_POOL_MAX_NUM)) {
+        ESP_LOGE(TAG, "func:%s, invalid parameters, handle=%p, size=%d, num=%d", __func__, handle, payload_size, payload_num);
+        return ESP_FAIL;
+    }
+    if (handle->pool) {
+        ESP_LOGE(TAG, "The payload pool already exists");
+        return ESP_FAIL;
+    }
+    int slot_size = EVT_CAST_ALIGN(sizeof(esp_evt_cast_payload_t) + payload_size);
+    handle->pool = audio_calloc(payload_num, slot_size);
+    AUDIO_MEM_CHECK(TAG, handle->pool, return ESP_FAIL);
+    for (int i = 0; i < payload_num; i++) {
+        ((esp_evt_cast_payload_t *)(handle->pool + i * slot_size))->index = i;
+    }
+    handle->payload_size = payload_size;
+    handle->slot_size = slot_size;
+    handle->payload_num = payload_num;
+    __atomic_store_n(&handle->free_mask, (payload_num == 32) ? 0xFFFFFFFF : ((1u << payload_num) - 1), __ATOMIC_RELEASE);
+    return ESP_OK;
+}
+
+void *esp_event_cast_alloc(esp_event_cast_handle_t handle)
+{
+    if ((handle == NULL) || (handle->pool == NULL)) {
+        return NULL;
+    }
+    uint32_t mask = __atomic_load_n(&handle->free_mask, __ATOMIC_ACQUIRE);
+    while (mask) {
+        uint32_t bit = mask & (~mask + 1);
+        if (__atomic_compare_exchange_n(&handle->free_mask, &mask, mask & ~bit, true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            esp_evt_cast_payload_t *hdr = (esp_evt_cast_payload_t *)(handle->pool + __builtin_ctz(bit) * handle->slot_size);
+            __atomic_store_n(&hdr->refcnt, 1, __ATOMIC_RELAXED);
+            return (uint8_t *)hdr + sizeof(esp_evt_cast_payload_t);
+        }
+    }
+    return NULL;
+}
+
+esp_err_t esp_event_cast_release(esp_event_cast_handle_t handle, void *payload)
+{
+    if ((handle == NULL) || (payload == NULL)) {
+        return ESP_FAIL;
+    }
+    esp_evt_cast_payload_t *hdr = evt_cast_payload_hdr(handle, payload);
+    if (hdr == NULL) {
+        return ESP_FAIL;
+    }
+    evt_cast_payload_unref(handle, hdr);
+    return ESP_OK;
+}
+
+static esp_err_t evt_cast_publish(esp_event_cast_handle_t handle, void *payload, bool from_isr)
+{
+    if ((handle == NULL) || (payload == NULL)) {
+        return ESP_FAIL;
+    }
+    esp_evt_cast_payload_t *hdr = evt_cast_payload_hdr(handle, payload);
+    if (hdr == NULL) {
+        return ESP_FAIL;
+    }
+    BaseType_t woken = pdFALSE;
+    esp_evt_cast_item_t *item;
+    for (item = evt_cast_first(handle); item; item = item->next) {
+        xQueueHandle que = evt_cast_item_get(item);
+        if (que == NULL) {
+            continue;
+        }
+        BaseType_t ret;
+        if (item->by_ref) {
+            // Take the reference before the receiver could get and release it
+            __atomic_add_fetch(&hdr->refcnt, 1, __ATOMIC_RELAXED);
+            ret = from_isr ? xQueueSendFromISR(que, &payload, &woken) : xQueueSend(que, &payload, 0);
+            if (ret == pdFALSE) {
+                evt_cast_payload_unref(handle, hdr);
+            }
+        } else {
+            // Receivers registered by `esp_event_cast_register` still get their own copy
+            ret = from_isr ? xQueueSendFromISR(que, payload, &woken) : xQueueSend(que, payload, 0);
+        }
+        if (ret == pdFALSE) {
+            __atomic_add_fetch(&item->dropped, 1, __ATOMIC_RELAXED);
+        }
+        evt_cast_item_put(item);
+    }
+    // Drop the publisher's reference
+    evt_cast_payload_unref(handle, hdr);
+    if (from_isr && woken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_event_cast_publish(esp_event_cast_handle_t handle, void *payload)
+{
+    return evt_cast_publish(handle, payload, false);
+}
+
+esp_err_t esp_event_cast_publish_isr(esp_event_cast_handle_t handle, void *payload)
+{
+    return evt_cast_publish(handle, payload, true);
+}
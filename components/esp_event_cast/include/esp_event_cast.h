@@ -71,6 +71,22 @@ esp_err_t esp_event_cast_register(esp_event_cast_handle_t handle, xQueueHandle q
  */
 esp_err_t esp_event_cast_unregister(esp_event_cast_handle_t handle, xQueueHandle que);
 
+/**
+ * @brief Add queue to esp_event_cast_handle_t object as a receiver of shared payloads
+ *
+ * @note The queue item size must be `sizeof(void *)`, it receives the payload pointers published by
+ *       `esp_event_cast_publish`, and the receiver must call `esp_event_cast_release` after use.
+ *       `esp_event_cast_broadcasting` doesn't send to this kind of receiver.
+ *
+ * @param  handle:  A poniter to esp_event_cast_handle_t
+ * @praram que:     The specific queue as receiver added to esp_event_cast_handle_t instance
+ *
+ * @return
+ *     - ESP_OK: success
+ *     - ESP_FAIL: others
+ */
+esp_err_t esp_event_cast_register_ref(esp_event_cast_handle_t handle, xQueueHandle que);
+
 /**
  * @brief Broadcasting the data to receiver
  *
@@ -86,7 +102,7 @@ esp_err_t esp_event_cast_broadcasting(esp_event_cast_handle_t handle, void *data
 /**
  * @brief Broadcasting the data to receiver from ISR
  *
- * @note This API is untested
+ * @note The receivers are walked without lock, so it's safe to call from ISR
  *
  * @param  handle: A poniter to esp_event_cast_handle_t
  * @param  data:   Data packet will be broadcasting
@@ -108,4 +124,82 @@ esp_err_t esp_event_cast_broadcasting_isr(esp_event_cast_handle_t handle, void *
  */
 esp_err_t esp_event_cast_get_count(esp_event_cast_handle_t handle);
 
+/**
+ * @brief Get the number of events dropped because the receiver queue was full
+ *
+ * @param  handle:  A poniter to esp_event_cast_handle_t
+ * @param  que:     The registered receiver
+ * @param  dropped: The dropped events since registered
+ *
+ * @return
+ *     - ESP_OK: success
+ *     - ESP_FAIL: not registered or invalid parameters
+ */
+esp_err_t esp_event_cast_get_dropped(esp_event_cast_handle_t handle, xQueueHandle que, uint32_t *dropped);
+
+/**
+ * @brief Create the reference counted payload pool used by `esp_event_cast_publish`
+ *
+ * @param  handle:       A poniter to esp_event_cast_handle_t
+ * @param  payload_size: Size of each payload
+ * @param  payload_num:  Number of payloads, up to 32
+ *
+ * @return
+ *     - ESP_OK: success
+ *     - ESP_FAIL: others
+ */
+esp_err_t esp_event_cast_setup_pool(esp_event_cast_handle_t handle, int payload_size, int payload_num);
+
+/**
+ * @brief Take a free payload from the pool, can be called from ISR
+ *
+ * @param  handle: A poniter to esp_event_cast_handle_t
+ *
+ * @return
+ *     - Valid pointer: the payload, hold by the caller until published or released
+ *     - NULL: pool exhausted or not set up
+ */
+void *esp_event_cast_alloc(esp_event_cast_handle_t handle);
+
+/**
+ * @brief Release a reference of the payload, it goes back to the pool when the last reference is released
+ *
+ * @param  handle:  A poniter to esp_event_cast_handle_t
+ * @param  payload: The payload got from `esp_event_cast_alloc` or a receiver queue
+ *
+ * @return
+ *     - ESP_OK: success
+ *     - ESP_FAIL: the payload doesn't belong to the pool
+ */
+esp_err_t esp_event_cast_release(esp_event_cast_handle_t handle, void *payload);
+
+/**
+ * @brief Publish a payload without copy
+ *
+ * The payload pointer is sent to every receiver registered by `esp_event_cast_register_ref`, each of them
+ * holds a reference. Receivers registered by `esp_event_cast_register` get a copy of the payload, so their
+ * queue item size must not be larger than the payload size. The caller's reference is consumed whatever
+ * the result, don't touch the payload after this call.
+ *
+ * @param  handle:  A poniter to esp_event_cast_handle_t
+ * @param  payload: The payload got from `esp_event_cast_alloc`
+ *
+ * @return
+ *     - ESP_OK: success
+ *     - ESP_FAIL: others
+ */
+esp_err_t esp_event_cast_publish(esp_event_cast_handle_t handle, void *payload);
+
+/**
+ * @brief The same as `esp_event_cast_publish` but called from ISR, it doesn't take any lock
+ *
+ * @param  handle:  A poniter to esp_event_cast_handle_t
+ * @param  payload: The payload got from `esp_event_cast_alloc`
+ *
+ * @return
+ *     - ESP_OK: success
+ *     - ESP_FAIL: others
+ */
+esp_err_t esp_event_cast_publish_isr(esp_event_cast_handle_t handle, void *payload);
+
 #endif  //__ESP_EVENT_CAST_H__
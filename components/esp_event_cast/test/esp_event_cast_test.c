@@ -35,6 +35,8 @@
 
 static const char *TAG = "EVT_CAST_TEST";
 #define TEST_QUEUE_NUMBER 50
+#define TEST_PAYLOAD_NUM  (4)
+#define TEST_PAYLOAD_SIZE (256)
 
 static void task_send(void *pv)
 {
@@ -257,4 +259,73 @@ TEST_CASE("Received data in real time", "[esp_event_cast]")
     vTaskDelay(3000 / portTICK_PERIOD_MS);
     AUDIO_MEM_SHOW(TAG);
     esp_event_cast_destroy(broadcast);
-}
\ No newline at end of file
+}
+
+TEST_CASE("shared payload broadcasting and drop counter", "[esp_event_cast]")
+{
+    AUDIO_MEM_SHOW(TAG);
+    esp_event_cast_handle_t broadcast = esp_event_cast_create();
+    TEST_ASSERT_NOT_NULL(broadcast);
+    TEST_ASSERT_NULL(esp_event_cast_alloc(broadcast));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_cast_setup_pool(broadcast, TEST_PAYLOAD_SIZE, TEST_PAYLOAD_NUM));
+
+    xQueueHandle ref_que[3];
+    for (int i = 0; i < 3; ++i) {
+        ref_que[i] = xQueueCreate(2, sizeof(void *));
+        TEST_ASSERT_EQUAL(ESP_OK, esp_event_cast_register_ref(broadcast, ref_que[i]));
+    }
+    xQueueHandle copy_que = xQueueCreate(3, 12);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_cast_register(broadcast, copy_que));
+
+    // The third publish overflows the queues of the shared receivers
+    for (int i = 0; i < 3; ++i) {
+        uint8_t *payload = esp_event_cast_alloc(broadcast);
+        TEST_ASSERT_NOT_NULL(payload);
+        memset(payload, i, TEST_PAYLOAD_SIZE);
+        TEST_ASSERT_EQUAL(ESP_OK, esp_event_cast_publish(broadcast, payload));
+    }
+    uint32_t dropped = 0;
+    for (int i = 0; i < 3; ++i) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_event_cast_get_dropped(broadcast, ref_que[i], &dropped));
+        TEST_ASSERT_EQUAL(1, dropped);
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_cast_get_dropped(broadcast, copy_que, &dropped));
+    TEST_ASSERT_EQUAL(0, dropped);
+
+    // Two payloads are in flight, all the receivers see the same pointer
+    for (int n = 0; n < 2; ++n) {
+        uint8_t *expect = NULL;
+        for (int i = 0; i < 3; ++i) {
+            uint8_t *payload = NULL;
+            TEST_ASSERT_EQUAL(pdTRUE, xQueueReceive(ref_que[i], &payload, 0));
+            TEST_ASSERT_EQUAL(n, payload[TEST_PAYLOAD_SIZE - 1]);
+            if (i == 0) {
+                expect = payload;
+            }
+            TEST_ASSERT_EQUAL_PTR(expect, payload);
+            TEST_ASSERT_EQUAL(ESP_OK, esp_event_cast_release(broadcast, payload));
+        }
+    }
+    int buf[3] = { 0 };
+    TEST_ASSERT_EQUAL(pdTRUE, xQueueReceive(copy_que, buf, 0));
+
+    // Every payload went back to the pool
+    void *payload[TEST_PAYLOAD_NUM];
+    for (int i = 0; i < TEST_PAYLOAD_NUM; ++i) {
+        payload[i] = esp_event_cast_alloc(broadcast);
+        TEST_ASSERT_NOT_NULL(payload[i]);
+    }
+    TEST_ASSERT_NULL(esp_event_cast_alloc(broadcast));
+    for (int i = 0; i < TEST_PAYLOAD_NUM; ++i) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_event_cast_release(broadcast, payload[i]));
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        esp_event_cast_unregister(broadcast, ref_que[i]);
+        vQueueDelete(ref_que[i]);
+    }
+    esp_event_cast_unregister(broadcast, copy_que);
+    vQueueDelete(copy_que);
+    esp_event_cast_destroy(broadcast);
+    AUDIO_MEM_SHOW(TAG);
+}
@@ -0,0 +1,344 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "audio_mem.h"
+#include "audio_error.h"
+#include "audio_mutex.h"
+#include "audio_thread.h"
+#include "esp_periph_bringup.h"
+
+static const char *TAG = "PERIPH_BRINGUP";
+
+#define BRINGUP_TIMELINE_WIDTH      (32)
+#define BRINGUP_MAX_WORKERS         (4)
+#define BRINGUP_EXIT_BIT            (1UL << 23)
+
+typedef enum {
+    STEP_PENDING,
+    STEP_RUNNING,
+    STEP_DONE,
+    STEP_FAILED,
+    STEP_SKIPPED,
+} step_state_t;
+
+typedef struct {
+    esp_periph_bringup_step_t   step;
+    step_state_t                state;
+    esp_err_t                   ret;
+    int                         worker;
+    int64_t                     start_us;
+    int64_t                     end_us;
+} bringup_step_t;
+
+typedef struct {
+    esp_periph_bringup_handle_t handle;
+    int                         index;
+    audio_thread_t              thread;
+} bringup_worker_t;
+
+struct esp_periph_bringup {
+    esp_periph_bringup_cfg_t    cfg;
+    bringup_step_t              steps[ESP_PERIPH_BRINGUP_MAX_STEPS];
+    int                         step_num;
+    uint32_t                    finished;
+    uint32_t                    failed;
+    void                        *lock;
+    EventGroupHandle_t          done_bits;
+    int64_t                     start_us;
+    bool                        started;
+    int                         workers_alive;
+    bringup_worker_t            workers[BRINGUP_MAX_WORKERS];
+};
+
+static const char *const step_state_str[] = { "PENDING", "RUNNING", "OK", "FAIL", "SKIPPED" };
+
+static inline uint32_t bringup_all_mask(esp_periph_bringup_handle_t h)
+{
+    return (1UL << h->step_num) - 1;
+}
+
+static void bringup_finish(esp_periph_bringup_handle_t h, int id, step_state_t state)
+{
+    h->steps[id].state = state;
+    h->finished |= ESP_PERIPH_BRINGUP_STEP(id);
+    if (state != STEP_DONE) {
+        h->failed |= ESP_PERIPH_BRINGUP_STEP(id);
+    }
+    xEventGroupSetBits(h->done_bits, ESP_PERIPH_BRINGUP_STEP(id));
+}
+
+// Called locked, returns the first step ready to run, skipping the steps whose dependencies failed
+static int bringup_pick(esp_periph_bringup_handle_t h, uint32_t *running)
+{
+    *running = 0;
+    for (int i = 0; i < h->step_num; i++) {
+        if (h->steps[i].state == STEP_RUNNING) {
+            *running |= ESP_PERIPH_BRINGUP_STEP(i);
+        }
+    }
+    // Dependencies only name earlier steps, one pass in id order resolves the skip chains
+    for (int i = 0; i < h->step_num; i++) {
+        bringup_step_t *s = &h->steps[i];
+        if (s->state != STEP_PENDING) {
+            continue;
+        }
+        if (s->step.deps & h->failed) {
+            s->end_us = s->start_us = esp_timer_get_time() - h->start_us;
+            bringup_finish(h, i, STEP_SKIPPED);
+            ESP_LOGW(TAG, "[%s] skipped, a dependency failed", s->step.name);
+            continue;
+        }
+        if (s->step.deps & ~h->finished) {
+            continue;
+        }
+        bool busy = false;
+        for (int j = 0; s->step.group && j < h->step_num; j++) {
+            if ((*running & ESP_PERIPH_BRINGUP_STEP(j)) && h->steps[j].step.group == s->step.group) {
+                busy = true;
+                break;
+            }
+        }
+        if (!busy) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void bringup_worker_task(void *pv)
+{
+    bringup_worker_t *worker = (bringup_worker_t *)pv;
+    esp_periph_bringup_handle_t h = worker->handle;
+    mutex_lock(h->lock);
+    while (h->finished != bringup_all_mask(h)) {
+        uint32_t running = 0;
+        int id = bringup_pick(h, &running);
+        if (id < 0) {
+            if (running == 0) {
+                break;
+            }
+            // Nothing ready, wait for one of the running steps to finish
+            mutex_unlock(h->lock);
+            xEventGroupWaitBits(h->done_bits, running, pdFALSE, pdFALSE, portMAX_DELAY);
+            mutex_lock(h->lock);
+            continue;
+        }
+        bringup_step_t *s = &h->steps[id];
+        s->state = STEP_RUNNING;
+        s->worker = worker->index;
+        s->start_us = esp_timer_get_time() - h->start_us;
+        mutex_unlock(h->lock);
+
+        esp_err_t ret = s->step.func ? s->step.func(s->step.ctx) : ESP_OK;
+        int64_t end_us = esp_timer_get_time() - h->start_us;
+        if (ret == ESP_OK) {
+            ESP_LOGI(TAG, "[%s] done in %d ms, at %d ms", s->step.name,
+                     (int)((end_us - s->start_us) / 1000), (int)(end_us / 1000));
+        } else {
+            ESP_LOGE(TAG, "[%s] failed 0x%x in %d ms, at %d ms", s->step.name, ret,
+                     (int)((end_us - s->start_us) / 1000), (int)(end_us / 1000));
+        }
+
+        mutex_lock(h->lock);
+        s->ret = ret;
+        s->end_us = end_us;
+        bringup_finish(h, id, ret == ESP_OK ? STEP_DONE : STEP_FAILED);
+    }
+    if (--h->workers_alive == 0) {
+        xEventGroupSetBits(h->done_bits, BRINGUP_EXIT_BIT);
+    }
+    mutex_unlock(h->lock);
+    vTaskDelete(NULL);
+}
+
+esp_periph_bringup_handle_t esp_periph_bringup_create(esp_periph_bringup_cfg_t *config)
+{
+    AUDIO_NULL_CHECK(TAG, config, return NULL);
+    esp_periph_bringup_handle_t h = audio_calloc(1, sizeof(struct esp_periph_bringup));
+    AUDIO_MEM_CHECK(TAG, h, return NULL);
+    h->cfg = *config;
+    if (h->cfg.workers < 1) {
+        h->cfg.workers = 1;
+    } else if (h->cfg.workers > BRINGUP_MAX_WORKERS) {
+        h->cfg.workers = BRINGUP_MAX_WORKERS;
+    }
+    if (h->cfg.task_stack <= 0) {
+        h->cfg.task_stack = DEFAULT_ESP_PERIPH_BRINGUP_STACK_SIZE;
+    }
+    h->lock = mutex_create();
+    AUDIO_MEM_CHECK(TAG, h->lock, goto _bringup_init_failed);
+    h->done_bits = xEventGroupCreate();
+    AUDIO_MEM_CHECK(TAG, h->done_bits, goto _bringup_init_failed);
+    return h;
+
+_bringup_init_failed:
+    if (h->lock) {
+        mutex_destroy(h->lock);
+    }
+    audio_free(h);
+    return NULL;
+}
+
+int esp_periph_bringup_add_step(esp_periph_bringup_handle_t handle, const esp_periph_bringup_step_t *step)
+{
+    AUDIO_NULL_CHECK(TAG, handle, return -1);
+    AUDIO_NULL_CHECK(TAG, step, return -1);
+    mutex_lock(handle->lock);
+    int id = handle->step_num;
+    if (handle->started || id >= ESP_PERIPH_BRINGUP_MAX_STEPS || (step->deps & ~bringup_all_mask(handle))) {
+        mutex_unlock(handle->lock);
+        ESP_LOGE(TAG, "Can't add step [%s], %d steps, deps 0x%x", step->name ? step->name : "", id, step->deps);
+        return -1;
+    }
+    handle->steps[id].step = *step;
+    if (handle->steps[id].step.name == NULL) {
+        handle->steps[id].step.name = "";
+    }
+    handle->steps[id].state = STEP_PENDING;
+    handle->step_num++;
+    mutex_unlock(handle->lock);
+    return id;
+}
+
+esp_err_t esp_periph_bringup_start(esp_periph_bringup_handle_t handle)
+{
+    AUDIO_NULL_CHECK(TAG, handle, return ESP_FAIL);
+    mutex_lock(handle->lock);
+    if (handle->started) {
+        mutex_unlock(handle->lock);
+        return ESP_FAIL;
+    }
+    int workers = handle->cfg.workers < handle->step_num ? handle->cfg.workers : handle->step_num;
+    if (workers < 1 && handle->step_num > 0) {
+        mutex_unlock(handle->lock);
+        ESP_LOGE(TAG, "No worker to run %d steps", handle->step_num);
+        return ESP_ERR_INVALID_ARG;
+    }
+    handle->started = true;
+    handle->start_us = esp_timer_get_time();
+    esp_err_t ret = ESP_OK;
+    for (int i = 0; i < workers; i++) {
+        bringup_worker_t *w = &handle->workers[i];
+        w->handle = handle;
+        w->index = i;
+        if (audio_thread_create(&w->thread, "bringup", bringup_worker_task, w, handle->cfg.task_stack,
+                                handle->cfg.task_prio, handle->cfg.ext_stack, handle->cfg.task_core) != ESP_OK) {
+            ESP_LOGE(TAG, "Create worker %d failed", i);
+            ret = i ? ESP_OK : ESP_FAIL;
+            break;
+        }
+        handle->workers_alive++;
+    }
+    if (handle->workers_alive == 0) {
+        // Nothing will run the steps, fail them so the waiters return instead of blocking forever
+        for (int i = 0; i < handle->step_num; i++) {
+            handle->steps[i].ret = ESP_FAIL;
+            bringup_finish(handle, i, STEP_FAILED);
+        }
+        xEventGroupSetBits(handle->done_bits, BRINGUP_EXIT_BIT);
+    }
+    mutex_unlock(handle->lock);
+    ESP_LOGI(TAG, "Start %d steps on %d workers", handle->step_num, handle->workers_alive);
+    return ret;
+}
+
+esp_err_t esp_periph_bringup_wait(esp_periph_bringup_handle_t handle, uint32_t steps, TickType_t ticks_wait)
+{
+    AUDIO_NULL_CHECK(TAG, handle, return ESP_ERR_INVALID_ARG);
+    if (steps == 0 || (steps & ~bringup_all_mask(handle))) {
+        ESP_LOGE(TAG, "Invalid steps mask 0x%x", steps);
+        return ESP_ERR_INVALID_ARG;
+    }
+    EventBits_t bits = xEventGroupWaitBits(handle->done_bits, steps, pdFALSE, pdTRUE, ticks_wait);
+    if ((bits & steps) != steps) {
+        return ESP_ERR_TIMEOUT;
+    }
+    mutex_lock(handle->lock);
+    uint32_t failed = handle->failed & steps;
+    mutex_unlock(handle->lock);
+    return failed ? ESP_FAIL : ESP_OK;
+}
+
+esp_err_t esp_periph_bringup_wait_all(esp_periph_bringup_handle_t handle, TickType_t ticks_wait)
+{
+    AUDIO_NULL_CHECK(TAG, handle, return ESP_ERR_INVALID_ARG);
+    if (handle->step_num == 0) {
+        return ESP_OK;
+    }
+    return esp_periph_bringup_wait(handle, bringup_all_mask(handle), ticks_wait);
+}
+
+void esp_periph_bringup_log_timeline(esp_periph_bringup_handle_t handle)
+{
+    AUDIO_NULL_CHECK(TAG, handle, return);
+    char bar[BRINGUP_TIMELINE_WIDTH + 1];
+    mutex_lock(handle->lock);
+    int64_t total_us = 1;
+    for (int i = 0; i < handle->step_num; i++) {
+        if (handle->steps[i].end_us > total_us) {
+            total_us = handle->steps[i].end_us;
+        }
+    }
+    ESP_LOGI(TAG, "Boot timeline, %d steps in %d ms", handle->step_num, (int)(total_us / 1000));
+    for (int i = 0; i < handle->step_num; i++) {
+        bringup_step_t *s = &handle->steps[i];
+        memset(bar, '.', BRINGUP_TIMELINE_WIDTH);
+        bar[BRINGUP_TIMELINE_WIDTH] = 0;
+        if (s->state == STEP_DONE || s->state == STEP_FAILED) {
+            int from = s->start_us * BRINGUP_TIMELINE_WIDTH / total_us;
+            int to = s->end_us * BRINGUP_TIMELINE_WIDTH / total_us;
+            for (int c = from; c <= to && c < BRINGUP_TIMELINE_WIDTH; c++) {
+                bar[c] = '#';
+            }
+        }
+        ESP_LOGI(TAG, "  %-16s |%s| %5d ~ %5d ms, worker %d, %s", s->step.name, bar,
+                 (int)(s->start_us / 1000), (int)(s->end_us / 1000), s->worker, step_state_str[s->state]);
+    }
+    mutex_unlock(handle->lock);
+}
+
+esp_err_t esp_periph_bringup_destroy(esp_periph_bringup_handle_t handle)
+{
+    AUDIO_NULL_CHECK(TAG, handle, return ESP_FAIL);
+    mutex_lock(handle->lock);
+    bool running = handle->workers_alive && handle->finished != bringup_all_mask(handle);
+    mutex_unlock(handle->lock);
+    if (running) {
+        ESP_LOGE(TAG, "Bring-up is still running");
+        return ESP_FAIL;
+    }
+    // All the steps are finished, the workers are only leaving
+    if (handle->started) {
+        xEventGroupWaitBits(handle->done_bits, BRINGUP_EXIT_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+    vEventGroupDelete(handle->done_bits);
+    mutex_destroy(handle->lock);
+    audio_free(handle);
+    return ESP_OK;
+}
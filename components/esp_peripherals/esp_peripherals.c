@@ -31,10 +31,10 @@
 #include "esp_peripherals.h"
 #include "audio_thread.h"
 #include "audio_mem.h"
+#include "timer_wheel.h"
 
 static const char *TAG = "ESP_PERIPH";
 
-#define DEFAULT_ESP_PERIPH_WAIT_TICK       (10/portTICK_RATE_MS)
 
 struct esp_periph {
     char                       *tag;
@@ -48,6 +48,9 @@ struct esp_periph {
     void                       *periph_data;
     esp_periph_event_t         *on_evt;
     TimerHandle_t               timer;
+    timer_callback              timer_cb;
+    timer_wheel_node_t          timer_node;
+    struct esp_periph_sets      *set;
     STAILQ_ENTRY(esp_periph)    entries;
 };
 
@@ -60,12 +63,19 @@ typedef struct esp_periph_sets {
     audio_thread_t                                  audio_thread;
     bool                                            ext_stack;
     bool                                            run;
+    bool                                            init_pending;
     esp_periph_event_t                              event_handle;
+    xSemaphoreHandle                                timer_lock;
+    TimerHandle_t                                   wheel_timer;
+    timer_wheel_t                                   wheel;
+    bool                                            dispatching;
+    uint32_t                                        timer_wakeups;
     STAILQ_HEAD(esp_periph_list_item, esp_periph)   periph_list;
 } esp_periph_set_t;
 
 static const int STARTED_BIT = BIT0;
 static const int STOPPED_BIT = BIT1;
+static const int TIMER_FLUSHED_BIT = BIT2;
 
 static esp_err_t esp_periph_wait_for_stop(esp_periph_set_handle_t periph_set_handle, TickType_t ticks_to_wait);
 
@@ -74,6 +84,10 @@ static esp_err_t process_peripheral_event(audio_event_iface_msg_t *msg, void *co
     esp_periph_handle_t periph_evt = (esp_periph_handle_t) msg->source;
     esp_periph_handle_t periph;
     esp_periph_set_t *sets = context;
+    if (periph_evt == NULL) {
+        // Only to wake up the task
+        return ESP_OK;
+    }
     STAILQ_FOREACH(periph, &sets->periph_list, entries) {
         if (periph->periph_id == periph_evt->periph_id
             && periph_evt->state == PERIPH_STATE_RUNNING
@@ -85,6 +99,74 @@ static esp_err_t process_peripheral_event(audio_event_iface_msg_t *msg, void *co
     return ESP_OK;
 }
 
+static void esp_periph_set_wakeup(esp_periph_set_handle_t periph_set_handle)
+{
+    audio_event_iface_msg_t msg = { 0 };
+    audio_event_iface_cmd(periph_set_handle->event_handle.iface, &msg);
+}
+
+static void esp_periph_wheel_fire(timer_wheel_node_t *node, void *ctx)
+{
+    esp_periph_handle_t periph = (esp_periph_handle_t)ctx;
+    // Keep the callback signature of FreeRTOS timer, `pvTimerGetTimerID` returns the peripheral
+    vTimerSetTimerID(periph->set->wheel_timer, periph);
+    periph->timer_cb(periph->set->wheel_timer);
+}
+
+// Must be called with timer_lock held, arm the one shot driver timer to the next deadline
+static void esp_periph_wheel_arm(esp_periph_set_handle_t periph_set_handle)
+{
+    uint32_t ticks = 0;
+    if (timer_wheel_next(&periph_set_handle->wheel, &ticks) == false) {
+        // Nothing scheduled, let the CPU sleep
+        xTimerStop(periph_set_handle->wheel_timer, 0);
+        return;
+    }
+    TickType_t elapsed = xTaskGetTickCount() - periph_set_handle->wheel.now;
+    TickType_t period = ticks > elapsed ? ticks - elapsed : 1;
+    xTimerChangePeriod(periph_set_handle->wheel_timer, period, 0);
+}
+
+static void esp_periph_wheel_timer_handler(xTimerHandle tmr)
+{
+    esp_periph_set_handle_t periph_set_handle = (esp_periph_set_handle_t)pvTimerGetTimerID(tmr);
+    xSemaphoreTakeRecursive(periph_set_handle->timer_lock, portMAX_DELAY);
+    periph_set_handle->timer_wakeups++;
+    periph_set_handle->dispatching = true;
+    timer_wheel_advance(&periph_set_handle->wheel, xTaskGetTickCount());
+    periph_set_handle->dispatching = false;
+    // The callbacks changed the ID to their peripheral
+    vTimerSetTimerID(tmr, periph_set_handle);
+    esp_periph_wheel_arm(periph_set_handle);
+    xSemaphoreGiveRecursive(periph_set_handle->timer_lock);
+}
+
+static void esp_periph_wheel_rearm(void *param, uint32_t arg)
+{
+    esp_periph_set_handle_t periph_set_handle = (esp_periph_set_handle_t)param;
+    xSemaphoreTakeRecursive(periph_set_handle->timer_lock, portMAX_DELAY);
+    // The dispatching handler arms the timer when all callbacks are done
+    if (periph_set_handle->dispatching == false) {
+        esp_periph_wheel_arm(periph_set_handle);
+    }
+    xSemaphoreGiveRecursive(periph_set_handle->timer_lock);
+}
+
+static void esp_periph_wheel_update(esp_periph_set_handle_t periph_set_handle)
+{
+    // Arm the driver timer in the timer task, so the commands are serialized with the handler
+    if (xTaskGetCurrentTaskHandle() == xTimerGetTimerDaemonTaskHandle()) {
+        esp_periph_wheel_rearm(periph_set_handle, 0);
+    } else {
+        xTimerPendFunctionCall(esp_periph_wheel_rearm, periph_set_handle, 0, portMAX_DELAY);
+    }
+}
+
+static void esp_periph_wheel_flush(void *param, uint32_t bits)
+{
+    xEventGroupSetBits((EventGroupHandle_t)param, bits);
+}
+
 static void esp_periph_task(void *pv)
 {
     esp_periph_handle_t periph;
@@ -94,17 +176,21 @@ static void esp_periph_task(void *pv)
     xEventGroupClearBits(periph_set_handle->state_event_bits, STOPPED_BIT);
 
     while (periph_set_handle->run) {
+        // The list is only walked when a peripheral was started, the task sleeps on the command queue otherwise
         mutex_lock(periph_set_handle->lock);
-        STAILQ_FOREACH(periph, &periph_set_handle->periph_list, entries) {
-            if (periph->disabled) {
-                continue;
-            }
-            if (periph->state == PERIPH_STATE_INIT && periph->init) {
-                ESP_LOGD(TAG, "PERIPH[%s]->init", periph->tag);
-                if (periph->init(periph) == ESP_OK) {
-                    periph->state = PERIPH_STATE_RUNNING;
-                } else {
-                    periph->state = PERIPH_STATE_ERROR;
+        if (periph_set_handle->init_pending) {
+            periph_set_handle->init_pending = false;
+            STAILQ_FOREACH(periph, &periph_set_handle->periph_list, entries) {
+                if (periph->disabled) {
+                    continue;
+                }
+                if (periph->state == PERIPH_STATE_INIT && periph->init) {
+                    ESP_LOGD(TAG, "PERIPH[%s]->init", periph->tag);
+                    if (periph->init(periph) == ESP_OK) {
+                        periph->state = PERIPH_STATE_RUNNING;
+                    } else {
+                        periph->state = PERIPH_STATE_ERROR;
+                    }
                 }
             }
         }
@@ -131,7 +217,10 @@ esp_periph_set_handle_t esp_periph_set_init(esp_periph_config_t *config)
         (
             (periph_sets                   = audio_calloc(1, sizeof(esp_periph_set_t))) && _err_step ++ &&
             (periph_sets->state_event_bits = xEventGroupCreate())                  && _err_step ++ &&
-            (periph_sets->lock             = mutex_create())                       && _err_step ++
+            (periph_sets->lock             = mutex_create())                       && _err_step ++ &&
+            (periph_sets->timer_lock       = xSemaphoreCreateRecursiveMutex())     && _err_step ++ &&
+            (periph_sets->wheel_timer      = xTimerCreate("periph_wheel", 1, pdFALSE, periph_sets,
+                                                          esp_periph_wheel_timer_handler)) && _err_step ++
         );
 
     AUDIO_MEM_CHECK(TAG, _success, {
@@ -139,6 +228,7 @@ esp_periph_set_handle_t esp_periph_set_init(esp_periph_config_t *config)
     });
 
     STAILQ_INIT(&periph_sets->periph_list);
+    timer_wheel_init(&periph_sets->wheel, xTaskGetTickCount());
 
     //TODO: Should we uninstall gpio isr service??
     //TODO: Because gpio need for sdcard and gpio, then install isr here
@@ -160,13 +250,19 @@ esp_periph_set_handle_t esp_periph_set_init(esp_periph_config_t *config)
     periph_sets->event_handle.iface = audio_event_iface_init(&event_cfg);
 
     AUDIO_MEM_CHECK(TAG, periph_sets->event_handle.iface, goto _periph_init_failed);
-    audio_event_iface_set_cmd_waiting_timeout(periph_sets->event_handle.iface, DEFAULT_ESP_PERIPH_WAIT_TICK);
+    audio_event_iface_set_cmd_waiting_timeout(periph_sets->event_handle.iface, portMAX_DELAY);
     return periph_sets;
 
 _periph_init_failed:
     if (periph_sets) {
         mutex_destroy(periph_sets->lock);
         vEventGroupDelete(periph_sets->state_event_bits);
+        if (periph_sets->timer_lock) {
+            vSemaphoreDelete(periph_sets->timer_lock);
+        }
+        if (periph_sets->wheel_timer) {
+            xTimerDelete(periph_sets->wheel_timer, portMAX_DELAY);
+        }
 
         if (periph_sets->event_handle.iface) {
             audio_event_iface_destroy(periph_sets->event_handle.iface);
@@ -185,7 +281,12 @@ esp_err_t esp_periph_set_destroy(esp_periph_set_handle_t periph_set_handle)
         return ESP_FAIL;
     }
     periph_set_handle->run = false;
+    esp_periph_set_wakeup(periph_set_handle);
     esp_periph_wait_for_stop(periph_set_handle, portMAX_DELAY);
+    // Wait for the pending timer commands referring to the set
+    xTimerDelete(periph_set_handle->wheel_timer, portMAX_DELAY);
+    xTimerPendFunctionCall(esp_periph_wheel_flush, periph_set_handle->state_event_bits, TIMER_FLUSHED_BIT, portMAX_DELAY);
+    xEventGroupWaitBits(periph_set_handle->state_event_bits, TIMER_FLUSHED_BIT, true, true, portMAX_DELAY);
     esp_periph_handle_t item, tmp;
     STAILQ_FOREACH_SAFE(item, &periph_set_handle->periph_list, entries, tmp) {
         STAILQ_REMOVE(&periph_set_handle->periph_list, item, esp_periph, entries);
@@ -193,6 +294,7 @@ esp_err_t esp_periph_set_destroy(esp_periph_set_handle_t periph_set_handle)
         audio_free(item);
     }
     mutex_destroy(periph_set_handle->lock);
+    vSemaphoreDelete(periph_set_handle->timer_lock);
     vEventGroupDelete(periph_set_handle->state_event_bits);
 
     gpio_uninstall_isr_service();
@@ -340,8 +442,10 @@ esp_err_t esp_periph_start(esp_periph_set_handle_t periph_set_handle, esp_periph
         periph->disabled = false;
     } else {
         esp_periph_register_on_events(periph, &periph_set_handle->event_handle);
+        periph->set = periph_set_handle;
         STAILQ_INSERT_TAIL(&periph_set_handle->periph_list, periph, entries);
     }
+    periph_set_handle->init_pending = true;
     if (periph_set_handle->run == false && periph_set_handle->task_stack > 0) {
         periph_set_handle->run = true;
         if (audio_thread_create(&periph_set_handle->audio_thread,
@@ -355,6 +459,8 @@ esp_err_t esp_periph_start(esp_periph_set_handle_t periph_set_handle, esp_periph
             ESP_LOGE(TAG, "Create [%s] task failed", periph->tag);
             return ESP_FAIL;
         }
+    } else if (periph_set_handle->run) {
+        esp_periph_set_wakeup(periph_set_handle);
     }
     return ESP_OK;
 }
@@ -417,13 +523,32 @@ esp_err_t esp_periph_send_event(esp_periph_handle_t periph, int event_id, void *
 
 esp_err_t esp_periph_start_timer(esp_periph_handle_t periph, TickType_t interval_tick, timer_callback callback)
 {
-    if (periph->timer == NULL) {
-        periph->timer = xTimerCreate("periph_itmer", interval_tick, pdTRUE, periph, callback);
-        if (xTimerStart(periph->timer, 0) != pdTRUE) {
-            AUDIO_ERROR(TAG, "Error to starting timer");
-            return ESP_FAIL;
+    esp_periph_set_handle_t periph_set_handle = periph->set;
+    if (periph_set_handle == NULL) {
+        // Not started in a set, fall back to a dedicated FreeRTOS timer
+        if (periph->timer == NULL) {
+            periph->timer = xTimerCreate("periph_itmer", interval_tick, pdTRUE, periph, callback);
+            if (xTimerStart(periph->timer, 0) != pdTRUE) {
+                AUDIO_ERROR(TAG, "Error to starting timer");
+                return ESP_FAIL;
+            }
         }
+        return ESP_OK;
+    }
+    xSemaphoreTakeRecursive(periph_set_handle->timer_lock, portMAX_DELAY);
+    if (periph->timer_node.cb == NULL) {
+        timer_wheel_node_init(&periph->timer_node, esp_periph_wheel_fire, periph);
     }
+    if (timer_wheel_node_active(&periph->timer_node)) {
+        xSemaphoreGiveRecursive(periph_set_handle->timer_lock);
+        return ESP_OK;
+    }
+    periph->timer_cb = callback;
+    // The wheel time may lag behind the tick count while it sleeps
+    TickType_t lag = xTaskGetTickCount() - periph_set_handle->wheel.now;
+    timer_wheel_add(&periph_set_handle->wheel, &periph->timer_node, lag + interval_tick, interval_tick ? interval_tick : 1);
+    xSemaphoreGiveRecursive(periph_set_handle->timer_lock);
+    esp_periph_wheel_update(periph_set_handle);
     return ESP_OK;
 }
 
@@ -434,6 +559,32 @@ esp_err_t esp_periph_stop_timer(esp_periph_handle_t periph)
         xTimerDelete(periph->timer, portMAX_DELAY);
         periph->timer = NULL;
     }
+    esp_periph_set_handle_t periph_set_handle = periph->set;
+    if (periph_set_handle) {
+        xSemaphoreTakeRecursive(periph_set_handle->timer_lock, portMAX_DELAY);
+        bool active = timer_wheel_node_active(&periph->timer_node);
+        timer_wheel_del(&periph_set_handle->wheel, &periph->timer_node);
+        xSemaphoreGiveRecursive(periph_set_handle->timer_lock);
+        if (active) {
+            esp_periph_wheel_update(periph_set_handle);
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_periph_get_timer_wakeups(esp_periph_handle_t periph, uint32_t *wakeups)
+{
+    AUDIO_NULL_CHECK(TAG, periph, return ESP_ERR_INVALID_ARG);
+    AUDIO_NULL_CHECK(TAG, wakeups, return ESP_ERR_INVALID_ARG);
+    *wakeups = periph->timer_node.fired;
+    return ESP_OK;
+}
+
+esp_err_t esp_periph_set_get_timer_wakeups(esp_periph_set_handle_t periph_set_handle, uint32_t *wakeups)
+{
+    AUDIO_NULL_CHECK(TAG, periph_set_handle, return ESP_ERR_INVALID_ARG);
+    AUDIO_NULL_CHECK(TAG, wakeups, return ESP_ERR_INVALID_ARG);
+    *wakeups = periph_set_handle->timer_wakeups;
     return ESP_OK;
 }
 
@@ -0,0 +1,173 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ESP_PERIPH_BRINGUP_H_
+#define _ESP_PERIPH_BRINGUP_H_
+
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief  Staged bring-up of the board
+ *
+ *         The application declares its init steps (codec, I2S, peripherals set, keys, SD card, Wi-Fi,
+ *         Bluetooth...) with their dependencies, the steps whose dependencies are met run concurrently
+ *         on a few worker tasks. The application waits only for the steps it needs first,
+ *         typically codec and I2S to start playback, while the others finish in the background.
+ *         Every step is timed from `esp_periph_bringup_start` and the timeline can be logged at the end.
+ */
+typedef struct esp_periph_bringup *esp_periph_bringup_handle_t;
+
+#define ESP_PERIPH_BRINGUP_MAX_STEPS        (16)
+#define ESP_PERIPH_BRINGUP_STEP(id)         (1UL << (id))    /*!< Mask of one step, for `deps` and `esp_periph_bringup_wait` */
+
+/**
+ * @brief  Bring-up step function, runs on a worker task
+ */
+typedef esp_err_t (*esp_periph_bringup_func_t)(void *ctx);
+
+/**
+ * @brief  Bring-up step
+ */
+typedef struct {
+    const char                  *name;      /*!< Step name, for the log */
+    esp_periph_bringup_func_t   func;       /*!< Step function */
+    void                        *ctx;       /*!< Step function context */
+    uint32_t                    deps;       /*!< Mask of the steps to finish first, only steps added before can be named */
+    int                         group;      /*!< Steps of the same non-zero group never run together, e.g. the users of one I2C bus or one peripherals set */
+} esp_periph_bringup_step_t;
+
+/**
+ * @brief  Bring-up configuration
+ */
+typedef struct {
+    int                         workers;        /*!< Number of worker tasks, 1 runs the steps in sequence */
+    int                         task_stack;     /*!< Worker task stack size, the largest step needs must fit */
+    int                         task_prio;      /*!< Worker task priority */
+    int                         task_core;      /*!< Worker task running in core (0 or 1) */
+    bool                        ext_stack;      /*!< Worker task stack allocate on extern ram */
+} esp_periph_bringup_cfg_t;
+
+#define DEFAULT_ESP_PERIPH_BRINGUP_WORKERS      (3)
+#define DEFAULT_ESP_PERIPH_BRINGUP_STACK_SIZE   (4 * 1024)
+#define DEFAULT_ESP_PERIPH_BRINGUP_TASK_PRIO    (10)
+#define DEFAULT_ESP_PERIPH_BRINGUP_TASK_CORE    (0)
+
+#define DEFAULT_ESP_PERIPH_BRINGUP_CONFIG() {                   \
+    .workers    = DEFAULT_ESP_PERIPH_BRINGUP_WORKERS,           \
+    .task_stack = DEFAULT_ESP_PERIPH_BRINGUP_STACK_SIZE,        \
+    .task_prio  = DEFAULT_ESP_PERIPH_BRINGUP_TASK_PRIO,         \
+    .task_core  = DEFAULT_ESP_PERIPH_BRINGUP_TASK_CORE,         \
+    .ext_stack  = false,                                        \
+}
+
+/**
+ * @brief  Create an empty bring-up
+ *
+ * @param[in]  config  The configuration
+ *
+ * @return
+ *     - NULL    Error
+ *     - Others  Bring-up handle
+ */
+esp_periph_bringup_handle_t esp_periph_bringup_create(esp_periph_bringup_cfg_t *config);
+
+/**
+ * @brief  Declare a step, before `esp_periph_bringup_start`
+ *
+ * @param[in]  handle  The bring-up handle
+ * @param[in]  step    The step, copied
+ *
+ * @return
+ *     - >= 0    Step id, use `ESP_PERIPH_BRINGUP_STEP(id)` to name it in a mask
+ *     - (-1)    Too many steps, the bring-up is running or a dependency is unknown
+ */
+int esp_periph_bringup_add_step(esp_periph_bringup_handle_t handle, const esp_periph_bringup_step_t *step);
+
+/**
+ * @brief  Start the worker tasks, the call does not wait for any step
+ *
+ * @param[in]  handle  The bring-up handle
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_INVALID_ARG  No worker configured for the steps
+ *     - ESP_FAIL             Already started or worker task creation failed, the steps are then failed
+ */
+esp_err_t esp_periph_bringup_start(esp_periph_bringup_handle_t handle);
+
+/**
+ * @brief  Wait for the steps of a mask to finish, a step whose dependency failed is skipped
+ *
+ * @param[in]  handle      The bring-up handle
+ * @param[in]  steps       Mask of the steps
+ * @param[in]  ticks_wait  Maximum ticks to wait
+ *
+ * @return
+ *     - ESP_OK               All the steps succeeded
+ *     - ESP_FAIL             One of the steps failed or was skipped
+ *     - ESP_ERR_TIMEOUT      Timeout
+ *     - ESP_ERR_INVALID_ARG  Invalid handle or mask
+ */
+esp_err_t esp_periph_bringup_wait(esp_periph_bringup_handle_t handle, uint32_t steps, TickType_t ticks_wait);
+
+/**
+ * @brief  Wait for all the steps to finish
+ *
+ * @param[in]  handle      The bring-up handle
+ * @param[in]  ticks_wait  Maximum ticks to wait
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_FAIL
+ *     - ESP_ERR_TIMEOUT
+ */
+esp_err_t esp_periph_bringup_wait_all(esp_periph_bringup_handle_t handle, TickType_t ticks_wait);
+
+/**
+ * @brief  Log the boot timeline, start and end of every step from `esp_periph_bringup_start`
+ *
+ * @param[in]  handle  The bring-up handle
+ */
+void esp_periph_bringup_log_timeline(esp_periph_bringup_handle_t handle);
+
+/**
+ * @brief  Destroy the bring-up, it must be finished
+ *
+ * @param[in]  handle  The bring-up handle
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_FAIL  Steps are still running
+ */
+esp_err_t esp_periph_bringup_destroy(esp_periph_bringup_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ESP_PERIPH_BRINGUP_H_ */
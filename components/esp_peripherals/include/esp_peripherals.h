@@ -334,7 +334,10 @@ esp_err_t esp_periph_send_event(esp_periph_handle_t periph, int event_id, void *
  *
  * @note
  *             - You do not need to stop or destroy the timer, when the `esp_periph_destroy` function is called, it will stop and destroy all
- *             - This timer using FreeRTOS Timer, with autoreload = true
+ *             - The timers of the peripherals started in a set share one timer wheel, driven by a single one shot FreeRTOS timer
+ *               armed to the next deadline, so there is no wakeup while no timer is due. The callbacks still run in the FreeRTOS
+ *               timer task and `pvTimerGetTimerID(tmr)` returns the peripheral, but `tmr` must not be used with other timer APIs
+ *             - Before the peripheral is started in a set, it uses its own FreeRTOS Timer, with autoreload = true
  *
  * @param[in]  periph          The peripheral
  * @param[in]  interval_tick   The interval tick
@@ -357,6 +360,30 @@ esp_err_t esp_periph_start_timer(esp_periph_handle_t periph, TickType_t interval
  */
 esp_err_t esp_periph_stop_timer(esp_periph_handle_t periph);
 
+/**
+ * @brief      Get the number of times the peripheral timer callback was invoked by the set timer wheel
+ *
+ * @param[in]  periph   The peripheral
+ * @param[out] wakeups  The callback count
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_INVALID_ARG
+ */
+esp_err_t esp_periph_get_timer_wakeups(esp_periph_handle_t periph, uint32_t *wakeups);
+
+/**
+ * @brief      Get the number of times the set timer wheel woke up, the due callbacks of each wakeup are run in one batch
+ *
+ * @param[in]  periph_set_handle  The esp_periph_set_handle_t instance
+ * @param[out] wakeups            The wakeup count
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_INVALID_ARG
+ */
+esp_err_t esp_periph_set_get_timer_wakeups(esp_periph_set_handle_t periph_set_handle, uint32_t *wakeups);
+
 /**
  * @brief      Set the user data
  *
@@ -36,9 +36,15 @@ extern "C" {
 #define ADC_BUTTON_STACK_SIZE           2500
 #define ADC_BUTTON_TASK_PRIORITY        10
 #define ADC_BUTTON_TASK_CORE_ID         0
+#define ADC_BUTTON_DMA_SAMPLE_RATE      1000    /*!< Suggested `task_cfg.dma_sample_rate`, shared by all the channels */
 
 /**
  * @brief      The configuration of ADC Button
+ *
+ * @note       By default the button task polls every channel with one shot reads. Setting `task_cfg.dma_sample_rate`
+ *             samples all the channels in the continuous (DMA) mode instead, and the task only wakes once per DMA
+ *             frame. The continuous mode is available on ESP32-C3 and ESP32-S3 with IDF v4.4 or later, other targets
+ *             fall back to one shot reads.
  */
 typedef struct {
     adc_arr_t *arr;  /*!< An array with configuration of buttons */
@@ -0,0 +1,124 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) PTE LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stddef.h>
+#include "adc_btn_detect.h"
+
+static int adc_btn_detect_get_id(adc_btn_detect_t *det, int value)
+{
+    for (int i = 0; i < det->total_steps; i++) {
+        if ((value > det->level_step[i]) && (value <= det->level_step[i + 1])) {
+            return i;
+        }
+    }
+    return ADC_BTN_DETECT_INVALID_ID;
+}
+
+static int adc_btn_detect_decide(adc_btn_detect_t *det, int value, adc_btn_detect_cb_t cb, void *ctx)
+{
+    int id = adc_btn_detect_get_id(det, value);
+    if (id != ADC_BTN_DETECT_INVALID_ID && id == det->act_id) {
+        det->cnt++;
+        if (det->cnt == ADC_BTN_DETECT_PRESS_CNT) {
+            det->pressed = true;
+            cb(ctx, id, ADC_BTN_DETECT_PRESSED);
+            return 1;
+        }
+        if (det->pressed && !det->long_pressed && det->cnt >= det->long_press_cnt) {
+            det->long_pressed = true;
+            cb(ctx, id, ADC_BTN_DETECT_LONG_PRESSED);
+            return 1;
+        }
+        return 0;
+    }
+    // The key is released or another key shows up, a bounce that never reached the press count is dropped
+    int events = 0;
+    if (det->pressed) {
+        cb(ctx, det->act_id, det->long_pressed ? ADC_BTN_DETECT_LONG_RELEASE : ADC_BTN_DETECT_RELEASE);
+        events = 1;
+    }
+    det->act_id = id;
+    det->cnt = 0;
+    det->pressed = false;
+    det->long_pressed = false;
+    return events;
+}
+
+void adc_btn_detect_init(adc_btn_detect_t *det, const int *level_step, int total_steps, int sample_rate, int press_judge_time)
+{
+    det->level_step = level_step;
+    det->total_steps = total_steps;
+    det->window = sample_rate * ADC_BTN_DETECT_TIME_MS / 1000;
+    if (det->window < 1) {
+        det->window = 1;
+    }
+    det->long_press_cnt = press_judge_time / ADC_BTN_DETECT_TIME_MS;
+    det->sum = 0;
+    det->sum_num = 0;
+    det->act_id = ADC_BTN_DETECT_INVALID_ID;
+    det->cnt = 0;
+    det->pressed = false;
+    det->long_pressed = false;
+}
+
+int adc_btn_detect_process(adc_btn_detect_t *det, const uint16_t *samples, int num, int stride, adc_btn_detect_cb_t cb, void *ctx)
+{
+    int low = det->level_step[0];
+    int high = det->level_step[det->total_steps];
+    int events = 0;
+    for (int i = 0; i < num; i++) {
+        int value = samples[i * stride];
+        if (det->sum_num == 0) {
+            if (det->act_id == ADC_BTN_DETECT_INVALID_ID && (value <= low || value > high)) {
+                continue;
+            }
+            det->sum = 0;
+            det->min = value;
+            det->max = value;
+        }
+        det->sum += value;
+        if (value < det->min) {
+            det->min = value;
+        } else if (value > det->max) {
+            det->max = value;
+        }
+        if (++det->sum_num < det->window) {
+            continue;
+        }
+        int avg;
+        if (det->window >= 3) {
+            avg = (det->sum - det->min - det->max) / (det->window - 2);
+        } else {
+            avg = det->sum / det->window;
+        }
+        det->sum_num = 0;
+        events += adc_btn_detect_decide(det, avg, cb, ctx);
+    }
+    return events;
+}
+
+bool adc_btn_detect_idle(adc_btn_detect_t *det)
+{
+    return det->act_id == ADC_BTN_DETECT_INVALID_ID && det->sum_num == 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) PTE LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef _ADC_BTN_DETECT_H_
+#define _ADC_BTN_DETECT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ADC_BTN_DETECT_TIME_MS      (20)    /*!< Length of the sample window averaged into one decision */
+#define ADC_BTN_DETECT_PRESS_CNT    (2)     /*!< Stable decisions after the first one to report a press */
+#define ADC_BTN_DETECT_INVALID_ID   (-1)
+
+/**
+ * @brief Events reported by the detector, the values match `adc_btn_state_t`
+ */
+typedef enum {
+    ADC_BTN_DETECT_PRESSED      = 2,
+    ADC_BTN_DETECT_RELEASE      = 3,
+    ADC_BTN_DETECT_LONG_PRESSED = 4,
+    ADC_BTN_DETECT_LONG_RELEASE = 5,
+} adc_btn_detect_event_t;
+
+typedef void (*adc_btn_detect_cb_t)(void *ctx, int id, adc_btn_detect_event_t event);
+
+/**
+ * @brief Debounce and long press detection of the keys on one ADC channel
+ *
+ *        Samples are averaged over windows of `ADC_BTN_DETECT_TIME_MS` (dropping the minimum and maximum),
+ *        and each average selects the key `i` whose band `(level_step[i], level_step[i + 1]]` contains it.
+ *        The detector has no OS dependency and keeps all its state here, so recorded traces can be replayed
+ *        on host.
+ */
+typedef struct {
+    const int   *level_step;        /*!< `total_steps + 1` ascending thresholds, in the unit of the samples */
+    int         total_steps;        /*!< Number of keys */
+    int         window;             /*!< Samples per decision */
+    int         long_press_cnt;     /*!< Decisions before a held key is reported as long pressed */
+    int32_t     sum;                /*!< Running window */
+    int         sum_num;
+    int         min;
+    int         max;
+    int         act_id;             /*!< Key seen by the last decision, `ADC_BTN_DETECT_INVALID_ID` for none */
+    int         cnt;                /*!< Decisions `act_id` has been stable for */
+    bool        pressed;
+    bool        long_pressed;
+} adc_btn_detect_t;
+
+/**
+ * @brief      Initialize the detector
+ *
+ * @param      det               The detector
+ * @param[in]  level_step        `total_steps + 1` ascending thresholds, must outlive the detector
+ * @param[in]  total_steps       Number of keys
+ * @param[in]  sample_rate       Samples per second fed to `adc_btn_detect_process`
+ * @param[in]  press_judge_time  Time in milliseconds a key must be held to be long pressed
+ */
+void adc_btn_detect_init(adc_btn_detect_t *det, const int *level_step, int total_steps, int sample_rate, int press_judge_time);
+
+/**
+ * @brief      Run the detection over a block of samples of one channel
+ *
+ *             While no key is active, samples outside all the key bands are dropped after a range check and
+ *             the next window only starts on a threshold crossing, so an untouched keypad costs no averaging.
+ *
+ * @param      det      The detector
+ * @param[in]  samples  The samples
+ * @param[in]  num      Number of samples
+ * @param[in]  stride   Distance between two samples of this channel, 1 for a dedicated buffer
+ * @param[in]  cb       Called for every detected event
+ * @param      ctx      Context of `cb`
+ *
+ * @return     Number of events reported
+ */
+int adc_btn_detect_process(adc_btn_detect_t *det, const uint16_t *samples, int num, int stride, adc_btn_detect_cb_t cb, void *ctx);
+
+/**
+ * @brief      Check whether the detector is waiting for a threshold crossing
+ *
+ * @param      det   The detector
+ *
+ * @return     true if no key is active
+ */
+bool adc_btn_detect_idle(adc_btn_detect_t *det);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
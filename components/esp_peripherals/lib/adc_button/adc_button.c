@@ -29,11 +29,14 @@
 #include "driver/adc.h"
 #include "math.h"
 #include "audio_mem.h"
+#include "audio_error.h"
 #include "esp_adc_cal.h"
 #include "string.h"
 #include "adc_button.h"
 #include "esp_log.h"
 #include "audio_thread.h"
+#include "esp_idf_version.h"
+#include "adc_btn_detect.h"
 
 #define V_REF                           1100
 
@@ -41,10 +44,13 @@
 #define ADC_SAMPLE_INTERVAL_TIME_MS     20
 #define DIAL_VOL_INTERVAL_TIME_MS       150
 
-#define ADC_BTN_INVALID_ID              -1
-#define ADC_BTN_INVALID_ACT_ID          -2
-#define ADC_BTN_DETECT_TIME_MS          20
-#define ADC_BTN_DETECTED_CNT            2
+#if (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 4, 0)) && (CONFIG_IDF_TARGET_ESP32C3 || CONFIG_IDF_TARGET_ESP32S3)
+// ESP32 and ESP32-S2 run the continuous mode through I2S0, which is taken by the audio codec
+#define ADC_BTN_DMA_SUPPORTED           1
+#define ADC_BTN_DMA_FRAME_MS            50
+#define ADC_BTN_DMA_READ_TIMEOUT_MS     200
+#define ADC_BTN_DMA_RESULT_BYTES        SOC_ADC_DIGI_DATA_BYTES_PER_CONV
+#endif
 
 #ifndef ENABLE_ADC_VOLUME
 #define USER_KEY_MAX                    7
@@ -53,12 +59,27 @@
 static char *TAG = "ADC_BTN";
 static EventGroupHandle_t g_event_bit;
 
+typedef struct adc_btn_tag adc_btn_tag_t;
+
 typedef struct {
+    adc_btn_detect_t det;
+    adc_btn_list *node;
+    adc_btn_tag_t *tag;
+    int *raw_step;          // Continuous mode, `adc_level_step` converted to raw readings
+    uint16_t *samples;      // Continuous mode, samples of this channel in the current frame
+    int sample_num;
+} adc_btn_chan_t;
+
+struct adc_btn_tag {
     adc_button_callback btn_callback;
     adc_btn_list *head;
     void *user_data;
     audio_thread_t audio_thread;
-} adc_btn_tag_t;
+    adc_btn_chan_t *chan;
+    int chan_num;
+    uint8_t *frame;
+    uint32_t frame_size;
+};
 
 static const int default_step_level[USER_KEY_MAX] = {0, 683, 1193, 1631, 2090, 2578, 3103};
 static const int DESTROY_BIT = BIT0;
@@ -165,103 +186,22 @@ static int get_adc_voltage(int channel)
     return (sum / (ADC_SAMPLES_NUM - 2));
 }
 
-static int get_button_id(adc_btn_list *node, int adc)
+static void adc_btn_on_event(void *ctx, int id, adc_btn_detect_event_t event)
 {
-    int m = ADC_BTN_INVALID_ID;
-    adc_arr_t *info = &(node->adc_info);
-    for (int i = 0; i < info->total_steps; i++) {
-        ESP_LOGV(TAG, "max:%d, adc:%d, i:%d, %d, %d", info->total_steps, adc, i, info->adc_level_step[i], info->adc_level_step[i + 1]);
-        if ((adc > info->adc_level_step[i])
-            && (adc <= info->adc_level_step[i + 1])) {
-            m = i;
-            break;
-        }
-    }
-    return m;
+    adc_btn_chan_t *chan = (adc_btn_chan_t *)ctx;
+    ESP_LOGD(TAG, "ADC:%d, ID:%d, state:%d", chan->node->adc_info.adc_ch, id, event);
+    chan->tag->btn_callback((void *)chan->tag->user_data, chan->node->adc_info.adc_ch, id, (adc_btn_state_t)event);
 }
 
-static void reset_btn(btn_decription *btn_dscp, int btn_num)
+static void adc_btn_tag_free(adc_btn_tag_t *tag)
 {
-    memset(btn_dscp, 0, sizeof(btn_decription) * btn_num);
-    for (int i = 0; i < btn_num; ++i) {
-        btn_dscp[i].active_id = ADC_BTN_INVALID_ID;
-    }
-}
-
-static adc_btn_state_t get_adc_btn_state(int adc_value, int act_id, adc_btn_list *node)
-{
-    adc_btn_state_t st = ADC_BTN_STATE_IDLE;
-    adc_arr_t *info = &(node->adc_info);
-    btn_decription *btn_dscp = node->btn_dscp;
-    int id = get_button_id(node, adc_value);
-    if (id == ADC_BTN_INVALID_ID) {
-        if (act_id == ADC_BTN_INVALID_ACT_ID) {
-            // No old act id and new act id.
-            return ADC_BTN_STATE_IDLE;
-        }
-        if (btn_dscp[act_id].click_cnt <= 1) {
-            return ADC_BTN_STATE_IDLE;
-        }
-        // Have old act ID, new id is invalid
-        // Need to send release event
-        if (btn_dscp[act_id].click_cnt < (info->press_judge_time / ADC_BTN_DETECT_TIME_MS)) {
-            ESP_LOGD(TAG, "pressed: Act ID:%d, ID:%d, Cnt:%d", act_id, id, btn_dscp[act_id].click_cnt);
-            st = ADC_BTN_STATE_RELEASE;
-        } else {
-            ESP_LOGD(TAG, "long press release: Act ID:%d, ID:%d, Cnt:%d", act_id, id, btn_dscp[act_id].click_cnt);
-            st = ADC_BTN_STATE_LONG_RELEASE;
-        }
-        btn_dscp[act_id].active_id = -1;
-        btn_dscp[act_id].long_click = 0;
-        btn_dscp[act_id].click_cnt = 0;
-        return st;
-    }
-    // 1.ID is valid and act ID is invalid.
-    if (act_id == ADC_BTN_INVALID_ACT_ID) {
-        // First new act id
-        btn_dscp[id].active_id = id;
-        return ADC_BTN_STATE_IDLE;
-    }
-    // 2.ID and act ID are valid, but not equal.
-    if (id != act_id) {
-        ESP_LOGW(TAG, "Old ID:%d, New ID:%d, Cnt:%d", act_id, id, btn_dscp[act_id].click_cnt);
-        // Invalid the act ID
-        btn_dscp[act_id].active_id = -1;
-        btn_dscp[act_id].long_click = 0;
-        // Set the new id act ID
-        btn_dscp[id].active_id = id;
-        // Maybe need to check release long pressed.
-        if (btn_dscp[act_id].click_cnt < ADC_BTN_DETECTED_CNT) {
-            btn_dscp[act_id].click_cnt = 0;
-            return ADC_BTN_STATE_IDLE;
-        }
-        btn_dscp[act_id].click_cnt = 0;
-        // Have old act ID, new id is invalid
-        // Need to send release event
-        if (btn_dscp[act_id].click_cnt < (info->press_judge_time / ADC_BTN_DETECT_TIME_MS)) {
-            ESP_LOGD(TAG, "pressed: Act ID:%d, ID:%d, Cnt:%d", act_id, id, btn_dscp[act_id].click_cnt);
-            return ADC_BTN_STATE_RELEASE;
-        } else {
-            ESP_LOGD(TAG, "long press release: Act ID:%d, ID:%d, Cnt:%d", act_id, id, btn_dscp[act_id].click_cnt);
-            return ADC_BTN_STATE_LONG_RELEASE;
-        }
-    }
-    // 3.ID and act ID are valid, and equal.
-    btn_dscp[act_id].click_cnt++;
-    if (btn_dscp[act_id].click_cnt == ADC_BTN_DETECTED_CNT) {
-        return ADC_BTN_STATE_PRESSED;
-    }
-
-    if (btn_dscp[act_id].long_click) {
-        return ADC_BTN_STATE_IDLE;
-    }
-    if (btn_dscp[act_id].click_cnt >= (info->press_judge_time / ADC_BTN_DETECT_TIME_MS)) {
-        //Send long click event.
-        ESP_LOGD(TAG, "long press: Act ID:%d, ID:%d, Cnt:%d", act_id, id, btn_dscp[act_id].click_cnt);
-        st = ADC_BTN_STATE_LONG_PRESSED;
-        btn_dscp[act_id].long_click = 1;
+    for (int i = 0; i < tag->chan_num; i++) {
+        audio_free(tag->chan[i].raw_step);
+        audio_free(tag->chan[i].samples);
     }
-    return st;
+    audio_free(tag->chan);
+    audio_free(tag->frame);
+    audio_free(tag);
 }
 
 static void button_task(void *parameters)
@@ -279,25 +219,20 @@ static void button_task(void *parameters)
 
     while (find) {
         adc_arr_t *info = &(find->adc_info);
-        reset_btn(find->btn_dscp, info->total_steps);
         adc1_config_channel_atten(info->adc_ch, ADC_ATTEN_11db);
         find = find->next;
     }
-    find = head;
 
 #if defined ENABLE_ADC_VOLUME
     adc1_config_channel_atten(DIAL_adc_ch, ADC_ATTEN_11db);
-    short adc_vol_prev = ADC_BTN_INVALID_ID;
-    short adc_vol_cur = ADC_BTN_INVALID_ID;
+    short adc_vol_prev = ADC_BTN_DETECT_INVALID_ID;
+    short adc_vol_cur = ADC_BTN_DETECT_INVALID_ID;
     short internal_time_ms = DIAL_VOL_INTERVAL_TIME_MS / ADC_SAMPLE_INTERVAL_TIME_MS; /// 10 * 10 = 100ms
     static bool empty_flag;
     static bool full_flag;
     bool is_first_time = true;
 #endif // ENABLE_ADC_VOLUME
 
-    static adc_btn_state_t cur_state = ADC_BTN_STATE_ADC;
-    adc_btn_state_t btn_st = ADC_BTN_STATE_IDLE;
-    int cur_act_id = ADC_BTN_INVALID_ACT_ID;
     while (_task_flag) {
 #if defined ENABLE_ADC_VOLUME
         if (internal_time_ms == 0) {
@@ -327,54 +262,10 @@ static void button_task(void *parameters)
         }
         internal_time_ms--;
 #else
-        find = head;
-        while (find) {
-            adc_arr_t *info = &(find->adc_info);
-            int act_id = ADC_BTN_INVALID_ACT_ID;
-            btn_decription *btn_dscp = find->btn_dscp;
-            switch (cur_state) {
-                case ADC_BTN_STATE_ADC: {
-                        int adc = get_adc_voltage(info->adc_ch);
-                        ESP_LOGD(TAG, "ADC:%d", adc);
-                        for (int i = 0; i < info->total_steps; ++i) {
-                            if (btn_dscp[i].active_id > ADC_BTN_INVALID_ID) {
-                                act_id = i;
-                                break;
-                            }
-                        }
-                        btn_st = get_adc_btn_state(adc, act_id, find);
-                        if (btn_st != ADC_BTN_STATE_IDLE) {
-                            cur_act_id = act_id;
-                            cur_state = btn_st;
-                            ESP_LOGD(TAG, "ADC ID:%d", act_id);
-                        }
-                        break;
-                    }
-                case ADC_BTN_STATE_PRESSED: {
-                        tag->btn_callback((void *)tag->user_data, info->adc_ch, cur_act_id, ADC_BTN_STATE_PRESSED);
-                        cur_state = ADC_BTN_STATE_ADC;
-                        break;
-                    }
-                case ADC_BTN_STATE_LONG_PRESSED: {
-                        tag->btn_callback((void *)tag->user_data, info->adc_ch, cur_act_id, ADC_BTN_STATE_LONG_PRESSED);
-                        cur_state = ADC_BTN_STATE_ADC;
-                        break;
-                    }
-                case ADC_BTN_STATE_LONG_RELEASE: {
-                        tag->btn_callback((void *)tag->user_data, info->adc_ch, cur_act_id, ADC_BTN_STATE_LONG_RELEASE);
-                        cur_state = ADC_BTN_STATE_ADC;
-                        break;
-                    }
-                case ADC_BTN_STATE_RELEASE: {
-                        tag->btn_callback((void *)tag->user_data, info->adc_ch, cur_act_id, ADC_BTN_STATE_RELEASE);
-                        cur_state = ADC_BTN_STATE_ADC;
-                        break;
-                    }
-                default:
-                    ESP_LOGE(TAG, "Not support state %d", cur_state);
-                    break;
-            }
-            find = find->next;
+        for (int i = 0; i < tag->chan_num; i++) {
+            // One averaged reading per interval, the detector window is a single sample
+            uint16_t adc = get_adc_voltage(tag->chan[i].node->adc_info.adc_ch);
+            adc_btn_detect_process(&tag->chan[i].det, &adc, 1, 1, adc_btn_on_event, &tag->chan[i]);
         }
 #endif // ENABLE_ADC_VOLUME
 
@@ -384,9 +275,141 @@ static void button_task(void *parameters)
     if (g_event_bit) {
         xEventGroupSetBits(g_event_bit, DESTROY_BIT);
     }
-    audio_free(tag);
+    adc_btn_tag_free(tag);
+    vTaskDelete(NULL);
+}
+
+#ifdef ADC_BTN_DMA_SUPPORTED
+// The largest raw reading not above `mv`, so that `raw > result` matches `voltage > mv`
+static int adc_btn_mv_to_raw(const esp_adc_cal_characteristics_t *characteristics, int mv)
+{
+    int low = 0;
+    int high = (1 << SOC_ADC_DIGI_MAX_BITWIDTH) - 1;
+    if (esp_adc_cal_raw_to_voltage(0, characteristics) > mv) {
+        return -1;
+    }
+    while (low < high) {
+        int mid = (low + high + 1) / 2;
+        if (esp_adc_cal_raw_to_voltage(mid, characteristics) <= mv) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return low;
+}
+
+static esp_err_t adc_btn_dma_start(adc_btn_tag_t *tag, int sample_rate)
+{
+    adc_digi_pattern_config_t adc_pattern[SOC_ADC_PATT_LEN_MAX] = { 0 };
+    uint32_t chan_mask = 0;
+    int pattern_num = 0;
+    for (int i = 0; i < tag->chan_num; i++) {
+        int ch = tag->chan[i].node->adc_info.adc_ch;
+        if ((chan_mask & BIT(ch)) || pattern_num >= SOC_ADC_PATT_LEN_MAX) {
+            continue;
+        }
+        chan_mask |= BIT(ch);
+        adc_pattern[pattern_num].atten = ADC_ATTEN_DB_11;
+        adc_pattern[pattern_num].channel = ch;
+        adc_pattern[pattern_num].unit = 0;
+        adc_pattern[pattern_num].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+        pattern_num++;
+    }
+    if (pattern_num == 0) {
+        ESP_LOGE(TAG, "No ADC channel to scan");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (sample_rate < SOC_ADC_SAMPLE_FREQ_THRES_LOW) {
+        sample_rate = SOC_ADC_SAMPLE_FREQ_THRES_LOW;
+    }
+    // One frame holds ADC_BTN_DMA_FRAME_MS of conversions, the task only wakes once per frame
+    tag->frame_size = sample_rate * ADC_BTN_DMA_FRAME_MS / 1000 * ADC_BTN_DMA_RESULT_BYTES;
+    tag->frame = audio_calloc(1, tag->frame_size);
+    AUDIO_MEM_CHECK(TAG, tag->frame, return ESP_ERR_NO_MEM);
+
+    esp_adc_cal_characteristics_t characteristics;
+    esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12, 0, &characteristics);
+    for (int i = 0; i < tag->chan_num; i++) {
+        adc_btn_chan_t *chan = &tag->chan[i];
+        adc_arr_t *info = &chan->node->adc_info;
+        chan->samples = audio_calloc(tag->frame_size / ADC_BTN_DMA_RESULT_BYTES, sizeof(uint16_t));
+        chan->raw_step = audio_calloc(info->total_steps + 1, sizeof(int));
+        AUDIO_MEM_CHECK(TAG, chan->samples && chan->raw_step, return ESP_ERR_NO_MEM);
+        // Compare raw readings on the fly instead of calibrating every sample
+        for (int j = 0; j <= info->total_steps; j++) {
+            chan->raw_step[j] = adc_btn_mv_to_raw(&characteristics, info->adc_level_step[j]);
+        }
+        adc_btn_detect_init(&chan->det, chan->raw_step, info->total_steps, sample_rate / pattern_num, info->press_judge_time);
+    }
+
+    adc_digi_init_config_t adc_dma_config = {
+        .max_store_buf_size = tag->frame_size * 4,
+        .conv_num_each_intr = tag->frame_size,
+        .adc1_chan_mask = chan_mask,
+        .adc2_chan_mask = 0,
+    };
+    esp_err_t ret = adc_digi_initialize(&adc_dma_config);
+    AUDIO_CHECK(TAG, ret == ESP_OK, return ret, "ADC continuous mode initialize failed");
+    adc_digi_configuration_t dig_cfg = {
+        .conv_limit_en = 0,
+        .conv_limit_num = 250,
+        .pattern_num = pattern_num,
+        .adc_pattern = adc_pattern,
+        .sample_freq_hz = sample_rate,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE2,
+    };
+    ret = adc_digi_controller_configure(&dig_cfg);
+    if (ret == ESP_OK) {
+        ret = adc_digi_start();
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "ADC continuous mode start failed, ret:%d", ret);
+        adc_digi_deinitialize();
+    }
+    return ret;
+}
+
+static void button_dma_task(void *parameters)
+{
+    _task_flag = true;
+    adc_btn_tag_t *tag = (adc_btn_tag_t *)parameters;
+    xEventGroupClearBits(g_event_bit, DESTROY_BIT);
+    while (_task_flag) {
+        uint32_t len = 0;
+        // Sleep until the DMA has filled a frame, the timeout only serves `adc_btn_delete_task`
+        if (adc_digi_read_bytes(tag->frame, tag->frame_size, &len, ADC_BTN_DMA_READ_TIMEOUT_MS) != ESP_OK) {
+            continue;
+        }
+        for (int i = 0; i < tag->chan_num; i++) {
+            tag->chan[i].sample_num = 0;
+        }
+        for (uint32_t pos = 0; pos + ADC_BTN_DMA_RESULT_BYTES <= len; pos += ADC_BTN_DMA_RESULT_BYTES) {
+            adc_digi_output_data_t *p = (adc_digi_output_data_t *)&tag->frame[pos];
+            if (p->type2.unit != 0) {
+                continue;
+            }
+            for (int i = 0; i < tag->chan_num; i++) {
+                if (tag->chan[i].node->adc_info.adc_ch == p->type2.channel) {
+                    tag->chan[i].samples[tag->chan[i].sample_num++] = p->type2.data;
+                }
+            }
+        }
+        for (int i = 0; i < tag->chan_num; i++) {
+            adc_btn_detect_process(&tag->chan[i].det, tag->chan[i].samples, tag->chan[i].sample_num, 1, adc_btn_on_event, &tag->chan[i]);
+        }
+    }
+    adc_digi_stop();
+    adc_digi_deinitialize();
+
+    if (g_event_bit) {
+        xEventGroupSetBits(g_event_bit, DESTROY_BIT);
+    }
+    adc_btn_tag_free(tag);
     vTaskDelete(NULL);
 }
+#endif
 
 void adc_btn_delete_task(void)
 {
@@ -411,11 +434,45 @@ void adc_btn_init(void *user_data, adc_button_callback cb, adc_btn_list *head, a
     tag->user_data = user_data;
     tag->head = head;
     tag->btn_callback = cb;
+    for (adc_btn_list *find = head; find; find = find->next) {
+        tag->chan_num++;
+    }
+    tag->chan = audio_calloc(tag->chan_num, sizeof(adc_btn_chan_t));
+    if (NULL == tag->chan) {
+        ESP_LOGE(TAG, "Memory allocation failed! Line: %d", __LINE__);
+        audio_free(tag);
+        return;
+    }
+    adc_btn_list *find = head;
+    for (int i = 0; i < tag->chan_num; i++, find = find->next) {
+        tag->chan[i].node = find;
+        tag->chan[i].tag = tag;
+    }
+
+    void (*task)(void *) = button_task;
+    if (task_cfg->dma_sample_rate > 0) {
+#ifdef ADC_BTN_DMA_SUPPORTED
+        if (adc_btn_dma_start(tag, task_cfg->dma_sample_rate) == ESP_OK) {
+            task = button_dma_task;
+        } else {
+            ESP_LOGW(TAG, "Fall back to one shot reads");
+        }
+#else
+        ESP_LOGW(TAG, "Continuous mode is not supported on this target, fall back to one shot reads");
+#endif
+    }
+    if (task == button_task) {
+        for (int i = 0; i < tag->chan_num; i++) {
+            adc_arr_t *info = &(tag->chan[i].node->adc_info);
+            adc_btn_detect_init(&tag->chan[i].det, info->adc_level_step, info->total_steps,
+                                1000 / ADC_SAMPLE_INTERVAL_TIME_MS, info->press_judge_time);
+        }
+    }
 
     g_event_bit = xEventGroupCreate();
 
     audio_thread_create(&tag->audio_thread,
-                        "button_task", button_task,
+                        "button_task", task,
                         (void *)tag,
                         task_cfg->task_stack,
                         task_cfg->task_prio,
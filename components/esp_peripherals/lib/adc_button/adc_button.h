@@ -75,6 +75,7 @@ typedef struct {
     int task_prio;
     int task_core;
     bool ext_stack;
+    int dma_sample_rate;    // Conversions per second of the continuous (DMA) mode, 0 to poll with one shot reads
 } adc_btn_task_cfg_t;
 
 typedef void (*adc_button_callback) (void *user_data, int adc, int id, adc_btn_state_t state);
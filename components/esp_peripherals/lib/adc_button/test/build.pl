@@ -0,0 +1,3 @@
+#!/usr/bin/perl
+# adc_button.c needs the ADC driver, only the detector is built on host
+`gcc ../adc_btn_detect.c test.c -I../ -I../../../../../tools/host_test/include -g -O2 -Wall -o ./test`;
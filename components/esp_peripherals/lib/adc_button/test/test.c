@@ -0,0 +1,294 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) PTE LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "adc_btn_detect.h"
+#include "host_test.h"
+
+/*
+ * Replay ADC traces through the detector and check the reported events.
+ * Traces are synthesized with noise and contact bounce, or loaded from capture files given on the
+ * command line: one sample in millivolt per line, an optional "# rate <hz>" line sets the sample rate.
+ */
+#define TRACE_RATE          (1000)
+#define TRACE_MAX           (60 * TRACE_RATE)
+#define TRACE_IDLE_MV       (3300)
+#define TRACE_NOISE_MV      (25)
+#define TRACE_BOUNCE_MS     (6)
+#define PRESS_JUDGE_TIME    (3000)
+#define EVENT_MAX           (64)
+
+// Same as `default_step_level` of adc_button.c
+static const int level_step[] = {0, 683, 1193, 1631, 2090, 2578, 3103};
+#define TOTAL_STEPS (sizeof(level_step) / sizeof(level_step[0]) - 1)
+
+typedef struct {
+    int id;
+    int event;
+    int at;
+} event_t;
+
+typedef struct {
+    event_t e[EVENT_MAX];
+    int     num;
+    int     pos;    // Sample index at the end of the processed block
+} result_t;
+
+static uint16_t trace[TRACE_MAX];
+static int      trace_len;
+
+static void on_event(void *ctx, int id, adc_btn_detect_event_t event)
+{
+    result_t *r = (result_t *)ctx;
+    CHECK(r->num < EVENT_MAX);
+    r->e[r->num].id = id;
+    r->e[r->num].event = event;
+    r->e[r->num].at = r->pos;
+    r->num++;
+}
+
+static int noise(void)
+{
+    return rand() % (2 * TRACE_NOISE_MV + 1) - TRACE_NOISE_MV;
+}
+
+static int key_mv(int id)
+{
+    return (level_step[id] + level_step[id + 1]) / 2;
+}
+
+static void trace_idle(int ms)
+{
+    for (int i = 0; i < ms * TRACE_RATE / 1000 && trace_len < TRACE_MAX; i++) {
+        trace[trace_len++] = TRACE_IDLE_MV + noise();
+    }
+}
+
+// Hold a key for `ms`, with contact bounce on both edges
+static void trace_key(int id, int ms)
+{
+    int n = ms * TRACE_RATE / 1000;
+    int bounce = TRACE_BOUNCE_MS * TRACE_RATE / 1000;
+    for (int i = 0; i < n && trace_len < TRACE_MAX; i++) {
+        bool edge = i < bounce || i >= n - bounce;
+        int mv = (edge && (rand() & 1)) ? TRACE_IDLE_MV : key_mv(id);
+        trace[trace_len++] = mv + noise();
+    }
+}
+
+static void run(result_t *r, int rate, int block)
+{
+    adc_btn_detect_t det;
+    adc_btn_detect_init(&det, level_step, TOTAL_STEPS, rate, PRESS_JUDGE_TIME);
+    memset(r, 0, sizeof(result_t));
+    for (int pos = 0; pos < trace_len; pos += block) {
+        int n = trace_len - pos < block ? trace_len - pos : block;
+        r->pos = pos + n;
+        adc_btn_detect_process(&det, trace + pos, n, 1, on_event, r);
+    }
+}
+
+static void check_events(result_t *r, const event_t *expect, int num)
+{
+    CHECK(r->num == num);
+    for (int i = 0; i < num; i++) {
+        CHECK(r->e[i].id == expect[i].id);
+        CHECK(r->e[i].event == expect[i].event);
+    }
+}
+
+static void test_idle(void)
+{
+    result_t r;
+    adc_btn_detect_t det;
+    trace_len = 0;
+    trace_idle(10000);
+    adc_btn_detect_init(&det, level_step, TOTAL_STEPS, TRACE_RATE, PRESS_JUDGE_TIME);
+    CHECK(adc_btn_detect_process(&det, trace, trace_len, 1, on_event, &r) == 0);
+    // No window was started for the untouched keypad
+    CHECK(adc_btn_detect_idle(&det));
+    printf("%s PASS\n", __FUNCTION__);
+}
+
+static void test_clicks(void)
+{
+    result_t r;
+    trace_len = 0;
+    trace_idle(200);
+    trace_key(1, 150);
+    trace_idle(300);
+    trace_key(4, 3500);
+    trace_idle(300);
+    // A bounce too short to be a press
+    trace_key(2, 30);
+    trace_idle(300);
+    trace_key(5, 200);
+    trace_idle(100);
+    const event_t expect[] = {
+        {1, ADC_BTN_DETECT_PRESSED},
+        {1, ADC_BTN_DETECT_RELEASE},
+        {4, ADC_BTN_DETECT_PRESSED},
+        {4, ADC_BTN_DETECT_LONG_PRESSED},
+        {4, ADC_BTN_DETECT_LONG_RELEASE},
+        {5, ADC_BTN_DETECT_PRESSED},
+        {5, ADC_BTN_DETECT_RELEASE},
+    };
+    int blocks[] = {1, 7, 20, 64, 333, 4096};
+    for (int i = 0; i < sizeof(blocks) / sizeof(blocks[0]); i++) {
+        run(&r, TRACE_RATE, blocks[i]);
+        check_events(&r, expect, sizeof(expect) / sizeof(expect[0]));
+    }
+    // Press reported within 3 windows plus the bounce, long press after the judge time
+    run(&r, TRACE_RATE, 1);
+    CHECK(r.e[0].at - 200 <= 3 * ADC_BTN_DETECT_TIME_MS + TRACE_BOUNCE_MS + 1);
+    CHECK(r.e[3].at - r.e[2].at >= PRESS_JUDGE_TIME - 2 * ADC_BTN_DETECT_TIME_MS);
+    printf("%s PASS\n", __FUNCTION__);
+}
+
+static void test_slide(void)
+{
+    result_t r;
+    trace_len = 0;
+    trace_idle(100);
+    // Slide from one key to the next without releasing
+    trace_key(0, 200);
+    trace_key(3, 200);
+    trace_idle(100);
+    const event_t expect[] = {
+        {0, ADC_BTN_DETECT_PRESSED},
+        {0, ADC_BTN_DETECT_RELEASE},
+        {3, ADC_BTN_DETECT_PRESSED},
+        {3, ADC_BTN_DETECT_RELEASE},
+    };
+    run(&r, TRACE_RATE, 50);
+    check_events(&r, expect, sizeof(expect) / sizeof(expect[0]));
+    printf("%s PASS\n", __FUNCTION__);
+}
+
+static void test_interleaved(void)
+{
+    // Two channels sharing one DMA frame, the second one stays idle
+    static uint16_t frame[2 * TRACE_MAX];
+    result_t r[2];
+    adc_btn_detect_t det[2];
+    trace_len = 0;
+    trace_idle(100);
+    trace_key(2, 400);
+    trace_idle(100);
+    for (int i = 0; i < trace_len; i++) {
+        frame[2 * i] = trace[i];
+        frame[2 * i + 1] = TRACE_IDLE_MV + noise();
+    }
+    memset(r, 0, sizeof(r));
+    for (int ch = 0; ch < 2; ch++) {
+        adc_btn_detect_init(&det[ch], level_step, TOTAL_STEPS, TRACE_RATE, PRESS_JUDGE_TIME);
+        adc_btn_detect_process(&det[ch], frame + ch, trace_len, 2, on_event, &r[ch]);
+    }
+    const event_t expect[] = {
+        {2, ADC_BTN_DETECT_PRESSED},
+        {2, ADC_BTN_DETECT_RELEASE},
+    };
+    check_events(&r[0], expect, 2);
+    CHECK(r[1].num == 0);
+    printf("%s PASS\n", __FUNCTION__);
+}
+
+static void test_polling_rate(void)
+{
+    // The one shot path feeds one averaged value every ADC_BTN_DETECT_TIME_MS
+    result_t r;
+    adc_btn_detect_t det;
+    const uint16_t values[] = {3300, 1400, 1400, 1400, 1400, 3300, 3300};
+    memset(&r, 0, sizeof(r));
+    adc_btn_detect_init(&det, level_step, TOTAL_STEPS, 1000 / ADC_BTN_DETECT_TIME_MS, PRESS_JUDGE_TIME);
+    CHECK(det.window == 1);
+    adc_btn_detect_process(&det, values, sizeof(values) / sizeof(values[0]), 1, on_event, &r);
+    const event_t expect[] = {
+        {2, ADC_BTN_DETECT_PRESSED},
+        {2, ADC_BTN_DETECT_RELEASE},
+    };
+    check_events(&r, expect, 2);
+    printf("%s PASS\n", __FUNCTION__);
+}
+
+static const char *event_name(int event)
+{
+    switch (event) {
+        case ADC_BTN_DETECT_PRESSED:
+            return "PRESSED";
+        case ADC_BTN_DETECT_RELEASE:
+            return "RELEASE";
+        case ADC_BTN_DETECT_LONG_PRESSED:
+            return "LONG_PRESSED";
+        default:
+            return "LONG_RELEASE";
+    }
+}
+
+static void replay_file(const char *f)
+{
+    FILE *fp = fopen(f, "r");
+    if (fp == NULL) {
+        printf("File %s not exists\n", f);
+        return;
+    }
+    char line[64];
+    int rate = TRACE_RATE;
+    trace_len = 0;
+    while (fgets(line, sizeof(line), fp) && trace_len < TRACE_MAX) {
+        if (line[0] == '#') {
+            sscanf(line, "# rate %d", &rate);
+            continue;
+        }
+        trace[trace_len++] = atoi(line);
+    }
+    fclose(fp);
+    result_t r;
+    run(&r, rate, 256);
+    printf("%s: %d samples at %d Hz\n", f, trace_len, rate);
+    for (int i = 0; i < r.num; i++) {
+        printf("  %8.3f s  key %d  %s\n", (double)r.e[i].at / rate, r.e[i].id, event_name(r.e[i].event));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc >= 2) {
+        for (int i = 1; i < argc; i++) {
+            replay_file(argv[i]);
+        }
+        return 0;
+    }
+    srand(1);
+    test_idle();
+    test_clicks();
+    test_slide();
+    test_interleaved();
+    test_polling_rate();
+    printf("PASS\n");
+    return 0;
+}
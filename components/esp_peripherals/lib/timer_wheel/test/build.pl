@@ -0,0 +1,3 @@
+#!/usr/bin/perl
+my @f = <../*.c>;
+`gcc @f test.c -I../ -I../../../../../tools/host_test/include -g -O2 -Wall -o ./test`;
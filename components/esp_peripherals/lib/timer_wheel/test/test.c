@@ -0,0 +1,162 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) PTE LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "timer_wheel.h"
+#include "host_test.h"
+
+/*
+ * Drive the wheel with random add / delete / advance steps and compare every expiry
+ * and every next deadline with a brute force model.
+ */
+#define NODE_NUM    (48)
+#define STEPS       (200000)
+
+typedef struct {
+    timer_wheel_node_t node;
+    bool               active;
+    uint32_t           expire;
+    uint32_t           period;
+    uint32_t           fired;
+} model_t;
+
+static timer_wheel_t wheel;
+static model_t       model[NODE_NUM];
+static uint32_t      cur_tick;
+static uint32_t      last_fire_tick;
+
+static uint32_t rand_delay(void)
+{
+    switch (rand() % 4) {
+        case 0:
+            return 1 + rand() % 8;
+        case 1:
+            return 1 + rand() % 200;
+        case 2:
+            return 1 + rand() % 5000;
+        default:
+            return 1 + rand() % 20000;
+    }
+}
+
+static void on_fire(timer_wheel_node_t *node, void *ctx)
+{
+    model_t *m = (model_t *)ctx;
+    CHECK(m->active);
+    // Callbacks are invoked in expiry order, at the tick the timer is due
+    CHECK(m->expire == wheel.now);
+    CHECK((int32_t)(m->expire - last_fire_tick) >= 0);
+    last_fire_tick = m->expire;
+    m->fired++;
+    if (m->period) {
+        m->expire += m->period;
+    } else {
+        m->active = false;
+    }
+    // Some callbacks reschedule or cancel other timers
+    if (rand() % 16 == 0) {
+        model_t *o = &model[rand() % NODE_NUM];
+        if (o != m) {
+            timer_wheel_del(&wheel, &o->node);
+            o->active = false;
+        }
+    }
+}
+
+static bool model_next(uint32_t *ticks)
+{
+    bool found = false;
+    for (int i = 0; i < NODE_NUM; i++) {
+        if (model[i].active && (!found || model[i].expire - wheel.now < *ticks)) {
+            *ticks = model[i].expire - wheel.now;
+            found = true;
+        }
+    }
+    return found;
+}
+
+static void test_random(uint32_t start)
+{
+    timer_wheel_init(&wheel, start);
+    cur_tick = start;
+    last_fire_tick = start;
+    for (int i = 0; i < NODE_NUM; i++) {
+        timer_wheel_node_init(&model[i].node, on_fire, &model[i]);
+        model[i].active = false;
+        model[i].fired = 0;
+    }
+    int fired = 0;
+    for (int step = 0; step < STEPS; step++) {
+        model_t *m = &model[rand() % NODE_NUM];
+        switch (rand() % 4) {
+            case 0: {
+                uint32_t delay = rand_delay();
+                uint32_t period = rand() % 2 ? rand_delay() : 0;
+                timer_wheel_add(&wheel, &m->node, delay, period);
+                m->active = true;
+                m->expire = wheel.now + delay;
+                m->period = period;
+                break;
+            }
+            case 1:
+                timer_wheel_del(&wheel, &m->node);
+                m->active = false;
+                break;
+            default: {
+                uint32_t next = 0, expect = 0;
+                bool has = timer_wheel_next(&wheel, &next);
+                CHECK(has == model_next(&expect));
+                CHECK(!has || next == expect);
+                // Sleep until the next deadline like the tickless driver, or wake up early
+                uint32_t jump = has && rand() % 2 ? next : 1 + rand() % 300;
+                cur_tick += jump;
+                fired += timer_wheel_advance(&wheel, cur_tick);
+                CHECK(wheel.now == cur_tick);
+                break;
+            }
+        }
+        for (int i = 0; i < NODE_NUM; i++) {
+            CHECK(timer_wheel_node_active(&model[i].node) == model[i].active);
+        }
+    }
+    uint32_t total = 0;
+    for (int i = 0; i < NODE_NUM; i++) {
+        CHECK(model[i].node.fired == model[i].fired);
+        total += model[i].fired;
+    }
+    CHECK(total == (uint32_t)fired);
+    printf("start %u: %d callbacks in %d steps, wheel time %u\n", start, fired, STEPS, wheel.now);
+}
+
+int main(int argc, char **argv)
+{
+    srand(1);
+    test_random(0);
+    // Tick counter wrap around
+    test_random(UINT32_MAX - 100000);
+    printf("PASS\n");
+    return 0;
+}
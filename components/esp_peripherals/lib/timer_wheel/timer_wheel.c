@@ -0,0 +1,210 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) PTE LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stddef.h>
+#include "timer_wheel.h"
+
+#define LEVEL0_SPAN     (TIMER_WHEEL_SLOTS)
+#define LEVEL1_SPAN     (TIMER_WHEEL_SLOTS * TIMER_WHEEL_SLOTS)
+#define SLOT_MASK       (TIMER_WHEEL_SLOTS - 1)
+#define NODE_OF(e)      ((timer_wheel_node_t *)(e))
+
+static inline void list_init(timer_wheel_list_t *head)
+{
+    head->next = head;
+    head->prev = head;
+}
+
+static inline bool list_empty(const timer_wheel_list_t *head)
+{
+    return head->next == head;
+}
+
+static inline void list_add_tail(timer_wheel_list_t *head, timer_wheel_list_t *node)
+{
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+static inline void list_unlink(timer_wheel_list_t *node)
+{
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->next = NULL;
+    node->prev = NULL;
+}
+
+static inline void list_move_all(timer_wheel_list_t *to, timer_wheel_list_t *from)
+{
+    list_init(to);
+    if (!list_empty(from)) {
+        to->next = from->next;
+        to->prev = from->prev;
+        to->next->prev = to;
+        to->prev->next = to;
+        list_init(from);
+    }
+}
+
+static void wheel_insert(timer_wheel_t *wheel, timer_wheel_node_t *node)
+{
+    uint32_t diff = node->expire - wheel->now;
+    if (diff < LEVEL0_SPAN) {
+        list_add_tail(&wheel->level0[node->expire & SLOT_MASK], &node->entry);
+    } else if (diff < LEVEL1_SPAN) {
+        list_add_tail(&wheel->level1[(node->expire >> TIMER_WHEEL_BITS) & SLOT_MASK], &node->entry);
+    } else {
+        list_add_tail(&wheel->overflow, &node->entry);
+    }
+}
+
+static void wheel_reinsert(timer_wheel_t *wheel, timer_wheel_list_t *list)
+{
+    timer_wheel_list_t tmp;
+    list_move_all(&tmp, list);
+    while (!list_empty(&tmp)) {
+        timer_wheel_node_t *node = NODE_OF(tmp.next);
+        list_unlink(&node->entry);
+        wheel_insert(wheel, node);
+    }
+}
+
+void timer_wheel_init(timer_wheel_t *wheel, uint32_t now)
+{
+    wheel->now = now;
+    wheel->count = 0;
+    for (int i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+        list_init(&wheel->level0[i]);
+        list_init(&wheel->level1[i]);
+    }
+    list_init(&wheel->overflow);
+}
+
+void timer_wheel_node_init(timer_wheel_node_t *node, timer_wheel_cb_t cb, void *ctx)
+{
+    node->entry.next = NULL;
+    node->entry.prev = NULL;
+    node->expire = 0;
+    node->period = 0;
+    node->fired = 0;
+    node->cb = cb;
+    node->ctx = ctx;
+}
+
+bool timer_wheel_node_active(const timer_wheel_node_t *node)
+{
+    return node->entry.next != NULL;
+}
+
+void timer_wheel_add(timer_wheel_t *wheel, timer_wheel_node_t *node, uint32_t delay, uint32_t period)
+{
+    timer_wheel_del(wheel, node);
+    node->expire = wheel->now + (delay ? delay : 1);
+    node->period = period;
+    wheel_insert(wheel, node);
+    wheel->count++;
+}
+
+void timer_wheel_del(timer_wheel_t *wheel, timer_wheel_node_t *node)
+{
+    if (timer_wheel_node_active(node)) {
+        list_unlink(&node->entry);
+        wheel->count--;
+    }
+}
+
+int timer_wheel_advance(timer_wheel_t *wheel, uint32_t now)
+{
+    int fired = 0;
+    while (wheel->now != now) {
+        if (wheel->count == 0) {
+            wheel->now = now;
+            break;
+        }
+        uint32_t t = ++wheel->now;
+        if ((t & (LEVEL1_SPAN - 1)) == 0) {
+            wheel_reinsert(wheel, &wheel->overflow);
+        }
+        if ((t & SLOT_MASK) == 0) {
+            wheel_reinsert(wheel, &wheel->level1[(t >> TIMER_WHEEL_BITS) & SLOT_MASK]);
+        }
+        // Detach the slot first, the callbacks may add timers due at this tick or delete the pending ones
+        timer_wheel_list_t due;
+        list_move_all(&due, &wheel->level0[t & SLOT_MASK]);
+        while (!list_empty(&due)) {
+            timer_wheel_node_t *node = NODE_OF(due.next);
+            list_unlink(&node->entry);
+            wheel->count--;
+            if (node->period) {
+                node->expire = t + node->period;
+                wheel_insert(wheel, node);
+                wheel->count++;
+            }
+            node->fired++;
+            fired++;
+            if (node->cb) {
+                node->cb(node, node->ctx);
+            }
+        }
+    }
+    return fired;
+}
+
+bool timer_wheel_next(timer_wheel_t *wheel, uint32_t *ticks)
+{
+    if (wheel->count == 0) {
+        return false;
+    }
+    // Level 0 slots are visited in expiry order, the first hit is the earliest timer of level 0,
+    // but a level 1 timer not cascaded yet may still be earlier
+    uint32_t best = UINT32_MAX;
+    timer_wheel_list_t *pos;
+    for (uint32_t i = 1; i <= LEVEL0_SPAN; i++) {
+        if (!list_empty(&wheel->level0[(wheel->now + i) & SLOT_MASK])) {
+            best = i;
+            break;
+        }
+    }
+    for (uint32_t i = 1; i <= TIMER_WHEEL_SLOTS; i++) {
+        timer_wheel_list_t *head = &wheel->level1[((wheel->now >> TIMER_WHEEL_BITS) + i) & SLOT_MASK];
+        if (list_empty(head)) {
+            continue;
+        }
+        for (pos = head->next; pos != head; pos = pos->next) {
+            if (NODE_OF(pos)->expire - wheel->now < best) {
+                best = NODE_OF(pos)->expire - wheel->now;
+            }
+        }
+        break;
+    }
+    for (pos = wheel->overflow.next; pos != &wheel->overflow; pos = pos->next) {
+        if (NODE_OF(pos)->expire - wheel->now < best) {
+            best = NODE_OF(pos)->expire - wheel->now;
+        }
+    }
+    *ticks = best;
+    return true;
+}
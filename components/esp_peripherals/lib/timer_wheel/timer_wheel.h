@@ -0,0 +1,139 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) PTE LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef _TIMER_WHEEL_H_
+#define _TIMER_WHEEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TIMER_WHEEL_BITS    (6)
+#define TIMER_WHEEL_SLOTS   (1 << TIMER_WHEEL_BITS)
+
+/**
+ * @brief Two level hierarchical timer wheel counted in ticks
+ *
+ *        Level 0 has one slot per tick for the timers due in the next 64 ticks, level 1 one slot per 64 ticks
+ *        for the next 4096 ticks, and the rest wait in an overflow list. The wheel doesn't lock nor allocate,
+ *        the caller provides the nodes and serializes the calls.
+ */
+typedef struct timer_wheel_node timer_wheel_node_t;
+
+typedef void (*timer_wheel_cb_t)(timer_wheel_node_t *node, void *ctx);
+
+typedef struct timer_wheel_list {
+    struct timer_wheel_list *next;
+    struct timer_wheel_list *prev;
+} timer_wheel_list_t;
+
+struct timer_wheel_node {
+    timer_wheel_list_t  entry;      /*!< Must be the first member */
+    uint32_t            expire;     /*!< Absolute tick the timer is due */
+    uint32_t            period;     /*!< Reload period in ticks, 0 for one shot */
+    uint32_t            fired;      /*!< Number of times the callback was invoked */
+    timer_wheel_cb_t    cb;         /*!< Callback, invoked from `timer_wheel_advance` */
+    void                *ctx;       /*!< Callback context */
+};
+
+typedef struct {
+    uint32_t            now;
+    int                 count;
+    timer_wheel_list_t  level0[TIMER_WHEEL_SLOTS];
+    timer_wheel_list_t  level1[TIMER_WHEEL_SLOTS];
+    timer_wheel_list_t  overflow;
+} timer_wheel_t;
+
+/**
+ * @brief      Initialize the wheel
+ *
+ * @param      wheel  The wheel
+ * @param[in]  now    Current tick
+ */
+void timer_wheel_init(timer_wheel_t *wheel, uint32_t now);
+
+/**
+ * @brief      Initialize a node, must be called once before the node is added
+ *
+ * @param      node  The node
+ * @param[in]  cb    The callback
+ * @param      ctx   The callback context
+ */
+void timer_wheel_node_init(timer_wheel_node_t *node, timer_wheel_cb_t cb, void *ctx);
+
+/**
+ * @brief      Add a timer, an active node is rescheduled
+ *
+ * @param      wheel   The wheel
+ * @param      node    The node
+ * @param[in]  delay   Ticks from the wheel time until the first expiry, at least 1
+ * @param[in]  period  Reload period in ticks, 0 for one shot
+ */
+void timer_wheel_add(timer_wheel_t *wheel, timer_wheel_node_t *node, uint32_t delay, uint32_t period);
+
+/**
+ * @brief      Remove a timer, it's fine to remove an inactive node or to remove it from its own callback
+ *
+ * @param      wheel  The wheel
+ * @param      node   The node
+ */
+void timer_wheel_del(timer_wheel_t *wheel, timer_wheel_node_t *node);
+
+/**
+ * @brief      Whether the node is scheduled
+ */
+bool timer_wheel_node_active(const timer_wheel_node_t *node);
+
+/**
+ * @brief      Move the wheel time to `now` and invoke the callbacks of all due timers in expiry order
+ *
+ * @note       The callbacks may add or delete any node of the wheel
+ *
+ * @param      wheel  The wheel
+ * @param[in]  now    Current tick
+ *
+ * @return     Number of callbacks invoked
+ */
+int timer_wheel_advance(timer_wheel_t *wheel, uint32_t now);
+
+/**
+ * @brief      Get the ticks from the wheel time to the next expiry
+ *
+ * @param      wheel  The wheel
+ * @param      ticks  The ticks until the next expiry
+ *
+ * @return
+ *     - true, a timer is scheduled
+ *     - false, the wheel is empty
+ */
+bool timer_wheel_next(timer_wheel_t *wheel, uint32_t *ticks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,100 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) PTE LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "ws2812_encoder.h"
+
+#define BIT0            (0x00128007)
+#define BIT1            (0x00078012)
+#define BENCH_ROUNDS    (200)
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// The per frame path periph_ws2812 used: GRB buffer and item array allocated, bits expanded one by one
+static uint32_t encode_legacy(const uint32_t *colors, int led_num)
+{
+    int len = led_num * 3;
+    uint8_t *grb = malloc(len);
+    for (int i = 0; i < led_num; i++) {
+        grb[i * 3] = (uint8_t)(colors[i] >> 8);
+        grb[i * 3 + 1] = (uint8_t)colors[i];
+        grb[i * 3 + 2] = (uint8_t)(colors[i] >> 16);
+    }
+    uint32_t *items = malloc(sizeof(uint32_t) * len * 8);
+    for (int i = 0; i < len; i++) {
+        unsigned int bit = grb[i];
+        for (int j = 0; j < 8; j++, bit <<= 1) {
+            items[j + i * 8] = ((bit >> 7) & 0x01) ? BIT1 : BIT0;
+        }
+    }
+    uint32_t check = items[len * 8 - 1];
+    free(items);
+    free(grb);
+    return check;
+}
+
+int main(void)
+{
+    int leds[] = { 8, 60, 300, 1000 };
+    ws2812_encoder_t enc;
+    ws2812_encoder_init(&enc, BIT0, BIT1);
+    printf("%8s %16s %16s\n", "leds", "legacy ns/led", "lut ns/led");
+    for (int k = 0; k < sizeof(leds) / sizeof(leds[0]); k++) {
+        int n = leds[k];
+        uint32_t *colors = malloc(n * sizeof(uint32_t));
+        uint32_t *items = malloc(n * WS2812_ITEMS_PER_LED * sizeof(uint32_t));
+        for (int i = 0; i < n; i++) {
+            colors[i] = (uint32_t)rand() & 0x00FFFFFF;
+        }
+        volatile uint32_t sink = 0;
+        double best_legacy = 0, best_lut = 0;
+        for (int round = 0; round < BENCH_ROUNDS; round++) {
+            double start = now_us();
+            sink += encode_legacy(colors, n);
+            double cost = now_us() - start;
+            if (round == 0 || cost < best_legacy) {
+                best_legacy = cost;
+            }
+            start = now_us();
+            ws2812_encoder_run(&enc, colors, n, items);
+            sink += items[n * WS2812_ITEMS_PER_LED - 1];
+            cost = now_us() - start;
+            if (round == 0 || cost < best_lut) {
+                best_lut = cost;
+            }
+        }
+        printf("%8d %16.2f %16.2f\n", n, best_legacy * 1000 / n, best_lut * 1000 / n);
+        free(colors);
+        free(items);
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) PTE LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "ws2812_encoder.h"
+#include "host_test.h"
+
+#define BIT0        (0x00128007)
+#define BIT1        (0x00078012)
+#define LED_MAX     (300)
+
+// Bit by bit expansion over a GRB buffer, as periph_ws2812 used to do
+static void encode_ref(const uint32_t *colors, int led_num, uint32_t *items)
+{
+    for (int i = 0; i < led_num; i++) {
+        uint8_t grb[3] = { (uint8_t)(colors[i] >> 8), (uint8_t)colors[i], (uint8_t)(colors[i] >> 16) };
+        for (int k = 0; k < 3; k++) {
+            unsigned int bit = grb[k];
+            for (int j = 0; j < 8; j++, bit <<= 1) {
+                *items++ = ((bit >> 7) & 0x01) ? BIT1 : BIT0;
+            }
+        }
+    }
+}
+
+int main(void)
+{
+    static uint32_t colors[LED_MAX];
+    static uint32_t items[LED_MAX * WS2812_ITEMS_PER_LED + 1];
+    static uint32_t ref[LED_MAX * WS2812_ITEMS_PER_LED];
+    ws2812_encoder_t enc;
+    ws2812_encoder_init(&enc, BIT0, BIT1);
+    srand(1);
+    for (int round = 0; round < 1000; round++) {
+        int n = 1 + rand() % LED_MAX;
+        for (int i = 0; i < n; i++) {
+            colors[i] = (uint32_t)rand() & 0x00FFFFFF;
+        }
+        items[n * WS2812_ITEMS_PER_LED] = 0xDEADBEEF;
+        ws2812_encoder_run(&enc, colors, n, items);
+        encode_ref(colors, n, ref);
+        for (int i = 0; i < n * WS2812_ITEMS_PER_LED; i++) {
+            CHECK(items[i] == ref[i]);
+        }
+        // Nothing written past the last LED
+        CHECK(items[n * WS2812_ITEMS_PER_LED] == 0xDEADBEEF);
+    }
+    // Red is sent after green
+    uint32_t red = 0xFF;
+    ws2812_encoder_run(&enc, &red, 1, items);
+    CHECK(items[7] == BIT0 && items[8] == BIT1 && items[15] == BIT1 && items[16] == BIT0);
+    printf("PASS\n");
+    return 0;
+}
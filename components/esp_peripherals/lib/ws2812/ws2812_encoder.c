@@ -0,0 +1,52 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) PTE LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "ws2812_encoder.h"
+
+void ws2812_encoder_init(ws2812_encoder_t *enc, uint32_t bit0, uint32_t bit1)
+{
+    for (int n = 0; n < 16; n++) {
+        for (int b = 0; b < 4; b++) {
+            enc->nibble[n][b] = (n & (0x08 >> b)) ? bit1 : bit0;
+        }
+    }
+}
+
+static inline uint32_t *ws2812_encode_byte(const ws2812_encoder_t *enc, uint8_t v, uint32_t *items)
+{
+    memcpy(items, enc->nibble[v >> 4], sizeof(enc->nibble[0]));
+    memcpy(items + 4, enc->nibble[v & 0x0F], sizeof(enc->nibble[0]));
+    return items + 8;
+}
+
+void ws2812_encoder_run(const ws2812_encoder_t *enc, const uint32_t *colors, int led_num, uint32_t *items)
+{
+    for (int i = 0; i < led_num; i++) {
+        uint32_t c = colors[i];
+        items = ws2812_encode_byte(enc, (uint8_t)(c >> 8), items);
+        items = ws2812_encode_byte(enc, (uint8_t)c, items);
+        items = ws2812_encode_byte(enc, (uint8_t)(c >> 16), items);
+    }
+}
@@ -0,0 +1,70 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) PTE LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef _WS2812_ENCODER_H_
+#define _WS2812_ENCODER_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WS2812_ITEMS_PER_LED    (24)    /*!< One RMT item per bit of G, R and B */
+
+/**
+ * @brief Nibble lookup table turning colors into RMT items
+ *
+ *        Each nibble maps to its four items, so a color byte costs two 16 bytes copies instead of
+ *        eight bit tests. The table takes 256 bytes and is built once from the two bit waveforms.
+ */
+typedef struct {
+    uint32_t nibble[16][4];
+} ws2812_encoder_t;
+
+/**
+ * @brief      Build the lookup table
+ *
+ * @param      enc   The encoder
+ * @param[in]  bit0  RMT item value of a 0 bit
+ * @param[in]  bit1  RMT item value of a 1 bit
+ */
+void ws2812_encoder_init(ws2812_encoder_t *enc, uint32_t bit0, uint32_t bit1);
+
+/**
+ * @brief      Encode colors in `periph_rgb_value` layout (0x00BBGGRR) to RMT items, most significant bit first
+ *             in the G, R, B order expected on the wire
+ *
+ * @param      enc      The encoder
+ * @param[in]  colors   The colors
+ * @param[in]  led_num  Number of LEDs
+ * @param      items    Output, `led_num * WS2812_ITEMS_PER_LED` items
+ */
+void ws2812_encoder_run(const ws2812_encoder_t *enc, const uint32_t *colors, int led_num, uint32_t *items);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -38,6 +38,7 @@
 #endif
 #include "driver/rmt.h"
 #include "audio_idf_version.h"
+#include "ws2812_encoder.h"
 
 static const char *TAG = "PERIPH_WS2812";
 
@@ -74,12 +75,6 @@ typedef struct {
     bool                     is_set;
 } periph_ws2812_state_t;
 
-typedef struct {
-    uint32_t                 pos;
-    uint32_t                 half;
-    uint8_t                  *buffer;
-} periph_ws2812_process_t;
-
 typedef struct periph_ws2812 {
     periph_rgb_value          *color;
     uint32_t                  led_num;
@@ -87,7 +82,9 @@ typedef struct periph_ws2812 {
     xSemaphoreHandle          sem;
     intr_handle_t             rmt_intr_handle;
     periph_ws2812_state_t     *state;
-    periph_ws2812_process_t   process;
+    rmt_item32_t              *items[2];  /*!< One frame is encoded while the other one transmits */
+    int                       tx_idx;     /*!< The buffer to encode next */
+    ws2812_encoder_t          encoder;
 } periph_ws2812_t;
 
 static esp_err_t ws2812_init_rmt_channel(int rmt_channel, int gpio_num)
@@ -117,36 +114,6 @@ static esp_err_t ws2812_init_rmt_channel(int rmt_channel, int gpio_num)
     return ESP_OK;
 }
 
-static esp_err_t ws2812_data_copy(periph_ws2812_t *ws)
-{
-    unsigned int i, j, len, bit;
-
-    len = ws->led_num * 3;;// - ws->process.pos;
-    rmt_item32_t *rmt_data  = malloc(sizeof(rmt_item32_t) * len * 8);
-
-    for (i = 0; i < len; i++) {
-        bit = ws->process.buffer[i];
-        for (j = 0; j < 8; j++, bit <<= 1) {
-            if ((bit >> 7) & 0x01) {
-                rmt_data[j + i * 8].val = PULSE_BIT1;
-            } else {
-                rmt_data[j + i * 8].val = PULSE_BIT0;
-            }
-        }
-        if (i + ws->process.pos == ws->led_num * 3 - 1) {
-            rmt_data[7 + i * 8].duration1 = PULSE_TRS;
-        }
-    }
-    
-    rmt_write_items(RMTCHANNEL, rmt_data, len * 8, portMAX_DELAY);
-    
-    if (rmt_data) {
-        free(rmt_data);
-        rmt_data = NULL;
-    }
-    return ESP_OK;
-}
-
 static void rmt_handle_tx_end(rmt_channel_t channel, void *arg)
 {
     portBASE_TYPE taskAwoken = 0;
@@ -157,28 +124,22 @@ static void rmt_handle_tx_end(rmt_channel_t channel, void *arg)
 static esp_err_t ws2812_set_colors(periph_ws2812_t *ws)
 {
     AUDIO_NULL_CHECK(TAG, ws, return ESP_FAIL);
-
-    ws->process.buffer = audio_malloc(ws->led_num * 3 * sizeof(uint8_t));
-    AUDIO_NULL_CHECK(TAG, ws->process.buffer, return ESP_FAIL);
-
-    for (int i = 0; i < ws->led_num; i++) {
-        rgb_value rgb = {
-            .num = ws->color[i]
-        };
-        ws->process.buffer[0 + i * 3] = rgb.g;
-        ws->process.buffer[1 + i * 3] = rgb.r;
-        ws->process.buffer[2 + i * 3] = rgb.b;
+    if (ws->led_num == 0) {
+        return ESP_OK;
     }
-    ws->process.pos = 0;
-    ws->process.half = 0;
+    // The other buffer may still be transmitting, `sem` is given back once it's done
+    rmt_item32_t *items = ws->items[ws->tx_idx];
+    ws2812_encoder_run(&ws->encoder, ws->color, ws->led_num, (uint32_t *)items);
+    items[ws->led_num * WS2812_ITEMS_PER_LED - 1].duration1 = PULSE_TRS;
 
-    ws2812_data_copy(ws);
     xSemaphoreTake(ws->sem, portMAX_DELAY);
-    if (ws->process.buffer) {
-        audio_free(ws->process.buffer);
-        ws->process.buffer = NULL;
+    esp_err_t ret = rmt_write_items(RMTCHANNEL, items, ws->led_num * WS2812_ITEMS_PER_LED, false);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Write RMT items failed, ret:%d", ret);
+        xSemaphoreGive(ws->sem);
+        return ESP_FAIL;
     }
-
+    ws->tx_idx ^= 1;
     return ESP_OK;
 }
 
@@ -307,6 +268,8 @@ static esp_err_t _ws2812_destroy(esp_periph_handle_t periph)
             st[i].mode = PERIPH_WS2812_ONE;
         }
         ws2812_set_colors(periph_ws2812);
+        // Wait for the last frame before releasing the channel and its buffers
+        xSemaphoreTake(periph_ws2812->sem, portMAX_DELAY);
 
         if (periph_ws2812->color) {
             audio_free(periph_ws2812->color);
@@ -322,6 +285,8 @@ static esp_err_t _ws2812_destroy(esp_periph_handle_t periph)
         rmt_tx_stop(RMTCHANNEL);
         rmt_driver_uninstall(RMTCHANNEL);
         vSemaphoreDelete(periph_ws2812->sem);
+        audio_free(periph_ws2812->items[0]);
+        audio_free(periph_ws2812->items[1]);
 
         audio_free(periph_ws2812);
         periph_ws2812 = NULL;
@@ -353,6 +318,15 @@ esp_periph_handle_t periph_ws2812_init(periph_ws2812_cfg_t *config)
     periph_ws2812->state = audio_malloc(sizeof(periph_ws2812_state_t) * (periph_ws2812->led_num));
     AUDIO_NULL_CHECK(TAG, periph_ws2812->state, goto ws2812_init_err);
 
+    for (int i = 0; i < 2; i++) {
+        periph_ws2812->items[i] = audio_calloc(periph_ws2812->led_num * WS2812_ITEMS_PER_LED, sizeof(rmt_item32_t));
+        AUDIO_NULL_CHECK(TAG, periph_ws2812->items[i], goto ws2812_init_err);
+    }
+    ws2812_encoder_init(&periph_ws2812->encoder, PULSE_BIT0, PULSE_BIT1);
+    AUDIO_NULL_CHECK(TAG, periph_ws2812->sem, goto ws2812_init_err);
+    // No frame in flight yet
+    xSemaphoreGive(periph_ws2812->sem);
+
     ws2812_init_rmt_channel(RMTCHANNEL, (gpio_num_t)config->gpio_num);
     esp_periph_set_data(periph, periph_ws2812);
     rmt_register_tx_end_callback(rmt_handle_tx_end, (void *)periph_ws2812);
@@ -375,6 +349,8 @@ ws2812_init_err:
         audio_free(periph_ws2812->state);
         periph_ws2812->state = NULL;
     }
+    audio_free(periph_ws2812->items[0]);
+    audio_free(periph_ws2812->items[1]);
     if (periph_ws2812) {
         audio_free(periph_ws2812);
         periph_ws2812 = NULL;
@@ -0,0 +1,137 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2022 <ESPRESSIF SYSTEMS (SHANGHAI) CO., LTD>
+ *
+ * Permission is hereby granted for use on all ESPRESSIF SYSTEMS products, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "unity.h"
+#include "audio_mem.h"
+#include "esp_periph_bringup.h"
+
+static const char *TAG = "BRINGUP_TEST";
+
+typedef struct {
+    int         delay_ms;
+    esp_err_t   ret;
+    int64_t     start_us;
+    int64_t     end_us;
+} bringup_test_step_t;
+
+static esp_err_t bringup_test_func(void *ctx)
+{
+    bringup_test_step_t *t = (bringup_test_step_t *)ctx;
+    t->start_us = esp_timer_get_time();
+    vTaskDelay(t->delay_ms / portTICK_PERIOD_MS);
+    t->end_us = esp_timer_get_time();
+    return t->ret;
+}
+
+static int bringup_test_add(esp_periph_bringup_handle_t h, const char *name, bringup_test_step_t *t, uint32_t deps, int group)
+{
+    esp_periph_bringup_step_t step = {
+        .name = name,
+        .func = bringup_test_func,
+        .ctx = t,
+        .deps = deps,
+        .group = group,
+    };
+    return esp_periph_bringup_add_step(h, &step);
+}
+
+TEST_CASE("bringup runs independent steps concurrently and honours dependencies", "[esp_peripherals]")
+{
+    esp_periph_bringup_cfg_t cfg = DEFAULT_ESP_PERIPH_BRINGUP_CONFIG();
+    esp_periph_bringup_handle_t h = esp_periph_bringup_create(&cfg);
+    TEST_ASSERT_NOT_NULL(h);
+    // Shaped like a player boot: codec and i2s gate the playback, wifi and sdcard come later
+    bringup_test_step_t codec = { 100, ESP_OK }, i2s = { 20, ESP_OK }, periph = { 10, ESP_OK };
+    bringup_test_step_t keys = { 50, ESP_OK }, sdcard = { 300, ESP_OK }, wifi = { 400, ESP_OK };
+    int codec_id = bringup_test_add(h, "codec", &codec, 0, 1);
+    int wifi_id = bringup_test_add(h, "wifi", &wifi, 0, 0);
+    int i2s_id = bringup_test_add(h, "i2s", &i2s, ESP_PERIPH_BRINGUP_STEP(codec_id), 0);
+    int periph_id = bringup_test_add(h, "periph_set", &periph, 0, 0);
+    int keys_id = bringup_test_add(h, "keys", &keys, ESP_PERIPH_BRINGUP_STEP(periph_id), 1);
+    int sd_id = bringup_test_add(h, "sdcard", &sdcard, ESP_PERIPH_BRINGUP_STEP(periph_id), 0);
+    TEST_ASSERT_TRUE(codec_id >= 0 && wifi_id >= 0 && i2s_id >= 0 && periph_id >= 0 && keys_id >= 0 && sd_id >= 0);
+    // Only earlier steps can be named as dependencies
+    TEST_ASSERT_EQUAL(-1, bringup_test_add(h, "bad", &periph, ESP_PERIPH_BRINGUP_STEP(sd_id + 1), 0));
+
+    int64_t t0 = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_periph_bringup_start(h));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_periph_bringup_wait(h, ESP_PERIPH_BRINGUP_STEP(codec_id) | ESP_PERIPH_BRINGUP_STEP(i2s_id), portMAX_DELAY));
+    int64_t audio_ready_us = esp_timer_get_time() - t0;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_periph_bringup_wait_all(h, portMAX_DELAY));
+    int64_t total_us = esp_timer_get_time() - t0;
+    esp_periph_bringup_log_timeline(h);
+    ESP_LOGI(TAG, "audio ready after %d ms, all done after %d ms, %d ms in sequence", (int)(audio_ready_us / 1000),
+             (int)(total_us / 1000), 100 + 20 + 10 + 50 + 300 + 400);
+
+    TEST_ASSERT_TRUE(i2s.start_us >= codec.end_us);
+    TEST_ASSERT_TRUE(keys.start_us >= periph.end_us && sdcard.start_us >= periph.end_us);
+    // Same group, never overlapping
+    TEST_ASSERT_TRUE(keys.start_us >= codec.end_us || codec.start_us >= keys.end_us);
+    TEST_ASSERT_TRUE(audio_ready_us < 250 * 1000);
+    TEST_ASSERT_TRUE(total_us < 600 * 1000);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_periph_bringup_destroy(h));
+}
+
+TEST_CASE("bringup skips the dependents of a failed step", "[esp_peripherals]")
+{
+    esp_periph_bringup_cfg_t cfg = DEFAULT_ESP_PERIPH_BRINGUP_CONFIG();
+    cfg.workers = 1;
+    esp_periph_bringup_handle_t h = esp_periph_bringup_create(&cfg);
+    TEST_ASSERT_NOT_NULL(h);
+    bringup_test_step_t a = { 10, ESP_FAIL }, b = { 10, ESP_OK }, c = { 10, ESP_OK }, d = { 10, ESP_OK };
+    int a_id = bringup_test_add(h, "a", &a, 0, 0);
+    int b_id = bringup_test_add(h, "b", &b, ESP_PERIPH_BRINGUP_STEP(a_id), 0);
+    int c_id = bringup_test_add(h, "c", &c, ESP_PERIPH_BRINGUP_STEP(b_id), 0);
+    int d_id = bringup_test_add(h, "d", &d, 0, 0);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_periph_bringup_start(h));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_periph_bringup_wait(h, ESP_PERIPH_BRINGUP_STEP(d_id), portMAX_DELAY));
+    TEST_ASSERT_EQUAL(ESP_FAIL, esp_periph_bringup_wait(h, ESP_PERIPH_BRINGUP_STEP(c_id), portMAX_DELAY));
+    TEST_ASSERT_EQUAL(ESP_FAIL, esp_periph_bringup_wait_all(h, portMAX_DELAY));
+    TEST_ASSERT_EQUAL(0, b.start_us);
+    TEST_ASSERT_EQUAL(0, c.start_us);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_periph_bringup_wait(h, ESP_PERIPH_BRINGUP_STEP(d_id + 1), 0));
+    esp_periph_bringup_log_timeline(h);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_periph_bringup_destroy(h));
+}
+
+TEST_CASE("bringup create and destroy memory", "[esp_peripherals]")
+{
+    esp_periph_bringup_cfg_t cfg = DEFAULT_ESP_PERIPH_BRINGUP_CONFIG();
+    bringup_test_step_t s = { 0, ESP_OK };
+    AUDIO_MEM_SHOW("BEFORE BRINGUP MEMORY TEST");
+    for (int i = 0; i < 100; i++) {
+        esp_periph_bringup_handle_t h = esp_periph_bringup_create(&cfg);
+        TEST_ASSERT_NOT_NULL(h);
+        TEST_ASSERT_TRUE(bringup_test_add(h, "s", &s, 0, 0) >= 0);
+        TEST_ASSERT_EQUAL(ESP_OK, esp_periph_bringup_start(h));
+        TEST_ASSERT_EQUAL(ESP_OK, esp_periph_bringup_wait_all(h, portMAX_DELAY));
+        TEST_ASSERT_EQUAL(ESP_OK, esp_periph_bringup_destroy(h));
+    }
+    AUDIO_MEM_SHOW("AFTER BRINGUP MEMORY TEST");
+}
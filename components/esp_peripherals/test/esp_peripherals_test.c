@@ -714,3 +714,54 @@ TEST_CASE("[memory leak test] [ws2812]", "[peripherals]")
         periph_ws2812_test();
     }
 }
+
+#define PERIPH_ID_WHEEL_FAST (PERIPH_ID_LCD + 1)
+#define PERIPH_ID_WHEEL_SLOW (PERIPH_ID_LCD + 2)
+
+static void periph_wheel_test_timer(xTimerHandle tmr)
+{
+    esp_periph_handle_t periph = (esp_periph_handle_t)pvTimerGetTimerID(tmr);
+    TEST_ASSERT_NOT_NULL(periph);
+}
+
+static esp_err_t periph_wheel_test_init(esp_periph_handle_t periph)
+{
+    int interval_ms = esp_periph_get_id(periph) == PERIPH_ID_WHEEL_FAST ? 10 : 30;
+    return esp_periph_start_timer(periph, interval_ms / portTICK_PERIOD_MS, periph_wheel_test_timer);
+}
+
+static esp_err_t periph_wheel_test_destroy(esp_periph_handle_t periph)
+{
+    return esp_periph_stop_timer(periph);
+}
+
+TEST_CASE("periph timers share one timer wheel", "[peripherals]")
+{
+    esp_periph_config_t periph_cfg = DEFAULT_ESP_PERIPH_SET_CONFIG();
+    esp_periph_set_handle_t set = esp_periph_set_init(&periph_cfg);
+    TEST_ASSERT_NOT_NULL(set);
+
+    esp_periph_handle_t fast = esp_periph_create(PERIPH_ID_WHEEL_FAST, "wheel_fast");
+    esp_periph_handle_t slow = esp_periph_create(PERIPH_ID_WHEEL_SLOW, "wheel_slow");
+    TEST_ASSERT_NOT_NULL(fast);
+    TEST_ASSERT_NOT_NULL(slow);
+    esp_periph_set_function(fast, periph_wheel_test_init, NULL, periph_wheel_test_destroy);
+    esp_periph_set_function(slow, periph_wheel_test_init, NULL, periph_wheel_test_destroy);
+    TEST_ASSERT_FALSE(esp_periph_start(set, fast));
+    TEST_ASSERT_FALSE(esp_periph_start(set, slow));
+
+    vTaskDelay(600 / portTICK_PERIOD_MS);
+
+    uint32_t fast_wakeups = 0, slow_wakeups = 0, set_wakeups = 0;
+    TEST_ASSERT_FALSE(esp_periph_get_timer_wakeups(fast, &fast_wakeups));
+    TEST_ASSERT_FALSE(esp_periph_get_timer_wakeups(slow, &slow_wakeups));
+    TEST_ASSERT_FALSE(esp_periph_set_get_timer_wakeups(set, &set_wakeups));
+    ESP_LOGI(TAG, "fast:%d, slow:%d, set:%d", fast_wakeups, slow_wakeups, set_wakeups);
+    TEST_ASSERT_TRUE(fast_wakeups > slow_wakeups * 2);
+    TEST_ASSERT_TRUE(slow_wakeups > 0);
+    // Deadlines coincide every 30ms, so the shared timer wakes less than the callbacks fire
+    TEST_ASSERT_TRUE(set_wakeups < fast_wakeups + slow_wakeups);
+
+    TEST_ASSERT_FALSE(esp_periph_set_stop_all(set));
+    TEST_ASSERT_FALSE(esp_periph_set_destroy(set));
+}
@@ -150,6 +150,21 @@ int dram_list_get_url_num(playlist_operator_handle_t handle);
  */
 int dram_list_get_url_id(playlist_operator_handle_t handle);
 
+/**
+ * @brief Get the memory footprint of the dram playlist
+ *
+ * @note The footprint covers the index, the hash table and the string arena.
+ *       Space of removed URLs is reclaimed once it reaches half of the arena, which
+ *       moves the stored strings, so URLs got before a removal must not be kept.
+ *
+ * @param handle        Playlist handle
+ *
+ * @return
+ *     - Bytes of memory used by the dram playlist
+ *     - ESP_FAIL     Fail to get the memory size
+ */
+int dram_list_get_mem_size(playlist_operator_handle_t handle);
+
 /**
  * @brief Show all the URLs in the dram playlist
  *
@@ -23,33 +23,191 @@
  */
 
 #include <string.h>
-#include "sys/queue.h"
 #include "audio_error.h"
 #include "audio_mem.h"
 #include "dram_list.h"
 
 static const char *TAG = "DRAM_LIST";
 
+#define DRAM_LIST_ARENA_BLOCK_SIZE  (1024)
+#define DRAM_LIST_INDEX_INIT_SIZE   (8)
+#define DRAM_LIST_HASH_INIT_SIZE    (16)
+#define DRAM_LIST_HASH_EMPTY        (0)
+#define DRAM_LIST_URL_NUM_MAX       (UINT16_MAX - 1)
+
+/**
+ * @brief One block of the string arena, URLs are packed back to back in `data`
+ */
+typedef struct dram_list_block {
+    struct dram_list_block *next;  /*!< Previously filled block */
+    uint32_t size;                 /*!< Capacity of `data` */
+    uint32_t used;                 /*!< Bytes of `data` in use */
+    char data[0];                  /*!< URL strings */
+} dram_list_block_t;
+
 /**
- * @brief List node save URL
+ * @brief Index entry of a URL, the position in the index array is the url id
  */
 typedef struct url_info {
-    char *url_name;                /*!< URL string */
-    int   url_id;
-    TAILQ_ENTRY(url_info) entries; /*!< list node */
+    char     *url_name;            /*!< URL string, points into the arena */
+    uint32_t  url_hash;            /*!< Hash of the URL string */
 } url_info_t;
 
 /**
  * @brief Dram list management unit
  */
 typedef struct dram_list {
-    uint16_t url_num;                         /*!< Number of URLs in dram playlist */
-    url_info_t *cur_node;                     /*!< Current node of URL on dram list */
-    TAILQ_HEAD(info, url_info) url_info_list; /*!< List of URL nodes */
+    uint16_t           url_num;     /*!< Number of URLs in dram playlist */
+    uint16_t           url_cap;     /*!< Capacity of the index array */
+    int                cur_id;      /*!< Id of the current URL */
+    url_info_t        *url_info;    /*!< Id to URL index array */
+    uint16_t          *hash_slots;  /*!< Open-addressing hash table, stores url id + 1 */
+    uint32_t           hash_size;   /*!< Number of hash slots, power of two */
+    dram_list_block_t *arena;       /*!< Current arena block, older blocks are chained behind */
+    uint32_t           arena_size;  /*!< Total bytes allocated for arena blocks */
+    uint32_t           arena_freed; /*!< Bytes of removed URLs still held by the arena */
 } dram_list_t;
 
 esp_err_t dram_list_get_operation(playlist_operation_t *operation);
 
+static uint32_t dram_list_hash(const char *url)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    while (*url) {
+        hash ^= (uint8_t) * url++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void dram_list_hash_insert(dram_list_t *playlist, int url_id)
+{
+    uint32_t mask = playlist->hash_size - 1;
+    uint32_t idx = playlist->url_info[url_id].url_hash & mask;
+    while (playlist->hash_slots[idx] != DRAM_LIST_HASH_EMPTY) {
+        idx = (idx + 1) & mask;
+    }
+    playlist->hash_slots[idx] = url_id + 1;
+}
+
+static esp_err_t dram_list_hash_rebuild(dram_list_t *playlist, uint32_t hash_size)
+{
+    if (hash_size != playlist->hash_size) {
+        uint16_t *slots = (uint16_t *)audio_calloc(hash_size, sizeof(uint16_t));
+        AUDIO_MEM_CHECK(TAG, slots, return ESP_FAIL);
+        audio_free(playlist->hash_slots);
+        playlist->hash_slots = slots;
+        playlist->hash_size = hash_size;
+    } else {
+        memset(playlist->hash_slots, 0, hash_size * sizeof(uint16_t));
+    }
+    for (int i = 0; i < playlist->url_num; i++) {
+        dram_list_hash_insert(playlist, i);
+    }
+    return ESP_OK;
+}
+
+static int dram_list_hash_find(dram_list_t *playlist, const char *url)
+{
+    if (playlist->url_num == 0) {
+        return -1;
+    }
+    uint32_t hash = dram_list_hash(url);
+    uint32_t mask = playlist->hash_size - 1;
+    uint32_t idx = hash & mask;
+    while (playlist->hash_slots[idx] != DRAM_LIST_HASH_EMPTY) {
+        url_info_t *info = &playlist->url_info[playlist->hash_slots[idx] - 1];
+        if (info->url_hash == hash && strcmp(info->url_name, url) == 0) {
+            return playlist->hash_slots[idx] - 1;
+        }
+        idx = (idx + 1) & mask;
+    }
+    return -1;
+}
+
+static char *dram_list_arena_alloc(dram_list_t *playlist, size_t size)
+{
+    dram_list_block_t *block = playlist->arena;
+    if (block == NULL || block->size - block->used < size) {
+        uint32_t block_size = size > DRAM_LIST_ARENA_BLOCK_SIZE ? size : DRAM_LIST_ARENA_BLOCK_SIZE;
+        block = (dram_list_block_t *)audio_malloc(sizeof(dram_list_block_t) + block_size);
+        AUDIO_MEM_CHECK(TAG, block, return NULL);
+        block->size = block_size;
+        block->used = 0;
+        block->next = playlist->arena;
+        playlist->arena = block;
+        playlist->arena_size += sizeof(dram_list_block_t) + block_size;
+    }
+    char *p = block->data + block->used;
+    block->used += size;
+    return p;
+}
+
+static void dram_list_arena_release(dram_list_t *playlist)
+{
+    dram_list_block_t *block = playlist->arena;
+    while (block) {
+        dram_list_block_t *next = block->next;
+        audio_free(block);
+        block = next;
+    }
+    playlist->arena = NULL;
+    playlist->arena_size = 0;
+    playlist->arena_freed = 0;
+}
+
+static void dram_list_arena_compact(dram_list_t *playlist)
+{
+    uint32_t live = 0;
+    for (int i = 0; i < playlist->url_num; i++) {
+        live += strlen(playlist->url_info[i].url_name) + 1;
+    }
+    uint32_t block_size = live > DRAM_LIST_ARENA_BLOCK_SIZE ? live : DRAM_LIST_ARENA_BLOCK_SIZE;
+    dram_list_block_t *block = (dram_list_block_t *)audio_malloc(sizeof(dram_list_block_t) + block_size);
+    if (block == NULL) {
+        // Keep the old blocks, the next removal tries again
+        ESP_LOGW(TAG, "No memory to compact the arena, %d bytes freed", (int)playlist->arena_freed);
+        return;
+    }
+    block->size = block_size;
+    block->used = 0;
+    block->next = NULL;
+    for (int i = 0; i < playlist->url_num; i++) {
+        size_t len = strlen(playlist->url_info[i].url_name) + 1;
+        memcpy(block->data + block->used, playlist->url_info[i].url_name, len);
+        playlist->url_info[i].url_name = block->data + block->used;
+        block->used += len;
+    }
+    dram_list_arena_release(playlist);
+    playlist->arena = block;
+    playlist->arena_size = sizeof(dram_list_block_t) + block_size;
+}
+
+static esp_err_t dram_list_remove_id(dram_list_t *playlist, int url_id)
+{
+    playlist->arena_freed += strlen(playlist->url_info[url_id].url_name) + 1;
+    memmove(&playlist->url_info[url_id], &playlist->url_info[url_id + 1],
+            (playlist->url_num - url_id - 1) * sizeof(url_info_t));
+    playlist->url_num--;
+
+    if (playlist->cur_id > url_id) {
+        playlist->cur_id--;
+    }
+    if (playlist->cur_id >= playlist->url_num) {
+        playlist->cur_id = 0;
+    }
+    if (playlist->url_num == 0) {
+        // Nothing references the arena any more, give it back
+        dram_list_arena_release(playlist);
+    } else if (playlist->arena_freed >= DRAM_LIST_ARENA_BLOCK_SIZE && playlist->arena_freed * 2 >= playlist->arena_size) {
+        // Half of the arena is dead, pack the live URLs into one block
+        dram_list_arena_compact(playlist);
+    }
+    // The ids behind the removed one have shifted, reindex them
+    return dram_list_hash_rebuild(playlist, playlist->hash_size);
+}
+
 esp_err_t dram_list_create(playlist_operator_handle_t *handle)
 {
     AUDIO_NULL_CHECK(TAG, handle, return ESP_FAIL);
@@ -61,11 +219,20 @@ esp_err_t dram_list_create(playlist_operator_handle_t *handle)
         audio_free(dram_handle);
         return ESP_FAIL;
     });
+    dram_list->url_info = (url_info_t *) audio_calloc(DRAM_LIST_INDEX_INIT_SIZE, sizeof(url_info_t));
+    dram_list->hash_slots = (uint16_t *) audio_calloc(DRAM_LIST_HASH_INIT_SIZE, sizeof(uint16_t));
+    AUDIO_NULL_CHECK(TAG, dram_list->url_info && dram_list->hash_slots, {
+        audio_free(dram_list->url_info);
+        audio_free(dram_list->hash_slots);
+        audio_free(dram_list);
+        audio_free(dram_handle);
+        return ESP_FAIL;
+    });
+    dram_list->url_cap = DRAM_LIST_INDEX_INIT_SIZE;
+    dram_list->hash_size = DRAM_LIST_HASH_INIT_SIZE;
 
     dram_handle->playlist = dram_list;
     dram_handle->get_operation = dram_list_get_operation;
-
-    TAILQ_INIT(&dram_list->url_info_list);
     *handle = dram_handle;
     return ESP_OK;
 }
@@ -78,26 +245,37 @@ esp_err_t dram_list_save(playlist_operator_handle_t handle, const char *url)
     dram_list_t *playlist = handle->playlist;
     AUDIO_NULL_CHECK(TAG, playlist, return ESP_FAIL);
 
-    url_info_t *list_node = (url_info_t *)audio_calloc(1, sizeof(url_info_t));
-    AUDIO_NULL_CHECK(TAG, list_node, return ESP_FAIL);
-    list_node->url_name = (char *)audio_calloc(1, url_len + 1);
-    list_node->url_id = playlist->url_num;
-    AUDIO_NULL_CHECK(TAG, list_node->url_name, {
-        audio_free(list_node);
-        list_node = NULL;
+    if (playlist->url_num >= DRAM_LIST_URL_NUM_MAX) {
+        ESP_LOGE(TAG, "The dram playlist is full");
         return ESP_FAIL;
-    });
-#if defined(__GNUC__) && (__GNUC__ >= 6)
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wstringop-truncation"
-    strncpy(list_node->url_name, url, url_len); // causes compilation warning although the extra byte is accounted for in the calloc
-#pragma GCC diagnostic pop
-#endif
-    TAILQ_INSERT_TAIL(&playlist->url_info_list, list_node, entries);
-
-    if (NULL == playlist->cur_node) {
+    }
+    if (playlist->url_num == playlist->url_cap) {
+        uint32_t cap = (uint32_t)playlist->url_cap * 2;
+        if (cap > DRAM_LIST_URL_NUM_MAX) {
+            cap = DRAM_LIST_URL_NUM_MAX;
+        }
+        url_info_t *info = (url_info_t *)audio_realloc(playlist->url_info, cap * sizeof(url_info_t));
+        AUDIO_MEM_CHECK(TAG, info, return ESP_FAIL);
+        playlist->url_info = info;
+        playlist->url_cap = cap;
+    }
+    // Keep the load factor of hash table below 3/4
+    if ((playlist->url_num + 1) * 4 > playlist->hash_size * 3) {
+        if (dram_list_hash_rebuild(playlist, playlist->hash_size * 2) != ESP_OK) {
+            return ESP_FAIL;
+        }
+    }
+    char *url_name = dram_list_arena_alloc(playlist, url_len + 1);
+    AUDIO_NULL_CHECK(TAG, url_name, return ESP_FAIL);
+    memcpy(url_name, url, url_len + 1);
+
+    int url_id = playlist->url_num;
+    playlist->url_info[url_id].url_name = url_name;
+    playlist->url_info[url_id].url_hash = dram_list_hash(url_name);
+    dram_list_hash_insert(playlist, url_id);
+    if (playlist->url_num == 0) {
         ESP_LOGD(TAG, "Set the first url as the default url");
-        playlist->cur_node = list_node;
+        playlist->cur_id = 0;
     }
     playlist->url_num ++;
     return ESP_OK;
@@ -119,16 +297,8 @@ esp_err_t dram_list_next(playlist_operator_handle_t handle, int step, char **url
         return ESP_FAIL;
     }
 
-    url_info_t *tmp = playlist->cur_node;
-    for (int i = 0; i < step; i++) {
-        tmp = TAILQ_NEXT(playlist->cur_node, entries);
-        if (tmp == NULL) {
-            ESP_LOGD(TAG, "Already the last url of the playlist");
-            tmp = TAILQ_FIRST(&playlist->url_info_list);
-        }
-        playlist->cur_node = tmp;
-    }
-    *url_buff = tmp->url_name;
+    playlist->cur_id = (playlist->cur_id + step % playlist->url_num) % playlist->url_num;
+    *url_buff = playlist->url_info[playlist->cur_id].url_name;
 
     return ESP_OK;
 }
@@ -149,16 +319,8 @@ esp_err_t dram_list_prev(playlist_operator_handle_t handle, int step, char **url
         return ESP_FAIL;
     }
 
-    url_info_t *tmp = playlist->cur_node;
-    for (int i = 0; i < step; i++) {
-        tmp = TAILQ_PREV(playlist->cur_node, info, entries);
-        if (tmp == NULL) {
-            ESP_LOGD(TAG, "Already the first url of the playlist");
-            tmp = TAILQ_LAST(&playlist->url_info_list, info);
-        }
-        playlist->cur_node = tmp;
-    }
-    *url_buff = tmp->url_name;
+    playlist->cur_id = (playlist->cur_id + playlist->url_num - step % playlist->url_num) % playlist->url_num;
+    *url_buff = playlist->url_info[playlist->cur_id].url_name;
 
     return ESP_OK;
 }
@@ -175,8 +337,7 @@ esp_err_t dram_list_current(playlist_operator_handle_t handle, char **url_buff)
         return ESP_FAIL;
     }
 
-    url_info_t *cur_node = playlist->cur_node;
-    *url_buff = cur_node->url_name;
+    *url_buff = playlist->url_info[playlist->cur_id].url_name;
     return ESP_OK;
 }
 
@@ -195,9 +356,9 @@ esp_err_t dram_list_choose(playlist_operator_handle_t handle, int url_id, char *
         ESP_LOGE(TAG, "Invalid url id to be choosen");
         return ESP_FAIL;
     }
-    // rewind pointer
-    playlist->cur_node = TAILQ_FIRST(&playlist->url_info_list);
-    return dram_list_next(handle, url_id, url_buff);
+    playlist->cur_id = url_id;
+    *url_buff = playlist->url_info[url_id].url_name;
+    return ESP_OK;
 }
 
 esp_err_t dram_list_show(playlist_operator_handle_t handle)
@@ -206,29 +367,22 @@ esp_err_t dram_list_show(playlist_operator_handle_t handle)
     dram_list_t *playlist = handle->playlist;
     AUDIO_NULL_CHECK(TAG, playlist, return ESP_FAIL);
 
-    url_info_t *item, *tmp;
-    TAILQ_FOREACH_SAFE(item, &playlist->url_info_list, entries, tmp) {
-        ESP_LOGI(TAG, "URL: %s", item->url_name);
+    for (int i = 0; i < playlist->url_num; i++) {
+        ESP_LOGI(TAG, "URL: %s", playlist->url_info[i].url_name);
     }
+    ESP_LOGI(TAG, "URLs: %d, memory: %d bytes (arena: %d, freed: %d)", playlist->url_num,
+             dram_list_get_mem_size(handle), (int)playlist->arena_size, (int)playlist->arena_freed);
     return ESP_OK;
 }
 
 bool dram_list_exist(playlist_operator_handle_t handle, const char *url)
 {
     AUDIO_NULL_CHECK(TAG, handle, return ESP_FAIL);
+    AUDIO_NULL_CHECK(TAG, url, return false);
     dram_list_t *playlist = handle->playlist;
     AUDIO_NULL_CHECK(TAG, playlist, return ESP_FAIL);
 
-    url_info_t *item, *tmp;
-    TAILQ_FOREACH_SAFE(item, &playlist->url_info_list, entries, tmp) {
-        if (strlen(url) != strlen(item->url_name)) {
-            continue;
-        }
-        if (strcmp(item->url_name, url) == 0) {
-            return true;
-        }
-    }
-    return false;
+    return dram_list_hash_find(playlist, url) >= 0;
 }
 
 esp_err_t dram_list_reset(playlist_operator_handle_t handle)
@@ -237,15 +391,10 @@ esp_err_t dram_list_reset(playlist_operator_handle_t handle)
     dram_list_t *playlist = handle->playlist;
     AUDIO_NULL_CHECK(TAG, playlist, return ESP_FAIL);
 
-    url_info_t *item, *tmp;
-    TAILQ_FOREACH_SAFE(item, &playlist->url_info_list, entries, tmp) {
-        audio_free(item->url_name);
-        item->url_name = NULL;
-        TAILQ_REMOVE(&playlist->url_info_list, item, entries);
-        audio_free(item);
-        item = NULL;
-    }
+    dram_list_arena_release(playlist);
+    memset(playlist->hash_slots, 0, playlist->hash_size * sizeof(uint16_t));
     playlist->url_num = 0;
+    playlist->cur_id = 0;
     return ESP_OK;
 }
 
@@ -269,35 +418,36 @@ int dram_list_get_url_id(playlist_operator_handle_t handle)
         return ESP_FAIL;
     }
 
-    url_info_t *cur_node = playlist->cur_node;
-    return cur_node->url_id;
+    return playlist->cur_id;
+}
+
+int dram_list_get_mem_size(playlist_operator_handle_t handle)
+{
+    AUDIO_NULL_CHECK(TAG, handle, return ESP_FAIL);
+    dram_list_t *playlist = handle->playlist;
+    AUDIO_NULL_CHECK(TAG, playlist, return ESP_FAIL);
+
+    return sizeof(playlist_operator_t) + sizeof(dram_list_t)
+           + playlist->url_cap * sizeof(url_info_t)
+           + playlist->hash_size * sizeof(uint16_t)
+           + playlist->arena_size;
 }
 
 esp_err_t dram_list_remove_by_url(playlist_operator_handle_t handle, const char *url)
 {
     AUDIO_NULL_CHECK(TAG, handle, return ESP_FAIL);
+    AUDIO_NULL_CHECK(TAG, url, return ESP_FAIL);
     dram_list_t *playlist = handle->playlist;
     AUDIO_NULL_CHECK(TAG, playlist, return ESP_FAIL);
     bool _find_flag = false;
 
-    url_info_t *item, *tmp;
-    TAILQ_FOREACH_SAFE(item, &playlist->url_info_list, entries, tmp) {
-        if (strlen(url) != strlen(item->url_name)) {
-            continue;
-        }
-        if (strcmp(url, item->url_name) == 0) {
-            audio_free(item->url_name);
-            item->url_name = NULL;
-            TAILQ_REMOVE(&playlist->url_info_list, item, entries);
-            audio_free(item);
-            item = NULL;
-            playlist->url_num--;
-            _find_flag = true;
-            continue;
-        }
-        if (_find_flag) {
-            item->url_id--;
+    int url_id;
+    // The same url may be saved more than once, remove all of them
+    while ((url_id = dram_list_hash_find(playlist, url)) >= 0) {
+        if (dram_list_remove_id(playlist, url_id) != ESP_OK) {
+            return ESP_FAIL;
         }
+        _find_flag = true;
     }
     if (_find_flag) {
         return ESP_OK;
@@ -312,30 +462,12 @@ esp_err_t dram_list_remove_by_url_id(playlist_operator_handle_t handle, uint16_t
     AUDIO_NULL_CHECK(TAG, handle, return ESP_FAIL);
     dram_list_t *playlist = handle->playlist;
     AUDIO_NULL_CHECK(TAG, playlist, return ESP_FAIL);
-    bool _find_flag = false;
 
-    url_info_t *item, *tmp;
-    TAILQ_FOREACH_SAFE(item, &playlist->url_info_list, entries, tmp) {
-        if (item->url_id == url_id) {
-            audio_free(item->url_name);
-            item->url_name = NULL;
-            TAILQ_REMOVE(&playlist->url_info_list, item, entries);
-            audio_free(item);
-            item = NULL;
-            playlist->url_num--;
-            _find_flag = true;
-            continue;
-        }
-        if (_find_flag) {
-            item->url_id--;
-        }
-    }
-    if (_find_flag) {
-        return ESP_OK;
-    } else {
+    if (url_id >= playlist->url_num) {
         ESP_LOGE(TAG, "Cannot find the url id, fail to remove");
         return ESP_ERR_NOT_FOUND;
     }
+    return dram_list_remove_id(playlist, url_id);
 }
 
 esp_err_t dram_list_destroy(playlist_operator_handle_t handle)
@@ -344,14 +476,9 @@ esp_err_t dram_list_destroy(playlist_operator_handle_t handle)
     dram_list_t *playlist = handle->playlist;
     AUDIO_NULL_CHECK(TAG, playlist, return ESP_FAIL);
 
-    url_info_t *item, *tmp;
-    TAILQ_FOREACH_SAFE(item, &playlist->url_info_list, entries, tmp) {
-        audio_free(item->url_name);
-        item->url_name = NULL;
-        TAILQ_REMOVE(&playlist->url_info_list, item, entries);
-        audio_free(item);
-        item = NULL;
-    }
+    dram_list_arena_release(playlist);
+    audio_free(playlist->url_info);
+    audio_free(playlist->hash_slots);
     audio_free(playlist);
     handle->playlist = NULL;
     audio_free(handle);
@@ -492,6 +492,74 @@ TEST_CASE("Create playlists and use them without playlist manager handle", "[pla
 }
 
 
+TEST_CASE("Create a dram playlist, look up and remove urls by hash", "[playlist]")
+{
+    playlist_operator_handle_t dram_handle = NULL;
+    TEST_ASSERT_FALSE(dram_list_create(&dram_handle));
+
+    char url_buf[64];
+    char *url = NULL;
+    for (int i = 0; i < 500; i++) {
+        snprintf(url_buf, sizeof(url_buf), "http://dram.playlist/test/url_%d.mp3", i);
+        TEST_ASSERT_FALSE(dram_list_save(dram_handle, url_buf));
+    }
+    TEST_ASSERT_EQUAL_INT(500, dram_list_get_url_num(dram_handle));
+    ESP_LOGI(TAG, "dram playlist with %d urls uses %d bytes", dram_list_get_url_num(dram_handle), dram_list_get_mem_size(dram_handle));
+
+    TEST_ASSERT_TRUE(dram_list_exist(dram_handle, "http://dram.playlist/test/url_499.mp3"));
+    TEST_ASSERT_FALSE(dram_list_exist(dram_handle, "http://dram.playlist/test/url_500.mp3"));
+
+    TEST_ASSERT_FALSE(dram_list_choose(dram_handle, 250, &url));
+    TEST_ASSERT_EQUAL_STRING("http://dram.playlist/test/url_250.mp3", url);
+    TEST_ASSERT_FALSE(dram_list_next(dram_handle, 251, &url));
+    TEST_ASSERT_EQUAL_STRING("http://dram.playlist/test/url_1.mp3", url);
+    TEST_ASSERT_FALSE(dram_list_prev(dram_handle, 2, &url));
+    TEST_ASSERT_EQUAL_STRING("http://dram.playlist/test/url_499.mp3", url);
+
+    TEST_ASSERT_FALSE(dram_list_remove_by_url(dram_handle, "http://dram.playlist/test/url_0.mp3"));
+    TEST_ASSERT_EQUAL_INT(498, dram_list_get_url_id(dram_handle));
+    TEST_ASSERT_FALSE(dram_list_remove_by_url_id(dram_handle, 0));
+    TEST_ASSERT_FALSE(dram_list_exist(dram_handle, "http://dram.playlist/test/url_1.mp3"));
+    TEST_ASSERT_FALSE(dram_list_choose(dram_handle, 0, &url));
+    TEST_ASSERT_EQUAL_STRING("http://dram.playlist/test/url_2.mp3", url);
+    TEST_ASSERT_EQUAL_INT(ESP_ERR_NOT_FOUND, dram_list_remove_by_url(dram_handle, "http://dram.playlist/test/url_1.mp3"));
+
+    TEST_ASSERT_FALSE(dram_list_reset(dram_handle));
+    TEST_ASSERT_EQUAL_INT(0, dram_list_get_url_num(dram_handle));
+    TEST_ASSERT_FALSE(dram_list_exist(dram_handle, "http://dram.playlist/test/url_2.mp3"));
+    TEST_ASSERT_FALSE(dram_list_destroy(dram_handle));
+}
+
+TEST_CASE("Keep a dram playlist bounded while urls are added and removed", "[playlist]")
+{
+    playlist_operator_handle_t dram_handle = NULL;
+    TEST_ASSERT_FALSE(dram_list_create(&dram_handle));
+
+    char url_buf[64];
+    char *url = NULL;
+    for (int i = 0; i < 50; i++) {
+        snprintf(url_buf, sizeof(url_buf), "http://dram.playlist/test/url_%d.mp3", i);
+        TEST_ASSERT_FALSE(dram_list_save(dram_handle, url_buf));
+    }
+    int mem_size = dram_list_get_mem_size(dram_handle);
+
+    // Rotate the oldest url out and a new one in, the live set stays at 50 urls
+    for (int i = 50; i < 5000; i++) {
+        TEST_ASSERT_FALSE(dram_list_remove_by_url_id(dram_handle, 0));
+        snprintf(url_buf, sizeof(url_buf), "http://dram.playlist/test/url_%d.mp3", i);
+        TEST_ASSERT_FALSE(dram_list_save(dram_handle, url_buf));
+    }
+    ESP_LOGI(TAG, "dram playlist uses %d bytes after churn, %d at start", dram_list_get_mem_size(dram_handle), mem_size);
+    TEST_ASSERT_EQUAL_INT(50, dram_list_get_url_num(dram_handle));
+    TEST_ASSERT_LESS_THAN(mem_size * 4, dram_list_get_mem_size(dram_handle));
+
+    TEST_ASSERT_FALSE(dram_list_choose(dram_handle, 0, &url));
+    TEST_ASSERT_EQUAL_STRING("http://dram.playlist/test/url_4950.mp3", url);
+    TEST_ASSERT_TRUE(dram_list_exist(dram_handle, "http://dram.playlist/test/url_4999.mp3"));
+    TEST_ASSERT_FALSE(dram_list_exist(dram_handle, "http://dram.playlist/test/url_4949.mp3"));
+    TEST_ASSERT_FALSE(dram_list_destroy(dram_handle));
+}
+
 static void scan_sdcard_cb(void *user_data, char *url)
 {
     playlist_handle_t handle = (playlist_handle_t)user_data;
@@ -22,25 +22,40 @@
  *
  */
 #include <string.h>
+#include <stddef.h>
 
 #include "audio_error.h"
 #include "audio_mem.h"
+#include "audio_idf_version.h"
 
 #include "esp_delegate.h"
 #include "esp_log.h"
 #include "esp_partition.h"
+#if (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 3, 0))
+#include "esp_rom_crc.h"
+#else
+#include "rom/crc.h"
+#define esp_rom_crc32_le crc32_le
+#endif
 
 #include "partition_action.h"
 #include "tone_partition.h"
 
 #define FLASH_TONE_FILE_TAG        (0x28)
 #define FLASH_TONE_FILE_INFO_BLOCK (64)
+#define FLASH_TONE_CACHE_SIZE      (4096)
 
 typedef struct tone_partition_s {
     const esp_partition_t *partition;
     flash_tone_header_t header;
     const esp_partition_t *(*find)(esp_partition_type_t, esp_partition_subtype_t, const char *);
     esp_err_t (*read)(const esp_partition_t *, size_t, void *, size_t);
+    tone_file_info_t *file_table;       /*!< File table loaded once at init */
+    const uint8_t *mmap_data;           /*!< Whole partition mapped into data address space, NULL if not mapped */
+    spi_flash_mmap_handle_t mmap_handle;
+    uint8_t *cache;                     /*!< Read cache used when the partition is not mapped */
+    uint32_t cache_addr;                /*!< Partition offset of the cached block */
+    uint32_t cache_len;                 /*!< Valid bytes in cache */
 } tone_partition_t;
 
 static const char *TAG = "TONE_PARTITION";
@@ -86,34 +101,105 @@ static esp_err_t partition_read_with_dispatcher(const esp_partition_t *partition
     return result.err;
 }
 
-esp_err_t tone_partition_get_file_info(tone_partition_handle_t handle, uint16_t index, tone_file_info_t *info)
+static int tone_partition_file_table_addr(tone_partition_handle_t handle)
 {
-    AUDIO_NULL_CHECK(TAG, handle, return ESP_FAIL);
-    AUDIO_NULL_CHECK(TAG, info, return ESP_FAIL);
-
-    if (handle->header.total_num < index) {
-        ESP_LOGE(TAG, "Wanted index out of range index[%d]", index);
-        return ESP_FAIL;
-    }
-    tone_file_info_t info_tmp = { 0 };
-    int start_adr = 0;
     if (handle->header.format == TONE_VERSION_0) {
-        start_adr = sizeof(flash_tone_header_t) + FLASH_TONE_FILE_INFO_BLOCK * index;
+        return sizeof(flash_tone_header_t);
     } else if (handle->header.format == TONE_VERSION_1) {
-        start_adr = sizeof(flash_tone_header_t) + sizeof(esp_app_desc_t) + FLASH_TONE_FILE_INFO_BLOCK * index;
-    } else {
+        return sizeof(flash_tone_header_t) + sizeof(esp_app_desc_t);
+    }
+    return -1;
+}
+
+static esp_err_t tone_partition_load_file_table(tone_partition_handle_t handle)
+{
+    int table_addr = tone_partition_file_table_addr(handle);
+    if (table_addr < 0) {
         ESP_LOGE(TAG, "Tone format not support!");
         return ESP_FAIL;
     }
-    if (ESP_OK == handle->read(handle->partition, start_adr, &info_tmp, sizeof(info_tmp))) {
-        //TODO check crc
-        if (info_tmp.file_tag == FLASH_TONE_FILE_TAG) {
-            memcpy(info, &info_tmp, sizeof(info_tmp));
+    int table_len = FLASH_TONE_FILE_INFO_BLOCK * handle->header.total_num;
+    if (handle->header.total_num == 0 || table_addr + table_len > handle->partition->size) {
+        ESP_LOGE(TAG, "Invalid tone file number %d", handle->header.total_num);
+        return ESP_FAIL;
+    }
+    handle->file_table = audio_malloc(table_len);
+    AUDIO_MEM_CHECK(TAG, handle->file_table, return ESP_FAIL);
+    if (handle->mmap_data) {
+        memcpy(handle->file_table, handle->mmap_data + table_addr, table_len);
+    } else if (ESP_OK != handle->read(handle->partition, table_addr, handle->file_table, table_len)) {
+        ESP_LOGE(TAG, "Read tone file table failed");
+        return ESP_FAIL;
+    }
+    for (int i = 0; i < handle->header.total_num; i++) {
+        tone_file_info_t *info = &handle->file_table[i];
+        if (info->file_tag != FLASH_TONE_FILE_TAG) {
+            ESP_LOGE(TAG, "Get tone file tag error %x, index %d", info->file_tag, i);
+            return ESP_FAIL;
         }
-    } else {
-        ESP_LOGE(TAG, "Get tone file tag error %x", info_tmp.file_tag);
+        // Images packed by old tools leave the crc as 0
+        if (info->info_crc != 0
+            && info->info_crc != esp_rom_crc32_le(0, (const uint8_t *)info, offsetof(tone_file_info_t, info_crc))) {
+            ESP_LOGE(TAG, "Tone file info crc error, index %d", i);
+            return ESP_FAIL;
+        }
+        if (info->song_adr < table_addr + table_len
+            || info->song_adr + info->song_len > handle->partition->size) {
+            ESP_LOGE(TAG, "Tone file out of partition, index %d, addr %x, len %d", i, info->song_adr, info->song_len);
+            return ESP_FAIL;
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t tone_partition_cached_read(tone_partition_handle_t handle, uint32_t addr, char *dst, int len)
+{
+    while (len > 0) {
+        if (addr >= handle->cache_addr && addr < handle->cache_addr + handle->cache_len) {
+            int copy = handle->cache_addr + handle->cache_len - addr;
+            copy = copy > len ? len : copy;
+            memcpy(dst, handle->cache + (addr - handle->cache_addr), copy);
+            addr += copy;
+            dst += copy;
+            len -= copy;
+            continue;
+        }
+        if (len >= FLASH_TONE_CACHE_SIZE) {
+            // Large request, read the aligned middle part straight into the destination
+            int direct = len & ~(FLASH_TONE_CACHE_SIZE - 1);
+            esp_err_t err = handle->read(handle->partition, addr, dst, direct);
+            if (err != ESP_OK) {
+                return err;
+            }
+            addr += direct;
+            dst += direct;
+            len -= direct;
+            continue;
+        }
+        uint32_t block = addr & ~(FLASH_TONE_CACHE_SIZE - 1);
+        uint32_t block_len = handle->partition->size - block;
+        block_len = block_len > FLASH_TONE_CACHE_SIZE ? FLASH_TONE_CACHE_SIZE : block_len;
+        handle->cache_len = 0;
+        esp_err_t err = handle->read(handle->partition, block, handle->cache, block_len);
+        if (err != ESP_OK) {
+            return err;
+        }
+        handle->cache_addr = block;
+        handle->cache_len = block_len;
+    }
+    return ESP_OK;
+}
+
+esp_err_t tone_partition_get_file_info(tone_partition_handle_t handle, uint16_t index, tone_file_info_t *info)
+{
+    AUDIO_NULL_CHECK(TAG, handle, return ESP_FAIL);
+    AUDIO_NULL_CHECK(TAG, info, return ESP_FAIL);
+
+    if (index >= handle->header.total_num) {
+        ESP_LOGE(TAG, "Wanted index out of range index[%d]", index);
         return ESP_FAIL;
     }
+    memcpy(info, &handle->file_table[index], sizeof(tone_file_info_t));
     return ESP_OK;
 }
 
@@ -122,7 +208,18 @@ esp_err_t tone_partition_file_read(tone_partition_handle_t handle, tone_file_inf
     AUDIO_NULL_CHECK(TAG, handle, return ESP_FAIL);
     AUDIO_NULL_CHECK(TAG, file, return ESP_FAIL);
 
-    esp_err_t err = handle->read(handle->partition, file->song_adr + offset, dst, read_len);
+    if (read_len <= 0) {
+        return ESP_OK;
+    }
+    if (file->song_adr + offset + read_len > handle->partition->size) {
+        ESP_LOGE(TAG, "Tone file read out of partition");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (handle->mmap_data) {
+        memcpy(dst, handle->mmap_data + file->song_adr + offset, read_len);
+        return ESP_OK;
+    }
+    esp_err_t err = tone_partition_cached_read(handle, file->song_adr + offset, dst, read_len);
     if (ESP_OK != err) {
         ESP_LOGE(TAG, "Tone file read error[0x%x]", err);
     }
@@ -134,10 +231,16 @@ static esp_err_t tone_partition_get_tail(tone_partition_handle_t handle, uint16_
     AUDIO_NULL_CHECK(TAG, handle, return ESP_FAIL);
 
     if (handle->header.format == TONE_VERSION_1) {
-        tone_file_info_t last_file = { 0 };
-        tone_partition_get_file_info(handle, handle->header.total_num - 1, &last_file);
-        int tail_addr = last_file.song_adr + last_file.song_len + ((4 - last_file.song_len % 4) % 4) + 4;
-        ESP_LOGD(TAG, "addr %X, len %X, tail %X", last_file.song_adr, last_file.song_len, tail_addr);
+        tone_file_info_t *last_file = &handle->file_table[handle->header.total_num - 1];
+        int tail_addr = last_file->song_adr + last_file->song_len + ((4 - last_file->song_len % 4) % 4) + 4;
+        ESP_LOGD(TAG, "addr %X, len %X, tail %X", last_file->song_adr, last_file->song_len, tail_addr);
+        if (tail_addr + sizeof(uint16_t) > handle->partition->size) {
+            return ESP_FAIL;
+        }
+        if (handle->mmap_data) {
+            memcpy(tail, handle->mmap_data + tail_addr, sizeof(uint16_t));
+            return ESP_OK;
+        }
         return handle->read(handle->partition, tail_addr, tail, sizeof(uint16_t));
     } else {
         *tail = 0;
@@ -182,6 +285,21 @@ tone_partition_handle_t tone_partition_init(const char *partition_label, bool us
         ESP_LOGE(TAG, "Not flash tone partition");
         goto error;
     }
+    if (use_delegate == false) {
+        // Mapping needs the cache to be reconfigured, which is not allowed from tasks with stack in external ram
+        if (ESP_OK != esp_partition_mmap(tone->partition, 0, tone->partition->size, SPI_FLASH_MMAP_DATA,
+                                         (const void **)&tone->mmap_data, &tone->mmap_handle)) {
+            ESP_LOGW(TAG, "Map tone partition failed, read through cache instead");
+            tone->mmap_data = NULL;
+        }
+    }
+    if (tone->mmap_data == NULL) {
+        tone->cache = audio_malloc(FLASH_TONE_CACHE_SIZE);
+        AUDIO_MEM_CHECK(TAG, tone->cache, goto error);
+    }
+    if (ESP_OK != tone_partition_load_file_table(tone)) {
+        goto error;
+    }
     if (tone->header.format == TONE_VERSION_1) {
         uint16_t tail = 0;
         if (ESP_OK != tone_partition_get_tail(tone, &tail) || tail != FLASH_TONE_TAIL) {
@@ -193,15 +311,18 @@ tone_partition_handle_t tone_partition_init(const char *partition_label, bool us
     return (tone_partition_handle_t)tone;
 
 error:
-    if (tone) {
-        free(tone);
-    }
+    tone_partition_deinit(tone);
     return NULL;
 }
 
 esp_err_t tone_partition_deinit(tone_partition_handle_t handle)
 {
     AUDIO_NULL_CHECK(TAG, handle, return ESP_FAIL);
-    free(handle);
+    if (handle->mmap_data) {
+        spi_flash_munmap(handle->mmap_handle);
+    }
+    audio_free(handle->file_table);
+    audio_free(handle->cache);
+    audio_free(handle);
     return ESP_OK;
 }
@@ -274,7 +274,7 @@ static esp_audio_handle_t setup_player()
     audio_element_handle_t bt_stream_reader = a2dp_stream_init(&a2dp_config);
     esp_audio_input_stream_add(player, bt_stream_reader);
     
-    hfp_stream_config_t hfp_config;
+    hfp_stream_config_t hfp_config = HFP_STREAM_CFG_DEFAULT();
     hfp_config.type = INCOMING_STREAM;
     audio_element_handle_t hfp_in_stream = hfp_stream_init(&hfp_config);
     esp_audio_input_stream_add(player, hfp_in_stream);
@@ -402,7 +402,7 @@ void app_main(void)
     audio_element_handle_t filter = rsp_filter_init(&rsp_cfg);
 
     ESP_LOGI(TAG, "[5.2] Create hfp stream");
-    hfp_stream_config_t hfp_config;
+    hfp_stream_config_t hfp_config = HFP_STREAM_CFG_DEFAULT();
     hfp_config.type = OUTGOING_STREAM;
     audio_element_handle_t hfp_out_stream = hfp_stream_init(&hfp_config);
     
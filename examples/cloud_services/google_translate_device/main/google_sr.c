@@ -195,7 +195,15 @@ static esp_err_t _http_stream_writer_event_handle(http_stream_event_msg_t *msg)
         if (sr->response_text) {
             free(sr->response_text);
         }
-        sr->response_text = json_get_token_value(sr->buffer, "transcript");
+        sr->response_text = NULL;
+        json_doc_t doc;
+        if (json_doc_parse(&doc, sr->buffer, read_len, NULL, 0) == ESP_OK) {
+            json_slice_t transcript;
+            if (json_doc_get(&doc, "results[0].alternatives[0].transcript", &transcript) == ESP_OK) {
+                sr->response_text = strndup(transcript.ptr, transcript.len);
+            }
+            json_doc_release(&doc);
+        }
         return ESP_OK;
     }
     return ESP_OK;
@@ -86,8 +86,13 @@ static ota_service_err_reason_t ota_http_tone_image_need_upgrade(void *handle, o
         return OTA_SERV_ERR_REASON_SUCCESS;
     }
 
-    /* Read tone header from partition */
-    if (esp_partition_read(partition, 0, (char *)&cur_header, sizeof(flash_tone_header_t)) != ESP_OK) {
+    /* Read tone header and app desc from partition, then unmap it before the partition is erased */
+    err = esp_partition_read(partition, 0, (char *)&cur_header, sizeof(flash_tone_header_t));
+    if (err == ESP_OK && cur_header.format == TONE_VERSION_1) {
+        err = tone_partition_get_app_desc(tone, &current_desc);
+    }
+    tone_partition_deinit(tone);
+    if (err != ESP_OK) {
         return OTA_SERV_ERR_REASON_PARTITION_RD_FAIL;
     }
 
@@ -120,9 +125,6 @@ static ota_service_err_reason_t ota_http_tone_image_need_upgrade(void *handle, o
 
     /* compare current app desc with the incoming one if the current bin's format is 1*/
     if (cur_header.format == TONE_VERSION_1) {
-        if (tone_partition_get_app_desc(tone, &current_desc) != ESP_OK) {
-            return OTA_SERV_ERR_REASON_PARTITION_RD_FAIL;
-        }
         if (ota_get_version_number(incoming_desc.version) < 0) {
             return OTA_SERV_ERR_REASON_ERROR_VERSION;
         }
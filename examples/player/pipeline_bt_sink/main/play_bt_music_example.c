@@ -24,9 +24,13 @@
 #include "filter_resample.h"
 #include "audio_mem.h"
 #include "bluetooth_service.h"
+#include "esp_periph_bringup.h"
 
 static const char *TAG = "BLUETOOTH_EXAMPLE";
 
+// The codec chip, the peripherals set and the keys share the I2C bus and the GPIO ISR service
+#define BOOT_GROUP_BOARD    (1)
+
 static void bt_app_avrc_ct_cb(esp_avrc_ct_cb_event_t event, esp_avrc_ct_cb_param_t *p_param)
 {
     esp_avrc_ct_cb_param_t *rc = p_param;
@@ -43,11 +47,14 @@ static void bt_app_avrc_ct_cb(esp_avrc_ct_cb_event_t event, esp_avrc_ct_cb_param
     }
 }
 
-void app_main(void)
-{
-    audio_pipeline_handle_t pipeline;
-    audio_element_handle_t bt_stream_reader, i2s_stream_writer;
+typedef struct {
+    audio_board_handle_t    board_handle;
+    audio_element_handle_t  i2s_stream_writer;
+    esp_periph_set_handle_t set;
+} bt_app_boot_t;
 
+static esp_err_t boot_nvs(void *ctx)
+{
     esp_err_t err = nvs_flash_init();
     if (err == ESP_ERR_NVS_NO_FREE_PAGES) {
         // NVS partition was truncated and needs to be erased
@@ -55,32 +62,92 @@ void app_main(void)
         ESP_ERROR_CHECK(nvs_flash_erase());
         err = nvs_flash_init();
     }
+    return err;
+}
 
-    esp_log_level_set("*", ESP_LOG_INFO);
-    esp_log_level_set(TAG, ESP_LOG_DEBUG);
-
-    ESP_LOGI(TAG, "[ 1 ] Create Bluetooth service");
+static esp_err_t boot_bt_service(void *ctx)
+{
     bluetooth_service_cfg_t bt_cfg = {
         .device_name = "ESP-ADF-SPEAKER",
         .mode = BLUETOOTH_A2DP_SINK,
         .user_callback.user_avrc_ct_cb = bt_app_avrc_ct_cb,
     };
-    bluetooth_service_start(&bt_cfg);
+    return bluetooth_service_start(&bt_cfg);
+}
+
+static esp_err_t boot_codec(void *ctx)
+{
+    bt_app_boot_t *boot = (bt_app_boot_t *)ctx;
+    boot->board_handle = audio_board_init();
+    AUDIO_NULL_CHECK(TAG, boot->board_handle, return ESP_FAIL);
+    return audio_hal_ctrl_codec(boot->board_handle->audio_hal, AUDIO_HAL_CODEC_MODE_DECODE, AUDIO_HAL_CTRL_START);
+}
+
+static esp_err_t boot_i2s(void *ctx)
+{
+    bt_app_boot_t *boot = (bt_app_boot_t *)ctx;
+    i2s_stream_cfg_t i2s_cfg = I2S_STREAM_CFG_DEFAULT();
+    i2s_cfg.type = AUDIO_STREAM_WRITER;
+    boot->i2s_stream_writer = i2s_stream_init(&i2s_cfg);
+    return boot->i2s_stream_writer ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t boot_periph_set(void *ctx)
+{
+    bt_app_boot_t *boot = (bt_app_boot_t *)ctx;
+    esp_periph_config_t periph_cfg = DEFAULT_ESP_PERIPH_SET_CONFIG();
+    boot->set = esp_periph_set_init(&periph_cfg);
+    return boot->set ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t boot_keys(void *ctx)
+{
+    bt_app_boot_t *boot = (bt_app_boot_t *)ctx;
+    return audio_board_key_init(boot->set);
+}
+
+void app_main(void)
+{
+    audio_pipeline_handle_t pipeline;
+    audio_element_handle_t bt_stream_reader, i2s_stream_writer;
+    bt_app_boot_t boot = { 0 };
+
+    esp_log_level_set("*", ESP_LOG_INFO);
+    esp_log_level_set(TAG, ESP_LOG_DEBUG);
 
-    ESP_LOGI(TAG, "[ 2 ] Start codec chip");
-    audio_board_handle_t board_handle = audio_board_init();
-    audio_hal_ctrl_codec(board_handle->audio_hal, AUDIO_HAL_CODEC_MODE_DECODE, AUDIO_HAL_CTRL_START);
+    ESP_LOGI(TAG, "[ 1 ] Bring up Bluetooth service, codec chip and peripherals concurrently");
+    esp_periph_bringup_cfg_t bringup_cfg = DEFAULT_ESP_PERIPH_BRINGUP_CONFIG();
+    esp_periph_bringup_handle_t bringup = esp_periph_bringup_create(&bringup_cfg);
+    // Step ids follow the order of the table
+    esp_periph_bringup_step_t steps[] = {
+        { .name = "nvs",        .func = boot_nvs,           .ctx = &boot },
+        { .name = "codec",      .func = boot_codec,         .ctx = &boot,   .group = BOOT_GROUP_BOARD },
+        { .name = "periph_set", .func = boot_periph_set,    .ctx = &boot,   .group = BOOT_GROUP_BOARD },
+        { .name = "bt_service", .func = boot_bt_service,    .ctx = &boot,   .deps = ESP_PERIPH_BRINGUP_STEP(0) },
+        { .name = "i2s",        .func = boot_i2s,           .ctx = &boot,   .deps = ESP_PERIPH_BRINGUP_STEP(1) },
+        { .name = "keys",       .func = boot_keys,          .ctx = &boot,   .deps = ESP_PERIPH_BRINGUP_STEP(2), .group = BOOT_GROUP_BOARD },
+    };
+    for (int i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+        esp_periph_bringup_add_step(bringup, &steps[i]);
+    }
+    esp_periph_bringup_start(bringup);
 
-    ESP_LOGI(TAG, "[ 3 ] Create audio pipeline for playback");
+    ESP_LOGI(TAG, "[ 2 ] Create audio pipeline for playback");
     audio_pipeline_cfg_t pipeline_cfg = DEFAULT_AUDIO_PIPELINE_CONFIG();
     pipeline = audio_pipeline_init(&pipeline_cfg);
 
-    ESP_LOGI(TAG, "[3.1] Create i2s stream to write data to codec chip");
-    i2s_stream_cfg_t i2s_cfg = I2S_STREAM_CFG_DEFAULT();
-    i2s_cfg.type = AUDIO_STREAM_WRITER;
-    i2s_stream_writer = i2s_stream_init(&i2s_cfg);
+    ESP_LOGI(TAG, "[ 3 ] Wait for the codec chip, the i2s stream and the Bluetooth service only");
+    uint32_t audio_steps = ESP_PERIPH_BRINGUP_STEP(1) | ESP_PERIPH_BRINGUP_STEP(3) | ESP_PERIPH_BRINGUP_STEP(4);
+    if (esp_periph_bringup_wait(bringup, audio_steps, portMAX_DELAY) != ESP_OK) {
+        ESP_LOGE(TAG, "[ * ] Audio bring-up failed");
+        esp_periph_bringup_wait_all(bringup, portMAX_DELAY);
+        esp_periph_bringup_log_timeline(bringup);
+        esp_periph_bringup_destroy(bringup);
+        return;
+    }
+    i2s_stream_writer = boot.i2s_stream_writer;
 
-    ESP_LOGI(TAG, "[3.2] Get Bluetooth stream");
+    ESP_LOGI(TAG, "[3.1] Get Bluetooth stream");
     bt_stream_reader = bluetooth_service_create_stream();
 
     ESP_LOGI(TAG, "[3.2] Register all elements to audio pipeline");
@@ -104,32 +171,38 @@ void app_main(void)
     const char *link_tag[2] = {"bt", "i2s"};
     audio_pipeline_link(pipeline, &link_tag[0], 2);
 #endif
-    ESP_LOGI(TAG, "[ 4 ] Initialize peripherals");
-    esp_periph_config_t periph_cfg = DEFAULT_ESP_PERIPH_SET_CONFIG();
-    esp_periph_set_handle_t set = esp_periph_set_init(&periph_cfg);
-
-    ESP_LOGI(TAG, "[4.1] Initialize Touch peripheral");
-    audio_board_key_init(set);
-
-    ESP_LOGI(TAG, "[4.2] Create Bluetooth peripheral");
-    esp_periph_handle_t bt_periph = bluetooth_service_create_periph();
-
-    ESP_LOGI(TAG, "[4.2] Start all peripherals");
-    esp_periph_start(set, bt_periph);
-
-    ESP_LOGI(TAG, "[ 5 ] Set up  event listener");
+    ESP_LOGI(TAG, "[ 4 ] Set up  event listener");
     audio_event_iface_cfg_t evt_cfg = AUDIO_EVENT_IFACE_DEFAULT_CFG();
     audio_event_iface_handle_t evt = audio_event_iface_init(&evt_cfg);
 
-    ESP_LOGI(TAG, "[5.1] Listening event from all elements of pipeline");
+    ESP_LOGI(TAG, "[4.1] Listening event from all elements of pipeline");
     audio_pipeline_set_listener(pipeline, evt);
 
-    ESP_LOGI(TAG, "[5.2] Listening event from peripherals");
-    audio_event_iface_set_listener(esp_periph_set_get_event_iface(set), evt);
-
-    ESP_LOGI(TAG, "[ 6 ] Start audio_pipeline");
+    ESP_LOGI(TAG, "[ 5 ] Start audio_pipeline, the peripherals may still be coming up");
     audio_pipeline_run(pipeline);
 
+    ESP_LOGI(TAG, "[ 6 ] Wait for the rest of the bring-up");
+    esp_err_t boot_ret = esp_periph_bringup_wait_all(bringup, portMAX_DELAY);
+    esp_periph_bringup_log_timeline(bringup);
+    esp_periph_bringup_destroy(bringup);
+    esp_periph_set_handle_t set = boot.set;
+    if (boot_ret != ESP_OK || set == NULL) {
+        ESP_LOGE(TAG, "[ * ] Peripherals bring-up failed");
+        audio_pipeline_stop(pipeline);
+        audio_pipeline_wait_for_stop(pipeline);
+        audio_pipeline_terminate(pipeline);
+        audio_pipeline_remove_listener(pipeline);
+        audio_event_iface_destroy(evt);
+        return;
+    }
+
+    ESP_LOGI(TAG, "[6.1] Create Bluetooth peripheral and start it");
+    esp_periph_handle_t bt_periph = bluetooth_service_create_periph();
+    esp_periph_start(set, bt_periph);
+
+    ESP_LOGI(TAG, "[6.2] Listening event from peripherals");
+    audio_event_iface_set_listener(esp_periph_set_get_event_iface(set), evt);
+
     ESP_LOGI(TAG, "[ 7 ] Listen for all pipeline events");
     while (1) {
         audio_event_iface_msg_t msg;
@@ -122,7 +122,7 @@ void app_main(void)
     i2s_stream_writer = i2s_stream_init(&i2s_cfg2);
 
     ESP_LOGI(TAG, "[3.2] Get hfp stream");
-    hfp_stream_config_t hfp_config;
+    hfp_stream_config_t hfp_config = HFP_STREAM_CFG_DEFAULT();
     hfp_config.type = OUTGOING_STREAM;
     hfp_out_stream = hfp_stream_init(&hfp_config);
     hfp_config.type = INCOMING_STREAM;
@@ -64,6 +64,7 @@ import os
 import struct
 import argparse
 import time
+import zlib
 
 __version__ = '1.2'
 
@@ -200,15 +201,16 @@ def pack_tone_file_table(tone_bin, file_list):
             offset += f_size + ((4 - f_size % 4) % 4)
 
     for info in get_info(file_list, next_addr):
-        tone_bin += struct.pack("<BBBBII", 0x28           #file tag
-                                        , info['idx']     #song index
-                                        , info['type']
-                                        , 0x0             #songVer
-                                        , info['addr']
-                                        , info['len']     #song length
-                                        )
-        tone_bin += struct.pack("<12I",*RFU)
-        tone_bin += struct.pack("<I",0x0)
+        file_info = struct.pack("<BBBBII", 0x28           #file tag
+                                         , info['idx']     #song index
+                                         , info['type']
+                                         , 0x0             #songVer
+                                         , info['addr']
+                                         , info['len']     #song length
+                                         )
+        file_info += struct.pack("<12I",*RFU)
+        tone_bin += file_info
+        tone_bin += struct.pack("<I", zlib.crc32(file_info) & 0xFFFFFFFF)  #info crc
 
         print ('fname:', info['name'])
         print ('song index: ', info['idx'])
@@ -238,7 +240,6 @@ def pack_tone_crc(tone_bin, b_format):
     pack the crc
     """
     if b_format == 1:
-        import zlib
         tone_bin += struct.pack("<I", zlib.crc32(tone_bin))
     return tone_bin
 
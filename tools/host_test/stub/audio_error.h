@@ -0,0 +1,8 @@
+#pragma once
+#include "esp_log.h"
+#define AUDIO_CHECK(TAG, a, action, msg) if (!(a)) {                                \
+        ESP_LOGE(TAG,"%s:%d (%s): %s", __FILE__, __LINE__, __FUNCTION__, msg);  \
+        action;                                                                     \
+        }
+#define AUDIO_MEM_CHECK(TAG, a, action)  AUDIO_CHECK(TAG, a, action, "Memory exhausted")
+#define AUDIO_NULL_CHECK(TAG, a, action) AUDIO_CHECK(TAG, a, action, "Got NULL Pointer")
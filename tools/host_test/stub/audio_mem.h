@@ -0,0 +1,9 @@
+#pragma once
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#define audio_malloc  malloc
+#define audio_free    free
+#define audio_calloc  calloc
+#define audio_realloc realloc
+#define audio_mem_spiram_stack_is_enabled() (false)
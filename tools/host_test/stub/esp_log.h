@@ -0,0 +1,8 @@
+#pragma once
+#include <stdio.h>
+#define LOGOUT(tag, format, ...) printf("%s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI LOGOUT
+#define ESP_LOGE LOGOUT
+#define ESP_LOGW LOGOUT
+#define ESP_LOGD(tag, format, ...)
+#define ESP_LOGV(tag, format, ...)